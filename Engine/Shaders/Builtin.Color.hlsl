@@ -4,9 +4,25 @@
 // Transforms and colors geometry.
 //**
  
-cbuffer cbPerObject : register(b0)
+struct ObjectData
 {
-    float4x4 gWorld; 
+    float4x4 World;
+};
+
+struct InstanceData
+{
+    uint ObjectId;
+    uint MaterialId;
+};
+
+// Every object's data, kept on the GPU from one frame to the next.
+StructuredBuffer<ObjectData> gObjects : register(t0, space1);
+// This frame's instances, the draw's ones start at gFirstInstance.
+StructuredBuffer<InstanceData> gInstances : register(t1, space1);
+
+cbuffer cbPerDraw : register(b0)
+{
+    uint gFirstInstance;
 };
 
 cbuffer cbPass : register(b1)
@@ -26,12 +42,13 @@ struct VertexOut
     float4 Color : COLOR;
 };
 
-VertexOut VS(VertexIn vin)
+VertexOut VS(VertexIn vin, uint instanceId : SV_InstanceID)
 {
     VertexOut vout;
 
     // Transform to homogeneous clip space.
-    float4 posW = mul(float4(vin.PosL, 1.0f), gWorld);
+    uint objectId = gInstances[gFirstInstance + instanceId].ObjectId;
+    float4 posW = mul(float4(vin.PosL, 1.0f), gObjects[objectId].World);
     vout.PosH = mul(posW, gViewProj);
 
     // Just pass vertex color into the pixel shader.
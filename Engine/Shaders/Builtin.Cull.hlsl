@@ -0,0 +1,136 @@
+// Frustum culling of the GpuCuller's candidates into the arguments of one ExecuteIndirect. GpuCulling is the
+// CPU reference of the three passes, the structs below are its ones : keep them in sync.
+
+#define GROUP_SIZE 64
+
+struct Candidate
+{
+    float3 Center;
+    uint IndexCount;
+    float3 Extents;
+    uint StartIndex;
+    int BaseVertex;
+    uint3 Padding;
+};
+
+// gFirstInstance of the draw shaders, then D3D12_DRAW_INDEXED_ARGUMENTS.
+struct DrawCommand
+{
+    uint FirstInstance;
+    uint IndexCountPerInstance;
+    uint InstanceCount;
+    uint StartIndexLocation;
+    int BaseVertexLocation;
+    uint StartInstanceLocation;
+};
+
+cbuffer cbCull : register(b0)
+{
+    // Left, right, bottom, top, near, far, relative to the candidates' origin.
+    float4 gPlanes[6];
+    uint gCandidateCount;
+    uint gGroupCount;
+    uint2 gPadding;
+};
+
+StructuredBuffer<Candidate> gCandidates : register(t0);
+// Visible candidates of each group, written by CullCS.
+RWStructuredBuffer<uint> gGroupCounts : register(u0);
+// Two uints per group, bit i of the first is candidate i of the group, of the second candidate 32 + i.
+RWStructuredBuffer<uint2> gVisibility : register(u1);
+RWStructuredBuffer<DrawCommand> gCommands : register(u2);
+// The number of commands, read by ExecuteIndirect.
+RWByteAddressBuffer gCommandCount : register(u3);
+// Visible candidates of the groups before each one, written by ScanCS.
+RWStructuredBuffer<uint> gGroupBases : register(u4);
+
+groupshared uint sMask[2];
+groupshared uint sSums[GROUP_SIZE];
+
+bool IsVisible(Candidate pCandidate)
+{
+    [unroll]
+    for (uint i = 0; i < 6; ++i)
+    {
+        const float4 plane = gPlanes[i];
+        // Evaluated in this order and without mad, as GpuCulling::IsVisible.
+        precise float distance = ((pCandidate.Center.x * plane.x + pCandidate.Center.y * plane.y) +
+            pCandidate.Center.z * plane.z) + plane.w;
+        precise float radius = (pCandidate.Extents.x * abs(plane.x) + pCandidate.Extents.y * abs(plane.y)) +
+            pCandidate.Extents.z * abs(plane.z);
+        precise float sum = distance + radius;
+        if (sum < 0.0f)
+            return false;
+    }
+    return true;
+}
+
+[numthreads(GROUP_SIZE, 1, 1)]
+void CullCS(uint3 pGroupId : SV_GroupID, uint pThread : SV_GroupIndex)
+{
+    if (pThread < 2)
+        sMask[pThread] = 0;
+    GroupMemoryBarrierWithGroupSync();
+
+    const uint index = pGroupId.x * GROUP_SIZE + pThread;
+    if (index < gCandidateCount && IsVisible(gCandidates[index]))
+        InterlockedOr(sMask[pThread / 32], 1u << (pThread % 32));
+    GroupMemoryBarrierWithGroupSync();
+
+    if (pThread == 0)
+    {
+        gVisibility[pGroupId.x] = uint2(sMask[0], sMask[1]);
+        gGroupCounts[pGroupId.x] = countbits(sMask[0]) + countbits(sMask[1]);
+    }
+}
+
+// Dispatched as a single group, each thread sums a contiguous run of the group counts.
+[numthreads(GROUP_SIZE, 1, 1)]
+void ScanCS(uint pThread : SV_GroupIndex)
+{
+    const uint runLength = (gGroupCount + GROUP_SIZE - 1) / GROUP_SIZE;
+    const uint first = min(pThread * runLength, gGroupCount);
+    const uint last = min(first + runLength, gGroupCount);
+
+    uint sum = 0;
+    for (uint group = first; group < last; ++group)
+        sum += gGroupCounts[group];
+    sSums[pThread] = sum;
+    GroupMemoryBarrierWithGroupSync();
+
+    uint base = 0;
+    for (uint i = 0; i < pThread; ++i)
+        base += sSums[i];
+    for (uint group = first; group < last; ++group)
+    {
+        gGroupBases[group] = base;
+        base += gGroupCounts[group];
+    }
+
+    if (pThread == GROUP_SIZE - 1)
+        gCommandCount.Store(0, base);
+}
+
+[numthreads(GROUP_SIZE, 1, 1)]
+void CompactCS(uint3 pGroupId : SV_GroupID, uint pThread : SV_GroupIndex)
+{
+    // The draws of the groups before this one come first.
+    const uint base = gGroupBases[pGroupId.x];
+    const uint2 mask = gVisibility[pGroupId.x];
+    const uint bit = 1u << (pThread % 32);
+    if ((pThread < 32 ? mask.x : mask.y) & bit)
+    {
+        const uint below = pThread < 32 ? countbits(mask.x & (bit - 1)) : countbits(mask.x) + countbits(mask.y & (bit - 1));
+        const uint index = pGroupId.x * GROUP_SIZE + pThread;
+        const Candidate candidate = gCandidates[index];
+
+        DrawCommand command;
+        command.FirstInstance = index;
+        command.IndexCountPerInstance = candidate.IndexCount;
+        command.InstanceCount = 1;
+        command.StartIndexLocation = candidate.StartIndex;
+        command.BaseVertexLocation = candidate.BaseVertex;
+        command.StartInstanceLocation = 0;
+        gCommands[base + below] = command;
+    }
+}
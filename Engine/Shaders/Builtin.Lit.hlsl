@@ -4,35 +4,79 @@ struct DirectionalLight
     float3 Direction;
 };
 
-cbuffer cbPerObject : register(b0)
+struct ObjectData
 {
-	float4x4 gWorld;
+    float4x4 World;
 };
 
+struct InstanceData
+{
+    uint ObjectId;
+    uint MaterialId;
+};
+
+#define NO_TEXTURE 0xFFFFFFFF
+
+// Permutations, see DirectXLitShader. The defaults are the most general variant.
+// TEXTURE : 0 when the material has no texture, nothing is sampled.
+#ifndef TEXTURE
+#define TEXTURE 1
+#endif
+// MAX_DIRECTIONAL_LIGHTS : the loop is unrolled to this many lights, gNumDirectionalLights must not exceed it.
+#ifndef MAX_DIRECTIONAL_LIGHTS
+#define MAX_DIRECTIONAL_LIGHTS 10
+#endif
+
+// Parameters of a lit material, the C++ struct is generated from this one (Scripts/GenerateShaderLayouts.py).
+struct LitMaterialConstants
+{
+    float4 Albedo;
+    float4 Specular;
+    float  Smoothness;
+    float  Fresnel;
+
+    float2 Tiling;
+};
+
+// Parameters of a lit material and its texture, see GpuMaterialData.
+struct MaterialData
+{
+    LitMaterialConstants Constants;
+
+    uint TextureIndex;
+    uint3 Padding;
+};
+
+// Every object's data, kept on the GPU from one frame to the next.
+StructuredBuffer<ObjectData> gObjects : register(t0, space1);
+// This frame's instances, the draw's ones start at gFirstInstance.
+StructuredBuffer<InstanceData> gInstances : register(t1, space1);
+// Every material's data, indexed by the instances' MaterialId.
+StructuredBuffer<MaterialData> gMaterials : register(t2, space1);
+
+cbuffer cbPerDraw : register(b0)
+{
+	uint gFirstInstance;
+};
+
+// PassConstants is generated from this one (Scripts/GenerateShaderLayouts.py). The lights are last, only the
+// gNumDirectionalLights first ones are uploaded.
 cbuffer cbPass : register(b1)
 {
     float4x4 gViewProj;
+    // Shares a register with gEyePosW.
     float3 gEyePosW;
+    int gNumDirectionalLights;
 
     float4 gAmbientLight;
 
-    int gNumDirectionalLights;
     DirectionalLight gDirectionalLights[10];
 };
 
-Texture2D mainTexture : register(t0);
+// Every texture of the heap, indexed by the materials' TextureIndex.
+Texture2D gTextures[] : register(t0, space2);
 SamplerState mainSample : register(s0);
 
-cbuffer cbMaterial : register(b2)
-{
-	float4 gAlbedo;
-    float4 gSpecular;
-    float  gSmoothness;
-    float  gFresnel;
-
-    float2 gTiling;
-};
-
 
 struct VertexIn
 {
@@ -47,20 +91,24 @@ struct VertexOut
 	float3 PosW  : POSITION;
     float2 TexC    : TEXCOORD;
     float3 NormalW : NORMAL;
+    nointerpolation uint MaterialId : MATERIAL;
 };
 
-VertexOut VS(VertexIn vin)
+VertexOut VS(VertexIn vin, uint instanceId : SV_InstanceID)
 {
 	VertexOut vout;
 	
 	// Transform to homogeneous clip space.
-    float4 posW = mul(float4(vin.PosL, 1.0f), gWorld);
+    InstanceData instance = gInstances[gFirstInstance + instanceId];
+    vout.MaterialId = instance.MaterialId;
+    float4x4 world = gObjects[instance.ObjectId].World;
+    float4 posW = mul(float4(vin.PosL, 1.0f), world);
     vout.PosW = posW.xyz;
 	
-    vout.NormalW = mul(vin.NormalL, (float3x3)gWorld);
+    vout.NormalW = mul(vin.NormalL, (float3x3)world);
     vout.PosH = mul(posW, gViewProj);
 
-    vout.TexC = vin.TexC * gTiling;
+    vout.TexC = vin.TexC * gMaterials[instance.MaterialId].Constants.Tiling;
     
     return vout;
 }
@@ -99,7 +147,7 @@ float LightingGGX_REF(float3 N, float3 V, float3 L, float roughness, float F0)
     return specular;
 }
 
-float4 CalculateLighting(DirectionalLight light, VertexOut pin)
+float4 CalculateLighting(DirectionalLight light, MaterialData material, VertexOut pin)
 {
     float4 diffuseColor = float4(0, 0, 0, 0);
     float4 specularColor = float4(0, 0, 0, 0);
@@ -115,7 +163,7 @@ float4 CalculateLighting(DirectionalLight light, VertexOut pin)
     // specular
     if (diffuseFactor > 0)
     {
-         specularColor = float4(float3(1, 1, 1) * LightingGGX_REF(normal, viewDir, lightDir, 1 - gSmoothness, gFresnel), 1);
+         specularColor = float4(float3(1, 1, 1) * LightingGGX_REF(normal, viewDir, lightDir, 1 - material.Constants.Smoothness, material.Constants.Fresnel), 1);
     }
 
     return diffuseColor + specularColor;
@@ -123,14 +171,23 @@ float4 CalculateLighting(DirectionalLight light, VertexOut pin)
 
 float4 PS(VertexOut pin) : SV_Target
 {
+    MaterialData material = gMaterials[pin.MaterialId];
     float4 ambientColor = gAmbientLight;
     float4 specularDiffuseColor = float4(0, 0, 0, 0);
     
-    int i = 0;
-    for(i = 0; i < gNumDirectionalLights; ++i)
+    [unroll]
+    for (int i = 0; i < MAX_DIRECTIONAL_LIGHTS; ++i)
     {
-        specularDiffuseColor += CalculateLighting(gDirectionalLights[i], pin);
+        if (i < gNumDirectionalLights)
+            specularDiffuseColor += CalculateLighting(gDirectionalLights[i], material, pin);
     }
 
-    return mainTexture.Sample(mainSample, pin.TexC) * gAlbedo * (ambientColor + specularDiffuseColor * gSpecular);
+    float4 textureColor = float4(1, 1, 1, 1);
+#if TEXTURE
+    // Instances of a draw can have different textures, the index is not uniform.
+    if (material.TextureIndex != NO_TEXTURE)
+        textureColor = gTextures[NonUniformResourceIndex(material.TextureIndex)].Sample(mainSample, pin.TexC);
+#endif
+
+    return textureColor * material.Constants.Albedo * (ambientColor + specularDiffuseColor * material.Constants.Specular);
 }
\ No newline at end of file
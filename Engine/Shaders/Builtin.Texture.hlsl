@@ -1,8 +1,34 @@
 
-// Constant data that varies per frame.
-cbuffer cbPerObject : register(b0)
+struct ObjectData
 {
-    float4x4 gWorld;
+    float4x4 World;
+};
+
+struct InstanceData
+{
+    uint ObjectId;
+    uint MaterialId;
+};
+
+#define NO_TEXTURE 0xFFFFFFFF
+
+struct MaterialData
+{
+    float4 Parameters[3];
+    uint TextureIndex;
+    uint3 Padding;
+};
+
+// Every object's data, kept on the GPU from one frame to the next.
+StructuredBuffer<ObjectData> gObjects : register(t0, space1);
+// This frame's instances, the draw's ones start at gFirstInstance.
+StructuredBuffer<InstanceData> gInstances : register(t1, space1);
+// Every material's data, indexed by the instances' MaterialId.
+StructuredBuffer<MaterialData> gMaterials : register(t2, space1);
+
+cbuffer cbPerDraw : register(b0)
+{
+    uint gFirstInstance;
 };
 
 // Constant data that varies per material.
@@ -11,7 +37,8 @@ cbuffer cbPass : register(b1)
     float4x4 gViewProj;
 };
 
-Texture2D mainTexture : register(t0);
+// Every texture of the heap, indexed by the materials' TextureIndex.
+Texture2D gTextures[] : register(t0, space2);
 SamplerState mainSample : register(s0);
 
 struct VertexIn
@@ -25,14 +52,17 @@ struct VertexOut
 	float4 PosH    : SV_POSITION;
     float3 PosW    : POSITION;
 	float2 TexC    : TEXCOORD;
+    nointerpolation uint TextureIndex : TEXTURE;
 };
 
-VertexOut VS(VertexIn vin)
+VertexOut VS(VertexIn vin, uint instanceId : SV_InstanceID)
 {
 	VertexOut vout = (VertexOut)0.0f;
 	
     // Transform to world space.
-    float4 posW = mul(float4(vin.PosL, 1.0f), gWorld);
+    InstanceData instance = gInstances[gFirstInstance + instanceId];
+    float4 posW = mul(float4(vin.PosL, 1.0f), gObjects[instance.ObjectId].World);
+    vout.TextureIndex = gMaterials[instance.MaterialId].TextureIndex;
     vout.PosW = posW.xyz;
 
     // Transform to homogeneous clip space.
@@ -46,5 +76,8 @@ VertexOut VS(VertexIn vin)
 
 float4 PS(VertexOut pin) : SV_Target
 {
-    return mainTexture.Sample(mainSample, pin.TexC);
+    if (pin.TextureIndex == NO_TEXTURE)
+        return float4(1, 1, 1, 1);
+    // Instances of a draw can have different textures, the index is not uniform.
+    return gTextures[NonUniformResourceIndex(pin.TextureIndex)].Sample(mainSample, pin.TexC);
 }
\ No newline at end of file
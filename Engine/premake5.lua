@@ -25,6 +25,12 @@ project "Engine"
 	
 	flags { "NoPCH" }
 
+	-- Mirrors of the shaders' constant buffers, regenerated when a shader changes them.
+	prebuildcommands { "python \"%{wks.location}Scripts/GenerateShaderLayouts.py\"" }
+
+	-- The software occlusion rasterizer evaluates 8 pixels per instruction.
+	vectorextensions "AVX2"
+
     filter "system:windows"
 		systemversion "latest"
 		defines "PLATFORM_WINDOWS"
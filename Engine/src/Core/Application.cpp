@@ -7,6 +7,9 @@
 #include "Renderer/DirectXApi.h"
 #include "Core/ObjLoader.h"
 #include "Renderer/Resource/DirectXResourceManager.h"
+#include "Core/JobSystem.h"
+#include "Platform/HeadlessWindow.h"
+#include "Platform/WindowsWindow.h"
 
 #include "Renderer/Shaders/DirectXShader.h"
 #include "Renderer/Shaders/DirectXSimpleShader.h"
@@ -28,31 +31,36 @@ namespace Engine
 	Application* Application::s_Instance = nullptr;
 
 	Application::Application(const ApplicationSpecification& pSpecification)
+		: m_Specification(pSpecification)
 	{
 		s_Instance = this;
-		m_Window = nullptr;
 
 		// === Window ===
-		m_Window = new WindowsWindow(WindowProps(pSpecification.Name, 1280, 700));
+		const WindowProps windowProps(pSpecification.Name, pSpecification.Width, pSpecification.Height);
+		if (pSpecification.Headless)
+			m_Window = std::make_unique<HeadlessWindow>(windowProps, pSpecification.Script);
+		else
+			m_Window = std::make_unique<WindowsWindow>(windowProps);
 		m_Window->SetEventCallback(BIND_EVENT_FN(Application::OnEvent));
 
+		// === Jobs ===
+		JobSystem::Initialize();
+
 		// === Renderer ===
-		DirectXApi::Initialize();
+		DirectXApi::Initialize(pSpecification.Headless);
 
 		// === Game Timer ===
-		__int64 countsPerSec;
-		QueryPerformanceFrequency(reinterpret_cast<LARGE_INTEGER*>(&countsPerSec));
-		m_SecondsPerCount = 1.0 / static_cast<double>(countsPerSec);
-
-		__int64 time;
-		QueryPerformanceCounter(reinterpret_cast<LARGE_INTEGER*>(&time));
-		m_LastFrameTime = time;
+		if (pSpecification.FixedTimestep > 0.f)
+			m_Clock = std::make_unique<FixedStepClock>(pSpecification.FixedTimestep);
+		else
+			m_Clock = std::make_unique<SystemClock>();
 	}
 
 	Application::~Application()
 	{
 		DirectXApi::Shutdown();
-		delete m_Window;
+		JobSystem::Shutdown();
+		m_Window.reset();
 	}
 
 	void Application::Run()
@@ -61,11 +69,9 @@ namespace Engine
 		{
 			if (!m_IsMinimized)
 			{
-				__int64 time;
-				QueryPerformanceCounter(reinterpret_cast<LARGE_INTEGER*>(&time));
-				Timestep deltaTime = (time - m_LastFrameTime) * m_SecondsPerCount;
-				m_LastFrameTime = time;
-				m_Fps = 1.f / deltaTime.GetSeconds();
+				const Timestep deltaTime = m_Clock->Tick();
+				if (deltaTime.GetSeconds() > 0.f)
+					m_Fps = 1.f / deltaTime.GetSeconds();
 
 				Update(deltaTime);
 
@@ -77,6 +83,10 @@ namespace Engine
 			}
 
 			m_Window->Update();
+
+			m_FrameIndex++;
+			if (m_Specification.FrameCount != 0 && m_FrameIndex >= m_Specification.FrameCount)
+				m_IsRunning = false;
 		}
 	}
 
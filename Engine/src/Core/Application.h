@@ -2,9 +2,11 @@
 #include <assert.h>
 #include <string>
 
+#include "Clock.h"
 #include "Timestep.h"
 #include "Events/ApplicationEvent.h"
-#include "Platform/WindowsWindow.h"
+#include "Platform/EventScript.h"
+#include "Platform/Window.h"
 #include "Renderer/DirectXMesh.h"
 #include "Core/Object.h"
 
@@ -15,6 +17,18 @@ namespace Engine
 	struct ApplicationSpecification
 	{
 		std::string Name = "Application";
+		uint32_t Width = 1280;
+		uint32_t Height = 700;
+
+		// Runs without an OS window nor a GPU : the window is a HeadlessWindow replaying Script and the
+		// renderer records into the null render backend.
+		bool Headless = false;
+		EventScript Script;
+
+		// Every frame advances by this many seconds when not 0, by the real elapsed time otherwise.
+		float FixedTimestep = 0.f;
+		// Run() returns after this many frames when not 0.
+		uint64_t FrameCount = 0;
 	};
 
 	class Application
@@ -25,7 +39,13 @@ namespace Engine
 
 		[[nodiscard]] const ApplicationSpecification& GetSpecification() const { return m_Specification; }
 
-		[[nodiscard]] WindowsWindow* GetWindow() const { return m_Window; }
+		[[nodiscard]] Window* GetWindow() const { return m_Window.get(); }
+		[[nodiscard]] Clock* GetClock() const { return m_Clock.get(); }
+		/// <summary>
+		/// Replaces the time source of the main loop (ex. a FixedStepClock for reproducible runs).
+		/// </summary>
+		void SetClock(std::unique_ptr<Clock> pClock) { m_Clock = std::move(pClock); }
+		[[nodiscard]] uint64_t GetFrameIndex() const { return m_FrameIndex; }
 		void SetMinimized(const bool pValue) { m_IsMinimized = pValue; }
 
 		static Application* Get() { return s_Instance; }
@@ -46,11 +66,11 @@ namespace Engine
 
 		bool m_IsRunning = true;
 		bool m_IsMinimized = false;
-		__int64 m_LastFrameTime = 0;
-		double m_SecondsPerCount;
+		uint64_t m_FrameIndex = 0;
 		float m_Fps = 0.0f;
 
-		WindowsWindow* m_Window;
+		std::unique_ptr<Window> m_Window;
+		std::unique_ptr<Clock> m_Clock;
 
 	private:
 		static Application* s_Instance;
@@ -0,0 +1,28 @@
+#include "Clock.h"
+
+namespace Engine
+{
+	SystemClock::SystemClock()
+		: m_Start(std::chrono::steady_clock::now()), m_LastTick(m_Start)
+	{
+	}
+
+	Timestep SystemClock::Tick()
+	{
+		const auto now = std::chrono::steady_clock::now();
+		const std::chrono::duration<float> deltaTime = now - m_LastTick;
+		m_LastTick = now;
+		return deltaTime.count();
+	}
+
+	double SystemClock::GetTime() const
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_Start).count();
+	}
+
+	Timestep FixedStepClock::Tick()
+	{
+		m_Time += m_Step;
+		return m_Step;
+	}
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <chrono>
+
+#include "Timestep.h"
+
+namespace Engine
+{
+	/// <summary>
+	/// Time source of the main loop.
+	/// </summary>
+	class Clock
+	{
+	public:
+		virtual ~Clock() = default;
+
+		/// <returns> The time elapsed since the previous call (or since the clock was created). </returns>
+		virtual Timestep Tick() = 0;
+		/// <returns> The time elapsed since the clock was created, in seconds. </returns>
+		[[nodiscard]] virtual double GetTime() const = 0;
+	};
+
+	/// <summary>
+	/// Real monotonic time.
+	/// </summary>
+	class SystemClock : public Clock
+	{
+	public:
+		SystemClock();
+
+		Timestep Tick() override;
+		[[nodiscard]] double GetTime() const override;
+
+	private:
+		std::chrono::steady_clock::time_point m_Start;
+		std::chrono::steady_clock::time_point m_LastTick;
+	};
+
+	/// <summary>
+	/// Advances by the same step on every Tick(), whatever the real time spent, so runs are reproducible.
+	/// </summary>
+	class FixedStepClock : public Clock
+	{
+	public:
+		explicit FixedStepClock(float pStep = 1.f / 60.f) : m_Step(pStep) {}
+
+		Timestep Tick() override;
+		[[nodiscard]] double GetTime() const override { return m_Time; }
+
+		[[nodiscard]] float GetStep() const { return m_Step; }
+
+	private:
+		float m_Step;
+		double m_Time = 0.0;
+	};
+}
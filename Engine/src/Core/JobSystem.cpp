@@ -0,0 +1,128 @@
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Engine
+{
+	namespace
+	{
+		struct JobSystemData
+		{
+			std::vector<std::thread> Workers;
+			std::deque<std::function<void()>> Queue;
+			std::mutex Mutex;
+			std::condition_variable Condition;
+			bool IsRunning = false;
+		};
+
+		JobSystemData s_Data;
+
+		bool TryRunOne()
+		{
+			std::function<void()> job;
+			{
+				std::lock_guard lock(s_Data.Mutex);
+				if (s_Data.Queue.empty())
+					return false;
+				job = std::move(s_Data.Queue.front());
+				s_Data.Queue.pop_front();
+			}
+			job();
+			return true;
+		}
+
+		void WorkerLoop()
+		{
+			while (true)
+			{
+				std::function<void()> job;
+				{
+					std::unique_lock lock(s_Data.Mutex);
+					s_Data.Condition.wait(lock, [] { return !s_Data.IsRunning || !s_Data.Queue.empty(); });
+					if (!s_Data.IsRunning && s_Data.Queue.empty())
+						return;
+					job = std::move(s_Data.Queue.front());
+					s_Data.Queue.pop_front();
+				}
+				job();
+			}
+		}
+	}
+
+	void JobSystem::Initialize(uint32_t pWorkerCount)
+	{
+		if (s_Data.IsRunning)
+			return;
+
+		if (pWorkerCount == 0)
+			pWorkerCount = (std::max)(1u, std::thread::hardware_concurrency()) - 1;
+
+		s_Data.IsRunning = true;
+		for (uint32_t i = 0; i < pWorkerCount; ++i)
+			s_Data.Workers.emplace_back(WorkerLoop);
+	}
+
+	void JobSystem::Shutdown()
+	{
+		{
+			std::lock_guard lock(s_Data.Mutex);
+			s_Data.IsRunning = false;
+		}
+		s_Data.Condition.notify_all();
+		for (auto& worker : s_Data.Workers)
+			worker.join();
+		s_Data.Workers.clear();
+	}
+
+	uint32_t JobSystem::GetThreadCount()
+	{
+		return static_cast<uint32_t>(s_Data.Workers.size()) + 1;
+	}
+
+	void JobSystem::ParallelFor(const uint32_t pCount, const uint32_t pMinRange, const RangeJob& pJob)
+	{
+		if (pCount == 0)
+			return;
+
+		const uint32_t maxRanges = (pCount + (std::max)(1u, pMinRange) - 1) / (std::max)(1u, pMinRange);
+		const uint32_t rangeCount = (std::min)(GetThreadCount(), maxRanges);
+		if (rangeCount <= 1)
+		{
+			pJob(0, pCount, 0);
+			return;
+		}
+
+		std::atomic<uint32_t> remaining = rangeCount - 1;
+		const uint32_t rangeSize = pCount / rangeCount;
+		const uint32_t leftover = pCount % rangeCount;
+		const auto rangeFirst = [&](const uint32_t pRange) { return pRange * rangeSize + (std::min)(pRange, leftover); };
+
+		{
+			std::lock_guard lock(s_Data.Mutex);
+			for (uint32_t range = 1; range < rangeCount; ++range)
+			{
+				s_Data.Queue.emplace_back([&, range]
+				{
+					pJob(rangeFirst(range), rangeFirst(range + 1), range);
+					remaining.fetch_sub(1, std::memory_order_release);
+				});
+			}
+		}
+		s_Data.Condition.notify_all();
+
+		pJob(0, rangeFirst(1), 0);
+
+		// Help with queued work instead of sleeping, so nested ParallelFor calls cannot starve.
+		while (remaining.load(std::memory_order_acquire) > 0)
+		{
+			if (!TryRunOne())
+				std::this_thread::yield();
+		}
+	}
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+
+namespace Engine
+{
+	/// <summary>
+	/// Small pool of worker threads used to split CPU work (culling, baking, ...) in contiguous ranges.
+	/// </summary>
+	class JobSystem
+	{
+	public:
+		using RangeJob = std::function<void(uint32_t pFirst, uint32_t pLast, uint32_t pWorkerIndex)>;
+
+		/// <summary>
+		/// Starts the worker threads.
+		/// </summary>
+		/// <param name="pWorkerCount"> : number of threads, 0 to use one per hardware thread minus the caller</param>
+		static void Initialize(uint32_t pWorkerCount = 0);
+		static void Shutdown();
+
+		/// <returns> The number of threads that can run jobs, the calling thread included. </returns>
+		static uint32_t GetThreadCount();
+
+		/// <summary>
+		/// Splits [0, pCount) in at most GetThreadCount() contiguous ranges of at least pMinRange items
+		/// and runs them in parallel. The calling thread takes part and returns once every range is done.
+		/// pWorkerIndex is the index of the range, ranges are numbered in order from 0 and fewer than GetThreadCount().
+		/// </summary>
+		static void ParallelFor(uint32_t pCount, uint32_t pMinRange, const RangeJob& pJob);
+	};
+}
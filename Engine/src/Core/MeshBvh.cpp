@@ -0,0 +1,622 @@
+#include "MeshBvh.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <immintrin.h>
+#include <numeric>
+#include <utility>
+
+namespace Engine
+{
+	namespace
+	{
+		float SurfaceArea(const DirectX::XMFLOAT3& min, const DirectX::XMFLOAT3& max)
+		{
+			const float ex = max.x - min.x;
+			const float ey = max.y - min.y;
+			const float ez = max.z - min.z;
+			return ex * ey + ey * ez + ez * ex;
+		}
+
+		float GetAxis(const DirectX::XMFLOAT3& v, int axis)
+		{
+			return (&v.x)[axis];
+		}
+
+		void Grow(DirectX::XMFLOAT3& min, DirectX::XMFLOAT3& max, const DirectX::XMFLOAT3& pMin,
+		          const DirectX::XMFLOAT3& pMax)
+		{
+			min = {std::min(min.x, pMin.x), std::min(min.y, pMin.y), std::min(min.z, pMin.z)};
+			max = {std::max(max.x, pMax.x), std::max(max.y, pMax.y), std::max(max.z, pMax.z)};
+		}
+
+		struct Bin
+		{
+			DirectX::XMFLOAT3 Min = {FLT_MAX, FLT_MAX, FLT_MAX};
+			DirectX::XMFLOAT3 Max = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+			uint32_t Count = 0;
+		};
+
+		// Structure of arrays view of up to 8 rays.
+		struct RayPacket
+		{
+			__m256 OriginX, OriginY, OriginZ;
+			__m256 DirX, DirY, DirZ;
+			__m256 InvDirX, InvDirY, InvDirZ;
+			// Origin * InvDir, so a slab distance is one fused multiply-subtract.
+			__m256 ScaledOriginX, ScaledOriginY, ScaledOriginZ;
+			__m256 TMax;
+			__m256 U, V;
+			__m256i TriangleIndex;
+		};
+
+		// Returns the lanes whose ray enters the box before its current TMax, and the entry distances, FLT_MAX
+		// for the other lanes.
+		int IntersectAabb(const RayPacket& packet, const BvhNode& node, __m256& tEnter)
+		{
+			const __m256 tx0 = _mm256_fmsub_ps(_mm256_set1_ps(node.BoundsMin.x), packet.InvDirX, packet.ScaledOriginX);
+			const __m256 tx1 = _mm256_fmsub_ps(_mm256_set1_ps(node.BoundsMax.x), packet.InvDirX, packet.ScaledOriginX);
+			const __m256 ty0 = _mm256_fmsub_ps(_mm256_set1_ps(node.BoundsMin.y), packet.InvDirY, packet.ScaledOriginY);
+			const __m256 ty1 = _mm256_fmsub_ps(_mm256_set1_ps(node.BoundsMax.y), packet.InvDirY, packet.ScaledOriginY);
+			const __m256 tz0 = _mm256_fmsub_ps(_mm256_set1_ps(node.BoundsMin.z), packet.InvDirZ, packet.ScaledOriginZ);
+			const __m256 tz1 = _mm256_fmsub_ps(_mm256_set1_ps(node.BoundsMax.z), packet.InvDirZ, packet.ScaledOriginZ);
+
+			__m256 tMin = _mm256_max_ps(_mm256_min_ps(tx0, tx1), _mm256_setzero_ps());
+			tMin = _mm256_max_ps(tMin, _mm256_min_ps(ty0, ty1));
+			tMin = _mm256_max_ps(tMin, _mm256_min_ps(tz0, tz1));
+
+			__m256 tMax = _mm256_min_ps(_mm256_max_ps(tx0, tx1), packet.TMax);
+			tMax = _mm256_min_ps(tMax, _mm256_max_ps(ty0, ty1));
+			tMax = _mm256_min_ps(tMax, _mm256_max_ps(tz0, tz1));
+
+			const __m256 hit = _mm256_cmp_ps(tMin, tMax, _CMP_LE_OQ);
+			tEnter = _mm256_blendv_ps(_mm256_set1_ps(FLT_MAX), tMin, hit);
+			return _mm256_movemask_ps(hit);
+		}
+
+		float MinEntry(const __m256 tEnter)
+		{
+			__m128 result = _mm_min_ps(_mm256_castps256_ps128(tEnter), _mm256_extractf128_ps(tEnter, 1));
+			result = _mm_min_ps(result, _mm_movehl_ps(result, result));
+			result = _mm_min_ss(result, _mm_shuffle_ps(result, result, 1));
+			return _mm_cvtss_f32(result);
+		}
+
+		// A ray traversed on its own. InvDir and ScaledOrigin hold x, y, z and 0 twice, to test the two children
+		// of a node at once.
+		struct SingleRay
+		{
+			float Origin[3];
+			float Dir[3];
+			__m256 InvDir;
+			__m256 ScaledOrigin;
+		};
+
+		// Returns bit 0 when the ray enters children[0] before rayTMax, bit 1 for children[1], and the entry
+		// distances in lanes 0 and 4.
+		int IntersectChildren(const SingleRay& ray, const BvhNode* children, const float rayTMax, __m256& tEnter)
+		{
+			const __m256 boundsMin = _mm256_set_m128(_mm_load_ps(&children[1].BoundsMin.x),
+			                                         _mm_load_ps(&children[0].BoundsMin.x));
+			const __m256 boundsMax = _mm256_set_m128(_mm_load_ps(&children[1].BoundsMax.x),
+			                                         _mm_load_ps(&children[0].BoundsMax.x));
+			// Lanes 3 and 7 read LeftFirst and TriangleCount, far too small to be infinite or NaN once seen as
+			// floats : times 0, their distances are 0.
+			const __m256 t0 = _mm256_fmsub_ps(boundsMin, ray.InvDir, ray.ScaledOrigin);
+			const __m256 t1 = _mm256_fmsub_ps(boundsMax, ray.InvDir, ray.ScaledOrigin);
+
+			__m256 tMin = _mm256_min_ps(t0, t1);
+			__m256 tMax = _mm256_blend_ps(_mm256_max_ps(t0, t1), _mm256_set1_ps(rayTMax), 0x88);
+			tMin = _mm256_max_ps(tMin, _mm256_permute_ps(tMin, _MM_SHUFFLE(1, 0, 3, 2)));
+			tMin = _mm256_max_ps(tMin, _mm256_permute_ps(tMin, _MM_SHUFFLE(2, 3, 0, 1)));
+			tMax = _mm256_min_ps(tMax, _mm256_permute_ps(tMax, _MM_SHUFFLE(1, 0, 3, 2)));
+			tMax = _mm256_min_ps(tMax, _mm256_permute_ps(tMax, _MM_SHUFFLE(2, 3, 0, 1)));
+
+			tEnter = tMin;
+			const int mask = _mm256_movemask_ps(_mm256_cmp_ps(tMin, tMax, _CMP_LE_OQ));
+			return (mask & 1) | ((mask >> 3) & 2);
+		}
+
+		// Packets whose rays do not all go the same way visit many nodes for one or two lanes, they are traced ray
+		// by ray instead.
+		bool IsCoherent(const Ray* rays, const uint32_t count)
+		{
+			const auto octant = [](const Ray& ray)
+			{
+				return (ray.Direction.x < 0.f ? 1 : 0) | (ray.Direction.y < 0.f ? 2 : 0) | (ray.Direction.z < 0.f ? 4 : 0);
+			};
+			const int first = octant(rays[0]);
+			for (uint32_t i = 1; i < count; ++i)
+			{
+				if (octant(rays[i]) != first)
+					return false;
+			}
+			return true;
+		}
+	}
+
+	void MeshBvh::Build(const std::vector<DirectX::XMFLOAT3>& positions, const std::vector<uint32_t>& indices)
+	{
+		m_Nodes.clear();
+		m_Triangles.clear();
+		m_TriangleIndices.clear();
+		m_Depth = 0;
+
+		const auto triangleCount = static_cast<uint32_t>(indices.size() / 3);
+		if (triangleCount == 0)
+			return;
+
+		std::vector<DirectX::XMFLOAT3> centroids(triangleCount);
+		std::vector<DirectX::XMFLOAT3> triMin(triangleCount);
+		std::vector<DirectX::XMFLOAT3> triMax(triangleCount);
+		for (uint32_t i = 0; i < triangleCount; ++i)
+		{
+			const DirectX::XMFLOAT3& a = positions[indices[i * 3 + 0]];
+			const DirectX::XMFLOAT3& b = positions[indices[i * 3 + 1]];
+			const DirectX::XMFLOAT3& c = positions[indices[i * 3 + 2]];
+			triMin[i] = {std::min({a.x, b.x, c.x}), std::min({a.y, b.y, c.y}), std::min({a.z, b.z, c.z})};
+			triMax[i] = {std::max({a.x, b.x, c.x}), std::max({a.y, b.y, c.y}), std::max({a.z, b.z, c.z})};
+			centroids[i] = {(a.x + b.x + c.x) / 3.f, (a.y + b.y + c.y) / 3.f, (a.z + b.z + c.z) / 3.f};
+		}
+
+		m_TriangleIndices.resize(triangleCount);
+		std::iota(m_TriangleIndices.begin(), m_TriangleIndices.end(), 0u);
+
+		m_Nodes.reserve(triangleCount * 2);
+		m_Nodes.push_back({});
+		m_Nodes[0].LeftFirst = 0;
+		m_Nodes[0].TriangleCount = triangleCount;
+		UpdateNodeBounds(0, triMin, triMax);
+		Subdivide(0, centroids, triMin, triMax);
+		m_Nodes.shrink_to_fit();
+
+		// Store the triangles in leaf order so a leaf reads one contiguous range.
+		m_Triangles.resize(triangleCount);
+		for (uint32_t i = 0; i < triangleCount; ++i)
+		{
+			const uint32_t triangle = m_TriangleIndices[i];
+			const DirectX::XMFLOAT3& a = positions[indices[triangle * 3 + 0]];
+			const DirectX::XMFLOAT3& b = positions[indices[triangle * 3 + 1]];
+			const DirectX::XMFLOAT3& c = positions[indices[triangle * 3 + 2]];
+			m_Triangles[i].V0 = a;
+			m_Triangles[i].Edge1 = {b.x - a.x, b.y - a.y, b.z - a.z};
+			m_Triangles[i].Edge2 = {c.x - a.x, c.y - a.y, c.z - a.z};
+		}
+
+		const BvhNode& root = m_Nodes[0];
+		m_Bounds.Center = {
+			(root.BoundsMin.x + root.BoundsMax.x) * 0.5f, (root.BoundsMin.y + root.BoundsMax.y) * 0.5f,
+			(root.BoundsMin.z + root.BoundsMax.z) * 0.5f
+		};
+		m_Bounds.Extents = {
+			(root.BoundsMax.x - root.BoundsMin.x) * 0.5f, (root.BoundsMax.y - root.BoundsMin.y) * 0.5f,
+			(root.BoundsMax.z - root.BoundsMin.z) * 0.5f
+		};
+	}
+
+	void MeshBvh::UpdateNodeBounds(const uint32_t nodeIndex, const std::vector<DirectX::XMFLOAT3>& triMin,
+	                               const std::vector<DirectX::XMFLOAT3>& triMax)
+	{
+		BvhNode& node = m_Nodes[nodeIndex];
+		node.BoundsMin = {FLT_MAX, FLT_MAX, FLT_MAX};
+		node.BoundsMax = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+		for (uint32_t i = 0; i < node.TriangleCount; ++i)
+		{
+			const uint32_t triangle = m_TriangleIndices[node.LeftFirst + i];
+			Grow(node.BoundsMin, node.BoundsMax, triMin[triangle], triMax[triangle]);
+		}
+	}
+
+	void MeshBvh::Subdivide(const uint32_t rootIndex, const std::vector<DirectX::XMFLOAT3>& centroids,
+	                        const std::vector<DirectX::XMFLOAT3>& triMin, const std::vector<DirectX::XMFLOAT3>& triMax)
+	{
+		// Nodes to split, with their depth.
+		std::vector<std::pair<uint32_t, uint32_t>> stack = {{rootIndex, 0}};
+		while (!stack.empty())
+		{
+			const auto [nodeIndex, depth] = stack.back();
+			stack.pop_back();
+			m_Depth = std::max(m_Depth, depth);
+
+			const uint32_t first = m_Nodes[nodeIndex].LeftFirst;
+			const uint32_t count = m_Nodes[nodeIndex].TriangleCount;
+			if (count <= 1 || depth >= k_MaxDepth)
+				continue;
+
+			// Bin the centroids along every axis and keep the cheapest SAH split plane.
+			DirectX::XMFLOAT3 centroidMin = {FLT_MAX, FLT_MAX, FLT_MAX};
+			DirectX::XMFLOAT3 centroidMax = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				const DirectX::XMFLOAT3& c = centroids[m_TriangleIndices[first + i]];
+				Grow(centroidMin, centroidMax, c, c);
+			}
+
+			int bestAxis = -1;
+			uint32_t bestSplit = 0;
+			float bestCost = FLT_MAX;
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				const float axisMin = GetAxis(centroidMin, axis);
+				const float extent = GetAxis(centroidMax, axis) - axisMin;
+				if (extent <= 1e-8f)
+					continue;
+
+				Bin bins[k_BinCount];
+				const float scale = k_BinCount / extent;
+				for (uint32_t i = 0; i < count; ++i)
+				{
+					const uint32_t triangle = m_TriangleIndices[first + i];
+					const uint32_t binIndex = std::min(k_BinCount - 1,
+					                                   static_cast<uint32_t>((GetAxis(centroids[triangle], axis) - axisMin) * scale));
+					++bins[binIndex].Count;
+					Grow(bins[binIndex].Min, bins[binIndex].Max, triMin[triangle], triMax[triangle]);
+				}
+
+				float leftArea[k_BinCount - 1], rightArea[k_BinCount - 1];
+				uint32_t leftCount[k_BinCount - 1], rightCount[k_BinCount - 1];
+				Bin left, right;
+				for (uint32_t i = 0; i < k_BinCount - 1; ++i)
+				{
+					left.Count += bins[i].Count;
+					Grow(left.Min, left.Max, bins[i].Min, bins[i].Max);
+					leftCount[i] = left.Count;
+					leftArea[i] = left.Count ? SurfaceArea(left.Min, left.Max) : 0.f;
+
+					const uint32_t j = k_BinCount - 1 - i;
+					right.Count += bins[j].Count;
+					Grow(right.Min, right.Max, bins[j].Min, bins[j].Max);
+					rightCount[j - 1] = right.Count;
+					rightArea[j - 1] = right.Count ? SurfaceArea(right.Min, right.Max) : 0.f;
+				}
+
+				for (uint32_t i = 0; i < k_BinCount - 1; ++i)
+				{
+					const float cost = leftCount[i] * leftArea[i] + rightCount[i] * rightArea[i];
+					if (leftCount[i] > 0 && rightCount[i] > 0 && cost < bestCost)
+					{
+						bestCost = cost;
+						bestAxis = axis;
+						bestSplit = i + 1;
+					}
+				}
+			}
+
+			// Splitting costs one extra box test per ray reaching this node.
+			const float nodeArea = SurfaceArea(m_Nodes[nodeIndex].BoundsMin, m_Nodes[nodeIndex].BoundsMax);
+			if (bestAxis < 0 || (bestCost + k_TraversalCost * nodeArea >= count * nodeArea && count <= k_MaxLeafTriangles))
+				continue;
+
+			const float axisMin = GetAxis(centroidMin, bestAxis);
+			const float scale = k_BinCount / (GetAxis(centroidMax, bestAxis) - axisMin);
+			const auto middle = std::partition(m_TriangleIndices.begin() + first,
+			                                   m_TriangleIndices.begin() + first + count,
+			                                   [&](const uint32_t triangle)
+			                                   {
+				                                   const auto binIndex = std::min(
+					                                   k_BinCount - 1, static_cast<uint32_t>(
+						                                   (GetAxis(centroids[triangle], bestAxis) - axisMin) * scale));
+				                                   return binIndex < bestSplit;
+			                                   });
+			const auto leftCount = static_cast<uint32_t>(middle - (m_TriangleIndices.begin() + first));
+			if (leftCount == 0 || leftCount == count)
+				continue;
+
+			const auto leftIndex = static_cast<uint32_t>(m_Nodes.size());
+			m_Nodes.push_back({});
+			m_Nodes.push_back({});
+			m_Nodes[leftIndex].LeftFirst = first;
+			m_Nodes[leftIndex].TriangleCount = leftCount;
+			m_Nodes[leftIndex + 1].LeftFirst = first + leftCount;
+			m_Nodes[leftIndex + 1].TriangleCount = count - leftCount;
+			m_Nodes[nodeIndex].LeftFirst = leftIndex;
+			m_Nodes[nodeIndex].TriangleCount = 0;
+
+			UpdateNodeBounds(leftIndex, triMin, triMax);
+			UpdateNodeBounds(leftIndex + 1, triMin, triMax);
+			stack.push_back({leftIndex, depth + 1});
+			stack.push_back({leftIndex + 1, depth + 1});
+		}
+	}
+
+	uint64_t MeshBvh::ComputeHash() const
+	{
+		// FNV-1a over the triangles, the build is deterministic so the same mesh always gives the same order.
+		uint64_t hash = 0xCBF29CE484222325ull;
+		const auto* bytes = reinterpret_cast<const uint8_t*>(m_Triangles.data());
+		for (size_t i = 0; i < m_Triangles.size() * sizeof(Triangle); ++i)
+			hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+		return hash;
+	}
+
+	bool MeshBvh::Intersect(const Ray& ray, RayHit& hit) const
+	{
+		hit = RayHit();
+		if (m_Nodes.empty())
+			return false;
+
+		hit.T = ray.TMax;
+		IntersectSingle(ray, 0, hit);
+		if (!hit.HasHit())
+		{
+			hit.T = FLT_MAX;
+			return false;
+		}
+		hit.TriangleIndex = m_TriangleIndices[hit.TriangleIndex];
+		return true;
+	}
+
+	uint32_t MeshBvh::Intersect(const Ray* rays, RayHit* hits, const uint32_t count) const
+	{
+		uint32_t hitCount = 0;
+		for (uint32_t i = 0; i < count; i += k_PacketSize)
+		{
+			const uint32_t packetCount = std::min(k_PacketSize, count - i);
+			if (m_Nodes.empty() || packetCount == 1 || !IsCoherent(rays + i, packetCount))
+			{
+				for (uint32_t lane = 0; lane < packetCount; ++lane)
+					hitCount += Intersect(rays[i + lane], hits[i + lane]) ? 1 : 0;
+				continue;
+			}
+
+			for (uint32_t lane = 0; lane < packetCount; ++lane)
+				hits[i + lane] = RayHit();
+			IntersectPacket(rays + i, hits + i, packetCount);
+			for (uint32_t lane = 0; lane < packetCount; ++lane)
+				hitCount += hits[i + lane].HasHit() ? 1 : 0;
+		}
+		return hitCount;
+	}
+
+	void MeshBvh::IntersectSingle(const Ray& ray, const uint32_t nodeIndex, RayHit& hit) const
+	{
+		SingleRay single;
+		const float* origin = &ray.Origin.x;
+		const float* direction = &ray.Direction.x;
+		alignas(32) float invDir[8] = {}, scaledOrigin[8] = {};
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			single.Origin[axis] = origin[axis];
+			single.Dir[axis] = direction[axis];
+			invDir[axis] = invDir[axis + 4] = 1.f / direction[axis];
+			scaledOrigin[axis] = scaledOrigin[axis + 4] = origin[axis] * invDir[axis];
+		}
+		single.InvDir = _mm256_load_ps(invDir);
+		single.ScaledOrigin = _mm256_load_ps(scaledOrigin);
+
+		uint32_t stack[k_MaxDepth + 1];
+		uint32_t stackSize = 0;
+
+		// The node is not tested itself, the packet entered it or it is the root whose children are tested next.
+		stack[stackSize++] = nodeIndex;
+
+		while (stackSize > 0)
+		{
+			const BvhNode& node = m_Nodes[stack[--stackSize]];
+
+			if (node.IsLeaf())
+			{
+				for (uint32_t i = 0; i < node.TriangleCount; ++i)
+				{
+					// Moller-Trumbore, the same operations as the packets'.
+					const Triangle& tri = m_Triangles[node.LeftFirst + i];
+					const float px = single.Dir[1] * tri.Edge2.z - single.Dir[2] * tri.Edge2.y;
+					const float py = single.Dir[2] * tri.Edge2.x - single.Dir[0] * tri.Edge2.z;
+					const float pz = single.Dir[0] * tri.Edge2.y - single.Dir[1] * tri.Edge2.x;
+					const float det = tri.Edge1.x * px + tri.Edge1.y * py + tri.Edge1.z * pz;
+					const float invDet = 1.f / det;
+
+					const float tx = single.Origin[0] - tri.V0.x;
+					const float ty = single.Origin[1] - tri.V0.y;
+					const float tz = single.Origin[2] - tri.V0.z;
+					const float u = (tx * px + ty * py + tz * pz) * invDet;
+
+					const float qx = ty * tri.Edge1.z - tz * tri.Edge1.y;
+					const float qy = tz * tri.Edge1.x - tx * tri.Edge1.z;
+					const float qz = tx * tri.Edge1.y - ty * tri.Edge1.x;
+					const float v = (single.Dir[0] * qx + single.Dir[1] * qy + single.Dir[2] * qz) * invDet;
+					const float t = (tri.Edge2.x * qx + tri.Edge2.y * qy + tri.Edge2.z * qz) * invDet;
+
+					if (std::fabs(det) > 1e-7f && u >= 0.f && v >= 0.f && u + v <= 1.f && t > 1e-7f && t < hit.T)
+					{
+						hit.T = t;
+						hit.U = u;
+						hit.V = v;
+						hit.TriangleIndex = node.LeftFirst + i;
+					}
+				}
+				continue;
+			}
+
+			__m256 tEnter;
+			const int mask = IntersectChildren(single, &m_Nodes[node.LeftFirst], hit.T, tEnter);
+			const bool hitsLeft = mask & 1;
+			const bool hitsRight = mask & 2;
+			if (hitsLeft && hitsRight)
+			{
+				const bool leftFirst = _mm256_cvtss_f32(tEnter) <= _mm_cvtss_f32(_mm256_extractf128_ps(tEnter, 1));
+				stack[stackSize++] = leftFirst ? node.LeftFirst + 1 : node.LeftFirst;
+				stack[stackSize++] = leftFirst ? node.LeftFirst : node.LeftFirst + 1;
+			}
+			else if (hitsLeft)
+				stack[stackSize++] = node.LeftFirst;
+			else if (hitsRight)
+				stack[stackSize++] = node.LeftFirst + 1;
+		}
+	}
+
+	void MeshBvh::IntersectPacket(const Ray* rays, RayHit* hits, const uint32_t count) const
+	{
+		alignas(32) float data[10][k_PacketSize];
+		for (uint32_t lane = 0; lane < k_PacketSize; ++lane)
+		{
+			// Unused lanes get a negative TMax so they never enter a box.
+			const Ray& ray = rays[lane < count ? lane : 0];
+			data[0][lane] = ray.Origin.x;
+			data[1][lane] = ray.Origin.y;
+			data[2][lane] = ray.Origin.z;
+			data[3][lane] = ray.Direction.x;
+			data[4][lane] = ray.Direction.y;
+			data[5][lane] = ray.Direction.z;
+			data[6][lane] = 1.f / ray.Direction.x;
+			data[7][lane] = 1.f / ray.Direction.y;
+			data[8][lane] = 1.f / ray.Direction.z;
+			data[9][lane] = lane < count ? ray.TMax : -1.f;
+		}
+
+		RayPacket packet;
+		packet.OriginX = _mm256_load_ps(data[0]);
+		packet.OriginY = _mm256_load_ps(data[1]);
+		packet.OriginZ = _mm256_load_ps(data[2]);
+		packet.DirX = _mm256_load_ps(data[3]);
+		packet.DirY = _mm256_load_ps(data[4]);
+		packet.DirZ = _mm256_load_ps(data[5]);
+		packet.InvDirX = _mm256_load_ps(data[6]);
+		packet.InvDirY = _mm256_load_ps(data[7]);
+		packet.InvDirZ = _mm256_load_ps(data[8]);
+		packet.ScaledOriginX = _mm256_mul_ps(packet.OriginX, packet.InvDirX);
+		packet.ScaledOriginY = _mm256_mul_ps(packet.OriginY, packet.InvDirY);
+		packet.ScaledOriginZ = _mm256_mul_ps(packet.OriginZ, packet.InvDirZ);
+		packet.TMax = _mm256_load_ps(data[9]);
+		packet.U = _mm256_setzero_ps();
+		packet.V = _mm256_setzero_ps();
+		packet.TriangleIndex = _mm256_set1_epi32(static_cast<int>(RayHit::k_NoHit));
+
+		const __m256 epsilon = _mm256_set1_ps(1e-7f);
+		const __m256 zero = _mm256_setzero_ps();
+		const __m256 one = _mm256_set1_ps(1.f);
+		const __m256 signMask = _mm256_set1_ps(-0.f);
+
+		// Going down a level pops a node and pushes at most two, so k_MaxDepth levels leave at most
+		// k_MaxDepth + 1 nodes on the stack.
+		uint32_t stack[k_MaxDepth + 1];
+		uint32_t stackSize = 0;
+
+		__m256 tEnter;
+		if (IntersectAabb(packet, m_Nodes[0], tEnter))
+			stack[stackSize++] = 0;
+
+		while (stackSize > 0)
+		{
+			const uint32_t nodeIndex = stack[--stackSize];
+			const BvhNode& node = m_Nodes[nodeIndex];
+
+			if (node.IsLeaf())
+			{
+				for (uint32_t i = 0; i < node.TriangleCount; ++i)
+				{
+					const Triangle& tri = m_Triangles[node.LeftFirst + i];
+					const __m256 e1x = _mm256_set1_ps(tri.Edge1.x), e1y = _mm256_set1_ps(tri.Edge1.y), e1z = _mm256_set1_ps(tri.Edge1.z);
+					const __m256 e2x = _mm256_set1_ps(tri.Edge2.x), e2y = _mm256_set1_ps(tri.Edge2.y), e2z = _mm256_set1_ps(tri.Edge2.z);
+
+					// Moller-Trumbore, one triangle against the 8 rays.
+					const __m256 px = _mm256_sub_ps(_mm256_mul_ps(packet.DirY, e2z), _mm256_mul_ps(packet.DirZ, e2y));
+					const __m256 py = _mm256_sub_ps(_mm256_mul_ps(packet.DirZ, e2x), _mm256_mul_ps(packet.DirX, e2z));
+					const __m256 pz = _mm256_sub_ps(_mm256_mul_ps(packet.DirX, e2y), _mm256_mul_ps(packet.DirY, e2x));
+					const __m256 det = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e1x, px), _mm256_mul_ps(e1y, py)),
+					                                 _mm256_mul_ps(e1z, pz));
+					const __m256 invDet = _mm256_div_ps(one, det);
+
+					const __m256 tx = _mm256_sub_ps(packet.OriginX, _mm256_set1_ps(tri.V0.x));
+					const __m256 ty = _mm256_sub_ps(packet.OriginY, _mm256_set1_ps(tri.V0.y));
+					const __m256 tz = _mm256_sub_ps(packet.OriginZ, _mm256_set1_ps(tri.V0.z));
+					const __m256 u = _mm256_mul_ps(
+						_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(tx, px), _mm256_mul_ps(ty, py)), _mm256_mul_ps(tz, pz)),
+						invDet);
+
+					const __m256 qx = _mm256_sub_ps(_mm256_mul_ps(ty, e1z), _mm256_mul_ps(tz, e1y));
+					const __m256 qy = _mm256_sub_ps(_mm256_mul_ps(tz, e1x), _mm256_mul_ps(tx, e1z));
+					const __m256 qz = _mm256_sub_ps(_mm256_mul_ps(tx, e1y), _mm256_mul_ps(ty, e1x));
+					const __m256 v = _mm256_mul_ps(
+						_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(packet.DirX, qx), _mm256_mul_ps(packet.DirY, qy)),
+						              _mm256_mul_ps(packet.DirZ, qz)), invDet);
+					const __m256 t = _mm256_mul_ps(
+						_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e2x, qx), _mm256_mul_ps(e2y, qy)), _mm256_mul_ps(e2z, qz)),
+						invDet);
+
+					__m256 mask = _mm256_cmp_ps(_mm256_andnot_ps(signMask, det), epsilon, _CMP_GT_OQ);
+					mask = _mm256_and_ps(mask, _mm256_cmp_ps(u, zero, _CMP_GE_OQ));
+					mask = _mm256_and_ps(mask, _mm256_cmp_ps(v, zero, _CMP_GE_OQ));
+					mask = _mm256_and_ps(mask, _mm256_cmp_ps(_mm256_add_ps(u, v), one, _CMP_LE_OQ));
+					mask = _mm256_and_ps(mask, _mm256_cmp_ps(t, epsilon, _CMP_GT_OQ));
+					mask = _mm256_and_ps(mask, _mm256_cmp_ps(t, packet.TMax, _CMP_LT_OQ));
+					if (_mm256_movemask_ps(mask) == 0)
+						continue;
+
+					packet.TMax = _mm256_blendv_ps(packet.TMax, t, mask);
+					packet.U = _mm256_blendv_ps(packet.U, u, mask);
+					packet.V = _mm256_blendv_ps(packet.V, v, mask);
+					packet.TriangleIndex = _mm256_castps_si256(_mm256_blendv_ps(
+						_mm256_castsi256_ps(packet.TriangleIndex),
+						_mm256_castsi256_ps(_mm256_set1_epi32(static_cast<int>(node.LeftFirst + i))), mask));
+				}
+				continue;
+			}
+
+			// Test both children here so the nearest one is visited first.
+			__m256 tLeft, tRight;
+			const int leftMask = IntersectAabb(packet, m_Nodes[node.LeftFirst], tLeft);
+			const int rightMask = IntersectAabb(packet, m_Nodes[node.LeftFirst + 1], tRight);
+			const int mask = leftMask | rightMask;
+			if (mask == 0)
+				continue;
+
+			// The packet diverged down to one ray, which goes on alone rather than with 7 idle lanes.
+			if ((mask & (mask - 1)) == 0)
+			{
+				const int lane = std::countr_zero(static_cast<uint32_t>(mask));
+				alignas(32) float tMax[k_PacketSize], u[k_PacketSize], v[k_PacketSize];
+				alignas(32) uint32_t triangleIndex[k_PacketSize];
+				_mm256_store_ps(tMax, packet.TMax);
+				_mm256_store_ps(u, packet.U);
+				_mm256_store_ps(v, packet.V);
+				_mm256_store_si256(reinterpret_cast<__m256i*>(triangleIndex), packet.TriangleIndex);
+
+				RayHit hit;
+				hit.T = tMax[lane];
+				hit.U = u[lane];
+				hit.V = v[lane];
+				hit.TriangleIndex = triangleIndex[lane];
+				IntersectSingle(rays[lane], nodeIndex, hit);
+				tMax[lane] = hit.T;
+				u[lane] = hit.U;
+				v[lane] = hit.V;
+				triangleIndex[lane] = hit.TriangleIndex;
+
+				packet.TMax = _mm256_load_ps(tMax);
+				packet.U = _mm256_load_ps(u);
+				packet.V = _mm256_load_ps(v);
+				packet.TriangleIndex = _mm256_load_si256(reinterpret_cast<const __m256i*>(triangleIndex));
+				continue;
+			}
+
+			if (leftMask && rightMask)
+			{
+				const bool leftFirst = MinEntry(tLeft) <= MinEntry(tRight);
+				stack[stackSize++] = leftFirst ? node.LeftFirst + 1 : node.LeftFirst;
+				stack[stackSize++] = leftFirst ? node.LeftFirst : node.LeftFirst + 1;
+			}
+			else if (leftMask)
+				stack[stackSize++] = node.LeftFirst;
+			else
+				stack[stackSize++] = node.LeftFirst + 1;
+		}
+
+		alignas(32) float tMax[k_PacketSize], u[k_PacketSize], v[k_PacketSize];
+		alignas(32) uint32_t triangleIndex[k_PacketSize];
+		_mm256_store_ps(tMax, packet.TMax);
+		_mm256_store_ps(u, packet.U);
+		_mm256_store_ps(v, packet.V);
+		_mm256_store_si256(reinterpret_cast<__m256i*>(triangleIndex), packet.TriangleIndex);
+		for (uint32_t lane = 0; lane < count; ++lane)
+		{
+			if (triangleIndex[lane] == RayHit::k_NoHit)
+				continue;
+			hits[lane].T = tMax[lane];
+			hits[lane].U = u[lane];
+			hits[lane].V = v[lane];
+			hits[lane].TriangleIndex = m_TriangleIndices[triangleIndex[lane]];
+		}
+	}
+}
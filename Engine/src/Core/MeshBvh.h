@@ -0,0 +1,108 @@
+#pragma once
+#include <cfloat>
+#include <cstdint>
+#include <vector>
+#include <DirectXMath.h>
+#include <DirectXCollision.h>
+
+namespace Engine
+{
+	struct Ray
+	{
+		DirectX::XMFLOAT3 Origin = {0.f, 0.f, 0.f};
+		DirectX::XMFLOAT3 Direction = {0.f, 0.f, 1.f};
+		float TMax = FLT_MAX;
+	};
+
+	struct RayHit
+	{
+		static constexpr uint32_t k_NoHit = UINT32_MAX;
+
+		float T = FLT_MAX;
+		float U = 0.f;
+		float V = 0.f;
+		uint32_t TriangleIndex = k_NoHit;
+
+		bool HasHit() const { return TriangleIndex != k_NoHit; }
+	};
+
+	/// <summary>
+	/// Compact BVH node : interior nodes store the index of their left child (the right one follows it),
+	/// leaves store the first triangle of their range and a non-zero triangle count.
+	/// </summary>
+	struct alignas(32) BvhNode
+	{
+		DirectX::XMFLOAT3 BoundsMin;
+		uint32_t LeftFirst;
+		DirectX::XMFLOAT3 BoundsMax;
+		uint32_t TriangleCount;
+
+		bool IsLeaf() const { return TriangleCount > 0; }
+	};
+
+	static_assert(sizeof(BvhNode) == 32, "BvhNode must stay 32 bytes.");
+
+	/// <summary>
+	/// Static triangle BVH built with a binned SAH, traversed by packets of 8 rays with AVX2. Rays that do not go
+	/// the same way, and the last ray of a packet left in a subtree, are traversed one by one.
+	/// </summary>
+	class MeshBvh
+	{
+	public:
+		static constexpr uint32_t k_BinCount = 8;
+		static constexpr uint32_t k_MaxLeafTriangles = 4;
+		// Nodes this deep become leaves whatever their triangle count, the traversal stack holds one node per level.
+		static constexpr uint32_t k_MaxDepth = 63;
+		static constexpr uint32_t k_PacketSize = 8;
+		static constexpr float k_TraversalCost = 1.f;
+
+		/// <summary>
+		/// Builds the hierarchy over an indexed triangle list.
+		/// </summary>
+		/// <param name="positions"> : vertex positions in mesh local space</param>
+		/// <param name="indices"> : three indices per triangle</param>
+		void Build(const std::vector<DirectX::XMFLOAT3>& positions, const std::vector<uint32_t>& indices);
+
+		/// <returns> True if the ray hit a triangle closer than ray.TMax. </returns>
+		bool Intersect(const Ray& ray, RayHit& hit) const;
+
+		/// <summary>
+		/// Intersects a batch of rays, traversing them 8 by 8 as SIMD packets when they go the same way.
+		/// </summary>
+		/// <returns> The number of rays that hit the mesh. </returns>
+		uint32_t Intersect(const Ray* rays, RayHit* hits, uint32_t count) const;
+
+		bool IsEmpty() const { return m_Nodes.empty(); }
+		const DirectX::BoundingBox& GetBounds() const { return m_Bounds; }
+		uint32_t GetNodeCount() const { return static_cast<uint32_t>(m_Nodes.size()); }
+		uint32_t GetTriangleCount() const { return static_cast<uint32_t>(m_Triangles.size()); }
+		/// <returns> The depth of the deepest leaf, 0 when the root is one. </returns>
+		uint32_t GetDepth() const { return m_Depth; }
+		/// <returns> A hash of the triangles, to tell whether data baked from the mesh is still up to date. </returns>
+		uint64_t ComputeHash() const;
+
+	private:
+		struct Triangle
+		{
+			DirectX::XMFLOAT3 V0;
+			DirectX::XMFLOAT3 Edge1;
+			DirectX::XMFLOAT3 Edge2;
+		};
+
+		void UpdateNodeBounds(uint32_t nodeIndex, const std::vector<DirectX::XMFLOAT3>& triMin,
+		                      const std::vector<DirectX::XMFLOAT3>& triMax);
+		void Subdivide(uint32_t nodeIndex, const std::vector<DirectX::XMFLOAT3>& centroids,
+		               const std::vector<DirectX::XMFLOAT3>& triMin, const std::vector<DirectX::XMFLOAT3>& triMax);
+		// hit.T is the closest hit so far, hit.TriangleIndex is in m_Triangles' order.
+		void IntersectSingle(const Ray& ray, uint32_t nodeIndex, RayHit& hit) const;
+		void IntersectPacket(const Ray* rays, RayHit* hits, uint32_t count) const;
+
+		std::vector<BvhNode> m_Nodes;
+		std::vector<Triangle> m_Triangles;
+		// Original triangle index of each (reordered) triangle of m_Triangles.
+		std::vector<uint32_t> m_TriangleIndices;
+		uint32_t m_Depth = 0;
+
+		DirectX::BoundingBox m_Bounds;
+	};
+}
@@ -1,7 +1,7 @@
 #include "MeshRenderer.h"
 
-#include "Renderer/DirectXContext.h"
 #include "Renderer/DirectXMesh.h"
+#include "Renderer/DrawQueue.h"
 #include "Renderer/Materials/DirectXMaterial.h"
 
 namespace Engine
@@ -9,18 +9,10 @@ namespace Engine
 	MeshRenderer::MeshRenderer(DirectXMesh* mesh, DirectXMaterial* material = nullptr)
 		: m_Mesh(mesh), m_Material(material)
 	{
-		m_ConstantBuffer = std::make_unique<UploadBuffer<ObjectConstants>>(DirectXContext::Get()->m_Device.Get(), 1, true);
 	}
 
-	void MeshRenderer::Draw(const DirectX::XMFLOAT4X4& transformMatrix)
+	void MeshRenderer::Draw(DrawQueue& queue, const uint32_t objectId, const float depth)
 	{
-		const DirectX::XMMATRIX world = XMLoadFloat4x4(&transformMatrix);
-		ObjectConstants objConstants;
-		XMStoreFloat4x4(&objConstants.World, XMMatrixTranspose(world));
-		m_ConstantBuffer->CopyData(0, objConstants);
-
-		m_Material->Bind(*m_ConstantBuffer);
-
-		m_Mesh->Draw();
+		queue.Submit(m_Mesh, m_Material, objectId, depth);
 	}
 }
\ No newline at end of file
@@ -1,29 +1,32 @@
 #pragma once
 
-#include "Renderer/MathHelper.h"
-#include "Renderer/UploadBuffer.h"
+#include <cstdint>
 
 namespace Engine
 {
 	class DirectXMesh;
 	class DirectXMaterial;
-
-	struct ObjectConstants
-	{
-		DirectX::XMFLOAT4X4 World = MathHelper::Identity4x4();
-	};
+	class DrawQueue;
 
 	class MeshRenderer
 	{
 	public:
 		MeshRenderer(DirectXMesh* mesh, DirectXMaterial* material);
 
-		void Draw(const DirectX::XMFLOAT4X4& transformMatrix);
+		/// <summary>
+		/// Queues the mesh to be drawn with the material, the queue sorts it and merges it with the draws it can be
+		/// instanced with.
+		/// </summary>
+		/// <param name="queue"></param>
+		/// <param name="objectId"> : the drawn Object's element in the GPU object table</param>
+		/// <param name="depth"> : distance from the camera, draws are issued front to back</param>
+		void Draw(DrawQueue& queue, uint32_t objectId, float depth);
+
+		DirectXMesh* GetMesh() const { return m_Mesh; }
+		DirectXMaterial* GetMaterial() const { return m_Material; }
 
 	private:
 		DirectXMesh* m_Mesh;
 		DirectXMaterial* m_Material;
-
-		std::unique_ptr<UploadBuffer<ObjectConstants>> m_ConstantBuffer = nullptr;
 	};
 }
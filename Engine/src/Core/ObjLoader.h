@@ -1,6 +1,6 @@
 #pragma once
 
-#include "Renderer/DirectXFrameData.h"
+#include "Renderer/Vertex.h"
 #include <vector>
 
 namespace Engine
@@ -1,21 +1,34 @@
 #include "Object.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "MeshRenderer.h"
+#include "Renderer/DirectXApi.h"
+#include "Renderer/GpuObjectTable.h"
+#include "Debug/Log.h"
 
 Engine::Object::Object(DirectX::XMFLOAT3 position, DirectXMesh* mesh, DirectXMaterial* material)
 {
 	m_Transform = std::make_unique<Transform>(position);
 	m_Renderer = std::make_unique<MeshRenderer>(mesh, material);
+	m_ObjectId = DirectXContext::Get()->GetObjectTable()->Register(m_Transform.get());
 }
 
 Engine::Object::~Object()
 {
-
+	if (GpuObjectTable* objectTable = DirectXContext::Get()->GetObjectTable())
+		objectTable->Unregister(m_ObjectId);
 }
 
 void Engine::Object::Render()
 {
-	m_Renderer->Draw(m_Transform->GetWorldAsFloat4x4());
+	if (!m_IsVisible || m_Lod == LodSelector::k_Culled)
+		return;
+
+	// The matrix itself is already on the GPU, uploaded by the object table when the Transform changed.
+	MeshRenderer* renderer = m_Lod == 0 ? m_Renderer.get() : m_LodRenderers[m_Lod - 1].get();
+	renderer->Draw(DirectXContext::Get()->GetDrawQueue(), m_ObjectId, m_ViewDepth);
 }
 
 void Engine::Object::GameUpdate(float dt)
@@ -27,3 +40,165 @@ Engine::Transform* Engine::Object::GetTransform()
 {
 	return m_Transform.get();
 }
+
+Engine::DirectXMesh* Engine::Object::GetMesh() const
+{
+	return m_Renderer->GetMesh();
+}
+
+Engine::DirectXMaterial* Engine::Object::GetMaterial() const
+{
+	return m_Renderer->GetMaterial();
+}
+
+DirectX::XMFLOAT4X4 Engine::Object::GetWorldMatrix() const
+{
+	return m_Transform->GetWorldAsFloat4x4();
+}
+
+DirectX::BoundingBox Engine::Object::GetWorldBounds() const
+{
+	DirectX::BoundingBox worldBounds;
+	GetMesh()->GetBounds().Transform(worldBounds, m_Transform->GetWorld());
+	return worldBounds;
+}
+
+DirectX::XMFLOAT4X4 Engine::Object::GetWorldMatrixRelativeTo(const WorldPosition& origin) const
+{
+	DirectX::XMFLOAT4X4 world;
+	DirectX::XMStoreFloat4x4(&world, m_Transform->GetWorldRelativeTo(origin));
+	return world;
+}
+
+void Engine::Object::AddLod(DirectXMesh* mesh, const float geometricError)
+{
+	if (m_LodGroup.LodCount >= LodSelector::k_MaxLods)
+	{
+		CORE_WARN("Object already has %u lods, the new one is ignored.", LodSelector::k_MaxLods);
+		return;
+	}
+
+	m_LodRenderers.push_back(std::make_unique<MeshRenderer>(mesh, m_Renderer->GetMaterial()));
+	m_LodGroup.GeometricErrors[m_LodGroup.LodCount++] = geometricError;
+}
+
+void Engine::Object::CullAndSelectLods(Object* const* objects, const size_t count)
+{
+	LodSelector* selector = DirectXApi::GetLodSelector();
+	const WorldPosition& origin = DirectXApi::GetCameraWorldPosition();
+
+	// Only the visible Objects are gathered, in one array so the selector can split it across its threads. The
+	// arrays only grow, selecting lods stops allocating after the first frames.
+	static std::vector<Object*> visible;
+	static std::vector<DirectX::BoundingSphere> spheres;
+	static std::vector<LodSelector::LodGroup> groups;
+	static std::vector<const LodSelector::LodGroup*> groupPointers;
+	static std::vector<uint8_t> lods;
+	visible.clear();
+	spheres.clear();
+	groups.clear();
+	groupPointers.clear();
+	lods.clear();
+	for (size_t i = 0; i < count; ++i)
+	{
+		Object* object = objects[i];
+
+		// Culled relative to the camera so the float matrices stay precise far from the world origin.
+		const DirectX::XMMATRIX world = object->m_Transform->GetWorldRelativeTo(origin);
+		const DirectX::BoundingBox& localBounds = object->GetMesh()->GetBounds();
+		DirectX::BoundingBox bounds;
+		localBounds.Transform(bounds, world);
+		object->m_IsVisible = DirectXApi::IsVisible(bounds);
+		if (!object->m_IsVisible)
+			continue;
+
+		// The bounds are camera relative, their center's length is the distance the draw is sorted by.
+		object->m_ViewDepth = DirectX::XMVectorGetX(DirectX::XMVector3Length(DirectX::XMLoadFloat3(&bounds.Center)));
+
+		DirectX::BoundingSphere localSphere;
+		DirectX::BoundingSphere::CreateFromBoundingBox(localSphere, localBounds);
+		DirectX::BoundingSphere& sphere = spheres.emplace_back();
+		localSphere.Transform(sphere, world);
+
+		// Errors are given in mesh units, scale them like the sphere.
+		const float scale = localSphere.Radius > 0.f ? sphere.Radius / localSphere.Radius : 1.f;
+		LodSelector::LodGroup& group = groups.emplace_back(object->m_LodGroup);
+		for (uint32_t lod = 0; lod < group.LodCount; ++lod)
+			group.GeometricErrors[lod] *= scale;
+		lods.push_back(object->m_Lod);
+		visible.push_back(object);
+	}
+
+	// Pointed to once every group is in place, the vector may have moved while growing.
+	for (const LodSelector::LodGroup& group : groups)
+		groupPointers.push_back(&group);
+	selector->Select(spheres.data(), groupPointers.data(), lods.data(), static_cast<uint32_t>(visible.size()));
+
+	for (size_t i = 0; i < visible.size(); ++i)
+		visible[i]->m_Lod = lods[i];
+}
+
+bool Engine::Object::Raycast(const Ray& ray, RayHit& hit) const
+{
+	Ray relativeRay = ray;
+	relativeRay.Origin = {0.f, 0.f, 0.f};
+	return Raycast(WorldPosition(ray.Origin), &relativeRay, &hit, 1) == 1;
+}
+
+uint32_t Engine::Object::Raycast(const WorldPosition& origin, const Ray* rays, RayHit* hits, uint32_t count) const
+{
+	// Inverting the float world matrix would lose the mesh's precision far from the world's origin, the
+	// translation relative to the rays is small.
+	const DirectX::XMMATRIX worldToLocal = DirectX::XMMatrixInverse(nullptr, m_Transform->GetWorldRelativeTo(origin));
+	const MeshBvh& bvh = GetMesh()->GetBvh();
+
+	// Directions are not renormalized, so distances along the local rays match the world ones.
+	constexpr uint32_t batchSize = 64;
+	Ray localRays[batchSize];
+	uint32_t hitCount = 0;
+	for (uint32_t first = 0; first < count; first += batchSize)
+	{
+		const uint32_t batchCount = (std::min)(batchSize, count - first);
+		for (uint32_t i = 0; i < batchCount; ++i)
+		{
+			const Ray& ray = rays[first + i];
+			DirectX::XMStoreFloat3(&localRays[i].Origin,
+			                       DirectX::XMVector3TransformCoord(DirectX::XMLoadFloat3(&ray.Origin), worldToLocal));
+			DirectX::XMStoreFloat3(&localRays[i].Direction,
+			                       DirectX::XMVector3TransformNormal(DirectX::XMLoadFloat3(&ray.Direction), worldToLocal));
+			localRays[i].TMax = ray.TMax;
+		}
+		hitCount += bvh.Intersect(localRays, hits + first, batchCount);
+	}
+	return hitCount;
+}
+
+Engine::Object* Engine::Object::Pick(Object* const* objects, size_t count, const Ray& ray, RayHit* outHit)
+{
+	Ray relativeRay = ray;
+	relativeRay.Origin = {0.f, 0.f, 0.f};
+	return Pick(objects, count, WorldPosition(ray.Origin), relativeRay, outHit);
+}
+
+Engine::Object* Engine::Object::Pick(Object* const* objects, size_t count, const WorldPosition& origin, const Ray& ray,
+                                     RayHit* outHit)
+{
+	Object* picked = nullptr;
+	Ray closest = ray;
+	RayHit closestHit;
+	for (size_t i = 0; i < count; ++i)
+	{
+		RayHit hit;
+		if (objects[i] && objects[i]->Raycast(origin, &closest, &hit, 1) == 1)
+		{
+			// Shrinking TMax lets the following BVH traversals stop early.
+			closest.TMax = hit.T;
+			closestHit = hit;
+			picked = objects[i];
+		}
+	}
+
+	if (outHit)
+		*outHit = closestHit;
+	return picked;
+}
@@ -1,6 +1,8 @@
 #pragma once
 #include "Core/Transform.h"
+#include "Core/MeshBvh.h"
 #include "Renderer/DirectXMesh.h"
+#include "Renderer/Culling/LodSelector.h"
 
 namespace Engine {
 
@@ -18,7 +20,9 @@ namespace Engine {
 		~Object();
 
 		/// <summary>
-		/// Call this in between BeginFrame() and EndFrame() to draw the Object's mesh.
+		/// Call this in between BeginFrame() and EndFrame() to draw the Object's mesh. The draw is recorded at
+		/// EndFrame(), instanced with the other Objects sharing its mesh and shader.
+		/// Draws the lod picked by the last CullAndSelectLods(), nothing if it culled the Object.
 		/// </summary>
 		void Render();
 
@@ -31,10 +35,91 @@ namespace Engine {
 		/// <returns> The Object's Transform. </returns>
 		Transform* GetTransform();
 
+		/// <returns> The Object's index in the GPU object table (see GpuObjectTable). </returns>
+		uint32_t GetObjectId() const { return m_ObjectId; }
+
+		/// <returns> The Object's mesh. </returns>
+		DirectXMesh* GetMesh() const;
+
+		/// <returns> The Object's material, nullptr for the default one. </returns>
+		DirectXMaterial* GetMaterial() const;
+
+		/// <returns> The Object's world matrix. </returns>
+		DirectX::XMFLOAT4X4 GetWorldMatrix() const;
+
+		/// <returns> The mesh bounds transformed to world space. </returns>
+		DirectX::BoundingBox GetWorldBounds() const;
+
+		/// <returns> The Object's world matrix in a space centered on origin (see Transform::GetWorldRelativeTo). </returns>
+		DirectX::XMFLOAT4X4 GetWorldMatrixRelativeTo(const WorldPosition& origin) const;
+
+		/// <summary>
+		/// Adds a cheaper version of the mesh, drawn with the Object's material. Lods must be added
+		/// from the most to the least detailed, up to LodSelector::k_MaxLods in total.
+		/// </summary>
+		/// <param name="mesh"></param>
+		/// <param name="geometricError"> : how far, in mesh units, this lod deviates from the original mesh</param>
+		void AddLod(DirectXMesh* mesh, float geometricError);
+
+		/// <returns> The lod drawn by Render(), or LodSelector::k_Culled. </returns>
+		uint8_t GetLod() const { return m_Lod; }
+
+		/// <summary>
+		/// Culls every Object against the view frustum and the occluders, then selects the lod of the visible ones.
+		/// Call it after BeginFrame() and before Render(). Hidden Objects keep their last lod for the hysteresis,
+		/// Objects hidden or too small on screen are skipped by Render().
+		/// </summary>
+		static void CullAndSelectLods(Object* const* objects, size_t count);
+
+		/// <summary>
+		/// Intersects a world space ray with the Object's mesh. The ray is moved to mesh local space
+		/// through the inverse of the Transform relative to the ray's origin, so hit.T stays a world space
+		/// distance along the ray, and the mesh keeps its precision far from the world's origin.
+		/// </summary>
+		/// <returns> True if the ray hit the mesh. </returns>
+		bool Raycast(const Ray& ray, RayHit& hit) const;
+
+		/// <summary>
+		/// Batched version of Raycast, the rays are traversed as SIMD packets.
+		/// </summary>
+		/// <param name="origin"> : the rays' origins are relative to it (ex. the camera position)</param>
+		/// <param name="rays"></param>
+		/// <param name="hits"></param>
+		/// <param name="count"></param>
+		/// <returns> The number of rays that hit the mesh. </returns>
+		uint32_t Raycast(const WorldPosition& origin, const Ray* rays, RayHit* hits, uint32_t count) const;
+
+		/// <summary>
+		/// Finds the closest Object hit by a world space ray.
+		/// </summary>
+		/// <param name="objects"></param>
+		/// <param name="count"></param>
+		/// <param name="ray"></param>
+		/// <param name="outHit"> : optional, receives the closest hit</param>
+		/// <returns> The picked Object, or nullptr. </returns>
+		static Object* Pick(Object* const* objects, size_t count, const Ray& ray, RayHit* outHit = nullptr);
+
+		/// <summary>
+		/// Finds the closest Object hit by a ray relative to origin (ex. DirectXCamera::GetMouseRay() from
+		/// the camera position).
+		/// </summary>
+		static Object* Pick(Object* const* objects, size_t count, const WorldPosition& origin, const Ray& ray,
+		                    RayHit* outHit = nullptr);
+
 	private:
 
 		std::unique_ptr<Transform> m_Transform;
 		std::unique_ptr<MeshRenderer> m_Renderer;
+		uint32_t m_ObjectId;
+
+		// m_Renderer is lod 0, m_LodRenderers[i] is lod i + 1.
+		std::vector<std::unique_ptr<MeshRenderer>> m_LodRenderers;
+		LodSelector::LodGroup m_LodGroup;
+		uint8_t m_Lod = 0;
+		// Set by CullAndSelectLods() for this frame.
+		bool m_IsVisible = false;
+		// Distance from the camera to the bounds' center, the draw is sorted by it.
+		float m_ViewDepth = 0.f;
 	};
 }
 
@@ -0,0 +1,154 @@
+#include "RadixSort.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#include "JobSystem.h"
+
+namespace Engine
+{
+	void RadixSorter::Sort(const uint64_t* pKeys, const uint32_t pCount, uint32_t* pOrder)
+	{
+		m_Stats = Stats();
+		uint64_t varying = 0;
+		for (uint32_t i = 1; i < pCount; ++i)
+			varying |= pKeys[i] ^ pKeys[0];
+		if (!varying)
+		{
+			for (uint32_t i = 0; i < pCount; ++i)
+				pOrder[i] = i;
+			return;
+		}
+
+		// The varying bits are packed at the bottom of the key, in order, which keeps the keys' order.
+		BitRun runs[32];
+		uint32_t runCount = 0;
+		uint32_t keyBits = 0;
+		for (uint32_t bit = 0; bit < 64;)
+		{
+			if (!((varying >> bit) & 1))
+			{
+				++bit;
+				continue;
+			}
+			uint32_t end = bit;
+			while (end < 64 && (varying >> end) & 1)
+				++end;
+			const uint32_t length = end - bit;
+			runs[runCount++] = {bit, length == 64 ? ~0ull : (1ull << length) - 1, keyBits};
+			keyBits += length;
+			bit = end;
+		}
+
+		if (m_ScratchIndices.size() < pCount)
+		{
+			m_ScratchKeys[0].resize(pCount);
+			m_ScratchKeys[1].resize(pCount);
+			m_ScratchIndices.resize(pCount);
+		}
+
+		// When the index fits under the packed key the passes only move one 64 bits word per key, the index
+		// bits are not sorted on : they are unique and already increasing, which is what keeps the sort stable.
+		const uint32_t indexBits = static_cast<uint32_t>(std::bit_width(pCount - 1));
+		const bool packIndex = keyBits + indexBits <= 64;
+		const uint32_t firstBit = packIndex ? indexBits : 0;
+		const uint32_t digitCount = (keyBits + k_DigitBits - 1) / k_DigitBits;
+
+		// Every range of keys has its own histograms, so the ranges are packed, then scattered on every pass, in
+		// parallel. A single range counts every digit while packing, in one read of the keys. Several ranges only
+		// count the first digit there : each pass moves keys between ranges, so later digits are counted per pass.
+		const uint32_t rangeCount = (std::min)(JobSystem::GetThreadCount(), (pCount + k_MinKeysPerJob - 1) / k_MinKeysPerJob);
+		const uint32_t packedDigitCount = rangeCount == 1 ? digitCount : 1;
+		m_Histograms.assign(static_cast<size_t>(rangeCount) * digitCount * k_BucketCount, 0);
+		uint64_t* keys = m_ScratchKeys[0].data();
+		uint32_t* indices = pOrder;
+		JobSystem::ParallelFor(pCount, k_MinKeysPerJob,
+		                       [&](const uint32_t pFirst, const uint32_t pLast, const uint32_t pRange)
+		                       {
+			                       uint32_t* histograms = GetHistogram(pRange, 0, digitCount);
+			                       for (uint32_t i = pFirst; i < pLast; ++i)
+			                       {
+				                       uint64_t key = 0;
+				                       for (uint32_t run = 0; run < runCount; ++run)
+					                       key |= ((pKeys[i] >> runs[run].Shift) & runs[run].Mask) << runs[run].Destination;
+				                       for (uint32_t digit = 0; digit < packedDigitCount; ++digit)
+					                       ++histograms[digit * k_BucketCount + ((key >> (digit * k_DigitBits)) & (k_BucketCount - 1))];
+				                       if (packIndex)
+					                       keys[i] = (key << indexBits) | i;
+				                       else
+				                       {
+					                       keys[i] = key;
+					                       indices[i] = i;
+				                       }
+			                       }
+		                       });
+
+		uint64_t* scratchKeys = m_ScratchKeys[1].data();
+		uint32_t* scratchIndices = m_ScratchIndices.data();
+		for (uint32_t digit = 0; digit < digitCount; ++digit)
+		{
+			const uint32_t shift = firstBit + digit * k_DigitBits;
+			if (digit >= packedDigitCount)
+			{
+				JobSystem::ParallelFor(pCount, k_MinKeysPerJob,
+				                       [&](const uint32_t pFirst, const uint32_t pLast, const uint32_t pRange)
+				                       {
+					                       uint32_t* counts = GetHistogram(pRange, digit, digitCount);
+					                       for (uint32_t i = pFirst; i < pLast; ++i)
+						                       ++counts[(keys[i] >> shift) & (k_BucketCount - 1)];
+				                       });
+			}
+			ComputeOffsets(digit, digitCount, rangeCount);
+			JobSystem::ParallelFor(pCount, k_MinKeysPerJob,
+			                       [&](const uint32_t pFirst, const uint32_t pLast, const uint32_t pRange)
+			                       {
+				                       // Same ranges as the counting, ParallelFor splits the same count the same way.
+				                       uint32_t* offsets = GetHistogram(pRange, digit, digitCount);
+				                       if (packIndex)
+				                       {
+					                       for (uint32_t i = pFirst; i < pLast; ++i)
+						                       scratchKeys[offsets[(keys[i] >> shift) & (k_BucketCount - 1)]++] = keys[i];
+					                       return;
+				                       }
+				                       for (uint32_t i = pFirst; i < pLast; ++i)
+				                       {
+					                       const uint32_t destination = offsets[(keys[i] >> shift) & (k_BucketCount - 1)]++;
+					                       scratchKeys[destination] = keys[i];
+					                       scratchIndices[destination] = indices[i];
+				                       }
+			                       });
+			std::swap(keys, scratchKeys);
+			if (!packIndex)
+				std::swap(indices, scratchIndices);
+		}
+
+		if (packIndex)
+		{
+			const uint64_t indexMask = (1ull << indexBits) - 1;
+			for (uint32_t i = 0; i < pCount; ++i)
+				pOrder[i] = static_cast<uint32_t>(keys[i] & indexMask);
+		}
+		else if (indices != pOrder)
+			std::memcpy(pOrder, indices, pCount * sizeof(uint32_t));
+
+		m_Stats.KeyBits = keyBits;
+		m_Stats.Passes = digitCount;
+	}
+
+	void RadixSorter::ComputeOffsets(const uint32_t pDigit, const uint32_t pDigitCount, const uint32_t pRangeCount)
+	{
+		// Buckets in order, then ranges in order inside a bucket, which keeps the sort stable.
+		uint32_t offset = 0;
+		for (uint32_t bucket = 0; bucket < k_BucketCount; ++bucket)
+		{
+			for (uint32_t range = 0; range < pRangeCount; ++range)
+			{
+				uint32_t& count = GetHistogram(range, pDigit, pDigitCount)[bucket];
+				const uint32_t rangeCount = count;
+				count = offset;
+				offset += rangeCount;
+			}
+		}
+	}
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Engine
+{
+	/// <summary>
+	/// Stable LSD radix sort of 64 bits keys, giving the order of the keys rather than moving them.
+	/// Only the key bits that differ between the keys are sorted on, so sparse keys (small ids in wide fields) take
+	/// fewer passes, and when they fit the key index is packed in the same 64 bits so a pass moves 8 bytes per key.
+	/// Large sorts are split in ranges of keys that are packed and scattered in parallel on the JobSystem.
+	/// The scratch buffers are kept between calls, sorting as many or fewer keys than before does not allocate.
+	/// </summary>
+	class RadixSorter
+	{
+	public:
+		static constexpr uint32_t k_DigitBits = 8;
+		static constexpr uint32_t k_BucketCount = 1u << k_DigitBits;
+		static constexpr uint32_t k_MaxDigitCount = (64 + k_DigitBits - 1) / k_DigitBits;
+		// Keys below which splitting a pass over one more thread costs more than it saves.
+		static constexpr uint32_t k_MinKeysPerJob = 1 << 16;
+
+		struct Stats
+		{
+			// Of the last Sort() : the key bits that were sorted on and the passes it took.
+			uint32_t KeyBits = 0;
+			uint32_t Passes = 0;
+		};
+
+		/// <summary>
+		/// Writes in pOrder the indices of pKeys by increasing key, equal keys keep their order.
+		/// </summary>
+		/// <param name="pKeys"></param>
+		/// <param name="pCount"></param>
+		/// <param name="pOrder"> : pCount indices</param>
+		void Sort(const uint64_t* pKeys, uint32_t pCount, uint32_t* pOrder);
+
+		[[nodiscard]] const Stats& GetStats() const { return m_Stats; }
+
+	private:
+		// Contiguous key bits moved to Destination in the packed key.
+		struct BitRun
+		{
+			uint32_t Shift;
+			uint64_t Mask;
+			uint32_t Destination;
+		};
+
+		uint32_t* GetHistogram(const uint32_t pRange, const uint32_t pDigit, const uint32_t pDigitCount)
+		{
+			return &m_Histograms[(static_cast<size_t>(pRange) * pDigitCount + pDigit) * k_BucketCount];
+		}
+		/// <summary>
+		/// Turns the digit's counts of every range into where the range writes each bucket.
+		/// </summary>
+		void ComputeOffsets(uint32_t pDigit, uint32_t pDigitCount, uint32_t pRangeCount);
+
+		std::vector<uint64_t> m_ScratchKeys[2];
+		std::vector<uint32_t> m_ScratchIndices;
+		// Per range of keys, then per digit.
+		std::vector<uint32_t> m_Histograms;
+		Stats m_Stats;
+	};
+}
@@ -0,0 +1,346 @@
+#include "TlsfAllocator.h"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+namespace Engine
+{
+	TlsfAllocator::TlsfAllocator(const uint64_t pCapacity, const uint64_t pGranularity)
+		: m_Capacity(pCapacity), m_Granularity(pGranularity)
+	{
+		if (!std::has_single_bit(pGranularity) || pCapacity == 0 || pCapacity % pGranularity != 0)
+			throw std::invalid_argument("TLSF capacity must be a non zero multiple of a power of two granularity.");
+		m_GranularityShift = static_cast<uint32_t>(std::countr_zero(pGranularity));
+
+		for (auto& firstLevel : m_FreeLists)
+			std::fill(std::begin(firstLevel), std::end(firstLevel), k_InvalidBlock);
+
+		// The whole range, free.
+		m_FirstBlock = CreateBlock();
+		m_Blocks[m_FirstBlock].Size = pCapacity;
+		InsertFreeBlock(m_FirstBlock);
+	}
+
+	bool TlsfAllocator::TryAllocate(const uint64_t pSize, uint64_t pAlignment, TlsfAllocation& pOut,
+	                                void* pUserData)
+	{
+		pAlignment = (std::max)(pAlignment, m_Granularity);
+		if (!std::has_single_bit(pAlignment))
+			throw std::invalid_argument("TLSF alignment must be a power of two.");
+
+		const uint64_t size = ((std::max)(pSize, uint64_t(1)) + m_Granularity - 1) & ~(m_Granularity - 1);
+		if (size > m_Capacity)
+			return false;
+
+		uint32_t index = FindFreeBlock(size, pAlignment);
+		if (index == k_InvalidBlock)
+			return false;
+		RemoveFreeBlock(index);
+
+		const uint64_t alignedOffset = (m_Blocks[index].Offset + pAlignment - 1) & ~(pAlignment - 1);
+		const uint64_t padding = alignedOffset - m_Blocks[index].Offset;
+		if (padding > 0)
+		{
+			// The padding stays free in front of the allocation, its physical previous block is in use.
+			const uint32_t front = CreateBlock();
+			Block& block = m_Blocks[index];
+			Block& frontBlock = m_Blocks[front];
+			frontBlock.Offset = block.Offset;
+			frontBlock.Size = padding;
+			frontBlock.PreviousPhysical = block.PreviousPhysical;
+			frontBlock.NextPhysical = index;
+			if (block.PreviousPhysical != k_InvalidBlock)
+				m_Blocks[block.PreviousPhysical].NextPhysical = front;
+			else
+				m_FirstBlock = front;
+			block.PreviousPhysical = front;
+			block.Offset = alignedOffset;
+			block.Size -= padding;
+			InsertFreeBlock(front);
+		}
+
+		if (m_Blocks[index].Size > size)
+		{
+			const uint32_t back = CreateBlock();
+			Block& block = m_Blocks[index];
+			Block& backBlock = m_Blocks[back];
+			backBlock.Offset = block.Offset + size;
+			backBlock.Size = block.Size - size;
+			backBlock.PreviousPhysical = index;
+			backBlock.NextPhysical = block.NextPhysical;
+			if (block.NextPhysical != k_InvalidBlock)
+				m_Blocks[block.NextPhysical].PreviousPhysical = back;
+			block.NextPhysical = back;
+			block.Size = size;
+			InsertFreeBlock(back);
+		}
+
+		Block& block = m_Blocks[index];
+		block.UserData = pUserData;
+		m_UsedBytes += block.Size;
+		++m_AllocationCount;
+		pOut = {block.Offset, block.Size, index, pUserData};
+		return true;
+	}
+
+	void TlsfAllocator::Free(const TlsfAllocation& pAllocation)
+	{
+		uint32_t index = pAllocation.Block;
+		if (index >= m_Blocks.size() || m_Blocks[index].IsFree || m_Blocks[index].Offset != pAllocation.Offset)
+			throw std::invalid_argument("TLSF block freed twice or not allocated here.");
+
+		m_UsedBytes -= m_Blocks[index].Size;
+		--m_AllocationCount;
+		m_Blocks[index].UserData = nullptr;
+
+		// Merged with the free neighbours, two free blocks are never next to each other.
+		const uint32_t previous = m_Blocks[index].PreviousPhysical;
+		if (previous != k_InvalidBlock && m_Blocks[previous].IsFree)
+		{
+			RemoveFreeBlock(previous);
+			m_Blocks[previous].Size += m_Blocks[index].Size;
+			m_Blocks[previous].NextPhysical = m_Blocks[index].NextPhysical;
+			if (m_Blocks[index].NextPhysical != k_InvalidBlock)
+				m_Blocks[m_Blocks[index].NextPhysical].PreviousPhysical = previous;
+			ReleaseBlock(index);
+			index = previous;
+		}
+
+		const uint32_t next = m_Blocks[index].NextPhysical;
+		if (next != k_InvalidBlock && m_Blocks[next].IsFree)
+		{
+			RemoveFreeBlock(next);
+			m_Blocks[index].Size += m_Blocks[next].Size;
+			m_Blocks[index].NextPhysical = m_Blocks[next].NextPhysical;
+			if (m_Blocks[next].NextPhysical != k_InvalidBlock)
+				m_Blocks[m_Blocks[next].NextPhysical].PreviousPhysical = index;
+			ReleaseBlock(next);
+		}
+
+		InsertFreeBlock(index);
+	}
+
+	void TlsfAllocator::GetAllocations(std::vector<TlsfAllocation>& pOutAllocations) const
+	{
+		pOutAllocations.clear();
+		for (uint32_t index = m_FirstBlock; index != k_InvalidBlock; index = m_Blocks[index].NextPhysical)
+		{
+			const Block& block = m_Blocks[index];
+			if (!block.IsFree)
+				pOutAllocations.push_back({block.Offset, block.Size, index, block.UserData});
+		}
+	}
+
+	TlsfAllocator::Stats TlsfAllocator::GetStats() const
+	{
+		Stats stats;
+		stats.Capacity = m_Capacity;
+		stats.UsedBytes = m_UsedBytes;
+		stats.FreeBytes = m_Capacity - m_UsedBytes;
+		stats.AllocationCount = m_AllocationCount;
+		stats.FreeBlockCount = m_FreeBlockCount;
+		if (m_FirstLevelBitmap != 0)
+		{
+			const uint32_t firstLevel = 63 - std::countl_zero(m_FirstLevelBitmap);
+			const uint32_t secondLevel = 31 - std::countl_zero(m_SecondLevelBitmaps[firstLevel]);
+			for (uint32_t index = m_FreeLists[firstLevel][secondLevel]; index != k_InvalidBlock;
+			     index = m_Blocks[index].NextFree)
+				stats.LargestFreeBlock = (std::max)(stats.LargestFreeBlock, m_Blocks[index].Size);
+		}
+		return stats;
+	}
+
+	bool TlsfAllocator::Validate() const
+	{
+		uint64_t offset = 0;
+		uint64_t usedBytes = 0;
+		uint32_t allocationCount = 0;
+		uint32_t freeBlockCount = 0;
+		uint32_t previous = k_InvalidBlock;
+		for (uint32_t index = m_FirstBlock; index != k_InvalidBlock; index = m_Blocks[index].NextPhysical)
+		{
+			const Block& block = m_Blocks[index];
+			if (block.Offset != offset || block.Size == 0 || block.PreviousPhysical != previous ||
+				block.Offset % m_Granularity != 0 || block.Size % m_Granularity != 0)
+				return false;
+			if (block.IsFree)
+			{
+				if (previous != k_InvalidBlock && m_Blocks[previous].IsFree)
+					return false;
+				++freeBlockCount;
+			}
+			else
+			{
+				usedBytes += block.Size;
+				++allocationCount;
+			}
+			offset += block.Size;
+			previous = index;
+		}
+		if (offset != m_Capacity || usedBytes != m_UsedBytes || allocationCount != m_AllocationCount ||
+			freeBlockCount != m_FreeBlockCount)
+			return false;
+
+		// Every free block is in the list of its class, and the bitmaps match the lists.
+		uint32_t listedCount = 0;
+		for (uint32_t firstLevel = 0; firstLevel < k_FirstLevelCount; ++firstLevel)
+		{
+			const bool hasFirstLevel = (m_FirstLevelBitmap >> firstLevel & 1) != 0;
+			if (hasFirstLevel != (m_SecondLevelBitmaps[firstLevel] != 0))
+				return false;
+			for (uint32_t secondLevel = 0; secondLevel < k_SecondLevelCount; ++secondLevel)
+			{
+				const uint32_t head = m_FreeLists[firstLevel][secondLevel];
+				if ((head != k_InvalidBlock) != ((m_SecondLevelBitmaps[firstLevel] >> secondLevel & 1) != 0))
+					return false;
+				uint32_t previousFree = k_InvalidBlock;
+				for (uint32_t index = head; index != k_InvalidBlock; index = m_Blocks[index].NextFree)
+				{
+					uint32_t blockFirstLevel, blockSecondLevel;
+					GetSizeClass(m_Blocks[index].Size, blockFirstLevel, blockSecondLevel);
+					if (!m_Blocks[index].IsFree || m_Blocks[index].PreviousFree != previousFree ||
+						blockFirstLevel != firstLevel || blockSecondLevel != secondLevel)
+						return false;
+					previousFree = index;
+					++listedCount;
+				}
+			}
+		}
+		return listedCount == m_FreeBlockCount;
+	}
+
+	void TlsfAllocator::GetSizeClass(const uint64_t pSize, uint32_t& pFirstLevel, uint32_t& pSecondLevel) const
+	{
+		// Below 16 granules every size has its own class, then each power of two is split in 16.
+		const uint64_t units = pSize >> m_GranularityShift;
+		if (units < k_SecondLevelCount)
+		{
+			pFirstLevel = 0;
+			pSecondLevel = static_cast<uint32_t>(units);
+			return;
+		}
+		const uint32_t log2 = 63 - std::countl_zero(units);
+		pFirstLevel = log2 - k_SecondLevelBits + 1;
+		pSecondLevel = static_cast<uint32_t>(units >> (log2 - k_SecondLevelBits)) & (k_SecondLevelCount - 1);
+	}
+
+	uint32_t TlsfAllocator::FindFreeBlock(const uint64_t pSize, const uint64_t pAlignment) const
+	{
+		// Any block of searchSize fits once aligned, the padding is a multiple of the granularity. Rounded up to
+		// the next class, any of its blocks is large enough.
+		const uint64_t searchSize = pSize + (pAlignment - m_Granularity);
+		uint64_t size = searchSize;
+		const uint64_t units = searchSize >> m_GranularityShift;
+		if (units >= k_SecondLevelCount)
+			size += (uint64_t(1) << (63 - std::countl_zero(units) - k_SecondLevelBits + m_GranularityShift)) - 1;
+
+		uint32_t firstLevel, secondLevel;
+		GetSizeClass(size, firstLevel, secondLevel);
+		if (size <= m_Capacity && firstLevel < k_FirstLevelCount)
+		{
+			uint32_t secondLevelMap = m_SecondLevelBitmaps[firstLevel] & (~0u << secondLevel);
+			if (secondLevelMap == 0)
+			{
+				const uint64_t firstLevelMap = firstLevel + 1 < k_FirstLevelCount
+					                               ? m_FirstLevelBitmap & (~uint64_t(0) << (firstLevel + 1))
+					                               : 0;
+				if (firstLevelMap != 0)
+				{
+					firstLevel = static_cast<uint32_t>(std::countr_zero(firstLevelMap));
+					secondLevelMap = m_SecondLevelBitmaps[firstLevel];
+				}
+			}
+			if (secondLevelMap != 0)
+				return m_FreeLists[firstLevel][static_cast<uint32_t>(std::countr_zero(secondLevelMap))];
+		}
+
+		// Nothing in the larger classes, a smaller block may still fit where it is : one of pSize's own class,
+		// the last one left in a full range, or one already aligned. The classes in between are walked.
+		uint32_t lastFirstLevel, lastSecondLevel;
+		GetSizeClass(pSize, firstLevel, secondLevel);
+		GetSizeClass((std::min)(size, m_Capacity), lastFirstLevel, lastSecondLevel);
+		for (; firstLevel <= lastFirstLevel && firstLevel < k_FirstLevelCount; ++firstLevel, secondLevel = 0)
+		{
+			uint32_t secondLevelMap = m_SecondLevelBitmaps[firstLevel] & (~0u << secondLevel);
+			if (firstLevel == lastFirstLevel && lastSecondLevel + 1 < k_SecondLevelCount)
+				secondLevelMap &= (1u << (lastSecondLevel + 1)) - 1;
+			for (; secondLevelMap != 0; secondLevelMap &= secondLevelMap - 1)
+			{
+				const uint32_t list = static_cast<uint32_t>(std::countr_zero(secondLevelMap));
+				for (uint32_t index = m_FreeLists[firstLevel][list]; index != k_InvalidBlock;
+				     index = m_Blocks[index].NextFree)
+				{
+					const Block& block = m_Blocks[index];
+					const uint64_t padding = ((block.Offset + pAlignment - 1) & ~(pAlignment - 1)) - block.Offset;
+					if (block.Size >= pSize + padding)
+						return index;
+				}
+			}
+		}
+		return k_InvalidBlock;
+	}
+
+	void TlsfAllocator::InsertFreeBlock(const uint32_t pBlock)
+	{
+		uint32_t firstLevel, secondLevel;
+		GetSizeClass(m_Blocks[pBlock].Size, firstLevel, secondLevel);
+
+		Block& block = m_Blocks[pBlock];
+		block.IsFree = true;
+		block.PreviousFree = k_InvalidBlock;
+		block.NextFree = m_FreeLists[firstLevel][secondLevel];
+		if (block.NextFree != k_InvalidBlock)
+			m_Blocks[block.NextFree].PreviousFree = pBlock;
+		m_FreeLists[firstLevel][secondLevel] = pBlock;
+
+		m_FirstLevelBitmap |= uint64_t(1) << firstLevel;
+		m_SecondLevelBitmaps[firstLevel] |= 1u << secondLevel;
+		++m_FreeBlockCount;
+	}
+
+	void TlsfAllocator::RemoveFreeBlock(const uint32_t pBlock)
+	{
+		uint32_t firstLevel, secondLevel;
+		GetSizeClass(m_Blocks[pBlock].Size, firstLevel, secondLevel);
+
+		Block& block = m_Blocks[pBlock];
+		if (block.PreviousFree != k_InvalidBlock)
+			m_Blocks[block.PreviousFree].NextFree = block.NextFree;
+		else
+			m_FreeLists[firstLevel][secondLevel] = block.NextFree;
+		if (block.NextFree != k_InvalidBlock)
+			m_Blocks[block.NextFree].PreviousFree = block.PreviousFree;
+		block.IsFree = false;
+		block.PreviousFree = k_InvalidBlock;
+		block.NextFree = k_InvalidBlock;
+
+		if (m_FreeLists[firstLevel][secondLevel] == k_InvalidBlock)
+		{
+			m_SecondLevelBitmaps[firstLevel] &= ~(1u << secondLevel);
+			if (m_SecondLevelBitmaps[firstLevel] == 0)
+				m_FirstLevelBitmap &= ~(uint64_t(1) << firstLevel);
+		}
+		--m_FreeBlockCount;
+	}
+
+	uint32_t TlsfAllocator::CreateBlock()
+	{
+		if (!m_UnusedBlocks.empty())
+		{
+			const uint32_t index = m_UnusedBlocks.back();
+			m_UnusedBlocks.pop_back();
+			m_Blocks[index] = {};
+			return index;
+		}
+		m_Blocks.emplace_back();
+		return static_cast<uint32_t>(m_Blocks.size() - 1);
+	}
+
+	void TlsfAllocator::ReleaseBlock(const uint32_t pBlock)
+	{
+		// Marked free so Free() refuses a stale allocation, the offset check catches a reused one.
+		m_Blocks[pBlock].IsFree = true;
+		m_UnusedBlocks.push_back(pBlock);
+	}
+}
@@ -0,0 +1,110 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace Engine
+{
+	struct TlsfAllocation
+	{
+		uint64_t Offset = 0;
+		uint64_t Size = 0;
+		// Block of the allocator, what Free() is given back.
+		uint32_t Block = UINT32_MAX;
+		void* UserData = nullptr;
+	};
+
+	/// <summary>
+	/// Two-level segregated fit allocator of offsets in a range, without touching the memory itself : the same
+	/// code places resources in GPU heaps or anything else. Free blocks are kept in lists by size class, a
+	/// power of two split in 16, found through two bitmaps in constant time. Aligned allocations split the
+	/// padding in front into a free block, freed blocks merge with their free neighbours.
+	/// Not thread safe.
+	/// </summary>
+	class TlsfAllocator
+	{
+	public:
+		struct Stats
+		{
+			uint64_t Capacity = 0;
+			uint64_t UsedBytes = 0;
+			uint64_t FreeBytes = 0;
+			uint64_t LargestFreeBlock = 0;
+			uint32_t AllocationCount = 0;
+			uint32_t FreeBlockCount = 0;
+
+			/// <returns> 0 when the free memory is one block, toward 1 as it is split into small ones. </returns>
+			float GetFragmentation() const
+			{
+				return FreeBytes == 0 ? 0.0f : 1.0f - static_cast<float>(LargestFreeBlock) / static_cast<float>(FreeBytes);
+			}
+		};
+
+		/// <param name="pCapacity"> : bytes of the range, a multiple of pGranularity</param>
+		/// <param name="pGranularity"> : power of two every size and offset is rounded to</param>
+		TlsfAllocator(uint64_t pCapacity, uint64_t pGranularity = 256);
+
+		/// <param name="pAlignment"> : power of two, the granularity when smaller</param>
+		/// <returns> False when no free block can hold pSize bytes at pAlignment. </returns>
+		bool TryAllocate(uint64_t pSize, uint64_t pAlignment, TlsfAllocation& pOut, void* pUserData = nullptr);
+		void Free(const TlsfAllocation& pAllocation);
+
+		/// <summary>
+		/// Lists the allocations in offset order, to move them elsewhere for instance.
+		/// </summary>
+		void GetAllocations(std::vector<TlsfAllocation>& pOutAllocations) const;
+
+		[[nodiscard]] bool IsEmpty() const { return m_AllocationCount == 0; }
+		[[nodiscard]] uint64_t GetCapacity() const { return m_Capacity; }
+		[[nodiscard]] uint64_t GetUsedBytes() const { return m_UsedBytes; }
+		/// <returns> The counters, the largest free block is looked for in the largest size class. </returns>
+		[[nodiscard]] Stats GetStats() const;
+		/// <returns> False when the blocks do not tile the range or a free list is wrong. Walks every block. </returns>
+		[[nodiscard]] bool Validate() const;
+
+	private:
+		static constexpr uint32_t k_InvalidBlock = UINT32_MAX;
+		static constexpr uint32_t k_SecondLevelBits = 4;
+		static constexpr uint32_t k_SecondLevelCount = 1 << k_SecondLevelBits;
+		static constexpr uint32_t k_FirstLevelCount = 64;
+
+		struct Block
+		{
+			uint64_t Offset = 0;
+			uint64_t Size = 0;
+			// Neighbours in the range.
+			uint32_t PreviousPhysical = k_InvalidBlock;
+			uint32_t NextPhysical = k_InvalidBlock;
+			// Neighbours in the free list of its size class.
+			uint32_t PreviousFree = k_InvalidBlock;
+			uint32_t NextFree = k_InvalidBlock;
+			bool IsFree = false;
+			void* UserData = nullptr;
+		};
+
+		// Size class of pSize, rounded down : every block of the class is at least pSize when it is exact.
+		void GetSizeClass(uint64_t pSize, uint32_t& pFirstLevel, uint32_t& pSecondLevel) const;
+		// A free block holding pSize bytes at pAlignment : the first of a class large enough whatever its
+		// offset, else a smaller one checked block by block.
+		uint32_t FindFreeBlock(uint64_t pSize, uint64_t pAlignment) const;
+		void InsertFreeBlock(uint32_t pBlock);
+		void RemoveFreeBlock(uint32_t pBlock);
+		uint32_t CreateBlock();
+		void ReleaseBlock(uint32_t pBlock);
+
+		uint64_t m_Capacity;
+		uint64_t m_Granularity;
+		uint32_t m_GranularityShift = 0;
+
+		std::vector<Block> m_Blocks;
+		std::vector<uint32_t> m_UnusedBlocks;
+		uint32_t m_FirstBlock = 0;
+
+		uint64_t m_FirstLevelBitmap = 0;
+		uint32_t m_SecondLevelBitmaps[k_FirstLevelCount] = {};
+		uint32_t m_FreeLists[k_FirstLevelCount][k_SecondLevelCount];
+
+		uint64_t m_UsedBytes = 0;
+		uint32_t m_AllocationCount = 0;
+		uint32_t m_FreeBlockCount = 0;
+	};
+}
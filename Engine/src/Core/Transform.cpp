@@ -30,9 +30,7 @@ void Engine::Transform::Rotate(float yaw, float pitch, float roll)
 
 void Engine::Transform::Translate(float offsetx, float offsety, float offsetz)
 {
-	DirectX::XMVECTOR translation = DirectX::XMVectorSet(offsetx, offsety, offsetz, 0.f);
-	DirectX::XMVECTOR newpos = DirectX::XMVectorAdd(GetPosition(), translation);
-	DirectX::XMStoreFloat3(&m_Position, newpos);
+	m_Position.Offset(DirectX::XMVectorSet(offsetx, offsety, offsetz, 0.f));
 
 	UpdateMatrix();
 }
@@ -41,9 +39,7 @@ void Engine::Transform::MoveForward(float speed, float direction)
 {
 	DirectX::XMVECTOR forward = GetForwardVector();
 	DirectX::XMVECTOR s = DirectX::XMVectorReplicate(speed * direction);
-	DirectX::XMVECTOR position = GetPosition();
-	DirectX::XMVECTOR newPos = DirectX::XMVectorMultiplyAdd(s, forward, position);
-	DirectX::XMStoreFloat3(&m_Position, newPos);
+	m_Position.Offset(DirectX::XMVectorMultiply(s, forward));
 	UpdateMatrix();
 }
 
@@ -51,9 +47,7 @@ void Engine::Transform::MoveRight(float speed, float direction)
 {
 	DirectX::XMVECTOR right = GetRightVector();
 	DirectX::XMVECTOR s = DirectX::XMVectorReplicate(speed * direction);
-	DirectX::XMVECTOR position = GetPosition();
-	DirectX::XMVECTOR newPos = DirectX::XMVectorMultiplyAdd(s, right, position);
-	DirectX::XMStoreFloat3(&m_Position, newPos);
+	m_Position.Offset(DirectX::XMVectorMultiply(s, right));
 	UpdateMatrix();
 }
 
@@ -61,9 +55,7 @@ void Engine::Transform::MoveUp(float speed, float direction)
 {
 	DirectX::XMVECTOR up = GetUpVector();
 	DirectX::XMVECTOR s = DirectX::XMVectorReplicate(speed * direction);
-	DirectX::XMVECTOR position = GetPosition();
-	DirectX::XMVECTOR newPos = DirectX::XMVectorMultiplyAdd(s, up, position);
-	DirectX::XMStoreFloat3(&m_Position, newPos);
+	m_Position.Offset(DirectX::XMVectorMultiply(s, up));
 	UpdateMatrix();
 }
 
@@ -135,6 +127,12 @@ void Engine::Transform::SetPosition(DirectX::XMFLOAT3 position)
 	UpdateMatrix();
 }
 
+void Engine::Transform::SetPosition(const WorldPosition& position)
+{
+	m_Position = position;
+	UpdateMatrix();
+}
+
 void Engine::Transform::SetScale(DirectX::XMFLOAT3 scale)
 {
 	m_Scale = scale;
@@ -143,7 +141,13 @@ void Engine::Transform::SetScale(DirectX::XMFLOAT3 scale)
 
 DirectX::XMVECTOR Engine::Transform::GetPosition() const
 {
-	return DirectX::XMLoadFloat3(&m_Position);
+	const DirectX::XMFLOAT3 position = m_Position.ToFloat3();
+	return DirectX::XMLoadFloat3(&position);
+}
+
+const Engine::WorldPosition& Engine::Transform::GetWorldPosition() const
+{
+	return m_Position;
 }
 
 DirectX::XMVECTOR Engine::Transform::GetScale() const
@@ -170,10 +174,19 @@ void Engine::Transform::UpdateMatrix()
 {
 	DirectX::XMMATRIX scaleMatrix = DirectX::XMMatrixScalingFromVector(DirectX::XMLoadFloat3(&m_Scale));
 	DirectX::XMMATRIX rotationMatrix = DirectX::XMLoadFloat4x4(&m_Rot);
-	DirectX::XMMATRIX translationMatrix = DirectX::XMMatrixTranslationFromVector(DirectX::XMLoadFloat3(&m_Position));
+	DirectX::XMMATRIX translationMatrix = DirectX::XMMatrixTranslationFromVector(GetPosition());
 	DirectX::XMMATRIX world = scaleMatrix * rotationMatrix * translationMatrix;
 
 	DirectX::XMStoreFloat4x4(&m_World, world);
+
+	if (m_Listener)
+		m_Listener->OnTransformChanged(m_ListenerId);
+}
+
+void Engine::Transform::SetListener(TransformListener* listener, const uint32_t id)
+{
+	m_Listener = listener;
+	m_ListenerId = id;
 }
 
 void Engine::Transform::UpdateRotation()
@@ -211,3 +224,11 @@ DirectX::XMFLOAT4X4 Engine::Transform::GetWorldAsFloat4x4() const
 {
 	return m_World;
 }
+
+DirectX::XMMATRIX Engine::Transform::GetWorldRelativeTo(const WorldPosition& origin) const
+{
+	// Scale and rotation rows are not affected by the origin, only the translation is rebuilt.
+	DirectX::XMMATRIX world = DirectX::XMLoadFloat4x4(&m_World);
+	world.r[3] = DirectX::XMVectorSetW(WorldPosition::Subtract(m_Position, origin), 1.f);
+	return world;
+}
@@ -1,8 +1,23 @@
 #pragma once
+#include <cstdint>
 #include <DirectXMath.h>
 
+#include "Core/WorldPosition.h"
+
 namespace Engine
 {
+	/// <summary>
+	/// Notified every time the world matrix of a Transform changes (ex. to upload it to the GPU).
+	/// </summary>
+	class TransformListener
+	{
+	public:
+		virtual ~TransformListener() = default;
+
+		/// <param name="id"> : the id the Transform was given in Transform::SetListener</param>
+		virtual void OnTransformChanged(uint32_t id) = 0;
+	};
+
 	/// <summary>
 	/// A Basic Transform class to manipulates Directx's meshes' position, rotation, and scale.
 	/// </summary>
@@ -18,6 +33,12 @@ namespace Engine
 		/// <param name="position"></param>
 		void SetPosition(DirectX::XMFLOAT3 position);
 
+		/// <summary>
+		/// Sets transform's position in world space, in double precision.
+		/// </summary>
+		/// <param name="position"></param>
+		void SetPosition(const WorldPosition& position);
+
 		/// <summary>
 		/// Set transform's rotation in world space.
 		/// </summary>
@@ -103,20 +124,37 @@ namespace Engine
 		/// <param name="angle"></param>
 		void RotateLocalZ(float angle);
 
+		/// <summary>
+		/// Sets the listener notified when the world matrix changes, nullptr to remove it.
+		/// </summary>
+		/// <param name="listener"></param>
+		/// <param name="id"> : passed back to the listener, to know which Transform changed</param>
+		void SetListener(TransformListener* listener, uint32_t id);
+
 		/// GETTERS functions ------------------------
 
-		/// <returns>The tranform's position.</returns>
+		/// <returns>The tranform's position, rounded to float precision.</returns>
 		DirectX::XMVECTOR GetPosition() const;
 
+		/// <returns>The tranform's double precision position.</returns>
+		const WorldPosition& GetWorldPosition() const;
+
 		/// <returns>The tranform's scale.</returns>
 		DirectX::XMVECTOR GetScale() const;
 
-		/// <returns>The tranform's world matrix.</returns>
+		/// <returns>The tranform's world matrix. Its translation loses precision far from the origin.</returns>
 		DirectX::XMMATRIX GetWorld() const;
 
 		/// <returns>The tranform's world matrix as XMFLOAT4X4</returns>
 		DirectX::XMFLOAT4X4 GetWorldAsFloat4x4() const;
 
+		/// <summary>
+		/// Computes the world matrix of the transform in a space centered on origin (ex. the camera position).
+		/// The translation is subtracted in double precision, so it stays exact near the origin.
+		/// </summary>
+		/// <param name="origin"></param>
+		DirectX::XMMATRIX XM_CALLCONV GetWorldRelativeTo(const WorldPosition& origin) const;
+
 		/// <returns>The tranform's Up vector.</returns>
 		DirectX::XMVECTOR GetUpVector() const;
 
@@ -139,7 +177,10 @@ namespace Engine
 		/// </summary>
 		void UpdateRotation();
 
-		DirectX::XMFLOAT3 m_Position = {0.f, 0.f, 0.f};
+		WorldPosition m_Position;
+
+		TransformListener* m_Listener = nullptr;
+		uint32_t m_ListenerId = 0;
 
 		DirectX::XMFLOAT3 m_Right = {1.f, 0.f, 0.f};
 		DirectX::XMFLOAT3 m_Up = {0.f, 1.f, 0.f};
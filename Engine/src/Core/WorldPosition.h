@@ -0,0 +1,61 @@
+#pragma once
+#include <DirectXMath.h>
+#include <immintrin.h>
+
+namespace Engine
+{
+	/// <summary>
+	/// Double precision world space position, so objects keep a millimetre precision far away from the origin.
+	/// It never reaches the GPU : matrices are rebuilt relative to a float precision origin (the camera)
+	/// with Subtract(). The padding lane lets it load in a single AVX register.
+	/// </summary>
+	struct alignas(32) WorldPosition
+	{
+		double x = 0.0;
+		double y = 0.0;
+		double z = 0.0;
+		double Padding = 0.0;
+
+		WorldPosition() = default;
+		WorldPosition(const double px, const double py, const double pz) : x(px), y(py), z(pz) {}
+		WorldPosition(const DirectX::XMFLOAT3& position) : x(position.x), y(position.y), z(position.z) {}
+
+		/// <returns> The position rounded to float precision. </returns>
+		DirectX::XMFLOAT3 ToFloat3() const
+		{
+			return {static_cast<float>(x), static_cast<float>(y), static_cast<float>(z)};
+		}
+
+		/// <summary>
+		/// Moves the position by a float precision offset (w is ignored).
+		/// </summary>
+		void XM_CALLCONV Offset(DirectX::FXMVECTOR offset)
+		{
+#if defined(__AVX__)
+			const __m256d delta = _mm256_cvtps_pd(_mm_blend_ps(offset, _mm_setzero_ps(), 0x8));
+			_mm256_store_pd(&x, _mm256_add_pd(_mm256_load_pd(&x), delta));
+#else
+			DirectX::XMFLOAT3 delta;
+			DirectX::XMStoreFloat3(&delta, offset);
+			x += delta.x;
+			y += delta.y;
+			z += delta.z;
+#endif
+		}
+
+		/// <summary>
+		/// Computes a - b in double precision and rounds the result to float, w is 0.
+		/// The difference is small when b is close to a, so no precision is lost.
+		/// </summary>
+		static DirectX::XMVECTOR XM_CALLCONV Subtract(const WorldPosition& a, const WorldPosition& b)
+		{
+#if defined(__AVX__)
+			return _mm256_cvtpd_ps(_mm256_sub_pd(_mm256_load_pd(&a.x), _mm256_load_pd(&b.x)));
+#else
+			const __m128 xy = _mm_cvtpd_ps(_mm_sub_pd(_mm_load_pd(&a.x), _mm_load_pd(&b.x)));
+			const __m128 zw = _mm_cvtpd_ps(_mm_sub_pd(_mm_load_pd(&a.z), _mm_load_pd(&b.z)));
+			return _mm_movelh_ps(xy, zw);
+#endif
+		}
+	};
+}
@@ -1,8 +1,11 @@
 #include "Log.h"
 
+#include <cstdio>
 #include <ctime>
 
+#ifdef PLATFORM_WINDOWS
 #include "Platform/WindowsWindow.h"
+#endif
 
 namespace Engine
 {
@@ -23,10 +26,15 @@ namespace Engine
 
 		message = LogFormatMessage("[%s] [%s] %s: %s\n", timestamp, levelStrings[pLevel], pSender, message);
 
+#ifdef PLATFORM_WINDOWS
 		if (isError)
 			WindowsWindow::ConsoleWriteError(message, pLevel);
 		else
 			WindowsWindow::ConsoleWrite(message, pLevel);
+#else
+		// Without the windows console, ex. the tests built on Linux.
+		std::fputs(message, isError ? stderr : stdout);
+#endif
 
 		delete[] message;
 	}
@@ -43,13 +51,14 @@ namespace Engine
 
 	char* Log::FormatMessageV(const char* pFormat, va_list pVaList)
 	{
-		// Calculate the size needed for the formatted string
-		const int size = std::vsnprintf(nullptr, 0, pFormat, pVaList);
+		// Calculate the size needed for the formatted string, on a copy : the list cannot be walked twice outside
+		// of Windows.
+		va_list sizeArgs;
+		va_copy(sizeArgs, pVaList);
+		const int size = std::vsnprintf(nullptr, 0, pFormat, sizeArgs);
+		va_end(sizeArgs);
 		if (size <= 0)
-		{
-			va_end(pVaList);
 			return nullptr;
-		}
 
 		// Allocate a buffer and format the string
 		const auto buffer = new char[size + 1];
@@ -2,8 +2,23 @@
 #include <crtdbg.h>
 #endif
 
+#include <cstdlib>
+#include <cstring>
+
 #include "Sandbox.h"
+#include "Renderer/DirectXApi.h"
 
+// Command line :
+//   --headless         no window nor GPU, see ApplicationSpecification::Headless
+//   --script <path>    events replayed by the headless window
+//   --fixed-step <s>   seconds per frame instead of the real time
+//   --frames <count>   exits after this many frames
+//   --stress <count>   adds this many spheres to the scene
+//   --no-instancing    issues one draw call per Object
+//   --no-state-filter  forwards the redundant state changes too
+//   --shader-report    logs the shader variants and the shader cache's size at startup
+//   --static-batching  merges the objects that never move per material and chunk
+//   --gpu-culling      culls the objects that never move on the GPU, drawn with one ExecuteIndirect
 int main(int pArgc, char** pArgv)
 {
 #ifdef _DEBUG
@@ -13,7 +28,48 @@ int main(int pArgc, char** pArgv)
 	
 	Engine::ApplicationSpecification spec;
 	spec.Name = "Sandbox";
-	const auto app = new Sandbox(spec);
+	uint32_t stressSphereCount = 0;
+	bool useInstancing = true;
+	bool useStateFiltering = true;
+	bool logShaderReport = false;
+	bool useStaticBatching = false;
+	bool useGpuCulling = false;
+	for (int i = 1; i < pArgc; i++)
+	{
+		const bool hasValue = i + 1 < pArgc;
+		if (std::strcmp(pArgv[i], "--headless") == 0)
+			spec.Headless = true;
+		else if (std::strcmp(pArgv[i], "--script") == 0 && hasValue)
+		{
+			if (!spec.Script.Load(pArgv[++i]))
+				return 1;
+		}
+		else if (std::strcmp(pArgv[i], "--fixed-step") == 0 && hasValue)
+			spec.FixedTimestep = static_cast<float>(std::atof(pArgv[++i]));
+		else if (std::strcmp(pArgv[i], "--frames") == 0 && hasValue)
+			spec.FrameCount = std::strtoull(pArgv[++i], nullptr, 10);
+		else if (std::strcmp(pArgv[i], "--stress") == 0 && hasValue)
+			stressSphereCount = static_cast<uint32_t>(std::strtoul(pArgv[++i], nullptr, 10));
+		else if (std::strcmp(pArgv[i], "--no-instancing") == 0)
+			useInstancing = false;
+		else if (std::strcmp(pArgv[i], "--no-state-filter") == 0)
+			useStateFiltering = false;
+		else if (std::strcmp(pArgv[i], "--shader-report") == 0)
+			logShaderReport = true;
+		else if (std::strcmp(pArgv[i], "--static-batching") == 0)
+			useStaticBatching = true;
+		else if (std::strcmp(pArgv[i], "--gpu-culling") == 0)
+			useGpuCulling = true;
+	}
+	const auto app = new Sandbox(spec, stressSphereCount);
+	Engine::DirectXApi::SetInstancing(useInstancing);
+	Engine::DirectXApi::SetStateFiltering(useStateFiltering);
+	if (logShaderReport)
+		app->LogShaderReport();
+	if (useStaticBatching)
+		app->EnableStaticBatching();
+	if (useGpuCulling)
+		app->EnableGpuCulling();
 
 	app->Run();
 
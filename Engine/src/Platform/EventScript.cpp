@@ -0,0 +1,126 @@
+#include "EventScript.h"
+
+#include <algorithm>
+#include <sstream>
+
+#include "Debug/Log.h"
+#include "Platform/FilesSystem.h"
+
+namespace Engine
+{
+	namespace
+	{
+		struct ScriptedEventName
+		{
+			const char* Name;
+			EventType Type;
+			// Number of arguments after the name.
+			int ArgumentCount;
+		};
+
+		const ScriptedEventName k_EventNames[] = {
+			{"KeyPressed", EventType::KeyPressed, 1},
+			{"KeyReleased", EventType::KeyReleased, 1},
+			{"MouseButtonPressed", EventType::MouseButtonPressed, 1},
+			{"MouseButtonReleased", EventType::MouseButtonReleased, 1},
+			{"MouseMoved", EventType::MouseMoved, 2},
+			{"MouseScrolled", EventType::MouseScrolled, 2},
+			{"WindowResize", EventType::WindowResize, 2},
+			{"WindowClose", EventType::WindowClose, 0},
+		};
+	}
+
+	void EventScript::Add(const ScriptedEvent& pEvent)
+	{
+		// Keeps the list sorted, after the events already added on the same frame.
+		const auto position = std::upper_bound(m_Events.begin(), m_Events.end(), pEvent.Frame,
+		                                       [](const uint64_t pFrame, const ScriptedEvent& pOther)
+		                                       {
+			                                       return pFrame < pOther.Frame;
+		                                       });
+		m_Events.insert(position, pEvent);
+	}
+
+	bool EventScript::Parse(const std::string& pText)
+	{
+		std::istringstream stream(pText);
+		std::string line;
+		while (std::getline(stream, line))
+		{
+			if (!ParseLine(line))
+				return false;
+		}
+		return true;
+	}
+
+	bool EventScript::Load(const char* pPath)
+	{
+		File file;
+		if (!FilesSystem::Exist(pPath) || !FilesSystem::TryOpen(pPath, FileModeRead, true, &file))
+		{
+			CORE_ERROR("Event script not found : %s", pPath);
+			return false;
+		}
+
+		char* bytes = nullptr;
+		uint64_t size = 0;
+		const bool result = FilesSystem::TryReadAllBytes(&file, &bytes, &size) &&
+			Parse(std::string(bytes, size));
+		delete[] bytes;
+		FilesSystem::Close(&file);
+		return result;
+	}
+
+	bool EventScript::ParseLine(const std::string& pLine)
+	{
+		std::istringstream stream(pLine);
+		stream >> std::ws;
+		if (stream.eof() || stream.peek() == '#')
+			return true;
+
+		ScriptedEvent event;
+		std::string name;
+		if (!(stream >> event.Frame >> name))
+		{
+			CORE_ERROR("Event script : expected a frame and an event in '%s'", pLine.c_str());
+			return false;
+		}
+
+		const auto* eventName = std::find_if(std::begin(k_EventNames), std::end(k_EventNames),
+		                                     [&name](const ScriptedEventName& pName) { return name == pName.Name; });
+		if (eventName == std::end(k_EventNames))
+		{
+			CORE_ERROR("Event script : unknown event '%s'", name.c_str());
+			return false;
+		}
+		event.Type = eventName->Type;
+
+		bool result = true;
+		switch (event.Type)
+		{
+		case EventType::KeyPressed:
+		case EventType::KeyReleased:
+		case EventType::MouseButtonPressed:
+		case EventType::MouseButtonReleased:
+			result = static_cast<bool>(stream >> event.Code);
+			break;
+		case EventType::MouseMoved:
+		case EventType::MouseScrolled:
+		case EventType::WindowResize:
+			result = static_cast<bool>(stream >> event.X >> event.Y);
+			break;
+		default:
+			break;
+		}
+
+		if (!result)
+		{
+			CORE_ERROR("Event script : %s expects %d argument(s) in '%s'", eventName->Name,
+			           eventName->ArgumentCount, pLine.c_str());
+			return false;
+		}
+
+		Add(event);
+		return true;
+	}
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Core/KeyCodes.h"
+#include "Events/Event.h"
+
+namespace Engine
+{
+	struct ScriptedEvent
+	{
+		// Frame the event is sent on, counted from the first Window::Update().
+		uint64_t Frame = 0;
+		// One of KeyPressed, KeyReleased, MouseButtonPressed, MouseButtonReleased, MouseMoved, MouseScrolled,
+		// WindowResize and WindowClose.
+		EventType Type = EventType::None;
+		// Key or mouse button code.
+		uint32_t Code = 0;
+		// Position for MouseMoved, offsets for MouseScrolled, size for WindowResize.
+		float X = 0.f;
+		float Y = 0.f;
+	};
+
+	/// <summary>
+	/// Timeline of input and window events to replay without a real window. Scripts are text files with one
+	/// event per line, the frame followed by the event name and its arguments :
+	/// <code>
+	/// # frame event arguments
+	/// 0   WindowResize 1920 1080
+	/// 10  KeyPressed 87
+	/// 12  MouseMoved 640 360
+	/// 40  KeyReleased 87
+	/// 600 WindowClose
+	/// </code>
+	/// </summary>
+	class EventScript
+	{
+	public:
+		void Add(const ScriptedEvent& pEvent);
+		void KeyPressed(uint64_t pFrame, KeyCode pKey) { Add({pFrame, EventType::KeyPressed, pKey}); }
+		void KeyReleased(uint64_t pFrame, KeyCode pKey) { Add({pFrame, EventType::KeyReleased, pKey}); }
+		void MouseMoved(uint64_t pFrame, float pX, float pY) { Add({pFrame, EventType::MouseMoved, 0, pX, pY}); }
+		void Close(uint64_t pFrame) { Add({pFrame, EventType::WindowClose}); }
+
+		/// <returns> False if a line could not be read, the lines before it are kept. </returns>
+		bool Parse(const std::string& pText);
+		bool Load(const char* pPath);
+
+		/// <returns> The events, sorted by frame. Events of a same frame keep the order they were added in. </returns>
+		[[nodiscard]] const std::vector<ScriptedEvent>& GetEvents() const { return m_Events; }
+		[[nodiscard]] bool IsEmpty() const { return m_Events.empty(); }
+
+	private:
+		bool ParseLine(const std::string& pLine);
+
+		std::vector<ScriptedEvent> m_Events;
+	};
+}
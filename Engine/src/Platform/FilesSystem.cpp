@@ -23,7 +23,8 @@ namespace Engine
 
 		if ((pModes & FileModeWrite) != 0)
 		{
-			mode |= std::ios_base::out;
+			// Write only opens create (or truncate) the file, in | out requires it to exist.
+			mode = (pModes & FileModeRead) != 0 ? mode | std::ios_base::out : std::ios_base::out | std::ios_base::trunc;
 		}
 
 		if (pInBinary)
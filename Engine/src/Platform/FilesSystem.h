@@ -1,5 +1,6 @@
 ﻿#pragma once
-#include <cvt/wstring>
+#include <cstdint>
+#include <string>
 
 namespace Engine
 {
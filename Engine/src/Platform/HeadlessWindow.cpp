@@ -0,0 +1,110 @@
+#include "HeadlessWindow.h"
+
+#include <algorithm>
+
+#include "Debug/Log.h"
+#include "Events/ApplicationEvent.h"
+#include "Events/KeyEvent.h"
+#include "Events/MouseEvent.h"
+#include "Platform/Input.h"
+
+namespace Engine
+{
+	HeadlessWindow::HeadlessWindow(const WindowProps& pWindowProps, EventScript pScript)
+		: m_Title(pWindowProps.Title), m_Width(pWindowProps.Width), m_Height(pWindowProps.Height),
+		  m_Script(std::move(pScript))
+	{
+		CORE_INFO("Headless window initialized : %s (%d, %d), %zu scripted events", m_Title.c_str(), m_Width,
+		          m_Height, m_Script.GetEvents().size());
+	}
+
+	void HeadlessWindow::Update()
+	{
+		const auto& events = m_Script.GetEvents();
+		while (m_NextEvent < events.size() && events[m_NextEvent].Frame <= m_Frame)
+		{
+			// Copied, the callback may inject events and grow the list.
+			const ScriptedEvent event = events[m_NextEvent++];
+			Send(event);
+		}
+		m_Frame++;
+	}
+
+	void HeadlessWindow::Inject(const ScriptedEvent& pEvent)
+	{
+		// Sorted after the events already sent, so they are not sent twice.
+		ScriptedEvent event = pEvent;
+		event.Frame = std::max(event.Frame, m_Frame);
+		m_Script.Add(event);
+	}
+
+	void HeadlessWindow::Send(const ScriptedEvent& pEvent)
+	{
+		// Input is updated as WindowsWindow does, so polling code sees the scripted state.
+		switch (pEvent.Type)
+		{
+		case EventType::KeyPressed:
+			{
+				const auto key = static_cast<KeyCode>(pEvent.Code);
+				KeyPressedEvent event(key, Input::s_Keys[key]);
+				Input::s_Keys[key] = true;
+				if (m_EventCallback) m_EventCallback(event);
+			}
+			break;
+		case EventType::KeyReleased:
+			{
+				const auto key = static_cast<KeyCode>(pEvent.Code);
+				KeyReleasedEvent event(key);
+				Input::s_Keys[key] = false;
+				if (m_EventCallback) m_EventCallback(event);
+			}
+			break;
+		case EventType::MouseButtonPressed:
+			{
+				const auto button = static_cast<MouseCode>(pEvent.Code);
+				MouseButtonPressedEvent event(button);
+				Input::s_MouseButtons[button] = true;
+				if (m_EventCallback) m_EventCallback(event);
+			}
+			break;
+		case EventType::MouseButtonReleased:
+			{
+				const auto button = static_cast<MouseCode>(pEvent.Code);
+				MouseButtonReleasedEvent event(button);
+				Input::s_MouseButtons[button] = false;
+				if (m_EventCallback) m_EventCallback(event);
+			}
+			break;
+		case EventType::MouseMoved:
+			{
+				MouseMovedEvent event(pEvent.X, pEvent.Y);
+				Input::s_MousePositionX = pEvent.X;
+				Input::s_MousePositionY = pEvent.Y;
+				if (m_EventCallback) m_EventCallback(event);
+			}
+			break;
+		case EventType::MouseScrolled:
+			{
+				MouseScrolledEvent event(pEvent.X, pEvent.Y);
+				if (m_EventCallback) m_EventCallback(event);
+			}
+			break;
+		case EventType::WindowResize:
+			{
+				m_Width = static_cast<uint32_t>(pEvent.X);
+				m_Height = static_cast<uint32_t>(pEvent.Y);
+				WindowResizeEvent event(m_Width, m_Height);
+				if (m_EventCallback) m_EventCallback(event);
+			}
+			break;
+		case EventType::WindowClose:
+			{
+				WindowCloseEvent event;
+				if (m_EventCallback) m_EventCallback(event);
+			}
+			break;
+		default:
+			break;
+		}
+	}
+}
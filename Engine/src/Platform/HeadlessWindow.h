@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Window.h"
+#include "EventScript.h"
+
+namespace Engine
+{
+	/// <summary>
+	/// Window without an OS window : the size is virtual and the events come from an EventScript, so the main
+	/// loop can run deterministically on any platform (benchmarks, soak tests).
+	/// </summary>
+	class HeadlessWindow : public Window
+	{
+	public:
+		HeadlessWindow(const WindowProps& pWindowProps, EventScript pScript = {});
+
+		/// <summary>
+		/// Sends the scripted events of the current frame, then moves to the next frame.
+		/// </summary>
+		void Update() override;
+
+		[[nodiscard]] uint32_t GetWidth() const override { return m_Width; }
+		[[nodiscard]] uint32_t GetHeight() const override { return m_Height; }
+
+		void SetEventCallback(const EventCallbackFn& pCallback) override { m_EventCallback = pCallback; }
+
+		[[nodiscard]] void* GetNativeHandle() const override { return nullptr; }
+
+		/// <summary>
+		/// Queues an event, it is sent on its frame, or on the next Update() if that frame already passed.
+		/// </summary>
+		void Inject(const ScriptedEvent& pEvent);
+
+		[[nodiscard]] uint64_t GetFrame() const { return m_Frame; }
+		/// <returns> True once every scripted event was sent. </returns>
+		[[nodiscard]] bool IsScriptDone() const { return m_NextEvent == m_Script.GetEvents().size(); }
+
+	private:
+		void Send(const ScriptedEvent& pEvent);
+
+		std::string m_Title;
+		uint32_t m_Width;
+		uint32_t m_Height;
+		EventCallbackFn m_EventCallback;
+
+		EventScript m_Script;
+		size_t m_NextEvent = 0;
+		uint64_t m_Frame = 0;
+	};
+}
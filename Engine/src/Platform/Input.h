@@ -22,5 +22,6 @@ namespace Engine
 		static float s_MousePositionY;
 
 		friend class WindowsWindow;
+		friend class HeadlessWindow;
 	};
 }
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include "Events/Event.h"
+
+namespace Engine
+{
+	struct WindowProps
+	{
+		std::string Title = "Application";
+		uint32_t Width = 1600;
+		uint32_t Height = 900;
+	};
+
+	/// <summary>
+	/// Source of the window size and of the input / window events the Application reacts to.
+	/// </summary>
+	class Window
+	{
+	public:
+		using EventCallbackFn = std::function<void(Event&)>;
+
+		virtual ~Window() = default;
+
+		/// <summary>
+		/// Pumps the pending events, called once per frame by Application::Run().
+		/// </summary>
+		virtual void Update() = 0;
+
+		[[nodiscard]] virtual uint32_t GetWidth() const = 0;
+		[[nodiscard]] virtual uint32_t GetHeight() const = 0;
+
+		virtual void SetEventCallback(const EventCallbackFn& pCallback) = 0;
+
+		/// <returns> The OS handle the swapchain presents to (HWND), nullptr when there is no real window. </returns>
+		[[nodiscard]] virtual void* GetNativeHandle() const = 0;
+	};
+}
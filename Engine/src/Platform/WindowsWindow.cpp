@@ -98,10 +98,10 @@ namespace Engine
 		const HANDLE consoleHandle = GetStdHandle(STD_OUTPUT_HANDLE);
 
 		CONSOLE_SCREEN_BUFFER_INFO csbi;
-		auto t = Application::Get();
-		if (Application::Get() && Application::Get()->GetWindow())
+		const auto* window = Application::Get() ? dynamic_cast<WindowsWindow*>(Application::Get()->GetWindow()) : nullptr;
+		if (window)
 		{
-			csbi = Application::Get()->GetWindow()->m_StdOutputCsbi;
+			csbi = window->m_StdOutputCsbi;
 		}
 		else
 		{
@@ -124,9 +124,10 @@ namespace Engine
 		const HANDLE consoleHandle = GetStdHandle(STD_OUTPUT_HANDLE);
 
 		CONSOLE_SCREEN_BUFFER_INFO csbi;
-		if (Application::Get() && Application::Get()->GetWindow())
+		const auto* window = Application::Get() ? dynamic_cast<WindowsWindow*>(Application::Get()->GetWindow()) : nullptr;
+		if (window)
 		{
-			csbi = Application::Get()->GetWindow()->m_ErrOutputCsbi;
+			csbi = window->m_ErrOutputCsbi;
 		}
 		else
 		{
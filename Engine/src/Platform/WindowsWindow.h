@@ -1,36 +1,26 @@
 ﻿#pragma once
 
-#include <cstdint>
-#include <functional>
-#include <string>
 #include <windows.h>
 
-#include "Events/Event.h"
+#include "Window.h"
 
 namespace Engine
 {
-	struct WindowProps
-	{
-		std::string Title = "Application";
-		uint32_t Width = 1600;
-		uint32_t Height = 900;
-	};
-
-	class WindowsWindow
+	class WindowsWindow : public Window
 	{
 	public:
-		using EventCallbackFn = std::function<void(Event&)>;
-
 		WindowsWindow(const WindowProps& pWindowProps);
-		~WindowsWindow();
+		~WindowsWindow() override;
 
 		void Initialize(const WindowProps& pWindowProps);
-		void Update();
+		void Update() override;
+
+		[[nodiscard]] uint32_t GetWidth() const override { return m_Data.Width; }
+		[[nodiscard]] uint32_t GetHeight() const override { return m_Data.Height; }
 
-		[[nodiscard]] uint32_t GetWidth() const { return m_Data.Width; }
-		[[nodiscard]] uint32_t GetHeight() const { return m_Data.Height; }
+		void SetEventCallback(const EventCallbackFn& pCallback) override { m_Data.EventCallback = pCallback; }
 
-		void SetEventCallback(const EventCallbackFn& pCallback) { m_Data.EventCallback = pCallback; }
+		[[nodiscard]] void* GetNativeHandle() const override { return m_Window; }
 
 		void Sleep(const unsigned long pMilliseconds) { ::Sleep(pMilliseconds); }
 
@@ -0,0 +1,64 @@
+#include "CommandListPool.h"
+
+namespace Engine
+{
+	CommandListPool::CommandListPool(RhiDevice& pDevice, const uint32_t pFrameCount, const uint32_t pListCount)
+	{
+		m_Lists.resize(pListCount);
+		for (PooledList& list : m_Lists)
+		{
+			list.List = pDevice.CreateCommandList(RhiQueueType::Graphics);
+			list.Filter = std::make_unique<StateFilteringCommandList>(*list.List);
+			for (uint32_t i = 0; i < pFrameCount; ++i)
+				list.Allocators.push_back(pDevice.CreateCommandAllocator(RhiQueueType::Graphics));
+		}
+	}
+
+	void CommandListPool::BeginFrame(const uint32_t pFrameIndex)
+	{
+		m_FrameIndex = pFrameIndex;
+		++m_FrameNumber;
+	}
+
+	StateFilteringCommandList& CommandListPool::Begin(const uint32_t pIndex)
+	{
+		PooledList& list = m_Lists[pIndex];
+		list.FrameNumber = m_FrameNumber;
+		RhiCommandAllocator& allocator = *list.Allocators[m_FrameIndex];
+		allocator.Reset();
+		list.Filter->Begin(allocator);
+		return *list.Filter;
+	}
+
+	void CommandListPool::End(const uint32_t pIndex)
+	{
+		m_Lists[pIndex].Filter->End();
+	}
+
+	void CommandListPool::Execute(RhiCommandQueue& pQueue, RhiCommandList* pFirst, const uint32_t pCount)
+	{
+		m_ExecuteLists.clear();
+		if (pFirst)
+			m_ExecuteLists.push_back(pFirst);
+		for (uint32_t i = 0; i < pCount; ++i)
+			m_ExecuteLists.push_back(m_Lists[i].List.get());
+		pQueue.Execute(m_ExecuteLists.data(), static_cast<uint32_t>(m_ExecuteLists.size()));
+	}
+
+	void CommandListPool::SetStateFiltering(const bool pIsEnabled)
+	{
+		for (PooledList& list : m_Lists)
+			list.Filter->SetEnabled(pIsEnabled);
+	}
+
+	StateFilteringCommandList::Stats CommandListPool::GetStateFilteringStats() const
+	{
+		StateFilteringCommandList::Stats stats;
+		for (const PooledList& list : m_Lists)
+		{
+			if (list.FrameNumber == m_FrameNumber)
+				stats += list.Filter->GetStats();
+		}
+		return stats;
+	}
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <memory>
+#include <vector>
+
+#include "RHI/RhiDevice.h"
+#include "RHI/StateFilteringCommandList.h"
+
+namespace Engine
+{
+	/// <summary>
+	/// Command lists recorded in parallel, one per job. Every list has its own allocator per frame in flight, so a
+	/// list can be recorded by any thread while the GPU still runs the previous frames. A list is only touched
+	/// by the thread between its Begin() and End(), several lists can be recorded concurrently.
+	/// </summary>
+	class CommandListPool
+	{
+	public:
+		CommandListPool(RhiDevice& pDevice, uint32_t pFrameCount, uint32_t pListCount);
+
+		CommandListPool(const CommandListPool&) = delete;
+		CommandListPool& operator=(const CommandListPool&) = delete;
+
+		/// <summary>
+		/// Moves to the allocators of the frame, the FramePacer must have waited for the GPU to be done with them.
+		/// </summary>
+		void BeginFrame(uint32_t pFrameIndex);
+
+		/// <summary>
+		/// Resets the list's allocator of this frame and opens the list.
+		/// </summary>
+		/// <returns> The list, through the redundant state filter. </returns>
+		StateFilteringCommandList& Begin(uint32_t pIndex);
+		void End(uint32_t pIndex);
+
+		/// <returns> The backend list to execute. </returns>
+		[[nodiscard]] RhiCommandList& GetList(const uint32_t pIndex) const { return *m_Lists[pIndex].List; }
+		[[nodiscard]] uint32_t GetListCount() const { return static_cast<uint32_t>(m_Lists.size()); }
+
+		/// <summary>
+		/// Submits pFirst, when not nullptr, then the lists [0, pCount) in a single Execute().
+		/// </summary>
+		void Execute(RhiCommandQueue& pQueue, RhiCommandList* pFirst, uint32_t pCount);
+
+		void SetStateFiltering(bool pIsEnabled);
+		/// <returns> The state filtering counters of the lists, summed. </returns>
+		[[nodiscard]] StateFilteringCommandList::Stats GetStateFilteringStats() const;
+
+	private:
+		struct PooledList
+		{
+			std::unique_ptr<RhiCommandList> List;
+			std::unique_ptr<StateFilteringCommandList> Filter;
+			// One per frame in flight.
+			std::vector<std::unique_ptr<RhiCommandAllocator>> Allocators;
+			// Frame the list was last begun in, the filter's counters are only this frame's when it matches.
+			uint64_t FrameNumber = 0;
+		};
+
+		std::vector<PooledList> m_Lists;
+		std::vector<RhiCommandList*> m_ExecuteLists;
+		uint32_t m_FrameIndex = 0;
+		uint64_t m_FrameNumber = 0;
+	};
+}
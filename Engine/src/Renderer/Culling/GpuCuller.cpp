@@ -0,0 +1,269 @@
+#include "GpuCuller.h"
+
+#include "Core/Object.h"
+#include "Renderer/DirectXApi.h"
+#include "Renderer/DirectXContext.h"
+#include "Renderer/FramePacer.h"
+#include "Renderer/MeshPool.h"
+#include "Renderer/UploadManager.h"
+#include "Renderer/UploadRing.h"
+#include "Renderer/Materials/DirectXMaterial.h"
+#include "Renderer/Shaders/DirectXShader.h"
+
+namespace Engine
+{
+	namespace
+	{
+		constexpr const wchar_t* k_ShaderPath = L"Shaders\\Builtin.Cull.hlsl";
+		// Root parameters of the three passes.
+		constexpr uint32_t k_ConstantsSlot = 0;
+		constexpr uint32_t k_CandidatesSlot = 1;
+		constexpr uint32_t k_GroupCountsSlot = 2;
+		constexpr uint32_t k_VisibilitySlot = 3;
+		constexpr uint32_t k_CommandsSlot = 4;
+		constexpr uint32_t k_CountSlot = 5;
+		constexpr uint32_t k_GroupBasesSlot = 6;
+		// Root parameter of the draw shaders holding gFirstInstance, see DirectXBindlessShader.
+		constexpr uint32_t k_FirstInstanceSlot = 0;
+	}
+
+	GpuCuller::~GpuCuller()
+	{
+		// The frames in flight may still cull with the buffers.
+		if (DirectXContext::Get() && m_CandidateBuffer)
+			DirectXContext::Get()->GetFramePacer().WaitIdle();
+	}
+
+	std::vector<Object*> GpuCuller::SetObjects(Object* const* objects, const size_t count)
+	{
+		m_Objects.clear();
+		m_Material = nullptr;
+		m_Shader = nullptr;
+		m_Pool = nullptr;
+		m_Stats = {};
+
+		std::vector<Object*> rejected;
+		for (size_t i = 0; i < count; ++i)
+		{
+			Object* object = objects[i];
+			const DirectXMesh* mesh = object->GetMesh();
+			DirectXMaterial* material = object->GetMaterial();
+			if (!material || !mesh->GetPool())
+			{
+				rejected.push_back(object);
+				continue;
+			}
+
+			if (!m_Material)
+			{
+				m_Material = material;
+				m_Shader = material->GetShader();
+				m_Pool = mesh->GetPool();
+				m_Origin = object->GetTransform()->GetWorldPosition();
+			}
+			// One ExecuteIndirect : one vertex and index buffer, one pipeline.
+			if (mesh->GetPool() != m_Pool || material->GetShader() != m_Shader ||
+				material->GetVariantKey() != m_Material->GetVariantKey())
+			{
+				rejected.push_back(object);
+				continue;
+			}
+			m_Objects.push_back(object);
+		}
+		m_Stats.Rejected = static_cast<uint32_t>(rejected.size());
+
+		const auto candidateCount = static_cast<uint32_t>(m_Objects.size());
+		const uint32_t groupCount = GpuCulling::GetGroupCount(candidateCount);
+		m_Stats.Candidates = candidateCount;
+		m_Stats.Groups = groupCount;
+
+		Retire(std::move(m_GroupCountBuffer));
+		Retire(std::move(m_GroupBaseBuffer));
+		Retire(std::move(m_VisibilityBuffer));
+		Retire(std::move(m_CommandBuffer));
+		Retire(std::move(m_CountBuffer));
+		Retire(std::move(m_InstanceBuffer));
+		m_Candidates.clear();
+		m_Instances.clear();
+		if (m_Objects.empty())
+		{
+			Retire(std::move(m_CandidateBuffer));
+			return rejected;
+		}
+
+		CreatePipelines();
+		m_GroupCountBuffer = CreateUnorderedAccessBuffer(groupCount * sizeof(uint32_t));
+		m_GroupBaseBuffer = CreateUnorderedAccessBuffer(groupCount * sizeof(uint32_t));
+		m_VisibilityBuffer = CreateUnorderedAccessBuffer(groupCount * 2 * sizeof(uint32_t));
+		m_CommandBuffer = CreateUnorderedAccessBuffer(candidateCount * sizeof(GpuCulling::DrawCommand));
+		m_CountBuffer = CreateUnorderedAccessBuffer(sizeof(uint32_t));
+
+		m_Instances.reserve(candidateCount);
+		for (const Object* object : m_Objects)
+			m_Instances.push_back({object->GetObjectId(), object->GetMaterial()->GetMaterialId()});
+		m_InstanceBuffer = DirectXContext::Get()->GetUploadManager()->CreateBuffer(
+			m_Instances.data(), m_Instances.size() * sizeof(InstanceData));
+		UploadCandidates();
+		return rejected;
+	}
+
+	void GpuCuller::Render()
+	{
+		++m_FrameNumber;
+		while (!m_RetiredBuffers.empty() &&
+			m_RetiredBuffers.front().first + DirectXContext::k_FrameCount <= m_FrameNumber)
+			m_RetiredBuffers.erase(m_RetiredBuffers.begin());
+		if (m_Objects.empty())
+			return;
+
+		// The ranges moved, the draws must read the new ones.
+		if (m_Pool->GetCompactionCount() != m_PoolCompactions)
+			UploadCandidates();
+
+		RhiCommandList& commandList = DirectXContext::Get()->GetFrameCommandList();
+		const GpuCulling::Constants constants = GetConstants();
+
+		// ===== Culling =====
+		// Buffers go back to the common state after every submission.
+		RhiBuffer* const outputs[] = {
+			m_GroupCountBuffer.get(), m_GroupBaseBuffer.get(), m_VisibilityBuffer.get(), m_CommandBuffer.get(),
+			m_CountBuffer.get()
+		};
+		for (const RhiBuffer* buffer : outputs)
+			commandList.Barrier(*buffer, RhiResourceState::Common, RhiResourceState::UnorderedAccess);
+
+		commandList.SetPipeline(*m_CullPipeline);
+		commandList.SetComputeRootConstantBufferView(
+			k_ConstantsSlot, DirectXContext::Get()->GetUploadRing().PushConstants(constants));
+		commandList.SetComputeRootShaderResourceView(k_CandidatesSlot, m_CandidateBuffer->GetGpuAddress());
+		commandList.SetComputeRootUnorderedAccessView(k_GroupCountsSlot, m_GroupCountBuffer->GetGpuAddress());
+		commandList.SetComputeRootUnorderedAccessView(k_VisibilitySlot, m_VisibilityBuffer->GetGpuAddress());
+		commandList.SetComputeRootUnorderedAccessView(k_CommandsSlot, m_CommandBuffer->GetGpuAddress());
+		commandList.SetComputeRootUnorderedAccessView(k_CountSlot, m_CountBuffer->GetGpuAddress());
+		commandList.SetComputeRootUnorderedAccessView(k_GroupBasesSlot, m_GroupBaseBuffer->GetGpuAddress());
+		commandList.Dispatch(constants.GroupCount, 1, 1);
+
+		// Same root signature, the arguments stay bound.
+		commandList.UnorderedAccessBarrier(*m_GroupCountBuffer);
+		commandList.UnorderedAccessBarrier(*m_VisibilityBuffer);
+		commandList.SetPipelineState(*m_ScanPipeline);
+		commandList.Dispatch(1, 1, 1);
+
+		commandList.UnorderedAccessBarrier(*m_GroupBaseBuffer);
+		commandList.SetPipelineState(*m_CompactPipeline);
+		commandList.Dispatch(constants.GroupCount, 1, 1);
+
+		commandList.Barrier(*m_CommandBuffer, RhiResourceState::UnorderedAccess, RhiResourceState::IndirectArgument);
+		commandList.Barrier(*m_CountBuffer, RhiResourceState::UnorderedAccess, RhiResourceState::IndirectArgument);
+
+		// ===== Draws =====
+		const ShaderVariantKey variant = m_Shader->SelectVariant(*m_Material);
+		const RhiPipeline& pipeline = m_Shader->GetPipeline(variant);
+		if (!m_CommandSignature || m_SignatureRootSignature != pipeline.GetRootSignatureId())
+		{
+			RhiCommandSignatureDesc signatureDesc;
+			signatureDesc.Arguments = {
+				{RhiIndirectArgumentType::Constants, k_FirstInstanceSlot, 0, 1},
+				{RhiIndirectArgumentType::DrawIndexed},
+			};
+			signatureDesc.ByteStride = sizeof(GpuCulling::DrawCommand);
+			m_CommandSignature = RhiDevice::Get()->CreateCommandSignature(signatureDesc, &pipeline);
+			m_SignatureRootSignature = pipeline.GetRootSignatureId();
+		}
+
+		// Every instance reads its material from the table, the first material only binds the shader.
+		m_Material->Bind(commandList, variant, m_InstanceBuffer->GetGpuAddress(), 0);
+		commandList.SetVertexBuffer(m_Pool->GetVertexBufferView());
+		commandList.SetIndexBuffer(m_Pool->GetIndexBufferView());
+		commandList.SetPrimitiveTopology(RhiPrimitiveTopology::TriangleList);
+		commandList.ExecuteIndirect(*m_CommandSignature, m_Stats.Candidates, *m_CommandBuffer, 0, m_CountBuffer.get(),
+		                            0);
+	}
+
+	GpuCulling::Constants GpuCuller::GetConstants() const
+	{
+		const WorldPosition& camera = DirectXApi::GetCameraWorldPosition();
+		const double originOffset[3] = {m_Origin.x - camera.x, m_Origin.y - camera.y, m_Origin.z - camera.z};
+		return GpuCulling::GetConstants(DirectXApi::GetCameraViewProj(), originOffset,
+		                                static_cast<uint32_t>(m_Objects.size()));
+	}
+
+	void GpuCuller::CreatePipelines()
+	{
+		if (m_CullPipeline)
+			return;
+
+		ShaderCompiler& compiler = DirectXContext::Get()->GetShaderCompiler();
+		const ShaderCompileRequest requests[] = {
+			{k_ShaderPath, "CullCS", "cs_5_1", {}},
+			{k_ShaderPath, "ScanCS", "cs_5_1", {}},
+			{k_ShaderPath, "CompactCS", "cs_5_1", {}},
+		};
+		compiler.CompileAll({std::begin(requests), std::end(requests)});
+
+		RhiPipelineDesc desc;
+		desc.RootParameters = {
+			{RhiRootParameterType::ConstantBuffer, 0},
+			{RhiRootParameterType::ShaderResource, 0},
+			{RhiRootParameterType::UnorderedAccess, 0},
+			{RhiRootParameterType::UnorderedAccess, 1},
+			{RhiRootParameterType::UnorderedAccess, 2},
+			{RhiRootParameterType::UnorderedAccess, 3},
+			{RhiRootParameterType::UnorderedAccess, 4},
+		};
+		// The compiler keeps the bytecode alive, the description only points to it.
+		RhiPipeline** pipelines[] = {&m_CullPipeline, &m_ScanPipeline, &m_CompactPipeline};
+		for (size_t i = 0; i < std::size(requests); ++i)
+		{
+			const ShaderBytecode& byteCode = compiler.Compile(requests[i]);
+			desc.ComputeShader = {byteCode.data(), byteCode.size()};
+			*pipelines[i] = &DirectXContext::Get()->GetPipelineCache().GetPipeline(desc);
+		}
+	}
+
+	void GpuCuller::UploadCandidates()
+	{
+		m_Candidates.clear();
+		m_Candidates.reserve(m_Objects.size());
+		for (const Object* object : m_Objects)
+		{
+			const DirectXMesh* mesh = object->GetMesh();
+			DirectX::BoundingBox bounds;
+			const DirectX::XMFLOAT4X4 world = object->GetWorldMatrixRelativeTo(m_Origin);
+			mesh->GetBounds().Transform(bounds, DirectX::XMLoadFloat4x4(&world));
+
+			const MeshPool::Range& range = m_Pool->GetRange(mesh->GetPoolHandle());
+			m_Candidates.push_back({
+				bounds.Center, range.IndexCount, bounds.Extents, range.StartIndex, range.BaseVertex, {}
+			});
+		}
+		m_PoolCompactions = m_Pool->GetCompactionCount();
+
+		// Uploaded on the copy queue, the frame's submission waits for it.
+		Retire(std::move(m_CandidateBuffer));
+		m_CandidateBuffer = DirectXContext::Get()->GetUploadManager()->CreateBuffer(
+			m_Candidates.data(), m_Candidates.size() * sizeof(GpuCulling::Candidate));
+		m_Stats.Uploads++;
+
+		m_Stats.GpuBytes = 0;
+		for (const auto& buffer : {
+			     m_CandidateBuffer.get(), m_InstanceBuffer.get(), m_GroupCountBuffer.get(), m_GroupBaseBuffer.get(),
+			     m_VisibilityBuffer.get(), m_CommandBuffer.get(), m_CountBuffer.get()
+		     })
+			m_Stats.GpuBytes += buffer->GetDesc().Size;
+	}
+
+	std::unique_ptr<RhiBuffer> GpuCuller::CreateUnorderedAccessBuffer(const uint64_t size)
+	{
+		RhiBufferDesc desc;
+		desc.Size = size;
+		desc.AllowUnorderedAccess = true;
+		return RhiDevice::Get()->CreateBuffer(desc);
+	}
+
+	void GpuCuller::Retire(std::unique_ptr<RhiBuffer> buffer)
+	{
+		if (buffer)
+			m_RetiredBuffers.emplace_back(m_FrameNumber, std::move(buffer));
+	}
+}
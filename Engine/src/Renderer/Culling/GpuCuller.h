@@ -0,0 +1,105 @@
+#pragma once
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "GpuCulling.h"
+#include "Core/WorldPosition.h"
+#include "Renderer/DrawQueue.h"
+#include "Renderer/RHI/RhiDevice.h"
+
+namespace Engine
+{
+	class DirectXMaterial;
+	class DirectXShader;
+	class MeshPool;
+	class Object;
+
+	/// <summary>
+	/// Draws static Objects whose visibility is decided on the GPU : compute passes test their bounds against
+	/// the frustum and write the draws of the visible ones, then a single ExecuteIndirect draws them, the count
+	/// read from a GPU buffer. The CPU records the same commands whatever the camera sees.
+	/// Every Object has to share the mesh pool and the shader variant of the first one, their materials can
+	/// differ. The bounds are taken once, the Objects must not move afterward.
+	/// GpuCulling is the CPU reference of the compute passes.
+	/// </summary>
+	class GpuCuller
+	{
+	public:
+		struct Stats
+		{
+			uint32_t Candidates = 0;
+			// Objects SetObjects() could not take.
+			uint32_t Rejected = 0;
+			uint32_t Groups = 0;
+			// Candidate uploads, the first one and one per compaction of the mesh pool.
+			uint32_t Uploads = 0;
+			// Of every buffer Render() reads or writes.
+			uint64_t GpuBytes = 0;
+		};
+
+		GpuCuller() = default;
+		~GpuCuller();
+
+		GpuCuller(const GpuCuller&) = delete;
+		GpuCuller& operator=(const GpuCuller&) = delete;
+
+		/// <summary>
+		/// Replaces the Objects drawn by Render(). Only lod 0 is drawn.
+		/// </summary>
+		/// <returns> The Objects that cannot be drawn with the first one, to keep rendering them. </returns>
+		std::vector<Object*> SetObjects(Object* const* objects, size_t count);
+
+		/// <summary>
+		/// Call this in between BeginFrame() and EndFrame(). The culling and the draws are recorded right away on
+		/// the frame's list, ahead of the DrawQueue's draws.
+		/// </summary>
+		void Render();
+
+		/// <returns> The cull constants of this frame's camera, what Render() culls with. </returns>
+		GpuCulling::Constants GetConstants() const;
+		/// <returns> The candidates as uploaded, one per Object, in the order they were given. </returns>
+		const std::vector<GpuCulling::Candidate>& GetCandidates() const { return m_Candidates; }
+		const Stats& GetStats() const { return m_Stats; }
+
+	private:
+		void CreatePipelines();
+		// Builds the candidates from the pool's current ranges and uploads them.
+		void UploadCandidates();
+		std::unique_ptr<RhiBuffer> CreateUnorderedAccessBuffer(uint64_t size);
+		// Keeps buffer for the frames in flight.
+		void Retire(std::unique_ptr<RhiBuffer> buffer);
+
+		std::vector<Object*> m_Objects;
+		DirectXMaterial* m_Material = nullptr;
+		DirectXShader* m_Shader = nullptr;
+		const MeshPool* m_Pool = nullptr;
+		uint32_t m_PoolCompactions = 0;
+		// The candidates' bounds are relative to the first Object.
+		WorldPosition m_Origin;
+
+		std::vector<GpuCulling::Candidate> m_Candidates;
+		std::vector<InstanceData> m_Instances;
+		std::unique_ptr<RhiBuffer> m_CandidateBuffer;
+		std::unique_ptr<RhiBuffer> m_InstanceBuffer;
+		std::unique_ptr<RhiBuffer> m_GroupCountBuffer;
+		std::unique_ptr<RhiBuffer> m_GroupBaseBuffer;
+		std::unique_ptr<RhiBuffer> m_VisibilityBuffer;
+		std::unique_ptr<RhiBuffer> m_CommandBuffer;
+		std::unique_ptr<RhiBuffer> m_CountBuffer;
+
+		// Replaced buffers, with the frame they were let go on.
+		std::vector<std::pair<uint64_t, std::unique_ptr<RhiBuffer>>> m_RetiredBuffers;
+		uint64_t m_FrameNumber = 0;
+
+		// They belong to the context's PipelineCache.
+		RhiPipeline* m_CullPipeline = nullptr;
+		RhiPipeline* m_ScanPipeline = nullptr;
+		RhiPipeline* m_CompactPipeline = nullptr;
+		std::unique_ptr<RhiCommandSignature> m_CommandSignature;
+		// Root signature of the draw pipeline the command signature writes gFirstInstance of.
+		const void* m_SignatureRootSignature = nullptr;
+
+		Stats m_Stats;
+	};
+}
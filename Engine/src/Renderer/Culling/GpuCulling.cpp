@@ -0,0 +1,170 @@
+#include "GpuCulling.h"
+
+#include <bit>
+#include <cmath>
+#include <cstring>
+
+#include "Core/JobSystem.h"
+
+namespace Engine
+{
+	namespace
+	{
+		// Groups per job, a group is only 64 box tests.
+		constexpr uint32_t k_MinJobGroups = 16;
+
+		float Flush(const float value)
+		{
+			uint32_t bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+			if ((bits & 0x7F800000u) == 0)
+				bits &= 0x80000000u;
+			float flushed;
+			std::memcpy(&flushed, &bits, sizeof(flushed));
+			return flushed;
+		}
+
+		float Add(const float a, const float b) { return Flush(a + b); }
+		float Mul(const float a, const float b) { return Flush(a * b); }
+	}
+
+	void GpuCulling::Output::Resize(const uint32_t candidateCount)
+	{
+		const uint32_t groupCount = GetGroupCount(candidateCount);
+		GroupCounts.assign(groupCount, 0);
+		GroupBases.assign(groupCount, 0);
+		Visibility.assign(groupCount * 2, 0);
+		Commands.assign(candidateCount, {});
+		CommandCount = 0;
+	}
+
+	GpuCulling::Constants GpuCulling::GetConstants(const DirectX::XMFLOAT4X4& viewProj,
+	                                               const double (&originOffset)[3], const uint32_t candidateCount)
+	{
+		// With row vectors, clip = point * viewProj : the planes are sums of its columns.
+		const auto column = [&viewProj](const int j, double (&out)[4])
+		{
+			for (int i = 0; i < 4; ++i)
+				out[i] = viewProj.m[i][j];
+		};
+		double x[4], y[4], z[4], w[4];
+		column(0, x);
+		column(1, y);
+		column(2, z);
+		column(3, w);
+
+		// D3D clip space : -w <= x <= w, -w <= y <= w, 0 <= z <= w.
+		double planes[6][4];
+		for (int i = 0; i < 4; ++i)
+		{
+			planes[0][i] = w[i] + x[i];
+			planes[1][i] = w[i] - x[i];
+			planes[2][i] = w[i] + y[i];
+			planes[3][i] = w[i] - y[i];
+			planes[4][i] = z[i];
+			planes[5][i] = w[i] - z[i];
+		}
+
+		Constants constants = {};
+		for (int p = 0; p < 6; ++p)
+		{
+			double* plane = planes[p];
+			// Moved from the camera to the candidates' origin, then normalized so the floats keep their precision.
+			plane[3] += plane[0] * originOffset[0] + plane[1] * originOffset[1] + plane[2] * originOffset[2];
+			const double length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+			const double scale = length > 0.0 ? 1.0 / length : 1.0;
+			constants.Planes[p] = {
+				Flush(static_cast<float>(plane[0] * scale)), Flush(static_cast<float>(plane[1] * scale)),
+				Flush(static_cast<float>(plane[2] * scale)), Flush(static_cast<float>(plane[3] * scale))
+			};
+		}
+		constants.CandidateCount = candidateCount;
+		constants.GroupCount = GetGroupCount(candidateCount);
+		return constants;
+	}
+
+	bool GpuCulling::IsVisible(const Candidate& candidate, const DirectX::XMFLOAT4 (&planes)[6])
+	{
+		const float cx = Flush(candidate.Center.x), cy = Flush(candidate.Center.y), cz = Flush(candidate.Center.z);
+		const float ex = Flush(candidate.Extents.x), ey = Flush(candidate.Extents.y), ez = Flush(candidate.Extents.z);
+		for (const DirectX::XMFLOAT4& plane : planes)
+		{
+			const float px = Flush(plane.x), py = Flush(plane.y), pz = Flush(plane.z), pw = Flush(plane.w);
+			// Same order as the shader : ((x + y) + z) + w.
+			const float distance = Add(Add(Add(Mul(cx, px), Mul(cy, py)), Mul(cz, pz)), pw);
+			const float radius = Add(Add(Mul(ex, std::fabs(px)), Mul(ey, std::fabs(py))), Mul(ez, std::fabs(pz)));
+			if (Add(distance, radius) < 0.f)
+				return false;
+		}
+		return true;
+	}
+
+	void GpuCulling::CullGroup(const Constants& constants, const Candidate* candidates, const uint32_t group,
+	                           Output& output)
+	{
+		uint32_t mask[2] = {};
+		const uint32_t first = group * k_GroupSize;
+		for (uint32_t thread = 0; thread < k_GroupSize; ++thread)
+		{
+			const uint32_t index = first + thread;
+			if (index < constants.CandidateCount && IsVisible(candidates[index], constants.Planes))
+				mask[thread / 32] |= 1u << (thread % 32);
+		}
+		output.Visibility[group * 2] = mask[0];
+		output.Visibility[group * 2 + 1] = mask[1];
+		output.GroupCounts[group] = std::popcount(mask[0]) + std::popcount(mask[1]);
+	}
+
+	void GpuCulling::ScanGroups(const Constants& constants, Output& output)
+	{
+		uint32_t base = 0;
+		for (uint32_t group = 0; group < constants.GroupCount; ++group)
+		{
+			output.GroupBases[group] = base;
+			base += output.GroupCounts[group];
+		}
+		output.CommandCount = base;
+	}
+
+	void GpuCulling::CompactGroup(const Constants&, const Candidate* candidates, const uint32_t group, Output& output)
+	{
+		const uint32_t base = output.GroupBases[group];
+		const uint32_t mask[2] = {output.Visibility[group * 2], output.Visibility[group * 2 + 1]};
+		const uint32_t first = group * k_GroupSize;
+		for (uint32_t thread = 0; thread < k_GroupSize; ++thread)
+		{
+			const uint32_t bit = 1u << (thread % 32);
+			if (!(mask[thread / 32] & bit))
+				continue;
+
+			// Visible candidates of the group before this one.
+			const uint32_t below = thread < 32
+				                       ? std::popcount(mask[0] & (bit - 1))
+				                       : std::popcount(mask[0]) + std::popcount(mask[1] & (bit - 1));
+			const Candidate& candidate = candidates[first + thread];
+			DrawCommand& command = output.Commands[base + below];
+			command.FirstInstance = first + thread;
+			command.Draw = {candidate.IndexCount, 1, candidate.StartIndex, candidate.BaseVertex, 0};
+		}
+	}
+
+	uint32_t GpuCulling::Run(const Constants& constants, const Candidate* candidates, Output& output)
+	{
+		output.CommandCount = 0;
+		if (constants.GroupCount == 0)
+			return 0;
+
+		JobSystem::ParallelFor(constants.GroupCount, k_MinJobGroups, [&](const uint32_t pFirst, const uint32_t pLast, uint32_t)
+		{
+			for (uint32_t group = pFirst; group < pLast; ++group)
+				CullGroup(constants, candidates, group, output);
+		});
+		ScanGroups(constants, output);
+		JobSystem::ParallelFor(constants.GroupCount, k_MinJobGroups, [&](const uint32_t pFirst, const uint32_t pLast, uint32_t)
+		{
+			for (uint32_t group = pFirst; group < pLast; ++group)
+				CompactGroup(constants, candidates, group, output);
+		});
+		return output.CommandCount;
+	}
+}
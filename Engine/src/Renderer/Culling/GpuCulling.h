@@ -0,0 +1,114 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <DirectXMath.h>
+
+#include "Renderer/RHI/RhiTypes.h"
+
+namespace Engine
+{
+	/// <summary>
+	/// Frustum culling of Builtin.Cull.hlsl, and its CPU reference. The structs are the shader's buffers, the
+	/// functions run its thread groups one at a time, with the same operations in the same order : given the same
+	/// Constants and candidates, CullCS and CompactCS write the same bytes as Run().
+	/// CullGroup() tests the group's candidates and writes their visibility mask and count. ScanGroups(), a single
+	/// group, sums the counts into each group's first draw and the draw count. CompactGroup() then writes the
+	/// visible ones' draws from there, so the draws keep the candidates' order whatever the order the groups run in.
+	/// Floats are flushed to zero when denormal, as GPU arithmetic does. The CPU code must be built without
+	/// fused multiply-adds, the default for x64 without /arch:AVX2 or -mfma; the shader marks its math precise.
+	/// </summary>
+	class GpuCulling
+	{
+	public:
+		// Threads of a group, one candidate each. The visibility mask of a group is two uints.
+		static constexpr uint32_t k_GroupSize = 64;
+
+		/// <summary>
+		/// StructuredBuffer&lt;Candidate&gt; gCandidates : register(t0), 48 bytes.
+		/// </summary>
+		struct Candidate
+		{
+			// Box of the object, relative to the origin the planes were shifted to (see GetConstants()).
+			DirectX::XMFLOAT3 Center;
+			uint32_t IndexCount;
+			DirectX::XMFLOAT3 Extents;
+			uint32_t StartIndex;
+			int32_t BaseVertex;
+			uint32_t Padding[3];
+		};
+
+		/// <summary>
+		/// cbuffer cbCull : register(b0), 112 bytes.
+		/// </summary>
+		struct Constants
+		{
+			// Left, right, bottom, top, near, far. A point is inside when dot(p.xyz, point) + p.w >= 0.
+			DirectX::XMFLOAT4 Planes[6];
+			uint32_t CandidateCount;
+			uint32_t GroupCount;
+			uint32_t Padding[2];
+		};
+
+		/// <summary>
+		/// One command of the ExecuteIndirect : a root constant, gFirstInstance of the draw shaders, then the draw.
+		/// RWStructuredBuffer&lt;DrawCommand&gt; gCommands : register(u2), 24 bytes.
+		/// </summary>
+		struct DrawCommand
+		{
+			uint32_t FirstInstance;
+			RhiDrawIndexedArguments Draw;
+		};
+
+		/// <summary>
+		/// What the passes write, sized by Resize() : the GPU buffers' content.
+		/// </summary>
+		struct Output
+		{
+			std::vector<uint32_t> GroupCounts;
+			// Visible candidates of the groups before each one.
+			std::vector<uint32_t> GroupBases;
+			// Two uints per group, bit i of the first is candidate i of the group, of the second candidate 32 + i.
+			std::vector<uint32_t> Visibility;
+			std::vector<DrawCommand> Commands;
+			uint32_t CommandCount = 0;
+
+			void Resize(uint32_t candidateCount);
+		};
+
+		/// <param name="viewProj"> : row-major (non transposed) view projection of a camera at the origin</param>
+		/// <param name="originOffset"> : position of the candidates' origin relative to the camera, in double so
+		/// the planes stay precise far from the world origin</param>
+		/// <param name="candidateCount"></param>
+		static Constants GetConstants(const DirectX::XMFLOAT4X4& viewProj, const double (&originOffset)[3],
+		                              uint32_t candidateCount);
+
+		static uint32_t GetGroupCount(const uint32_t candidateCount)
+		{
+			return (candidateCount + k_GroupSize - 1) / k_GroupSize;
+		}
+
+		/// <returns> True when the box is on the inner side of every plane, or crosses it. </returns>
+		static bool IsVisible(const Candidate& candidate, const DirectX::XMFLOAT4 (&planes)[6]);
+
+		/// <summary>
+		/// CullCS of group group.
+		/// </summary>
+		static void CullGroup(const Constants& constants, const Candidate* candidates, uint32_t group,
+		                      Output& output);
+		/// <summary>
+		/// ScanCS, once every group was culled : writes GroupBases and CommandCount.
+		/// </summary>
+		static void ScanGroups(const Constants& constants, Output& output);
+		/// <summary>
+		/// CompactCS of group group, once the groups were scanned.
+		/// </summary>
+		static void CompactGroup(const Constants& constants, const Candidate* candidates, uint32_t group,
+		                         Output& output);
+
+		/// <summary>
+		/// Runs the three passes, the groups of the cull and compact ones split across the JobSystem threads.
+		/// </summary>
+		/// <returns> The number of draws written. </returns>
+		static uint32_t Run(const Constants& constants, const Candidate* candidates, Output& output);
+	};
+}
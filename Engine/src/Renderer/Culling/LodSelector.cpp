@@ -0,0 +1,112 @@
+#include "LodSelector.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Core/JobSystem.h"
+
+namespace Engine
+{
+	namespace
+	{
+		// Objects per job, small batches are not worth waking the workers for.
+		constexpr uint32_t k_MinJobRange = 4096;
+		// Keeps the projected size finite when the camera is inside a bounding sphere.
+		constexpr float k_MinDistance = 1e-3f;
+
+		uint8_t CoarsestLod(const float (&errors)[LodSelector::k_MaxLods], const uint32_t lodCount,
+		                    const float maxError)
+		{
+			uint8_t lod = 0;
+			for (uint32_t i = 1; i < lodCount; ++i)
+			{
+				if (errors[i] <= maxError)
+					lod = static_cast<uint8_t>(i);
+			}
+			return lod;
+		}
+	}
+
+	void LodSelector::SetView(const DirectX::XMFLOAT3& cameraPosition, const float fovDegree,
+	                          const float viewportHeight)
+	{
+		m_CameraPosition = cameraPosition;
+		m_PixelScale = viewportHeight / (2.f * std::tan(DirectX::XMConvertToRadians(fovDegree) * 0.5f));
+
+		for (auto& selected : m_Selected)
+			selected.store(0, std::memory_order_relaxed);
+		m_Culled.store(0, std::memory_order_relaxed);
+	}
+
+	void LodSelector::Select(const DirectX::BoundingSphere* spheres, const LodGroup* const* groups, uint8_t* lods,
+	                         const uint32_t count)
+	{
+		JobSystem::ParallelFor(count, k_MinJobRange, [&](const uint32_t pFirst, const uint32_t pLast, uint32_t)
+		{
+			SelectRange(spheres, groups, lods, pFirst, pLast);
+		});
+	}
+
+	LodSelector::Stats LodSelector::GetStats() const
+	{
+		Stats stats;
+		for (uint32_t i = 0; i < k_MaxLods; ++i)
+			stats.Selected[i] = m_Selected[i].load(std::memory_order_relaxed);
+		stats.Culled = m_Culled.load(std::memory_order_relaxed);
+		return stats;
+	}
+
+	void LodSelector::SelectRange(const DirectX::BoundingSphere* spheres, const LodGroup* const* groups, uint8_t* lods,
+	                              const uint32_t first, const uint32_t last)
+	{
+		const float cx = m_CameraPosition.x;
+		const float cy = m_CameraPosition.y;
+		const float cz = m_CameraPosition.z;
+		const float invPixelScale = 1.f / m_PixelScale;
+
+		// Culling is sticky until the object grows past the upper bound, coarser lods need a lower error
+		// than finer ones: in between, the previous selection is kept.
+		const float minSize = m_Settings.MinPixelSize;
+		const float minSizeToShow = m_Settings.MinPixelSize * (1.f + m_Settings.Hysteresis);
+		const float maxErrorToRefine = m_Settings.MaxPixelError * invPixelScale;
+		const float maxErrorToCoarsen = m_Settings.MaxPixelError * (1.f - m_Settings.Hysteresis) * invPixelScale;
+
+		uint32_t selected[k_MaxLods] = {};
+		uint32_t culled = 0;
+		for (uint32_t i = first; i < last; ++i)
+		{
+			const DirectX::BoundingSphere& sphere = spheres[i];
+			const float dx = sphere.Center.x - cx;
+			const float dy = sphere.Center.y - cy;
+			const float dz = sphere.Center.z - cz;
+			const float distance = (std::max)(std::sqrt(dx * dx + dy * dy + dz * dz) - sphere.Radius, k_MinDistance);
+
+			const uint8_t previous = lods[i];
+			const float projectedSize = 2.f * sphere.Radius * m_PixelScale / distance;
+			if (projectedSize < (previous == k_Culled ? minSizeToShow : minSize))
+			{
+				lods[i] = k_Culled;
+				++culled;
+				continue;
+			}
+
+			// Errors are compared in world units at the object's distance instead of projecting each of them.
+			const LodGroup& group = *groups[i];
+			const uint32_t lodCount = (std::min)(group.LodCount, k_MaxLods);
+			const uint8_t finest = CoarsestLod(group.GeometricErrors, lodCount, maxErrorToCoarsen * distance);
+			const uint8_t coarsest = CoarsestLod(group.GeometricErrors, lodCount, maxErrorToRefine * distance);
+			const uint8_t lod = previous == k_Culled ? finest : std::clamp(previous, finest, coarsest);
+
+			lods[i] = lod;
+			++selected[lod];
+		}
+
+		for (uint32_t lod = 0; lod < k_MaxLods; ++lod)
+		{
+			if (selected[lod])
+				m_Selected[lod].fetch_add(selected[lod], std::memory_order_relaxed);
+		}
+		if (culled)
+			m_Culled.fetch_add(culled, std::memory_order_relaxed);
+	}
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <DirectXMath.h>
+#include <DirectXCollision.h>
+
+namespace Engine
+{
+	/// <summary>
+	/// Picks a level of detail for each object from the error it would make on screen, in pixels.
+	/// Runs after visibility culling, on arrays of bounding spheres, without allocating.
+	/// Objects smaller than Settings::MinPixelSize are dropped entirely (contribution culling).
+	/// </summary>
+	class LodSelector
+	{
+	public:
+		static constexpr uint32_t k_MaxLods = 4;
+		// Lod index written for objects too small to be worth drawing.
+		static constexpr uint8_t k_Culled = 0xFF;
+
+		struct Settings
+		{
+			// Highest geometric error allowed on screen, in pixels.
+			float MaxPixelError = 1.f;
+			// Objects whose projected diameter is below this, in pixels, are culled.
+			float MinPixelSize = 2.f;
+			// Fraction of the thresholds used as a dead zone so objects do not flicker between two lods.
+			float Hysteresis = 0.15f;
+		};
+
+		/// <summary>
+		/// Geometric error of each lod, in world units. GeometricErrors[0] is usually 0 and errors must increase.
+		/// </summary>
+		struct LodGroup
+		{
+			float GeometricErrors[k_MaxLods] = {};
+			uint32_t LodCount = 1;
+		};
+
+		struct Stats
+		{
+			uint32_t Selected[k_MaxLods] = {};
+			uint32_t Culled = 0;
+		};
+
+		LodSelector() = default;
+		explicit LodSelector(const Settings& settings) : m_Settings(settings) {}
+
+		void SetSettings(const Settings& settings) { m_Settings = settings; }
+		const Settings& GetSettings() const { return m_Settings; }
+
+		/// <summary>
+		/// Sets the camera used by the next Select() calls and clears the statistics.
+		/// </summary>
+		/// <param name="cameraPosition"> : world space camera position</param>
+		/// <param name="fovDegree"> : vertical field of view</param>
+		/// <param name="viewportHeight"> : in pixels</param>
+		void SetView(const DirectX::XMFLOAT3& cameraPosition, float fovDegree, float viewportHeight);
+
+		/// <summary>
+		/// Selects the lod of count objects. lods holds the previous frame selection (0 the first time)
+		/// and receives the new one, or k_Culled. Large batches are split across the JobSystem threads.
+		/// </summary>
+		/// <param name="spheres"> : world space bounding spheres</param>
+		/// <param name="groups"> : lod errors of each object</param>
+		/// <param name="lods"> : in/out lod indices</param>
+		void Select(const DirectX::BoundingSphere* spheres, const LodGroup* const* groups, uint8_t* lods,
+		            uint32_t count);
+
+		/// <returns> The number of objects per lod selected since the last SetView(). </returns>
+		Stats GetStats() const;
+
+	private:
+		void SelectRange(const DirectX::BoundingSphere* spheres, const LodGroup* const* groups, uint8_t* lods,
+		                 uint32_t first, uint32_t last);
+
+		Settings m_Settings;
+
+		DirectX::XMFLOAT3 m_CameraPosition = {0.f, 0.f, 0.f};
+		// Pixels covered by one world unit seen at a distance of one world unit.
+		float m_PixelScale = 1.f;
+
+		std::atomic<uint32_t> m_Selected[k_MaxLods] = {};
+		std::atomic<uint32_t> m_Culled = 0;
+	};
+}
@@ -0,0 +1,322 @@
+#include "OcclusionCuller.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <immintrin.h>
+
+#include "Core/JobSystem.h"
+
+namespace Engine
+{
+	namespace
+	{
+		// Vertices closer than this (in clip space w) are rejected rather than clipped.
+		constexpr float k_NearW = 1e-4f;
+	}
+
+	OcclusionCuller::OcclusionCuller(const uint32_t width, const uint32_t height)
+		: m_ScreenWidth(static_cast<float>(width)), m_ScreenHeight(static_cast<float>(height)),
+		  m_Width((width + k_TileSize - 1) / k_TileSize * k_TileSize),
+		  m_Height((height + k_TileSize - 1) / k_TileSize * k_TileSize)
+	{
+		m_TilesX = m_Width / k_TileSize;
+		m_TilesY = m_Height / k_TileSize;
+		m_Depth.assign(static_cast<size_t>(m_Width) * m_Height, 1.f);
+		m_TileMaxDepth.assign(static_cast<size_t>(m_TilesX) * m_TilesY, 1.f);
+		DirectX::XMStoreFloat4x4(&m_ViewProj, DirectX::XMMatrixIdentity());
+	}
+
+	void OcclusionCuller::BeginFrame(const DirectX::XMFLOAT4X4& viewProj)
+	{
+		m_ViewProj = viewProj;
+		m_Occluders.clear();
+		m_TriangleCount = 0;
+		m_OccluderTriangles = 0;
+		m_Tested.store(0, std::memory_order_relaxed);
+		m_Culled.store(0, std::memory_order_relaxed);
+	}
+
+	void OcclusionCuller::AddOccluder(const DirectX::XMFLOAT3* positions, const uint32_t* indices,
+	                                  const uint32_t indexCount, const DirectX::XMFLOAT4X4& world)
+	{
+		Occluder occluder;
+		occluder.Positions = positions;
+		occluder.Indices = indices;
+		occluder.IndexCount = indexCount;
+		occluder.FirstTriangle = m_TriangleCount;
+		DirectX::XMStoreFloat4x4(&occluder.WorldViewProj,
+		                         DirectX::XMMatrixMultiply(DirectX::XMLoadFloat4x4(&world),
+		                                                   DirectX::XMLoadFloat4x4(&m_ViewProj)));
+		m_Occluders.push_back(occluder);
+		m_TriangleCount += indexCount / 3;
+	}
+
+	void OcclusionCuller::Rasterize()
+	{
+		if (m_Triangles.size() < m_TriangleCount)
+			m_Triangles.resize(m_TriangleCount);
+
+		JobSystem::ParallelFor(static_cast<uint32_t>(m_Occluders.size()), 1,
+		                       [this](const uint32_t pFirst, const uint32_t pLast, uint32_t)
+		                       {
+			                       for (uint32_t i = pFirst; i < pLast; ++i)
+				                       TransformOccluder(m_Occluders[i]);
+		                       });
+
+		// Each worker owns a band of tile rows, so no two threads ever write the same pixel.
+		JobSystem::ParallelFor(m_TilesY, 1, [this](const uint32_t pFirst, const uint32_t pLast, uint32_t)
+		{
+			RasterizeRows(pFirst, pLast);
+		});
+
+		m_OccluderTriangles = m_TriangleCount;
+	}
+
+	OcclusionCuller::Stats OcclusionCuller::GetStats() const
+	{
+		Stats stats;
+		stats.OccluderTriangles = m_OccluderTriangles;
+		stats.Tested = m_Tested.load(std::memory_order_relaxed);
+		stats.Culled = m_Culled.load(std::memory_order_relaxed);
+		return stats;
+	}
+
+	void OcclusionCuller::TransformOccluder(const Occluder& occluder)
+	{
+		const DirectX::XMMATRIX worldViewProj = DirectX::XMLoadFloat4x4(&occluder.WorldViewProj);
+
+		for (uint32_t t = 0; t < occluder.IndexCount / 3; ++t)
+		{
+			ScreenTriangle& triangle = m_Triangles[occluder.FirstTriangle + t];
+			triangle.MinY = 1.f;
+			triangle.MaxY = 0.f;
+
+			bool isValid = true;
+			for (int v = 0; v < 3 && isValid; ++v)
+			{
+				const DirectX::XMVECTOR position = DirectX::XMLoadFloat3(&occluder.Positions[occluder.Indices[t * 3 + v]]);
+				DirectX::XMFLOAT4 clip;
+				DirectX::XMStoreFloat4(&clip, DirectX::XMVector3Transform(position, worldViewProj));
+
+				// Dropping a triangle crossing the near plane only makes the culling more conservative.
+				if (clip.w < k_NearW)
+				{
+					isValid = false;
+					break;
+				}
+
+				const float invW = 1.f / clip.w;
+				triangle.X[v] = (clip.x * invW * 0.5f + 0.5f) * m_ScreenWidth;
+				triangle.Y[v] = (0.5f - clip.y * invW * 0.5f) * m_ScreenHeight;
+				triangle.Z[v] = clip.z * invW;
+			}
+
+			if (!isValid)
+				continue;
+
+			triangle.MinY = (std::min)({triangle.Y[0], triangle.Y[1], triangle.Y[2]});
+			triangle.MaxY = (std::max)({triangle.Y[0], triangle.Y[1], triangle.Y[2]});
+		}
+	}
+
+	void OcclusionCuller::RasterizeRows(const uint32_t firstTileRow, const uint32_t lastTileRow)
+	{
+		const int rowMin = static_cast<int>(firstTileRow * k_TileSize);
+		const int rowMax = static_cast<int>(lastTileRow * k_TileSize);
+		std::fill(m_Depth.begin() + static_cast<size_t>(rowMin) * m_Width,
+		          m_Depth.begin() + static_cast<size_t>(rowMax) * m_Width, 1.f);
+
+		for (uint32_t i = 0; i < m_TriangleCount; ++i)
+		{
+			const ScreenTriangle& triangle = m_Triangles[i];
+			if (triangle.MinY > triangle.MaxY || triangle.MaxY < rowMin || triangle.MinY >= rowMax)
+				continue;
+			RasterizeTriangle(triangle, rowMin, rowMax);
+		}
+
+		for (uint32_t tileY = firstTileRow; tileY < lastTileRow; ++tileY)
+		{
+			for (uint32_t tileX = 0; tileX < m_TilesX; ++tileX)
+			{
+				float maxDepth = 0.f;
+				for (uint32_t y = 0; y < k_TileSize; ++y)
+				{
+					const float* row = &m_Depth[static_cast<size_t>(tileY * k_TileSize + y) * m_Width + tileX * k_TileSize];
+					for (uint32_t x = 0; x < k_TileSize; ++x)
+						maxDepth = (std::max)(maxDepth, row[x]);
+				}
+				m_TileMaxDepth[tileY * m_TilesX + tileX] = maxDepth;
+			}
+		}
+	}
+
+	void OcclusionCuller::RasterizeTriangle(const ScreenTriangle& triangle, const int rowMin, const int rowMax)
+	{
+		float x0 = triangle.X[0], y0 = triangle.Y[0], z0 = triangle.Z[0];
+		float x1 = triangle.X[1], y1 = triangle.Y[1], z1 = triangle.Z[1];
+		float x2 = triangle.X[2], y2 = triangle.Y[2], z2 = triangle.Z[2];
+
+		float area = (x1 - x0) * (y2 - y0) - (x2 - x0) * (y1 - y0);
+		if (std::fabs(area) < 1e-6f)
+			return;
+
+		// Occluders are rasterized without backface culling, so bring every triangle to the same winding.
+		if (area < 0.f)
+		{
+			std::swap(x1, x2);
+			std::swap(y1, y2);
+			std::swap(z1, z2);
+			area = -area;
+		}
+
+		// Edge functions E(x, y) = A * x + B * y + C, positive inside the triangle.
+		const float a0 = y1 - y2, b0 = x2 - x1, c0 = -(a0 * x1 + b0 * y1);
+		const float a1 = y2 - y0, b1 = x0 - x2, c1 = -(a1 * x2 + b1 * y2);
+		const float a2 = y0 - y1, b2 = x1 - x0, c2 = -(a2 * x0 + b2 * y0);
+
+		// Depth plane, z/w is linear in screen space. Pixels keep the farthest depth of the plane within their
+		// square, IsVisible() may look at a pixel for any point of it.
+		const float invArea = 1.f / area;
+		const float zx = (a0 * z0 + a1 * z1 + a2 * z2) * invArea;
+		const float zy = (b0 * z0 + b1 * z1 + b2 * z2) * invArea;
+		const float zc = (c0 * z0 + c1 * z1 + c2 * z2) * invArea + 0.5f * (std::fabs(zx) + std::fabs(zy));
+
+		// Only the pixels the triangle covers entirely are written : the edge functions are moved in by half a
+		// pixel, to the pixel's corner farthest inside, and still tested at the centre.
+		const float ic0 = c0 - 0.5f * (std::fabs(a0) + std::fabs(b0));
+		const float ic1 = c1 - 0.5f * (std::fabs(a1) + std::fabs(b1));
+		const float ic2 = c2 - 0.5f * (std::fabs(a2) + std::fabs(b2));
+
+		// Clamped as floats, a vertex close to the near plane can be far outside the int range.
+		const float lastX = static_cast<float>(m_Width - 1);
+		const float firstY = static_cast<float>(rowMin), lastY = static_cast<float>(rowMax - 1);
+		const int minX = static_cast<int>(std::floor(std::clamp((std::min)({x0, x1, x2}), 0.f, lastX)));
+		const int maxX = static_cast<int>(std::ceil(std::clamp((std::max)({x0, x1, x2}), 0.f, lastX)));
+		const int minY = static_cast<int>(std::floor(std::clamp((std::min)({y0, y1, y2}), firstY, lastY)));
+		const int maxY = static_cast<int>(std::ceil(std::clamp((std::max)({y0, y1, y2}), firstY, lastY)));
+		// Off the buffer, the range is squashed on its border where no pixel passes the edge tests.
+
+#if defined(__AVX2__)
+		const int startX = minX & ~7;
+		const __m256 laneOffsets = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+		const __m256 zero = _mm256_setzero_ps();
+		const __m256 ea0 = _mm256_set1_ps(a0), ea1 = _mm256_set1_ps(a1), ea2 = _mm256_set1_ps(a2);
+		const __m256 depthX = _mm256_set1_ps(zx);
+
+		for (int y = minY; y <= maxY; ++y)
+		{
+			const float py = static_cast<float>(y) + 0.5f;
+			const __m256 rowE0 = _mm256_set1_ps(b0 * py + ic0);
+			const __m256 rowE1 = _mm256_set1_ps(b1 * py + ic1);
+			const __m256 rowE2 = _mm256_set1_ps(b2 * py + ic2);
+			const __m256 rowZ = _mm256_set1_ps(zy * py + zc);
+			float* row = &m_Depth[static_cast<size_t>(y) * m_Width];
+
+			for (int x = startX; x <= maxX; x += 8)
+			{
+				const __m256 px = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(x)), laneOffsets);
+				const __m256 e0 = _mm256_fmadd_ps(ea0, px, rowE0);
+				const __m256 e1 = _mm256_fmadd_ps(ea1, px, rowE1);
+				const __m256 e2 = _mm256_fmadd_ps(ea2, px, rowE2);
+				const __m256 inside = _mm256_and_ps(_mm256_cmp_ps(e0, zero, _CMP_GE_OQ),
+				                                    _mm256_and_ps(_mm256_cmp_ps(e1, zero, _CMP_GE_OQ),
+				                                                  _mm256_cmp_ps(e2, zero, _CMP_GE_OQ)));
+				if (_mm256_testz_ps(inside, inside))
+					continue;
+
+				const __m256 depth = _mm256_fmadd_ps(depthX, px, rowZ);
+				const __m256 current = _mm256_loadu_ps(row + x);
+				_mm256_storeu_ps(row + x, _mm256_blendv_ps(current, _mm256_min_ps(current, depth), inside));
+			}
+		}
+#else
+		for (int y = minY; y <= maxY; ++y)
+		{
+			const float py = static_cast<float>(y) + 0.5f;
+			float* row = &m_Depth[static_cast<size_t>(y) * m_Width];
+			for (int x = minX; x <= maxX; ++x)
+			{
+				const float px = static_cast<float>(x) + 0.5f;
+				if (a0 * px + b0 * py + ic0 < 0.f || a1 * px + b1 * py + ic1 < 0.f || a2 * px + b2 * py + ic2 < 0.f)
+					continue;
+				row[x] = (std::min)(row[x], zx * px + zy * py + zc);
+			}
+		}
+#endif
+	}
+
+	bool OcclusionCuller::IsVisible(const DirectX::BoundingBox& worldBounds)
+	{
+		m_Tested.fetch_add(1, std::memory_order_relaxed);
+
+		DirectX::XMFLOAT3 corners[DirectX::BoundingBox::CORNER_COUNT];
+		worldBounds.GetCorners(corners);
+
+		const DirectX::XMMATRIX viewProj = DirectX::XMLoadFloat4x4(&m_ViewProj);
+		DirectX::XMFLOAT4 clips[DirectX::BoundingBox::CORNER_COUNT];
+		// One bit per frustum plane (-x, +x, -y, +y, near, far), set while every corner is outside of it.
+		uint32_t outside = 0x3F;
+		bool isCrossingNear = false;
+		for (size_t i = 0; i < DirectX::BoundingBox::CORNER_COUNT; ++i)
+		{
+			DirectX::XMFLOAT4& clip = clips[i];
+			DirectX::XMStoreFloat4(&clip, DirectX::XMVector3Transform(DirectX::XMLoadFloat3(&corners[i]), viewProj));
+			outside &= (clip.x < -clip.w ? 0x1 : 0) | (clip.x > clip.w ? 0x2 : 0) | (clip.y < -clip.w ? 0x4 : 0) |
+				(clip.y > clip.w ? 0x8 : 0) | (clip.z < 0.f ? 0x10 : 0) | (clip.z > clip.w ? 0x20 : 0);
+			isCrossingNear |= clip.w < k_NearW;
+		}
+
+		if (outside != 0)
+		{
+			m_Culled.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+		// Crossing the near plane : the box surrounds the camera, keep it.
+		if (isCrossingNear)
+			return true;
+
+		float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX, minZ = FLT_MAX;
+		for (const DirectX::XMFLOAT4& clip : clips)
+		{
+			const float invW = 1.f / clip.w;
+			const float x = (clip.x * invW * 0.5f + 0.5f) * m_ScreenWidth;
+			const float y = (0.5f - clip.y * invW * 0.5f) * m_ScreenHeight;
+			minX = (std::min)(minX, x);
+			maxX = (std::max)(maxX, x);
+			minY = (std::min)(minY, y);
+			maxY = (std::max)(maxY, y);
+			minZ = (std::min)(minZ, clip.z * invW);
+		}
+
+		// A covered pixel is covered entirely, every pixel the box's rectangle overlaps is tested. Clamped as
+		// floats first, the rectangle can be far outside the int range.
+		const float lastX = static_cast<float>(m_Width - 1), lastY = static_cast<float>(m_Height - 1);
+		const int pixelMinX = static_cast<int>(std::floor(std::clamp(minX, 0.f, lastX)));
+		const int pixelMaxX = static_cast<int>(std::floor(std::clamp(maxX, 0.f, lastX)));
+		const int pixelMinY = static_cast<int>(std::floor(std::clamp(minY, 0.f, lastY)));
+		const int pixelMaxY = static_cast<int>(std::floor(std::clamp(maxY, 0.f, lastY)));
+
+		for (int tileY = pixelMinY / static_cast<int>(k_TileSize); tileY <= pixelMaxY / static_cast<int>(k_TileSize); ++tileY)
+		{
+			for (int tileX = pixelMinX / static_cast<int>(k_TileSize); tileX <= pixelMaxX / static_cast<int>(k_TileSize); ++tileX)
+			{
+				if (m_TileMaxDepth[tileY * m_TilesX + tileX] < minZ)
+					continue;
+
+				// The tile is not fully covered in front of the box, look at the pixels the box overlaps.
+				const int x0 = (std::max)(pixelMinX, tileX * static_cast<int>(k_TileSize));
+				const int x1 = (std::min)(pixelMaxX, (tileX + 1) * static_cast<int>(k_TileSize) - 1);
+				const int y0 = (std::max)(pixelMinY, tileY * static_cast<int>(k_TileSize));
+				const int y1 = (std::min)(pixelMaxY, (tileY + 1) * static_cast<int>(k_TileSize) - 1);
+				for (int y = y0; y <= y1; ++y)
+					for (int x = x0; x <= x1; ++x)
+						if (m_Depth[static_cast<size_t>(y) * m_Width + x] >= minZ)
+							return true;
+			}
+		}
+
+		m_Culled.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+}
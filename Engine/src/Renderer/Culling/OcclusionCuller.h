@@ -0,0 +1,110 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include <DirectXMath.h>
+#include <DirectXCollision.h>
+
+namespace Engine
+{
+	/// <summary>
+	/// Coarse software occlusion culling : occluder triangles are rasterized on the CPU in a low resolution
+	/// depth buffer (8 pixels at a time with AVX2, one screen band per worker thread), then the farthest depth
+	/// of each tile is kept so occludee bounds can be rejected with a couple of tile reads. Boxes outside the view
+	/// frustum are rejected first, the engine has no other CPU frustum culling.
+	/// It only depends on DirectXMath so it can run without a GPU.
+	/// </summary>
+	class OcclusionCuller
+	{
+	public:
+		static constexpr uint32_t k_TileSize = 8;
+
+		struct Stats
+		{
+			uint32_t OccluderTriangles = 0;
+			uint32_t Tested = 0;
+			uint32_t Culled = 0;
+
+			float GetCulledPercent() const { return Tested ? 100.f * static_cast<float>(Culled) / Tested : 0.f; }
+		};
+
+		/// <param name="width"> : resolution the screen is rasterized at. The depth buffer is rounded up to a
+		/// multiple of k_TileSize.</param>
+		/// <param name="height"> : same, vertically</param>
+		OcclusionCuller(uint32_t width = 256, uint32_t height = 144);
+
+		/// <summary>
+		/// Clears the occluders and the statistics of the previous frame.
+		/// </summary>
+		/// <param name="viewProj"> : row-major (non transposed) view projection matrix</param>
+		void BeginFrame(const DirectX::XMFLOAT4X4& viewProj);
+
+		/// <summary>
+		/// Queues an indexed triangle list to be rasterized as an occluder.
+		/// The geometry must stay alive until Rasterize() returns.
+		/// </summary>
+		void AddOccluder(const DirectX::XMFLOAT3* positions, const uint32_t* indices, uint32_t indexCount,
+		                 const DirectX::XMFLOAT4X4& world);
+
+		/// <summary>
+		/// Rasterizes the queued occluders and builds the tile depth level. Call it once per frame,
+		/// after every AddOccluder() and before any IsVisible().
+		/// </summary>
+		void Rasterize();
+
+		/// <summary>
+		/// Can be called from several threads at once, between Rasterize() and the next BeginFrame().
+		/// Conservative : a pixel is only covered when one triangle covers all of it, so a gap between occluders
+		/// never hides what is behind it.
+		/// </summary>
+		/// <returns> False if the box is outside the view frustum or fully hidden behind the occluders. </returns>
+		bool IsVisible(const DirectX::BoundingBox& worldBounds);
+
+		/// <returns> The occluders rasterized and the boxes tested since the last BeginFrame(). </returns>
+		Stats GetStats() const;
+		// Size of the depth buffer, the screen rounded up to whole tiles.
+		uint32_t GetWidth() const { return m_Width; }
+		uint32_t GetHeight() const { return m_Height; }
+		const std::vector<float>& GetDepthBuffer() const { return m_Depth; }
+
+	private:
+		struct Occluder
+		{
+			const DirectX::XMFLOAT3* Positions;
+			const uint32_t* Indices;
+			uint32_t IndexCount;
+			uint32_t FirstTriangle;
+			DirectX::XMFLOAT4X4 WorldViewProj;
+		};
+
+		struct ScreenTriangle
+		{
+			float X[3], Y[3], Z[3];
+			float MinY, MaxY;
+		};
+
+		void TransformOccluder(const Occluder& occluder);
+		void RasterizeRows(uint32_t firstTileRow, uint32_t lastTileRow);
+		void RasterizeTriangle(const ScreenTriangle& triangle, int rowMin, int rowMax);
+
+		float m_ScreenWidth;
+		float m_ScreenHeight;
+		uint32_t m_Width;
+		uint32_t m_Height;
+		uint32_t m_TilesX;
+		uint32_t m_TilesY;
+
+		DirectX::XMFLOAT4X4 m_ViewProj;
+		std::vector<Occluder> m_Occluders;
+		std::vector<ScreenTriangle> m_Triangles;
+		uint32_t m_TriangleCount = 0;
+
+		std::vector<float> m_Depth;
+		// Farthest depth of each k_TileSize x k_TileSize tile.
+		std::vector<float> m_TileMaxDepth;
+
+		uint32_t m_OccluderTriangles = 0;
+		std::atomic<uint32_t> m_Tested = 0;
+		std::atomic<uint32_t> m_Culled = 0;
+	};
+}
@@ -0,0 +1,303 @@
+#include "PotentiallyVisibleSet.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <map>
+
+#include "Debug/Log.h"
+#include "Platform/FilesSystem.h"
+
+namespace Engine
+{
+	namespace
+	{
+		constexpr uint32_t k_FileMagic = 0x32535650; // "PVS2"
+
+		struct FileHeader
+		{
+			uint32_t Magic;
+			DirectX::XMFLOAT3 Origin;
+			float CellSize;
+			uint32_t CellsX, CellsY, CellsZ;
+			uint32_t ObjectCount;
+			uint32_t CellRowCount;
+			uint32_t RowValueCount;
+			// Written as 0, keeps SceneHash aligned without padding bytes.
+			uint32_t Reserved;
+			uint64_t SceneHash;
+		};
+		static_assert(sizeof(FileHeader) == 56, "The header must not have padding bytes.");
+	}
+
+	void PotentiallyVisibleSet::Build(const DirectX::XMFLOAT3& origin, const float cellSize, const uint32_t cellsX,
+	                                  const uint32_t cellsY, const uint32_t cellsZ, const uint32_t objectCount,
+	                                  const uint64_t* bits)
+	{
+		m_Origin = origin;
+		m_CellSize = cellSize;
+		m_CellsX = cellsX;
+		m_CellsY = cellsY;
+		m_CellsZ = cellsZ;
+		m_ObjectCount = objectCount;
+		m_SceneHash = 0;
+
+		// Cells are stored as a difference with their key cell, identical rows are shared.
+		const uint32_t cellCount = GetCellCount();
+		const uint32_t wordCount = GetWordCount();
+		m_CellRows.resize(cellCount);
+		m_Rows.clear();
+		std::map<std::vector<uint64_t>, uint32_t> rows;
+		std::vector<uint64_t> row(wordCount);
+		for (uint32_t cell = 0; cell < cellCount; ++cell)
+		{
+			const uint64_t* cellBits = bits + static_cast<size_t>(cell) * wordCount;
+			const uint64_t* keyBits = bits + static_cast<size_t>(GetKeyCell(cell)) * wordCount;
+			for (uint32_t i = 0; i < wordCount; ++i)
+				row[i] = keyBits != cellBits ? cellBits[i] ^ keyBits[i] : cellBits[i];
+
+			auto [shared, isNew] = rows.try_emplace(row, 0);
+			if (isNew)
+				shared->second = Encode(row.data());
+			m_CellRows[cell] = shared->second;
+		}
+
+		if (GetCompressedSize() >= GetUncompressedSize())
+		{
+			m_CellRows.clear();
+			m_Rows.assign(reinterpret_cast<const uint32_t*>(bits),
+			              reinterpret_cast<const uint32_t*>(bits + static_cast<size_t>(cellCount) * wordCount));
+		}
+	}
+
+	uint32_t PotentiallyVisibleSet::GetCellIndex(const DirectX::XMFLOAT3& position) const
+	{
+		const float x = std::floor((position.x - m_Origin.x) / m_CellSize);
+		const float y = std::floor((position.y - m_Origin.y) / m_CellSize);
+		const float z = std::floor((position.z - m_Origin.z) / m_CellSize);
+		if (x < 0.f || y < 0.f || z < 0.f || x >= static_cast<float>(m_CellsX) || y >= static_cast<float>(m_CellsY) ||
+			z >= static_cast<float>(m_CellsZ))
+			return k_InvalidCell;
+
+		return (static_cast<uint32_t>(z) * m_CellsY + static_cast<uint32_t>(y)) * m_CellsX + static_cast<uint32_t>(x);
+	}
+
+	void PotentiallyVisibleSet::GetVisibleSet(const uint32_t cell, uint64_t* bits) const
+	{
+		const uint32_t wordCount = GetWordCount();
+		if (cell >= GetCellCount() || IsEmpty())
+		{
+			for (uint32_t i = 0; i < wordCount; ++i)
+				bits[i] = ~0ull;
+			return;
+		}
+
+		if (!IsCompressed())
+		{
+			std::memcpy(bits, m_Rows.data() + static_cast<size_t>(cell) * wordCount * 2, wordCount * sizeof(uint64_t));
+			return;
+		}
+
+		const uint32_t keyCell = GetKeyCell(cell);
+		DecodeRow(m_CellRows[keyCell], bits, false);
+		if (keyCell != cell)
+			DecodeRow(m_CellRows[cell], bits, true);
+	}
+
+	bool PotentiallyVisibleSet::IsVisible(const uint32_t cell, const uint32_t object) const
+	{
+		if (cell >= GetCellCount() || object >= m_ObjectCount || IsEmpty())
+			return true;
+
+		if (!IsCompressed())
+			return (m_Rows[static_cast<size_t>(cell) * GetWordCount() * 2 + object / 32] >> (object % 32)) & 1;
+
+		const uint32_t keyCell = GetKeyCell(cell);
+		const bool isVisible = TestRow(m_CellRows[keyCell], object);
+		return keyCell != cell ? isVisible != TestRow(m_CellRows[cell], object) : isVisible;
+	}
+
+	void PotentiallyVisibleSet::DecodeRow(const uint32_t offset, uint64_t* bits, const bool xorWithBits) const
+	{
+		const uint32_t wordCount = GetWordCount();
+		const uint32_t* row = m_Rows.data() + offset;
+		const uint32_t valueCount = row[0] >> 1;
+		const bool isSparse = row[0] & 1;
+		const uint32_t* values = row + 1;
+
+		if (!isSparse)
+		{
+			for (uint32_t i = 0; i < wordCount; ++i)
+			{
+				const uint64_t word = static_cast<uint64_t>(values[2 * i + 1]) << 32 | values[2 * i];
+				bits[i] = xorWithBits ? bits[i] ^ word : word;
+			}
+			return;
+		}
+
+		if (!xorWithBits)
+			std::fill_n(bits, wordCount, 0ull);
+		for (uint32_t i = 0; i < valueCount; ++i)
+			bits[values[i] / 64] ^= 1ull << (values[i] % 64);
+	}
+
+	bool PotentiallyVisibleSet::TestRow(const uint32_t offset, const uint32_t object) const
+	{
+		const uint32_t* row = m_Rows.data() + offset;
+		const uint32_t valueCount = row[0] >> 1;
+		const uint32_t* values = row + 1;
+		if (row[0] & 1)
+			return std::binary_search(values, values + valueCount, object);
+
+		return (values[object / 32] >> (object % 32)) & 1;
+	}
+
+	bool PotentiallyVisibleSet::IsRowValid(const uint32_t offset) const
+	{
+		if (offset >= m_Rows.size())
+			return false;
+
+		const uint32_t* row = m_Rows.data() + offset;
+		const uint64_t valueCount = row[0] >> 1;
+		if (offset + 1 + valueCount > m_Rows.size())
+			return false;
+
+		const uint32_t* values = row + 1;
+		if (!(row[0] & 1))
+			return valueCount == 2ull * GetWordCount();
+
+		// Sparse rows are binary searched and index the bitset.
+		for (uint64_t i = 0; i < valueCount; ++i)
+		{
+			if (values[i] >= m_ObjectCount || (i > 0 && values[i] <= values[i - 1]))
+				return false;
+		}
+		return true;
+	}
+
+	size_t PotentiallyVisibleSet::GetCompressedSize() const
+	{
+		return m_Rows.size() * sizeof(uint32_t) + m_CellRows.size() * sizeof(uint32_t);
+	}
+
+	size_t PotentiallyVisibleSet::GetUncompressedSize() const
+	{
+		return static_cast<size_t>(GetCellCount()) * GetWordCount() * sizeof(uint64_t);
+	}
+
+	uint32_t PotentiallyVisibleSet::Encode(const uint64_t* bits)
+	{
+		const uint32_t offset = static_cast<uint32_t>(m_Rows.size());
+		const uint32_t wordCount = GetWordCount();
+
+		uint32_t setCount = 0;
+		for (uint32_t i = 0; i < wordCount; ++i)
+			setCount += static_cast<uint32_t>(std::popcount(bits[i]));
+
+		if (setCount >= 2 * wordCount)
+		{
+			m_Rows.push_back(2 * wordCount << 1);
+			for (uint32_t i = 0; i < wordCount; ++i)
+			{
+				m_Rows.push_back(static_cast<uint32_t>(bits[i]));
+				m_Rows.push_back(static_cast<uint32_t>(bits[i] >> 32));
+			}
+			return offset;
+		}
+
+		m_Rows.push_back(setCount << 1 | 1);
+		for (uint32_t object = 0; object < m_ObjectCount; ++object)
+		{
+			if ((bits[object / 64] >> (object % 64)) & 1)
+				m_Rows.push_back(object);
+		}
+		return offset;
+	}
+
+	bool PotentiallyVisibleSet::Save(const char* path) const
+	{
+		File file;
+		if (!FilesSystem::TryOpen(path, FileModeWrite, true, &file))
+			return false;
+
+		FileHeader header;
+		header.Magic = k_FileMagic;
+		header.Reserved = 0;
+		header.SceneHash = m_SceneHash;
+		header.Origin = m_Origin;
+		header.CellSize = m_CellSize;
+		header.CellsX = m_CellsX;
+		header.CellsY = m_CellsY;
+		header.CellsZ = m_CellsZ;
+		header.ObjectCount = m_ObjectCount;
+		header.CellRowCount = static_cast<uint32_t>(m_CellRows.size());
+		header.RowValueCount = static_cast<uint32_t>(m_Rows.size());
+
+		uint64_t written;
+		const bool result = FilesSystem::TryWrite(&file, sizeof(header), &header, &written) &&
+			FilesSystem::TryWrite(&file, m_CellRows.size() * sizeof(uint32_t), m_CellRows.data(), &written) &&
+			FilesSystem::TryWrite(&file, m_Rows.size() * sizeof(uint32_t), m_Rows.data(), &written);
+		FilesSystem::Close(&file);
+		return result;
+	}
+
+	bool PotentiallyVisibleSet::Load(const char* path)
+	{
+		if (!FilesSystem::Exist(path))
+			return false;
+
+		File file;
+		if (!FilesSystem::TryOpen(path, FileModeRead, true, &file))
+			return false;
+
+		// Read at once so the counts of the header can be checked against the file's size before anything is
+		// allocated from them.
+		char* bytes = nullptr;
+		uint64_t size = 0;
+		const bool isRead = FilesSystem::TryReadAllBytes(&file, &bytes, &size);
+		FilesSystem::Close(&file);
+
+		FileHeader header;
+		bool result = isRead && size >= sizeof(header);
+		if (result)
+		{
+			std::memcpy(&header, bytes, sizeof(header));
+			const uint64_t cellCount = static_cast<uint64_t>(header.CellsX) * header.CellsY * header.CellsZ;
+			const uint64_t wordCount = (static_cast<uint64_t>(header.ObjectCount) + 63) / 64;
+			result = header.Magic == k_FileMagic && header.CellSize > 0.f && cellCount > 0 &&
+				cellCount <= UINT32_MAX && size == sizeof(header) +
+				(static_cast<uint64_t>(header.CellRowCount) + header.RowValueCount) * sizeof(uint32_t) &&
+				(header.CellRowCount == 0 ? header.RowValueCount == cellCount * wordCount * 2 : header.CellRowCount == cellCount);
+		}
+		if (result)
+		{
+			m_Origin = header.Origin;
+			m_CellSize = header.CellSize;
+			m_CellsX = header.CellsX;
+			m_CellsY = header.CellsY;
+			m_CellsZ = header.CellsZ;
+			m_ObjectCount = header.ObjectCount;
+			m_SceneHash = header.SceneHash;
+			m_CellRows.resize(header.CellRowCount);
+			m_Rows.resize(header.RowValueCount);
+			std::memcpy(m_CellRows.data(), bytes + sizeof(header), m_CellRows.size() * sizeof(uint32_t));
+			std::memcpy(m_Rows.data(), bytes + sizeof(header) + m_CellRows.size() * sizeof(uint32_t),
+			            m_Rows.size() * sizeof(uint32_t));
+			for (const uint32_t offset : m_CellRows)
+				result = result && IsRowValid(offset);
+		}
+		delete[] bytes;
+
+		if (!result)
+		{
+			CORE_ERROR("[PotentiallyVisibleSet] Invalid file: '%s'", path);
+			m_CellsX = m_CellsY = m_CellsZ = 0;
+			m_ObjectCount = 0;
+			m_SceneHash = 0;
+			m_CellRows.clear();
+			m_Rows.clear();
+		}
+		return result;
+	}
+}
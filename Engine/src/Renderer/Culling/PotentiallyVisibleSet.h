@@ -0,0 +1,100 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <DirectXMath.h>
+
+namespace Engine
+{
+	/// <summary>
+	/// Baked cell-to-object visibility of a static scene (see PvsBaker). Space is cut in a grid of cubic cells,
+	/// each cell stores the objects that can be seen from somewhere inside it as a compressed bitset.
+	/// Neighbour cells see almost the same objects, so along x only one cell every k_KeyCellInterval stores its
+	/// set, the others store the difference (xor) with it, which has few bits set and is stored as a list of indices.
+	/// Small or dense scenes where this does not pay off keep one raw bitset per cell.
+	/// </summary>
+	class PotentiallyVisibleSet
+	{
+	public:
+		static constexpr uint32_t k_InvalidCell = 0xFFFFFFFF;
+		static constexpr uint32_t k_KeyCellInterval = 4;
+
+		/// <summary>
+		/// Replaces the set with the given grid and encodes the visible sets of its cells.
+		/// </summary>
+		/// <param name="origin"> : minimum corner of the grid</param>
+		/// <param name="cellSize"> : edge length of the cubic cells</param>
+		/// <param name="cellsX"> : cells along x, the index of a cell is (z * cellsY + y) * cellsX + x</param>
+		/// <param name="cellsY"></param>
+		/// <param name="cellsZ"></param>
+		/// <param name="objectCount"></param>
+		/// <param name="bits"> : GetWordCount() words per cell, in the cells' order</param>
+		void Build(const DirectX::XMFLOAT3& origin, float cellSize, uint32_t cellsX, uint32_t cellsY, uint32_t cellsZ,
+		           uint32_t objectCount, const uint64_t* bits);
+
+		/// <returns> The cell containing the position, or k_InvalidCell outside of the baked volume. </returns>
+		uint32_t GetCellIndex(const DirectX::XMFLOAT3& position) const;
+
+		/// <summary>
+		/// Decodes the visible set of a cell, bit i of bits[i / 64] is set if object i may be visible.
+		/// Outside of the baked volume every object is reported visible.
+		/// </summary>
+		/// <param name="cell"></param>
+		/// <param name="bits"> : GetWordCount() words</param>
+		void GetVisibleSet(uint32_t cell, uint64_t* bits) const;
+
+		/// <returns> True if the object may be seen from the cell, or if either is not in the set. </returns>
+		bool IsVisible(uint32_t cell, uint32_t object) const;
+
+		bool IsEmpty() const { return m_Rows.empty(); }
+		bool IsCompressed() const { return !m_CellRows.empty(); }
+		uint32_t GetObjectCount() const { return m_ObjectCount; }
+		uint32_t GetCellCount() const { return m_CellsX * m_CellsY * m_CellsZ; }
+		uint32_t GetWordCount() const { return (m_ObjectCount + 63) / 64; }
+		/// <returns> PvsBaker::ComputeSceneHash() of the scene the set was baked from. </returns>
+		uint64_t GetSceneHash() const { return m_SceneHash; }
+
+		/// <returns> Size of the encoded sets in bytes. </returns>
+		size_t GetCompressedSize() const;
+		/// <returns> Size the sets would take as raw bitsets, in bytes. </returns>
+		size_t GetUncompressedSize() const;
+
+		bool Save(const char* path) const;
+		/// <summary>
+		/// Loads a set written by Save(). Truncated or inconsistent files are rejected and leave the set empty.
+		/// </summary>
+		bool Load(const char* path);
+
+	private:
+		/// <returns> The cell whose set is xor-ed with this cell's row. </returns>
+		uint32_t GetKeyCell(uint32_t cell) const { return cell - cell % m_CellsX % k_KeyCellInterval; }
+
+		/// <summary>
+		/// Decodes a row into bits, or xor it with bits.
+		/// </summary>
+		void DecodeRow(uint32_t offset, uint64_t* bits, bool xorWithBits) const;
+		bool TestRow(uint32_t offset, uint32_t object) const;
+		/// <returns> True if the header of the row at offset, and the values it announces, are valid. </returns>
+		bool IsRowValid(uint32_t offset) const;
+
+		/// <summary>
+		/// Appends a bitset to m_Rows and returns its offset. A row starts with a header (value count << 1 | is sparse)
+		/// followed either by the sorted indices of the set bits, or by the raw bitset when it is shorter.
+		/// </summary>
+		uint32_t Encode(const uint64_t* bits);
+
+		DirectX::XMFLOAT3 m_Origin = {0.f, 0.f, 0.f};
+		float m_CellSize = 1.f;
+		uint32_t m_CellsX = 0;
+		uint32_t m_CellsY = 0;
+		uint32_t m_CellsZ = 0;
+		uint32_t m_ObjectCount = 0;
+		uint64_t m_SceneHash = 0;
+
+		// Offset of each cell's row in m_Rows, cells with the same set share a row.
+		// Empty if m_Rows holds the raw bitsets of every cell.
+		std::vector<uint32_t> m_CellRows;
+		std::vector<uint32_t> m_Rows;
+
+		friend class PvsBaker;
+	};
+}
@@ -0,0 +1,211 @@
+#include "PvsBaker.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+
+#include "Core/JobSystem.h"
+
+namespace Engine
+{
+	namespace
+	{
+		// Small deterministic generator, seeded per cell so the result does not depend on the thread count.
+		struct Random
+		{
+			uint32_t State;
+
+			explicit Random(const uint32_t seed) : State(seed * 0x9E3779B9u + 0x7F4A7C15u) { Next(); }
+
+			uint32_t Next()
+			{
+				State ^= State << 13;
+				State ^= State >> 17;
+				State ^= State << 5;
+				return State;
+			}
+
+			float NextFloat() { return static_cast<float>(Next() >> 8) * (1.f / 16777216.f); }
+
+			DirectX::XMFLOAT3 PointIn(const DirectX::BoundingBox& box)
+			{
+				return {
+					box.Center.x + box.Extents.x * (2.f * NextFloat() - 1.f),
+					box.Center.y + box.Extents.y * (2.f * NextFloat() - 1.f),
+					box.Center.z + box.Extents.z * (2.f * NextFloat() - 1.f)
+				};
+			}
+		};
+
+		DirectX::BoundingBox Merge(const DirectX::BoundingBox& a, const DirectX::BoundingBox& b)
+		{
+			DirectX::BoundingBox merged;
+			DirectX::BoundingBox::CreateMerged(merged, a, b);
+			return merged;
+		}
+
+		// FNV-1a.
+		template <typename T>
+		uint64_t Hash(uint64_t hash, const T& value)
+		{
+			const auto* bytes = reinterpret_cast<const uint8_t*>(&value);
+			for (size_t i = 0; i < sizeof(T); ++i)
+				hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+			return hash;
+		}
+	}
+
+	uint32_t PvsBaker::AddObject(const DirectX::BoundingBox& worldBounds, const MeshBvh* occluder,
+	                             const Transform& transform)
+	{
+		BakeObject object;
+		object.Bounds = worldBounds;
+		object.Occluder = occluder && !occluder->IsEmpty() ? occluder : nullptr;
+		object.OccluderTransform = &transform;
+		m_Objects.push_back(object);
+		return static_cast<uint32_t>(m_Objects.size() - 1);
+	}
+
+	void PvsBaker::Bake(const DirectX::BoundingBox& volume, PotentiallyVisibleSet& result)
+	{
+		const auto start = std::chrono::steady_clock::now();
+
+		const float cellSize = m_Settings.CellSize;
+		result.m_Origin = {
+			volume.Center.x - volume.Extents.x, volume.Center.y - volume.Extents.y, volume.Center.z - volume.Extents.z
+		};
+		result.m_CellSize = cellSize;
+		result.m_CellsX = (std::max)(1u, static_cast<uint32_t>(std::ceil(2.f * volume.Extents.x / cellSize)));
+		result.m_CellsY = (std::max)(1u, static_cast<uint32_t>(std::ceil(2.f * volume.Extents.y / cellSize)));
+		result.m_CellsZ = (std::max)(1u, static_cast<uint32_t>(std::ceil(2.f * volume.Extents.z / cellSize)));
+		result.m_ObjectCount = static_cast<uint32_t>(m_Objects.size());
+
+		const uint32_t cellCount = result.m_CellsX * result.m_CellsY * result.m_CellsZ;
+		const uint32_t wordCount = result.GetWordCount();
+		std::vector<uint64_t> bits(static_cast<size_t>(cellCount) * wordCount, 0);
+
+		std::atomic<uint64_t> rayCount = 0;
+		JobSystem::ParallelFor(cellCount, 1, [&](const uint32_t pFirst, const uint32_t pLast, uint32_t)
+		{
+			uint64_t rangeRays = 0;
+			for (uint32_t cell = pFirst; cell < pLast; ++cell)
+				rangeRays += BakeCell(result, cell, bits.data() + static_cast<size_t>(cell) * wordCount);
+			rayCount.fetch_add(rangeRays, std::memory_order_relaxed);
+		});
+
+		result.Build(result.m_Origin, cellSize, result.m_CellsX, result.m_CellsY, result.m_CellsZ, result.m_ObjectCount,
+		             bits.data());
+		result.m_SceneHash = ComputeSceneHash();
+
+		m_Stats.RayCount = rayCount.load();
+		m_Stats.CellCount = cellCount;
+		m_Stats.ThreadCount = JobSystem::GetThreadCount();
+		m_Stats.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	uint64_t PvsBaker::ComputeSceneHash() const
+	{
+		uint64_t hash = Hash(0xCBF29CE484222325ull, m_Settings.CellSize);
+		hash = Hash(hash, m_Settings.RaysPerObject);
+		for (const BakeObject& object : m_Objects)
+		{
+			hash = Hash(hash, object.Bounds);
+			hash = Hash(hash, object.Occluder ? object.Occluder->ComputeHash() : 0ull);
+			if (object.Occluder)
+				hash = Hash(hash, object.OccluderTransform->GetWorldAsFloat4x4());
+		}
+		return hash;
+	}
+
+	uint64_t PvsBaker::BakeCell(const PotentiallyVisibleSet& result, const uint32_t cell, uint64_t* bits) const
+	{
+		const uint32_t x = cell % result.m_CellsX;
+		const uint32_t y = cell / result.m_CellsX % result.m_CellsY;
+		const uint32_t z = cell / (result.m_CellsX * result.m_CellsY);
+		const float halfCell = result.m_CellSize * 0.5f;
+		const DirectX::BoundingBox cellBounds(
+			DirectX::XMFLOAT3(result.m_Origin.x + (x + 0.5f) * result.m_CellSize,
+			                  result.m_Origin.y + (y + 0.5f) * result.m_CellSize,
+			                  result.m_Origin.z + (z + 0.5f) * result.m_CellSize),
+			DirectX::XMFLOAT3(halfCell, halfCell, halfCell));
+		// The rays start from the cell, they are cast relative to its centre : the occluders' matrices are
+		// rebuilt around it rather than inverted from their float world matrix, far from the origin.
+		const WorldPosition cellCenter(cellBounds.Center);
+		const DirectX::BoundingBox relativeCell(DirectX::XMFLOAT3(0.f, 0.f, 0.f), cellBounds.Extents);
+		std::vector<DirectX::XMFLOAT4X4> cellToLocal(m_Objects.size());
+		for (size_t i = 0; i < m_Objects.size(); ++i)
+		{
+			if (m_Objects[i].Occluder)
+				DirectX::XMStoreFloat4x4(&cellToLocal[i], DirectX::XMMatrixInverse(
+					                         nullptr, m_Objects[i].OccluderTransform->GetWorldRelativeTo(cellCenter)));
+		}
+
+		Random random(cell);
+		const uint32_t rayCount = m_Settings.RaysPerObject;
+		std::vector<Ray> cellRays(rayCount);
+		std::vector<Ray> localRays(rayCount);
+		std::vector<RayHit> hits(rayCount);
+		uint64_t castCount = 0;
+
+		for (uint32_t target = 0; target < m_Objects.size(); ++target)
+		{
+			const DirectX::BoundingBox& targetBounds = m_Objects[target].Bounds;
+			if (cellBounds.Intersects(targetBounds))
+			{
+				bits[target / 64] |= 1ull << (target % 64);
+				continue;
+			}
+
+			// Segments from the cell to the target, T is in [0, 1] along them.
+			for (Ray& ray : cellRays)
+			{
+				const DirectX::XMFLOAT3 from = random.PointIn(relativeCell);
+				const DirectX::XMFLOAT3 to = random.PointIn(targetBounds);
+				ray.Origin = from;
+				ray.Direction = {
+					to.x - cellBounds.Center.x - from.x, to.y - cellBounds.Center.y - from.y,
+					to.z - cellBounds.Center.z - from.z
+				};
+				ray.TMax = 1.f;
+			}
+
+			const DirectX::BoundingBox segmentsBounds = Merge(cellBounds, targetBounds);
+			uint32_t aliveCount = rayCount;
+			for (uint32_t occluder = 0; occluder < m_Objects.size() && aliveCount > 0; ++occluder)
+			{
+				const BakeObject& object = m_Objects[occluder];
+				if (occluder == target || !object.Occluder || !segmentsBounds.Intersects(object.Bounds))
+					continue;
+
+				const DirectX::XMMATRIX toLocal = DirectX::XMLoadFloat4x4(&cellToLocal[occluder]);
+				for (uint32_t i = 0; i < aliveCount; ++i)
+				{
+					DirectX::XMStoreFloat3(&localRays[i].Origin,
+					                       DirectX::XMVector3TransformCoord(DirectX::XMLoadFloat3(&cellRays[i].Origin),
+					                                                        toLocal));
+					DirectX::XMStoreFloat3(&localRays[i].Direction,
+					                       DirectX::XMVector3TransformNormal(
+						                       DirectX::XMLoadFloat3(&cellRays[i].Direction), toLocal));
+					localRays[i].TMax = 1.f;
+					hits[i] = RayHit();
+				}
+				object.Occluder->Intersect(localRays.data(), hits.data(), aliveCount);
+				castCount += aliveCount;
+
+				// Blocked rays are dropped, the others keep being tested against the next occluders.
+				uint32_t kept = 0;
+				for (uint32_t i = 0; i < aliveCount; ++i)
+				{
+					if (!hits[i].HasHit())
+						cellRays[kept++] = cellRays[i];
+				}
+				aliveCount = kept;
+			}
+
+			if (aliveCount > 0)
+				bits[target / 64] |= 1ull << (target % 64);
+		}
+		return castCount;
+	}
+}
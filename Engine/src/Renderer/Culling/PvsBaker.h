@@ -0,0 +1,80 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <DirectXMath.h>
+#include <DirectXCollision.h>
+
+#include "Core/MeshBvh.h"
+#include "Core/Transform.h"
+#include "PotentiallyVisibleSet.h"
+
+namespace Engine
+{
+	/// <summary>
+	/// Offline visibility baker for static scenes. For every cell of a grid it casts rays from random points
+	/// of the cell towards random points of each object's bounds, an object is visible from the cell as soon
+	/// as one ray is not blocked by the occluders. Cells are baked in parallel on every JobSystem thread.
+	/// The result is conservative only up to the number of rays cast.
+	/// </summary>
+	class PvsBaker
+	{
+	public:
+		struct Settings
+		{
+			// Edge length of the cubic cells, in world units.
+			float CellSize = 2.f;
+			// Rays cast from a cell towards each object.
+			uint32_t RaysPerObject = 64;
+		};
+
+		struct Stats
+		{
+			uint64_t RayCount = 0;
+			uint32_t CellCount = 0;
+			uint32_t ThreadCount = 0;
+			double Seconds = 0.0;
+
+			double GetRaysPerSecond() const { return Seconds > 0.0 ? static_cast<double>(RayCount) / Seconds : 0.0; }
+		};
+
+		PvsBaker() = default;
+		explicit PvsBaker(const Settings& settings) : m_Settings(settings) {}
+
+		/// <summary>
+		/// Adds an object, its index in the baked set is the number of objects added before it.
+		/// </summary>
+		/// <param name="worldBounds"> : bounds tested for visibility</param>
+		/// <param name="occluder"> : mesh blocking the rays, or nullptr if the object hides nothing</param>
+		/// <param name="transform"> : transform of the occluder mesh, kept until Bake()</param>
+		/// <returns> The object index. </returns>
+		uint32_t AddObject(const DirectX::BoundingBox& worldBounds, const MeshBvh* occluder,
+		                   const Transform& transform);
+
+		/// <summary>
+		/// Bakes the visibility of every object from the cells covering volume.
+		/// </summary>
+		void Bake(const DirectX::BoundingBox& volume, PotentiallyVisibleSet& result);
+
+		/// <returns> A hash of the settings and of every object's bounds, occluder mesh and transform. Bake() stores
+		/// it in the result, a loaded set whose hash differs was baked from another scene. </returns>
+		uint64_t ComputeSceneHash() const;
+
+		const Stats& GetStats() const { return m_Stats; }
+
+	private:
+		struct BakeObject
+		{
+			DirectX::BoundingBox Bounds;
+			const MeshBvh* Occluder;
+			// The rays are tested in the occluder's space, through its world matrix relative to their cell.
+			const Transform* OccluderTransform;
+		};
+
+		/// <returns> The number of rays cast. </returns>
+		uint64_t BakeCell(const PotentiallyVisibleSet& result, uint32_t cell, uint64_t* bits) const;
+
+		Settings m_Settings;
+		std::vector<BakeObject> m_Objects;
+		Stats m_Stats;
+	};
+}
@@ -6,15 +6,22 @@
 #include "DirectXCamera.h"
 #include "DirectXContext.h"
 #include "DirectXSwapchain.h"
+#include "FramePacer.h"
+#include "CommandListPool.h"
+#include "MeshPool.h"
+#include "RenderGraph.h"
+#include "RHI/RhiDevice.h"
 #include "Core/Application.h"
 #include "Resource/DirectXResourceManager.h"
+#include "Core/Object.h"
 
 namespace Engine
 {
-	void DirectXApi::Initialize()
+	void DirectXApi::Initialize(const bool pHeadless)
 	{
-		InitializeDebug();
-		DirectXContext::Initialize();
+		if (!pHeadless)
+			InitializeDebug();
+		DirectXContext::Initialize(pHeadless);
 	}
 
 	void DirectXApi::Shutdown()
@@ -24,49 +31,97 @@ namespace Engine
 
 	void DirectXApi::Resize(const int pWidth, const int pHeight)
 	{
-		DirectXContext::Get()->m_Swapchain->Resize(pWidth, pHeight);
+		// The swapchain buffers may still be used by frames in flight.
+		DirectXContext::Get()->m_FramePacer->WaitIdle();
+		RhiDevice::Get()->GetSwapchain().Resize(pWidth, pHeight);
 		DirectXContext::Get()->m_Camera->Resize(pWidth, pHeight);
 	}
 
 	void DirectXApi::BeginFrame()
 	{
-		auto& cmdListAlloc = DirectXContext::Get()->CurrentFrameData().CmdListAlloc;
-		THROW_IF_FAILED(cmdListAlloc->Reset());
-		THROW_IF_FAILED(DirectXContext::Get()->m_CommandObject->ResetList(cmdListAlloc));
+		// Waits for the GPU to release this frame's resources, only when it is k_FrameCount frames behind.
+		DirectXContext::Get()->m_FramePacer->BeginFrame();
+		DirectXContext::Get()->m_UploadRing->BeginFrame(DirectXContext::Get()->GetFrameIndex());
+		DirectXContext::Get()->m_CommandListPool->BeginFrame(DirectXContext::Get()->GetFrameIndex());
+		DirectXContext::Get()->m_UploadManager->Retire();
 
-		DirectXContext::Get()->m_CommandObject->GetCommandList()->RSSetViewports(
-			1, &DirectXContext::Get()->m_Swapchain->GetViewport());
-		DirectXContext::Get()->m_CommandObject->GetCommandList()->RSSetScissorRects(
-			1, &DirectXContext::Get()->m_Swapchain->GetScissorRect());
+		// Everything of the frame is recorded through the filter, so it knows what is bound.
+		RhiCommandList& commandList = DirectXContext::Get()->GetFrameCommandList();
+		RhiSwapchain& swapchain = RhiDevice::Get()->GetSwapchain();
+		RhiCommandAllocator& cmdListAlloc = *DirectXContext::Get()->CurrentFrameData().CmdListAlloc;
+		cmdListAlloc.Reset();
+		commandList.Begin(cmdListAlloc);
 
-		// Indicate a state transition on the resource usage.
-		const auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(
-			DirectXContext::Get()->m_Swapchain->GetCurrentBackBuffer(),
-			D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET);
-		DirectXContext::Get()->m_CommandObject->GetCommandList()->ResourceBarrier(1, &barrier);
+		DirectXContext::Get()->m_Camera->Update();
 
-		// Clear the back buffer and depth buffer.
-		DirectXContext::Get()->m_CommandObject->GetCommandList()->ClearRenderTargetView(
-			DirectXContext::Get()->m_Swapchain->GetCurrentBackBufferView(), DirectX::Colors::Gray, 0, nullptr);
-		DirectXContext::Get()->m_CommandObject->GetCommandList()->ClearDepthStencilView(
-			DirectXContext::Get()->m_Swapchain->GetDepthStencilView(),
-			D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, 1.0f, 0, 0, nullptr);
+		// Copies the transforms that moved since the last frame, before anything draws with the table.
+		GpuObjectTable& objectTable = *DirectXContext::Get()->m_ObjectTable;
+		objectTable.Update(commandList, *DirectXContext::Get()->m_UploadRing, GetCameraWorldPosition());
+		// Same for the materials whose parameters or texture changed.
+		DirectXContext::Get()->m_MaterialTable->Update(commandList, *DirectXContext::Get()->m_UploadRing);
+		// Packs the mesh pools whose free space got split by unloaded meshes.
+		for (const auto& [stride, meshPool] : DirectXContext::Get()->m_MeshPools)
+			meshPool->BeginFrame(commandList);
 
-		DirectXContext::Get()->m_ResourceManager->BindDescriptorsHeap();
+		// The frame's passes : the graph transitions the back buffer and places the depth buffer.
+		RenderGraph& graph = *DirectXContext::Get()->m_RenderGraph;
+		graph.Reset();
+		const RhiTexture& backBuffer = swapchain.GetCurrentBackBuffer();
+		const RenderGraph::TextureHandle backBufferHandle = graph.ImportTexture(
+			"BackBuffer", backBuffer, RhiResourceState::Present, RhiResourceState::Present);
+		RhiTextureDesc depthDesc;
+		depthDesc.Width = backBuffer.GetDesc().Width;
+		depthDesc.Height = backBuffer.GetDesc().Height;
+		depthDesc.Format = RhiFormat::D24UnormS8Uint;
+		depthDesc.SampleCount = DirectXContext::Get()->m_4xMsaaState ? 4 : 1;
+		depthDesc.SampleQuality = DirectXContext::Get()->m_4xMsaaState
+			                          ? (DirectXContext::Get()->m_4xMsaaQuality - 1)
+			                          : 0;
+		depthDesc.IsDepthStencil = true;
+		const RenderGraph::TextureHandle depth = graph.CreateTexture("SceneDepth", depthDesc);
+		DirectXContext::Get()->m_SceneDepth = depth;
 
-		const auto renderTargetDescriptor = DirectXContext::Get()->m_Swapchain->GetCurrentBackBufferView();
-		const auto depthStencilDescriptor = DirectXContext::Get()->m_Swapchain->GetDepthStencilView();
-		DirectXContext::Get()->m_CommandObject->GetCommandList()->OMSetRenderTargets(1,
-			&renderTargetDescriptor, true,
-			&depthStencilDescriptor);
+		// Everything drawn until EndFrame(), on this list and the draw queue's ones.
+		RenderGraph::PassBuilder scenePass = graph.AddPass(
+			"Scene", [&graph, &swapchain, backBufferHandle, depth](RhiCommandList& pCommandList)
+			{
+				pCommandList.SetViewport(swapchain.GetViewport());
+				pCommandList.SetScissorRect(swapchain.GetScissorRect());
+				// The depth buffer shares its memory with other transients, it is undefined until cleared.
+				pCommandList.ClearRenderTarget(graph.GetTexture(backBufferHandle), DirectX::Colors::Gray);
+				pCommandList.ClearDepthStencil(graph.GetTexture(depth), 1.0f, 0);
+				pCommandList.SetRenderTarget(&graph.GetTexture(backBufferHandle), &graph.GetTexture(depth));
+			});
+		scenePass.Write(backBufferHandle, RhiResourceState::RenderTarget).Write(depth, RhiResourceState::DepthWrite);
+		graph.Compile();
+		graph.Execute(commandList, scenePass.GetPass());
 
-		DirectXContext::Get()->m_Camera->Update();
+		// Occluders are rasterized before any Render() call so objects can be tested as they are drawn.
+		DirectXContext::Get()->m_OcclusionCuller->BeginFrame(DirectXContext::Get()->m_Camera->m_ViewProj);
+		for (const Object* occluder : DirectXContext::Get()->m_Occluders)
+		{
+			const DirectXMesh* mesh = occluder->GetMesh();
+			DirectXContext::Get()->m_OcclusionCuller->AddOccluder(mesh->GetPositions().data(), mesh->GetIndices().data(),
+			                                                      static_cast<uint32_t>(mesh->GetIndices().size()),
+			                                                      occluder->GetWorldMatrixRelativeTo(GetCameraWorldPosition()));
+		}
+		DirectXContext::Get()->m_OcclusionCuller->Rasterize();
+
+		// Everything below is camera relative, the eye sits at the origin.
+		DirectXContext::Get()->m_LodSelector->SetView({0.f, 0.f, 0.f}, DirectXContext::Get()->m_Camera->m_FovDegree,
+		                                              DirectXContext::Get()->m_Camera->m_Height);
 
 		// --- TODO : Refactor this !!!
-		DirectXContext::Get()->CurrentFrameData().SetViewProj(DirectXContext::Get()->m_Camera->m_ViewProjT);
-		DirectX::XMFLOAT3 pos;
-		DirectX::XMStoreFloat3(&pos, DirectXContext::Get()->m_Camera->m_Transform->GetPosition());
-		DirectXContext::Get()->CurrentFrameData().SetEyePosition(pos);
+		// Object matrices are relative to the table's origin, the pass moves them back around the camera.
+		const DirectX::XMVECTOR originOffset = WorldPosition::Subtract(objectTable.GetOrigin(), GetCameraWorldPosition());
+		const DirectX::XMMATRIX viewProj = DirectX::XMMatrixTranslationFromVector(originOffset) *
+			DirectX::XMLoadFloat4x4(&DirectXContext::Get()->m_Camera->m_ViewProj);
+		DirectX::XMFLOAT4X4 viewProjT;
+		DirectX::XMStoreFloat4x4(&viewProjT, DirectX::XMMatrixTranspose(viewProj));
+		DirectX::XMFLOAT3 eyePosition;
+		DirectX::XMStoreFloat3(&eyePosition, DirectX::XMVectorNegate(originOffset));
+		DirectXContext::Get()->CurrentFrameData().SetViewProj(viewProjT);
+		DirectXContext::Get()->CurrentFrameData().SetEyePosition(eyePosition);
 		auto light = DirectionalLight();
 		light.Direction = {0.57735f, -0.57735f, 0.57735f};
 		light.Color = {1.0f, 1.0f, 1.0f};
@@ -83,19 +138,37 @@ namespace Engine
 
 	void DirectXApi::EndFrame()
 	{
-		const auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(
-			DirectXContext::Get()->m_Swapchain->GetCurrentBackBuffer(),
-			D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT);
-		DirectXContext::Get()->m_CommandObject->GetCommandList()->ResourceBarrier(1, &barrier);
+		RhiSwapchain& swapchain = RhiDevice::Get()->GetSwapchain();
+		CommandListPool& pool = *DirectXContext::Get()->m_CommandListPool;
+		DirectXContext::Get()->GetFrameCommandList().End();
+
+		RenderGraph& graph = *DirectXContext::Get()->m_RenderGraph;
+		const RhiTexture& depth = graph.GetTexture(DirectXContext::Get()->m_SceneDepth);
+
+		// The draws are recorded in parallel, each list binds the frame's target again as lists share no state.
+		const uint32_t drawListCount = DirectXContext::Get()->m_DrawQueue->Flush(
+			pool, *DirectXContext::Get()->m_UploadRing, [&swapchain, &depth](RhiCommandList& pCommandList)
+			{
+				pCommandList.SetViewport(swapchain.GetViewport());
+				pCommandList.SetScissorRect(swapchain.GetScissorRect());
+				pCommandList.SetRenderTarget(&swapchain.GetCurrentBackBuffer(), &depth);
+			});
 
-		DirectXContext::Get()->m_CommandObject->Execute();
-		DirectXContext::Get()->m_Swapchain->Present();
+		// The rest of the graph, the back buffer back to Present.
+		RhiCommandList& commandList = pool.Begin(drawListCount);
+		graph.Execute(commandList);
+		pool.End(drawListCount);
 
-		DirectXContext::Get()->CurrentFrameData().Fence = ++DirectXContext::Get()->m_CommandObject->
-			GetCurrentFenceIndex();
-		DirectXContext::Get()->m_CommandObject->GetCommandQueue()->Signal(
-			DirectXContext::Get()->m_CommandObject->GetFence().Get(),
-			DirectXContext::Get()->m_CommandObject->GetCurrentFenceIndex());
+		// The uploads recorded since the last frame go in one copy submission, the frame waits for them on the GPU.
+		DirectXContext::Get()->m_UploadManager->Submit();
+		DirectXContext::Get()->m_UploadManager->MakeVisible(RhiDevice::Get()->GetQueue(RhiQueueType::Graphics));
+
+		// The queue executes the backend's lists, the ones the filters record into, all in one submission.
+		pool.Execute(RhiDevice::Get()->GetQueue(RhiQueueType::Graphics), &RhiDevice::Get()->GetCommandList(),
+		             drawListCount + 1);
+		swapchain.Present();
+
+		DirectXContext::Get()->m_FramePacer->EndFrame(RhiDevice::Get()->GetQueue(RhiQueueType::Graphics));
 	}
 
 	void DirectXApi::UpdateCamera(float dt)
@@ -108,6 +181,121 @@ namespace Engine
 		DirectXContext::Get()->m_Camera->MouseMove(x, y);
 	}
 
+	Ray DirectXApi::GetCameraMouseRay()
+	{
+		return DirectXContext::Get()->m_Camera->GetMouseRay();
+	}
+
+	DirectX::XMFLOAT3 DirectXApi::GetCameraPosition()
+	{
+		DirectX::XMFLOAT3 position;
+		DirectX::XMStoreFloat3(&position, DirectXContext::Get()->m_Camera->m_Transform->GetPosition());
+		return position;
+	}
+
+	const WorldPosition& DirectXApi::GetCameraWorldPosition()
+	{
+		return DirectXContext::Get()->m_Camera->m_Transform->GetWorldPosition();
+	}
+
+	const DirectX::XMFLOAT4X4& DirectXApi::GetCameraViewProj()
+	{
+		return DirectXContext::Get()->m_Camera->m_ViewProj;
+	}
+
+	void DirectXApi::AddOccluder(Object* pObject)
+	{
+		DirectXContext::Get()->m_Occluders.push_back(pObject);
+	}
+
+	void DirectXApi::RemoveOccluder(Object* pObject)
+	{
+		std::erase(DirectXContext::Get()->m_Occluders, pObject);
+	}
+
+	bool DirectXApi::IsVisible(const DirectX::BoundingBox& pWorldBounds)
+	{
+		return DirectXContext::Get()->m_OcclusionCuller->IsVisible(pWorldBounds);
+	}
+
+	OcclusionCuller::Stats DirectXApi::GetOcclusionStats()
+	{
+		return DirectXContext::Get()->m_OcclusionCuller->GetStats();
+	}
+
+	const UploadRing::Stats& DirectXApi::GetUploadStats()
+	{
+		return DirectXContext::Get()->m_UploadRing->GetStats();
+	}
+
+	const UploadManager::Stats& DirectXApi::GetUploadManagerStats()
+	{
+		return DirectXContext::Get()->m_UploadManager->GetStats();
+	}
+
+	RhiMemoryAllocator::Stats DirectXApi::GetMemoryStats()
+	{
+		return RhiDevice::Get()->GetMemoryAllocator().GetStats();
+	}
+
+	const GpuObjectTable::Stats& DirectXApi::GetObjectTableStats()
+	{
+		return DirectXContext::Get()->m_ObjectTable->GetStats();
+	}
+
+	const GpuMaterialTable::Stats& DirectXApi::GetMaterialTableStats()
+	{
+		return DirectXContext::Get()->m_MaterialTable->GetStats();
+	}
+
+	const PipelineCache::Stats& DirectXApi::GetPipelineCacheStats()
+	{
+		return DirectXContext::Get()->m_PipelineCache->GetStats();
+	}
+
+	const ShaderCompiler::Stats& DirectXApi::GetShaderCompilerStats()
+	{
+		return DirectXContext::Get()->m_ShaderCompiler->GetStats();
+	}
+
+	void DirectXApi::SetInstancing(const bool pIsEnabled)
+	{
+		DirectXContext::Get()->m_DrawQueue->SetEnabled(pIsEnabled);
+	}
+
+	const DrawQueue::Stats& DirectXApi::GetDrawQueueStats()
+	{
+		return DirectXContext::Get()->m_DrawQueue->GetStats();
+	}
+
+	uint32_t DirectXApi::GetPassConstantsUploadBytes()
+	{
+		return DirectXContext::Get()->CurrentFrameData().GetUploadedBytes();
+	}
+
+	void DirectXApi::SetStateFiltering(const bool pIsEnabled)
+	{
+		DirectXContext::Get()->m_FrameCommandList->SetEnabled(pIsEnabled);
+		DirectXContext::Get()->m_CommandListPool->SetStateFiltering(pIsEnabled);
+	}
+
+	StateFilteringCommandList::Stats DirectXApi::GetStateFilteringStats()
+	{
+		StateFilteringCommandList::Stats stats = DirectXContext::Get()->m_FrameCommandList->GetStats();
+		stats += DirectXContext::Get()->m_CommandListPool->GetStateFilteringStats();
+		return stats;
+	}
+
+	const RenderGraph::Stats& DirectXApi::GetRenderGraphStats()
+	{
+		return DirectXContext::Get()->m_RenderGraph->GetStats();
+	}
+
+	LodSelector* DirectXApi::GetLodSelector()
+	{
+		return DirectXContext::Get()->m_LodSelector.get();
+	}
+
 	void DirectXApi::InitializeDebug()
 	{
 #if defined(DEBUG) || defined(_DEBUG)
@@ -1,13 +1,27 @@
 ﻿#pragma once
 
 #include "DirectXContext.h"
+#include "Core/MeshBvh.h"
+#include "Core/WorldPosition.h"
+#include "Culling/OcclusionCuller.h"
+#include "Culling/LodSelector.h"
+#include "UploadRing.h"
+#include "UploadManager.h"
+#include "GpuObjectTable.h"
+#include "GpuMaterialTable.h"
+#include "PipelineCache.h"
+#include "Shaders/ShaderCompiler.h"
+#include "DrawQueue.h"
+#include "RenderGraph.h"
+#include "RHI/StateFilteringCommandList.h"
 
 namespace Engine
 {
 	class DirectXApi
 	{
 	public:
-		static void Initialize();
+		/// <param name="pHeadless"> Records into the null render backend instead of creating a D3D12 device. </param>
+		static void Initialize(bool pHeadless = false);
 		static void Shutdown();
 
 		static void Resize(int pWidth, int pHeight);
@@ -17,6 +31,54 @@ namespace Engine
 
 		static void UpdateCamera(float dt);
 		static void CameraMouseEvent(float x, float y);
+		static Ray GetCameraMouseRay();
+
+		/// <returns> The camera's world space position. </returns>
+		static DirectX::XMFLOAT3 GetCameraPosition();
+
+		/// <returns> The camera's double precision position, origin of the space objects are rendered in. </returns>
+		static const WorldPosition& GetCameraWorldPosition();
+
+		/// <returns> The camera's view projection, camera relative and row-major (non transposed). </returns>
+		static const DirectX::XMFLOAT4X4& GetCameraViewProj();
+
+		/// <summary>
+		/// Registers an Object whose mesh is rasterized in the occlusion buffer at the start of every frame.
+		/// </summary>
+		static void AddOccluder(Object* pObject);
+		static void RemoveOccluder(Object* pObject);
+
+		/// <returns> False if the camera relative box is hidden behind this frame's occluders. </returns>
+		static bool IsVisible(const DirectX::BoundingBox& pWorldBounds);
+		static OcclusionCuller::Stats GetOcclusionStats();
+		static const UploadRing::Stats& GetUploadStats();
+		static const UploadManager::Stats& GetUploadManagerStats();
+		static RhiMemoryAllocator::Stats GetMemoryStats();
+		static const GpuObjectTable::Stats& GetObjectTableStats();
+		static const GpuMaterialTable::Stats& GetMaterialTableStats();
+		static const PipelineCache::Stats& GetPipelineCacheStats();
+		static const ShaderCompiler::Stats& GetShaderCompilerStats();
+
+		/// <summary>
+		/// Merges the draws sharing a mesh and a shader into instanced draws (on by default).
+		/// </summary>
+		static void SetInstancing(bool pIsEnabled);
+		static const DrawQueue::Stats& GetDrawQueueStats();
+		/// <returns> The bytes of pass constants uploaded last frame, the unused lights are skipped. </returns>
+		static uint32_t GetPassConstantsUploadBytes();
+
+		/// <summary>
+		/// Drops the state changes that bind what is already bound (on by default).
+		/// </summary>
+		static void SetStateFiltering(bool pIsEnabled);
+		/// <returns> The counters of the frame's list and of the lists the draws were recorded into. </returns>
+		static StateFilteringCommandList::Stats GetStateFilteringStats();
+
+		/// <returns> What the compilation of this frame's render graph planned. </returns>
+		static const RenderGraph::Stats& GetRenderGraphStats();
+
+		/// <returns> The lod selector, set up with this frame's camera. </returns>
+		static LodSelector* GetLodSelector();
 
 	private:
 		static void InitializeDebug();
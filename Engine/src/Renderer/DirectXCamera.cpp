@@ -7,7 +7,8 @@ namespace Engine
 	{
 		m_Transform = std::make_unique<Transform>(DirectX::XMFLOAT3(0.f, 0.f, -2.f));
 
-		DirectX::XMMATRIX viewMatrix = DirectX::XMMatrixInverse(nullptr, m_Transform->GetWorld());
+		DirectX::XMMATRIX viewMatrix = DirectX::XMMatrixInverse(
+			nullptr, m_Transform->GetWorldRelativeTo(m_Transform->GetWorldPosition()));
 
 		XMStoreFloat4x4(&m_View, viewMatrix);
 
@@ -20,6 +21,8 @@ namespace Engine
 
 	void DirectXCamera::Resize(float width, float height)
 	{
+		m_Width = width;
+		m_Height = height;
 		float fovRad = (m_FovDegree / 360.f) * DirectX::XM_2PI;
 		float aspectRatio = width / height;
 		DirectX::XMMATRIX projMatrix = DirectX::XMMatrixPerspectiveFovLH(fovRad, aspectRatio, m_NearZ, m_FarZ);
@@ -28,7 +31,9 @@ namespace Engine
 
 	void DirectXCamera::Update()
 	{
-		DirectX::XMMATRIX view = DirectX::XMMatrixInverse(nullptr, m_Transform->GetWorld());
+		// Rendering happens relative to the camera, so the view only holds its rotation.
+		DirectX::XMMATRIX view = DirectX::XMMatrixInverse(
+			nullptr, m_Transform->GetWorldRelativeTo(m_Transform->GetWorldPosition()));
 
 		const DirectX::XMMATRIX proj = XMLoadFloat4x4(&m_Proj);
 
@@ -78,4 +83,20 @@ namespace Engine
         m_LastMousePos = {x, y};
     }
 
+	Ray DirectXCamera::ScreenPointToRay(float x, float y) const
+	{
+		// Viewport -> NDC -> view space direction on the z = 1 plane.
+		const float ndcX = 2.f * x / m_Width - 1.f;
+		const float ndcY = 1.f - 2.f * y / m_Height;
+		const DirectX::XMVECTOR viewDirection = DirectX::XMVectorSet(ndcX / m_Proj._11, ndcY / m_Proj._22, 1.f, 0.f);
+
+		const DirectX::XMVECTOR direction = DirectX::XMVector3Normalize(
+			DirectX::XMVector3TransformNormal(viewDirection, m_Transform->GetWorld()));
+
+		Ray ray;
+		DirectX::XMStoreFloat3(&ray.Direction, direction);
+		ray.TMax = m_FarZ;
+		return ray;
+	}
+
 }
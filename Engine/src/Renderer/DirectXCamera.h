@@ -2,6 +2,7 @@
 
 #include "DirectXContext.h"
 #include "Core/Transform.h"
+#include "Core/MeshBvh.h"
 #include "Platform/Input.h"
 #include "Events/MouseEvent.h"
 #include "Debug/Log.h"
@@ -39,16 +40,30 @@ namespace Engine
 		/// <param name="y"></param>
 		void MouseMove(float x, float y);
 
+		/// <summary>
+		/// Builds the ray going from the camera through a point of the viewport, relative to the camera's
+		/// world position : its origin is 0.
+		/// </summary>
+		/// <param name="x"> : viewport x coordinate, in pixels</param>
+		/// <param name="y"> : viewport y coordinate, in pixels</param>
+		Ray ScreenPointToRay(float x, float y) const;
+
+		/// <returns> The camera relative ray under the last known mouse position. </returns>
+		Ray GetMouseRay() const { return ScreenPointToRay(m_LastMousePos.x, m_LastMousePos.y); }
+
 	private:
 		std::unique_ptr<Transform> m_Transform;
 
 		float m_FovDegree;
 		float m_NearZ;
 		float m_FarZ;
+		float m_Width = 1.f;
+		float m_Height = 1.f;
 
 		DirectX::XMFLOAT4X4 m_View = MathHelper::Identity4x4();
 		DirectX::XMFLOAT4X4 m_Proj = MathHelper::Identity4x4();
 
+		// Camera relative : world matrices must be built with Transform::GetWorldRelativeTo(camera position).
 		DirectX::XMFLOAT4X4 m_ViewProj = MathHelper::Identity4x4();
 		DirectX::XMFLOAT4X4 m_ViewProjT = MathHelper::Identity4x4();
 
@@ -4,7 +4,24 @@
 #include "DirectXSwapchain.h"
 #include "Core/Application.h"
 #include "DirectXCamera.h"
+#include "RHI/DirectXRhi.h"
+#include "RHI/NullRhi.h"
+#include "RHI/StateFilteringCommandList.h"
+#include "CommandListPool.h"
+#include "RenderGraph.h"
+#include "Core/JobSystem.h"
 #include "Resource/DirectXResourceManager.h"
+#include "Culling/OcclusionCuller.h"
+#include "Culling/LodSelector.h"
+#include "FramePacer.h"
+#include "UploadRing.h"
+#include "UploadManager.h"
+#include "GpuObjectTable.h"
+#include "GpuMaterialTable.h"
+#include "PipelineCache.h"
+#include "Shaders/DirectXShaderCompiler.h"
+#include "DrawQueue.h"
+#include "MeshPool.h"
 
 #include "Shaders/DirectXSimpleShader.h"
 #include "Shaders/DirectXTextureShader.h"
@@ -14,16 +31,20 @@
 #include "Materials/DirectXTextureMaterial.h"
 #include "Materials/DirectXLitMaterial.h"
 
-const int gNumFrameResources = 3;
-
 namespace Engine
 {
 	DirectXContext* DirectXContext::s_Instance = nullptr;
 
-	void DirectXContext::Initialize()
+	void DirectXContext::Initialize(const bool pHeadless)
 	{
 		s_Instance = new DirectXContext();
 
+		if (pHeadless)
+		{
+			s_Instance->InitializeHeadless();
+			return;
+		}
+
 		// ===== Factory =====
 		THROW_IF_FAILED(CreateDXGIFactory1(IID_PPV_ARGS(&s_Instance->m_Factory)));
 
@@ -49,102 +70,89 @@ namespace Engine
                                                                      Application::Get()->GetWindow()->GetHeight());
         s_Instance->m_Swapchain->Resize(Application::Get()->GetWindow()->GetWidth(),
                                         Application::Get()->GetWindow()->GetHeight());
+        RhiDevice::Initialize(std::make_unique<DirectXRhiDevice>(s_Instance->m_Device.Get(),
+                                                                 *s_Instance->m_CommandObject,
+                                                                 *s_Instance->m_Swapchain));
         s_Instance->m_ResourceManager = std::make_unique<DirectXResourceManager>(1000);
-        
-        // ===== Frame Resources =====
-        for(int i = 0; i < gNumFrameResources; ++i)
-        {
-            s_Instance->m_FramesData.push_back(std::make_unique<DirectXFrameData>(s_Instance->m_Device.Get(), 1));
-        }
+        s_Instance->InitializeFrameObjects();
     }
 
-    void DirectXContext::Shutdown()
-    {
-    }
-
-	Microsoft::WRL::ComPtr<ID3D12Resource> DirectXContext::CreateDefaultBuffer(ID3D12Device* pDevice,
-	                                                                           ID3D12GraphicsCommandList* pCmdList,
-	                                                                           const void* pInitData,
-	                                                                           const UINT64 pByteSize,
-	                                                                           Microsoft::WRL::ComPtr<ID3D12Resource>&
-	                                                                           pUploadBuffer)
+	void DirectXContext::InitializeHeadless()
 	{
-		Microsoft::WRL::ComPtr<ID3D12Resource> defaultBuffer;
-
-		const auto defaultProperty = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
-		const auto uploadProperty = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
-		const auto bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(pByteSize);
-
-		// Create the actual default buffer resource.
-		THROW_IF_FAILED(pDevice->CreateCommittedResource(
-			&defaultProperty,
-			D3D12_HEAP_FLAG_NONE,
-			&bufferDesc,
-			D3D12_RESOURCE_STATE_COMMON,
-			nullptr,
-			IID_PPV_ARGS(defaultBuffer.GetAddressOf())));
-
-		// In order to copy CPU memory data into our default buffer, we need to create
-		// an intermediate upload heap.
-		THROW_IF_FAILED(pDevice->CreateCommittedResource(
-			&uploadProperty,
-			D3D12_HEAP_FLAG_NONE,
-			&bufferDesc,
-			D3D12_RESOURCE_STATE_GENERIC_READ,
-			nullptr,
-			IID_PPV_ARGS(pUploadBuffer.GetAddressOf())));
-
-
-		// Describe the data we want to copy into the default buffer.
-		D3D12_SUBRESOURCE_DATA subResourceData = {};
-		subResourceData.pData = pInitData;
-		subResourceData.RowPitch = static_cast<LONG_PTR>(pByteSize);
-		subResourceData.SlicePitch = subResourceData.RowPitch;
-
-		// Schedule to copy the data to the default buffer resource.  At a high level, the helper function UpdateSubresources
-		// will copy the CPU memory into the intermediate upload heap.  Then, using ID3D12CommandList::CopySubresourceRegion,
-		// the intermediate upload heap data will be copied to mBuffer.
-		const auto barrierToCopy = CD3DX12_RESOURCE_BARRIER::Transition(defaultBuffer.Get(),
-		                                                                D3D12_RESOURCE_STATE_COMMON,
-		                                                                D3D12_RESOURCE_STATE_COPY_DEST);
-		pCmdList->ResourceBarrier(1, &barrierToCopy);
-		UpdateSubresources<1>(pCmdList, defaultBuffer.Get(), pUploadBuffer.Get(), 0, 0, 1, &subResourceData);
-		const auto barrierToRead = CD3DX12_RESOURCE_BARRIER::Transition(defaultBuffer.Get(),
-		                                                                D3D12_RESOURCE_STATE_COPY_DEST,
-		                                                                D3D12_RESOURCE_STATE_GENERIC_READ);
-		pCmdList->ResourceBarrier(1, &barrierToRead);
-
-		// Note: uploadBuffer has to be kept alive after the above function calls because
-		// the command list has not been executed yet that performs the actual copy.
-		// The caller can Release the uploadBuffer after it knows the copy has been executed.
-
-
-		return defaultBuffer;
+		const uint32_t width = Application::Get()->GetWindow()->GetWidth();
+		const uint32_t height = Application::Get()->GetWindow()->GetHeight();
+		m_Camera = std::make_unique<DirectXCamera>(width, height, 45.f, 0.1f, 1000.f);
+		RhiDevice::Initialize(std::make_unique<NullRhiDevice>(width, height));
+		InitializeFrameObjects();
 	}
 
-	Microsoft::WRL::ComPtr<ID3DBlob> DirectXContext::CompileShader(const std::wstring& pFilename,
-	                                                               const D3D_SHADER_MACRO* pDefines,
-	                                                               const std::string& pEntrypoint,
-	                                                               const std::string& pTarget)
+	void DirectXContext::InitializeFrameObjects()
 	{
-		UINT compileFlags = 0;
-#if defined(DEBUG) || defined(_DEBUG)
-        compileFlags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
-#endif
+		m_OcclusionCuller = std::make_unique<OcclusionCuller>();
+		m_LodSelector = std::make_unique<LodSelector>();
 
-		HRESULT hr = S_OK;
+		// ===== Frame Resources =====
+		for (uint32_t i = 0; i < k_FrameCount; ++i)
+		{
+			m_FramesData.push_back(std::make_unique<DirectXFrameData>(RhiDevice::Get(), 1));
+		}
+		m_FramePacer = std::make_unique<FramePacer>(*RhiDevice::Get(), k_FrameCount);
+		m_UploadRing = std::make_unique<UploadRing>(*RhiDevice::Get(), k_FrameCount);
+		m_UploadManager = std::make_unique<UploadManager>(*RhiDevice::Get());
+		m_ObjectTable = std::make_unique<GpuObjectTable>(*RhiDevice::Get(), k_FrameCount);
+		m_MaterialTable = std::make_unique<GpuMaterialTable>(*RhiDevice::Get(), k_FrameCount);
+		// Compiled pipelines of the previous run, the file is rewritten on shutdown when new ones were compiled.
+		m_PipelineCache = std::make_unique<PipelineCache>(*RhiDevice::Get());
+		m_PipelineCache->Load(k_PipelineCachePath);
+		m_ShaderCompiler = std::make_unique<ShaderCompiler>(std::make_unique<DirectXShaderCompiler>(),
+		                                                    k_ShaderCacheDirectory);
+		m_DrawQueue = std::make_unique<DrawQueue>();
+		m_FrameCommandList = std::make_unique<StateFilteringCommandList>(RhiDevice::Get()->GetCommandList());
+		// One list per range the JobSystem can split the draws in, plus one for what follows them.
+		m_CommandListPool = std::make_unique<CommandListPool>(*RhiDevice::Get(), k_FrameCount,
+		                                                      JobSystem::GetThreadCount() + 1);
+		m_RenderGraph = std::make_unique<RenderGraph>(*RhiDevice::Get(), k_FrameCount);
+	}
 
-		Microsoft::WRL::ComPtr<ID3DBlob> byteCode = nullptr;
-		Microsoft::WRL::ComPtr<ID3DBlob> errors;
-		hr = D3DCompileFromFile(pFilename.c_str(), pDefines, D3D_COMPILE_STANDARD_FILE_INCLUDE,
-		                        pEntrypoint.c_str(), pTarget.c_str(), compileFlags, 0, &byteCode, &errors);
+	uint32_t DirectXContext::GetFrameIndex() const
+	{
+		return m_FramePacer->GetFrameIndex();
+	}
 
-		if (errors != nullptr)
-			OutputDebugStringA(static_cast<char*>(errors->GetBufferPointer()));
+    void DirectXContext::Shutdown()
+    {
+        s_Instance->m_FramePacer->WaitIdle();
+        RhiDevice::Get()->GetQueue(RhiQueueType::Graphics).Flush();
+        s_Instance->m_ObjectTable.reset();
+        s_Instance->m_MaterialTable.reset();
+        if (s_Instance->m_PipelineCache->IsDirty())
+            s_Instance->m_PipelineCache->Save(k_PipelineCachePath);
+        s_Instance->m_PipelineCache.reset();
+        s_Instance->m_ShaderCompiler.reset();
+        s_Instance->m_UploadRing.reset();
+        s_Instance->m_MeshPools.clear();
+        s_Instance->m_UploadManager.reset();
+        s_Instance->m_FramePacer.reset();
+        s_Instance->m_FrameCommandList.reset();
+        s_Instance->m_CommandListPool.reset();
+        s_Instance->m_RenderGraph.reset();
+        RhiDevice::Shutdown();
+    }
 
-		THROW_IF_FAILED(hr);
+	void DirectXContext::EnableMeshPool(const uint32_t pVertexStride, const uint32_t pVertexCapacity,
+	                                    const uint32_t pIndexCapacity)
+	{
+		if (!m_MeshPools.contains(pVertexStride))
+		{
+			m_MeshPools.emplace(pVertexStride, std::make_unique<MeshPool>(*RhiDevice::Get(), pVertexStride, k_FrameCount,
+			                                                              pVertexCapacity, pIndexCapacity));
+		}
+	}
 
-		return byteCode;
+	MeshPool* DirectXContext::GetMeshPool(const uint32_t pVertexStride) const
+	{
+		const auto it = m_MeshPools.find(pVertexStride);
+		return it == m_MeshPools.end() ? nullptr : it->second.get();
 	}
 
 	void DirectXContext::InitializeMsaa()
@@ -12,6 +12,7 @@
 #include <DirectXCollision.h>
 #include <string>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 #include <sstream>
 #include "d3dx12.h"
@@ -39,13 +40,38 @@ namespace Engine
 
 	class DirectXCamera;
 	class DirectXResourceManager;
+	class FramePacer;
+	class UploadRing;
+	class UploadManager;
+	class GpuObjectTable;
+	class GpuMaterialTable;
+	class PipelineCache;
+	class ShaderCompiler;
+	class DrawQueue;
+	class StateFilteringCommandList;
+	class CommandListPool;
+	class RenderGraph;
+	class MeshPool;
+	class OcclusionCuller;
+	class LodSelector;
+	class Object;
 
 	class DirectXContext
 	{
 	public:
-		static void Initialize();
+		// Frames the CPU can record ahead of the GPU, each with its own per-frame resources.
+		static constexpr uint32_t k_FrameCount = 3;
+		// Compiled pipelines of the previous run, next to the executable.
+		static constexpr const char* k_PipelineCachePath = "PipelineCache.bin";
+		// Compiled shaders, one file per source, defines and entry point.
+		static constexpr const char* k_ShaderCacheDirectory = "ShaderCache";
+
+		static void Initialize(bool pHeadless = false);
 		static void Shutdown();
 		DirectXResourceManager& GetResourceManager() const { return *m_ResourceManager; }
+		/// <returns> True when running on the null render backend : there is no D3D12 device, swapchain nor
+		/// resource manager. </returns>
+		bool IsHeadless() const { return m_Device == nullptr; }
 
 		static void LogErrorIfFailed(const HRESULT pHr, const char* pFile, int pLine)
 		{
@@ -68,20 +94,43 @@ namespace Engine
 
 		static UINT CalcConstantBufferByteSize(UINT byteSize) { return (byteSize + 255) & ~255; }
 
-		static Microsoft::WRL::ComPtr<ID3D12Resource> CreateDefaultBuffer(
-			ID3D12Device* pDevice, ID3D12GraphicsCommandList* pCmdList, const void* pInitData, UINT64 pByteSize,
-			Microsoft::WRL::ComPtr<ID3D12Resource>& pUploadBuffer);
-
-		static Microsoft::WRL::ComPtr<ID3DBlob> CompileShader(const std::wstring& pFilename,
-		                                                      const D3D_SHADER_MACRO* pDefines,
-		                                                      const std::string& pEntrypoint,
-		                                                      const std::string& pTarget);
-
 		static DirectXContext* Get() { return s_Instance; }
 
+		/// <returns> Index of the frame being recorded, data the CPU writes every frame goes to this slot. </returns>
+		uint32_t GetFrameIndex() const;
+		FramePacer& GetFramePacer() const { return *m_FramePacer; }
+		/// <returns> The allocator of this frame's constants and dynamic geometry. </returns>
+		UploadRing& GetUploadRing() const { return *m_UploadRing; }
+		/// <returns> Where meshes and textures are uploaded from, on the copy queue. nullptr once the context is
+		/// shut down. </returns>
+		UploadManager* GetUploadManager() const { return m_UploadManager.get(); }
+		/// <returns> The per object data the shaders read, nullptr once the context is shut down. </returns>
+		GpuObjectTable* GetObjectTable() const { return m_ObjectTable.get(); }
+		/// <returns> Every material's parameters, nullptr once the context is shut down. </returns>
+		GpuMaterialTable* GetMaterialTable() const { return m_MaterialTable.get(); }
+		/// <returns> Where the shaders get their pipelines from. </returns>
+		PipelineCache& GetPipelineCache() const { return *m_PipelineCache; }
+		/// <returns> Where the shaders get their bytecode from. </returns>
+		ShaderCompiler& GetShaderCompiler() const { return *m_ShaderCompiler; }
+		DrawQueue& GetDrawQueue() const { return *m_DrawQueue; }
+		/// <returns> The list frames are recorded into : the device's one, without the redundant state changes. </returns>
+		StateFilteringCommandList& GetFrameCommandList() const { return *m_FrameCommandList; }
+		/// <returns> The lists the draw queue is recorded into in parallel, one per job thread plus the last one. </returns>
+		CommandListPool& GetCommandListPool() const { return *m_CommandListPool; }
+		/// <summary>
+		/// Opt in : the meshes created afterward with vertices of pVertexStride bytes share one vertex buffer and
+		/// one index buffer. Does nothing when the pool exists.
+		/// </summary>
+		void EnableMeshPool(uint32_t pVertexStride, uint32_t pVertexCapacity = 1 << 20, uint32_t pIndexCapacity = 3 << 20);
+		/// <returns> The pool of the stride, nullptr when it is not enabled or once the context is shut down. </returns>
+		MeshPool* GetMeshPool(uint32_t pVertexStride) const;
+
 	private:
 		void InitializeMsaa();
-		DirectXFrameData& CurrentFrameData() const { return *m_FramesData[m_CurrentFrameData]; }
+		void InitializeHeadless();
+		// Objects shared by the D3D12 and the headless paths.
+		void InitializeFrameObjects();
+		DirectXFrameData& CurrentFrameData() const { return *m_FramesData[GetFrameIndex()]; }
 
 		Microsoft::WRL::ComPtr<IDXGIFactory4> m_Factory;
 		std::unique_ptr<DirectXSwapchain> m_Swapchain;
@@ -99,12 +148,31 @@ namespace Engine
 		D3D_DRIVER_TYPE m_DriverType = D3D_DRIVER_TYPE_HARDWARE;
 
 		std::vector<std::unique_ptr<DirectXFrameData>> m_FramesData;
-		int m_CurrentFrameData = 0;
+		std::unique_ptr<FramePacer> m_FramePacer;
+		std::unique_ptr<UploadRing> m_UploadRing;
+		std::unique_ptr<UploadManager> m_UploadManager;
+		std::unique_ptr<GpuObjectTable> m_ObjectTable;
+		std::unique_ptr<GpuMaterialTable> m_MaterialTable;
+		std::unique_ptr<PipelineCache> m_PipelineCache;
+		std::unique_ptr<ShaderCompiler> m_ShaderCompiler;
+		std::unique_ptr<DrawQueue> m_DrawQueue;
+		std::unique_ptr<StateFilteringCommandList> m_FrameCommandList;
+		std::unique_ptr<CommandListPool> m_CommandListPool;
+		// Declared again every frame by BeginFrame(), m_SceneDepth is its depth buffer.
+		std::unique_ptr<RenderGraph> m_RenderGraph;
+		uint32_t m_SceneDepth = 0;
+		// By vertex stride.
+		std::unordered_map<uint32_t, std::unique_ptr<MeshPool>> m_MeshPools;
 		Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> m_PassConstantHeap = nullptr;
 
 		// Camera
 		std::unique_ptr<DirectXCamera> m_Camera;
 
+		// Culling
+		std::unique_ptr<OcclusionCuller> m_OcclusionCuller;
+		std::unique_ptr<LodSelector> m_LodSelector;
+		std::vector<Object*> m_Occluders;
+
 	private:
 		static DirectXContext* s_Instance;
 
@@ -113,7 +181,7 @@ namespace Engine
 		friend class DirectXCommandObject;
 		friend class DirectXShader;
 		friend class DirectXSimpleShader;
-		friend class DirectXTextureShader;
+		friend class DirectXBindlessShader;
 		friend class DirectXLitShader;
 		friend class DirectXMesh;
 		friend class DirectXMaterial;
@@ -3,104 +3,20 @@
 
 #include "DirectXContext.h"
 #include "UploadBuffer.h"
+#include "Vertex.h"
+#include "Shaders/ShaderLayouts.h"
 
 namespace Engine
 {
-	struct DirectionalLight
-	{
-		alignas(16) DirectX::XMFLOAT3 Color = {1.0f, 1.0f, 1.0f};
-		alignas(16) DirectX::XMFLOAT3 Direction = {0.0f, -1.0f, 0.0f};
-	};
-
-	struct PassConstants
-	{
-		alignas(16) DirectX::XMFLOAT4X4 ViewProj = MathHelper::Identity4x4();
-		alignas(16) DirectX::XMFLOAT3 EyePosW{0.0f, 0.0f, 0.0f};
-
-		alignas(16) DirectX::XMFLOAT4 AmbientLight{0.2f, 0.2f, 0.2f, 1.0f};
-
-		alignas(16) int NumDirectionalLights = 0;
-
-		alignas(16) DirectionalLight DirectionalLights[10];
-	};
-
-	struct Vertex
-	{
-	};
-
-	struct VertexColor : Vertex
-	{
-		DirectX::XMFLOAT3 Position;
-		DirectX::XMFLOAT4 Color{1, 1, 1, 1};
-
-		VertexColor(const DirectX::XMFLOAT3 pPosition)
-			: Vertex(), Position(pPosition)
-		{
-		}
-
-		VertexColor(const DirectX::XMFLOAT3 pPosition, const DirectX::XMFLOAT4 pColor)
-			: Vertex(), Position(pPosition), Color(pColor)
-		{
-		}
-
-		static std::vector<D3D12_INPUT_ELEMENT_DESC> GetLayout()
-		{
-			return {
-				{"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
-				{"COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0}
-			};
-		}
-	};
-
-	struct VertexTex : Vertex
-	{
-		DirectX::XMFLOAT3 Position;
-		DirectX::XMFLOAT2 TexCoord;
-
-		VertexTex(const DirectX::XMFLOAT3 pPosition, const DirectX::XMFLOAT2 pTexCoord)
-			: Vertex(), Position(pPosition), TexCoord(pTexCoord)
-		{
-		}
-
-		static std::vector<D3D12_INPUT_ELEMENT_DESC> GetLayout()
-		{
-			return {
-				{"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
-				{"TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0}
-			};
-		}
-	};
-
-	struct VertexLit : Vertex
-	{
-		DirectX::XMFLOAT3 Position;
-		DirectX::XMFLOAT2 TexCoord;
-		DirectX::XMFLOAT3 Normal;
-
-		VertexLit(const DirectX::XMFLOAT3 pPosition, const DirectX::XMFLOAT2 pTexCoord, const DirectX::XMFLOAT3 pNormal)
-			: Vertex(), Position(pPosition), TexCoord(pTexCoord), Normal(pNormal)
-		{
-		}
-
-		static std::vector<D3D12_INPUT_ELEMENT_DESC> GetLayout()
-		{
-			return {
-				{"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
-				{"TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
-				{"NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 20, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0}
-			};
-		}
-	};
-
 	struct DirectXFrameData
 	{
-		DirectXFrameData(ID3D12Device* pDevice, UINT pPassCount)
+		DirectXFrameData(RhiDevice* pDevice, UINT pPassCount)
 		{
-			THROW_IF_FAILED(pDevice->CreateCommandAllocator(
-				D3D12_COMMAND_LIST_TYPE_DIRECT,
-				IID_PPV_ARGS(CmdListAlloc.GetAddressOf())));
+			CmdListAlloc = pDevice->CreateCommandAllocator(RhiQueueType::Graphics);
 
 			PassCB = std::make_unique<UploadBuffer<PassConstants>>(pDevice, pPassCount, true);
+			m_Constants.ViewProj = MathHelper::Identity4x4();
+			m_Constants.AmbientLight = {0.2f, 0.2f, 0.2f, 1.0f};
 			m_IsDirty = true;
 		}
 
@@ -110,17 +26,14 @@ namespace Engine
 
 		// We cannot reset the allocator until the GPU is done processing the commands.
 		// So each frame needs their own allocator.
-		Microsoft::WRL::ComPtr<ID3D12CommandAllocator> CmdListAlloc;
+		std::unique_ptr<RhiCommandAllocator> CmdListAlloc;
 
-		PassConstants m_Constants;
+		// Generated from the lit shader's cbPass, see ShaderLayouts.h.
+		PassConstants m_Constants = {};
 		// We cannot update a cbuffer until the GPU is done processing the commands
 		// that reference it.  So each frame needs their own cbuffers.
 		std::unique_ptr<UploadBuffer<PassConstants>> PassCB = nullptr;
 
-		// Fence value to mark commands up to this fence point.  This lets us
-		// check if these frame resources are still in use by the GPU.
-		UINT64 Fence = 0;
-
 	public:
 		void SetViewProj(const DirectX::XMFLOAT4X4& viewProj)
 		{
@@ -152,18 +65,28 @@ namespace Engine
 			m_IsDirty = true;
 		}
 
+		int GetNumDirectionalLights() const { return m_Constants.NumDirectionalLights; }
+
 		void Update()
 		{
 			if (m_IsDirty)
 			{
-				PassCB->CopyData(0, m_Constants);
+				// The lights are last, the unused ones are never read.
+				m_UploadedBytes = static_cast<uint32_t>(offsetof(PassConstants, DirectionalLights) +
+					m_Constants.NumDirectionalLights * sizeof(DirectionalLight));
+				PassCB->CopyData(0, m_Constants, m_UploadedBytes);
 				m_IsDirty = false;
 			}
+			else
+				m_UploadedBytes = 0;
 		}
 
 		bool IsDirty() { return m_IsDirty; }
+		/// <returns> The bytes of pass constants the last Update() uploaded. </returns>
+		uint32_t GetUploadedBytes() const { return m_UploadedBytes; }
 
 	private:
 		bool m_IsDirty;
+		uint32_t m_UploadedBytes = 0;
 	};
 }
@@ -1,5 +1,7 @@
 ﻿#include "DirectXMesh.h"
 
+#include <numeric>
+
 #include "DirectXCommandObject.h"
 #include "DirectXContext.h"
 #include "Materials/DirectXMaterial.h"
@@ -7,11 +9,35 @@
 
 namespace Engine
 {
+    uint32_t DirectXMesh::s_NextSortId = 0;
+
+    DirectXMesh::~DirectXMesh()
+    {
+        // The copy queue may still be writing the buffers.
+        if (UploadManager* uploads = DirectXContext::Get()->GetUploadManager())
+            uploads->Wait(m_UploadTicket);
+        // The pools are gone once the context is shut down.
+        if (m_Pool && DirectXContext::Get()->GetMeshPool(m_VertexBuffer.Stride) == m_Pool)
+            m_Pool->Free(m_PoolHandle);
+    }
+
+    bool DirectXMesh::IsUploaded() const
+    {
+        const UploadManager* uploads = DirectXContext::Get()->GetUploadManager();
+        return uploads == nullptr || uploads->IsDone(m_UploadTicket);
+    }
 
     std::unique_ptr<Engine::DirectXMesh> DirectXMesh::CreateFromFile(const char* file)
     {
         std::vector<Engine::VertexLit> vertices;
         Engine::ObjLoader::LoadObj(file, &vertices);
+        // Not indexed, 16 bits indices only reach the first 65536 vertices.
+        if (vertices.size() > 65536)
+        {
+            std::vector<uint32_t> indices(vertices.size());
+            std::iota(indices.begin(), indices.end(), 0u);
+            return std::make_unique<Engine::DirectXMesh>(vertices, indices);
+        }
         std::vector<uint16_t> indices;
         for (size_t i = 0; i < vertices.size(); i++)
         {
@@ -20,13 +46,28 @@ namespace Engine
         return std::make_unique<Engine::DirectXMesh>(vertices, indices);
     }
 
-    void DirectXMesh::Draw()
+    uint64_t DirectXMesh::GetGpuBytes() const
+    {
+        const uint64_t indexSize = m_IndexBuffer.Format == RhiFormat::R32Uint ? sizeof(uint32_t) : sizeof(uint16_t);
+        return m_VertexData.size() + m_Indices.size() * indexSize;
+    }
+
+    void DirectXMesh::Draw(RhiCommandList& pCommandList, const uint32_t pInstanceCount) const
     {
-        DirectXContext::Get()->m_CommandObject->GetCommandList()->IASetVertexBuffers(0, 1, &m_VertexBuffer);
-        DirectXContext::Get()->m_CommandObject->GetCommandList()->IASetIndexBuffer(&m_IndexBuffer);
-        DirectXContext::Get()->m_CommandObject->GetCommandList()->IASetPrimitiveTopology(m_PrimitiveType);
-        
-        DirectXContext::Get()->m_CommandObject->GetCommandList()->DrawIndexedInstanced(m_IndexCount, 1, 0, 0, 0);
+        pCommandList.SetPrimitiveTopology(m_PrimitiveType);
+        if (m_Pool)
+        {
+            // Same buffers for every mesh of the pool, the filter drops the bindings after the first draw.
+            const MeshPool::Range& range = m_Pool->GetRange(m_PoolHandle);
+            pCommandList.SetVertexBuffer(m_Pool->GetVertexBufferView());
+            pCommandList.SetIndexBuffer(m_Pool->GetIndexBufferView());
+            pCommandList.DrawIndexedInstanced(m_IndexCount, pInstanceCount, range.StartIndex, range.BaseVertex, 0);
+            return;
+        }
+
+        pCommandList.SetVertexBuffer(m_VertexBuffer);
+        pCommandList.SetIndexBuffer(m_IndexBuffer);
+        pCommandList.DrawIndexedInstanced(m_IndexCount, pInstanceCount, 0, 0, 0);
     }
 
 
@@ -1,80 +1,134 @@
 ﻿#pragma once
 #include <DirectXMath.h>
+#include <cstring>
 
 #include "DirectXCamera.h"
 #include "DirectXCommandObject.h"
 #include "DirectXContext.h"
 #include "DirectXFrameData.h"
 #include "DirectXSwapchain.h"
+#include "DrawQueue.h"
 #include "MathHelper.h"
+#include "MeshPool.h"
+#include "UploadManager.h"
+#include "Core/MeshBvh.h"
 #include "Resource/Texture.h"
 
 namespace Engine
 {
 	class DirectXMaterial;
 
-    class DirectXMesh
+    class DirectXMesh : public DrawQueueMesh
     {
 
     public:
 
-        template <typename T, typename = std::enable_if_t<std::is_base_of_v<Vertex, T>>>
-        DirectXMesh(std::vector<T>& pVertices, std::vector<uint16_t>& pIndices);
+        /// <summary>
+        /// Indices are 16 or 32 bits, the GPU index buffer keeps their size. Only 16 bits meshes go to a MeshPool.
+        /// </summary>
+        template <typename T, typename TIndex, typename = std::enable_if_t<
+	                  std::is_base_of_v<Vertex, T> && (std::is_same_v<TIndex, uint16_t> || std::is_same_v<TIndex, uint32_t>)>>
+        DirectXMesh(std::vector<T>& pVertices, std::vector<TIndex>& pIndices);
+		/// <summary>
+		/// Waits for the upload of the buffers when it is still on the copy queue, gives the mesh's ranges back
+		/// to its pool.
+		/// </summary>
+		~DirectXMesh();
 
-		void Draw();
+		void Draw(RhiCommandList& pCommandList, uint32_t pInstanceCount = 1) const override;
 
 		static std::unique_ptr<Engine::DirectXMesh> CreateFromFile(const char* file);
 
+		/// <returns> The triangle BVH of the mesh, in mesh local space. </returns>
+		const MeshBvh& GetBvh() const { return m_Bvh; }
+		/// <returns> Small id given at creation, used in the draw sort keys. </returns>
+		uint32_t GetSortId() const override { return m_SortId; }
+		const DirectX::BoundingBox& GetBounds() const { return m_Bvh.GetBounds(); }
+		const std::vector<DirectX::XMFLOAT3>& GetPositions() const { return m_Positions; }
+		/// <returns> The indices, widened to 32 bits whatever the size of the GPU ones. </returns>
+		const std::vector<uint32_t>& GetIndices() const { return m_Indices; }
+		/// <returns> The vertices as they were uploaded, GetVertexStride() bytes each. </returns>
+		const std::vector<uint8_t>& GetVertexData() const { return m_VertexData; }
+		uint32_t GetVertexStride() const { return m_VertexBuffer.Stride; }
+		/// <returns> The bytes of the mesh's vertices and indices on the GPU. </returns>
+		uint64_t GetGpuBytes() const;
+		/// <returns> The upload of the vertex and index buffers, the frames submitted afterward can draw the mesh. </returns>
+		UploadTicket GetUploadTicket() const { return m_UploadTicket; }
+		bool IsUploaded() const;
+		/// <returns> The pool the mesh's geometry is in, nullptr when it has buffers of its own. </returns>
+		const MeshPool* GetPool() const { return m_Pool; }
+		/// <returns> The mesh's ranges in GetPool(), MeshPool::k_InvalidHandle without a pool. </returns>
+		MeshPool::Handle GetPoolHandle() const { return m_PoolHandle; }
+
     private:
+		static uint32_t s_NextSortId;
+		uint32_t m_SortId = s_NextSortId++;
 		int m_NumFramesDirty = DirectXSwapchain::k_SwapChainBufferCount;
 
-		D3D12_PRIMITIVE_TOPOLOGY m_PrimitiveType = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
-
-		Microsoft::WRL::ComPtr<ID3D12Resource> m_VertexBufferGpu;
-		Microsoft::WRL::ComPtr<ID3D12Resource> m_IndexBufferGpu;
+		RhiPrimitiveTopology m_PrimitiveType = RhiPrimitiveTopology::TriangleList;
 
-		Microsoft::WRL::ComPtr<ID3D12Resource> m_VertexBufferUploader;
-		Microsoft::WRL::ComPtr<ID3D12Resource> m_IndexBufferUploader;
+		// Either a range of the pool of the vertex stride, when it is enabled and has room, or buffers of its own.
+		MeshPool* m_Pool = nullptr;
+		MeshPool::Handle m_PoolHandle = MeshPool::k_InvalidHandle;
+		std::unique_ptr<RhiBuffer> m_VertexBufferGpu;
+		std::unique_ptr<RhiBuffer> m_IndexBufferGpu;
+		UploadTicket m_UploadTicket = 0;
 
-		D3D12_VERTEX_BUFFER_VIEW m_VertexBuffer;
-		D3D12_INDEX_BUFFER_VIEW m_IndexBuffer;
+		RhiVertexBufferView m_VertexBuffer;
+		RhiIndexBufferView m_IndexBuffer;
 		UINT m_IndexCount = 0;
+
+		// CPU copy of the geometry, used for picking, culling and static batching.
+		std::vector<DirectX::XMFLOAT3> m_Positions;
+		std::vector<uint32_t> m_Indices;
+		std::vector<uint8_t> m_VertexData;
+		MeshBvh m_Bvh;
 	};
 
-	template <typename T, typename>
-	DirectXMesh::DirectXMesh(std::vector<T>& pVertices, std::vector<uint16_t>& pIndices)
+	template <typename T, typename TIndex, typename>
+	DirectXMesh::DirectXMesh(std::vector<T>& pVertices, std::vector<TIndex>& pIndices)
 		: m_IndexCount(pIndices.size())
 	{
 		// ===== Data =====
-		DirectXContext::Get()->m_CommandObject->GetCommandAllocator()->Reset();
-		DirectXContext::Get()->m_CommandObject->
-		                       ResetList(DirectXContext::Get()->m_CommandObject->GetCommandAllocator());
+		// Copied on the copy queue with the other loads of the frame, the graphics queue waits for them when the
+		// frame is submitted.
+		UploadManager& uploads = *DirectXContext::Get()->GetUploadManager();
 
 		const auto verticesByteSize = static_cast<UINT>(pVertices.size()) * sizeof(T);
-		const auto indicesByteSize = static_cast<UINT>(pIndices.size()) * sizeof(uint16_t);
-
-		m_VertexBufferGpu = DirectXContext::CreateDefaultBuffer(
-			DirectXContext::Get()->m_Device.Get(),
-			DirectXContext::Get()->m_CommandObject->GetCommandList().Get(), pVertices.data(), verticesByteSize,
-			m_VertexBufferUploader);
-
-		m_IndexBufferGpu = DirectXContext::CreateDefaultBuffer(
-			DirectXContext::Get()->m_Device.Get(),
-			DirectXContext::Get()->m_CommandObject->GetCommandList().Get(), pIndices.data(), indicesByteSize,
-			m_IndexBufferUploader);
-
-		DirectXContext::Get()->m_CommandObject->Execute();
-		DirectXContext::Get()->m_CommandObject->Flush();
-
-		m_VertexBuffer.BufferLocation = m_VertexBufferGpu->GetGPUVirtualAddress();
-		m_VertexBuffer.StrideInBytes = sizeof(T);
-		m_VertexBuffer.SizeInBytes = verticesByteSize;
-
-		m_IndexBuffer.BufferLocation = m_IndexBufferGpu->GetGPUVirtualAddress();
-		m_IndexBuffer.Format = DXGI_FORMAT_R16_UINT;
-		m_IndexBuffer.SizeInBytes = indicesByteSize;
-		
-		m_VertexBufferUploader.Reset();
-		m_IndexBufferUploader.Reset();
+		const auto indicesByteSize = static_cast<UINT>(pIndices.size()) * sizeof(TIndex);
+
+		m_VertexBuffer.Stride = sizeof(T);
+		m_IndexBuffer.Format = std::is_same_v<TIndex, uint16_t> ? RhiFormat::R16Uint : RhiFormat::R32Uint;
+		MeshPool* pool = DirectXContext::Get()->GetMeshPool(sizeof(T));
+		if constexpr (std::is_same_v<TIndex, uint16_t>)
+		{
+			if (pool)
+			{
+				m_PoolHandle = pool->Allocate(uploads, pVertices.data(), static_cast<uint32_t>(pVertices.size()),
+				                              pIndices.data(), static_cast<uint32_t>(pIndices.size()));
+				if (m_PoolHandle != MeshPool::k_InvalidHandle)
+					m_Pool = pool;
+			}
+		}
+		if (!m_Pool)
+		{
+			m_VertexBufferGpu = uploads.CreateBuffer(pVertices.data(), verticesByteSize);
+			m_IndexBufferGpu = uploads.CreateBuffer(pIndices.data(), indicesByteSize);
+
+			m_VertexBuffer.Address = m_VertexBufferGpu->GetGpuAddress();
+			m_VertexBuffer.Size = verticesByteSize;
+
+			m_IndexBuffer.Address = m_IndexBufferGpu->GetGpuAddress();
+			m_IndexBuffer.Size = indicesByteSize;
+		}
+		m_UploadTicket = uploads.GetPendingTicket();
+
+		m_Positions.reserve(pVertices.size());
+		for (const T& vertex : pVertices)
+			m_Positions.push_back(vertex.Position);
+		m_Indices.assign(pIndices.begin(), pIndices.end());
+		m_VertexData.resize(verticesByteSize);
+		std::memcpy(m_VertexData.data(), pVertices.data(), verticesByteSize);
+		m_Bvh.Build(m_Positions, m_Indices);
 	}
 }
@@ -23,7 +23,7 @@ namespace Engine
 			                                   : 0;
 		swapchainInfo.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
 		swapchainInfo.BufferCount = k_SwapChainBufferCount;
-		swapchainInfo.OutputWindow = Application::Get()->GetWindow()->GetWindow();
+		swapchainInfo.OutputWindow = static_cast<HWND>(Application::Get()->GetWindow()->GetNativeHandle());
 		swapchainInfo.Windowed = true;
 		swapchainInfo.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
 		swapchainInfo.Flags = DXGI_SWAP_CHAIN_FLAG_ALLOW_MODE_SWITCH;
@@ -33,7 +33,7 @@ namespace Engine
 			&swapchainInfo,
 			m_Swapchain.GetAddressOf()));
 
-		CreateRtvAndDsvDescriptorHeaps();
+		CreateRtvDescriptorHeap();
 	}
 
 	ID3D12Resource* DirectXSwapchain::GetCurrentBackBuffer() const
@@ -49,11 +49,6 @@ namespace Engine
 			m_RenderTargetDescriptorSize);
 	}
 
-	D3D12_CPU_DESCRIPTOR_HANDLE DirectXSwapchain::GetDepthStencilView() const
-	{
-		return m_DepthStencilDescriptor->GetCPUDescriptorHandleForHeapStart();
-	}
-
 	void DirectXSwapchain::Resize(uint32_t pWidth, uint32_t pHeight)
 	{
 		// Flush before changing any resources.
@@ -66,7 +61,6 @@ namespace Engine
 		// Release the previous resources we will be recreating.
 		for (int i = 0; i < k_SwapChainBufferCount; ++i)
 			m_SwapchainBuffers[i].Reset();
-		m_DepthStencilBuffer.Reset();
 
 		// Resize the swap chain.
 		THROW_IF_FAILED(m_Swapchain->ResizeBuffers(
@@ -86,51 +80,6 @@ namespace Engine
 			rtvHeapHandle.Offset(1, m_RenderTargetDescriptorSize);
 		}
 
-		// Create the depth/stencil buffer and view.
-		D3D12_RESOURCE_DESC depthStencilDesc;
-		depthStencilDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
-		depthStencilDesc.Alignment = 0;
-		depthStencilDesc.Width = pWidth;
-		depthStencilDesc.Height = pHeight;
-		depthStencilDesc.DepthOrArraySize = 1;
-		depthStencilDesc.MipLevels = 1;
-		depthStencilDesc.Format = DXGI_FORMAT_R24G8_TYPELESS;
-
-		depthStencilDesc.SampleDesc.Count = DirectXContext::Get()->m_4xMsaaState ? 4 : 1;
-		depthStencilDesc.SampleDesc.Quality = DirectXContext::Get()->m_4xMsaaState
-			                                      ? (DirectXContext::Get()->m_4xMsaaQuality - 1)
-			                                      : 0;
-		depthStencilDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
-		depthStencilDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL;
-
-		D3D12_CLEAR_VALUE optClear;
-		optClear.Format = k_DepthStencilFormat;
-		optClear.DepthStencil.Depth = 1.0f;
-		optClear.DepthStencil.Stencil = 0;
-		auto properties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
-		THROW_IF_FAILED(DirectXContext::Get()->m_Device->CreateCommittedResource(
-			&properties,
-			D3D12_HEAP_FLAG_NONE,
-			&depthStencilDesc,
-			D3D12_RESOURCE_STATE_COMMON,
-			&optClear,
-			IID_PPV_ARGS(m_DepthStencilBuffer.GetAddressOf())));
-
-		// Create descriptor to mip level 0 of entire resource using the format of the resource.
-		D3D12_DEPTH_STENCIL_VIEW_DESC dsvDesc;
-		dsvDesc.Flags = D3D12_DSV_FLAG_NONE;
-		dsvDesc.ViewDimension = D3D12_DSV_DIMENSION_TEXTURE2D;
-		dsvDesc.Format = k_DepthStencilFormat;
-		dsvDesc.Texture2D.MipSlice = 0;
-		DirectXContext::Get()->m_Device->CreateDepthStencilView(m_DepthStencilBuffer.Get(), &dsvDesc,
-		                                                        GetDepthStencilView());
-
-		// Transition the resource from its initial state to be used as a depth buffer.
-		auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(m_DepthStencilBuffer.Get(),
-		                                                    D3D12_RESOURCE_STATE_COMMON,
-		                                                    D3D12_RESOURCE_STATE_DEPTH_WRITE);
-		DirectXContext::Get()->m_CommandObject->GetCommandList()->ResourceBarrier(1, &barrier);
-
 		// Execute the resize commands.
 		DirectXContext::Get()->m_CommandObject->Execute();
 
@@ -152,19 +101,12 @@ namespace Engine
 	{
 		THROW_IF_FAILED(m_Swapchain->Present(0, 0));
 		m_CurrentBackBuffer = (m_CurrentBackBuffer + 1) % k_SwapChainBufferCount;
-
-		// Wait until frame commands are complete.  This waiting is inefficient and is
-		// done for simplicity.  Later we will show how to organize our rendering code
-		// so we do not have to wait per frame.
-		DirectXContext::Get()->m_CommandObject->Flush(); // TODO : Refactor this pls x/
 	}
 
-	void DirectXSwapchain::CreateRtvAndDsvDescriptorHeaps()
+	void DirectXSwapchain::CreateRtvDescriptorHeap()
 	{
 		m_RenderTargetDescriptorSize = DirectXContext::Get()->m_Device->GetDescriptorHandleIncrementSize(
 			D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
-		m_DepthStencilDescriptorSize = DirectXContext::Get()->m_Device->GetDescriptorHandleIncrementSize(
-			D3D12_DESCRIPTOR_HEAP_TYPE_DSV);
 
 		D3D12_DESCRIPTOR_HEAP_DESC rtvHeapDesc;
 		rtvHeapDesc.NumDescriptors = k_SwapChainBufferCount;
@@ -173,14 +115,5 @@ namespace Engine
 		rtvHeapDesc.NodeMask = 0;
 		THROW_IF_FAILED(DirectXContext::Get()->m_Device->CreateDescriptorHeap(
 			&rtvHeapDesc, IID_PPV_ARGS(m_RenderTargetDescriptor.GetAddressOf())));
-
-
-		D3D12_DESCRIPTOR_HEAP_DESC dsvHeapDesc;
-		dsvHeapDesc.NumDescriptors = 1;
-		dsvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_DSV;
-		dsvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
-		dsvHeapDesc.NodeMask = 0;
-		THROW_IF_FAILED(DirectXContext::Get()->m_Device->CreateDescriptorHeap(
-			&dsvHeapDesc, IID_PPV_ARGS(m_DepthStencilDescriptor.GetAddressOf())));
 	}
 }
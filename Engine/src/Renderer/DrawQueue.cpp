@@ -0,0 +1,146 @@
+#include "DrawQueue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+
+#include "CommandListPool.h"
+#include "UploadRing.h"
+#include "Core/JobSystem.h"
+
+namespace Engine
+{
+	uint64_t DrawQueue::MakeKey(const DrawPass pPass, const uint32_t pShader, const uint32_t pVariant, const uint32_t pMesh,
+	                            const float pDepth)
+	{
+		// Positive floats order like their bits, the top ones keep a precision relative to the distance.
+		const uint32_t depth = std::bit_cast<uint32_t>((std::max)(pDepth, 0.0f)) >> (32 - 1 - k_DepthBits);
+
+		uint64_t key = static_cast<uint64_t>(pPass) & ((1ull << k_PassBits) - 1);
+		key = (key << k_ShaderBits) | (pShader & ((1ull << k_ShaderBits) - 1));
+		key = (key << k_VariantBits) | (pVariant & ((1ull << k_VariantBits) - 1));
+		key = (key << k_MeshBits) | (pMesh & ((1ull << k_MeshBits) - 1));
+		key = (key << k_DepthBits) | depth;
+		return key;
+	}
+
+	void DrawQueue::Submit(const DrawQueueMesh* pMesh, const DrawQueueMaterial* pMaterial, const uint32_t pObjectId,
+	                       const float pDepth, const DrawPass pPass)
+	{
+		const uint32_t shader = pMaterial->GetShaderSortId();
+		const ShaderVariantKey variant = pMaterial->SelectVariant();
+		m_Keys.push_back(MakeKey(pPass, shader, variant, pMesh->GetSortId(), pDepth));
+		m_Packets.push_back({pMesh, pMaterial, pObjectId, shader, variant});
+	}
+
+	const std::vector<uint32_t>& DrawQueue::Sort()
+	{
+		m_Order.resize(m_Packets.size());
+		m_Sorter.Sort(m_Keys.data(), static_cast<uint32_t>(m_Keys.size()), m_Order.data());
+		return m_Order;
+	}
+
+	void DrawQueue::Flush(RhiCommandList& pCommandList, UploadRing& pUploadRing)
+	{
+		if (Prepare(pUploadRing))
+		{
+			RecordDrawCalls(pCommandList, 0, static_cast<uint32_t>(m_DrawCalls.size()));
+			m_Stats.ListCount = 1;
+		}
+		Clear();
+	}
+
+	uint32_t DrawQueue::Flush(CommandListPool& pPool, UploadRing& pUploadRing,
+	                          const std::function<void(RhiCommandList&)>& pSetUpList)
+	{
+		if (!Prepare(pUploadRing))
+		{
+			Clear();
+			return 0;
+		}
+
+		// Ranges of at least k_MinDrawCallsPerList, and no more than there are lists.
+		const uint32_t drawCallCount = static_cast<uint32_t>(m_DrawCalls.size());
+		const uint32_t minRange = (std::max)(k_MinDrawCallsPerList,
+		                                     (drawCallCount + pPool.GetListCount() - 1) / pPool.GetListCount());
+		std::atomic<uint32_t> listCount = 0;
+		JobSystem::ParallelFor(drawCallCount, minRange,
+		                       [&](const uint32_t pFirst, const uint32_t pLast, const uint32_t pRange)
+		                       {
+			                       // Ranges are contiguous and numbered in order, so are the lists.
+			                       RhiCommandList& commandList = pPool.Begin(pRange);
+			                       pSetUpList(commandList);
+			                       RecordDrawCalls(commandList, pFirst, pLast);
+			                       pPool.End(pRange);
+			                       listCount.fetch_add(1, std::memory_order_relaxed);
+		                       });
+
+		m_Stats.ListCount = listCount.load();
+		Clear();
+		return m_Stats.ListCount;
+	}
+
+	bool DrawQueue::Prepare(UploadRing& pUploadRing)
+	{
+		m_Stats.SubmittedDraws = static_cast<uint32_t>(m_Packets.size());
+		m_Stats.DrawCalls = 0;
+		m_Stats.ListCount = 0;
+		m_DrawCalls.clear();
+		if (m_Packets.empty())
+			return false;
+
+		Sort();
+
+		m_Instances.resize(m_Packets.size());
+		for (size_t i = 0; i < m_Packets.size(); ++i)
+		{
+			const Packet& packet = m_Packets[m_Order[i]];
+			m_Instances[i] = {packet.ObjectId, packet.Material->GetMaterialId()};
+		}
+
+		const uint64_t size = m_Instances.size() * sizeof(InstanceData);
+		const UploadAllocation allocation = pUploadRing.Allocate(size);
+		RhiDevice::Get()->WriteBuffer(*allocation.Buffer, allocation.Offset, m_Instances.data(), size);
+		m_InstancesAddress = allocation.GpuAddress;
+
+		// Ids wrapping in the key can interleave groups, so what is merged is checked on the packets themselves.
+		uint32_t first = 0;
+		while (first < m_Packets.size())
+		{
+			const Packet& packet = m_Packets[m_Order[first]];
+			uint32_t count = 1;
+			if (m_IsEnabled)
+			{
+				while (first + count < m_Packets.size())
+				{
+					const Packet& next = m_Packets[m_Order[first + count]];
+					if (next.Mesh != packet.Mesh || next.Shader != packet.Shader || next.Variant != packet.Variant)
+						break;
+					++count;
+				}
+			}
+
+			m_DrawCalls.push_back({first, count});
+			first += count;
+		}
+		m_Stats.DrawCalls = static_cast<uint32_t>(m_DrawCalls.size());
+		return true;
+	}
+
+	void DrawQueue::RecordDrawCalls(RhiCommandList& pCommandList, const uint32_t pFirst, const uint32_t pLast) const
+	{
+		for (uint32_t i = pFirst; i < pLast; ++i)
+		{
+			const DrawCall& drawCall = m_DrawCalls[i];
+			const Packet& packet = m_Packets[m_Order[drawCall.FirstInstance]];
+			packet.Material->Bind(pCommandList, packet.Variant, m_InstancesAddress, drawCall.FirstInstance);
+			packet.Mesh->Draw(pCommandList, drawCall.InstanceCount);
+		}
+	}
+
+	void DrawQueue::Clear()
+	{
+		m_Keys.clear();
+		m_Packets.clear();
+	}
+}
@@ -0,0 +1,194 @@
+#pragma once
+#include <functional>
+#include <vector>
+
+#include <DirectXMath.h>
+
+#include "Core/RadixSort.h"
+#include "RHI/RhiDevice.h"
+#include "Shaders/ShaderPermutations.h"
+
+namespace Engine
+{
+	class UploadRing;
+	class CommandListPool;
+
+	/// <summary>
+	/// Element of the per-frame instance buffer, read by the shaders as
+	/// StructuredBuffer&lt;InstanceData&gt; gInstances : register(t1, space1) at gInstances[gFirstInstance + SV_InstanceID].
+	/// </summary>
+	struct InstanceData
+	{
+		// Element of the GpuObjectTable.
+		uint32_t ObjectId = 0;
+		// Element of the GpuMaterialTable.
+		uint32_t MaterialId = 0;
+	};
+
+	/// <summary>
+	/// Geometry as the draw queue sees it, implemented by DirectXMesh.
+	/// </summary>
+	class DrawQueueMesh
+	{
+	public:
+		virtual ~DrawQueueMesh() = default;
+
+		/// <summary>
+		/// Records the draw of the mesh's indices, the material of the draw is already bound.
+		/// </summary>
+		virtual void Draw(RhiCommandList& pCommandList, uint32_t pInstanceCount) const = 0;
+		/// <returns> Small id given at creation, used in the draw sort keys. </returns>
+		virtual uint32_t GetSortId() const = 0;
+	};
+
+	/// <summary>
+	/// Shader and parameters as the draw queue sees them, implemented by DirectXMaterial.
+	/// </summary>
+	class DrawQueueMaterial
+	{
+	public:
+		virtual ~DrawQueueMaterial() = default;
+
+		/// <summary>
+		/// Binds the shader and the state shared by the instances of a draw.
+		/// </summary>
+		/// <param name="pCommandList"></param>
+		/// <param name="pVariant"> : the shader variant SelectVariant() picked for this material</param>
+		/// <param name="pInstances"> : this frame's InstanceData buffer</param>
+		/// <param name="pFirstInstance"> : the draw's first element in pInstances</param>
+		virtual void Bind(RhiCommandList& pCommandList, ShaderVariantKey pVariant, RhiGpuAddress pInstances,
+		                  uint32_t pFirstInstance) const = 0;
+		/// <summary>
+		/// Main thread only, the variant may be created on the way.
+		/// </summary>
+		/// <returns> The variant of the shader drawing the material this frame. </returns>
+		virtual ShaderVariantKey SelectVariant() const = 0;
+		/// <returns> Small id of the material's shader, draws of different shaders never share a draw call. </returns>
+		virtual uint32_t GetShaderSortId() const = 0;
+		/// <returns> The index of the material's record in the material table. </returns>
+		virtual uint32_t GetMaterialId() const = 0;
+	};
+
+	/// <summary>
+	/// Passes of the draw queue, in the order they are drawn.
+	/// </summary>
+	enum class DrawPass : uint8_t
+	{
+		Opaque = 0,
+	};
+
+	/// <summary>
+	/// Gathers the draws of a frame as packets with a 64 bits sort key, radix sorts them and issues the ones sharing a
+	/// mesh, a shader and a shader variant as a single instanced draw. Every draw becomes one InstanceData, so
+	/// materials of the same variant share a draw whatever their parameters and textures.
+	/// Key, from the most significant bits : pass (4) | shader (8) | variant (16) | mesh (16) | depth (20).
+	/// Opaque draws are grouped by state first, then front to back inside a group so the instances of a draw
+	/// are rasterized closest first.
+	/// Submit() from the main thread, between BeginFrame() and EndFrame().
+	/// </summary>
+	class DrawQueue
+	{
+	public:
+		struct Stats
+		{
+			// Draws submitted during the last frame, and the draw calls they were issued as.
+			uint32_t SubmittedDraws = 0;
+			uint32_t DrawCalls = 0;
+			// Command lists the draw calls were recorded into.
+			uint32_t ListCount = 0;
+		};
+
+		// Draw calls below which recording on one more thread costs more than it saves.
+		static constexpr uint32_t k_MinDrawCallsPerList = 64;
+
+		static constexpr uint32_t k_PassBits = 4;
+		static constexpr uint32_t k_ShaderBits = 8;
+		static constexpr uint32_t k_VariantBits = 16;
+		static constexpr uint32_t k_MeshBits = 16;
+		static constexpr uint32_t k_DepthBits = 20;
+		static_assert(k_PassBits + k_ShaderBits + k_VariantBits + k_MeshBits + k_DepthBits == 64);
+
+		/// <summary>
+		/// Builds the sort key of a draw. Ids wider than their field wrap, which only costs some ordering.
+		/// </summary>
+		/// <param name="pPass"></param>
+		/// <param name="pShader"> : DrawQueueMaterial::GetShaderSortId()</param>
+		/// <param name="pVariant"> : DrawQueueMaterial::SelectVariant()</param>
+		/// <param name="pMesh"> : DrawQueueMesh::GetSortId()</param>
+		/// <param name="pDepth"> : distance from the camera, the top bits of the float are kept (negatives count as 0)</param>
+		static uint64_t MakeKey(DrawPass pPass, uint32_t pShader, uint32_t pVariant, uint32_t pMesh, float pDepth);
+
+		/// <summary>
+		/// Queues a draw of the mesh with the material.
+		/// </summary>
+		/// <param name="pMesh"></param>
+		/// <param name="pMaterial"></param>
+		/// <param name="pObjectId"> : the drawn Object's element in the GPU object table</param>
+		/// <param name="pDepth"> : distance from the camera to the Object</param>
+		/// <param name="pPass"></param>
+		void Submit(const DrawQueueMesh* pMesh, const DrawQueueMaterial* pMaterial, uint32_t pObjectId, float pDepth,
+		            DrawPass pPass = DrawPass::Opaque);
+
+		/// <summary>
+		/// Sorts the submitted draws, writes their instances into this frame's upload memory and records the draws.
+		/// </summary>
+		void Flush(RhiCommandList& pCommandList, UploadRing& pUploadRing);
+
+		/// <summary>
+		/// Same as Flush(pCommandList, ...) but the draw calls are split in contiguous ranges recorded in parallel
+		/// with the JobSystem, range i into list i of pPool. Lists do not inherit any state, pSetUpList binds the
+		/// frame's one (render target, viewport...) at the start of every list.
+		/// </summary>
+		/// <returns> The number of lists recorded, from list 0, to execute in order. </returns>
+		uint32_t Flush(CommandListPool& pPool, UploadRing& pUploadRing,
+		               const std::function<void(RhiCommandList&)>& pSetUpList);
+
+		/// <summary>
+		/// Sorts the submitted draws by key without recording anything.
+		/// Flush() calls it, it is public to measure the sort alone.
+		/// </summary>
+		/// <returns> The indices of the submitted draws, in key order. </returns>
+		const std::vector<uint32_t>& Sort();
+
+		/// <summary>
+		/// When disabled, every submitted draw is issued on its own (to compare against instancing).
+		/// </summary>
+		void SetEnabled(const bool pIsEnabled) { m_IsEnabled = pIsEnabled; }
+		[[nodiscard]] bool IsEnabled() const { return m_IsEnabled; }
+
+		[[nodiscard]] const Stats& GetStats() const { return m_Stats; }
+
+	private:
+		struct Packet
+		{
+			const DrawQueueMesh* Mesh;
+			const DrawQueueMaterial* Material;
+			uint32_t ObjectId;
+			uint32_t Shader;
+			ShaderVariantKey Variant;
+		};
+
+		// Instances [FirstInstance, FirstInstance + InstanceCount) of the sorted packets.
+		struct DrawCall
+		{
+			uint32_t FirstInstance;
+			uint32_t InstanceCount;
+		};
+
+		/// <returns> False when nothing was submitted, else the instances are uploaded and the draw calls built. </returns>
+		bool Prepare(UploadRing& pUploadRing);
+		void RecordDrawCalls(RhiCommandList& pCommandList, uint32_t pFirst, uint32_t pLast) const;
+		void Clear();
+
+		// Keys and packets are kept apart, the sort only moves the key and the packet's index.
+		std::vector<uint64_t> m_Keys;
+		std::vector<uint32_t> m_Order;
+		std::vector<Packet> m_Packets;
+		std::vector<InstanceData> m_Instances;
+		std::vector<DrawCall> m_DrawCalls;
+		RhiGpuAddress m_InstancesAddress = 0;
+		RadixSorter m_Sorter;
+		bool m_IsEnabled = true;
+		Stats m_Stats;
+	};
+}
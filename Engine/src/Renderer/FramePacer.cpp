@@ -0,0 +1,45 @@
+#include "FramePacer.h"
+
+#include <algorithm>
+
+namespace Engine
+{
+	FramePacer::FramePacer(RhiDevice& pDevice, const uint32_t pFrameCount)
+		: m_Fence(pDevice.CreateFence(0)), m_FrameFences(pFrameCount, 0)
+	{
+	}
+
+	FramePacer::~FramePacer()
+	{
+		WaitIdle();
+	}
+
+	void FramePacer::BeginFrame()
+	{
+		const uint64_t completed = m_Fence->GetCompletedValue();
+		m_Stats.FramesInFlight = static_cast<uint32_t>(m_LastSignaledValue - completed);
+		m_Stats.MaxFramesInFlight = (std::max)(m_Stats.MaxFramesInFlight, m_Stats.FramesInFlight);
+		++m_Stats.FrameCount;
+
+		// Only blocks when the GPU is N frames behind, ie. still on the frame that last used this slot.
+		const uint64_t frameFence = m_FrameFences[m_FrameIndex];
+		if (completed < frameFence)
+		{
+			++m_Stats.WaitCount;
+			m_Fence->Wait(frameFence);
+		}
+	}
+
+	void FramePacer::EndFrame(RhiCommandQueue& pQueue)
+	{
+		m_FrameFences[m_FrameIndex] = ++m_LastSignaledValue;
+		pQueue.Signal(*m_Fence, m_LastSignaledValue);
+		m_FrameIndex = (m_FrameIndex + 1) % GetFrameCount();
+	}
+
+	void FramePacer::WaitIdle()
+	{
+		if (m_Fence->GetCompletedValue() < m_LastSignaledValue)
+			m_Fence->Wait(m_LastSignaledValue);
+	}
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <memory>
+#include <vector>
+
+#include "RHI/RhiDevice.h"
+
+namespace Engine
+{
+	/// <summary>
+	/// Cycles through N frames of per-frame resources. The CPU records frame i while the GPU still runs up to
+	/// N-1 previous frames, and only waits when it is about to reuse the resources of a frame the GPU has not
+	/// finished yet.
+	/// </summary>
+	class FramePacer
+	{
+	public:
+		struct Stats
+		{
+			uint64_t FrameCount = 0;
+			// Frames whose BeginFrame() had to wait for the GPU.
+			uint64_t WaitCount = 0;
+			// Frames submitted but not completed yet, seen at the last BeginFrame(), and the most seen so far.
+			uint32_t FramesInFlight = 0;
+			uint32_t MaxFramesInFlight = 0;
+		};
+
+		FramePacer(RhiDevice& pDevice, uint32_t pFrameCount);
+		~FramePacer();
+
+		FramePacer(const FramePacer&) = delete;
+		FramePacer& operator=(const FramePacer&) = delete;
+
+		/// <summary>
+		/// Waits until the GPU is done with the frame about to be reused. Everything the CPU writes for this
+		/// frame must go to the resources of GetFrameIndex().
+		/// </summary>
+		void BeginFrame();
+
+		/// <summary>
+		/// Signals the end of the frame's commands on pQueue and moves to the next frame.
+		/// </summary>
+		void EndFrame(RhiCommandQueue& pQueue);
+
+		/// <summary>
+		/// Waits for every submitted frame, ex. before resizing or destroying resources they use.
+		/// </summary>
+		void WaitIdle();
+
+		/// <returns> Index of the per-frame resources of the frame being recorded, in [0, GetFrameCount()). </returns>
+		[[nodiscard]] uint32_t GetFrameIndex() const { return m_FrameIndex; }
+		[[nodiscard]] uint32_t GetFrameCount() const { return static_cast<uint32_t>(m_FrameFences.size()); }
+		[[nodiscard]] const Stats& GetStats() const { return m_Stats; }
+
+	private:
+		std::unique_ptr<RhiFence> m_Fence;
+		// Fence value signaled at the end of the last frame that used each slot, 0 if none did.
+		std::vector<uint64_t> m_FrameFences;
+		uint64_t m_LastSignaledValue = 0;
+		uint32_t m_FrameIndex = 0;
+		Stats m_Stats;
+	};
+}
@@ -0,0 +1,144 @@
+#include "GpuMaterialTable.h"
+
+#include <algorithm>
+#include <bit>
+
+#include "UploadRing.h"
+#include "Materials/DirectXMaterial.h"
+
+namespace Engine
+{
+	GpuMaterialTable::GpuMaterialTable(RhiDevice& pDevice, const uint32_t pFrameCount, const uint32_t pInitialCapacity)
+		: m_Device(pDevice), m_FrameCount(pFrameCount)
+	{
+		m_Capacity = (std::max)(pInitialCapacity, 1u);
+		m_Buffer = m_Device.CreateBuffer({static_cast<uint64_t>(m_Capacity) * sizeof(GpuMaterialData), RhiHeapType::Default});
+		m_Stats.CapacityBytes = m_Buffer->GetDesc().Size;
+	}
+
+	uint32_t GpuMaterialTable::Register(const DirectXMaterial* pMaterial)
+	{
+		uint32_t id;
+		if (!m_FreeIds.empty())
+		{
+			id = m_FreeIds.back();
+			m_FreeIds.pop_back();
+			m_Materials[id] = pMaterial;
+		}
+		else
+		{
+			id = static_cast<uint32_t>(m_Materials.size());
+			m_Materials.push_back(pMaterial);
+			m_Changed.resize((m_Materials.size() + 63) / 64, 0);
+		}
+
+		MarkChanged(id);
+		++m_Stats.MaterialCount;
+		return id;
+	}
+
+	void GpuMaterialTable::Unregister(const uint32_t pId)
+	{
+		if (pId >= m_Materials.size() || !m_Materials[pId])
+			return;
+
+		// The record stays in the table until the id is reused, nothing draws with it anymore.
+		m_Materials[pId] = nullptr;
+		m_FreeIds.push_back(pId);
+		--m_Stats.MaterialCount;
+	}
+
+	void GpuMaterialTable::Update(RhiCommandList& pCommandList, UploadRing& pUploadRing)
+	{
+		++m_UpdateCount;
+		std::erase_if(m_RetiredBuffers, [this](const auto& pRetired)
+		{
+			return m_UpdateCount - pRetired.first > m_FrameCount;
+		});
+
+		if (m_Materials.size() > m_Capacity)
+			Grow(pCommandList, (std::max)(static_cast<uint32_t>(m_Materials.size()), m_Capacity * 2));
+
+		m_Stats.UpdatedMaterials = 0;
+		m_Stats.RangeCount = 0;
+		m_Stats.UploadedBytes = 0;
+
+		// Same gathering as the object table : changed ids in increasing order, close enough ones are merged.
+		const uint32_t materialCount = static_cast<uint32_t>(m_Materials.size());
+		uint32_t rangeFirst = k_InvalidId;
+		uint32_t rangeLast = 0;
+		for (uint32_t word = 0; word < m_Changed.size(); ++word)
+		{
+			uint64_t bits = m_Changed[word];
+			m_Changed[word] = 0;
+			while (bits)
+			{
+				const uint32_t id = word * 64 + static_cast<uint32_t>(std::countr_zero(bits));
+				bits &= bits - 1;
+				if (id >= materialCount)
+					break;
+
+				if (rangeFirst == k_InvalidId)
+					rangeFirst = id;
+				else if (id - rangeLast > k_MergeGap + 1)
+				{
+					UploadRange(pCommandList, pUploadRing, rangeFirst, rangeLast - rangeFirst + 1);
+					rangeFirst = id;
+				}
+				rangeLast = id;
+			}
+		}
+		if (rangeFirst != k_InvalidId)
+			UploadRange(pCommandList, pUploadRing, rangeFirst, rangeLast - rangeFirst + 1);
+
+		if (m_BufferState != RhiResourceState::ShaderResource)
+		{
+			pCommandList.Barrier(*m_Buffer, m_BufferState, RhiResourceState::ShaderResource);
+			m_BufferState = RhiResourceState::ShaderResource;
+		}
+	}
+
+	void GpuMaterialTable::Grow(RhiCommandList& pCommandList, const uint32_t pCapacity)
+	{
+		std::unique_ptr<RhiBuffer> buffer = m_Device.CreateBuffer(
+			{static_cast<uint64_t>(pCapacity) * sizeof(GpuMaterialData), RhiHeapType::Default});
+
+		pCommandList.Barrier(*m_Buffer, m_BufferState, RhiResourceState::CopySource);
+		pCommandList.Barrier(*buffer, RhiResourceState::Common, RhiResourceState::CopyDest);
+		pCommandList.CopyBufferRegion(*buffer, 0, *m_Buffer, 0, m_Buffer->GetDesc().Size);
+
+		m_RetiredBuffers.emplace_back(m_UpdateCount, std::move(m_Buffer));
+		m_Buffer = std::move(buffer);
+		m_BufferState = RhiResourceState::CopyDest;
+		m_Capacity = pCapacity;
+		m_Stats.CapacityBytes = m_Buffer->GetDesc().Size;
+	}
+
+	void GpuMaterialTable::UploadRange(RhiCommandList& pCommandList, UploadRing& pUploadRing, const uint32_t pFirst,
+	                                   const uint32_t pCount)
+	{
+		m_Staging.resize(pCount);
+		for (uint32_t i = 0; i < pCount; ++i)
+		{
+			m_Staging[i] = GpuMaterialData();
+			if (const DirectXMaterial* material = m_Materials[pFirst + i])
+				material->WriteMaterialData(m_Staging[i]);
+		}
+
+		const uint64_t size = static_cast<uint64_t>(pCount) * sizeof(GpuMaterialData);
+		const UploadAllocation allocation = pUploadRing.Allocate(size);
+		m_Device.WriteBuffer(*allocation.Buffer, allocation.Offset, m_Staging.data(), size);
+
+		if (m_BufferState != RhiResourceState::CopyDest)
+		{
+			pCommandList.Barrier(*m_Buffer, m_BufferState, RhiResourceState::CopyDest);
+			m_BufferState = RhiResourceState::CopyDest;
+		}
+		pCommandList.CopyBufferRegion(*m_Buffer, static_cast<uint64_t>(pFirst) * sizeof(GpuMaterialData),
+		                              *allocation.Buffer, allocation.Offset, size);
+
+		m_Stats.UpdatedMaterials += pCount;
+		++m_Stats.RangeCount;
+		m_Stats.UploadedBytes += size;
+	}
+}
@@ -0,0 +1,107 @@
+#pragma once
+#include <memory>
+#include <vector>
+
+#include <DirectXMath.h>
+
+#include "RHI/RhiDevice.h"
+
+namespace Engine
+{
+	class DirectXMaterial;
+	class UploadRing;
+
+	/// <summary>
+	/// Element of the material table, read by the shaders as
+	/// StructuredBuffer&lt;MaterialData&gt; gMaterials : register(t2, space1).
+	/// </summary>
+	struct GpuMaterialData
+	{
+		static constexpr uint32_t k_NoTexture = UINT32_MAX;
+
+		// Parameters laid out by the material (see DirectXMaterial::WriteMaterialData).
+		DirectX::XMFLOAT4 Parameters[3] = {};
+		// Index of the texture in the shader visible heap, the shaders read it from an unbounded table.
+		uint32_t TextureIndex = k_NoTexture;
+		uint32_t Padding[3] = {};
+	};
+
+	/// <summary>
+	/// Every material's parameters and texture, kept on the GPU in one buffer indexed by material id. Draws only
+	/// pass the id, so changing material inside an instanced draw costs nothing and materials with different
+	/// textures share draws. Materials mark themselves changed and Update() uploads the changed records,
+	/// coalesced in a few copies.
+	/// Not thread safe, materials are created and modified from the main thread.
+	/// </summary>
+	class GpuMaterialTable
+	{
+	public:
+		struct Stats
+		{
+			uint32_t MaterialCount = 0;
+			// Materials uploaded by the last Update(), clean materials merged into a range included.
+			uint32_t UpdatedMaterials = 0;
+			uint32_t RangeCount = 0;
+			uint64_t UploadedBytes = 0;
+			// Size of the GPU table.
+			uint64_t CapacityBytes = 0;
+		};
+
+		static constexpr uint32_t k_InvalidId = UINT32_MAX;
+		// Runs of clean materials up to this long are uploaded along with their neighbours.
+		static constexpr uint32_t k_MergeGap = 8;
+
+		/// <param name="pDevice"></param>
+		/// <param name="pFrameCount"> : frames in flight, a table that grew is only released after them</param>
+		/// <param name="pInitialCapacity"> : materials, the table doubles when it is full</param>
+		GpuMaterialTable(RhiDevice& pDevice, uint32_t pFrameCount, uint32_t pInitialCapacity = 256);
+
+		GpuMaterialTable(const GpuMaterialTable&) = delete;
+		GpuMaterialTable& operator=(const GpuMaterialTable&) = delete;
+
+		/// <summary>
+		/// Adds pMaterial to the table, its record is written on the next Update().
+		/// </summary>
+		/// <returns> The material id, stable for the lifetime of the registration. </returns>
+		uint32_t Register(const DirectXMaterial* pMaterial);
+		void Unregister(uint32_t pId);
+
+		/// <summary>
+		/// Rewrites the material's record on the next Update().
+		/// </summary>
+		void MarkChanged(uint32_t pId) { m_Changed[pId >> 6] |= 1ull << (pId & 63); }
+
+		/// <summary>
+		/// Records the upload of the materials that changed since the last call. Call it once per frame, before
+		/// the draws and after UploadRing::BeginFrame().
+		/// </summary>
+		void Update(RhiCommandList& pCommandList, UploadRing& pUploadRing);
+
+		/// <returns> The address of the table, to bind as a root shader resource. </returns>
+		[[nodiscard]] RhiGpuAddress GetGpuAddress() const { return m_Buffer->GetGpuAddress(); }
+		[[nodiscard]] const Stats& GetStats() const { return m_Stats; }
+
+	private:
+		void Grow(RhiCommandList& pCommandList, uint32_t pCapacity);
+		void UploadRange(RhiCommandList& pCommandList, UploadRing& pUploadRing, uint32_t pFirst, uint32_t pCount);
+
+		RhiDevice& m_Device;
+		uint32_t m_FrameCount;
+
+		// Indexed by id, nullptr for the free ids.
+		std::vector<const DirectXMaterial*> m_Materials;
+		std::vector<uint32_t> m_FreeIds;
+		// One bit per id.
+		std::vector<uint64_t> m_Changed;
+		std::vector<GpuMaterialData> m_Staging;
+
+		std::unique_ptr<RhiBuffer> m_Buffer;
+		RhiResourceState m_BufferState = RhiResourceState::Common;
+		uint32_t m_Capacity = 0;
+		// Tables replaced by a bigger one, with the update they were replaced on. Frames in flight may still read them.
+		std::vector<std::pair<uint64_t, std::unique_ptr<RhiBuffer>>> m_RetiredBuffers;
+		uint64_t m_UpdateCount = 0;
+
+		Stats m_Stats;
+	};
+}
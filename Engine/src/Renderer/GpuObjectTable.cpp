@@ -0,0 +1,178 @@
+#include "GpuObjectTable.h"
+
+#include <algorithm>
+#include <bit>
+
+#include "UploadRing.h"
+
+namespace Engine
+{
+	GpuObjectTable::GpuObjectTable(RhiDevice& pDevice, const uint32_t pFrameCount, const uint32_t pInitialCapacity)
+		: m_Device(pDevice), m_FrameCount(pFrameCount)
+	{
+		m_Capacity = (std::max)(pInitialCapacity, 1u);
+		m_Buffer = m_Device.CreateBuffer({static_cast<uint64_t>(m_Capacity) * sizeof(GpuObjectData), RhiHeapType::Default});
+		m_Stats.CapacityBytes = m_Buffer->GetDesc().Size;
+	}
+
+	GpuObjectTable::~GpuObjectTable()
+	{
+		for (Transform* transform : m_Transforms)
+		{
+			if (transform)
+				transform->SetListener(nullptr, 0);
+		}
+	}
+
+	uint32_t GpuObjectTable::Register(Transform* pTransform)
+	{
+		uint32_t id;
+		if (!m_FreeIds.empty())
+		{
+			id = m_FreeIds.back();
+			m_FreeIds.pop_back();
+			m_Transforms[id] = pTransform;
+		}
+		else
+		{
+			id = static_cast<uint32_t>(m_Transforms.size());
+			m_Transforms.push_back(pTransform);
+			m_Changed.resize((m_Transforms.size() + 63) / 64, 0);
+		}
+
+		pTransform->SetListener(this, id);
+		MarkChanged(id);
+		++m_Stats.ObjectCount;
+		return id;
+	}
+
+	void GpuObjectTable::Unregister(const uint32_t pId)
+	{
+		if (pId >= m_Transforms.size() || !m_Transforms[pId])
+			return;
+
+		// The element stays in the table until the id is reused, nothing draws it anymore.
+		m_Transforms[pId]->SetListener(nullptr, 0);
+		m_Transforms[pId] = nullptr;
+		m_FreeIds.push_back(pId);
+		--m_Stats.ObjectCount;
+	}
+
+	void GpuObjectTable::OnTransformChanged(const uint32_t pId)
+	{
+		MarkChanged(pId);
+	}
+
+	void GpuObjectTable::Update(RhiCommandList& pCommandList, UploadRing& pUploadRing, const WorldPosition& pCamera)
+	{
+		++m_UpdateCount;
+		std::erase_if(m_RetiredBuffers, [this](const auto& pRetired)
+		{
+			return m_UpdateCount - pRetired.first > m_FrameCount;
+		});
+
+		const double dx = pCamera.x - m_Origin.x;
+		const double dy = pCamera.y - m_Origin.y;
+		const double dz = pCamera.z - m_Origin.z;
+		if (!m_HasOrigin || dx * dx + dy * dy + dz * dz > k_RebaseDistance * k_RebaseDistance)
+		{
+			m_Origin = pCamera;
+			m_HasOrigin = true;
+			MarkAllChanged();
+		}
+
+		if (m_Transforms.size() > m_Capacity)
+			Grow(pCommandList, (std::max)(static_cast<uint32_t>(m_Transforms.size()), m_Capacity * 2));
+
+		m_Stats.UpdatedObjects = 0;
+		m_Stats.RangeCount = 0;
+		m_Stats.UploadedBytes = 0;
+
+		// Changed ids are gathered in increasing order, ranges are closed when the next change is too far.
+		const uint32_t objectCount = static_cast<uint32_t>(m_Transforms.size());
+		uint32_t rangeFirst = k_InvalidId;
+		uint32_t rangeLast = 0;
+		for (uint32_t word = 0; word < m_Changed.size(); ++word)
+		{
+			uint64_t bits = m_Changed[word];
+			m_Changed[word] = 0;
+			while (bits)
+			{
+				const uint32_t id = word * 64 + static_cast<uint32_t>(std::countr_zero(bits));
+				bits &= bits - 1;
+				if (id >= objectCount)
+					break;
+
+				if (rangeFirst == k_InvalidId)
+					rangeFirst = id;
+				else if (id - rangeLast > k_MergeGap + 1)
+				{
+					UploadRange(pCommandList, pUploadRing, rangeFirst, rangeLast - rangeFirst + 1);
+					rangeFirst = id;
+				}
+				rangeLast = id;
+			}
+		}
+		if (rangeFirst != k_InvalidId)
+			UploadRange(pCommandList, pUploadRing, rangeFirst, rangeLast - rangeFirst + 1);
+
+		if (m_BufferState != RhiResourceState::ShaderResource)
+		{
+			pCommandList.Barrier(*m_Buffer, m_BufferState, RhiResourceState::ShaderResource);
+			m_BufferState = RhiResourceState::ShaderResource;
+		}
+	}
+
+	void GpuObjectTable::MarkAllChanged()
+	{
+		std::fill(m_Changed.begin(), m_Changed.end(), ~0ull);
+	}
+
+	void GpuObjectTable::Grow(RhiCommandList& pCommandList, const uint32_t pCapacity)
+	{
+		std::unique_ptr<RhiBuffer> buffer = m_Device.CreateBuffer(
+			{static_cast<uint64_t>(pCapacity) * sizeof(GpuObjectData), RhiHeapType::Default});
+
+		// The current elements are copied on the GPU, only the changes are uploaded afterward.
+		pCommandList.Barrier(*m_Buffer, m_BufferState, RhiResourceState::CopySource);
+		pCommandList.Barrier(*buffer, RhiResourceState::Common, RhiResourceState::CopyDest);
+		pCommandList.CopyBufferRegion(*buffer, 0, *m_Buffer, 0, m_Buffer->GetDesc().Size);
+
+		m_RetiredBuffers.emplace_back(m_UpdateCount, std::move(m_Buffer));
+		m_Buffer = std::move(buffer);
+		m_BufferState = RhiResourceState::CopyDest;
+		m_Capacity = pCapacity;
+		m_Stats.CapacityBytes = m_Buffer->GetDesc().Size;
+	}
+
+	void GpuObjectTable::UploadRange(RhiCommandList& pCommandList, UploadRing& pUploadRing, const uint32_t pFirst,
+	                                 const uint32_t pCount)
+	{
+		m_Staging.resize(pCount);
+		for (uint32_t i = 0; i < pCount; ++i)
+		{
+			const Transform* transform = m_Transforms[pFirst + i];
+			if (transform)
+				DirectX::XMStoreFloat4x4(&m_Staging[i].World,
+				                         DirectX::XMMatrixTranspose(transform->GetWorldRelativeTo(m_Origin)));
+			else
+				DirectX::XMStoreFloat4x4(&m_Staging[i].World, DirectX::XMMatrixIdentity());
+		}
+
+		const uint64_t size = static_cast<uint64_t>(pCount) * sizeof(GpuObjectData);
+		const UploadAllocation allocation = pUploadRing.Allocate(size);
+		m_Device.WriteBuffer(*allocation.Buffer, allocation.Offset, m_Staging.data(), size);
+
+		if (m_BufferState != RhiResourceState::CopyDest)
+		{
+			pCommandList.Barrier(*m_Buffer, m_BufferState, RhiResourceState::CopyDest);
+			m_BufferState = RhiResourceState::CopyDest;
+		}
+		pCommandList.CopyBufferRegion(*m_Buffer, static_cast<uint64_t>(pFirst) * sizeof(GpuObjectData),
+		                              *allocation.Buffer, allocation.Offset, size);
+
+		m_Stats.UpdatedObjects += pCount;
+		++m_Stats.RangeCount;
+		m_Stats.UploadedBytes += size;
+	}
+}
@@ -0,0 +1,113 @@
+#pragma once
+#include <memory>
+#include <vector>
+
+#include "Core/Transform.h"
+#include "RHI/RhiDevice.h"
+
+namespace Engine
+{
+	class UploadRing;
+
+	/// <summary>
+	/// Element of the object table, read by the shaders as StructuredBuffer&lt;ObjectData&gt; gObjects : register(t0, space1).
+	/// </summary>
+	struct GpuObjectData
+	{
+		// Transposed, relative to GpuObjectTable::GetOrigin().
+		DirectX::XMFLOAT4X4 World;
+	};
+
+	/// <summary>
+	/// Per object data kept on the GPU from one frame to the next, instead of being pushed again for every draw.
+	/// Every registered Transform gets a stable id, the index of its element in the table. Transforms report their
+	/// changes, and Update() only uploads the elements that changed since the previous frame, coalesced in a few
+	/// copies. Draws then only pass their object id, as a root constant.
+	/// Matrices are stored relative to an origin that follows the camera (see k_RebaseDistance), so they keep
+	/// their precision far from the world origin without being rebuilt each time the camera moves.
+	/// Not thread safe, objects are registered and moved from the main thread.
+	/// </summary>
+	class GpuObjectTable : public TransformListener
+	{
+	public:
+		struct Stats
+		{
+			uint32_t ObjectCount = 0;
+			// Objects uploaded by the last Update(), clean objects merged into a range included.
+			uint32_t UpdatedObjects = 0;
+			uint32_t RangeCount = 0;
+			uint64_t UploadedBytes = 0;
+			// Size of the GPU table.
+			uint64_t CapacityBytes = 0;
+		};
+
+		static constexpr uint32_t k_InvalidId = UINT32_MAX;
+		// Runs of clean objects up to this long are uploaded along with their neighbours, one copy costs more
+		// than a few extra bytes.
+		static constexpr uint32_t k_MergeGap = 8;
+		// Distance the camera can move away from the table's origin before every matrix is rebuilt around it.
+		static constexpr double k_RebaseDistance = 4096.0;
+
+		/// <param name="pDevice"></param>
+		/// <param name="pFrameCount"> : frames in flight, a table that grew is only released after them</param>
+		/// <param name="pInitialCapacity"> : objects, the table doubles when it is full</param>
+		GpuObjectTable(RhiDevice& pDevice, uint32_t pFrameCount, uint32_t pInitialCapacity = 1024);
+		~GpuObjectTable() override;
+
+		GpuObjectTable(const GpuObjectTable&) = delete;
+		GpuObjectTable& operator=(const GpuObjectTable&) = delete;
+
+		/// <summary>
+		/// Adds pTransform to the table and listens to its changes until Unregister().
+		/// </summary>
+		/// <returns> The object id, stable for the lifetime of the registration. </returns>
+		uint32_t Register(Transform* pTransform);
+		void Unregister(uint32_t pId);
+
+		void OnTransformChanged(uint32_t pId) override;
+
+		/// <summary>
+		/// Records the upload of the objects that changed since the last call. Call it once per frame, before
+		/// the draws and after UploadRing::BeginFrame().
+		/// </summary>
+		/// <param name="pCommandList"></param>
+		/// <param name="pUploadRing"> : holds the new data until the copies are executed</param>
+		/// <param name="pCamera"> : the origin is moved on the camera when it is too far from it</param>
+		void Update(RhiCommandList& pCommandList, UploadRing& pUploadRing, const WorldPosition& pCamera);
+
+		/// <returns> The address of the table, to bind as a root shader resource. </returns>
+		[[nodiscard]] RhiGpuAddress GetGpuAddress() const { return m_Buffer->GetGpuAddress(); }
+		/// <returns> The table, replaced when it grows. </returns>
+		[[nodiscard]] const RhiBuffer& GetBuffer() const { return *m_Buffer; }
+		/// <returns> The position the matrices are relative to. </returns>
+		[[nodiscard]] const WorldPosition& GetOrigin() const { return m_Origin; }
+		[[nodiscard]] const Stats& GetStats() const { return m_Stats; }
+
+	private:
+		void MarkChanged(uint32_t pId) { m_Changed[pId >> 6] |= 1ull << (pId & 63); }
+		void MarkAllChanged();
+		void Grow(RhiCommandList& pCommandList, uint32_t pCapacity);
+		void UploadRange(RhiCommandList& pCommandList, UploadRing& pUploadRing, uint32_t pFirst, uint32_t pCount);
+
+		RhiDevice& m_Device;
+		uint32_t m_FrameCount;
+
+		// Indexed by id, nullptr for the free ids.
+		std::vector<Transform*> m_Transforms;
+		std::vector<uint32_t> m_FreeIds;
+		// One bit per id.
+		std::vector<uint64_t> m_Changed;
+		std::vector<GpuObjectData> m_Staging;
+
+		std::unique_ptr<RhiBuffer> m_Buffer;
+		RhiResourceState m_BufferState = RhiResourceState::Common;
+		uint32_t m_Capacity = 0;
+		// Tables replaced by a bigger one, with the update they were replaced on. Frames in flight may still read them.
+		std::vector<std::pair<uint64_t, std::unique_ptr<RhiBuffer>>> m_RetiredBuffers;
+		uint64_t m_UpdateCount = 0;
+
+		WorldPosition m_Origin;
+		bool m_HasOrigin = false;
+		Stats m_Stats;
+	};
+}
@@ -1,44 +1,41 @@
 #include "DirectXLitMaterial.h"
 
-#include "Renderer/Shaders/DirectXShader.h"
+#include <cstring>
+
+#include "Renderer/Shaders/DirectXLitShader.h"
 #include "Renderer/DirectXContext.h"
-#include "Renderer/Resource/DirectXResourceManager.h"
-#include "Renderer/DirectXCommandObject.h"
+#include "Renderer/GpuMaterialTable.h"
 
 namespace Engine
 {
 	DirectXLitMaterial::DirectXLitMaterial(DirectXLitShader* shader)
-		: DirectXMaterial((DirectXShader*)shader), m_Data(), m_Texture(nullptr)
+		: DirectXMaterial((DirectXShader*)shader), m_Data{{1.f, 1.f, 1.f, 1.f}, {0.1f, 0.1f, 0.1f, 1.f}, 0.5f, 0.04f, {1, 1}},
+		  m_Texture(nullptr)
 	{
-		m_MatCB = std::make_unique<UploadBuffer<LitMaterialConstants>>(DirectXContext::Get()->m_Device.Get(), 1, true);
 	}
 
 	DirectXLitMaterial::DirectXLitMaterial(DirectXLitShader* shader, DirectX::XMFLOAT4 albedo,
 	                                       DirectX::XMFLOAT4 specular, float smoothness, float fresnel, Texture* texture, DirectX::XMFLOAT2 tiling)
-		: DirectXMaterial((DirectXShader*)shader), m_Data(albedo, specular, smoothness, fresnel, tiling), m_Texture(texture)
+		: DirectXMaterial((DirectXShader*)shader), m_Data{albedo, specular, smoothness, fresnel, tiling}, m_Texture(texture)
 	{
-		m_MatCB = std::make_unique<UploadBuffer<LitMaterialConstants>>(DirectXContext::Get()->m_Device.Get(), 1, true);
 	}
 
 	void DirectXLitMaterial::SetTexture(Texture* texture)
 	{
 		m_Texture = texture;
+		MarkChanged();
 	}
 
-	void DirectXLitMaterial::Bind(const UploadBuffer<ObjectConstants>& objectConstantBuffer)
+	void DirectXLitMaterial::WriteMaterialData(GpuMaterialData& pData) const
 	{
-		if (m_IsDirty)
-		{
-			m_MatCB->CopyData(0, m_Data);
-			m_IsDirty = false;
-		}
-
-		m_Shader->Bind(objectConstantBuffer);
+		static_assert(sizeof(LitMaterialConstants) <= sizeof(pData.Parameters));
+		std::memcpy(pData.Parameters, &m_Data, sizeof(LitMaterialConstants));
+		if (m_Texture)
+			pData.TextureIndex = static_cast<uint32_t>(m_Texture->HeapIndex);
+	}
 
-		DirectXContext::Get()->m_CommandObject->GetCommandList()->SetGraphicsRootConstantBufferView(
-			2, m_MatCB->Resource()->GetGPUVirtualAddress());
-		if (m_Texture != nullptr)
-			DirectXContext::Get()->m_CommandObject->GetCommandList()->SetGraphicsRootDescriptorTable(
-				3, DirectXContext::Get()->m_ResourceManager->GetTextureHandle(m_Texture));
+	ShaderVariantKey DirectXLitMaterial::GetVariantKey() const
+	{
+		return m_Shader->GetPermutations().Select(0, DirectXLitShader::k_TextureFeature, m_Texture ? 1 : 0);
 	}
 }
@@ -1,11 +1,41 @@
 #include "DirectXMaterial.h"
 
+#include "Renderer/GpuMaterialTable.h"
 #include "Renderer/Shaders/DirectXShader.h"
 
 namespace Engine
 {
 	DirectXMaterial::DirectXMaterial(DirectXShader* shader)
-		: m_Shader(shader), m_IsDirty(true)
+		: m_Shader(shader)
 	{
+		m_MaterialId = DirectXContext::Get()->GetMaterialTable()->Register(this);
+	}
+
+	DirectXMaterial::~DirectXMaterial()
+	{
+		if (GpuMaterialTable* materialTable = DirectXContext::Get()->GetMaterialTable())
+			materialTable->Unregister(m_MaterialId);
+	}
+
+	void DirectXMaterial::Bind(RhiCommandList& pCommandList, const ShaderVariantKey pVariant,
+	                           const RhiGpuAddress pInstances, const uint32_t pFirstInstance) const
+	{
+		m_Shader->Bind(pCommandList, pVariant, pInstances, pFirstInstance);
+	}
+
+	ShaderVariantKey DirectXMaterial::SelectVariant() const
+	{
+		return m_Shader->SelectVariant(*this);
+	}
+
+	uint32_t DirectXMaterial::GetShaderSortId() const
+	{
+		return m_Shader->GetSortId();
+	}
+
+	void DirectXMaterial::MarkChanged() const
+	{
+		if (GpuMaterialTable* materialTable = DirectXContext::Get()->GetMaterialTable())
+			materialTable->MarkChanged(m_MaterialId);
 	}
 }
@@ -1,21 +1,64 @@
 #pragma once
 
 #include "Core/MeshRenderer.h"
+#include "Renderer/DirectXContext.h"
+#include "Renderer/DrawQueue.h"
+#include "Renderer/RHI/RhiDevice.h"
+#include "Renderer/Shaders/ShaderPermutations.h"
 
 namespace Engine
 {
 	class DirectXShader;
 	class DirectXMesh;
+	struct GpuMaterialData;
 
-	class DirectXMaterial
+	/// <summary>
+	/// Parameters of a shader, stored in the GpuMaterialTable for the lifetime of the material.
+	/// </summary>
+	class DirectXMaterial : public DrawQueueMaterial
 	{
 	public:
 		DirectXMaterial(DirectXShader* shader);
+		virtual ~DirectXMaterial();
 
-		virtual void Bind(const UploadBuffer<ObjectConstants>& objectConstantBuffer) = 0;
+		DirectXMaterial(const DirectXMaterial&) = delete;
+		DirectXMaterial& operator=(const DirectXMaterial&) = delete;
+
+		/// <summary>
+		/// Binds the shader and the state shared by the instances of a draw. The material's own data is read
+		/// from the material table through the instances' material id.
+		/// </summary>
+		/// <param name="pCommandList"></param>
+		/// <param name="pVariant"> : the shader variant DirectXShader::SelectVariant() picked for this material</param>
+		/// <param name="pInstances"> : this frame's InstanceData buffer</param>
+		/// <param name="pFirstInstance"> : the draw's first element in pInstances</param>
+		void Bind(RhiCommandList& pCommandList, ShaderVariantKey pVariant, RhiGpuAddress pInstances,
+		          uint32_t pFirstInstance) const override;
+		ShaderVariantKey SelectVariant() const override;
+		uint32_t GetShaderSortId() const override;
+
+		/// <returns> The cheapest variant of the shader the material can be drawn with, the features that depend
+		/// on the frame left at their first value. Materials of different variants do not share draws. </returns>
+		virtual ShaderVariantKey GetVariantKey() const { return 0; }
+
+		/// <summary>
+		/// Writes the material's record of the material table.
+		/// </summary>
+		virtual void WriteMaterialData(GpuMaterialData& pData) const {}
+
+		DirectXShader* GetShader() const { return m_Shader; }
+		/// <returns> The index of the material's record in the material table. </returns>
+		uint32_t GetMaterialId() const override { return m_MaterialId; }
 
 	protected:
+		/// <summary>
+		/// Uploads the material's record again on the next frame, call it when a parameter changes.
+		/// </summary>
+		void MarkChanged() const;
+
 		DirectXShader* m_Shader;
-		bool m_IsDirty;
+
+	private:
+		uint32_t m_MaterialId;
 	};
 }
@@ -2,7 +2,6 @@
 
 #include "Renderer/Shaders/DirectXShader.h"
 #include "Renderer/DirectXContext.h"
-#include "Renderer/Resource/DirectXResourceManager.h"
 
 namespace Engine
 {
@@ -10,9 +9,4 @@ namespace Engine
 		: DirectXMaterial((DirectXShader*)shader)
 	{
 	}
-
-	void DirectXSimpleMaterial::Bind(const UploadBuffer<ObjectConstants>& objectConstantBuffer)
-	{
-		m_Shader->Bind(objectConstantBuffer);
-	}
 }
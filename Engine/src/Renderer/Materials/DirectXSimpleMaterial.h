@@ -11,7 +11,5 @@ namespace Engine
 	{
 	public:
 		DirectXSimpleMaterial(DirectXSimpleShader* shader);
-
-		void Bind(const UploadBuffer<ObjectConstants>& objectConstantBuffer) override;
 	};
 }
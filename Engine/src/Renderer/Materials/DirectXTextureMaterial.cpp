@@ -2,13 +2,12 @@
 
 #include "Renderer/Shaders/DirectXShader.h"
 #include "Renderer/DirectXContext.h"
-#include "Renderer/Resource/DirectXResourceManager.h"
-#include "Renderer/DirectXCommandObject.h"
+#include "Renderer/GpuMaterialTable.h"
 
 namespace Engine
 {
 	Engine::DirectXTextureMaterial::DirectXTextureMaterial(DirectXTextureShader* shader)
-		: DirectXMaterial((DirectXShader*)shader)
+		: DirectXMaterial((DirectXShader*)shader), m_Texture(nullptr)
 	{
 	}
 
@@ -17,9 +16,9 @@ namespace Engine
 	{
 	}
 
-	void Engine::DirectXTextureMaterial::Bind(const UploadBuffer<ObjectConstants>& objectConstantBuffer)
+	void Engine::DirectXTextureMaterial::WriteMaterialData(GpuMaterialData& pData) const
 	{
-		m_Shader->Bind(objectConstantBuffer);
-		DirectXContext::Get()->m_CommandObject->GetCommandList()->SetGraphicsRootDescriptorTable(0, DirectXContext::Get()->m_ResourceManager->GetTextureHandle(m_Texture));
+		if (m_Texture != nullptr)
+			pData.TextureIndex = static_cast<uint32_t>(m_Texture->HeapIndex);
 	}
 }
@@ -14,7 +14,7 @@ namespace Engine
 		DirectXTextureMaterial(DirectXTextureShader* shader);
 		DirectXTextureMaterial(DirectXTextureShader* shader, Texture* texture);
 
-		void Bind(const UploadBuffer<ObjectConstants>& objectConstantBuffer) override;
+		void WriteMaterialData(GpuMaterialData& pData) const override;
 
 	protected:
 		Texture* m_Texture;
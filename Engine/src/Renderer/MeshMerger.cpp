@@ -0,0 +1,89 @@
+#include "MeshMerger.h"
+
+#include <cstring>
+
+#include "Core/JobSystem.h"
+
+namespace Engine
+{
+	namespace
+	{
+		template <typename TIndex>
+		void AppendIndices(const MergeSource& pSource, const uint32_t pBaseVertex, const bool pIsMirrored,
+		                   std::vector<TIndex>& pOut)
+		{
+			for (uint32_t i = 0; i + 2 < pSource.IndexCount; i += 3)
+			{
+				pOut.push_back(static_cast<TIndex>(pBaseVertex + pSource.Indices[i]));
+				pOut.push_back(static_cast<TIndex>(pBaseVertex + pSource.Indices[i + (pIsMirrored ? 2 : 1)]));
+				pOut.push_back(static_cast<TIndex>(pBaseVertex + pSource.Indices[i + (pIsMirrored ? 1 : 2)]));
+			}
+		}
+	}
+
+	void MeshMerger::Merge(const MergeSource* pSources, const size_t pCount, const MergeVertexFormat& pFormat,
+	                       MergedMesh& pOut)
+	{
+		using namespace DirectX;
+
+		uint32_t vertexCount = 0;
+		uint32_t indexCount = 0;
+		for (size_t i = 0; i < pCount; ++i)
+		{
+			vertexCount += pSources[i].VertexCount;
+			indexCount += pSources[i].IndexCount;
+		}
+
+		pOut = {};
+		pOut.VertexCount = vertexCount;
+		pOut.Vertices.resize(static_cast<size_t>(vertexCount) * pFormat.Stride);
+		const bool is32Bits = vertexCount > k_Max16BitVertices;
+		if (is32Bits)
+			pOut.Indices32.reserve(indexCount);
+		else
+			pOut.Indices16.reserve(indexCount);
+
+		uint32_t baseVertex = 0;
+		for (size_t source = 0; source < pCount; ++source)
+		{
+			const MergeSource& mesh = pSources[source];
+			const XMMATRIX toMerged = XMLoadFloat4x4(&mesh.Transform);
+			// Normals go through the inverse transpose, so non uniform scales keep them perpendicular.
+			const XMMATRIX normalToMerged = XMMatrixTranspose(XMMatrixInverse(nullptr, toMerged));
+			// A mirroring transform turns the triangles inside out, their winding is flipped back.
+			const bool isMirrored = XMVectorGetX(XMMatrixDeterminant(toMerged)) < 0.f;
+
+			uint8_t* vertices = pOut.Vertices.data() + static_cast<size_t>(baseVertex) * pFormat.Stride;
+			std::memcpy(vertices, mesh.Vertices, static_cast<size_t>(mesh.VertexCount) * pFormat.Stride);
+			for (uint32_t i = 0; i < mesh.VertexCount; ++i)
+			{
+				uint8_t* vertex = vertices + static_cast<size_t>(i) * pFormat.Stride;
+				auto* position = reinterpret_cast<XMFLOAT3*>(vertex + pFormat.PositionOffset);
+				XMStoreFloat3(position, XMVector3TransformCoord(XMLoadFloat3(position), toMerged));
+				if (pFormat.NormalOffset != MergeVertexFormat::k_NoNormal)
+				{
+					auto* normal = reinterpret_cast<XMFLOAT3*>(vertex + pFormat.NormalOffset);
+					XMStoreFloat3(normal, XMVector3Normalize(XMVector3TransformNormal(XMLoadFloat3(normal), normalToMerged)));
+				}
+			}
+
+			if (is32Bits)
+				AppendIndices(mesh, baseVertex, isMirrored, pOut.Indices32);
+			else
+				AppendIndices(mesh, baseVertex, isMirrored, pOut.Indices16);
+			baseVertex += mesh.VertexCount;
+		}
+	}
+
+	void MeshMerger::MergeAll(const std::vector<std::vector<MergeSource>>& pMeshes, const MergeVertexFormat& pFormat,
+	                          std::vector<MergedMesh>& pOut)
+	{
+		pOut.resize(pMeshes.size());
+		JobSystem::ParallelFor(static_cast<uint32_t>(pMeshes.size()), 1,
+		                       [&](const uint32_t pFirst, const uint32_t pLast, uint32_t)
+		                       {
+			                       for (uint32_t i = pFirst; i < pLast; ++i)
+				                       Merge(pMeshes[i].data(), pMeshes[i].size(), pFormat, pOut[i]);
+		                       });
+	}
+}
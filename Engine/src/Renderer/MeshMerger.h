@@ -0,0 +1,73 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <DirectXMath.h>
+
+namespace Engine
+{
+	/// <summary>
+	/// Where a vertex keeps what a transform changes, its other bytes are copied as they are.
+	/// </summary>
+	struct MergeVertexFormat
+	{
+		static constexpr uint32_t k_NoNormal = UINT32_MAX;
+
+		uint32_t Stride = 0;
+		// Of a float3.
+		uint32_t PositionOffset = 0;
+		// Of a float3, k_NoNormal when the vertices have none.
+		uint32_t NormalOffset = k_NoNormal;
+
+		template <typename T>
+		static MergeVertexFormat Of()
+		{
+			MergeVertexFormat format = {sizeof(T), offsetof(T, Position)};
+			if constexpr (requires { &T::Normal; })
+				format.NormalOffset = offsetof(T, Normal);
+			return format;
+		}
+	};
+
+	/// <summary>
+	/// An indexed triangle list to merge, and its transform to the merged mesh's space.
+	/// </summary>
+	struct MergeSource
+	{
+		const uint8_t* Vertices = nullptr;
+		uint32_t VertexCount = 0;
+		const uint32_t* Indices = nullptr;
+		uint32_t IndexCount = 0;
+		DirectX::XMFLOAT4X4 Transform;
+	};
+
+	struct MergedMesh
+	{
+		std::vector<uint8_t> Vertices;
+		uint32_t VertexCount = 0;
+		// Only one is filled : 16 bits indices up to MeshMerger::k_Max16BitVertices vertices, 32 bits above.
+		std::vector<uint16_t> Indices16;
+		std::vector<uint32_t> Indices32;
+	};
+
+	/// <summary>
+	/// Bakes the transforms of meshes into one vertex and one index buffer, the sources one after the other in
+	/// the order they are given. Positions are transformed as points, normals by the inverse transpose and
+	/// normalized, and the triangles of mirroring transforms get their winding flipped back.
+	/// Platform neutral, the vertices are handled as bytes described by a MergeVertexFormat.
+	/// </summary>
+	class MeshMerger
+	{
+	public:
+		static constexpr uint32_t k_Max16BitVertices = 65536;
+
+		static void Merge(const MergeSource* pSources, size_t pCount, const MergeVertexFormat& pFormat,
+		                  MergedMesh& pOut);
+		/// <summary>
+		/// Merges each list of sources into its mesh, in parallel on the JobSystem. Each mesh is merged by one
+		/// thread, the result does not depend on the thread count.
+		/// </summary>
+		static void MergeAll(const std::vector<std::vector<MergeSource>>& pMeshes, const MergeVertexFormat& pFormat,
+		                     std::vector<MergedMesh>& pOut);
+	};
+}
@@ -0,0 +1,268 @@
+#include "MeshPool.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "UploadManager.h"
+
+namespace Engine
+{
+	namespace
+	{
+		// Ranges of a buffer copied to another, merged while they stay contiguous on both sides.
+		class CopyBatcher
+		{
+		public:
+			CopyBatcher(RhiCommandList& pCommandList, const RhiBuffer& pDestination, const RhiBuffer& pSource)
+				: m_CommandList(pCommandList), m_Destination(pDestination), m_Source(pSource)
+			{
+			}
+
+			void Add(const uint64_t pDestinationOffset, const uint64_t pSourceOffset, const uint64_t pSize)
+			{
+				if (m_Size > 0 && m_DestinationOffset + m_Size == pDestinationOffset &&
+					m_SourceOffset + m_Size == pSourceOffset)
+				{
+					m_Size += pSize;
+					return;
+				}
+				Flush();
+				m_DestinationOffset = pDestinationOffset;
+				m_SourceOffset = pSourceOffset;
+				m_Size = pSize;
+			}
+
+			/// <returns> The bytes copied so far. </returns>
+			uint64_t Flush()
+			{
+				if (m_Size > 0)
+					m_CommandList.CopyBufferRegion(m_Destination, m_DestinationOffset, m_Source, m_SourceOffset, m_Size);
+				m_CopiedBytes += m_Size;
+				m_Size = 0;
+				return m_CopiedBytes;
+			}
+
+		private:
+			RhiCommandList& m_CommandList;
+			const RhiBuffer& m_Destination;
+			const RhiBuffer& m_Source;
+			uint64_t m_DestinationOffset = 0;
+			uint64_t m_SourceOffset = 0;
+			uint64_t m_Size = 0;
+			uint64_t m_CopiedBytes = 0;
+		};
+
+		// Part of the allocator's capacity that is free but not in its largest block.
+		float GetWaste(const TlsfAllocator& pAllocator)
+		{
+			const TlsfAllocator::Stats stats = pAllocator.GetStats();
+			return static_cast<float>(stats.FreeBytes - stats.LargestFreeBlock) / static_cast<float>(stats.Capacity);
+		}
+	}
+
+	MeshPool::MeshPool(RhiDevice& pDevice, const uint32_t pVertexStride, const uint32_t pFrameCount,
+	                   const uint32_t pVertexCapacity, const uint32_t pIndexCapacity)
+		: m_Device(pDevice), m_VertexStride(pVertexStride), m_FrameCount(pFrameCount)
+	{
+		if (pVertexStride == 0)
+			throw std::invalid_argument("Mesh pool vertex stride must not be 0.");
+		CreateBuffers(pVertexCapacity, pIndexCapacity);
+	}
+
+	MeshPool::Handle MeshPool::Allocate(UploadManager& pUploads, const void* pVertices, const uint32_t pVertexCount,
+	                                    const uint16_t* pIndices, const uint32_t pIndexCount)
+	{
+		TlsfAllocation vertices;
+		TlsfAllocation indices;
+		if (!m_VertexAllocator->TryAllocate(pVertexCount, 1, vertices))
+		{
+			m_HasFailedAllocation = true;
+			++m_FailedAllocations;
+			return k_InvalidHandle;
+		}
+		if (!m_IndexAllocator->TryAllocate(pIndexCount, 1, indices))
+		{
+			m_VertexAllocator->Free(vertices);
+			m_HasFailedAllocation = true;
+			++m_FailedAllocations;
+			return k_InvalidHandle;
+		}
+
+		Handle handle;
+		if (!m_FreeHandles.empty())
+		{
+			handle = m_FreeHandles.back();
+			m_FreeHandles.pop_back();
+		}
+		else
+		{
+			handle = static_cast<Handle>(m_Entries.size());
+			m_Entries.emplace_back();
+		}
+		Entry& entry = m_Entries[handle];
+		entry.MeshRange = {
+			static_cast<int32_t>(vertices.Offset), pVertexCount, static_cast<uint32_t>(indices.Offset), pIndexCount
+		};
+		entry.Vertices = vertices;
+		entry.Indices = indices;
+		++m_MeshCount;
+
+		// Written on the copy queue while the graphics queue may read other ranges : buffers allow it, as long as
+		// the ranges do not overlap.
+		pUploads.UploadBuffer(*m_VertexBuffer, vertices.Offset * m_VertexStride, pVertices,
+		                      static_cast<uint64_t>(pVertexCount) * m_VertexStride);
+		pUploads.UploadBuffer(*m_IndexBuffer, indices.Offset * sizeof(uint16_t), pIndices,
+		                      static_cast<uint64_t>(pIndexCount) * sizeof(uint16_t));
+		return handle;
+	}
+
+	void MeshPool::Free(const Handle pHandle)
+	{
+		m_PendingFrees.emplace_back(m_FrameNumber, pHandle);
+	}
+
+	RhiVertexBufferView MeshPool::GetVertexBufferView() const
+	{
+		return {m_VertexBuffer->GetGpuAddress(), static_cast<uint32_t>(m_VertexBuffer->GetDesc().Size), m_VertexStride};
+	}
+
+	RhiIndexBufferView MeshPool::GetIndexBufferView() const
+	{
+		return {m_IndexBuffer->GetGpuAddress(), static_cast<uint32_t>(m_IndexBuffer->GetDesc().Size), RhiFormat::R16Uint};
+	}
+
+	void MeshPool::BeginFrame(RhiCommandList& pCommandList)
+	{
+		++m_FrameNumber;
+		std::erase_if(m_RetiredBuffers, [this](const auto& pRetired)
+		{
+			return m_FrameNumber - pRetired.first > m_FrameCount;
+		});
+		std::erase_if(m_PendingFrees, [this](const auto& pFree)
+		{
+			if (m_FrameNumber - pFree.first <= m_FrameCount)
+				return false;
+			Release(pFree.second);
+			return true;
+		});
+
+		const uint32_t vertexCapacity = static_cast<uint32_t>(m_VertexAllocator->GetCapacity());
+		const uint32_t indexCapacity = static_cast<uint32_t>(m_IndexAllocator->GetCapacity());
+		if (m_HasFailedAllocation)
+			Compact(pCommandList, vertexCapacity * 2, indexCapacity * 2);
+		else if (GetWaste(*m_VertexAllocator) > k_CompactionWaste || GetWaste(*m_IndexAllocator) > k_CompactionWaste)
+			Compact(pCommandList, vertexCapacity, indexCapacity);
+	}
+
+	void MeshPool::Compact(RhiCommandList& pCommandList, uint32_t pVertexCapacity, uint32_t pIndexCapacity)
+	{
+		// The freed ranges are not copied, the frames still drawing them read the current buffers.
+		for (const auto& [frame, handle] : m_PendingFrees)
+			Release(handle);
+		m_PendingFrees.clear();
+
+		std::vector<Handle> handles;
+		handles.reserve(m_MeshCount);
+		for (Handle handle = 0; handle < m_Entries.size(); ++handle)
+		{
+			if (m_Entries[handle].Vertices.Block != UINT32_MAX)
+				handles.push_back(handle);
+		}
+
+		// A view's size is 32 bits.
+		pVertexCapacity = (std::min)((std::max)(pVertexCapacity, static_cast<uint32_t>(m_VertexAllocator->GetUsedBytes())),
+		                             UINT32_MAX / m_VertexStride);
+		pIndexCapacity = (std::min)((std::max)(pIndexCapacity, static_cast<uint32_t>(m_IndexAllocator->GetUsedBytes())),
+		                            UINT32_MAX / static_cast<uint32_t>(sizeof(uint16_t)));
+
+		std::unique_ptr<RhiBuffer> oldVertexBuffer = std::move(m_VertexBuffer);
+		std::unique_ptr<RhiBuffer> oldIndexBuffer = std::move(m_IndexBuffer);
+		CreateBuffers(pVertexCapacity, pIndexCapacity);
+
+		pCommandList.Barrier(*oldVertexBuffer, RhiResourceState::Common, RhiResourceState::CopySource);
+		pCommandList.Barrier(*oldIndexBuffer, RhiResourceState::Common, RhiResourceState::CopySource);
+		pCommandList.Barrier(*m_VertexBuffer, RhiResourceState::Common, RhiResourceState::CopyDest);
+		pCommandList.Barrier(*m_IndexBuffer, RhiResourceState::Common, RhiResourceState::CopyDest);
+
+		// Allocated in the order they are in, from empty allocators : they end up packed, and neighbours stay
+		// neighbours so their copies merge.
+		std::sort(handles.begin(), handles.end(), [this](const Handle pA, const Handle pB)
+		{
+			return m_Entries[pA].Vertices.Offset < m_Entries[pB].Vertices.Offset;
+		});
+		CopyBatcher vertexCopies(pCommandList, *m_VertexBuffer, *oldVertexBuffer);
+		for (const Handle handle : handles)
+		{
+			Entry& entry = m_Entries[handle];
+			TlsfAllocation vertices;
+			m_VertexAllocator->TryAllocate(entry.Vertices.Size, 1, vertices);
+			vertexCopies.Add(vertices.Offset * m_VertexStride, entry.Vertices.Offset * m_VertexStride,
+			                 entry.Vertices.Size * m_VertexStride);
+			entry.Vertices = vertices;
+			entry.MeshRange.BaseVertex = static_cast<int32_t>(vertices.Offset);
+		}
+
+		std::sort(handles.begin(), handles.end(), [this](const Handle pA, const Handle pB)
+		{
+			return m_Entries[pA].Indices.Offset < m_Entries[pB].Indices.Offset;
+		});
+		CopyBatcher indexCopies(pCommandList, *m_IndexBuffer, *oldIndexBuffer);
+		for (const Handle handle : handles)
+		{
+			Entry& entry = m_Entries[handle];
+			TlsfAllocation indices;
+			m_IndexAllocator->TryAllocate(entry.Indices.Size, 1, indices);
+			indexCopies.Add(indices.Offset * sizeof(uint16_t), entry.Indices.Offset * sizeof(uint16_t),
+			                entry.Indices.Size * sizeof(uint16_t));
+			entry.Indices = indices;
+			entry.MeshRange.StartIndex = static_cast<uint32_t>(indices.Offset);
+		}
+		m_MovedBytes = vertexCopies.Flush() + indexCopies.Flush();
+
+		// Back to Common, the draws promote them and the copy queue can write new meshes.
+		pCommandList.Barrier(*m_VertexBuffer, RhiResourceState::CopyDest, RhiResourceState::Common);
+		pCommandList.Barrier(*m_IndexBuffer, RhiResourceState::CopyDest, RhiResourceState::Common);
+
+		m_RetiredBuffers.emplace_back(m_FrameNumber, std::move(oldVertexBuffer));
+		m_RetiredBuffers.emplace_back(m_FrameNumber, std::move(oldIndexBuffer));
+		m_HasFailedAllocation = false;
+		++m_Compactions;
+	}
+
+	MeshPool::Stats MeshPool::GetStats() const
+	{
+		const TlsfAllocator::Stats vertexStats = m_VertexAllocator->GetStats();
+		const TlsfAllocator::Stats indexStats = m_IndexAllocator->GetStats();
+		Stats stats;
+		stats.MeshCount = m_MeshCount;
+		stats.VertexCapacity = static_cast<uint32_t>(vertexStats.Capacity);
+		stats.UsedVertices = static_cast<uint32_t>(vertexStats.UsedBytes);
+		stats.IndexCapacity = static_cast<uint32_t>(indexStats.Capacity);
+		stats.UsedIndices = static_cast<uint32_t>(indexStats.UsedBytes);
+		stats.VertexFragmentation = vertexStats.GetFragmentation();
+		stats.IndexFragmentation = indexStats.GetFragmentation();
+		stats.FailedAllocations = m_FailedAllocations;
+		stats.Compactions = m_Compactions;
+		stats.MovedBytes = m_MovedBytes;
+		return stats;
+	}
+
+	void MeshPool::CreateBuffers(const uint32_t pVertexCapacity, const uint32_t pIndexCapacity)
+	{
+		// The allocators count elements, not bytes.
+		m_VertexAllocator = std::make_unique<TlsfAllocator>((std::max)(pVertexCapacity, 1u), 1);
+		m_IndexAllocator = std::make_unique<TlsfAllocator>((std::max)(pIndexCapacity, 1u), 1);
+		m_VertexBuffer = m_Device.CreateBuffer({m_VertexAllocator->GetCapacity() * m_VertexStride, RhiHeapType::Default});
+		m_IndexBuffer = m_Device.CreateBuffer({m_IndexAllocator->GetCapacity() * sizeof(uint16_t), RhiHeapType::Default});
+	}
+
+	void MeshPool::Release(const Handle pHandle)
+	{
+		Entry& entry = m_Entries[pHandle];
+		m_VertexAllocator->Free(entry.Vertices);
+		m_IndexAllocator->Free(entry.Indices);
+		entry = {};
+		m_FreeHandles.push_back(pHandle);
+		--m_MeshCount;
+	}
+}
@@ -0,0 +1,140 @@
+#pragma once
+#include <memory>
+#include <vector>
+
+#include "Core/TlsfAllocator.h"
+#include "RHI/RhiDevice.h"
+
+namespace Engine
+{
+	class UploadManager;
+
+	/// <summary>
+	/// One vertex buffer and one index buffer shared by the meshes of a vertex stride. Each mesh gets a range
+	/// of vertices and a range of indices, split by TlsfAllocators counting in elements, and draws with its base
+	/// vertex and start index : consecutive draws of the pool bind the same buffers, the state filter drops the
+	/// bindings, and the meshes can be drawn by one indirect call.
+	/// Indices stay 16 bits, they are relative to the base vertex.
+	/// Freed ranges are released after the frames in flight. Compact() packs the ranges at the front of new
+	/// buffers when the free space is split, or grows them when a mesh did not fit.
+	/// Not thread safe, meshes are loaded from the main thread. GetRange() can be read while recording draws.
+	/// </summary>
+	class MeshPool
+	{
+	public:
+		using Handle = uint32_t;
+
+		struct Range
+		{
+			int32_t BaseVertex = 0;
+			uint32_t VertexCount = 0;
+			uint32_t StartIndex = 0;
+			uint32_t IndexCount = 0;
+		};
+
+		struct Stats
+		{
+			uint32_t MeshCount = 0;
+			uint32_t VertexCapacity = 0;
+			uint32_t UsedVertices = 0;
+			uint32_t IndexCapacity = 0;
+			uint32_t UsedIndices = 0;
+			// Of the vertex and index free space, see TlsfAllocator::Stats::GetFragmentation().
+			float VertexFragmentation = 0.0f;
+			float IndexFragmentation = 0.0f;
+			// Meshes that did not fit, they keep buffers of their own.
+			uint32_t FailedAllocations = 0;
+			uint32_t Compactions = 0;
+			// Bytes copied by the last compaction.
+			uint64_t MovedBytes = 0;
+		};
+
+		static constexpr Handle k_InvalidHandle = UINT32_MAX;
+		// Part of the capacity in free blocks other than the largest, above it the next BeginFrame() compacts.
+		static constexpr float k_CompactionWaste = 0.25f;
+
+		/// <param name="pDevice"></param>
+		/// <param name="pVertexStride"> : bytes of a vertex, layouts of the same stride can share the pool</param>
+		/// <param name="pFrameCount"> : frames in flight, freed ranges and replaced buffers are kept for them</param>
+		/// <param name="pVertexCapacity"> : vertices, doubled by Compact() when a mesh did not fit</param>
+		/// <param name="pIndexCapacity"> : indices, same</param>
+		MeshPool(RhiDevice& pDevice, uint32_t pVertexStride, uint32_t pFrameCount, uint32_t pVertexCapacity = 1 << 20,
+		         uint32_t pIndexCapacity = 3 << 20);
+
+		MeshPool(const MeshPool&) = delete;
+		MeshPool& operator=(const MeshPool&) = delete;
+
+		/// <summary>
+		/// Copies a mesh into the pool through pUploads, the data can be released right away.
+		/// </summary>
+		/// <returns> k_InvalidHandle when the pool is full. </returns>
+		Handle Allocate(UploadManager& pUploads, const void* pVertices, uint32_t pVertexCount, const uint16_t* pIndices,
+		                uint32_t pIndexCount);
+		/// <summary>
+		/// The ranges are reused once the frames in flight are done with them.
+		/// </summary>
+		void Free(Handle pHandle);
+
+		/// <returns> Where the mesh is, it moves when the pool is compacted. </returns>
+		const Range& GetRange(const Handle pHandle) const { return m_Entries[pHandle].MeshRange; }
+		RhiVertexBufferView GetVertexBufferView() const;
+		RhiIndexBufferView GetIndexBufferView() const;
+		/// <returns> The current buffers, replaced by Compact(). </returns>
+		[[nodiscard]] const RhiBuffer& GetVertexBuffer() const { return *m_VertexBuffer; }
+		[[nodiscard]] const RhiBuffer& GetIndexBuffer() const { return *m_IndexBuffer; }
+
+		/// <summary>
+		/// Releases what the frames in flight no longer use, and compacts the pool when its free space is
+		/// split or a mesh did not fit. Call it once per frame, pCommandList is executed before the draws.
+		/// </summary>
+		void BeginFrame(RhiCommandList& pCommandList);
+		/// <summary>
+		/// Copies every range to the front of new buffers, in order, on pCommandList. The current buffers are
+		/// kept for the frames in flight. Uploads not done yet are waited for by the GPU : pCommandList must be
+		/// executed after UploadManager::MakeVisible().
+		/// </summary>
+		/// <param name="pVertexCapacity"> : of the new buffers, at least the vertices in use</param>
+		/// <param name="pIndexCapacity"> : same</param>
+		void Compact(RhiCommandList& pCommandList, uint32_t pVertexCapacity, uint32_t pIndexCapacity);
+
+		[[nodiscard]] uint32_t GetVertexStride() const { return m_VertexStride; }
+		/// <returns> The number of Compact() calls so far, the ranges read before a change have moved. </returns>
+		[[nodiscard]] uint32_t GetCompactionCount() const { return m_Compactions; }
+		[[nodiscard]] Stats GetStats() const;
+
+	private:
+		struct Entry
+		{
+			Range MeshRange;
+			TlsfAllocation Vertices;
+			TlsfAllocation Indices;
+		};
+
+		void CreateBuffers(uint32_t pVertexCapacity, uint32_t pIndexCapacity);
+		void Release(Handle pHandle);
+
+		RhiDevice& m_Device;
+		uint32_t m_VertexStride;
+		uint32_t m_FrameCount;
+
+		std::unique_ptr<RhiBuffer> m_VertexBuffer;
+		std::unique_ptr<RhiBuffer> m_IndexBuffer;
+		std::unique_ptr<TlsfAllocator> m_VertexAllocator;
+		std::unique_ptr<TlsfAllocator> m_IndexAllocator;
+
+		// Indexed by handle, the free handles are listed.
+		std::vector<Entry> m_Entries;
+		std::vector<Handle> m_FreeHandles;
+		uint32_t m_MeshCount = 0;
+
+		// Freed handles and replaced buffers, with the frame they were let go on.
+		std::vector<std::pair<uint64_t, Handle>> m_PendingFrees;
+		std::vector<std::pair<uint64_t, std::unique_ptr<RhiBuffer>>> m_RetiredBuffers;
+		uint64_t m_FrameNumber = 0;
+		bool m_HasFailedAllocation = false;
+
+		uint32_t m_FailedAllocations = 0;
+		uint32_t m_Compactions = 0;
+		uint64_t m_MovedBytes = 0;
+	};
+}
@@ -0,0 +1,205 @@
+#include "PipelineCache.h"
+
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+#include "Debug/Log.h"
+#include "Platform/FilesSystem.h"
+
+namespace Engine
+{
+	namespace
+	{
+		struct FileHeader
+		{
+			uint32_t Magic;
+			uint32_t Version;
+			uint32_t EntryCount;
+		};
+
+		struct FileEntry
+		{
+			uint64_t Hash;
+			float CompileMilliseconds;
+			uint32_t BlobSize;
+		};
+
+		template <typename T>
+		void Write(std::vector<uint8_t>& pOut, const T& pValue)
+		{
+			const auto* bytes = reinterpret_cast<const uint8_t*>(&pValue);
+			pOut.insert(pOut.end(), bytes, bytes + sizeof(T));
+		}
+
+		void WriteBytes(std::vector<uint8_t>& pOut, const void* pData, const size_t pSize)
+		{
+			Write(pOut, static_cast<uint64_t>(pSize));
+			const auto* bytes = static_cast<const uint8_t*>(pData);
+			pOut.insert(pOut.end(), bytes, bytes + pSize);
+		}
+	}
+
+	PipelineCache::PipelineCache(RhiDevice& pDevice)
+		: m_Device(pDevice)
+	{
+	}
+
+	RhiPipeline& PipelineCache::GetPipeline(const RhiPipelineDesc& pDesc)
+	{
+		++m_Stats.Requests;
+		GetCanonicalDesc(pDesc, m_Scratch);
+		const uint64_t hash = Hash(m_Scratch);
+
+		Entry& entry = m_Pipelines[hash];
+		if (entry.Pipeline)
+		{
+			if (entry.CanonicalDesc != m_Scratch)
+			{
+				CORE_ERROR("[PipelineCache] Hash collision between two pipeline descriptions");
+				throw std::runtime_error("Pipeline description hash collision.");
+			}
+			++m_Stats.Hits;
+			return *entry.Pipeline;
+		}
+
+		RhiPipelineDesc desc = pDesc;
+		const auto stored = m_Stored.find(hash);
+		if (stored != m_Stored.end())
+			desc.CachedBlob = {stored->second.Blob.data(), stored->second.Blob.size()};
+
+		const auto start = std::chrono::steady_clock::now();
+		entry.Pipeline = m_Device.CreatePipeline(desc);
+		const float milliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+		entry.CanonicalDesc = m_Scratch;
+		m_Stats.CreateMilliseconds += milliseconds;
+
+		if (entry.Pipeline->IsFromCachedBlob())
+		{
+			++m_Stats.DiskHits;
+			m_Stats.SavedMilliseconds += stored->second.CompileMilliseconds - milliseconds;
+		}
+		else
+		{
+			// New, or rejected by the driver : the blob of this compilation replaces the stored one.
+			++m_Stats.Misses;
+			m_Stored[hash] = {entry.Pipeline->GetCachedBlob(), milliseconds};
+			m_IsDirty = true;
+		}
+		return *entry.Pipeline;
+	}
+
+	bool PipelineCache::Load(const char* pPath)
+	{
+		if (!FilesSystem::Exist(pPath))
+			return false;
+
+		File file;
+		if (!FilesSystem::TryOpen(pPath, FileModeRead, true, &file))
+			return false;
+
+		FileHeader header;
+		uint64_t read;
+		bool result = FilesSystem::TryRead(&file, sizeof(header), &header, &read) && header.Magic == k_FileMagic &&
+			header.Version == k_FileVersion;
+		std::unordered_map<uint64_t, StoredPipeline> stored;
+		for (uint32_t i = 0; result && i < header.EntryCount; ++i)
+		{
+			FileEntry entry;
+			result = FilesSystem::TryRead(&file, sizeof(entry), &entry, &read);
+			if (!result)
+				break;
+
+			StoredPipeline& pipeline = stored[entry.Hash];
+			pipeline.CompileMilliseconds = entry.CompileMilliseconds;
+			pipeline.Blob.resize(entry.BlobSize);
+			result = entry.BlobSize == 0 || FilesSystem::TryRead(&file, entry.BlobSize, pipeline.Blob.data(), &read);
+		}
+		FilesSystem::Close(&file);
+
+		if (!result)
+		{
+			CORE_WARN("[PipelineCache] Ignoring invalid or outdated file: '%s'", pPath);
+			return false;
+		}
+
+		// Pipelines compiled before the load keep their fresher blob.
+		m_Stored.merge(stored);
+		return true;
+	}
+
+	bool PipelineCache::Save(const char* pPath) const
+	{
+		File file;
+		if (!FilesSystem::TryOpen(pPath, FileModeWrite, true, &file))
+			return false;
+
+		FileHeader header;
+		header.Magic = k_FileMagic;
+		header.Version = k_FileVersion;
+		header.EntryCount = static_cast<uint32_t>(m_Stored.size());
+
+		uint64_t written;
+		bool result = FilesSystem::TryWrite(&file, sizeof(header), &header, &written);
+		for (const auto& [hash, pipeline] : m_Stored)
+		{
+			if (!result)
+				break;
+
+			const FileEntry entry = {hash, pipeline.CompileMilliseconds, static_cast<uint32_t>(pipeline.Blob.size())};
+			result = FilesSystem::TryWrite(&file, sizeof(entry), &entry, &written) &&
+				FilesSystem::TryWrite(&file, pipeline.Blob.size(), pipeline.Blob.data(), &written);
+		}
+		FilesSystem::Close(&file);
+		return result;
+	}
+
+	void PipelineCache::GetCanonicalDesc(const RhiPipelineDesc& pDesc, std::vector<uint8_t>& pOut)
+	{
+		pOut.clear();
+		Write(pOut, k_FileVersion);
+
+		Write(pOut, static_cast<uint32_t>(pDesc.InputLayout.size()));
+		for (const RhiInputElement& element : pDesc.InputLayout)
+		{
+			WriteBytes(pOut, element.Semantic, element.Semantic ? std::strlen(element.Semantic) : 0);
+			Write(pOut, element.SemanticIndex);
+			Write(pOut, element.Format);
+			Write(pOut, element.Offset);
+		}
+
+		WriteBytes(pOut, pDesc.VertexShader.Data, pDesc.VertexShader.Size);
+		WriteBytes(pOut, pDesc.PixelShader.Data, pDesc.PixelShader.Size);
+		WriteBytes(pOut, pDesc.ComputeShader.Data, pDesc.ComputeShader.Size);
+
+		Write(pOut, static_cast<uint32_t>(pDesc.RootParameters.size()));
+		for (const RhiRootParameter& parameter : pDesc.RootParameters)
+		{
+			Write(pOut, parameter.Type);
+			Write(pOut, parameter.ShaderRegister);
+			Write(pOut, parameter.Visibility);
+			Write(pOut, parameter.RegisterSpace);
+			Write(pOut, parameter.ConstantCount);
+			Write(pOut, parameter.DescriptorCount);
+		}
+		Write(pOut, pDesc.UseStaticSamplers);
+
+		// Rasterizer, blend and depth states are the backend's defaults, they are covered by k_FileVersion.
+		Write(pOut, pDesc.RenderTargetFormat);
+		Write(pOut, pDesc.DepthStencilFormat);
+		Write(pOut, pDesc.SampleCount);
+		Write(pOut, pDesc.SampleQuality);
+	}
+
+	uint64_t PipelineCache::Hash(const std::vector<uint8_t>& pCanonicalDesc)
+	{
+		// FNV-1a, descriptions are hashed once per request.
+		uint64_t hash = 0xCBF29CE484222325ull;
+		for (const uint8_t byte : pCanonicalDesc)
+		{
+			hash ^= byte;
+			hash *= 0x100000001B3ull;
+		}
+		return hash;
+	}
+}
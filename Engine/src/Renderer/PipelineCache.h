@@ -0,0 +1,95 @@
+#pragma once
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "RHI/RhiDevice.h"
+
+namespace Engine
+{
+	/// <summary>
+	/// Owns every pipeline, keyed by a hash of their canonical description : bytecode, input layout, root
+	/// parameters, formats and multisampling. Equivalent descriptions get the same pipeline.
+	/// The driver's compiled pipelines are saved to a file and given back to the driver on the next run, which
+	/// skips most of the compilation. Entries the driver rejects (new driver, other adapter) are compiled again
+	/// and the file is rewritten.
+	/// Not thread safe, pipelines are created from the main thread.
+	/// </summary>
+	class PipelineCache
+	{
+	public:
+		struct Stats
+		{
+			uint32_t Requests = 0;
+			// Requests of a description already created during this run.
+			uint32_t Hits = 0;
+			// Pipelines created from the file's blob.
+			uint32_t DiskHits = 0;
+			// Pipelines compiled from scratch.
+			uint32_t Misses = 0;
+			// Time spent in RhiDevice::CreatePipeline.
+			double CreateMilliseconds = 0.0;
+			// Compile time the file recorded for the disk hits, minus the time they took to create.
+			double SavedMilliseconds = 0.0;
+
+			[[nodiscard]] float GetHitRate() const
+			{
+				return Requests ? static_cast<float>(Hits + DiskHits) / static_cast<float>(Requests) : 0.f;
+			}
+		};
+
+		static constexpr uint32_t k_FileMagic = 0x31435350; // "PSC1"
+		// Changes whenever the canonical description does, older files are ignored.
+		static constexpr uint32_t k_FileVersion = 2;
+
+		explicit PipelineCache(RhiDevice& pDevice);
+
+		PipelineCache(const PipelineCache&) = delete;
+		PipelineCache& operator=(const PipelineCache&) = delete;
+
+		/// <returns> The pipeline of the description, created on the first request. It lives as long as the cache. </returns>
+		RhiPipeline& GetPipeline(const RhiPipelineDesc& pDesc);
+
+		/// <summary>
+		/// Reads the compiled pipelines of a previous run, used by the next GetPipeline() calls.
+		/// </summary>
+		/// <returns> False when there is no file, or it is invalid or from another version. </returns>
+		bool Load(const char* pPath);
+		/// <summary>
+		/// Writes the compiled pipelines, the ones loaded but not requested during this run included.
+		/// </summary>
+		bool Save(const char* pPath) const;
+		/// <returns> True when pipelines were compiled during this run, the file does not hold them yet. </returns>
+		[[nodiscard]] bool IsDirty() const { return m_IsDirty; }
+
+		[[nodiscard]] const Stats& GetStats() const { return m_Stats; }
+
+		/// <summary>
+		/// Serializes what identifies the pipeline, field by field so padding is never part of it.
+		/// </summary>
+		static void GetCanonicalDesc(const RhiPipelineDesc& pDesc, std::vector<uint8_t>& pOut);
+		static uint64_t Hash(const std::vector<uint8_t>& pCanonicalDesc);
+
+	private:
+		struct Entry
+		{
+			std::unique_ptr<RhiPipeline> Pipeline;
+			// Compared on lookup, two descriptions with the same hash are not mixed up.
+			std::vector<uint8_t> CanonicalDesc;
+		};
+
+		struct StoredPipeline
+		{
+			std::vector<uint8_t> Blob;
+			float CompileMilliseconds = 0.f;
+		};
+
+		RhiDevice& m_Device;
+		std::unordered_map<uint64_t, Entry> m_Pipelines;
+		// What the file holds, and what Save() writes.
+		std::unordered_map<uint64_t, StoredPipeline> m_Stored;
+		std::vector<uint8_t> m_Scratch;
+		bool m_IsDirty = false;
+		Stats m_Stats;
+	};
+}
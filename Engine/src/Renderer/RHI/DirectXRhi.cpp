@@ -0,0 +1,944 @@
+#include "DirectXRhi.h"
+
+#include <array>
+
+#include "Renderer/DirectXCommandObject.h"
+#include "Renderer/DirectXSwapchain.h"
+
+namespace Engine
+{
+	DXGI_FORMAT ToDxgiFormat(const RhiFormat pFormat)
+	{
+		switch (pFormat)
+		{
+		case RhiFormat::R8G8B8A8Unorm: return DXGI_FORMAT_R8G8B8A8_UNORM;
+		case RhiFormat::D24UnormS8Uint: return DXGI_FORMAT_D24_UNORM_S8_UINT;
+		case RhiFormat::R16Uint: return DXGI_FORMAT_R16_UINT;
+		case RhiFormat::R32Uint: return DXGI_FORMAT_R32_UINT;
+		case RhiFormat::R32Float: return DXGI_FORMAT_R32_FLOAT;
+		case RhiFormat::R32G32Float: return DXGI_FORMAT_R32G32_FLOAT;
+		case RhiFormat::R32G32B32Float: return DXGI_FORMAT_R32G32B32_FLOAT;
+		case RhiFormat::R32G32B32A32Float: return DXGI_FORMAT_R32G32B32A32_FLOAT;
+		default: return DXGI_FORMAT_UNKNOWN;
+		}
+	}
+
+	D3D12_RESOURCE_STATES ToD3D12State(const RhiResourceState pState)
+	{
+		switch (pState)
+		{
+		case RhiResourceState::VertexAndConstantBuffer: return D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER;
+		case RhiResourceState::IndexBuffer: return D3D12_RESOURCE_STATE_INDEX_BUFFER;
+		case RhiResourceState::RenderTarget: return D3D12_RESOURCE_STATE_RENDER_TARGET;
+		case RhiResourceState::DepthWrite: return D3D12_RESOURCE_STATE_DEPTH_WRITE;
+		case RhiResourceState::ShaderResource: return D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE |
+				D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
+		case RhiResourceState::CopySource: return D3D12_RESOURCE_STATE_COPY_SOURCE;
+		case RhiResourceState::CopyDest: return D3D12_RESOURCE_STATE_COPY_DEST;
+		case RhiResourceState::GenericRead: return D3D12_RESOURCE_STATE_GENERIC_READ;
+		case RhiResourceState::Present: return D3D12_RESOURCE_STATE_PRESENT;
+		case RhiResourceState::UnorderedAccess: return D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+		case RhiResourceState::IndirectArgument: return D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT;
+		default: return D3D12_RESOURCE_STATE_COMMON;
+		}
+	}
+
+	namespace
+	{
+		D3D12_PRIMITIVE_TOPOLOGY ToD3D12Topology(const RhiPrimitiveTopology pTopology)
+		{
+			switch (pTopology)
+			{
+			case RhiPrimitiveTopology::TriangleStrip: return D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP;
+			case RhiPrimitiveTopology::LineList: return D3D_PRIMITIVE_TOPOLOGY_LINELIST;
+			case RhiPrimitiveTopology::PointList: return D3D_PRIMITIVE_TOPOLOGY_POINTLIST;
+			default: return D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+			}
+		}
+
+		D3D12_SHADER_VISIBILITY ToD3D12Visibility(const RhiShaderVisibility pVisibility)
+		{
+			switch (pVisibility)
+			{
+			case RhiShaderVisibility::Vertex: return D3D12_SHADER_VISIBILITY_VERTEX;
+			case RhiShaderVisibility::Pixel: return D3D12_SHADER_VISIBILITY_PIXEL;
+			default: return D3D12_SHADER_VISIBILITY_ALL;
+			}
+		}
+
+		D3D12_RESOURCE_DESC ToD3D12TextureDesc(const RhiTextureDesc& pDesc)
+		{
+			D3D12_RESOURCE_DESC textureDesc = CD3DX12_RESOURCE_DESC::Tex2D(
+				ToDxgiFormat(pDesc.Format), pDesc.Width, pDesc.Height, 1, pDesc.MipLevels, pDesc.SampleCount,
+				pDesc.SampleQuality);
+			if (pDesc.IsRenderTarget)
+				textureDesc.Flags |= D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
+			if (pDesc.IsDepthStencil)
+				textureDesc.Flags |= D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL;
+			return textureDesc;
+		}
+
+		D3D12_CLEAR_VALUE GetClearValue(const RhiTextureDesc& pDesc)
+		{
+			D3D12_CLEAR_VALUE clearValue = {};
+			clearValue.Format = ToDxgiFormat(pDesc.Format);
+			clearValue.DepthStencil.Depth = 1.0f;
+			return clearValue;
+		}
+
+		ID3D12Resource* GetResource(const RhiResource& pResource)
+		{
+			if (const auto* buffer = dynamic_cast<const DirectXRhiBuffer*>(&pResource))
+				return buffer->GetResource();
+			return static_cast<const DirectXRhiTexture&>(pResource).GetResource();
+		}
+
+		std::array<const CD3DX12_STATIC_SAMPLER_DESC, 6> GetStaticSamplers()
+		{
+			// Applications usually only need a handful of samplers.  So just define them all up front
+			// and keep them available as part of the root signature.
+
+			const CD3DX12_STATIC_SAMPLER_DESC pointWrap(
+				0, // shaderRegister
+				D3D12_FILTER_MIN_MAG_MIP_POINT, // filter
+				D3D12_TEXTURE_ADDRESS_MODE_WRAP, // addressU
+				D3D12_TEXTURE_ADDRESS_MODE_WRAP, // addressV
+				D3D12_TEXTURE_ADDRESS_MODE_WRAP); // addressW
+
+			const CD3DX12_STATIC_SAMPLER_DESC pointClamp(
+				1, // shaderRegister
+				D3D12_FILTER_MIN_MAG_MIP_POINT, // filter
+				D3D12_TEXTURE_ADDRESS_MODE_CLAMP, // addressU
+				D3D12_TEXTURE_ADDRESS_MODE_CLAMP, // addressV
+				D3D12_TEXTURE_ADDRESS_MODE_CLAMP); // addressW
+
+			const CD3DX12_STATIC_SAMPLER_DESC linearWrap(
+				2, // shaderRegister
+				D3D12_FILTER_MIN_MAG_MIP_LINEAR, // filter
+				D3D12_TEXTURE_ADDRESS_MODE_WRAP, // addressU
+				D3D12_TEXTURE_ADDRESS_MODE_WRAP, // addressV
+				D3D12_TEXTURE_ADDRESS_MODE_WRAP); // addressW
+
+			const CD3DX12_STATIC_SAMPLER_DESC linearClamp(
+				3, // shaderRegister
+				D3D12_FILTER_MIN_MAG_MIP_LINEAR, // filter
+				D3D12_TEXTURE_ADDRESS_MODE_CLAMP, // addressU
+				D3D12_TEXTURE_ADDRESS_MODE_CLAMP, // addressV
+				D3D12_TEXTURE_ADDRESS_MODE_CLAMP); // addressW
+
+			const CD3DX12_STATIC_SAMPLER_DESC anisotropicWrap(
+				4, // shaderRegister
+				D3D12_FILTER_ANISOTROPIC, // filter
+				D3D12_TEXTURE_ADDRESS_MODE_WRAP, // addressU
+				D3D12_TEXTURE_ADDRESS_MODE_WRAP, // addressV
+				D3D12_TEXTURE_ADDRESS_MODE_WRAP, // addressW
+				0.0f, // mipLODBias
+				8); // maxAnisotropy
+
+			const CD3DX12_STATIC_SAMPLER_DESC anisotropicClamp(
+				5, // shaderRegister
+				D3D12_FILTER_ANISOTROPIC, // filter
+				D3D12_TEXTURE_ADDRESS_MODE_CLAMP, // addressU
+				D3D12_TEXTURE_ADDRESS_MODE_CLAMP, // addressV
+				D3D12_TEXTURE_ADDRESS_MODE_CLAMP, // addressW
+				0.0f, // mipLODBias
+				8); // maxAnisotropy
+
+			return {
+				pointWrap, pointClamp,
+				linearWrap, linearClamp,
+				anisotropicWrap, anisotropicClamp
+			};
+		}
+	}
+
+	// ===== Resources =====
+
+	DirectXRhiBuffer::DirectXRhiBuffer(DirectXRhiDevice& pDevice, const RhiBufferDesc& pDesc)
+		: m_Allocator(pDevice.GetMemoryAllocator())
+	{
+		m_Desc = pDesc;
+		ID3D12Device* device = pDevice.GetDevice();
+
+		D3D12_HEAP_TYPE heapType = D3D12_HEAP_TYPE_DEFAULT;
+		D3D12_RESOURCE_STATES state = D3D12_RESOURCE_STATE_COMMON;
+		if (pDesc.Heap == RhiHeapType::Upload)
+		{
+			heapType = D3D12_HEAP_TYPE_UPLOAD;
+			state = D3D12_RESOURCE_STATE_GENERIC_READ;
+		}
+		else if (pDesc.Heap == RhiHeapType::Readback)
+		{
+			heapType = D3D12_HEAP_TYPE_READBACK;
+			state = D3D12_RESOURCE_STATE_COPY_DEST;
+		}
+
+		const auto bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(
+			pDesc.Size, pDesc.AllowUnorderedAccess ? D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS : D3D12_RESOURCE_FLAG_NONE);
+		const D3D12_RESOURCE_ALLOCATION_INFO info = device->GetResourceAllocationInfo(0, 1, &bufferDesc);
+		m_Allocation = m_Allocator.Allocate(GetBufferMemoryPool(pDesc.Heap), info.SizeInBytes, info.Alignment, this);
+
+		HRESULT hr;
+		if (m_Allocation.IsDedicated())
+		{
+			const auto heapProperties = CD3DX12_HEAP_PROPERTIES(heapType);
+			hr = device->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, &bufferDesc, state, nullptr,
+			                                     IID_PPV_ARGS(m_Resource.GetAddressOf()));
+		}
+		else
+		{
+			hr = device->CreatePlacedResource(pDevice.GetHeap(m_Allocation), m_Allocation.Offset, &bufferDesc, state,
+			                                  nullptr, IID_PPV_ARGS(m_Resource.GetAddressOf()));
+		}
+		if (FAILED(hr))
+			m_Allocator.Free(m_Allocation);
+		THROW_IF_FAILED(hr);
+		m_GpuAddress = m_Resource->GetGPUVirtualAddress();
+
+		// Upload and readback buffers stay mapped until they are destroyed.
+		if (pDesc.Heap != RhiHeapType::Default)
+			THROW_IF_FAILED(m_Resource->Map(0, nullptr, reinterpret_cast<void**>(&m_MappedData)));
+	}
+
+	DirectXRhiBuffer::~DirectXRhiBuffer()
+	{
+		if (m_MappedData)
+			m_Resource->Unmap(0, nullptr);
+		// The memory is given to the next resource, this one must be gone first.
+		m_Resource.Reset();
+		m_Allocator.Free(m_Allocation);
+	}
+
+	DirectXRhiHeap::DirectXRhiHeap(ID3D12Device* pDevice, const uint64_t pSize)
+	{
+		D3D12_HEAP_DESC heapDesc = {};
+		heapDesc.SizeInBytes = pSize;
+		// Multisampled targets are placed at 4MB.
+		heapDesc.Alignment = D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT;
+		heapDesc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES;
+		heapDesc.Properties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+		THROW_IF_FAILED(pDevice->CreateHeap(&heapDesc, IID_PPV_ARGS(m_Heap.GetAddressOf())));
+		m_Size = pSize;
+	}
+
+	DirectXRhiTexture::DirectXRhiTexture(DirectXRhiDevice& pDevice, const RhiTextureDesc& pDesc)
+	{
+		m_Desc = pDesc;
+		ID3D12Device* device = pDevice.GetDevice();
+
+		D3D12_RESOURCE_DESC textureDesc = ToD3D12TextureDesc(pDesc);
+		if (!pDesc.IsRenderTarget && !pDesc.IsDepthStencil)
+		{
+			// Small textures can be placed at 4KB instead of 64KB, the device tells when the format allows it.
+			textureDesc.Alignment = k_RhiSmallResourcePlacementAlignment;
+			D3D12_RESOURCE_ALLOCATION_INFO info = device->GetResourceAllocationInfo(0, 1, &textureDesc);
+			if (info.Alignment != k_RhiSmallResourcePlacementAlignment)
+			{
+				textureDesc.Alignment = 0;
+				info = device->GetResourceAllocationInfo(0, 1, &textureDesc);
+			}
+
+			RhiMemoryAllocator& allocator = pDevice.GetMemoryAllocator();
+			const RhiMemoryAllocation allocation = allocator.Allocate(RhiMemoryPool::Textures, info.SizeInBytes,
+			                                                          info.Alignment, this);
+			HRESULT hr;
+			if (allocation.IsDedicated())
+			{
+				const auto heapProperties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+				hr = device->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, &textureDesc,
+				                                     D3D12_RESOURCE_STATE_COMMON, nullptr,
+				                                     IID_PPV_ARGS(m_OwnedResource.GetAddressOf()));
+			}
+			else
+			{
+				hr = device->CreatePlacedResource(pDevice.GetHeap(allocation), allocation.Offset, &textureDesc,
+				                                  D3D12_RESOURCE_STATE_COMMON, nullptr,
+				                                  IID_PPV_ARGS(m_OwnedResource.GetAddressOf()));
+			}
+			if (FAILED(hr))
+				allocator.Free(allocation);
+			THROW_IF_FAILED(hr);
+
+			m_Resource = m_OwnedResource.Get();
+			m_Allocator = &allocator;
+			m_Allocation = allocation;
+			return;
+		}
+
+		const auto heapProperties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+		const D3D12_CLEAR_VALUE clearValue = GetClearValue(pDesc);
+		THROW_IF_FAILED(device->CreateCommittedResource(
+			&heapProperties,
+			D3D12_HEAP_FLAG_NONE,
+			&textureDesc,
+			D3D12_RESOURCE_STATE_COMMON,
+			&clearValue,
+			IID_PPV_ARGS(m_OwnedResource.GetAddressOf())));
+		m_Resource = m_OwnedResource.Get();
+		CreateView(device);
+	}
+
+	DirectXRhiTexture::DirectXRhiTexture(DirectXRhiDevice& pDevice, const RhiTextureDesc& pDesc,
+	                                     const DirectXRhiHeap& pHeap, const uint64_t pOffset)
+	{
+		assert((pDesc.IsRenderTarget || pDesc.IsDepthStencil) && "Only render targets and depth stencils are placed");
+		m_Desc = pDesc;
+		ID3D12Device* device = pDevice.GetDevice();
+
+		const D3D12_RESOURCE_DESC textureDesc = ToD3D12TextureDesc(pDesc);
+		const D3D12_CLEAR_VALUE clearValue = GetClearValue(pDesc);
+		THROW_IF_FAILED(device->CreatePlacedResource(pHeap.GetHeap(), pOffset, &textureDesc,
+		                                             D3D12_RESOURCE_STATE_COMMON, &clearValue,
+		                                             IID_PPV_ARGS(m_OwnedResource.GetAddressOf())));
+		m_Resource = m_OwnedResource.Get();
+		CreateView(device);
+	}
+
+	DirectXRhiTexture::~DirectXRhiTexture()
+	{
+		m_OwnedResource.Reset();
+		if (m_Allocator)
+			m_Allocator->Free(m_Allocation);
+	}
+
+	void DirectXRhiTexture::CreateView(ID3D12Device* pDevice)
+	{
+		D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
+		heapDesc.NumDescriptors = 1;
+		heapDesc.Type = m_Desc.IsDepthStencil ? D3D12_DESCRIPTOR_HEAP_TYPE_DSV : D3D12_DESCRIPTOR_HEAP_TYPE_RTV;
+		heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+		THROW_IF_FAILED(pDevice->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(m_ViewHeap.GetAddressOf())));
+		m_View = m_ViewHeap->GetCPUDescriptorHandleForHeapStart();
+
+		if (m_Desc.IsDepthStencil)
+			pDevice->CreateDepthStencilView(m_Resource, nullptr, m_View);
+		else
+			pDevice->CreateRenderTargetView(m_Resource, nullptr, m_View);
+	}
+
+	void DirectXRhiTexture::Wrap(ID3D12Resource* pResource, const D3D12_CPU_DESCRIPTOR_HANDLE pView,
+	                             const RhiTextureDesc& pDesc)
+	{
+		m_Resource = pResource;
+		m_View = pView;
+		m_Desc = pDesc;
+	}
+
+	DirectXRhiPipeline::DirectXRhiPipeline(ID3D12Device* pDevice,
+	                                       Microsoft::WRL::ComPtr<ID3D12RootSignature> pRootSignature,
+	                                       const RhiPipelineDesc& pDesc)
+		: m_RootSignature(std::move(pRootSignature)), m_IsCompute(pDesc.ComputeShader.Data != nullptr)
+	{
+		if (m_IsCompute)
+		{
+			D3D12_COMPUTE_PIPELINE_STATE_DESC computeDesc = {};
+			computeDesc.pRootSignature = m_RootSignature.Get();
+			computeDesc.CS = {pDesc.ComputeShader.Data, pDesc.ComputeShader.Size};
+			computeDesc.CachedPSO = {pDesc.CachedBlob.Data, pDesc.CachedBlob.Size};
+			HRESULT hr = pDevice->CreateComputePipelineState(&computeDesc, IID_PPV_ARGS(&m_PipelineState));
+			m_IsFromCachedBlob = SUCCEEDED(hr) && pDesc.CachedBlob.Data;
+			if (FAILED(hr) && pDesc.CachedBlob.Data)
+			{
+				computeDesc.CachedPSO = {};
+				hr = pDevice->CreateComputePipelineState(&computeDesc, IID_PPV_ARGS(&m_PipelineState));
+			}
+			THROW_IF_FAILED(hr);
+			return;
+		}
+
+		// ===== Pipeline state =====
+		std::vector<D3D12_INPUT_ELEMENT_DESC> layout;
+		layout.reserve(pDesc.InputLayout.size());
+		for (const RhiInputElement& element : pDesc.InputLayout)
+		{
+			layout.push_back({
+				element.Semantic, element.SemanticIndex, ToDxgiFormat(element.Format), 0, element.Offset,
+				D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0
+			});
+		}
+
+		D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc;
+		ZeroMemory(&psoDesc, sizeof(D3D12_GRAPHICS_PIPELINE_STATE_DESC));
+		psoDesc.InputLayout = {layout.data(), static_cast<UINT>(layout.size())};
+		psoDesc.pRootSignature = m_RootSignature.Get();
+		psoDesc.VS = {pDesc.VertexShader.Data, pDesc.VertexShader.Size};
+		psoDesc.PS = {pDesc.PixelShader.Data, pDesc.PixelShader.Size};
+		psoDesc.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
+		psoDesc.BlendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
+		psoDesc.DepthStencilState = CD3DX12_DEPTH_STENCIL_DESC(D3D12_DEFAULT);
+		psoDesc.SampleMask = UINT_MAX;
+		psoDesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+		psoDesc.NumRenderTargets = 1;
+		psoDesc.RTVFormats[0] = ToDxgiFormat(pDesc.RenderTargetFormat);
+		psoDesc.SampleDesc.Count = pDesc.SampleCount;
+		psoDesc.SampleDesc.Quality = pDesc.SampleQuality;
+		psoDesc.DSVFormat = ToDxgiFormat(pDesc.DepthStencilFormat);
+		psoDesc.CachedPSO = {pDesc.CachedBlob.Data, pDesc.CachedBlob.Size};
+		HRESULT hr = pDevice->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&m_PipelineState));
+		m_IsFromCachedBlob = SUCCEEDED(hr) && pDesc.CachedBlob.Data;
+		if (FAILED(hr) && pDesc.CachedBlob.Data)
+		{
+			// Another adapter or driver wrote the blob, or it does not match the description anymore.
+			psoDesc.CachedPSO = {};
+			hr = pDevice->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&m_PipelineState));
+		}
+		THROW_IF_FAILED(hr);
+	}
+
+	std::vector<uint8_t> DirectXRhiPipeline::GetCachedBlob() const
+	{
+		Microsoft::WRL::ComPtr<ID3DBlob> blob;
+		if (FAILED(m_PipelineState->GetCachedBlob(&blob)))
+			return {};
+		const auto* data = static_cast<const uint8_t*>(blob->GetBufferPointer());
+		return {data, data + blob->GetBufferSize()};
+	}
+
+	DirectXRhiCommandSignature::DirectXRhiCommandSignature(ID3D12Device* pDevice,
+	                                                       const RhiCommandSignatureDesc& pDesc,
+	                                                       const DirectXRhiPipeline* pPipeline)
+	{
+		std::vector<D3D12_INDIRECT_ARGUMENT_DESC> arguments(pDesc.Arguments.size());
+		bool hasRootArguments = false;
+		for (size_t i = 0; i < pDesc.Arguments.size(); ++i)
+		{
+			const RhiIndirectArgument& argument = pDesc.Arguments[i];
+			if (argument.Type == RhiIndirectArgumentType::Constants)
+			{
+				arguments[i].Type = D3D12_INDIRECT_ARGUMENT_TYPE_CONSTANT;
+				arguments[i].Constant = {argument.RootSlot, argument.ConstantOffset, argument.ConstantCount};
+				hasRootArguments = true;
+			}
+			else
+				arguments[i].Type = D3D12_INDIRECT_ARGUMENT_TYPE_DRAW_INDEXED;
+		}
+
+		D3D12_COMMAND_SIGNATURE_DESC signatureDesc = {};
+		signatureDesc.ByteStride = pDesc.ByteStride;
+		signatureDesc.NumArgumentDescs = static_cast<UINT>(arguments.size());
+		signatureDesc.pArgumentDescs = arguments.data();
+		// Only a signature changing root arguments is tied to a root signature.
+		ID3D12RootSignature* rootSignature = hasRootArguments && pPipeline ? pPipeline->GetRootSignature() : nullptr;
+		THROW_IF_FAILED(pDevice->CreateCommandSignature(&signatureDesc, rootSignature,
+			IID_PPV_ARGS(m_CommandSignature.GetAddressOf())));
+	}
+
+	DirectXRhiFence::DirectXRhiFence(ID3D12Device* pDevice, const uint64_t pInitialValue)
+	{
+		THROW_IF_FAILED(pDevice->CreateFence(pInitialValue, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_Fence)));
+	}
+
+	void DirectXRhiFence::Wait(const uint64_t pValue)
+	{
+		if (m_Fence->GetCompletedValue() >= pValue)
+			return;
+
+		const HANDLE eventHandle = CreateEventEx(nullptr, nullptr, false, EVENT_ALL_ACCESS);
+		THROW_IF_FAILED(m_Fence->SetEventOnCompletion(pValue, eventHandle));
+		WaitForSingleObject(eventHandle, INFINITE);
+		CloseHandle(eventHandle);
+	}
+
+	// ===== Command list =====
+
+	void DirectXRhiCommandList::Begin(RhiCommandAllocator& pAllocator)
+	{
+		THROW_IF_FAILED(m_List->Reset(static_cast<DirectXRhiCommandAllocator&>(pAllocator).GetAllocator(), nullptr));
+
+		// Copy lists cannot bind descriptor heaps.
+		if (ID3D12DescriptorHeap* heap = m_Device.GetShaderVisibleHeap();
+			heap && m_List->GetType() == D3D12_COMMAND_LIST_TYPE_DIRECT)
+			m_List->SetDescriptorHeaps(1, &heap);
+	}
+
+	void DirectXRhiCommandList::End()
+	{
+		THROW_IF_FAILED(m_List->Close());
+	}
+
+	void DirectXRhiCommandList::SetPipeline(const RhiPipeline& pPipeline)
+	{
+		const auto& pipeline = static_cast<const DirectXRhiPipeline&>(pPipeline);
+		m_List->SetPipelineState(pipeline.GetPipelineState());
+		if (pipeline.IsCompute())
+			m_List->SetComputeRootSignature(pipeline.GetRootSignature());
+		else
+			m_List->SetGraphicsRootSignature(pipeline.GetRootSignature());
+	}
+
+	void DirectXRhiCommandList::SetPipelineState(const RhiPipeline& pPipeline)
+	{
+		m_List->SetPipelineState(static_cast<const DirectXRhiPipeline&>(pPipeline).GetPipelineState());
+	}
+
+	void DirectXRhiCommandList::SetGraphicsRootConstantBufferView(const uint32_t pSlot, const RhiGpuAddress pAddress)
+	{
+		m_List->SetGraphicsRootConstantBufferView(pSlot, pAddress);
+	}
+
+	void DirectXRhiCommandList::SetGraphicsRootDescriptorTable(const uint32_t pSlot, const RhiDescriptor pDescriptor)
+	{
+		m_List->SetGraphicsRootDescriptorTable(pSlot, D3D12_GPU_DESCRIPTOR_HANDLE{pDescriptor});
+	}
+
+	void DirectXRhiCommandList::SetGraphicsRootShaderResourceView(const uint32_t pSlot, const RhiGpuAddress pAddress)
+	{
+		m_List->SetGraphicsRootShaderResourceView(pSlot, pAddress);
+	}
+
+	void DirectXRhiCommandList::SetGraphicsRoot32BitConstant(const uint32_t pSlot, const uint32_t pValue,
+	                                                         const uint32_t pOffset)
+	{
+		m_List->SetGraphicsRoot32BitConstant(pSlot, pValue, pOffset);
+	}
+
+	void DirectXRhiCommandList::SetComputeRootConstantBufferView(const uint32_t pSlot, const RhiGpuAddress pAddress)
+	{
+		m_List->SetComputeRootConstantBufferView(pSlot, pAddress);
+	}
+
+	void DirectXRhiCommandList::SetComputeRootShaderResourceView(const uint32_t pSlot, const RhiGpuAddress pAddress)
+	{
+		m_List->SetComputeRootShaderResourceView(pSlot, pAddress);
+	}
+
+	void DirectXRhiCommandList::SetComputeRootUnorderedAccessView(const uint32_t pSlot, const RhiGpuAddress pAddress)
+	{
+		m_List->SetComputeRootUnorderedAccessView(pSlot, pAddress);
+	}
+
+	void DirectXRhiCommandList::SetVertexBuffer(const RhiVertexBufferView& pView)
+	{
+		const D3D12_VERTEX_BUFFER_VIEW view = {pView.Address, pView.Size, pView.Stride};
+		m_List->IASetVertexBuffers(0, 1, &view);
+	}
+
+	void DirectXRhiCommandList::SetIndexBuffer(const RhiIndexBufferView& pView)
+	{
+		const D3D12_INDEX_BUFFER_VIEW view = {pView.Address, pView.Size, ToDxgiFormat(pView.Format)};
+		m_List->IASetIndexBuffer(&view);
+	}
+
+	void DirectXRhiCommandList::SetPrimitiveTopology(const RhiPrimitiveTopology pTopology)
+	{
+		m_List->IASetPrimitiveTopology(ToD3D12Topology(pTopology));
+	}
+
+	void DirectXRhiCommandList::SetViewport(const RhiViewport& pViewport)
+	{
+		const D3D12_VIEWPORT viewport = {
+			pViewport.TopLeftX, pViewport.TopLeftY, pViewport.Width, pViewport.Height, pViewport.MinDepth,
+			pViewport.MaxDepth
+		};
+		m_List->RSSetViewports(1, &viewport);
+	}
+
+	void DirectXRhiCommandList::SetScissorRect(const RhiRect& pRect)
+	{
+		const D3D12_RECT rect = {pRect.Left, pRect.Top, pRect.Right, pRect.Bottom};
+		m_List->RSSetScissorRects(1, &rect);
+	}
+
+	void DirectXRhiCommandList::SetRenderTarget(const RhiTexture* pColor, const RhiTexture* pDepthStencil)
+	{
+		D3D12_CPU_DESCRIPTOR_HANDLE color = {};
+		D3D12_CPU_DESCRIPTOR_HANDLE depthStencil = {};
+		if (pColor)
+			color = static_cast<const DirectXRhiTexture*>(pColor)->GetView();
+		if (pDepthStencil)
+			depthStencil = static_cast<const DirectXRhiTexture*>(pDepthStencil)->GetView();
+		m_List->OMSetRenderTargets(pColor ? 1 : 0, pColor ? &color : nullptr, true,
+		                           pDepthStencil ? &depthStencil : nullptr);
+	}
+
+	void DirectXRhiCommandList::ClearRenderTarget(const RhiTexture& pTarget, const float pColor[4])
+	{
+		m_List->ClearRenderTargetView(static_cast<const DirectXRhiTexture&>(pTarget).GetView(), pColor, 0, nullptr);
+	}
+
+	void DirectXRhiCommandList::ClearDepthStencil(const RhiTexture& pTarget, const float pDepth, const uint8_t pStencil)
+	{
+		m_List->ClearDepthStencilView(static_cast<const DirectXRhiTexture&>(pTarget).GetView(),
+		                              D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, pDepth, pStencil, 0, nullptr);
+	}
+
+	void DirectXRhiCommandList::Barrier(const RhiResource& pResource, const RhiResourceState pBefore,
+	                                    const RhiResourceState pAfter)
+	{
+		const auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(GetResource(pResource), ToD3D12State(pBefore),
+		                                                          ToD3D12State(pAfter));
+		m_List->ResourceBarrier(1, &barrier);
+	}
+
+	void DirectXRhiCommandList::UnorderedAccessBarrier(const RhiResource& pResource)
+	{
+		const auto barrier = CD3DX12_RESOURCE_BARRIER::UAV(GetResource(pResource));
+		m_List->ResourceBarrier(1, &barrier);
+	}
+
+	void DirectXRhiCommandList::Barriers(const RhiBarrier* pBarriers, const uint32_t pCount)
+	{
+		if (pCount == 0)
+			return;
+
+		m_Barriers.clear();
+		for (uint32_t i = 0; i < pCount; ++i)
+		{
+			const RhiBarrier& barrier = pBarriers[i];
+			ID3D12Resource* resource = GetResource(*barrier.Resource);
+			switch (barrier.Type)
+			{
+			case RhiBarrierType::Aliasing:
+				// Whatever was placed over the same memory before is done with it.
+				m_Barriers.push_back(CD3DX12_RESOURCE_BARRIER::Aliasing(nullptr, resource));
+				break;
+			case RhiBarrierType::UnorderedAccess:
+				m_Barriers.push_back(CD3DX12_RESOURCE_BARRIER::UAV(resource));
+				break;
+			default:
+				m_Barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(resource, ToD3D12State(barrier.Before),
+				                                                          ToD3D12State(barrier.After)));
+				break;
+			}
+		}
+		m_List->ResourceBarrier(static_cast<UINT>(m_Barriers.size()), m_Barriers.data());
+	}
+
+	void DirectXRhiCommandList::DrawIndexedInstanced(const uint32_t pIndexCount, const uint32_t pInstanceCount,
+	                                                 const uint32_t pStartIndex, const int32_t pBaseVertex,
+	                                                 const uint32_t pStartInstance)
+	{
+		m_List->DrawIndexedInstanced(pIndexCount, pInstanceCount, pStartIndex, pBaseVertex, pStartInstance);
+	}
+
+	void DirectXRhiCommandList::ExecuteIndirect(const RhiCommandSignature& pSignature, const uint32_t pMaxCommandCount,
+	                                            const RhiBuffer& pArguments, const uint64_t pArgumentOffset,
+	                                            const RhiBuffer* pCount, const uint64_t pCountOffset)
+	{
+		m_List->ExecuteIndirect(static_cast<const DirectXRhiCommandSignature&>(pSignature).GetCommandSignature(),
+		                        pMaxCommandCount, static_cast<const DirectXRhiBuffer&>(pArguments).GetResource(),
+		                        pArgumentOffset,
+		                        pCount ? static_cast<const DirectXRhiBuffer*>(pCount)->GetResource() : nullptr,
+		                        pCountOffset);
+	}
+
+	void DirectXRhiCommandList::Dispatch(const uint32_t pGroupCountX, const uint32_t pGroupCountY,
+	                                     const uint32_t pGroupCountZ)
+	{
+		m_List->Dispatch(pGroupCountX, pGroupCountY, pGroupCountZ);
+	}
+
+	void DirectXRhiCommandList::CopyBufferRegion(const RhiBuffer& pDestination, const uint64_t pDestinationOffset,
+	                                             const RhiBuffer& pSource, const uint64_t pSourceOffset,
+	                                             const uint64_t pSize)
+	{
+		m_List->CopyBufferRegion(static_cast<const DirectXRhiBuffer&>(pDestination).GetResource(), pDestinationOffset,
+		                         static_cast<const DirectXRhiBuffer&>(pSource).GetResource(), pSourceOffset, pSize);
+	}
+
+	void DirectXRhiCommandList::CopyBufferToTexture(const RhiTexture& pDestination, const uint32_t pSubresource,
+	                                                const RhiBuffer& pSource, const uint64_t pSourceOffset,
+	                                                const RhiTextureFootprint& pFootprint)
+	{
+		ID3D12Resource* texture = static_cast<const DirectXRhiTexture&>(pDestination).GetResource();
+		D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint = {};
+		footprint.Offset = pSourceOffset;
+		footprint.Footprint = {
+			texture->GetDesc().Format, pFootprint.Width, pFootprint.Height, pFootprint.Depth, pFootprint.RowPitch
+		};
+		const CD3DX12_TEXTURE_COPY_LOCATION destination(texture, pSubresource);
+		const CD3DX12_TEXTURE_COPY_LOCATION source(static_cast<const DirectXRhiBuffer&>(pSource).GetResource(),
+		                                           footprint);
+		m_List->CopyTextureRegion(&destination, 0, 0, 0, &source, nullptr);
+	}
+
+	// ===== Queue =====
+
+	DirectXRhiCommandQueue::DirectXRhiCommandQueue(ID3D12Device* pDevice,
+	                                               Microsoft::WRL::ComPtr<ID3D12CommandQueue> pQueue)
+		: m_Queue(std::move(pQueue)), m_FlushFence(pDevice, 0)
+	{
+	}
+
+	void DirectXRhiCommandQueue::Execute(RhiCommandList* const* pLists, const uint32_t pCount)
+	{
+		// One submission for all the lists, each call has a fixed cost on the CPU and the GPU.
+		m_ExecuteLists.resize(pCount);
+		for (uint32_t i = 0; i < pCount; ++i)
+			m_ExecuteLists[i] = static_cast<DirectXRhiCommandList*>(pLists[i])->GetList();
+		m_Queue->ExecuteCommandLists(pCount, m_ExecuteLists.data());
+	}
+
+	void DirectXRhiCommandQueue::Signal(RhiFence& pFence, const uint64_t pValue)
+	{
+		THROW_IF_FAILED(m_Queue->Signal(static_cast<DirectXRhiFence&>(pFence).GetFence(), pValue));
+	}
+
+	void DirectXRhiCommandQueue::Wait(RhiFence& pFence, const uint64_t pValue)
+	{
+		THROW_IF_FAILED(m_Queue->Wait(static_cast<DirectXRhiFence&>(pFence).GetFence(), pValue));
+	}
+
+	void DirectXRhiCommandQueue::Flush()
+	{
+		Signal(m_FlushFence, ++m_FlushValue);
+		m_FlushFence.Wait(m_FlushValue);
+	}
+
+	// ===== Swapchain =====
+
+	DirectXRhiSwapchain::DirectXRhiSwapchain(DirectXSwapchain& pSwapchain)
+		: m_Swapchain(pSwapchain)
+	{
+		UpdateViewport();
+	}
+
+	const RhiTexture& DirectXRhiSwapchain::GetCurrentBackBuffer()
+	{
+		RhiTextureDesc desc;
+		desc.Width = static_cast<uint32_t>(m_Viewport.Width);
+		desc.Height = static_cast<uint32_t>(m_Viewport.Height);
+		desc.Format = RhiFormat::R8G8B8A8Unorm;
+		desc.IsRenderTarget = true;
+		m_BackBuffer.Wrap(m_Swapchain.GetCurrentBackBuffer(), m_Swapchain.GetCurrentBackBufferView(), desc);
+		return m_BackBuffer;
+	}
+
+	void DirectXRhiSwapchain::Resize(const uint32_t pWidth, const uint32_t pHeight)
+	{
+		m_Swapchain.Resize(pWidth, pHeight);
+		UpdateViewport();
+	}
+
+	void DirectXRhiSwapchain::Present()
+	{
+		m_Swapchain.Present();
+	}
+
+	void DirectXRhiSwapchain::UpdateViewport()
+	{
+		const D3D12_VIEWPORT& viewport = m_Swapchain.GetViewport();
+		const D3D12_RECT& rect = m_Swapchain.GetScissorRect();
+		m_Viewport = {
+			viewport.TopLeftX, viewport.TopLeftY, viewport.Width, viewport.Height, viewport.MinDepth, viewport.MaxDepth
+		};
+		m_ScissorRect = {rect.left, rect.top, rect.right, rect.bottom};
+	}
+
+	// ===== Device =====
+
+	DirectXRhiDevice::DirectXRhiDevice(ID3D12Device* pDevice, DirectXCommandObject& pCommandObject,
+	                                   DirectXSwapchain& pSwapchain)
+		: m_Device(pDevice),
+		  m_MemoryAllocator([this](const RhiMemoryPool pPool, const uint32_t pHeap, const uint64_t pSize)
+		                    {
+			                    D3D12_HEAP_DESC heapDesc = {};
+			                    heapDesc.SizeInBytes = pSize;
+			                    heapDesc.Alignment = k_RhiResourcePlacementAlignment;
+			                    heapDesc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS;
+			                    D3D12_HEAP_TYPE heapType = D3D12_HEAP_TYPE_DEFAULT;
+			                    if (pPool == RhiMemoryPool::UploadBuffers)
+				                    heapType = D3D12_HEAP_TYPE_UPLOAD;
+			                    else if (pPool == RhiMemoryPool::ReadbackBuffers)
+				                    heapType = D3D12_HEAP_TYPE_READBACK;
+			                    else if (pPool == RhiMemoryPool::Textures)
+				                    heapDesc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES;
+			                    heapDesc.Properties = CD3DX12_HEAP_PROPERTIES(heapType);
+
+			                    auto& heaps = m_Heaps[static_cast<size_t>(pPool)];
+			                    if (heaps.size() <= pHeap)
+				                    heaps.resize(pHeap + 1);
+			                    THROW_IF_FAILED(m_Device->CreateHeap(&heapDesc, IID_PPV_ARGS(heaps[pHeap].GetAddressOf())));
+		                    },
+		                    [this](const RhiMemoryPool pPool, const uint32_t pHeap)
+		                    {
+			                    m_Heaps[static_cast<size_t>(pPool)][pHeap].Reset();
+		                    }),
+		  m_GraphicsQueue(pDevice, pCommandObject.GetCommandQueue()),
+		  m_CopyQueue(pDevice, [pDevice]
+		  {
+			  D3D12_COMMAND_QUEUE_DESC queueDesc = {};
+			  queueDesc.Type = D3D12_COMMAND_LIST_TYPE_COPY;
+			  queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+			  Microsoft::WRL::ComPtr<ID3D12CommandQueue> queue;
+			  THROW_IF_FAILED(pDevice->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&queue)));
+			  return queue;
+		  }()),
+		  m_Swapchain(pSwapchain),
+		  m_CommandList(*this, pCommandObject.GetCommandList()),
+		  m_CommandAllocator(pCommandObject.GetCommandAllocator())
+	{
+	}
+
+	std::unique_ptr<RhiBuffer> DirectXRhiDevice::CreateBuffer(const RhiBufferDesc& pDesc)
+	{
+		return std::make_unique<DirectXRhiBuffer>(*this, pDesc);
+	}
+
+	std::unique_ptr<RhiTexture> DirectXRhiDevice::CreateTexture(const RhiTextureDesc& pDesc)
+	{
+		return std::make_unique<DirectXRhiTexture>(*this, pDesc);
+	}
+
+	std::unique_ptr<RhiPipeline> DirectXRhiDevice::CreatePipeline(const RhiPipelineDesc& pDesc)
+	{
+		return std::make_unique<DirectXRhiPipeline>(m_Device, GetRootSignature(pDesc), pDesc);
+	}
+
+	std::unique_ptr<RhiCommandSignature> DirectXRhiDevice::CreateCommandSignature(const RhiCommandSignatureDesc& pDesc,
+	                                                                              const RhiPipeline* pPipeline)
+	{
+		return std::make_unique<DirectXRhiCommandSignature>(m_Device, pDesc,
+		                                                    static_cast<const DirectXRhiPipeline*>(pPipeline));
+	}
+
+	Microsoft::WRL::ComPtr<ID3D12RootSignature> DirectXRhiDevice::GetRootSignature(const RhiPipelineDesc& pDesc)
+	{
+		std::vector<CD3DX12_ROOT_PARAMETER> parameters(pDesc.RootParameters.size());
+		std::vector<CD3DX12_DESCRIPTOR_RANGE> ranges(pDesc.RootParameters.size());
+		for (size_t i = 0; i < pDesc.RootParameters.size(); ++i)
+		{
+			const RhiRootParameter& parameter = pDesc.RootParameters[i];
+			const D3D12_SHADER_VISIBILITY visibility = ToD3D12Visibility(parameter.Visibility);
+			switch (parameter.Type)
+			{
+			case RhiRootParameterType::ConstantBuffer:
+				parameters[i].InitAsConstantBufferView(parameter.ShaderRegister, parameter.RegisterSpace, visibility);
+				break;
+			case RhiRootParameterType::DescriptorTable:
+				// UINT_MAX is also D3D12's unbounded range.
+				ranges[i].Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, parameter.DescriptorCount, parameter.ShaderRegister,
+				               parameter.RegisterSpace);
+				parameters[i].InitAsDescriptorTable(1, &ranges[i], visibility);
+				break;
+			case RhiRootParameterType::ShaderResource:
+				parameters[i].InitAsShaderResourceView(parameter.ShaderRegister, parameter.RegisterSpace, visibility);
+				break;
+			case RhiRootParameterType::UnorderedAccess:
+				parameters[i].InitAsUnorderedAccessView(parameter.ShaderRegister, parameter.RegisterSpace, visibility);
+				break;
+			case RhiRootParameterType::Constants:
+				parameters[i].InitAsConstants(parameter.ConstantCount, parameter.ShaderRegister,
+				                              parameter.RegisterSpace, visibility);
+				break;
+			}
+		}
+
+		const auto staticSamplers = GetStaticSamplers();
+		const CD3DX12_ROOT_SIGNATURE_DESC rootSigDesc(static_cast<UINT>(parameters.size()), parameters.data(),
+		                                              pDesc.UseStaticSamplers ? staticSamplers.size() : 0,
+		                                              pDesc.UseStaticSamplers ? staticSamplers.data() : nullptr,
+		                                              D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
+
+		Microsoft::WRL::ComPtr<ID3DBlob> serializedRootSig = nullptr;
+		Microsoft::WRL::ComPtr<ID3DBlob> errorBlob = nullptr;
+		const HRESULT hr = D3D12SerializeRootSignature(&rootSigDesc, D3D_ROOT_SIGNATURE_VERSION_1,
+		                                               serializedRootSig.GetAddressOf(), errorBlob.GetAddressOf());
+
+		if (errorBlob != nullptr)
+		{
+			CORE_ERROR(static_cast<char*>(errorBlob->GetBufferPointer()));
+		}
+		THROW_IF_FAILED(hr);
+
+		// Pipelines with the same root parameters share the root signature, so switching between them keeps
+		// the root arguments bound (see RhiCommandList::SetPipelineState).
+		std::string key(static_cast<const char*>(serializedRootSig->GetBufferPointer()),
+		                serializedRootSig->GetBufferSize());
+		Microsoft::WRL::ComPtr<ID3D12RootSignature>& rootSignature = m_RootSignatures[key];
+		if (!rootSignature)
+		{
+			THROW_IF_FAILED(m_Device->CreateRootSignature(
+				0,
+				serializedRootSig->GetBufferPointer(),
+				serializedRootSig->GetBufferSize(),
+				IID_PPV_ARGS(&rootSignature)));
+		}
+		return rootSignature;
+	}
+
+	std::unique_ptr<RhiHeap> DirectXRhiDevice::CreateRenderTargetHeap(const uint64_t pSize)
+	{
+		return std::make_unique<DirectXRhiHeap>(m_Device, pSize);
+	}
+
+	RhiResourceAllocationInfo DirectXRhiDevice::GetTextureAllocationInfo(const RhiTextureDesc& pDesc)
+	{
+		const D3D12_RESOURCE_DESC textureDesc = ToD3D12TextureDesc(pDesc);
+		const D3D12_RESOURCE_ALLOCATION_INFO info = m_Device->GetResourceAllocationInfo(0, 1, &textureDesc);
+		return {info.SizeInBytes, info.Alignment};
+	}
+
+	std::unique_ptr<RhiTexture> DirectXRhiDevice::CreatePlacedTexture(const RhiTextureDesc& pDesc, RhiHeap& pHeap,
+	                                                                  const uint64_t pOffset)
+	{
+		return std::make_unique<DirectXRhiTexture>(*this, pDesc, static_cast<const DirectXRhiHeap&>(pHeap), pOffset);
+	}
+
+	std::unique_ptr<RhiFence> DirectXRhiDevice::CreateFence(const uint64_t pInitialValue)
+	{
+		return std::make_unique<DirectXRhiFence>(m_Device, pInitialValue);
+	}
+
+	std::unique_ptr<RhiCommandAllocator> DirectXRhiDevice::CreateCommandAllocator(const RhiQueueType pType)
+	{
+		Microsoft::WRL::ComPtr<ID3D12CommandAllocator> allocator;
+		THROW_IF_FAILED(m_Device->CreateCommandAllocator(
+			pType == RhiQueueType::Copy ? D3D12_COMMAND_LIST_TYPE_COPY : D3D12_COMMAND_LIST_TYPE_DIRECT,
+			IID_PPV_ARGS(allocator.GetAddressOf())));
+		return std::make_unique<DirectXRhiCommandAllocator>(allocator);
+	}
+
+	std::unique_ptr<RhiCommandList> DirectXRhiDevice::CreateCommandList(const RhiQueueType pType)
+	{
+		const D3D12_COMMAND_LIST_TYPE type = pType == RhiQueueType::Copy
+			                                     ? D3D12_COMMAND_LIST_TYPE_COPY
+			                                     : D3D12_COMMAND_LIST_TYPE_DIRECT;
+
+		// A list is created open on a temporary allocator, closed so Begin() can reset it on the caller's one.
+		Microsoft::WRL::ComPtr<ID3D12CommandAllocator> allocator;
+		THROW_IF_FAILED(m_Device->CreateCommandAllocator(type, IID_PPV_ARGS(allocator.GetAddressOf())));
+		Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> list;
+		THROW_IF_FAILED(m_Device->CreateCommandList(0, type, allocator.Get(), nullptr,
+			IID_PPV_ARGS(list.GetAddressOf())));
+		THROW_IF_FAILED(list->Close());
+		return std::make_unique<DirectXRhiCommandList>(*this, list);
+	}
+
+	void DirectXRhiDevice::WriteBuffer(RhiBuffer& pBuffer, const uint64_t pOffset, const void* pData,
+	                                   const uint64_t pSize)
+	{
+		memcpy(pBuffer.GetMappedData() + pOffset, pData, pSize);
+	}
+
+	uint64_t DirectXRhiDevice::GetTextureFootprints(const RhiTexture& pTexture,
+	                                                std::vector<RhiTextureFootprint>& pOutFootprints)
+	{
+		const D3D12_RESOURCE_DESC desc = static_cast<const DirectXRhiTexture&>(pTexture).GetResource()->GetDesc();
+		const uint32_t subresourceCount = desc.MipLevels *
+			(desc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D ? 1u : desc.DepthOrArraySize);
+
+		std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> layouts(subresourceCount);
+		std::vector<UINT> rowCounts(subresourceCount);
+		std::vector<UINT64> rowSizes(subresourceCount);
+		UINT64 totalBytes = 0;
+		m_Device->GetCopyableFootprints(&desc, 0, subresourceCount, 0, layouts.data(), rowCounts.data(),
+		                                rowSizes.data(), &totalBytes);
+
+		pOutFootprints.resize(subresourceCount);
+		for (uint32_t i = 0; i < subresourceCount; ++i)
+		{
+			const D3D12_SUBRESOURCE_FOOTPRINT& footprint = layouts[i].Footprint;
+			pOutFootprints[i] = {
+				layouts[i].Offset, footprint.Width, footprint.Height, footprint.Depth, footprint.RowPitch, rowCounts[i],
+				rowSizes[i]
+			};
+		}
+		return totalBytes;
+	}
+
+	RhiCommandQueue& DirectXRhiDevice::GetQueue(const RhiQueueType pType)
+	{
+		return pType == RhiQueueType::Copy ? m_CopyQueue : m_GraphicsQueue;
+	}
+}
@@ -0,0 +1,320 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+
+#include "RhiDevice.h"
+#include "Renderer/DirectXContext.h"
+
+namespace Engine
+{
+	class DirectXCommandObject;
+	class DirectXSwapchain;
+	class DirectXRhiDevice;
+
+	DXGI_FORMAT ToDxgiFormat(RhiFormat pFormat);
+	D3D12_RESOURCE_STATES ToD3D12State(RhiResourceState pState);
+
+	class DirectXRhiBuffer : public RhiBuffer
+	{
+	public:
+		/// <summary>
+		/// Places the buffer in a heap of the device's memory allocator, committed when it gets a dedicated
+		/// allocation.
+		/// </summary>
+		DirectXRhiBuffer(DirectXRhiDevice& pDevice, const RhiBufferDesc& pDesc);
+		~DirectXRhiBuffer() override;
+
+		ID3D12Resource* GetResource() const { return m_Resource.Get(); }
+		const RhiMemoryAllocation& GetAllocation() const { return m_Allocation; }
+
+	private:
+		Microsoft::WRL::ComPtr<ID3D12Resource> m_Resource;
+		RhiMemoryAllocator& m_Allocator;
+		RhiMemoryAllocation m_Allocation;
+	};
+
+	class DirectXRhiHeap : public RhiHeap
+	{
+	public:
+		/// <summary>
+		/// A default heap that only holds render targets and depth stencils, as the first resource heap tier requires.
+		/// </summary>
+		DirectXRhiHeap(ID3D12Device* pDevice, uint64_t pSize);
+
+		ID3D12Heap* GetHeap() const { return m_Heap.Get(); }
+
+	private:
+		Microsoft::WRL::ComPtr<ID3D12Heap> m_Heap;
+	};
+
+	class DirectXRhiTexture : public RhiTexture
+	{
+	public:
+		DirectXRhiTexture() = default;
+		/// <summary>
+		/// Places the texture in a heap of the device's memory allocator. Render targets and depth stencils stay
+		/// committed : a placed one would have to be cleared before its first use.
+		/// </summary>
+		DirectXRhiTexture(DirectXRhiDevice& pDevice, const RhiTextureDesc& pDesc);
+		/// <summary>
+		/// Places a render target or depth stencil at pOffset in pHeap, see RhiDevice::CreatePlacedTexture.
+		/// </summary>
+		DirectXRhiTexture(DirectXRhiDevice& pDevice, const RhiTextureDesc& pDesc, const DirectXRhiHeap& pHeap,
+		                  uint64_t pOffset);
+		~DirectXRhiTexture() override;
+		DirectXRhiTexture(const DirectXRhiTexture&) = delete;
+		DirectXRhiTexture& operator=(const DirectXRhiTexture&) = delete;
+
+		/// <summary>
+		/// Points the texture at a resource owned elsewhere (ex. a swapchain buffer). No reference is kept,
+		/// so the swapchain can still release its buffers on resize.
+		/// </summary>
+		void Wrap(ID3D12Resource* pResource, D3D12_CPU_DESCRIPTOR_HANDLE pView, const RhiTextureDesc& pDesc);
+
+		ID3D12Resource* GetResource() const { return m_Resource; }
+		/// <returns> The render target or depth stencil view. </returns>
+		D3D12_CPU_DESCRIPTOR_HANDLE GetView() const { return m_View; }
+
+	private:
+		// The render target or depth stencil view of m_Resource, in a descriptor heap of its own.
+		void CreateView(ID3D12Device* pDevice);
+
+		ID3D12Resource* m_Resource = nullptr;
+		Microsoft::WRL::ComPtr<ID3D12Resource> m_OwnedResource;
+		Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> m_ViewHeap;
+		D3D12_CPU_DESCRIPTOR_HANDLE m_View = {};
+		// Null for committed and wrapped textures.
+		RhiMemoryAllocator* m_Allocator = nullptr;
+		RhiMemoryAllocation m_Allocation;
+	};
+
+	class DirectXRhiPipeline : public RhiPipeline
+	{
+	public:
+		DirectXRhiPipeline(ID3D12Device* pDevice, Microsoft::WRL::ComPtr<ID3D12RootSignature> pRootSignature,
+		                   const RhiPipelineDesc& pDesc);
+
+		const void* GetRootSignatureId() const override { return m_RootSignature.Get(); }
+		std::vector<uint8_t> GetCachedBlob() const override;
+		bool IsFromCachedBlob() const override { return m_IsFromCachedBlob; }
+		ID3D12RootSignature* GetRootSignature() const { return m_RootSignature.Get(); }
+		ID3D12PipelineState* GetPipelineState() const { return m_PipelineState.Get(); }
+		bool IsCompute() const { return m_IsCompute; }
+
+	private:
+		Microsoft::WRL::ComPtr<ID3D12RootSignature> m_RootSignature;
+		Microsoft::WRL::ComPtr<ID3D12PipelineState> m_PipelineState;
+		bool m_IsFromCachedBlob = false;
+		bool m_IsCompute = false;
+	};
+
+	class DirectXRhiCommandSignature : public RhiCommandSignature
+	{
+	public:
+		DirectXRhiCommandSignature(ID3D12Device* pDevice, const RhiCommandSignatureDesc& pDesc,
+		                           const DirectXRhiPipeline* pPipeline);
+
+		ID3D12CommandSignature* GetCommandSignature() const { return m_CommandSignature.Get(); }
+
+	private:
+		Microsoft::WRL::ComPtr<ID3D12CommandSignature> m_CommandSignature;
+	};
+
+	class DirectXRhiFence : public RhiFence
+	{
+	public:
+		DirectXRhiFence(ID3D12Device* pDevice, uint64_t pInitialValue);
+
+		uint64_t GetCompletedValue() const override { return m_Fence->GetCompletedValue(); }
+		void Wait(uint64_t pValue) override;
+
+		ID3D12Fence* GetFence() const { return m_Fence.Get(); }
+
+	private:
+		Microsoft::WRL::ComPtr<ID3D12Fence> m_Fence;
+	};
+
+	class DirectXRhiCommandAllocator : public RhiCommandAllocator
+	{
+	public:
+		explicit DirectXRhiCommandAllocator(Microsoft::WRL::ComPtr<ID3D12CommandAllocator> pAllocator)
+			: m_Allocator(std::move(pAllocator))
+		{
+		}
+
+		void Reset() override { THROW_IF_FAILED(m_Allocator->Reset()); }
+
+		ID3D12CommandAllocator* GetAllocator() const { return m_Allocator.Get(); }
+
+	private:
+		Microsoft::WRL::ComPtr<ID3D12CommandAllocator> m_Allocator;
+	};
+
+	class DirectXRhiCommandList : public RhiCommandList
+	{
+	public:
+		DirectXRhiCommandList(const DirectXRhiDevice& pDevice, Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> pList)
+			: m_Device(pDevice), m_List(std::move(pList))
+		{
+		}
+
+		/// <summary>
+		/// Resets the list on the allocator, graphics lists also get the device's shader visible heap bound.
+		/// </summary>
+		void Begin(RhiCommandAllocator& pAllocator) override;
+		void End() override;
+
+		void SetPipeline(const RhiPipeline& pPipeline) override;
+		void SetPipelineState(const RhiPipeline& pPipeline) override;
+		void SetGraphicsRootConstantBufferView(uint32_t pSlot, RhiGpuAddress pAddress) override;
+		void SetGraphicsRootDescriptorTable(uint32_t pSlot, RhiDescriptor pDescriptor) override;
+		void SetGraphicsRootShaderResourceView(uint32_t pSlot, RhiGpuAddress pAddress) override;
+		void SetGraphicsRoot32BitConstant(uint32_t pSlot, uint32_t pValue, uint32_t pOffset) override;
+		void SetComputeRootConstantBufferView(uint32_t pSlot, RhiGpuAddress pAddress) override;
+		void SetComputeRootShaderResourceView(uint32_t pSlot, RhiGpuAddress pAddress) override;
+		void SetComputeRootUnorderedAccessView(uint32_t pSlot, RhiGpuAddress pAddress) override;
+
+		void SetVertexBuffer(const RhiVertexBufferView& pView) override;
+		void SetIndexBuffer(const RhiIndexBufferView& pView) override;
+		void SetPrimitiveTopology(RhiPrimitiveTopology pTopology) override;
+
+		void SetViewport(const RhiViewport& pViewport) override;
+		void SetScissorRect(const RhiRect& pRect) override;
+		void SetRenderTarget(const RhiTexture* pColor, const RhiTexture* pDepthStencil) override;
+		void ClearRenderTarget(const RhiTexture& pTarget, const float pColor[4]) override;
+		void ClearDepthStencil(const RhiTexture& pTarget, float pDepth, uint8_t pStencil) override;
+
+		void Barrier(const RhiResource& pResource, RhiResourceState pBefore, RhiResourceState pAfter) override;
+		void UnorderedAccessBarrier(const RhiResource& pResource) override;
+		void Barriers(const RhiBarrier* pBarriers, uint32_t pCount) override;
+
+		void DrawIndexedInstanced(uint32_t pIndexCount, uint32_t pInstanceCount, uint32_t pStartIndex,
+		                          int32_t pBaseVertex, uint32_t pStartInstance) override;
+		void ExecuteIndirect(const RhiCommandSignature& pSignature, uint32_t pMaxCommandCount,
+		                     const RhiBuffer& pArguments, uint64_t pArgumentOffset, const RhiBuffer* pCount,
+		                     uint64_t pCountOffset) override;
+		void Dispatch(uint32_t pGroupCountX, uint32_t pGroupCountY, uint32_t pGroupCountZ) override;
+
+		void CopyBufferRegion(const RhiBuffer& pDestination, uint64_t pDestinationOffset, const RhiBuffer& pSource,
+		                      uint64_t pSourceOffset, uint64_t pSize) override;
+		void CopyBufferToTexture(const RhiTexture& pDestination, uint32_t pSubresource, const RhiBuffer& pSource,
+		                         uint64_t pSourceOffset, const RhiTextureFootprint& pFootprint) override;
+
+		ID3D12GraphicsCommandList* GetList() const { return m_List.Get(); }
+
+	private:
+		const DirectXRhiDevice& m_Device;
+		Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> m_List;
+		// Kept between calls so a batch of barriers does not allocate.
+		std::vector<D3D12_RESOURCE_BARRIER> m_Barriers;
+	};
+
+	class DirectXRhiCommandQueue : public RhiCommandQueue
+	{
+	public:
+		DirectXRhiCommandQueue(ID3D12Device* pDevice, Microsoft::WRL::ComPtr<ID3D12CommandQueue> pQueue);
+
+		void Execute(RhiCommandList* const* pLists, uint32_t pCount) override;
+		void Signal(RhiFence& pFence, uint64_t pValue) override;
+		void Wait(RhiFence& pFence, uint64_t pValue) override;
+		void Flush() override;
+
+		ID3D12CommandQueue* GetQueue() const { return m_Queue.Get(); }
+
+	private:
+		Microsoft::WRL::ComPtr<ID3D12CommandQueue> m_Queue;
+		// Kept between calls so a submission does not allocate.
+		std::vector<ID3D12CommandList*> m_ExecuteLists;
+		DirectXRhiFence m_FlushFence;
+		uint64_t m_FlushValue = 0;
+	};
+
+	/// <summary>
+	/// Exposes the DirectXSwapchain buffers as RHI textures.
+	/// </summary>
+	class DirectXRhiSwapchain : public RhiSwapchain
+	{
+	public:
+		explicit DirectXRhiSwapchain(DirectXSwapchain& pSwapchain);
+
+		const RhiTexture& GetCurrentBackBuffer() override;
+
+		const RhiViewport& GetViewport() const override { return m_Viewport; }
+		const RhiRect& GetScissorRect() const override { return m_ScissorRect; }
+
+		void Resize(uint32_t pWidth, uint32_t pHeight) override;
+		void Present() override;
+
+	private:
+		void UpdateViewport();
+
+		DirectXSwapchain& m_Swapchain;
+		DirectXRhiTexture m_BackBuffer;
+		RhiViewport m_Viewport;
+		RhiRect m_ScissorRect;
+	};
+
+	/// <summary>
+	/// D3D12 implementation of the RHI, built on top of the objects created by DirectXContext.
+	/// </summary>
+	class DirectXRhiDevice : public RhiDevice
+	{
+	public:
+		DirectXRhiDevice(ID3D12Device* pDevice, DirectXCommandObject& pCommandObject, DirectXSwapchain& pSwapchain);
+
+		std::unique_ptr<RhiBuffer> CreateBuffer(const RhiBufferDesc& pDesc) override;
+		std::unique_ptr<RhiTexture> CreateTexture(const RhiTextureDesc& pDesc) override;
+		std::unique_ptr<RhiPipeline> CreatePipeline(const RhiPipelineDesc& pDesc) override;
+		std::unique_ptr<RhiCommandSignature> CreateCommandSignature(const RhiCommandSignatureDesc& pDesc,
+		                                                            const RhiPipeline* pPipeline) override;
+		std::unique_ptr<RhiHeap> CreateRenderTargetHeap(uint64_t pSize) override;
+		RhiResourceAllocationInfo GetTextureAllocationInfo(const RhiTextureDesc& pDesc) override;
+		std::unique_ptr<RhiTexture> CreatePlacedTexture(const RhiTextureDesc& pDesc, RhiHeap& pHeap,
+		                                                uint64_t pOffset) override;
+		std::unique_ptr<RhiFence> CreateFence(uint64_t pInitialValue) override;
+		std::unique_ptr<RhiCommandAllocator> CreateCommandAllocator(RhiQueueType pType) override;
+		std::unique_ptr<RhiCommandList> CreateCommandList(RhiQueueType pType) override;
+
+		void WriteBuffer(RhiBuffer& pBuffer, uint64_t pOffset, const void* pData, uint64_t pSize) override;
+		uint64_t GetTextureFootprints(const RhiTexture& pTexture,
+		                              std::vector<RhiTextureFootprint>& pOutFootprints) override;
+
+		RhiCommandQueue& GetQueue(RhiQueueType pType) override;
+		RhiSwapchain& GetSwapchain() override { return m_Swapchain; }
+		RhiMemoryAllocator& GetMemoryAllocator() override { return m_MemoryAllocator; }
+
+		RhiCommandList& GetCommandList() override { return m_CommandList; }
+		RhiCommandAllocator& GetCommandAllocator() override { return m_CommandAllocator; }
+
+		/// <summary>
+		/// Descriptor heap bound by every graphics list's Begin(), so lists recorded on other threads see the same
+		/// descriptors as the frame's list.
+		/// </summary>
+		void SetShaderVisibleHeap(ID3D12DescriptorHeap* pHeap) { m_ShaderVisibleHeap = pHeap; }
+		ID3D12DescriptorHeap* GetShaderVisibleHeap() const { return m_ShaderVisibleHeap; }
+
+		ID3D12Device* GetDevice() const { return m_Device; }
+		/// <returns> The heap of the memory allocator an allocation is placed in. </returns>
+		ID3D12Heap* GetHeap(const RhiMemoryAllocation& pAllocation) const
+		{
+			return m_Heaps[static_cast<size_t>(pAllocation.Pool)][pAllocation.Heap].Get();
+		}
+
+	private:
+		/// <returns> The root signature of the description's root parameters, created on first use. </returns>
+		Microsoft::WRL::ComPtr<ID3D12RootSignature> GetRootSignature(const RhiPipelineDesc& pDesc);
+
+		ID3D12Device* m_Device;
+		// Heaps of the memory allocator, by pool then index, released ones are null.
+		std::vector<Microsoft::WRL::ComPtr<ID3D12Heap>> m_Heaps[static_cast<size_t>(RhiMemoryPool::Count)];
+		RhiMemoryAllocator m_MemoryAllocator;
+		// Serialized root signature to the one created from it.
+		std::unordered_map<std::string, Microsoft::WRL::ComPtr<ID3D12RootSignature>> m_RootSignatures;
+		DirectXRhiCommandQueue m_GraphicsQueue;
+		DirectXRhiCommandQueue m_CopyQueue;
+		DirectXRhiSwapchain m_Swapchain;
+		DirectXRhiCommandList m_CommandList;
+		DirectXRhiCommandAllocator m_CommandAllocator;
+		ID3D12DescriptorHeap* m_ShaderVisibleHeap = nullptr;
+	};
+}
@@ -0,0 +1,671 @@
+#include "NullRhi.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Engine
+{
+	NullRhiStats& NullRhiStats::operator+=(const NullRhiStats& pOther)
+	{
+		CommandCount += pOther.CommandCount;
+		DrawCount += pOther.DrawCount;
+		InstanceCount += pOther.InstanceCount;
+		IndexCount += pOther.IndexCount;
+		PipelineBinds += pOther.PipelineBinds;
+		RootSignatureBinds += pOther.RootSignatureBinds;
+		ConstantBufferBinds += pOther.ConstantBufferBinds;
+		DescriptorTableBinds += pOther.DescriptorTableBinds;
+		ShaderResourceBinds += pOther.ShaderResourceBinds;
+		RootConstantBinds += pOther.RootConstantBinds;
+		UnorderedAccessBinds += pOther.UnorderedAccessBinds;
+		VertexBufferBinds += pOther.VertexBufferBinds;
+		IndexBufferBinds += pOther.IndexBufferBinds;
+		BarrierCount += pOther.BarrierCount;
+		BarrierBatchCount += pOther.BarrierBatchCount;
+		DispatchCount += pOther.DispatchCount;
+		ExecuteIndirectCount += pOther.ExecuteIndirectCount;
+		CopiedBytes += pOther.CopiedBytes;
+		UploadedBytes += pOther.UploadedBytes;
+		ExecutedListCount += pOther.ExecutedListCount;
+		ExecuteCount += pOther.ExecuteCount;
+		QueueWaitCount += pOther.QueueWaitCount;
+		PresentCount += pOther.PresentCount;
+		return *this;
+	}
+
+	// ===== Resources =====
+
+	NullRhiBuffer::NullRhiBuffer(const RhiBufferDesc& pDesc, const RhiGpuAddress pAddress)
+		: m_Storage(pDesc.Size)
+	{
+		m_Desc = pDesc;
+		m_GpuAddress = pAddress;
+		if (pDesc.Heap != RhiHeapType::Default)
+			m_MappedData = m_Storage.data();
+	}
+
+	NullRhiBuffer::~NullRhiBuffer()
+	{
+		if (m_Allocator)
+			m_Allocator->Free(m_Allocation);
+	}
+
+	void NullRhiBuffer::SetAllocation(RhiMemoryAllocator& pAllocator, const RhiMemoryAllocation& pAllocation,
+	                                  const RhiGpuAddress pAddress)
+	{
+		m_Allocator = &pAllocator;
+		m_Allocation = pAllocation;
+		m_GpuAddress = pAddress;
+	}
+
+	NullRhiTexture::~NullRhiTexture()
+	{
+		if (m_Allocator)
+			m_Allocator->Free(m_Allocation);
+	}
+
+	void NullRhiTexture::SetAllocation(RhiMemoryAllocator& pAllocator, const RhiMemoryAllocation& pAllocation)
+	{
+		m_Allocator = &pAllocator;
+		m_Allocation = pAllocation;
+	}
+
+	std::vector<uint8_t>& NullRhiTexture::GetSubresource(const uint32_t pIndex)
+	{
+		if (pIndex >= m_Subresources.size())
+			m_Subresources.resize(pIndex + 1);
+		return m_Subresources[pIndex];
+	}
+
+	namespace
+	{
+		// The null backend compiles nothing, its blobs only tell which backend wrote them.
+		constexpr char k_CachedBlobTag[] = "NullRhiPipeline";
+
+		uint32_t GetTexelSize(const RhiFormat pFormat)
+		{
+			switch (pFormat)
+			{
+			case RhiFormat::R16Uint: return 2;
+			case RhiFormat::R32G32Float: return 8;
+			case RhiFormat::R32G32B32Float: return 12;
+			case RhiFormat::R32G32B32A32Float: return 16;
+			default: return 4;
+			}
+		}
+	}
+
+	NullRhiPipeline::NullRhiPipeline(const RhiPipelineDesc& pDesc, const void* pRootSignatureId)
+		: m_Desc(pDesc), m_RootSignatureId(pRootSignatureId)
+	{
+		m_IsFromCachedBlob = pDesc.CachedBlob.Size == sizeof(k_CachedBlobTag) &&
+			std::memcmp(pDesc.CachedBlob.Data, k_CachedBlobTag, sizeof(k_CachedBlobTag)) == 0;
+
+		// The bytecode is only valid during CreatePipeline.
+		m_Desc.VertexShader = {};
+		m_Desc.PixelShader = {};
+		m_Desc.ComputeShader = {};
+		m_Desc.CachedBlob = {};
+	}
+
+	std::vector<uint8_t> NullRhiPipeline::GetCachedBlob() const
+	{
+		return {k_CachedBlobTag, k_CachedBlobTag + sizeof(k_CachedBlobTag)};
+	}
+
+	// ===== Command list =====
+
+	NullRhiCommand& NullRhiCommandList::Record(const NullRhiCommandType pType)
+	{
+		++m_Stats.CommandCount;
+		if (!m_IsRecording)
+		{
+			// The caller fills a scratch command that is never read.
+			static thread_local NullRhiCommand scratch;
+			scratch = {pType};
+			return scratch;
+		}
+		return m_Commands.emplace_back(NullRhiCommand{pType});
+	}
+
+	void NullRhiCommandList::Begin(RhiCommandAllocator& pAllocator)
+	{
+		m_Commands.clear();
+		m_Copies.clear();
+		m_TextureCopies.clear();
+		m_Stats = NullRhiStats();
+		m_IsOpen = true;
+	}
+
+	void NullRhiCommandList::End()
+	{
+		m_IsOpen = false;
+	}
+
+	void NullRhiCommandList::SetPipeline(const RhiPipeline& pPipeline)
+	{
+		Record(NullRhiCommandType::SetPipeline).Object = &pPipeline;
+		++m_Stats.PipelineBinds;
+		++m_Stats.RootSignatureBinds;
+	}
+
+	void NullRhiCommandList::SetPipelineState(const RhiPipeline& pPipeline)
+	{
+		Record(NullRhiCommandType::SetPipelineState).Object = &pPipeline;
+		++m_Stats.PipelineBinds;
+	}
+
+	void NullRhiCommandList::SetGraphicsRootConstantBufferView(const uint32_t pSlot, const RhiGpuAddress pAddress)
+	{
+		NullRhiCommand& command = Record(NullRhiCommandType::SetRootConstantBuffer);
+		command.Slot = pSlot;
+		command.Args[0] = pAddress;
+		++m_Stats.ConstantBufferBinds;
+	}
+
+	void NullRhiCommandList::SetGraphicsRootDescriptorTable(const uint32_t pSlot, const RhiDescriptor pDescriptor)
+	{
+		NullRhiCommand& command = Record(NullRhiCommandType::SetRootDescriptorTable);
+		command.Slot = pSlot;
+		command.Args[0] = pDescriptor;
+		++m_Stats.DescriptorTableBinds;
+	}
+
+	void NullRhiCommandList::SetGraphicsRootShaderResourceView(const uint32_t pSlot, const RhiGpuAddress pAddress)
+	{
+		NullRhiCommand& command = Record(NullRhiCommandType::SetRootShaderResource);
+		command.Slot = pSlot;
+		command.Args[0] = pAddress;
+		++m_Stats.ShaderResourceBinds;
+	}
+
+	void NullRhiCommandList::SetGraphicsRoot32BitConstant(const uint32_t pSlot, const uint32_t pValue,
+	                                                      const uint32_t pOffset)
+	{
+		NullRhiCommand& command = Record(NullRhiCommandType::SetRootConstant);
+		command.Slot = pSlot;
+		command.Args[0] = pValue;
+		command.Args[1] = pOffset;
+		++m_Stats.RootConstantBinds;
+	}
+
+	void NullRhiCommandList::SetComputeRootConstantBufferView(const uint32_t pSlot, const RhiGpuAddress pAddress)
+	{
+		NullRhiCommand& command = Record(NullRhiCommandType::SetComputeRootConstantBuffer);
+		command.Slot = pSlot;
+		command.Args[0] = pAddress;
+		++m_Stats.ConstantBufferBinds;
+	}
+
+	void NullRhiCommandList::SetComputeRootShaderResourceView(const uint32_t pSlot, const RhiGpuAddress pAddress)
+	{
+		NullRhiCommand& command = Record(NullRhiCommandType::SetComputeRootShaderResource);
+		command.Slot = pSlot;
+		command.Args[0] = pAddress;
+		++m_Stats.ShaderResourceBinds;
+	}
+
+	void NullRhiCommandList::SetComputeRootUnorderedAccessView(const uint32_t pSlot, const RhiGpuAddress pAddress)
+	{
+		NullRhiCommand& command = Record(NullRhiCommandType::SetComputeRootUnorderedAccess);
+		command.Slot = pSlot;
+		command.Args[0] = pAddress;
+		++m_Stats.UnorderedAccessBinds;
+	}
+
+	void NullRhiCommandList::SetVertexBuffer(const RhiVertexBufferView& pView)
+	{
+		NullRhiCommand& command = Record(NullRhiCommandType::SetVertexBuffer);
+		command.Args[0] = pView.Address;
+		command.Args[1] = pView.Size;
+		command.Args[2] = pView.Stride;
+		++m_Stats.VertexBufferBinds;
+	}
+
+	void NullRhiCommandList::SetIndexBuffer(const RhiIndexBufferView& pView)
+	{
+		NullRhiCommand& command = Record(NullRhiCommandType::SetIndexBuffer);
+		command.Args[0] = pView.Address;
+		command.Args[1] = pView.Size;
+		command.Args[2] = static_cast<uint64_t>(pView.Format);
+		++m_Stats.IndexBufferBinds;
+	}
+
+	void NullRhiCommandList::SetPrimitiveTopology(const RhiPrimitiveTopology pTopology)
+	{
+		Record(NullRhiCommandType::SetPrimitiveTopology).Args[0] = static_cast<uint64_t>(pTopology);
+	}
+
+	void NullRhiCommandList::SetViewport(const RhiViewport& pViewport)
+	{
+		NullRhiCommand& command = Record(NullRhiCommandType::SetViewport);
+		const float values[4] = {pViewport.TopLeftX, pViewport.TopLeftY, pViewport.Width, pViewport.Height};
+		for (int i = 0; i < 4; ++i)
+			std::memcpy(&command.Args[i], &values[i], sizeof(float));
+	}
+
+	void NullRhiCommandList::SetScissorRect(const RhiRect& pRect)
+	{
+		NullRhiCommand& command = Record(NullRhiCommandType::SetScissorRect);
+		command.Args[0] = static_cast<uint64_t>(pRect.Left);
+		command.Args[1] = static_cast<uint64_t>(pRect.Top);
+		command.Args[2] = static_cast<uint64_t>(pRect.Right);
+		command.Args[3] = static_cast<uint64_t>(pRect.Bottom);
+	}
+
+	void NullRhiCommandList::SetRenderTarget(const RhiTexture* pColor, const RhiTexture* pDepthStencil)
+	{
+		NullRhiCommand& command = Record(NullRhiCommandType::SetRenderTarget);
+		command.Object = pColor;
+		command.Object2 = pDepthStencil;
+	}
+
+	void NullRhiCommandList::ClearRenderTarget(const RhiTexture& pTarget, const float pColor[4])
+	{
+		Record(NullRhiCommandType::ClearRenderTarget).Object = &pTarget;
+	}
+
+	void NullRhiCommandList::ClearDepthStencil(const RhiTexture& pTarget, const float pDepth, const uint8_t pStencil)
+	{
+		NullRhiCommand& command = Record(NullRhiCommandType::ClearDepthStencil);
+		command.Object = &pTarget;
+		std::memcpy(&command.Args[0], &pDepth, sizeof(float));
+		command.Args[1] = pStencil;
+	}
+
+	void NullRhiCommandList::Barrier(const RhiResource& pResource, const RhiResourceState pBefore,
+	                                 const RhiResourceState pAfter)
+	{
+		NullRhiCommand& command = Record(NullRhiCommandType::Barrier);
+		command.Object = &pResource;
+		command.Args[0] = static_cast<uint64_t>(pBefore);
+		command.Args[1] = static_cast<uint64_t>(pAfter);
+		++m_Stats.BarrierCount;
+		++m_Stats.BarrierBatchCount;
+	}
+
+	void NullRhiCommandList::UnorderedAccessBarrier(const RhiResource& pResource)
+	{
+		Record(NullRhiCommandType::UnorderedAccessBarrier).Object = &pResource;
+		++m_Stats.BarrierCount;
+		++m_Stats.BarrierBatchCount;
+	}
+
+	void NullRhiCommandList::Barriers(const RhiBarrier* pBarriers, const uint32_t pCount)
+	{
+		for (uint32_t i = 0; i < pCount; ++i)
+		{
+			const RhiBarrier& barrier = pBarriers[i];
+			switch (barrier.Type)
+			{
+			case RhiBarrierType::Transition:
+				{
+					NullRhiCommand& command = Record(NullRhiCommandType::Barrier);
+					command.Object = barrier.Resource;
+					command.Args[0] = static_cast<uint64_t>(barrier.Before);
+					command.Args[1] = static_cast<uint64_t>(barrier.After);
+					break;
+				}
+			case RhiBarrierType::Aliasing:
+				Record(NullRhiCommandType::AliasingBarrier).Object = barrier.Resource;
+				break;
+			case RhiBarrierType::UnorderedAccess:
+				Record(NullRhiCommandType::UnorderedAccessBarrier).Object = barrier.Resource;
+				break;
+			}
+		}
+		m_Stats.BarrierCount += pCount;
+		if (pCount > 0)
+			++m_Stats.BarrierBatchCount;
+	}
+
+	void NullRhiCommandList::DrawIndexedInstanced(const uint32_t pIndexCount, const uint32_t pInstanceCount,
+	                                              const uint32_t pStartIndex, const int32_t pBaseVertex,
+	                                              const uint32_t pStartInstance)
+	{
+		NullRhiCommand& command = Record(NullRhiCommandType::DrawIndexedInstanced);
+		command.Args[0] = pIndexCount;
+		command.Args[1] = pInstanceCount;
+		command.Args[2] = pStartIndex;
+		command.Args[3] = static_cast<uint64_t>(static_cast<int64_t>(pBaseVertex));
+		command.Slot = pStartInstance;
+		++m_Stats.DrawCount;
+		m_Stats.InstanceCount += pInstanceCount;
+		m_Stats.IndexCount += static_cast<uint64_t>(pIndexCount) * pInstanceCount;
+	}
+
+	void NullRhiCommandList::ExecuteIndirect(const RhiCommandSignature& pSignature, const uint32_t pMaxCommandCount,
+	                                         const RhiBuffer& pArguments, const uint64_t pArgumentOffset,
+	                                         const RhiBuffer* pCount, const uint64_t pCountOffset)
+	{
+		NullRhiCommand& command = Record(NullRhiCommandType::ExecuteIndirect);
+		command.Object = &pArguments;
+		command.Object2 = pCount;
+		command.Slot = pMaxCommandCount;
+		command.Args[0] = pArgumentOffset;
+		command.Args[1] = pCountOffset;
+		command.Args[2] = reinterpret_cast<uint64_t>(&pSignature);
+		++m_Stats.ExecuteIndirectCount;
+	}
+
+	void NullRhiCommandList::Dispatch(const uint32_t pGroupCountX, const uint32_t pGroupCountY,
+	                                  const uint32_t pGroupCountZ)
+	{
+		NullRhiCommand& command = Record(NullRhiCommandType::Dispatch);
+		command.Args[0] = pGroupCountX;
+		command.Args[1] = pGroupCountY;
+		command.Args[2] = pGroupCountZ;
+		++m_Stats.DispatchCount;
+	}
+
+	void NullRhiCommandList::CopyBufferRegion(const RhiBuffer& pDestination, const uint64_t pDestinationOffset,
+	                                          const RhiBuffer& pSource, const uint64_t pSourceOffset,
+	                                          const uint64_t pSize)
+	{
+		NullRhiCommand& command = Record(NullRhiCommandType::CopyBufferRegion);
+		command.Object = &pDestination;
+		command.Object2 = &pSource;
+		command.Args[0] = pDestinationOffset;
+		command.Args[1] = pSourceOffset;
+		command.Args[2] = pSize;
+		m_Stats.CopiedBytes += pSize;
+
+		m_Copies.push_back({
+			static_cast<const NullRhiBuffer*>(&pDestination), static_cast<const NullRhiBuffer*>(&pSource),
+			pDestinationOffset, pSourceOffset, pSize
+		});
+	}
+
+	void NullRhiCommandList::CopyBufferToTexture(const RhiTexture& pDestination, const uint32_t pSubresource,
+	                                             const RhiBuffer& pSource, const uint64_t pSourceOffset,
+	                                             const RhiTextureFootprint& pFootprint)
+	{
+		NullRhiCommand& command = Record(NullRhiCommandType::CopyBufferToTexture);
+		command.Object = &pDestination;
+		command.Object2 = &pSource;
+		command.Slot = pSubresource;
+		command.Args[0] = pSourceOffset;
+		command.Args[1] = pFootprint.RowPitch;
+		command.Args[2] = pFootprint.RowCount;
+		command.Args[3] = pFootprint.RowSize;
+		m_Stats.CopiedBytes += pFootprint.RowSize * pFootprint.RowCount * pFootprint.Depth;
+
+		m_TextureCopies.push_back({
+			static_cast<const NullRhiTexture*>(&pDestination), pSubresource,
+			static_cast<const NullRhiBuffer*>(&pSource), pSourceOffset, pFootprint
+		});
+	}
+
+	// ===== Queue =====
+
+	void NullRhiCommandQueue::Execute(RhiCommandList* const* pLists, const uint32_t pCount)
+	{
+		++m_Device.m_Stats.ExecuteCount;
+		for (uint32_t i = 0; i < pCount; ++i)
+		{
+			const NullRhiCommandList& list = *static_cast<const NullRhiCommandList*>(pLists[i]);
+			for (const NullRhiCommandList::PendingCopy& copy : list.m_Copies)
+			{
+				// The GPU is the only writer of a default buffer, so it is fine to write through a const buffer.
+				std::memcpy(const_cast<NullRhiBuffer*>(copy.Destination)->GetStorage().data() + copy.DestinationOffset,
+				            copy.Source->GetStorage().data() + copy.SourceOffset, copy.Size);
+			}
+			for (const NullRhiCommandList::PendingTextureCopy& copy : list.m_TextureCopies)
+			{
+				// Stored without the row padding of the buffer.
+				const RhiTextureFootprint& footprint = copy.Footprint;
+				const uint32_t rows = footprint.RowCount * footprint.Depth;
+				std::vector<uint8_t>& subresource = const_cast<NullRhiTexture*>(copy.Destination)->GetSubresource(
+					copy.Subresource);
+				subresource.resize(footprint.RowSize * rows);
+				for (uint32_t row = 0; row < rows; ++row)
+				{
+					std::memcpy(subresource.data() + row * footprint.RowSize,
+					            copy.Source->GetStorage().data() + copy.SourceOffset + row * footprint.RowPitch,
+					            footprint.RowSize);
+				}
+			}
+
+			m_Device.m_Stats += list.m_Stats;
+			++m_Device.m_Stats.ExecutedListCount;
+		}
+	}
+
+	void NullRhiCommandQueue::Signal(RhiFence& pFence, const uint64_t pValue)
+	{
+		auto& fence = static_cast<NullRhiFence&>(pFence);
+		fence.m_Queue.store(this, std::memory_order_relaxed);
+
+		std::lock_guard lock(m_SignalMutex);
+		m_PendingSignals.push_back({&fence, pValue});
+		Retire(nullptr, 0, m_Latency);
+	}
+
+	void NullRhiCommandQueue::Wait(RhiFence& pFence, const uint64_t pValue)
+	{
+		++m_Device.m_Stats.QueueWaitCount;
+		pFence.Wait(pValue);
+	}
+
+	void NullRhiCommandQueue::Flush()
+	{
+		std::lock_guard lock(m_SignalMutex);
+		Retire(nullptr, 0, 0);
+	}
+
+	void NullRhiCommandQueue::SetLatency(const uint32_t pSignals)
+	{
+		std::lock_guard lock(m_SignalMutex);
+		m_Latency = pSignals;
+		Retire(nullptr, 0, m_Latency);
+	}
+
+	void NullRhiCommandQueue::Retire(const NullRhiFence* pFence, const uint64_t pValue, const size_t pKeep)
+	{
+		// Signals complete in submission order, as on a real queue.
+		while (m_PendingSignals.size() > pKeep && (!pFence || pFence->GetCompletedValue() < pValue))
+		{
+			const PendingSignal signal = m_PendingSignals.front();
+			m_PendingSignals.pop_front();
+			signal.Fence->SetCompletedValue(signal.Value);
+		}
+	}
+
+	void NullRhiFence::Wait(const uint64_t pValue)
+	{
+		NullRhiCommandQueue* queue = m_Queue.load(std::memory_order_relaxed);
+		if (!queue || GetCompletedValue() >= pValue)
+			return;
+
+		std::lock_guard lock(queue->m_SignalMutex);
+		queue->Retire(this, pValue, 0);
+	}
+
+	// ===== Swapchain =====
+
+	NullRhiSwapchain::NullRhiSwapchain(NullRhiDevice& pDevice, const uint32_t pWidth, const uint32_t pHeight)
+		: m_Device(pDevice), m_BackBuffers{NullRhiTexture({}), NullRhiTexture({})}
+	{
+		Resize(pWidth, pHeight);
+	}
+
+	void NullRhiSwapchain::Resize(const uint32_t pWidth, const uint32_t pHeight)
+	{
+		RhiTextureDesc backBufferDesc;
+		backBufferDesc.Width = pWidth;
+		backBufferDesc.Height = pHeight;
+		backBufferDesc.Format = RhiFormat::R8G8B8A8Unorm;
+		backBufferDesc.IsRenderTarget = true;
+		for (NullRhiTexture& backBuffer : m_BackBuffers)
+			backBuffer = NullRhiTexture(backBufferDesc);
+
+		m_CurrentBackBuffer = 0;
+		m_Viewport = {0.f, 0.f, static_cast<float>(pWidth), static_cast<float>(pHeight), 0.f, 1.f};
+		m_ScissorRect = {0, 0, static_cast<int32_t>(pWidth), static_cast<int32_t>(pHeight)};
+	}
+
+	void NullRhiSwapchain::Present()
+	{
+		m_CurrentBackBuffer = (m_CurrentBackBuffer + 1) % k_BufferCount;
+		++m_Device.m_Stats.PresentCount;
+	}
+
+	// ===== Device =====
+
+	NullRhiDevice::NullRhiDevice(const uint32_t pWidth, const uint32_t pHeight)
+		: m_MemoryAllocator([this](const RhiMemoryPool pPool, const uint32_t pHeap, const uint64_t pSize)
+		                    {
+			                    std::vector<RhiGpuAddress>& addresses = m_HeapAddresses[static_cast<size_t>(pPool)];
+			                    if (addresses.size() <= pHeap)
+				                    addresses.resize(pHeap + 1);
+			                    addresses[pHeap] = m_NextAddress.fetch_add(pSize, std::memory_order_relaxed);
+		                    }, [](RhiMemoryPool, uint32_t)
+		                    {
+		                    }),
+		  m_GraphicsQueue(*this), m_CopyQueue(*this), m_Swapchain(*this, pWidth, pHeight)
+	{
+	}
+
+	std::unique_ptr<RhiBuffer> NullRhiDevice::CreateBuffer(const RhiBufferDesc& pDesc)
+	{
+		// Placed as D3D12 places buffers : 64 KB aligned, sizes rounded to 64 KB.
+		const uint64_t size = RhiAlign((std::max)(pDesc.Size, uint64_t(1)), k_RhiResourcePlacementAlignment);
+		const RhiMemoryPool pool = GetBufferMemoryPool(pDesc.Heap);
+		auto buffer = std::make_unique<NullRhiBuffer>(pDesc, 0);
+		const RhiMemoryAllocation allocation = m_MemoryAllocator.Allocate(pool, size, k_RhiResourcePlacementAlignment,
+		                                                                  buffer.get());
+		const RhiGpuAddress address = allocation.IsDedicated()
+			                              ? m_NextAddress.fetch_add(size, std::memory_order_relaxed)
+			                              : m_HeapAddresses[static_cast<size_t>(pool)][allocation.Heap] +
+			                              allocation.Offset;
+		buffer->SetAllocation(m_MemoryAllocator, allocation, address);
+		return buffer;
+	}
+
+	std::unique_ptr<RhiTexture> NullRhiDevice::CreateTexture(const RhiTextureDesc& pDesc)
+	{
+		auto texture = std::make_unique<NullRhiTexture>(pDesc);
+		// Render targets and depth stencils have memory of their own, as on D3D12.
+		if (pDesc.IsRenderTarget || pDesc.IsDepthStencil)
+			return texture;
+
+		// Sized as the copy footprints, D3D12 lays the texels out its own way.
+		std::vector<RhiTextureFootprint> footprints;
+		const uint64_t bytes = GetTextureFootprints(*texture, footprints);
+		const uint64_t alignment = bytes <= k_RhiResourcePlacementAlignment
+			                           ? k_RhiSmallResourcePlacementAlignment
+			                           : k_RhiResourcePlacementAlignment;
+		const uint64_t size = RhiAlign(bytes, alignment);
+		texture->SetAllocation(m_MemoryAllocator, m_MemoryAllocator.Allocate(RhiMemoryPool::Textures, size,
+		                                                                     alignment, texture.get()));
+		return texture;
+	}
+
+	std::unique_ptr<RhiPipeline> NullRhiDevice::CreatePipeline(const RhiPipelineDesc& pDesc)
+	{
+		std::lock_guard lock(m_RootSignatureMutex);
+		for (const auto& rootSignature : m_RootSignatures)
+		{
+			if (rootSignature->first == pDesc.RootParameters && rootSignature->second == pDesc.UseStaticSamplers)
+				return std::make_unique<NullRhiPipeline>(pDesc, rootSignature.get());
+		}
+		m_RootSignatures.push_back(std::make_unique<std::pair<std::vector<RhiRootParameter>, bool>>(
+			pDesc.RootParameters, pDesc.UseStaticSamplers));
+		return std::make_unique<NullRhiPipeline>(pDesc, m_RootSignatures.back().get());
+	}
+
+	std::unique_ptr<RhiCommandSignature> NullRhiDevice::CreateCommandSignature(const RhiCommandSignatureDesc& pDesc,
+	                                                                           const RhiPipeline* pPipeline)
+	{
+		return std::make_unique<NullRhiCommandSignature>(pDesc);
+	}
+
+	std::unique_ptr<RhiHeap> NullRhiDevice::CreateRenderTargetHeap(const uint64_t pSize)
+	{
+		return std::make_unique<NullRhiHeap>(pSize);
+	}
+
+	RhiResourceAllocationInfo NullRhiDevice::GetTextureAllocationInfo(const RhiTextureDesc& pDesc)
+	{
+		uint64_t bytes = 0;
+		for (uint32_t mip = 0; mip < pDesc.MipLevels; ++mip)
+		{
+			bytes += static_cast<uint64_t>((std::max)(pDesc.Width >> mip, 1u)) * (std::max)(pDesc.Height >> mip, 1u) *
+				GetTexelSize(pDesc.Format) * pDesc.SampleCount;
+		}
+		return {RhiAlign((std::max)(bytes, uint64_t(1)), k_RhiResourcePlacementAlignment),
+		        k_RhiResourcePlacementAlignment};
+	}
+
+	std::unique_ptr<RhiTexture> NullRhiDevice::CreatePlacedTexture(const RhiTextureDesc& pDesc, RhiHeap& pHeap,
+	                                                               uint64_t pOffset)
+	{
+		return std::make_unique<NullRhiTexture>(pDesc);
+	}
+
+	std::unique_ptr<RhiFence> NullRhiDevice::CreateFence(const uint64_t pInitialValue)
+	{
+		return std::make_unique<NullRhiFence>(pInitialValue);
+	}
+
+	std::unique_ptr<RhiCommandAllocator> NullRhiDevice::CreateCommandAllocator(RhiQueueType pType)
+	{
+		return std::make_unique<NullRhiCommandAllocator>();
+	}
+
+	std::unique_ptr<RhiCommandList> NullRhiDevice::CreateCommandList(RhiQueueType pType)
+	{
+		return std::make_unique<NullRhiCommandList>();
+	}
+
+	void NullRhiDevice::WriteBuffer(RhiBuffer& pBuffer, const uint64_t pOffset, const void* pData,
+	                                const uint64_t pSize)
+	{
+		std::memcpy(pBuffer.GetMappedData() + pOffset, pData, pSize);
+		m_UploadedBytes.fetch_add(pSize, std::memory_order_relaxed);
+	}
+
+	uint64_t NullRhiDevice::GetTextureFootprints(const RhiTexture& pTexture,
+	                                             std::vector<RhiTextureFootprint>& pOutFootprints)
+	{
+		const RhiTextureDesc& desc = pTexture.GetDesc();
+		const uint32_t texelSize = GetTexelSize(desc.Format);
+
+		pOutFootprints.resize(desc.MipLevels);
+		uint64_t offset = 0;
+		uint64_t totalBytes = 0;
+		for (uint32_t mip = 0; mip < desc.MipLevels; ++mip)
+		{
+			RhiTextureFootprint& footprint = pOutFootprints[mip];
+			footprint.Offset = RhiAlign(offset, k_RhiTexturePlacementAlignment);
+			footprint.Width = (std::max)(desc.Width >> mip, 1u);
+			footprint.Height = (std::max)(desc.Height >> mip, 1u);
+			footprint.RowSize = static_cast<uint64_t>(footprint.Width) * texelSize;
+			footprint.RowPitch = static_cast<uint32_t>(RhiAlign(footprint.RowSize, k_RhiTextureRowPitchAlignment));
+			footprint.RowCount = footprint.Height;
+			// As on D3D12, the last row is not padded.
+			totalBytes = footprint.Offset + static_cast<uint64_t>(footprint.RowPitch) * (footprint.RowCount - 1) +
+				footprint.RowSize;
+			offset = footprint.Offset + static_cast<uint64_t>(footprint.RowPitch) * footprint.RowCount;
+		}
+		return totalBytes;
+	}
+
+	RhiCommandQueue& NullRhiDevice::GetQueue(const RhiQueueType pType)
+	{
+		return pType == RhiQueueType::Copy ? m_CopyQueue : m_GraphicsQueue;
+	}
+
+	NullRhiStats NullRhiDevice::GetStats() const
+	{
+		NullRhiStats stats = m_Stats;
+		stats.UploadedBytes += m_UploadedBytes.load(std::memory_order_relaxed);
+		return stats;
+	}
+
+	void NullRhiDevice::ResetStats()
+	{
+		m_Stats = NullRhiStats();
+		m_UploadedBytes = 0;
+	}
+}
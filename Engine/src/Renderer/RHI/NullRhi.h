@@ -0,0 +1,426 @@
+#pragma once
+#include <atomic>
+#include <deque>
+#include <mutex>
+
+#include "RhiDevice.h"
+
+namespace Engine
+{
+	/// <summary>
+	/// Counters of the null backend. Command lists count what they record, the device sums what was executed.
+	/// </summary>
+	struct NullRhiStats
+	{
+		uint64_t CommandCount = 0;
+		uint64_t DrawCount = 0;
+		uint64_t InstanceCount = 0;
+		uint64_t IndexCount = 0;
+
+		uint64_t PipelineBinds = 0;
+		// Pipeline binds that also changed the root signature (SetPipeline rather than SetPipelineState).
+		uint64_t RootSignatureBinds = 0;
+		uint64_t ConstantBufferBinds = 0;
+		uint64_t DescriptorTableBinds = 0;
+		uint64_t ShaderResourceBinds = 0;
+		uint64_t RootConstantBinds = 0;
+		// Root UAVs, compute root arguments of the other types are counted with the graphics ones.
+		uint64_t UnorderedAccessBinds = 0;
+		uint64_t VertexBufferBinds = 0;
+		uint64_t IndexBufferBinds = 0;
+
+		uint64_t BarrierCount = 0;
+		// Barrier recording calls, a Barriers() batch is one.
+		uint64_t BarrierBatchCount = 0;
+		uint64_t DispatchCount = 0;
+		// The draws of an ExecuteIndirect() are in the GPU's buffers, they are not in DrawCount.
+		uint64_t ExecuteIndirectCount = 0;
+		uint64_t CopiedBytes = 0;
+		// Bytes written by the CPU into upload buffers.
+		uint64_t UploadedBytes = 0;
+
+		uint64_t ExecutedListCount = 0;
+		// Execute() calls, a frame's lists should go in one.
+		uint64_t ExecuteCount = 0;
+		// RhiCommandQueue::Wait() calls, a queue waiting for another one.
+		uint64_t QueueWaitCount = 0;
+		uint64_t PresentCount = 0;
+
+		uint64_t GetBindCount() const
+		{
+			return PipelineBinds + ConstantBufferBinds + DescriptorTableBinds + ShaderResourceBinds + RootConstantBinds +
+				UnorderedAccessBinds + VertexBufferBinds + IndexBufferBinds;
+		}
+
+		NullRhiStats& operator+=(const NullRhiStats& pOther);
+	};
+
+	enum class NullRhiCommandType : uint8_t
+	{
+		SetPipeline, // Object : RhiPipeline
+		SetPipelineState, // Object : RhiPipeline
+		SetRootConstantBuffer, // Slot, Args[0] : address
+		SetRootDescriptorTable, // Slot, Args[0] : descriptor
+		SetRootShaderResource, // Slot, Args[0] : address
+		SetRootConstant, // Slot, Args : value, offset
+		SetComputeRootConstantBuffer, // Slot, Args[0] : address
+		SetComputeRootShaderResource, // Slot, Args[0] : address
+		SetComputeRootUnorderedAccess, // Slot, Args[0] : address
+		SetVertexBuffer, // Args : address, size, stride
+		SetIndexBuffer, // Args : address, size, format
+		SetPrimitiveTopology, // Args[0] : topology
+		SetViewport, // Args : x, y, width, height as floats
+		SetScissorRect, // Args : left, top, right, bottom
+		SetRenderTarget, // Object : color, Object2 : depth stencil (both optional)
+		ClearRenderTarget, // Object : target
+		ClearDepthStencil, // Object : target, Args : depth as float, stencil
+		Barrier, // Object : resource, Args : state before, state after
+		UnorderedAccessBarrier, // Object : resource
+		AliasingBarrier, // Object : resource
+		DrawIndexedInstanced, // Args : index count, instance count, start index, base vertex, Slot : start instance
+		ExecuteIndirect, // Object : arguments, Object2 : count (optional), Slot : max command count, Args : argument offset, count offset, signature
+		Dispatch, // Args : group counts x, y, z
+		CopyBufferRegion, // Object : destination, Object2 : source, Args : destination offset, source offset, size
+		CopyBufferToTexture, // Object : destination, Object2 : source, Slot : subresource, Args : source offset, row pitch, row count, row size
+	};
+
+	struct NullRhiCommand
+	{
+		NullRhiCommandType Type;
+		uint32_t Slot = 0;
+		const void* Object = nullptr;
+		const void* Object2 = nullptr;
+		uint64_t Args[4] = {};
+	};
+
+	class NullRhiBuffer : public RhiBuffer
+	{
+	public:
+		NullRhiBuffer(const RhiBufferDesc& pDesc, RhiGpuAddress pAddress);
+		~NullRhiBuffer() override;
+
+		/// <summary>
+		/// Memory of the buffer, freed from pAllocator on destruction, and the address it is at.
+		/// </summary>
+		void SetAllocation(RhiMemoryAllocator& pAllocator, const RhiMemoryAllocation& pAllocation,
+		                   RhiGpuAddress pAddress);
+		const RhiMemoryAllocation& GetAllocation() const { return m_Allocation; }
+
+		/// <returns> The buffer content, default heap buffers included. </returns>
+		std::vector<uint8_t>& GetStorage() { return m_Storage; }
+		const std::vector<uint8_t>& GetStorage() const { return m_Storage; }
+
+	private:
+		std::vector<uint8_t> m_Storage;
+		RhiMemoryAllocator* m_Allocator = nullptr;
+		RhiMemoryAllocation m_Allocation;
+	};
+
+	class NullRhiTexture : public RhiTexture
+	{
+	public:
+		explicit NullRhiTexture(const RhiTextureDesc& pDesc) { m_Desc = pDesc; }
+		~NullRhiTexture() override;
+
+		/// <summary>
+		/// Memory of the texture, freed from pAllocator on destruction.
+		/// </summary>
+		void SetAllocation(RhiMemoryAllocator& pAllocator, const RhiMemoryAllocation& pAllocation);
+		const RhiMemoryAllocation& GetAllocation() const { return m_Allocation; }
+
+		/// <returns> The content of a subresource, rows without padding, empty until something is copied to it. </returns>
+		std::vector<uint8_t>& GetSubresource(uint32_t pIndex);
+		const std::vector<uint8_t>& GetSubresource(uint32_t pIndex) const { return m_Subresources.at(pIndex); }
+
+	private:
+		std::vector<std::vector<uint8_t>> m_Subresources;
+		RhiMemoryAllocator* m_Allocator = nullptr;
+		RhiMemoryAllocation m_Allocation;
+	};
+
+	class NullRhiHeap : public RhiHeap
+	{
+	public:
+		explicit NullRhiHeap(const uint64_t pSize) { m_Size = pSize; }
+	};
+
+	class NullRhiPipeline : public RhiPipeline
+	{
+	public:
+		NullRhiPipeline(const RhiPipelineDesc& pDesc, const void* pRootSignatureId);
+
+		const void* GetRootSignatureId() const override { return m_RootSignatureId; }
+		std::vector<uint8_t> GetCachedBlob() const override;
+		/// <returns> The description the pipeline was created with, without the bytecode. </returns>
+		const RhiPipelineDesc& GetDesc() const { return m_Desc; }
+		bool IsFromCachedBlob() const override { return m_IsFromCachedBlob; }
+
+	private:
+		RhiPipelineDesc m_Desc;
+		const void* m_RootSignatureId;
+		bool m_IsFromCachedBlob = false;
+	};
+
+	class NullRhiCommandSignature : public RhiCommandSignature
+	{
+	public:
+		explicit NullRhiCommandSignature(const RhiCommandSignatureDesc& pDesc) : m_Desc(pDesc) {}
+
+		const RhiCommandSignatureDesc& GetDesc() const { return m_Desc; }
+
+	private:
+		RhiCommandSignatureDesc m_Desc;
+	};
+
+	class NullRhiCommandQueue;
+
+	/// <summary>
+	/// Holds the last value the simulated GPU reached. Waiting on a value still queued makes the GPU catch up
+	/// to it, as if the CPU had blocked until then.
+	/// </summary>
+	class NullRhiFence : public RhiFence
+	{
+	public:
+		explicit NullRhiFence(const uint64_t pInitialValue) : m_Value(pInitialValue) {}
+
+		uint64_t GetCompletedValue() const override { return m_Value.load(std::memory_order_acquire); }
+		void Wait(uint64_t pValue) override;
+
+		void SetCompletedValue(const uint64_t pValue) { m_Value.store(pValue, std::memory_order_release); }
+
+	private:
+		std::atomic<uint64_t> m_Value;
+		// Queue of the last Signal(), the one to drain on Wait().
+		std::atomic<NullRhiCommandQueue*> m_Queue = nullptr;
+
+		friend class NullRhiCommandQueue;
+	};
+
+	class NullRhiCommandAllocator : public RhiCommandAllocator
+	{
+	public:
+		void Reset() override {}
+	};
+
+	/// <summary>
+	/// Records every command into an inspectable stream and counts them. Recording can be turned off to only
+	/// keep the counters, the cost left is the one of the code issuing the commands.
+	/// </summary>
+	class NullRhiCommandList : public RhiCommandList
+	{
+	public:
+		void Begin(RhiCommandAllocator& pAllocator) override;
+		void End() override;
+
+		void SetPipeline(const RhiPipeline& pPipeline) override;
+		void SetPipelineState(const RhiPipeline& pPipeline) override;
+		void SetGraphicsRootConstantBufferView(uint32_t pSlot, RhiGpuAddress pAddress) override;
+		void SetGraphicsRootDescriptorTable(uint32_t pSlot, RhiDescriptor pDescriptor) override;
+		void SetGraphicsRootShaderResourceView(uint32_t pSlot, RhiGpuAddress pAddress) override;
+		void SetGraphicsRoot32BitConstant(uint32_t pSlot, uint32_t pValue, uint32_t pOffset) override;
+		void SetComputeRootConstantBufferView(uint32_t pSlot, RhiGpuAddress pAddress) override;
+		void SetComputeRootShaderResourceView(uint32_t pSlot, RhiGpuAddress pAddress) override;
+		void SetComputeRootUnorderedAccessView(uint32_t pSlot, RhiGpuAddress pAddress) override;
+
+		void SetVertexBuffer(const RhiVertexBufferView& pView) override;
+		void SetIndexBuffer(const RhiIndexBufferView& pView) override;
+		void SetPrimitiveTopology(RhiPrimitiveTopology pTopology) override;
+
+		void SetViewport(const RhiViewport& pViewport) override;
+		void SetScissorRect(const RhiRect& pRect) override;
+		void SetRenderTarget(const RhiTexture* pColor, const RhiTexture* pDepthStencil) override;
+		void ClearRenderTarget(const RhiTexture& pTarget, const float pColor[4]) override;
+		void ClearDepthStencil(const RhiTexture& pTarget, float pDepth, uint8_t pStencil) override;
+
+		void Barrier(const RhiResource& pResource, RhiResourceState pBefore, RhiResourceState pAfter) override;
+		void UnorderedAccessBarrier(const RhiResource& pResource) override;
+		/// <summary>
+		/// Records each barrier as a command of its own, counted as one batch.
+		/// </summary>
+		void Barriers(const RhiBarrier* pBarriers, uint32_t pCount) override;
+
+		void DrawIndexedInstanced(uint32_t pIndexCount, uint32_t pInstanceCount, uint32_t pStartIndex,
+		                          int32_t pBaseVertex, uint32_t pStartInstance) override;
+		/// <summary>
+		/// Only recorded, the null backend runs no shader to write the arguments.
+		/// </summary>
+		void ExecuteIndirect(const RhiCommandSignature& pSignature, uint32_t pMaxCommandCount,
+		                     const RhiBuffer& pArguments, uint64_t pArgumentOffset, const RhiBuffer* pCount,
+		                     uint64_t pCountOffset) override;
+		void Dispatch(uint32_t pGroupCountX, uint32_t pGroupCountY, uint32_t pGroupCountZ) override;
+
+		void CopyBufferRegion(const RhiBuffer& pDestination, uint64_t pDestinationOffset, const RhiBuffer& pSource,
+		                      uint64_t pSourceOffset, uint64_t pSize) override;
+		void CopyBufferToTexture(const RhiTexture& pDestination, uint32_t pSubresource, const RhiBuffer& pSource,
+		                         uint64_t pSourceOffset, const RhiTextureFootprint& pFootprint) override;
+
+		void SetRecording(const bool pIsRecording) { m_IsRecording = pIsRecording; }
+
+		/// <returns> The commands recorded since Begin(). </returns>
+		const std::vector<NullRhiCommand>& GetCommands() const { return m_Commands; }
+		/// <returns> The counters since Begin(). </returns>
+		const NullRhiStats& GetStats() const { return m_Stats; }
+		bool IsOpen() const { return m_IsOpen; }
+
+	private:
+		NullRhiCommand& Record(NullRhiCommandType pType);
+
+		struct PendingCopy
+		{
+			const NullRhiBuffer* Destination;
+			const NullRhiBuffer* Source;
+			uint64_t DestinationOffset;
+			uint64_t SourceOffset;
+			uint64_t Size;
+		};
+
+		struct PendingTextureCopy
+		{
+			const NullRhiTexture* Destination;
+			uint32_t Subresource;
+			const NullRhiBuffer* Source;
+			uint64_t SourceOffset;
+			RhiTextureFootprint Footprint;
+		};
+
+		std::vector<NullRhiCommand> m_Commands;
+		// Copies are applied when the list is executed, even if the commands are not recorded.
+		std::vector<PendingCopy> m_Copies;
+		std::vector<PendingTextureCopy> m_TextureCopies;
+		NullRhiStats m_Stats;
+		bool m_IsRecording = true;
+		bool m_IsOpen = false;
+
+		friend class NullRhiCommandQueue;
+	};
+
+	class NullRhiDevice;
+
+	/// <summary>
+	/// Executes lists immediately. Signals go through a simulated GPU timeline : with a latency of N, a signal
+	/// only completes once N more signals were queued after it, like a GPU running N frames behind the CPU.
+	/// </summary>
+	class NullRhiCommandQueue : public RhiCommandQueue
+	{
+	public:
+		explicit NullRhiCommandQueue(NullRhiDevice& pDevice) : m_Device(pDevice) {}
+
+		void Execute(RhiCommandList* const* pLists, uint32_t pCount) override;
+		void Signal(RhiFence& pFence, uint64_t pValue) override;
+		/// <summary>
+		/// Lists execute right away, so the signaling queue catches up to pValue as a CPU wait would.
+		/// </summary>
+		void Wait(RhiFence& pFence, uint64_t pValue) override;
+		void Flush() override;
+
+		/// <param name="pSignals"> Number of signals the GPU lags behind, 0 completes them right away. </param>
+		void SetLatency(uint32_t pSignals);
+		uint32_t GetLatency() const { return m_Latency; }
+
+	private:
+		struct PendingSignal
+		{
+			NullRhiFence* Fence;
+			uint64_t Value;
+		};
+
+		// Completes the oldest signals until pFence reaches pValue, or until only pKeep signals are left.
+		void Retire(const NullRhiFence* pFence, uint64_t pValue, size_t pKeep);
+
+		NullRhiDevice& m_Device;
+
+		std::mutex m_SignalMutex;
+		std::deque<PendingSignal> m_PendingSignals;
+		uint32_t m_Latency = 0;
+
+		friend class NullRhiFence;
+	};
+
+	class NullRhiSwapchain : public RhiSwapchain
+	{
+	public:
+		static const int k_BufferCount = 2;
+
+		NullRhiSwapchain(NullRhiDevice& pDevice, uint32_t pWidth, uint32_t pHeight);
+
+		const RhiTexture& GetCurrentBackBuffer() override { return m_BackBuffers[m_CurrentBackBuffer]; }
+
+		const RhiViewport& GetViewport() const override { return m_Viewport; }
+		const RhiRect& GetScissorRect() const override { return m_ScissorRect; }
+
+		void Resize(uint32_t pWidth, uint32_t pHeight) override;
+		void Present() override;
+
+	private:
+		NullRhiDevice& m_Device;
+		NullRhiTexture m_BackBuffers[k_BufferCount];
+		int m_CurrentBackBuffer = 0;
+		RhiViewport m_Viewport;
+		RhiRect m_ScissorRect;
+	};
+
+	/// <summary>
+	/// Backend without a GPU : buffers live in CPU memory, copies are applied on execution and everything else
+	/// is only recorded and counted. It runs on any platform, for headless runs and CPU side benchmarks.
+	/// </summary>
+	class NullRhiDevice : public RhiDevice
+	{
+	public:
+		NullRhiDevice(uint32_t pWidth = 1280, uint32_t pHeight = 720);
+
+		std::unique_ptr<RhiBuffer> CreateBuffer(const RhiBufferDesc& pDesc) override;
+		std::unique_ptr<RhiTexture> CreateTexture(const RhiTextureDesc& pDesc) override;
+		std::unique_ptr<RhiPipeline> CreatePipeline(const RhiPipelineDesc& pDesc) override;
+		std::unique_ptr<RhiCommandSignature> CreateCommandSignature(const RhiCommandSignatureDesc& pDesc,
+		                                                            const RhiPipeline* pPipeline) override;
+		std::unique_ptr<RhiHeap> CreateRenderTargetHeap(uint64_t pSize) override;
+		/// <summary>
+		/// Sized as the mips' texels, aligned as D3D12 aligns placed render targets.
+		/// </summary>
+		RhiResourceAllocationInfo GetTextureAllocationInfo(const RhiTextureDesc& pDesc) override;
+		std::unique_ptr<RhiTexture> CreatePlacedTexture(const RhiTextureDesc& pDesc, RhiHeap& pHeap,
+		                                                uint64_t pOffset) override;
+		std::unique_ptr<RhiFence> CreateFence(uint64_t pInitialValue) override;
+		std::unique_ptr<RhiCommandAllocator> CreateCommandAllocator(RhiQueueType pType) override;
+		std::unique_ptr<RhiCommandList> CreateCommandList(RhiQueueType pType) override;
+
+		void WriteBuffer(RhiBuffer& pBuffer, uint64_t pOffset, const void* pData, uint64_t pSize) override;
+		/// <summary>
+		/// Follows the D3D12 placement rules, the texture's mips only.
+		/// </summary>
+		uint64_t GetTextureFootprints(const RhiTexture& pTexture,
+		                              std::vector<RhiTextureFootprint>& pOutFootprints) override;
+
+		RhiCommandQueue& GetQueue(RhiQueueType pType) override;
+		RhiSwapchain& GetSwapchain() override { return m_Swapchain; }
+		RhiMemoryAllocator& GetMemoryAllocator() override { return m_MemoryAllocator; }
+
+		RhiCommandList& GetCommandList() override { return m_CommandList; }
+		RhiCommandAllocator& GetCommandAllocator() override { return m_CommandAllocator; }
+
+		/// <returns> The counters of every executed command list since the last ResetStats(). </returns>
+		NullRhiStats GetStats() const;
+		void ResetStats();
+
+	private:
+		std::atomic<RhiGpuAddress> m_NextAddress = 0x10000;
+		// Address of every heap of the memory allocator, reserved when it is created.
+		std::vector<RhiGpuAddress> m_HeapAddresses[static_cast<size_t>(RhiMemoryPool::Count)];
+		RhiMemoryAllocator m_MemoryAllocator;
+		NullRhiStats m_Stats;
+		std::atomic<uint64_t> m_UploadedBytes = 0;
+
+		// Root parameters of the pipelines created so far, a pipeline's root signature id is its entry.
+		std::mutex m_RootSignatureMutex;
+		std::vector<std::unique_ptr<std::pair<std::vector<RhiRootParameter>, bool>>> m_RootSignatures;
+
+		NullRhiCommandQueue m_GraphicsQueue;
+		NullRhiCommandQueue m_CopyQueue;
+		NullRhiSwapchain m_Swapchain;
+		NullRhiCommandList m_CommandList;
+		NullRhiCommandAllocator m_CommandAllocator;
+
+		friend class NullRhiCommandQueue;
+		friend class NullRhiSwapchain;
+	};
+}
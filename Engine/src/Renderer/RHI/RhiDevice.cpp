@@ -0,0 +1,35 @@
+#include "RhiDevice.h"
+
+namespace Engine
+{
+	RhiDevice* RhiDevice::s_Instance = nullptr;
+
+	void RhiDevice::Initialize(std::unique_ptr<RhiDevice> pDevice)
+	{
+		Shutdown();
+		s_Instance = pDevice.release();
+	}
+
+	void RhiDevice::Shutdown()
+	{
+		delete s_Instance;
+		s_Instance = nullptr;
+	}
+
+	std::unique_ptr<RhiBuffer> RhiDevice::CreateDefaultBuffer(RhiCommandList& pCommandList, const void* pData,
+	                                                          const uint64_t pSize,
+	                                                          std::unique_ptr<RhiBuffer>& pUploadBuffer)
+	{
+		std::unique_ptr<RhiBuffer> buffer = CreateBuffer({pSize, RhiHeapType::Default});
+
+		// In order to copy CPU memory data into the default buffer, it goes through an intermediate upload heap.
+		pUploadBuffer = CreateBuffer({pSize, RhiHeapType::Upload});
+		WriteBuffer(*pUploadBuffer, 0, pData, pSize);
+
+		pCommandList.Barrier(*buffer, RhiResourceState::Common, RhiResourceState::CopyDest);
+		pCommandList.CopyBufferRegion(*buffer, 0, *pUploadBuffer, 0, pSize);
+		pCommandList.Barrier(*buffer, RhiResourceState::CopyDest, RhiResourceState::GenericRead);
+
+		return buffer;
+	}
+}
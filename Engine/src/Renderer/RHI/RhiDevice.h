@@ -0,0 +1,306 @@
+#pragma once
+#include <memory>
+
+#include "RhiMemoryAllocator.h"
+#include "RhiTypes.h"
+
+namespace Engine
+{
+	/// <summary>
+	/// Base of the GPU objects that can be transitioned with RhiCommandList::Barrier.
+	/// </summary>
+	class RhiResource
+	{
+	public:
+		virtual ~RhiResource() = default;
+	};
+
+	class RhiBuffer : public RhiResource
+	{
+	public:
+		const RhiBufferDesc& GetDesc() const { return m_Desc; }
+		RhiGpuAddress GetGpuAddress() const { return m_GpuAddress; }
+
+		/// <returns> The persistently mapped memory of an upload or readback buffer, nullptr on the default heap. </returns>
+		uint8_t* GetMappedData() const { return m_MappedData; }
+
+	protected:
+		RhiBufferDesc m_Desc;
+		RhiGpuAddress m_GpuAddress = 0;
+		uint8_t* m_MappedData = nullptr;
+	};
+
+	class RhiTexture : public RhiResource
+	{
+	public:
+		const RhiTextureDesc& GetDesc() const { return m_Desc; }
+
+	protected:
+		RhiTextureDesc m_Desc;
+	};
+
+	/// <summary>
+	/// GPU memory render targets and depth stencils are placed in, see RhiDevice::CreatePlacedTexture.
+	/// </summary>
+	class RhiHeap
+	{
+	public:
+		virtual ~RhiHeap() = default;
+
+		uint64_t GetSize() const { return m_Size; }
+
+	protected:
+		uint64_t m_Size = 0;
+	};
+
+	/// <summary>
+	/// A compiled pipeline state and the root signature it was built with.
+	/// </summary>
+	class RhiPipeline
+	{
+	public:
+		virtual ~RhiPipeline() = default;
+
+		/// <returns> Identifies the root signature, pipelines created with the same root parameters share it. </returns>
+		virtual const void* GetRootSignatureId() const = 0;
+
+		/// <returns> The driver's compiled form of the pipeline, to pass back as RhiPipelineDesc::CachedBlob on a
+		/// later run. Empty when the backend has none. </returns>
+		virtual std::vector<uint8_t> GetCachedBlob() const = 0;
+		/// <returns> True when RhiPipelineDesc::CachedBlob was used instead of compiling the pipeline. </returns>
+		virtual bool IsFromCachedBlob() const = 0;
+	};
+
+	/// <summary>
+	/// Layout of the commands of an indirect execution, see RhiCommandSignatureDesc.
+	/// </summary>
+	class RhiCommandSignature
+	{
+	public:
+		virtual ~RhiCommandSignature() = default;
+	};
+
+	class RhiFence
+	{
+	public:
+		virtual ~RhiFence() = default;
+
+		/// <returns> The last value signaled by the GPU. </returns>
+		virtual uint64_t GetCompletedValue() const = 0;
+
+		/// <summary>
+		/// Blocks the calling thread until the GPU has signaled pValue.
+		/// </summary>
+		virtual void Wait(uint64_t pValue) = 0;
+	};
+
+	/// <summary>
+	/// Memory backing recorded commands. It can only be reset once the GPU is done with them.
+	/// </summary>
+	class RhiCommandAllocator
+	{
+	public:
+		virtual ~RhiCommandAllocator() = default;
+
+		virtual void Reset() = 0;
+	};
+
+	/// <summary>
+	/// Records GPU commands between Begin() and End(). Root parameter slots follow the RhiPipelineDesc::RootParameters
+	/// of the bound pipeline.
+	/// </summary>
+	class RhiCommandList
+	{
+	public:
+		virtual ~RhiCommandList() = default;
+
+		virtual void Begin(RhiCommandAllocator& pAllocator) = 0;
+		virtual void End() = 0;
+
+		/// <summary>
+		/// Binds the pipeline state and its root signature, the root arguments have to be set again. A compute
+		/// pipeline binds the compute root signature, the graphics one and its arguments stay.
+		/// </summary>
+		virtual void SetPipeline(const RhiPipeline& pPipeline) = 0;
+		/// <summary>
+		/// Only binds the pipeline state : the bound root signature and root arguments stay, so it has to be
+		/// pPipeline's one (same GetRootSignatureId()).
+		/// </summary>
+		virtual void SetPipelineState(const RhiPipeline& pPipeline) = 0;
+		virtual void SetGraphicsRootConstantBufferView(uint32_t pSlot, RhiGpuAddress pAddress) = 0;
+		virtual void SetGraphicsRootDescriptorTable(uint32_t pSlot, RhiDescriptor pDescriptor) = 0;
+		virtual void SetGraphicsRootShaderResourceView(uint32_t pSlot, RhiGpuAddress pAddress) = 0;
+		/// <param name="pOffset"> Index of the value within the Constants parameter. </param>
+		virtual void SetGraphicsRoot32BitConstant(uint32_t pSlot, uint32_t pValue, uint32_t pOffset) = 0;
+		virtual void SetComputeRootConstantBufferView(uint32_t pSlot, RhiGpuAddress pAddress) = 0;
+		virtual void SetComputeRootShaderResourceView(uint32_t pSlot, RhiGpuAddress pAddress) = 0;
+		virtual void SetComputeRootUnorderedAccessView(uint32_t pSlot, RhiGpuAddress pAddress) = 0;
+
+		virtual void SetVertexBuffer(const RhiVertexBufferView& pView) = 0;
+		virtual void SetIndexBuffer(const RhiIndexBufferView& pView) = 0;
+		virtual void SetPrimitiveTopology(RhiPrimitiveTopology pTopology) = 0;
+
+		virtual void SetViewport(const RhiViewport& pViewport) = 0;
+		virtual void SetScissorRect(const RhiRect& pRect) = 0;
+		virtual void SetRenderTarget(const RhiTexture* pColor, const RhiTexture* pDepthStencil) = 0;
+		virtual void ClearRenderTarget(const RhiTexture& pTarget, const float pColor[4]) = 0;
+		virtual void ClearDepthStencil(const RhiTexture& pTarget, float pDepth, uint8_t pStencil) = 0;
+
+		virtual void Barrier(const RhiResource& pResource, RhiResourceState pBefore, RhiResourceState pAfter) = 0;
+		/// <summary>
+		/// Waits for the writes of the previous dispatches to pResource, left in UnorderedAccess state, before
+		/// the next ones.
+		/// </summary>
+		virtual void UnorderedAccessBarrier(const RhiResource& pResource) = 0;
+		/// <summary>
+		/// Records pCount barriers in one go, the GPU waits once for all of them.
+		/// </summary>
+		virtual void Barriers(const RhiBarrier* pBarriers, uint32_t pCount) = 0;
+
+		virtual void DrawIndexedInstanced(uint32_t pIndexCount, uint32_t pInstanceCount, uint32_t pStartIndex,
+		                                  int32_t pBaseVertex, uint32_t pStartInstance) = 0;
+		/// <summary>
+		/// Runs the commands laid out as pSignature in pArguments, in IndirectArgument state.
+		/// </summary>
+		/// <param name="pSignature"></param>
+		/// <param name="pMaxCommandCount"> : commands pArguments has room for</param>
+		/// <param name="pArguments"></param>
+		/// <param name="pArgumentOffset"></param>
+		/// <param name="pCount"> : optional, the uint32_t at pCountOffset is the number of commands, up to pMaxCommandCount</param>
+		/// <param name="pCountOffset"></param>
+		virtual void ExecuteIndirect(const RhiCommandSignature& pSignature, uint32_t pMaxCommandCount,
+		                             const RhiBuffer& pArguments, uint64_t pArgumentOffset, const RhiBuffer* pCount,
+		                             uint64_t pCountOffset) = 0;
+		virtual void Dispatch(uint32_t pGroupCountX, uint32_t pGroupCountY, uint32_t pGroupCountZ) = 0;
+
+		virtual void CopyBufferRegion(const RhiBuffer& pDestination, uint64_t pDestinationOffset,
+		                              const RhiBuffer& pSource, uint64_t pSourceOffset, uint64_t pSize) = 0;
+		/// <summary>
+		/// Copies a subresource laid out as pFootprint (see RhiDevice::GetTextureFootprints) from pSource, starting
+		/// at pSourceOffset, a multiple of k_RhiTexturePlacementAlignment.
+		/// </summary>
+		virtual void CopyBufferToTexture(const RhiTexture& pDestination, uint32_t pSubresource, const RhiBuffer& pSource,
+		                                 uint64_t pSourceOffset, const RhiTextureFootprint& pFootprint) = 0;
+	};
+
+	class RhiCommandQueue
+	{
+	public:
+		virtual ~RhiCommandQueue() = default;
+
+		/// <summary>
+		/// Submits closed command lists, they run in order.
+		/// </summary>
+		virtual void Execute(RhiCommandList* const* pLists, uint32_t pCount) = 0;
+
+		/// <summary>
+		/// Sets the fence to pValue once every command submitted before is done.
+		/// </summary>
+		virtual void Signal(RhiFence& pFence, uint64_t pValue) = 0;
+
+		/// <summary>
+		/// Makes the GPU wait until pFence reaches pValue before running what is submitted afterward, ex. a
+		/// signal of another queue. The CPU does not block.
+		/// </summary>
+		virtual void Wait(RhiFence& pFence, uint64_t pValue) = 0;
+
+		/// <summary>
+		/// Blocks until every submitted command is done.
+		/// </summary>
+		virtual void Flush() = 0;
+	};
+
+	class RhiSwapchain
+	{
+	public:
+		virtual ~RhiSwapchain() = default;
+
+		/// <returns> The back buffer rendered this frame, in Present state outside of the frame. </returns>
+		virtual const RhiTexture& GetCurrentBackBuffer() = 0;
+
+		virtual const RhiViewport& GetViewport() const = 0;
+		virtual const RhiRect& GetScissorRect() const = 0;
+
+		virtual void Resize(uint32_t pWidth, uint32_t pHeight) = 0;
+		virtual void Present() = 0;
+	};
+
+	/// <summary>
+	/// Render hardware interface : creates GPU objects and owns the queues, the swapchain and the immediate
+	/// command list everything records into. DirectXRhiDevice drives D3D12, NullRhiDevice records the commands
+	/// without a GPU so the renderer can run (and be measured) anywhere.
+	/// </summary>
+	class RhiDevice
+	{
+	public:
+		/// <summary>
+		/// Makes pDevice the device returned by Get().
+		/// </summary>
+		static void Initialize(std::unique_ptr<RhiDevice> pDevice);
+		static void Shutdown();
+
+		static RhiDevice* Get() { return s_Instance; }
+
+		virtual ~RhiDevice() = default;
+
+		virtual std::unique_ptr<RhiBuffer> CreateBuffer(const RhiBufferDesc& pDesc) = 0;
+		virtual std::unique_ptr<RhiTexture> CreateTexture(const RhiTextureDesc& pDesc) = 0;
+		virtual std::unique_ptr<RhiPipeline> CreatePipeline(const RhiPipelineDesc& pDesc) = 0;
+		/// <param name="pDesc"></param>
+		/// <param name="pPipeline"> : the pipeline whose root parameters the Constants arguments write to, nullptr
+		/// without them</param>
+		virtual std::unique_ptr<RhiCommandSignature> CreateCommandSignature(const RhiCommandSignatureDesc& pDesc,
+		                                                                    const RhiPipeline* pPipeline) = 0;
+		/// <summary>
+		/// Creates a heap for render targets and depth stencils, the ones never used at the same time can share
+		/// its memory.
+		/// </summary>
+		virtual std::unique_ptr<RhiHeap> CreateRenderTargetHeap(uint64_t pSize) = 0;
+		/// <returns> The bytes and the alignment a texture of pDesc takes in a heap. </returns>
+		virtual RhiResourceAllocationInfo GetTextureAllocationInfo(const RhiTextureDesc& pDesc) = 0;
+		/// <summary>
+		/// Creates a render target or depth stencil at pOffset in pHeap, a multiple of the texture's alignment,
+		/// in Common state. Once another texture used its memory, it needs an aliasing barrier and a clear
+		/// before it is drawn to again.
+		/// </summary>
+		virtual std::unique_ptr<RhiTexture> CreatePlacedTexture(const RhiTextureDesc& pDesc, RhiHeap& pHeap,
+		                                                        uint64_t pOffset) = 0;
+		virtual std::unique_ptr<RhiFence> CreateFence(uint64_t pInitialValue) = 0;
+		virtual std::unique_ptr<RhiCommandAllocator> CreateCommandAllocator(RhiQueueType pType) = 0;
+		virtual std::unique_ptr<RhiCommandList> CreateCommandList(RhiQueueType pType) = 0;
+
+		/// <summary>
+		/// Copies CPU data into an upload buffer.
+		/// </summary>
+		virtual void WriteBuffer(RhiBuffer& pBuffer, uint64_t pOffset, const void* pData, uint64_t pSize) = 0;
+
+		/// <summary>
+		/// Lays out every subresource of pTexture for a copy from a buffer, mips first then array slices.
+		/// </summary>
+		/// <returns> The bytes of buffer they span. </returns>
+		virtual uint64_t GetTextureFootprints(const RhiTexture& pTexture,
+		                                      std::vector<RhiTextureFootprint>& pOutFootprints) = 0;
+
+		virtual RhiCommandQueue& GetQueue(RhiQueueType pType) = 0;
+		virtual RhiSwapchain& GetSwapchain() = 0;
+		/// <returns> Where buffers and textures are placed. </returns>
+		virtual RhiMemoryAllocator& GetMemoryAllocator() = 0;
+
+		/// <summary>
+		/// The graphics command list frames and one-off uploads are recorded into, with its allocator.
+		/// </summary>
+		virtual RhiCommandList& GetCommandList() = 0;
+		virtual RhiCommandAllocator& GetCommandAllocator() = 0;
+
+		/// <summary>
+		/// Creates a default heap buffer and records the copy of pData into it. pUploadBuffer holds the data
+		/// until the copy is executed, the caller can release it afterward.
+		/// The buffer is left in GenericRead state.
+		/// </summary>
+		std::unique_ptr<RhiBuffer> CreateDefaultBuffer(RhiCommandList& pCommandList, const void* pData, uint64_t pSize,
+		                                               std::unique_ptr<RhiBuffer>& pUploadBuffer);
+
+	private:
+		static RhiDevice* s_Instance;
+	};
+}
@@ -0,0 +1,197 @@
+#include "RhiMemoryAllocator.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace Engine
+{
+	namespace
+	{
+		// Alignment a move keeps at most, the one of buffers and large textures.
+		constexpr uint64_t k_MaxMoveAlignment = 64 * 1024;
+	}
+
+	RhiMemoryAllocator::PoolStats RhiMemoryAllocator::Stats::GetTotal() const
+	{
+		PoolStats total;
+		for (const PoolStats& pool : Pools)
+		{
+			total.HeapCount += pool.HeapCount;
+			total.HeapBytes += pool.HeapBytes;
+			total.UsedBytes += pool.UsedBytes;
+			total.AllocationCount += pool.AllocationCount;
+			total.LargestFreeBlock = (std::max)(total.LargestFreeBlock, pool.LargestFreeBlock);
+			total.FreeBlockCount += pool.FreeBlockCount;
+			total.DedicatedCount += pool.DedicatedCount;
+			total.DedicatedBytes += pool.DedicatedBytes;
+		}
+		return total;
+	}
+
+	RhiMemoryAllocator::RhiMemoryAllocator(CreateHeapCallback pCreateHeap, ReleaseHeapCallback pReleaseHeap,
+	                                       const uint64_t pHeapSize)
+		: m_CreateHeap(std::move(pCreateHeap)), m_ReleaseHeap(std::move(pReleaseHeap)),
+		  m_HeapSize((pHeapSize + k_Granularity - 1) / k_Granularity * k_Granularity)
+	{
+	}
+
+	RhiMemoryAllocation RhiMemoryAllocator::Allocate(const RhiMemoryPool pPool, const uint64_t pSize,
+	                                                 const uint64_t pAlignment, void* pOwner)
+	{
+		std::lock_guard lock(m_Mutex);
+		Pool& pool = m_Pools[static_cast<size_t>(pPool)];
+		RhiMemoryAllocation allocation;
+		allocation.Pool = pPool;
+
+		// A heap holding a few large resources would mostly be lost to fragmentation.
+		if (pSize > m_HeapSize / 2)
+		{
+			allocation.Size = pSize;
+			++pool.DedicatedCount;
+			pool.DedicatedBytes += pSize;
+			return allocation;
+		}
+
+		for (uint32_t heap = 0; heap < pool.Heaps.size(); ++heap)
+		{
+			if (pool.Heaps[heap] && pool.Heaps[heap]->TryAllocate(pSize, pAlignment, allocation.Block, pOwner))
+			{
+				allocation.Heap = heap;
+				break;
+			}
+		}
+		if (allocation.IsDedicated())
+		{
+			allocation.Heap = CreateHeap(pPool);
+			pool.Heaps[allocation.Heap]->TryAllocate(pSize, pAlignment, allocation.Block, pOwner);
+		}
+		allocation.Offset = allocation.Block.Offset;
+		allocation.Size = allocation.Block.Size;
+		return allocation;
+	}
+
+	void RhiMemoryAllocator::Free(const RhiMemoryAllocation& pAllocation)
+	{
+		std::lock_guard lock(m_Mutex);
+		Pool& pool = m_Pools[static_cast<size_t>(pAllocation.Pool)];
+		if (pAllocation.IsDedicated())
+		{
+			--pool.DedicatedCount;
+			pool.DedicatedBytes -= pAllocation.Size;
+			return;
+		}
+
+		std::unique_ptr<TlsfAllocator>& heap = pool.Heaps[pAllocation.Heap];
+		heap->Free(pAllocation.Block);
+		if (!heap->IsEmpty())
+			return;
+
+		// The last heap is kept, the next resource would create it again.
+		const auto heapCount = std::count_if(pool.Heaps.begin(), pool.Heaps.end(),
+		                                     [](const std::unique_ptr<TlsfAllocator>& pHeap) { return pHeap != nullptr; });
+		if (heapCount > 1)
+		{
+			heap.reset();
+			m_ReleaseHeap(pAllocation.Pool, pAllocation.Heap);
+			++m_HeapsReleased;
+		}
+	}
+
+	uint64_t RhiMemoryAllocator::PlanDefragmentation(const RhiMemoryPool pPool, const uint64_t pMaxBytes,
+	                                                 std::vector<Move>& pOutMoves)
+	{
+		std::lock_guard lock(m_Mutex);
+		Pool& pool = m_Pools[static_cast<size_t>(pPool)];
+
+		// The least used heap, its resources are the cheapest to move.
+		uint32_t source = k_RhiDedicatedHeap;
+		uint32_t heapCount = 0;
+		for (uint32_t heap = 0; heap < pool.Heaps.size(); ++heap)
+		{
+			if (!pool.Heaps[heap])
+				continue;
+			++heapCount;
+			if (source == k_RhiDedicatedHeap || pool.Heaps[heap]->GetUsedBytes() < pool.Heaps[source]->GetUsedBytes())
+				source = heap;
+		}
+		if (heapCount < 2)
+			return 0;
+
+		std::vector<TlsfAllocation> allocations;
+		pool.Heaps[source]->GetAllocations(allocations);
+		uint64_t plannedBytes = 0;
+		for (const TlsfAllocation& block : allocations)
+		{
+			if (plannedBytes + block.Size > pMaxBytes)
+				break;
+
+			// The alignment of the resource is not known, its offset's is kept.
+			const uint64_t alignment = block.Offset == 0
+				                           ? k_MaxMoveAlignment
+				                           : (std::min)(uint64_t(1) << std::countr_zero(block.Offset),
+				                                        k_MaxMoveAlignment);
+			RhiMemoryAllocation to;
+			to.Pool = pPool;
+			for (uint32_t heap = 0; heap < pool.Heaps.size(); ++heap)
+			{
+				if (heap != source && pool.Heaps[heap] &&
+					pool.Heaps[heap]->TryAllocate(block.Size, alignment, to.Block, block.UserData))
+				{
+					to.Heap = heap;
+					break;
+				}
+			}
+			// The other heaps are full, moving the rest would not release the heap.
+			if (to.IsDedicated())
+				break;
+
+			to.Offset = to.Block.Offset;
+			to.Size = to.Block.Size;
+			const RhiMemoryAllocation from = {pPool, source, block.Offset, block.Size, block};
+			pOutMoves.push_back({block.UserData, from, to});
+			plannedBytes += block.Size;
+		}
+		return plannedBytes;
+	}
+
+	RhiMemoryAllocator::Stats RhiMemoryAllocator::GetStats() const
+	{
+		std::lock_guard lock(m_Mutex);
+		Stats stats;
+		stats.HeapsCreated = m_HeapsCreated;
+		stats.HeapsReleased = m_HeapsReleased;
+		for (size_t i = 0; i < static_cast<size_t>(RhiMemoryPool::Count); ++i)
+		{
+			PoolStats& poolStats = stats.Pools[i];
+			poolStats.DedicatedCount = m_Pools[i].DedicatedCount;
+			poolStats.DedicatedBytes = m_Pools[i].DedicatedBytes;
+			for (const std::unique_ptr<TlsfAllocator>& heap : m_Pools[i].Heaps)
+			{
+				if (!heap)
+					continue;
+				const TlsfAllocator::Stats heapStats = heap->GetStats();
+				++poolStats.HeapCount;
+				poolStats.HeapBytes += heapStats.Capacity;
+				poolStats.UsedBytes += heapStats.UsedBytes;
+				poolStats.AllocationCount += heapStats.AllocationCount;
+				poolStats.LargestFreeBlock = (std::max)(poolStats.LargestFreeBlock, heapStats.LargestFreeBlock);
+				poolStats.FreeBlockCount += heapStats.FreeBlockCount;
+			}
+		}
+		return stats;
+	}
+
+	uint32_t RhiMemoryAllocator::CreateHeap(const RhiMemoryPool pPool)
+	{
+		std::vector<std::unique_ptr<TlsfAllocator>>& heaps = m_Pools[static_cast<size_t>(pPool)].Heaps;
+		auto slot = std::find(heaps.begin(), heaps.end(), nullptr);
+		if (slot == heaps.end())
+			slot = heaps.insert(heaps.end(), nullptr);
+		*slot = std::make_unique<TlsfAllocator>(m_HeapSize, k_Granularity);
+
+		const auto heap = static_cast<uint32_t>(slot - heaps.begin());
+		m_CreateHeap(pPool, heap, m_HeapSize);
+		++m_HeapsCreated;
+		return heap;
+	}
+}
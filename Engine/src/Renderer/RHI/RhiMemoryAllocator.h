@@ -0,0 +1,162 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "RhiTypes.h"
+#include "Core/TlsfAllocator.h"
+
+namespace Engine
+{
+	/// <summary>
+	/// Kind of heap a resource is placed in. Heaps hold one kind only : buffers or textures, as the first
+	/// resource heap tier requires, and one CPU access.
+	/// </summary>
+	enum class RhiMemoryPool : uint8_t
+	{
+		DefaultBuffers,
+		UploadBuffers,
+		ReadbackBuffers,
+		Textures,
+		Count
+	};
+
+	constexpr uint32_t k_RhiDedicatedHeap = UINT32_MAX;
+
+	inline RhiMemoryPool GetBufferMemoryPool(const RhiHeapType pHeap)
+	{
+		switch (pHeap)
+		{
+		case RhiHeapType::Upload:
+			return RhiMemoryPool::UploadBuffers;
+		case RhiHeapType::Readback:
+			return RhiMemoryPool::ReadbackBuffers;
+		default:
+			return RhiMemoryPool::DefaultBuffers;
+		}
+	}
+
+	struct RhiMemoryAllocation
+	{
+		RhiMemoryPool Pool = RhiMemoryPool::DefaultBuffers;
+		// Heap of the pool, k_RhiDedicatedHeap when the resource has memory of its own.
+		uint32_t Heap = k_RhiDedicatedHeap;
+		uint64_t Offset = 0;
+		uint64_t Size = 0;
+		TlsfAllocation Block;
+
+		bool IsDedicated() const { return Heap == k_RhiDedicatedHeap; }
+	};
+
+	/// <summary>
+	/// Places resources in large heaps, one set of heaps per pool, each split by a TlsfAllocator. The heaps
+	/// themselves are created and released by the backend through callbacks, the allocator only hands out
+	/// (heap, offset) pairs : it runs the same without a GPU.
+	/// A resource larger than half a heap gets a dedicated allocation, the backend commits it on its own.
+	/// Heaps left empty are released, the last one of each pool excepted.
+	/// Thread safe.
+	/// </summary>
+	class RhiMemoryAllocator
+	{
+	public:
+		// Called with the allocator locked, they must not allocate from it.
+		using CreateHeapCallback = std::function<void(RhiMemoryPool pPool, uint32_t pHeap, uint64_t pSize)>;
+		using ReleaseHeapCallback = std::function<void(RhiMemoryPool pPool, uint32_t pHeap)>;
+
+		struct PoolStats
+		{
+			uint32_t HeapCount = 0;
+			uint64_t HeapBytes = 0;
+			// Bytes of the heaps given to resources, alignment included.
+			uint64_t UsedBytes = 0;
+			uint32_t AllocationCount = 0;
+			uint64_t LargestFreeBlock = 0;
+			uint32_t FreeBlockCount = 0;
+			uint32_t DedicatedCount = 0;
+			uint64_t DedicatedBytes = 0;
+
+			/// <returns> The part of the heaps in use. </returns>
+			float GetOccupancy() const
+			{
+				return HeapBytes == 0 ? 0.0f : static_cast<float>(UsedBytes) / static_cast<float>(HeapBytes);
+			}
+
+			/// <returns> 0 when the free memory of the heaps is one block, toward 1 as it is split. </returns>
+			float GetFragmentation() const
+			{
+				const uint64_t freeBytes = HeapBytes - UsedBytes;
+				return freeBytes == 0
+					       ? 0.0f
+					       : 1.0f - static_cast<float>(LargestFreeBlock) / static_cast<float>(freeBytes);
+			}
+		};
+
+		struct Stats
+		{
+			PoolStats Pools[static_cast<size_t>(RhiMemoryPool::Count)];
+			uint32_t HeapsCreated = 0;
+			uint32_t HeapsReleased = 0;
+
+			/// <returns> Every pool summed, the largest free block is the largest of them. </returns>
+			PoolStats GetTotal() const;
+		};
+
+		/// <summary>
+		/// A resource to place elsewhere : the backend creates it at To, copies its content, then frees From.
+		/// </summary>
+		struct Move
+		{
+			void* Owner;
+			RhiMemoryAllocation From;
+			RhiMemoryAllocation To;
+		};
+
+		static constexpr uint64_t k_DefaultHeapSize = 64ull << 20;
+		// Smallest placement alignment, the one of small textures.
+		static constexpr uint64_t k_Granularity = 4096;
+
+		RhiMemoryAllocator(CreateHeapCallback pCreateHeap, ReleaseHeapCallback pReleaseHeap,
+		                   uint64_t pHeapSize = k_DefaultHeapSize);
+
+		RhiMemoryAllocator(const RhiMemoryAllocator&) = delete;
+		RhiMemoryAllocator& operator=(const RhiMemoryAllocator&) = delete;
+
+		/// <param name="pOwner"> : handed back by PlanDefragmentation()</param>
+		/// <returns> A place in the first heap of the pool with room, in a new heap when none has. </returns>
+		RhiMemoryAllocation Allocate(RhiMemoryPool pPool, uint64_t pSize, uint64_t pAlignment, void* pOwner);
+		void Free(const RhiMemoryAllocation& pAllocation);
+
+		/// <summary>
+		/// Defragmentation hook : empties the least occupied heap of pPool into the free space of the others,
+		/// so it can be released. The destinations are allocated, nothing moves before the backend does it.
+		/// </summary>
+		/// <param name="pMaxBytes"> : bytes to move at most, the rest is planned by the next calls</param>
+		/// <returns> The bytes planned. </returns>
+		uint64_t PlanDefragmentation(RhiMemoryPool pPool, uint64_t pMaxBytes, std::vector<Move>& pOutMoves);
+
+		[[nodiscard]] Stats GetStats() const;
+		[[nodiscard]] uint64_t GetHeapSize() const { return m_HeapSize; }
+
+	private:
+		struct Pool
+		{
+			// Released heaps leave a null slot, reused by the next heap.
+			std::vector<std::unique_ptr<TlsfAllocator>> Heaps;
+			uint32_t DedicatedCount = 0;
+			uint64_t DedicatedBytes = 0;
+		};
+
+		uint32_t CreateHeap(RhiMemoryPool pPool);
+
+		CreateHeapCallback m_CreateHeap;
+		ReleaseHeapCallback m_ReleaseHeap;
+		uint64_t m_HeapSize;
+
+		mutable std::mutex m_Mutex;
+		Pool m_Pools[static_cast<size_t>(RhiMemoryPool::Count)];
+		uint32_t m_HeapsCreated = 0;
+		uint32_t m_HeapsReleased = 0;
+	};
+}
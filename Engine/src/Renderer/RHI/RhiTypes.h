@@ -0,0 +1,309 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace Engine
+{
+	// Platform neutral description types of the render hardware interface (see RhiDevice).
+	// They mirror the D3D12 ones the engine was written against, without any Windows header.
+
+	class RhiResource;
+
+	// GPU virtual address of a buffer, or of a byte inside it.
+	using RhiGpuAddress = uint64_t;
+	// Shader visible descriptor (a D3D12_GPU_DESCRIPTOR_HANDLE::ptr on the D3D12 backend).
+	using RhiDescriptor = uint64_t;
+
+	// Constant buffers can only be viewed at multiples of 256 bytes.
+	constexpr uint32_t k_RhiConstantBufferAlignment = 256;
+	// Texture data copied from a buffer starts at multiples of 512 bytes, its rows at multiples of 256 bytes.
+	constexpr uint32_t k_RhiTexturePlacementAlignment = 512;
+	constexpr uint32_t k_RhiTextureRowPitchAlignment = 256;
+	// Resources placed in a heap start at multiples of 64 KB, textures of 64 KB or less at multiples of 4 KB.
+	constexpr uint32_t k_RhiResourcePlacementAlignment = 64 * 1024;
+	constexpr uint32_t k_RhiSmallResourcePlacementAlignment = 4 * 1024;
+
+	inline uint64_t RhiAlign(const uint64_t pValue, const uint64_t pAlignment)
+	{
+		return (pValue + pAlignment - 1) & ~(pAlignment - 1);
+	}
+
+	enum class RhiFormat : uint8_t
+	{
+		Unknown,
+		R8G8B8A8Unorm,
+		D24UnormS8Uint,
+		R16Uint,
+		R32Uint,
+		R32Float,
+		R32G32Float,
+		R32G32B32Float,
+		R32G32B32A32Float,
+	};
+
+	enum class RhiHeapType : uint8_t
+	{
+		Default, // GPU only
+		Upload, // CPU write, persistently mapped
+		Readback, // CPU read, persistently mapped
+	};
+
+	enum class RhiQueueType : uint8_t
+	{
+		Graphics,
+		Copy,
+	};
+
+	enum class RhiResourceState : uint8_t
+	{
+		Common,
+		VertexAndConstantBuffer,
+		IndexBuffer,
+		RenderTarget,
+		DepthWrite,
+		ShaderResource,
+		CopySource,
+		CopyDest,
+		GenericRead,
+		Present,
+		UnorderedAccess,
+		IndirectArgument,
+	};
+
+	enum class RhiPrimitiveTopology : uint8_t
+	{
+		TriangleList,
+		TriangleStrip,
+		LineList,
+		PointList,
+	};
+
+	enum class RhiRootParameterType : uint8_t
+	{
+		ConstantBuffer, // root CBV, bound with SetGraphicsRootConstantBufferView
+		DescriptorTable, // one SRV range, bound with SetGraphicsRootDescriptorTable
+		ShaderResource, // root SRV of a (structured) buffer, bound with SetGraphicsRootShaderResourceView
+		Constants, // 32 bit values stored in the root signature, bound with SetGraphicsRoot32BitConstant
+		UnorderedAccess, // root UAV of a (structured) buffer, bound with SetComputeRootUnorderedAccessView
+	};
+
+	enum class RhiShaderVisibility : uint8_t
+	{
+		All,
+		Vertex,
+		Pixel,
+	};
+
+	struct RhiBufferDesc
+	{
+		uint64_t Size = 0;
+		RhiHeapType Heap = RhiHeapType::Default;
+		// Written by compute shaders through a RhiRootParameterType::UnorderedAccess parameter.
+		bool AllowUnorderedAccess = false;
+	};
+
+	struct RhiTextureDesc
+	{
+		uint32_t Width = 1;
+		uint32_t Height = 1;
+		uint16_t MipLevels = 1;
+		RhiFormat Format = RhiFormat::R8G8B8A8Unorm;
+		uint32_t SampleCount = 1;
+		uint32_t SampleQuality = 0;
+		bool IsRenderTarget = false;
+		bool IsDepthStencil = false;
+
+		bool operator==(const RhiTextureDesc& pOther) const = default;
+	};
+
+	/// <summary>
+	/// Bytes a resource takes in a heap, see RhiDevice::GetTextureAllocationInfo.
+	/// </summary>
+	struct RhiResourceAllocationInfo
+	{
+		uint64_t Size = 0;
+		uint64_t Alignment = 0;
+	};
+
+	enum class RhiBarrierType : uint8_t
+	{
+		Transition,
+		// Resource becomes the one of the placed resources sharing its memory in use, its content is undefined.
+		Aliasing,
+		// Waits for the previous dispatches' writes to Resource.
+		UnorderedAccess,
+	};
+
+	/// <summary>
+	/// One barrier of RhiCommandList::Barriers.
+	/// </summary>
+	struct RhiBarrier
+	{
+		RhiBarrierType Type = RhiBarrierType::Transition;
+		const RhiResource* Resource = nullptr;
+		// Transitions only.
+		RhiResourceState Before = RhiResourceState::Common;
+		RhiResourceState After = RhiResourceState::Common;
+
+		bool operator==(const RhiBarrier& pOther) const = default;
+	};
+
+	/// <summary>
+	/// Layout of a texture subresource in a buffer, as RhiCommandList::CopyBufferToTexture reads it.
+	/// </summary>
+	struct RhiTextureFootprint
+	{
+		// From the start of the texture's data, a multiple of k_RhiTexturePlacementAlignment.
+		uint64_t Offset = 0;
+		uint32_t Width = 1;
+		uint32_t Height = 1;
+		uint32_t Depth = 1;
+		// Bytes between two rows in the buffer, a multiple of k_RhiTextureRowPitchAlignment.
+		uint32_t RowPitch = 0;
+		// Rows of a slice, fewer than Height for block compressed formats.
+		uint32_t RowCount = 0;
+		// Bytes of a row without its padding.
+		uint64_t RowSize = 0;
+	};
+
+	/// <summary>
+	/// CPU copy of a texture subresource, rows of RowPitch bytes and slices of SlicePitch bytes.
+	/// </summary>
+	struct RhiSubresourceData
+	{
+		const void* Data = nullptr;
+		uint64_t RowPitch = 0;
+		uint64_t SlicePitch = 0;
+	};
+
+	struct RhiVertexBufferView
+	{
+		RhiGpuAddress Address = 0;
+		uint32_t Size = 0;
+		uint32_t Stride = 0;
+
+		bool operator==(const RhiVertexBufferView& pOther) const = default;
+	};
+
+	struct RhiIndexBufferView
+	{
+		RhiGpuAddress Address = 0;
+		uint32_t Size = 0;
+		RhiFormat Format = RhiFormat::R16Uint;
+
+		bool operator==(const RhiIndexBufferView& pOther) const = default;
+	};
+
+	struct RhiViewport
+	{
+		float TopLeftX = 0.f;
+		float TopLeftY = 0.f;
+		float Width = 0.f;
+		float Height = 0.f;
+		float MinDepth = 0.f;
+		float MaxDepth = 1.f;
+	};
+
+	struct RhiRect
+	{
+		int32_t Left = 0;
+		int32_t Top = 0;
+		int32_t Right = 0;
+		int32_t Bottom = 0;
+	};
+
+	struct RhiInputElement
+	{
+		const char* Semantic = nullptr;
+		uint32_t SemanticIndex = 0;
+		RhiFormat Format = RhiFormat::Unknown;
+		uint32_t Offset = 0;
+	};
+
+	struct RhiRootParameter
+	{
+		// Descriptor table reaching to the end of the heap, read by the shaders as an unsized array.
+		static constexpr uint32_t k_UnboundedDescriptorCount = UINT32_MAX;
+
+		RhiRootParameterType Type = RhiRootParameterType::ConstantBuffer;
+		uint32_t ShaderRegister = 0;
+		RhiShaderVisibility Visibility = RhiShaderVisibility::All;
+		uint32_t RegisterSpace = 0;
+		// Number of 32 bit values of a Constants parameter.
+		uint32_t ConstantCount = 1;
+		// Number of shader resource views of a DescriptorTable parameter.
+		uint32_t DescriptorCount = 1;
+
+		bool operator==(const RhiRootParameter& pOther) const = default;
+	};
+
+	struct RhiShaderBytecode
+	{
+		const void* Data = nullptr;
+		size_t Size = 0;
+	};
+
+	/// <summary>
+	/// Everything needed to build a graphics or compute pipeline and its root signature. The bytecode is only
+	/// read during RhiDevice::CreatePipeline.
+	/// </summary>
+	struct RhiPipelineDesc
+	{
+		std::vector<RhiInputElement> InputLayout;
+		RhiShaderBytecode VertexShader;
+		RhiShaderBytecode PixelShader;
+		// Makes a compute pipeline : the input layout, graphics stages and target formats are ignored.
+		RhiShaderBytecode ComputeShader;
+
+		std::vector<RhiRootParameter> RootParameters;
+		// Adds the six point/linear/anisotropic wrap/clamp samplers at s0-s5.
+		bool UseStaticSamplers = false;
+
+		RhiFormat RenderTargetFormat = RhiFormat::R8G8B8A8Unorm;
+		RhiFormat DepthStencilFormat = RhiFormat::D24UnormS8Uint;
+		uint32_t SampleCount = 1;
+		uint32_t SampleQuality = 0;
+
+		// RhiPipeline::GetCachedBlob() of the same description, skips the driver's compilation. The pipeline is
+		// compiled again when the blob does not match the device or the driver anymore.
+		RhiShaderBytecode CachedBlob;
+	};
+
+	enum class RhiIndirectArgumentType : uint8_t
+	{
+		Constants, // 32 bit values written to a Constants root parameter
+		DrawIndexed, // a RhiDrawIndexedArguments
+	};
+
+	struct RhiIndirectArgument
+	{
+		RhiIndirectArgumentType Type = RhiIndirectArgumentType::DrawIndexed;
+		// Root parameter and first value written by a Constants argument.
+		uint32_t RootSlot = 0;
+		uint32_t ConstantOffset = 0;
+		uint32_t ConstantCount = 1;
+	};
+
+	/// <summary>
+	/// Layout of the commands RhiCommandList::ExecuteIndirect reads, the arguments one after the other.
+	/// A draw must be the last argument.
+	/// </summary>
+	struct RhiCommandSignatureDesc
+	{
+		std::vector<RhiIndirectArgument> Arguments;
+		// Bytes between two commands, at least the size of the arguments.
+		uint32_t ByteStride = 0;
+	};
+
+	/// <summary>
+	/// Same layout as D3D12_DRAW_INDEXED_ARGUMENTS.
+	/// </summary>
+	struct RhiDrawIndexedArguments
+	{
+		uint32_t IndexCountPerInstance = 0;
+		uint32_t InstanceCount = 0;
+		uint32_t StartIndexLocation = 0;
+		int32_t BaseVertexLocation = 0;
+		uint32_t StartInstanceLocation = 0;
+	};
+}
@@ -0,0 +1,275 @@
+#include "StateFilteringCommandList.h"
+
+namespace Engine
+{
+	uint64_t StateFilteringCommandList::Stats::GetIssuedCount() const
+	{
+		uint64_t count = 0;
+		for (const uint64_t issued : Issued)
+			count += issued;
+		return count;
+	}
+
+	uint64_t StateFilteringCommandList::Stats::GetFilteredCount() const
+	{
+		uint64_t count = 0;
+		for (const uint64_t filtered : Filtered)
+			count += filtered;
+		return count;
+	}
+
+	StateFilteringCommandList::Stats& StateFilteringCommandList::Stats::operator+=(const Stats& pOther)
+	{
+		for (size_t i = 0; i < static_cast<size_t>(StateType::Count); ++i)
+		{
+			Issued[i] += pOther.Issued[i];
+			Filtered[i] += pOther.Filtered[i];
+		}
+		return *this;
+	}
+
+	void StateFilteringCommandList::Begin(RhiCommandAllocator& pAllocator)
+	{
+		// A reset list starts without any state bound.
+		Invalidate();
+		m_Stats = Stats();
+		m_List.Begin(pAllocator);
+	}
+
+	void StateFilteringCommandList::End()
+	{
+		m_List.End();
+	}
+
+	void StateFilteringCommandList::SetPipeline(const RhiPipeline& pPipeline)
+	{
+		const void* rootSignature = pPipeline.GetRootSignatureId();
+		if (!m_IsEnabled || rootSignature != m_RootSignature)
+		{
+			Count(StateType::Pipeline, false);
+			Count(StateType::RootSignature, false);
+			m_List.SetPipeline(pPipeline);
+			m_Pipeline = &pPipeline;
+			m_RootSignature = rootSignature;
+			InvalidateRootArguments();
+			return;
+		}
+
+		// Same root signature : the root arguments bound so far stay valid.
+		Count(StateType::RootSignature, true);
+		SetPipelineState(pPipeline);
+	}
+
+	void StateFilteringCommandList::SetPipelineState(const RhiPipeline& pPipeline)
+	{
+		if (Count(StateType::Pipeline, m_Pipeline == &pPipeline))
+		{
+			m_List.SetPipelineState(pPipeline);
+			m_Pipeline = &pPipeline;
+		}
+	}
+
+	void StateFilteringCommandList::SetGraphicsRootConstantBufferView(const uint32_t pSlot, const RhiGpuAddress pAddress)
+	{
+		if (SetRootArgument(pSlot, RhiRootParameterType::ConstantBuffer, pAddress))
+			m_List.SetGraphicsRootConstantBufferView(pSlot, pAddress);
+	}
+
+	void StateFilteringCommandList::SetGraphicsRootDescriptorTable(const uint32_t pSlot, const RhiDescriptor pDescriptor)
+	{
+		if (SetRootArgument(pSlot, RhiRootParameterType::DescriptorTable, pDescriptor))
+			m_List.SetGraphicsRootDescriptorTable(pSlot, pDescriptor);
+	}
+
+	void StateFilteringCommandList::SetGraphicsRootShaderResourceView(const uint32_t pSlot, const RhiGpuAddress pAddress)
+	{
+		if (SetRootArgument(pSlot, RhiRootParameterType::ShaderResource, pAddress))
+			m_List.SetGraphicsRootShaderResourceView(pSlot, pAddress);
+	}
+
+	void StateFilteringCommandList::SetGraphicsRoot32BitConstant(const uint32_t pSlot, const uint32_t pValue,
+	                                                             const uint32_t pOffset)
+	{
+		if (pSlot >= k_MaxRootSlots || pOffset >= k_MaxRootConstants)
+		{
+			Count(StateType::RootArgument, false);
+			m_List.SetGraphicsRoot32BitConstant(pSlot, pValue, pOffset);
+			return;
+		}
+
+		const uint32_t bit = 1u << pOffset;
+		if (Count(StateType::RootArgument, (m_BoundConstants[pSlot] & bit) && m_Constants[pSlot][pOffset] == pValue))
+		{
+			m_List.SetGraphicsRoot32BitConstant(pSlot, pValue, pOffset);
+			m_BoundConstants[pSlot] |= bit;
+			m_Constants[pSlot][pOffset] = pValue;
+		}
+	}
+
+	void StateFilteringCommandList::SetComputeRootConstantBufferView(const uint32_t pSlot, const RhiGpuAddress pAddress)
+	{
+		Count(StateType::RootArgument, false);
+		m_List.SetComputeRootConstantBufferView(pSlot, pAddress);
+	}
+
+	void StateFilteringCommandList::SetComputeRootShaderResourceView(const uint32_t pSlot, const RhiGpuAddress pAddress)
+	{
+		Count(StateType::RootArgument, false);
+		m_List.SetComputeRootShaderResourceView(pSlot, pAddress);
+	}
+
+	void StateFilteringCommandList::SetComputeRootUnorderedAccessView(const uint32_t pSlot,
+	                                                                  const RhiGpuAddress pAddress)
+	{
+		Count(StateType::RootArgument, false);
+		m_List.SetComputeRootUnorderedAccessView(pSlot, pAddress);
+	}
+
+	void StateFilteringCommandList::SetVertexBuffer(const RhiVertexBufferView& pView)
+	{
+		if (Count(StateType::VertexBuffer, m_HasVertexBuffer && m_VertexBuffer == pView))
+		{
+			m_List.SetVertexBuffer(pView);
+			m_VertexBuffer = pView;
+			m_HasVertexBuffer = true;
+		}
+	}
+
+	void StateFilteringCommandList::SetIndexBuffer(const RhiIndexBufferView& pView)
+	{
+		if (Count(StateType::IndexBuffer, m_HasIndexBuffer && m_IndexBuffer == pView))
+		{
+			m_List.SetIndexBuffer(pView);
+			m_IndexBuffer = pView;
+			m_HasIndexBuffer = true;
+		}
+	}
+
+	void StateFilteringCommandList::SetPrimitiveTopology(const RhiPrimitiveTopology pTopology)
+	{
+		if (Count(StateType::Topology, m_HasTopology && m_Topology == pTopology))
+		{
+			m_List.SetPrimitiveTopology(pTopology);
+			m_Topology = pTopology;
+			m_HasTopology = true;
+		}
+	}
+
+	void StateFilteringCommandList::SetViewport(const RhiViewport& pViewport)
+	{
+		m_List.SetViewport(pViewport);
+	}
+
+	void StateFilteringCommandList::SetScissorRect(const RhiRect& pRect)
+	{
+		m_List.SetScissorRect(pRect);
+	}
+
+	void StateFilteringCommandList::SetRenderTarget(const RhiTexture* pColor, const RhiTexture* pDepthStencil)
+	{
+		m_List.SetRenderTarget(pColor, pDepthStencil);
+	}
+
+	void StateFilteringCommandList::ClearRenderTarget(const RhiTexture& pTarget, const float pColor[4])
+	{
+		m_List.ClearRenderTarget(pTarget, pColor);
+	}
+
+	void StateFilteringCommandList::ClearDepthStencil(const RhiTexture& pTarget, const float pDepth,
+	                                                  const uint8_t pStencil)
+	{
+		m_List.ClearDepthStencil(pTarget, pDepth, pStencil);
+	}
+
+	void StateFilteringCommandList::Barrier(const RhiResource& pResource, const RhiResourceState pBefore,
+	                                        const RhiResourceState pAfter)
+	{
+		m_List.Barrier(pResource, pBefore, pAfter);
+	}
+
+	void StateFilteringCommandList::UnorderedAccessBarrier(const RhiResource& pResource)
+	{
+		m_List.UnorderedAccessBarrier(pResource);
+	}
+
+	void StateFilteringCommandList::Barriers(const RhiBarrier* pBarriers, const uint32_t pCount)
+	{
+		m_List.Barriers(pBarriers, pCount);
+	}
+
+	void StateFilteringCommandList::DrawIndexedInstanced(const uint32_t pIndexCount, const uint32_t pInstanceCount,
+	                                                     const uint32_t pStartIndex, const int32_t pBaseVertex,
+	                                                     const uint32_t pStartInstance)
+	{
+		m_List.DrawIndexedInstanced(pIndexCount, pInstanceCount, pStartIndex, pBaseVertex, pStartInstance);
+	}
+
+	void StateFilteringCommandList::ExecuteIndirect(const RhiCommandSignature& pSignature,
+	                                                const uint32_t pMaxCommandCount, const RhiBuffer& pArguments,
+	                                                const uint64_t pArgumentOffset, const RhiBuffer* pCount,
+	                                                const uint64_t pCountOffset)
+	{
+		m_List.ExecuteIndirect(pSignature, pMaxCommandCount, pArguments, pArgumentOffset, pCount, pCountOffset);
+		// The root arguments the commands set are undefined afterward.
+		InvalidateRootArguments();
+	}
+
+	void StateFilteringCommandList::Dispatch(const uint32_t pGroupCountX, const uint32_t pGroupCountY,
+	                                         const uint32_t pGroupCountZ)
+	{
+		m_List.Dispatch(pGroupCountX, pGroupCountY, pGroupCountZ);
+	}
+
+	void StateFilteringCommandList::CopyBufferRegion(const RhiBuffer& pDestination, const uint64_t pDestinationOffset,
+	                                                 const RhiBuffer& pSource, const uint64_t pSourceOffset,
+	                                                 const uint64_t pSize)
+	{
+		m_List.CopyBufferRegion(pDestination, pDestinationOffset, pSource, pSourceOffset, pSize);
+	}
+
+	void StateFilteringCommandList::CopyBufferToTexture(const RhiTexture& pDestination, const uint32_t pSubresource,
+	                                                    const RhiBuffer& pSource, const uint64_t pSourceOffset,
+	                                                    const RhiTextureFootprint& pFootprint)
+	{
+		m_List.CopyBufferToTexture(pDestination, pSubresource, pSource, pSourceOffset, pFootprint);
+	}
+
+	void StateFilteringCommandList::Invalidate()
+	{
+		m_Pipeline = nullptr;
+		m_RootSignature = nullptr;
+		InvalidateRootArguments();
+		m_HasVertexBuffer = false;
+		m_HasIndexBuffer = false;
+		m_HasTopology = false;
+	}
+
+	bool StateFilteringCommandList::Count(const StateType pType, const bool pIsRedundant)
+	{
+		const bool isIssued = !m_IsEnabled || !pIsRedundant;
+		++(isIssued ? m_Stats.Issued : m_Stats.Filtered)[static_cast<size_t>(pType)];
+		return isIssued;
+	}
+
+	bool StateFilteringCommandList::SetRootArgument(const uint32_t pSlot, const RhiRootParameterType pType,
+	                                                const uint64_t pValue)
+	{
+		if (pSlot >= k_MaxRootSlots)
+			return Count(StateType::RootArgument, false);
+
+		RootArgument& argument = m_RootArguments[pSlot];
+		if (!Count(StateType::RootArgument, argument.IsBound && argument.Type == pType && argument.Value == pValue))
+			return false;
+
+		argument = {pType, pValue, true};
+		return true;
+	}
+
+	void StateFilteringCommandList::InvalidateRootArguments()
+	{
+		for (RootArgument& argument : m_RootArguments)
+			argument.IsBound = false;
+		for (uint32_t& constants : m_BoundConstants)
+			constants = 0;
+	}
+}
@@ -0,0 +1,129 @@
+#pragma once
+#include "RhiDevice.h"
+
+namespace Engine
+{
+	/// <summary>
+	/// Wraps a command list and drops the calls that would bind what is already bound : pipeline state, root
+	/// signature, root arguments, vertex and index buffers and topology. The bound state is forgotten on Begin(),
+	/// so everything recorded into the wrapped list between Begin() and End() has to go through the wrapper.
+	/// Draws, dispatches, barriers, copies, render target calls and compute root arguments are always forwarded.
+	/// A compute pipeline is tracked as a root signature change : the graphics root arguments are bound again
+	/// after it, which is redundant but never wrong. ExecuteIndirect() forgets the root arguments too.
+	/// </summary>
+	class StateFilteringCommandList : public RhiCommandList
+	{
+	public:
+		enum class StateType : uint8_t
+		{
+			Pipeline,
+			RootSignature,
+			RootArgument,
+			VertexBuffer,
+			IndexBuffer,
+			Topology,
+			Count
+		};
+
+		struct Stats
+		{
+			// Calls forwarded to the wrapped list and calls dropped, per type of state, since Begin().
+			uint64_t Issued[static_cast<size_t>(StateType::Count)] = {};
+			uint64_t Filtered[static_cast<size_t>(StateType::Count)] = {};
+
+			uint64_t GetIssuedCount() const;
+			uint64_t GetFilteredCount() const;
+
+			Stats& operator+=(const Stats& pOther);
+		};
+
+		// Root arguments of higher slots, or constants at higher offsets, are always forwarded.
+		static constexpr uint32_t k_MaxRootSlots = 16;
+		static constexpr uint32_t k_MaxRootConstants = 4;
+
+		explicit StateFilteringCommandList(RhiCommandList& pList) : m_List(pList) {}
+
+		void Begin(RhiCommandAllocator& pAllocator) override;
+		void End() override;
+
+		void SetPipeline(const RhiPipeline& pPipeline) override;
+		void SetPipelineState(const RhiPipeline& pPipeline) override;
+		void SetGraphicsRootConstantBufferView(uint32_t pSlot, RhiGpuAddress pAddress) override;
+		void SetGraphicsRootDescriptorTable(uint32_t pSlot, RhiDescriptor pDescriptor) override;
+		void SetGraphicsRootShaderResourceView(uint32_t pSlot, RhiGpuAddress pAddress) override;
+		void SetGraphicsRoot32BitConstant(uint32_t pSlot, uint32_t pValue, uint32_t pOffset) override;
+		void SetComputeRootConstantBufferView(uint32_t pSlot, RhiGpuAddress pAddress) override;
+		void SetComputeRootShaderResourceView(uint32_t pSlot, RhiGpuAddress pAddress) override;
+		void SetComputeRootUnorderedAccessView(uint32_t pSlot, RhiGpuAddress pAddress) override;
+
+		void SetVertexBuffer(const RhiVertexBufferView& pView) override;
+		void SetIndexBuffer(const RhiIndexBufferView& pView) override;
+		void SetPrimitiveTopology(RhiPrimitiveTopology pTopology) override;
+
+		void SetViewport(const RhiViewport& pViewport) override;
+		void SetScissorRect(const RhiRect& pRect) override;
+		void SetRenderTarget(const RhiTexture* pColor, const RhiTexture* pDepthStencil) override;
+		void ClearRenderTarget(const RhiTexture& pTarget, const float pColor[4]) override;
+		void ClearDepthStencil(const RhiTexture& pTarget, float pDepth, uint8_t pStencil) override;
+
+		void Barrier(const RhiResource& pResource, RhiResourceState pBefore, RhiResourceState pAfter) override;
+		void UnorderedAccessBarrier(const RhiResource& pResource) override;
+		void Barriers(const RhiBarrier* pBarriers, uint32_t pCount) override;
+
+		void DrawIndexedInstanced(uint32_t pIndexCount, uint32_t pInstanceCount, uint32_t pStartIndex,
+		                          int32_t pBaseVertex, uint32_t pStartInstance) override;
+		void ExecuteIndirect(const RhiCommandSignature& pSignature, uint32_t pMaxCommandCount,
+		                     const RhiBuffer& pArguments, uint64_t pArgumentOffset, const RhiBuffer* pCount,
+		                     uint64_t pCountOffset) override;
+		void Dispatch(uint32_t pGroupCountX, uint32_t pGroupCountY, uint32_t pGroupCountZ) override;
+
+		void CopyBufferRegion(const RhiBuffer& pDestination, uint64_t pDestinationOffset, const RhiBuffer& pSource,
+		                      uint64_t pSourceOffset, uint64_t pSize) override;
+		void CopyBufferToTexture(const RhiTexture& pDestination, uint32_t pSubresource, const RhiBuffer& pSource,
+		                         uint64_t pSourceOffset, const RhiTextureFootprint& pFootprint) override;
+
+		/// <summary>
+		/// Forgets the bound state, for when the wrapped list was recorded into directly.
+		/// </summary>
+		void Invalidate();
+
+		/// <summary>
+		/// When disabled every call is forwarded (and counted as issued), to compare against the filtering.
+		/// </summary>
+		void SetEnabled(const bool pIsEnabled) { m_IsEnabled = pIsEnabled; }
+		[[nodiscard]] bool IsEnabled() const { return m_IsEnabled; }
+
+		[[nodiscard]] const Stats& GetStats() const { return m_Stats; }
+
+	private:
+		struct RootArgument
+		{
+			RhiRootParameterType Type = RhiRootParameterType::ConstantBuffer;
+			uint64_t Value = 0;
+			bool IsBound = false;
+		};
+
+		/// <returns> True when the call has to be forwarded, counts it either way. </returns>
+		bool Count(StateType pType, bool pIsRedundant);
+		bool SetRootArgument(uint32_t pSlot, RhiRootParameterType pType, uint64_t pValue);
+		void InvalidateRootArguments();
+
+		RhiCommandList& m_List;
+		bool m_IsEnabled = true;
+
+		const RhiPipeline* m_Pipeline = nullptr;
+		const void* m_RootSignature = nullptr;
+		RootArgument m_RootArguments[k_MaxRootSlots];
+		// One bit per constant offset, per slot.
+		uint32_t m_BoundConstants[k_MaxRootSlots] = {};
+		uint32_t m_Constants[k_MaxRootSlots][k_MaxRootConstants] = {};
+		RhiVertexBufferView m_VertexBuffer;
+		RhiIndexBufferView m_IndexBuffer;
+		bool m_HasVertexBuffer = false;
+		bool m_HasIndexBuffer = false;
+		bool m_HasTopology = false;
+		RhiPrimitiveTopology m_Topology = RhiPrimitiveTopology::TriangleList;
+
+		Stats m_Stats;
+	};
+}
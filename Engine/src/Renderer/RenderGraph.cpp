@@ -0,0 +1,386 @@
+#include "RenderGraph.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace Engine
+{
+	RenderGraph::PassBuilder& RenderGraph::PassBuilder::Read(const TextureHandle pTexture,
+	                                                         const RhiResourceState pState)
+	{
+		m_Graph.AddAccess(m_Pass, pTexture, pState, false);
+		return *this;
+	}
+
+	RenderGraph::PassBuilder& RenderGraph::PassBuilder::Write(const TextureHandle pTexture,
+	                                                          const RhiResourceState pState)
+	{
+		m_Graph.AddAccess(m_Pass, pTexture, pState, true);
+		return *this;
+	}
+
+	RenderGraph::PassBuilder& RenderGraph::PassBuilder::SetSideEffects()
+	{
+		m_Graph.m_Passes[m_Pass].HasSideEffects = true;
+		return *this;
+	}
+
+	RenderGraph::RenderGraph(RhiDevice& pDevice, const uint32_t pFrameCount)
+		: m_Device(pDevice), m_FrameCount(pFrameCount)
+	{
+	}
+
+	RenderGraph::~RenderGraph()
+	{
+		// The placed textures go before the heaps they are in.
+		m_RetiredTextures.clear();
+		m_PlacedTextures.clear();
+	}
+
+	void RenderGraph::Reset()
+	{
+		++m_FrameNumber;
+		std::erase_if(m_RetiredTextures, [this](const auto& pRetired)
+		{
+			return m_FrameNumber - pRetired.first >= m_FrameCount;
+		});
+		std::erase_if(m_RetiredHeaps, [this](const auto& pRetired)
+		{
+			return m_FrameNumber - pRetired.first >= m_FrameCount;
+		});
+
+		m_Passes.clear();
+		m_Textures.clear();
+		m_FinalBarriers.clear();
+		m_NextPass = 0;
+		m_IsRealized = false;
+	}
+
+	RenderGraph::TextureHandle RenderGraph::ImportTexture(const char* pName, const RhiTexture& pTexture,
+	                                                      const RhiResourceState pInitialState,
+	                                                      const RhiResourceState pFinalState)
+	{
+		Texture& texture = m_Textures.emplace_back();
+		texture.Name = pName;
+		texture.Imported = &pTexture;
+		texture.Desc = pTexture.GetDesc();
+		texture.InitialState = pInitialState;
+		texture.FinalState = pFinalState;
+		return static_cast<TextureHandle>(m_Textures.size() - 1);
+	}
+
+	RenderGraph::TextureHandle RenderGraph::CreateTexture(const char* pName, const RhiTextureDesc& pDesc)
+	{
+		assert((pDesc.IsRenderTarget || pDesc.IsDepthStencil) && "Transients are render targets or depth stencils");
+		Texture& texture = m_Textures.emplace_back();
+		texture.Name = pName;
+		texture.Desc = pDesc;
+		return static_cast<TextureHandle>(m_Textures.size() - 1);
+	}
+
+	RenderGraph::PassBuilder RenderGraph::AddPass(const char* pName, ExecuteCallback pExecute)
+	{
+		Pass& pass = m_Passes.emplace_back();
+		pass.Name = pName;
+		pass.Execute = std::move(pExecute);
+		return {*this, static_cast<uint32_t>(m_Passes.size() - 1)};
+	}
+
+	void RenderGraph::AddAccess(const uint32_t pPass, const TextureHandle pTexture, const RhiResourceState pState,
+	                            const bool pIsWrite)
+	{
+		std::vector<Access>& accesses = m_Passes[pPass].Accesses;
+		for (Access& access : accesses)
+		{
+			if (access.Texture != pTexture)
+				continue;
+			// Read and written in the same state, ex. a depth test that also writes depth.
+			assert(access.State == pState && "A pass uses a texture in a single state");
+			access.IsWrite |= pIsWrite;
+			return;
+		}
+		accesses.push_back({pTexture, pState, pIsWrite});
+	}
+
+	void RenderGraph::Compile()
+	{
+		m_Stats = {};
+		m_Stats.PassCount = static_cast<uint32_t>(m_Passes.size());
+		Cull();
+		PlanBarriers();
+		PlaceTransients();
+	}
+
+	void RenderGraph::Cull()
+	{
+		// From the last pass back : a pass is kept when it writes what a kept pass reads or an imported texture.
+		// Every earlier writer of a texture read is kept, even the ones a later writer fully overwrites.
+		std::vector<bool> isNeeded(m_Textures.size());
+		for (size_t i = 0; i < m_Textures.size(); ++i)
+			isNeeded[i] = m_Textures[i].Imported != nullptr;
+
+		for (auto pass = m_Passes.rbegin(); pass != m_Passes.rend(); ++pass)
+		{
+			bool isKept = pass->HasSideEffects;
+			for (const Access& access : pass->Accesses)
+				isKept |= access.IsWrite && isNeeded[access.Texture];
+			pass->IsCulled = !isKept;
+			if (!isKept)
+			{
+				++m_Stats.CulledPasses;
+				continue;
+			}
+			for (const Access& access : pass->Accesses)
+			{
+				if (!access.IsWrite)
+					isNeeded[access.Texture] = true;
+			}
+		}
+	}
+
+	void RenderGraph::PlanBarriers()
+	{
+		struct TrackedState
+		{
+			bool IsKnown = false;
+			RhiResourceState State = RhiResourceState::Common;
+			bool IsWritten = false;
+		};
+		std::vector<TrackedState> states(m_Textures.size());
+		for (size_t i = 0; i < m_Textures.size(); ++i)
+		{
+			if (m_Textures[i].Imported)
+				states[i] = {true, m_Textures[i].InitialState, false};
+		}
+
+		const auto countBatch = [this](const std::vector<PlannedBarrier>& pBarriers)
+		{
+			if (pBarriers.empty())
+				return;
+			m_Stats.BarrierCount += static_cast<uint32_t>(pBarriers.size());
+			++m_Stats.BarrierBatchCount;
+		};
+
+		uint32_t order = 0;
+		for (Pass& pass : m_Passes)
+		{
+			pass.Barriers.clear();
+			if (pass.IsCulled)
+				continue;
+
+			for (const Access& access : pass.Accesses)
+			{
+				Texture& texture = m_Textures[access.Texture];
+				if (!texture.Imported)
+				{
+					texture.FirstUse = (std::min)(texture.FirstUse, order);
+					texture.LastUse = order;
+				}
+
+				TrackedState& tracked = states[access.Texture];
+				if (!tracked.IsKnown)
+				{
+					// A transient takes over its memory from whatever was placed there before.
+					pass.Barriers.push_back({RhiBarrierType::Aliasing, access.Texture, {}, {}, false});
+					pass.Barriers.push_back({
+						RhiBarrierType::Transition, access.Texture, RhiResourceState::Common, access.State, true
+					});
+				}
+				else if (tracked.State != access.State)
+				{
+					pass.Barriers.push_back({
+						RhiBarrierType::Transition, access.Texture, tracked.State, access.State, false
+					});
+				}
+				else if (access.State == RhiResourceState::UnorderedAccess && (tracked.IsWritten || access.IsWrite))
+				{
+					pass.Barriers.push_back({RhiBarrierType::UnorderedAccess, access.Texture, {}, {}, false});
+				}
+				tracked = {true, access.State, access.IsWrite};
+			}
+			countBatch(pass.Barriers);
+			++order;
+		}
+
+		for (size_t i = 0; i < m_Textures.size(); ++i)
+		{
+			const Texture& texture = m_Textures[i];
+			if (texture.Imported && states[i].State != texture.FinalState)
+			{
+				m_FinalBarriers.push_back({
+					RhiBarrierType::Transition, static_cast<TextureHandle>(i), states[i].State, texture.FinalState,
+					false
+				});
+			}
+		}
+		countBatch(m_FinalBarriers);
+	}
+
+	void RenderGraph::PlaceTransients()
+	{
+		std::vector<TextureHandle> transients;
+		for (size_t i = 0; i < m_Textures.size(); ++i)
+		{
+			Texture& texture = m_Textures[i];
+			if (texture.Imported || texture.FirstUse == UINT32_MAX)
+				continue;
+			const RhiResourceAllocationInfo info = m_Device.GetTextureAllocationInfo(texture.Desc);
+			texture.Size = info.Size;
+			texture.Alignment = (std::max)(info.Alignment, uint64_t{1});
+			m_Stats.TransientBytes += texture.Size;
+			transients.push_back(static_cast<TextureHandle>(i));
+		}
+		m_Stats.TransientCount = static_cast<uint32_t>(transients.size());
+
+		// The largest first, each at the lowest offset the textures already placed and used at the same time
+		// leave free.
+		std::ranges::sort(transients, [this](const TextureHandle pA, const TextureHandle pB)
+		{
+			if (m_Textures[pA].Size != m_Textures[pB].Size)
+				return m_Textures[pA].Size > m_Textures[pB].Size;
+			return pA < pB;
+		});
+
+		for (size_t i = 0; i < transients.size(); ++i)
+		{
+			Texture& texture = m_Textures[transients[i]];
+			uint64_t offset = 0;
+			bool isMoved = true;
+			while (isMoved)
+			{
+				isMoved = false;
+				for (size_t j = 0; j < i; ++j)
+				{
+					const Texture& placed = m_Textures[transients[j]];
+					const bool isLiveTogether = placed.FirstUse <= texture.LastUse && texture.FirstUse <= placed.LastUse;
+					const bool isOverlapping = placed.Offset < offset + texture.Size && offset < placed.Offset + placed.Size;
+					if (isLiveTogether && isOverlapping)
+					{
+						offset = RhiAlign(placed.Offset + placed.Size, texture.Alignment);
+						isMoved = true;
+					}
+				}
+			}
+			texture.Offset = offset;
+			m_Stats.HeapBytes = (std::max)(m_Stats.HeapBytes, offset + texture.Size);
+		}
+	}
+
+	void RenderGraph::Realize()
+	{
+		if (m_Stats.HeapBytes > 0 && (!m_Heap || m_Heap->GetSize() < m_Stats.HeapBytes))
+		{
+			// The placed textures go with their heap, the frames in flight may still use both.
+			for (auto& placed : m_PlacedTextures)
+				m_RetiredTextures.emplace_back(m_FrameNumber, std::move(placed->Texture));
+			m_PlacedTextures.clear();
+			if (m_Heap)
+				m_RetiredHeaps.emplace_back(m_FrameNumber, std::move(m_Heap));
+			m_Heap = m_Device.CreateRenderTargetHeap(m_Stats.HeapBytes);
+		}
+
+		for (auto& placed : m_PlacedTextures)
+			placed->IsUsed = false;
+		for (Texture& texture : m_Textures)
+		{
+			if (texture.Imported || texture.FirstUse == UINT32_MAX)
+				continue;
+			// Transients of the same desc at the same offset are never used at the same time, they share it.
+			const auto found = std::ranges::find_if(m_PlacedTextures, [&texture](const auto& pPlaced)
+			{
+				return pPlaced->Desc == texture.Desc && pPlaced->Offset == texture.Offset;
+			});
+			if (found != m_PlacedTextures.end())
+			{
+				texture.Placed = found->get();
+			}
+			else
+			{
+				auto placed = std::make_unique<PlacedTexture>();
+				placed->Desc = texture.Desc;
+				placed->Offset = texture.Offset;
+				placed->Texture = m_Device.CreatePlacedTexture(texture.Desc, *m_Heap, texture.Offset);
+				texture.Placed = placed.get();
+				m_PlacedTextures.push_back(std::move(placed));
+			}
+			texture.Placed->IsUsed = true;
+		}
+
+		// The ones this frame does not use anymore, ex. after a resize.
+		for (auto& placed : m_PlacedTextures)
+		{
+			if (!placed->IsUsed)
+				m_RetiredTextures.emplace_back(m_FrameNumber, std::move(placed->Texture));
+		}
+		std::erase_if(m_PlacedTextures, [](const auto& pPlaced) { return !pPlaced->IsUsed; });
+	}
+
+	void RenderGraph::Execute(RhiCommandList& pCommandList, const uint32_t pLastPass)
+	{
+		if (!m_IsRealized)
+		{
+			Realize();
+			m_IsRealized = true;
+		}
+
+		const uint32_t end = pLastPass == UINT32_MAX
+			                     ? static_cast<uint32_t>(m_Passes.size())
+			                     : (std::min)(pLastPass + 1, static_cast<uint32_t>(m_Passes.size()));
+		for (; m_NextPass < end; ++m_NextPass)
+		{
+			Pass& pass = m_Passes[m_NextPass];
+			if (pass.IsCulled)
+				continue;
+			RecordBarriers(pCommandList, pass.Barriers);
+			pass.Execute(pCommandList);
+		}
+
+		if (pLastPass == UINT32_MAX)
+			RecordBarriers(pCommandList, m_FinalBarriers);
+	}
+
+	void RenderGraph::RecordBarriers(RhiCommandList& pCommandList, const std::vector<PlannedBarrier>& pBarriers)
+	{
+		m_Barriers.clear();
+		for (const PlannedBarrier& planned : pBarriers)
+		{
+			const Texture& texture = m_Textures[planned.Texture];
+			RhiBarrier barrier = {planned.Type, &GetTexture(planned.Texture), planned.Before, planned.After};
+			if (texture.Placed && planned.Type == RhiBarrierType::Transition)
+			{
+				// The placed texture kept the state it was left in, by this transient or another one.
+				if (planned.IsFirstUse)
+					barrier.Before = texture.Placed->State;
+				texture.Placed->State = planned.After;
+				if (barrier.Before == barrier.After)
+					continue;
+			}
+			m_Barriers.push_back(barrier);
+		}
+		if (!m_Barriers.empty())
+			pCommandList.Barriers(m_Barriers.data(), static_cast<uint32_t>(m_Barriers.size()));
+	}
+
+	const RhiTexture& RenderGraph::GetTexture(const TextureHandle pTexture) const
+	{
+		const Texture& texture = m_Textures[pTexture];
+		if (texture.Imported)
+			return *texture.Imported;
+		assert(texture.Placed && "The transient is placed by the Execute() recording its first pass");
+		return *texture.Placed->Texture;
+	}
+
+	std::vector<RhiBarrier> RenderGraph::GetPassBarriers(const uint32_t pPass) const
+	{
+		std::vector<RhiBarrier> barriers;
+		for (const PlannedBarrier& planned : m_Passes[pPass].Barriers)
+		{
+			const Texture& texture = m_Textures[planned.Texture];
+			const RhiResource* resource = texture.Imported;
+			if (!resource && texture.Placed)
+				resource = texture.Placed->Texture.get();
+			barriers.push_back({planned.Type, resource, planned.Before, planned.After});
+		}
+		return barriers;
+	}
+}
@@ -0,0 +1,210 @@
+#pragma once
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "RHI/RhiDevice.h"
+
+namespace Engine
+{
+	/// <summary>
+	/// A frame's GPU work as passes declaring the textures they read and write. Compile() drops the passes whose
+	/// writes nothing uses, works out the barriers in between, batched per pass, and places the transient textures
+	/// in one heap : the ones no pass uses at the same time share memory. Compiling is CPU only, the device is just
+	/// asked the textures' sizes. Execute() then records the passes with their barriers.
+	/// The graph is declared again every frame, Reset() then AddPass()... then Compile(). The heap and the placed
+	/// textures are kept while the transients stay the same.
+	/// </summary>
+	class RenderGraph
+	{
+	public:
+		// Index of a texture of the graph, valid until Reset().
+		using TextureHandle = uint32_t;
+		using ExecuteCallback = std::function<void(RhiCommandList& pCommandList)>;
+
+		struct Stats
+		{
+			uint32_t PassCount = 0;
+			// Passes dropped by Compile(), nothing used what they wrote.
+			uint32_t CulledPasses = 0;
+			// Transient textures used by the kept passes.
+			uint32_t TransientCount = 0;
+			// Barriers and ResourceBarrier() calls Compile() planned, the final barriers included.
+			uint32_t BarrierCount = 0;
+			uint32_t BarrierBatchCount = 0;
+			// The transients' sizes summed, what they would take in memory of their own, and the heap they share.
+			uint64_t TransientBytes = 0;
+			uint64_t HeapBytes = 0;
+
+			uint64_t GetAliasingSavings() const { return TransientBytes - HeapBytes; }
+		};
+
+		class PassBuilder
+		{
+		public:
+			/// <summary>
+			/// The pass reads pTexture in pState, the texture's writers before it are kept.
+			/// </summary>
+			PassBuilder& Read(TextureHandle pTexture, RhiResourceState pState);
+			/// <summary>
+			/// The pass writes pTexture in pState. A transient is undefined in the first pass using it, which has
+			/// to clear it.
+			/// </summary>
+			PassBuilder& Write(TextureHandle pTexture, RhiResourceState pState);
+			/// <summary>
+			/// Keeps the pass even when nothing reads what it writes, ex. it writes buffers the graph does not see.
+			/// </summary>
+			PassBuilder& SetSideEffects();
+
+			[[nodiscard]] uint32_t GetPass() const { return m_Pass; }
+
+		private:
+			PassBuilder(RenderGraph& pGraph, const uint32_t pPass) : m_Graph(pGraph), m_Pass(pPass) {}
+
+			RenderGraph& m_Graph;
+			uint32_t m_Pass;
+
+			friend class RenderGraph;
+		};
+
+		/// <param name="pDevice"> : where the heap and the transients are created</param>
+		/// <param name="pFrameCount"> : frames in flight, the textures let go of are kept as long</param>
+		RenderGraph(RhiDevice& pDevice, uint32_t pFrameCount);
+		~RenderGraph();
+
+		RenderGraph(const RenderGraph&) = delete;
+		RenderGraph& operator=(const RenderGraph&) = delete;
+
+		/// <summary>
+		/// Starts the declaration of a new frame, after the GPU is done with the one k_FrameCount frames ago.
+		/// </summary>
+		void Reset();
+
+		/// <summary>
+		/// A texture the graph does not own, in pInitialState before the graph and put in pFinalState after it.
+		/// Its writers are kept.
+		/// </summary>
+		/// <param name="pName"> : a literal, only kept for debugging</param>
+		TextureHandle ImportTexture(const char* pName, const RhiTexture& pTexture, RhiResourceState pInitialState,
+		                            RhiResourceState pFinalState);
+		/// <summary>
+		/// A render target or depth stencil that only lives within the graph.
+		/// </summary>
+		TextureHandle CreateTexture(const char* pName, const RhiTextureDesc& pDesc);
+
+		/// <param name="pExecute"> : records the pass, called by Execute() unless the pass is culled</param>
+		PassBuilder AddPass(const char* pName, ExecuteCallback pExecute);
+
+		/// <summary>
+		/// Culls the passes, then plans the barriers and where the transients go.
+		/// </summary>
+		void Compile();
+
+		/// <summary>
+		/// Records the compiled passes up to pass pLastPass included, from where the previous call stopped, so a
+		/// frame can be split across command lists. The last call, pLastPass left to its default, also puts the
+		/// imported textures in their final state.
+		/// </summary>
+		void Execute(RhiCommandList& pCommandList, uint32_t pLastPass = UINT32_MAX);
+
+		/// <returns> The texture behind pTexture, valid from the Execute() that records its first pass. </returns>
+		[[nodiscard]] const RhiTexture& GetTexture(TextureHandle pTexture) const;
+		/// <returns> False when Compile() culled pass pPass. </returns>
+		[[nodiscard]] bool IsPassKept(const uint32_t pPass) const { return !m_Passes[pPass].IsCulled; }
+		/// <returns> Where Compile() placed pTexture in the heap, a transient used by a kept pass. </returns>
+		[[nodiscard]] uint64_t GetTextureOffset(const TextureHandle pTexture) const
+		{
+			return m_Textures[pTexture].Offset;
+		}
+		/// <returns> The barriers recorded before pass pPass. The transients' resources are nullptr until
+		/// Execute() places them, and their first transition is from Common : Execute() takes the placed texture's
+		/// state instead. </returns>
+		[[nodiscard]] std::vector<RhiBarrier> GetPassBarriers(uint32_t pPass) const;
+		[[nodiscard]] const Stats& GetStats() const { return m_Stats; }
+
+	private:
+		struct Access
+		{
+			TextureHandle Texture;
+			RhiResourceState State;
+			bool IsWrite;
+		};
+
+		// A barrier of the plan, on a texture not created yet for the transients.
+		struct PlannedBarrier
+		{
+			RhiBarrierType Type;
+			TextureHandle Texture;
+			RhiResourceState Before;
+			RhiResourceState After;
+			// The first transition of a transient, from the placed texture's state.
+			bool IsFirstUse;
+		};
+
+		struct Pass
+		{
+			const char* Name;
+			ExecuteCallback Execute;
+			std::vector<Access> Accesses;
+			bool HasSideEffects = false;
+			bool IsCulled = false;
+			std::vector<PlannedBarrier> Barriers;
+		};
+
+		// A texture created in the heap, reused by the transients of the same desc at the same offset.
+		struct PlacedTexture
+		{
+			RhiTextureDesc Desc;
+			uint64_t Offset = 0;
+			std::unique_ptr<RhiTexture> Texture;
+			RhiResourceState State = RhiResourceState::Common;
+			bool IsUsed = false;
+		};
+
+		struct Texture
+		{
+			const char* Name;
+			// nullptr for a transient.
+			const RhiTexture* Imported = nullptr;
+			RhiTextureDesc Desc;
+			RhiResourceState InitialState = RhiResourceState::Common;
+			RhiResourceState FinalState = RhiResourceState::Common;
+			// Transients only : the kept passes using it, in the order they run, and its place in the heap.
+			uint32_t FirstUse = UINT32_MAX;
+			uint32_t LastUse = 0;
+			uint64_t Size = 0;
+			uint64_t Alignment = 0;
+			uint64_t Offset = 0;
+			PlacedTexture* Placed = nullptr;
+		};
+
+		void AddAccess(uint32_t pPass, TextureHandle pTexture, RhiResourceState pState, bool pIsWrite);
+		void Cull();
+		void PlanBarriers();
+		void PlaceTransients();
+		// Creates the heap and the placed textures the compiled graph needs.
+		void Realize();
+		void RecordBarriers(RhiCommandList& pCommandList, const std::vector<PlannedBarrier>& pBarriers);
+
+		RhiDevice& m_Device;
+		uint32_t m_FrameCount;
+		uint64_t m_FrameNumber = 0;
+
+		std::vector<Pass> m_Passes;
+		std::vector<Texture> m_Textures;
+		std::vector<PlannedBarrier> m_FinalBarriers;
+		// Pass Execute() resumes from, and whether the heap was set up for this compilation.
+		uint32_t m_NextPass = 0;
+		bool m_IsRealized = false;
+
+		std::unique_ptr<RhiHeap> m_Heap;
+		std::vector<std::unique_ptr<PlacedTexture>> m_PlacedTextures;
+		std::vector<RhiBarrier> m_Barriers;
+		// Textures and heaps let go of, with the frame they were let go on. The textures go first.
+		std::vector<std::pair<uint64_t, std::unique_ptr<RhiTexture>>> m_RetiredTextures;
+		std::vector<std::pair<uint64_t, std::unique_ptr<RhiHeap>>> m_RetiredHeaps;
+
+		Stats m_Stats;
+	};
+}
@@ -1287,7 +1287,7 @@ static HRESULT CreateD3DResources12(
 				texture = nullptr;
 				return hr;
 			}
-			else
+			else if (cmdList)
 			{
 				const UINT num2DSubresources = texDesc.DepthOrArraySize * texDesc.MipLevels;
 				const UINT64 uploadBufferSize = GetRequiredIntermediateSize(texture.Get(), 0, num2DSubresources);
@@ -1699,7 +1699,8 @@ static HRESULT CreateTextureFromDDS12(
 	_In_ size_t maxsize,
 	_In_ bool forceSRGB,
 	ComPtr<ID3D12Resource>& texture,
-	ComPtr<ID3D12Resource>& textureUploadHeap)
+	ComPtr<ID3D12Resource>& textureUploadHeap,
+	_Out_opt_ std::vector<D3D12_SUBRESOURCE_DATA>* subresources = nullptr)
 {
 	HRESULT hr = S_OK;
 
@@ -1891,6 +1892,11 @@ static HRESULT CreateTextureFromDDS12(
 			textureUploadHeap);
 	}
 
+	if (SUCCEEDED(hr) && subresources)
+	{
+		subresources->assign(initData.get(), initData.get() + (mipCount - skipMip) * arraySize);
+	}
+
 	return hr;
 }
 
@@ -2149,6 +2155,49 @@ HRESULT DirectX::CreateDDSTextureFromMemoryEx(ID3D11Device* d3dDevice,
 //--------------------------------------------------------------------------------------
 _Use_decl_annotations_
 
+HRESULT DirectX::LoadDDSTextureFromFile12(ID3D12Device* device,
+                                          const wchar_t* szFileName,
+                                          ComPtr<ID3D12Resource>& texture,
+                                          std::unique_ptr<uint8_t[]>& ddsData,
+                                          std::vector<D3D12_SUBRESOURCE_DATA>& subresources,
+                                          size_t maxsize,
+                                          DDS_ALPHA_MODE* alphaMode)
+{
+	texture = nullptr;
+	subresources.clear();
+	if (alphaMode)
+	{
+		*alphaMode = DDS_ALPHA_MODE_UNKNOWN;
+	}
+
+	if (!device || !szFileName)
+	{
+		return E_INVALIDARG;
+	}
+
+	DDS_HEADER* header = nullptr;
+	uint8_t* bitData = nullptr;
+	size_t bitSize = 0;
+
+	HRESULT hr = LoadTextureDataFromFile(szFileName, ddsData, &header, &bitData, &bitSize);
+	if (FAILED(hr))
+	{
+		return hr;
+	}
+
+	// Without a command list, no upload heap is created nor copy recorded.
+	ComPtr<ID3D12Resource> textureUploadHeap;
+	hr = CreateTextureFromDDS12(device, nullptr, header,
+	                            bitData, bitSize, maxsize, false, texture, textureUploadHeap, &subresources);
+
+	if (SUCCEEDED(hr) && alphaMode)
+		*alphaMode = GetAlphaMode(header);
+
+	return hr;
+}
+
+_Use_decl_annotations_
+
 HRESULT DirectX::CreateDDSTextureFromFile(ID3D11Device* d3dDevice,
                                           const wchar_t* fileName,
                                           ID3D11Resource** texture,
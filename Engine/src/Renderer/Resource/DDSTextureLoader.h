@@ -24,6 +24,8 @@
 
 #include <wrl.h>
 #include <d3d11_1.h>
+#include <memory>
+#include <vector>
 #include "../d3dx12.h"
 
 #pragma warning(push)
@@ -92,6 +94,17 @@ namespace DirectX
 	                                   _Out_opt_ DDS_ALPHA_MODE* alphaMode = nullptr
 	);
 
+	// Creates the texture in the COMMON state without uploading it. subresources point into ddsData, in the
+	// order of GetCopyableFootprints, for the caller to upload.
+	HRESULT LoadDDSTextureFromFile12(_In_ ID3D12Device* device,
+	                                 _In_z_ const wchar_t* szFileName,
+	                                 _Out_ Microsoft::WRL::ComPtr<ID3D12Resource>& texture,
+	                                 _Out_ std::unique_ptr<uint8_t[]>& ddsData,
+	                                 _Out_ std::vector<D3D12_SUBRESOURCE_DATA>& subresources,
+	                                 _In_ size_t maxsize = 0,
+	                                 _Out_opt_ DDS_ALPHA_MODE* alphaMode = nullptr
+	);
+
 	// Standard version with optional auto-gen mipmap support
 	HRESULT CreateDDSTextureFromMemory(_In_ ID3D11Device* d3dDevice,
 	                                   _In_opt_ ID3D11DeviceContext* d3dContext,
@@ -5,6 +5,8 @@
 #include "DDSTextureLoader.h"
 #include "Renderer/DirectXCommandObject.h"
 #include "Renderer/DirectXContext.h"
+#include "Renderer/UploadManager.h"
+#include "Renderer/RHI/DirectXRhi.h"
 
 namespace Engine
 {
@@ -20,6 +22,8 @@ namespace Engine
 		srvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
 		THROW_IF_FAILED(
 			DirectXContext::Get()->m_Device->CreateDescriptorHeap(&srvHeapDesc, IID_PPV_ARGS(&m_SrvDescriptorHeap)));
+		// Every graphics list binds it when it begins.
+		static_cast<DirectXRhiDevice*>(RhiDevice::Get())->SetShaderVisibleHeap(m_SrvDescriptorHeap.Get());
 
 		for (int i = 0; i < m_MaxTextures; ++i)
 			m_TextureIndicesAvailable.push(i);
@@ -28,32 +32,27 @@ namespace Engine
 	DirectXResourceManager::~DirectXResourceManager()
 	{
 		for (const auto& texture : m_Textures | std::views::values)
+		{
 			if (texture)
+			{
+				WaitForUpload(*texture);
 				delete texture;
-	}
-
-	void DirectXResourceManager::BindDescriptorsHeap() const
-	{
-		ID3D12DescriptorHeap* descriptorsHeap[] = {m_SrvDescriptorHeap.Get()};
-		DirectXContext::Get()->m_CommandObject->GetCommandList()->SetDescriptorHeaps(
-			_countof(descriptorsHeap), descriptorsHeap);
+			}
+		}
 	}
 
 	Texture* DirectXResourceManager::LoadTexture(const std::wstring& pPath, const std::string& pName)
 	{
-		DirectXContext::Get()->m_CommandObject->GetCommandAllocator()->Reset();
-		DirectXContext::Get()->m_CommandObject->
-		                       ResetList(DirectXContext::Get()->m_CommandObject->GetCommandAllocator());
-
 		m_Textures[pName] = new Texture();
 		m_Textures[pName]->Name = pName;
 		m_Textures[pName]->Filename = pPath;
 		m_Textures[pName]->HeapIndex = m_TextureIndicesAvailable.front();
 		m_TextureIndicesAvailable.pop();
 		++m_TextureCount;
-		THROW_IF_FAILED(DirectX::CreateDDSTextureFromFile12(DirectXContext::Get()->m_Device.Get(),
-			DirectXContext::Get()->m_CommandObject->GetCommandList().Get(), m_Textures[pName]->Filename.c_str(),
-			m_Textures[pName]->Resource, m_Textures[pName]->UploadHeap));
+		std::unique_ptr<uint8_t[]> ddsData;
+		std::vector<D3D12_SUBRESOURCE_DATA> subresources;
+		THROW_IF_FAILED(DirectX::LoadDDSTextureFromFile12(DirectXContext::Get()->m_Device.Get(),
+			m_Textures[pName]->Filename.c_str(), m_Textures[pName]->Resource, ddsData, subresources));
 
 		CD3DX12_CPU_DESCRIPTOR_HANDLE hDescriptor(m_SrvDescriptorHeap->GetCPUDescriptorHandleForHeapStart());
 		hDescriptor.Offset(m_Textures[pName]->HeapIndex, m_CbvSrvDescriptorSize);
@@ -69,10 +68,25 @@ namespace Engine
 		DirectXContext::Get()->m_Device->CreateShaderResourceView(m_Textures[pName]->Resource.Get(), &srvDesc,
 		                                                          hDescriptor);
 
-		DirectXContext::Get()->m_CommandObject->Execute();
-		DirectXContext::Get()->m_CommandObject->Flush();
+		// Staged right away, the file's data is released on return. The copy runs with the other uploads of the
+		// frame, the frame waits for it on the GPU.
+		const D3D12_RESOURCE_DESC resourceDesc = m_Textures[pName]->Resource->GetDesc();
+		DirectXRhiTexture texture;
+		texture.Wrap(m_Textures[pName]->Resource.Get(), {},
+		             {static_cast<uint32_t>(resourceDesc.Width), resourceDesc.Height, resourceDesc.MipLevels});
 
-		m_Textures[pName]->UploadHeap->Release();
+		std::vector<RhiSubresourceData> data;
+		data.reserve(subresources.size());
+		for (const D3D12_SUBRESOURCE_DATA& subresource : subresources)
+		{
+			data.push_back({
+				subresource.pData, static_cast<uint64_t>(subresource.RowPitch),
+				static_cast<uint64_t>(subresource.SlicePitch)
+			});
+		}
+		UploadManager& uploads = *DirectXContext::Get()->GetUploadManager();
+		uploads.UploadTexture(texture, data.data(), static_cast<uint32_t>(data.size()));
+		m_Textures[pName]->UploadTicket = uploads.GetPendingTicket();
 
 		return m_Textures[pName];
 	}
@@ -94,6 +108,17 @@ namespace Engine
 		return handle;
 	}
 
+	CD3DX12_GPU_DESCRIPTOR_HANDLE DirectXResourceManager::GetTextureTableHandle() const
+	{
+		return CD3DX12_GPU_DESCRIPTOR_HANDLE(m_SrvDescriptorHeap->GetGPUDescriptorHandleForHeapStart());
+	}
+
+	void DirectXResourceManager::WaitForUpload(const Texture& pTexture)
+	{
+		if (UploadManager* uploads = DirectXContext::Get()->GetUploadManager())
+			uploads->Wait(pTexture.UploadTicket);
+	}
+
 	void DirectXResourceManager::ReleaseTexture(const std::string& pName)
 	{
 		if (!m_Textures.contains(pName))
@@ -105,6 +130,7 @@ namespace Engine
 		m_TextureIndicesAvailable.push(m_Textures[pName]->HeapIndex);
 		--m_TextureCount;
 
+		WaitForUpload(*m_Textures[pName]);
 		delete m_Textures[pName];
 		m_Textures[pName] = nullptr;
 	}
@@ -114,6 +140,7 @@ namespace Engine
 		m_TextureIndicesAvailable.push(pTexture->HeapIndex);
 		--m_TextureCount;
 
+		WaitForUpload(*pTexture);
 		delete pTexture;
 	}
 }
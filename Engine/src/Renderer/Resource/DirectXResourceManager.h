@@ -14,16 +14,19 @@ namespace Engine
 		DirectXResourceManager(uint32_t pMaxTextures);
 		~DirectXResourceManager();
 
-		void BindDescriptorsHeap() const;
-
 		Texture* LoadTexture(const std::wstring& pPath, const std::string& pName);
 		Texture* GetTexture(const std::string& pName) { return m_Textures[pName]; }
 		CD3DX12_GPU_DESCRIPTOR_HANDLE GetTextureHandle(const std::string& pName);
 		CD3DX12_GPU_DESCRIPTOR_HANDLE GetTextureHandle(const Texture* pTexture) const;
+		/// <returns> The start of the heap, bound to the shaders' texture array indexed by Texture::HeapIndex. </returns>
+		CD3DX12_GPU_DESCRIPTOR_HANDLE GetTextureTableHandle() const;
 		void ReleaseTexture(const std::string& pName);
 		void ReleaseTexture(const Texture* pTexture);
 
 	private:
+		// The copy queue may still be writing the texture.
+		static void WaitForUpload(const Texture& pTexture);
+
 		Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> m_SrvDescriptorHeap = nullptr;
 
 		UINT m_CbvSrvDescriptorSize = 0;
@@ -14,6 +14,7 @@ namespace Engine
 		std::wstring Filename;
 
 		Microsoft::WRL::ComPtr<ID3D12Resource> Resource = nullptr;
-		Microsoft::WRL::ComPtr<ID3D12Resource> UploadHeap = nullptr;
+		// Copy of the texels on the copy queue, see UploadManager.
+		uint64_t UploadTicket = 0;
 	};
 }
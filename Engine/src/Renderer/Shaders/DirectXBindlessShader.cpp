@@ -0,0 +1,47 @@
+#include "DirectXBindlessShader.h"
+
+#include <utility>
+
+#include "../DirectXFrameData.h"
+#include "../GpuMaterialTable.h"
+#include "../GpuObjectTable.h"
+#include "../Resource/DirectXResourceManager.h"
+
+namespace Engine
+{
+	DirectXBindlessShader::DirectXBindlessShader(const std::vector<RhiInputElement>& pLayout,
+	                                             const std::wstring& pShaderPath, ShaderPermutations pPermutations)
+		: DirectXShader(pLayout, pShaderPath, std::move(pPermutations))
+	{
+		m_RootParameters = {
+			{RhiRootParameterType::Constants, 0},
+			{RhiRootParameterType::ConstantBuffer, 1},
+			{RhiRootParameterType::ShaderResource, 0, RhiShaderVisibility::All, 1},
+			{RhiRootParameterType::ShaderResource, 1, RhiShaderVisibility::All, 1},
+			{RhiRootParameterType::ShaderResource, 2, RhiShaderVisibility::All, 1},
+			{
+				RhiRootParameterType::DescriptorTable, 0, RhiShaderVisibility::Pixel, 2, 1,
+				RhiRootParameter::k_UnboundedDescriptorCount
+			},
+		};
+		m_UseStaticSamplers = true;
+	}
+
+    void DirectXBindlessShader::Bind(RhiCommandList& pCommandList, const ShaderVariantKey pVariant,
+                                     const RhiGpuAddress pInstances, const uint32_t pFirstInstance)
+    {
+        pCommandList.SetPipeline(GetPipeline(pVariant));
+
+        pCommandList.SetGraphicsRootConstantBufferView(
+			1, DirectXContext::Get()->CurrentFrameData().PassCB->GetGpuAddress());
+
+        pCommandList.SetGraphicsRootShaderResourceView(2, DirectXContext::Get()->GetObjectTable()->GetGpuAddress());
+        pCommandList.SetGraphicsRootShaderResourceView(3, pInstances);
+        pCommandList.SetGraphicsRootShaderResourceView(4, DirectXContext::Get()->GetMaterialTable()->GetGpuAddress());
+        // Every texture is reachable from the table, the materials hold their index.
+        if (DirectXContext::Get()->m_ResourceManager)
+            pCommandList.SetGraphicsRootDescriptorTable(
+				5, DirectXContext::Get()->m_ResourceManager->GetTextureTableHandle().ptr);
+        pCommandList.SetGraphicsRoot32BitConstant(0, pFirstInstance, 0);
+    }
+}
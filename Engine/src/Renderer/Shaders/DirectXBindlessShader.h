@@ -0,0 +1,22 @@
+#pragma once
+
+#include "DirectXShader.h"
+#include "../DirectXContext.h"
+
+namespace Engine
+{
+	/// <summary>
+	/// Shaders reading their material from the GPU material table and their textures from the bindless texture
+	/// table. They all have the same root signature, so switching between them keeps the root arguments bound.
+	/// </summary>
+	class DirectXBindlessShader : public DirectXShader
+	{
+	public:
+        void Bind(RhiCommandList& pCommandList, ShaderVariantKey pVariant, RhiGpuAddress pInstances,
+                  uint32_t pFirstInstance) final;
+
+	protected:
+		DirectXBindlessShader(const std::vector<RhiInputElement>& pLayout, const std::wstring& pShaderPath,
+		                      ShaderPermutations pPermutations = {});
+	};
+}
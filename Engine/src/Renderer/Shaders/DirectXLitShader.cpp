@@ -1,107 +1,26 @@
 #include "DirectXLitShader.h"
 
-#include <array>
-#include <comdef.h>
-
-#include "../DirectXSwapchain.h"
-#include "../DirectXCommandObject.h"
 #include "../DirectXFrameData.h"
-#include "Debug/Log.h"
 
 namespace Engine
 {
-	DirectXLitShader::DirectXLitShader(const std::vector<D3D12_INPUT_ELEMENT_DESC>& pLayout,
-	                                   const std::wstring& pShaderPath)
+	DirectXLitShader::DirectXLitShader(const std::vector<RhiInputElement>& pLayout, const std::wstring& pShaderPath)
+		: DirectXBindlessShader(pLayout, pShaderPath, CreatePermutations())
 	{
-		const Microsoft::WRL::ComPtr<ID3DBlob> vsByteCode = DirectXContext::CompileShader(
-			pShaderPath, nullptr, "VS", "vs_5_0");
-		const Microsoft::WRL::ComPtr<ID3DBlob> psByteCode = DirectXContext::CompileShader(
-			pShaderPath, nullptr, "PS", "ps_5_0");
-
-		InitializeSignature();
-
-		InitializePipelineState(pLayout, vsByteCode, psByteCode);
 	}
 
-
-    void DirectXLitShader::Bind(const UploadBuffer<ObjectConstants>& objectConstantBuffer)
-    {
-        DirectXContext::Get()->m_CommandObject->GetCommandList()->SetPipelineState(GetState().Get());
-        DirectXContext::Get()->m_CommandObject->GetCommandList()->SetGraphicsRootSignature(GetSignature().Get());
-
-		DirectXContext::Get()->m_CommandObject->GetCommandList()->SetGraphicsRootConstantBufferView(
-			1, DirectXContext::Get()->CurrentFrameData().PassCB->Resource()->GetGPUVirtualAddress());
-	
-        DirectXContext::Get()->m_CommandObject->GetCommandList()->SetGraphicsRootConstantBufferView(0, objectConstantBuffer.Resource()->GetGPUVirtualAddress());
-    }
-
-	void DirectXLitShader::InitializeSignature()
+	ShaderPermutations DirectXLitShader::CreatePermutations()
 	{
-		CD3DX12_ROOT_PARAMETER slotRootParameter[4];
-
-		CD3DX12_DESCRIPTOR_RANGE texTable;
-		texTable.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 0);
-
-		slotRootParameter[0].InitAsConstantBufferView(0);
-		slotRootParameter[1].InitAsConstantBufferView(1);
-		slotRootParameter[2].InitAsConstantBufferView(2);
-		slotRootParameter[3].InitAsDescriptorTable(1, &texTable, D3D12_SHADER_VISIBILITY_PIXEL);
-
-		const auto staticSamplers = GetStaticSamplers();
-
-		const CD3DX12_ROOT_SIGNATURE_DESC rootSigDesc(4, slotRootParameter, staticSamplers.size(),
-		                                              staticSamplers.data(),
-		                                              D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
-
-		Microsoft::WRL::ComPtr<ID3DBlob> serializedRootSig = nullptr;
-		Microsoft::WRL::ComPtr<ID3DBlob> errorBlob = nullptr;
-		const HRESULT hr = D3D12SerializeRootSignature(&rootSigDesc, D3D_ROOT_SIGNATURE_VERSION_1,
-		                                               serializedRootSig.GetAddressOf(), errorBlob.GetAddressOf());
-
-		if (errorBlob != nullptr)
-		{
-			CORE_ERROR(static_cast<char*>(errorBlob->GetBufferPointer()));
-		}
-		THROW_IF_FAILED(hr);
-
-		THROW_IF_FAILED(DirectXContext::Get()->m_Device->CreateRootSignature(
-			0,
-			serializedRootSig->GetBufferPointer(),
-			serializedRootSig->GetBufferSize(),
-			IID_PPV_ARGS(&m_RootSignature)));
+		return ShaderPermutations({
+			{"TEXTURE", {0, 1}, RhiShaderVisibility::Pixel},
+			// Up to PassConstants::DirectionalLights.
+			{"MAX_DIRECTIONAL_LIGHTS", {0, 1, 2, 4, 10}, RhiShaderVisibility::Pixel},
+		});
 	}
 
-	void DirectXLitShader::InitializePipelineState(std::vector<D3D12_INPUT_ELEMENT_DESC> pLayout,
-	                                               Microsoft::WRL::ComPtr<ID3DBlob> pVsByteCode,
-	                                               Microsoft::WRL::ComPtr<ID3DBlob> pPsByteCode)
+	ShaderVariantKey DirectXLitShader::ApplyFrameFeatures(const ShaderVariantKey pMaterialVariant) const
 	{
-		D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc;
-		ZeroMemory(&psoDesc, sizeof(D3D12_GRAPHICS_PIPELINE_STATE_DESC));
-		psoDesc.InputLayout = {pLayout.data(), static_cast<UINT>(pLayout.size())};
-		psoDesc.pRootSignature = m_RootSignature.Get();
-		psoDesc.VS =
-		{
-			static_cast<BYTE*>(pVsByteCode->GetBufferPointer()),
-			pVsByteCode->GetBufferSize()
-		};
-		psoDesc.PS =
-		{
-			static_cast<BYTE*>(pPsByteCode->GetBufferPointer()),
-			pPsByteCode->GetBufferSize()
-		};
-		psoDesc.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
-		psoDesc.BlendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
-		psoDesc.DepthStencilState = CD3DX12_DEPTH_STENCIL_DESC(D3D12_DEFAULT);
-		psoDesc.SampleMask = UINT_MAX;
-		psoDesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
-		psoDesc.NumRenderTargets = 1;
-		psoDesc.RTVFormats[0] = DirectXSwapchain::k_BackBufferFormat;
-		psoDesc.SampleDesc.Count = DirectXContext::Get()->m_4xMsaaState ? 4 : 1;
-		psoDesc.SampleDesc.Quality = DirectXContext::Get()->m_4xMsaaState
-			                             ? (DirectXContext::Get()->m_4xMsaaQuality - 1)
-			                             : 0;
-		psoDesc.DSVFormat = DirectXSwapchain::k_DepthStencilFormat;
-		THROW_IF_FAILED(
-			DirectXContext::Get()->m_Device->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&m_PipelineState)));
+		const int lightCount = DirectXContext::Get()->CurrentFrameData().GetNumDirectionalLights();
+		return GetPermutations().Select(pMaterialVariant, k_LightCountFeature, static_cast<uint32_t>(lightCount));
 	}
 }
@@ -1,20 +1,26 @@
 #pragma once
 
-#include "DirectXShader.h"
-#include "../DirectXContext.h"
+#include "DirectXBindlessShader.h"
 
 namespace Engine
 {
-	class DirectXLitShader : public DirectXShader
+	/// <summary>
+	/// Builtin.Lit.hlsl. Materials without texture skip the sampling, and the light loop is unrolled for the
+	/// smallest bucket holding the frame's lights.
+	/// </summary>
+	class DirectXLitShader : public DirectXBindlessShader
 	{
 	public:
-		DirectXLitShader(const std::vector<D3D12_INPUT_ELEMENT_DESC>& pLayout, const std::wstring& pShaderPath);
+		// Indices of the features in GetPermutations().
+		static constexpr uint32_t k_TextureFeature = 0;
+		static constexpr uint32_t k_LightCountFeature = 1;
 
-        void Bind(const UploadBuffer<ObjectConstants>& objectConstantBuffer) override;
-    private:
-        void InitializeSignature();
-		void InitializePipelineState(std::vector<D3D12_INPUT_ELEMENT_DESC> pLayout,
-		                             Microsoft::WRL::ComPtr<ID3DBlob> pVsByteCode,
-		                             Microsoft::WRL::ComPtr<ID3DBlob> pPsByteCode);
+		DirectXLitShader(const std::vector<RhiInputElement>& pLayout, const std::wstring& pShaderPath);
+
+	protected:
+		ShaderVariantKey ApplyFrameFeatures(ShaderVariantKey pMaterialVariant) const override;
+
+	private:
+		static ShaderPermutations CreatePermutations();
 	};
 }
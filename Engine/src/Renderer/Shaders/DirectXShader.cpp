@@ -1,66 +1,93 @@
 ﻿#include "DirectXShader.h"
 
-#include <array>
+#include <algorithm>
+#include <cassert>
 
 #include "Renderer/DirectXContext.h"
+#include "Renderer/PipelineCache.h"
+#include "Renderer/Materials/DirectXMaterial.h"
+#include "ShaderCompiler.h"
 
 namespace Engine
 {
-	std::array<const CD3DX12_STATIC_SAMPLER_DESC, 6> DirectXShader::GetStaticSamplers()
+	uint32_t DirectXShader::s_NextSortId = 0;
+
+	DirectXShader::DirectXShader(const std::vector<RhiInputElement>& pLayout, std::filesystem::path pShaderPath,
+	                             ShaderPermutations pPermutations)
+		: m_Layout(pLayout), m_ShaderPath(std::move(pShaderPath)), m_Permutations(std::move(pPermutations))
 	{
-		// Applications usually only need a handful of samplers.  So just define them all up front
-		// and keep them available as part of the root signature.  
+	}
 
-		const CD3DX12_STATIC_SAMPLER_DESC pointWrap(
-			0, // shaderRegister
-			D3D12_FILTER_MIN_MAG_MIP_POINT, // filter
-			D3D12_TEXTURE_ADDRESS_MODE_WRAP, // addressU
-			D3D12_TEXTURE_ADDRESS_MODE_WRAP, // addressV
-			D3D12_TEXTURE_ADDRESS_MODE_WRAP); // addressW
+	RhiPipeline& DirectXShader::GetPipeline(const ShaderVariantKey pVariant) const
+	{
+		RhiPipeline* pipeline = FindVariant(pVariant);
+		assert(pipeline && "Variant drawn before SelectVariant() created it.");
+		return *pipeline;
+	}
 
-		const CD3DX12_STATIC_SAMPLER_DESC pointClamp(
-			1, // shaderRegister
-			D3D12_FILTER_MIN_MAG_MIP_POINT, // filter
-			D3D12_TEXTURE_ADDRESS_MODE_CLAMP, // addressU
-			D3D12_TEXTURE_ADDRESS_MODE_CLAMP, // addressV
-			D3D12_TEXTURE_ADDRESS_MODE_CLAMP); // addressW
+	ShaderVariantKey DirectXShader::SelectVariant(const DirectXMaterial& pMaterial)
+	{
+		const ShaderVariantKey variant = ApplyFrameFeatures(pMaterial.GetVariantKey());
+		if (!FindVariant(variant))
+			CreateVariant(variant);
+		return variant;
+	}
 
-		const CD3DX12_STATIC_SAMPLER_DESC linearWrap(
-			2, // shaderRegister
-			D3D12_FILTER_MIN_MAG_MIP_LINEAR, // filter
-			D3D12_TEXTURE_ADDRESS_MODE_WRAP, // addressU
-			D3D12_TEXTURE_ADDRESS_MODE_WRAP, // addressV
-			D3D12_TEXTURE_ADDRESS_MODE_WRAP); // addressW
+	std::vector<ShaderCompileRequest> DirectXShader::GetCompileRequests(const ShaderVariantKey pVariant) const
+	{
+		return {
+			{m_ShaderPath, "VS", "vs_5_1", m_Permutations.GetDefines(pVariant, RhiShaderVisibility::Vertex)},
+			{m_ShaderPath, "PS", "ps_5_1", m_Permutations.GetDefines(pVariant, RhiShaderVisibility::Pixel)},
+		};
+	}
 
-		const CD3DX12_STATIC_SAMPLER_DESC linearClamp(
-			3, // shaderRegister
-			D3D12_FILTER_MIN_MAG_MIP_LINEAR, // filter
-			D3D12_TEXTURE_ADDRESS_MODE_CLAMP, // addressU
-			D3D12_TEXTURE_ADDRESS_MODE_CLAMP, // addressV
-			D3D12_TEXTURE_ADDRESS_MODE_CLAMP); // addressW
+	void DirectXShader::CreateAllVariants()
+	{
+		for (const ShaderVariantKey variant : m_Permutations.GetAllKeys())
+		{
+			if (!FindVariant(variant))
+				CreateVariant(variant);
+		}
+	}
+
+	std::vector<ShaderVariantKey> DirectXShader::GetCreatedVariants() const
+	{
+		std::vector<ShaderVariantKey> variants;
+		for (const auto& [variant, pipeline] : m_Variants)
+			variants.push_back(variant);
+		return variants;
+	}
+
+	RhiPipeline* DirectXShader::FindVariant(const ShaderVariantKey pVariant) const
+	{
+		const auto variant = std::find_if(m_Variants.begin(), m_Variants.end(), [pVariant](const auto& pEntry)
+		{
+			return pEntry.first == pVariant;
+		});
+		return variant != m_Variants.end() ? variant->second : nullptr;
+	}
 
-		const CD3DX12_STATIC_SAMPLER_DESC anisotropicWrap(
-			4, // shaderRegister
-			D3D12_FILTER_ANISOTROPIC, // filter
-			D3D12_TEXTURE_ADDRESS_MODE_WRAP, // addressU
-			D3D12_TEXTURE_ADDRESS_MODE_WRAP, // addressV
-			D3D12_TEXTURE_ADDRESS_MODE_WRAP, // addressW
-			0.0f, // mipLODBias
-			8); // maxAnisotropy
+	RhiPipeline& DirectXShader::CreateVariant(const ShaderVariantKey pVariant)
+	{
+		ShaderCompiler& compiler = DirectXContext::Get()->GetShaderCompiler();
+		const std::vector<ShaderCompileRequest> stages = GetCompileRequests(pVariant);
+		// The compiler keeps the bytecode alive, the description only points to it.
+		const ShaderBytecode& vsByteCode = compiler.Compile(stages[0]);
+		const ShaderBytecode& psByteCode = compiler.Compile(stages[1]);
 
-		const CD3DX12_STATIC_SAMPLER_DESC anisotropicClamp(
-			5, // shaderRegister
-			D3D12_FILTER_ANISOTROPIC, // filter
-			D3D12_TEXTURE_ADDRESS_MODE_CLAMP, // addressU
-			D3D12_TEXTURE_ADDRESS_MODE_CLAMP, // addressV
-			D3D12_TEXTURE_ADDRESS_MODE_CLAMP, // addressW
-			0.0f, // mipLODBias
-			8); // maxAnisotropy
+		RhiPipelineDesc desc;
+		desc.InputLayout = m_Layout;
+		desc.VertexShader = {vsByteCode.data(), vsByteCode.size()};
+		desc.PixelShader = {psByteCode.data(), psByteCode.size()};
+		desc.RootParameters = m_RootParameters;
+		desc.UseStaticSamplers = m_UseStaticSamplers;
+		desc.RenderTargetFormat = RhiFormat::R8G8B8A8Unorm;
+		desc.DepthStencilFormat = RhiFormat::D24UnormS8Uint;
+		desc.SampleCount = DirectXContext::Get()->m_4xMsaaState ? 4 : 1;
+		desc.SampleQuality = DirectXContext::Get()->m_4xMsaaState ? (DirectXContext::Get()->m_4xMsaaQuality - 1) : 0;
 
-		return {
-			pointWrap, pointClamp,
-			linearWrap, linearClamp,
-			anisotropicWrap, anisotropicClamp
-		};
+		RhiPipeline& pipeline = DirectXContext::Get()->GetPipelineCache().GetPipeline(desc);
+		m_Variants.emplace_back(pVariant, &pipeline);
+		return pipeline;
 	}
 }
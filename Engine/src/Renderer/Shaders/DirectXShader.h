@@ -2,22 +2,80 @@
 #include <d3d12.h>
 #include <wrl/client.h>
 
+#include "ShaderCompiler.h"
+#include "ShaderPermutations.h"
 #include "Core/MeshRenderer.h"
+#include "Renderer/RHI/RhiDevice.h"
 
 namespace Engine
 {
+	class DirectXMaterial;
+
+	/// <summary>
+	/// A builtin shader file and its variants, one pipeline per combination of the features it declares.
+	/// Variants are created on the first draw that needs them, or ahead with CreateAllVariants().
+	/// </summary>
 	class DirectXShader
 	{
 	public:
-		Microsoft::WRL::ComPtr<ID3D12RootSignature>& GetSignature() { return m_RootSignature; }
-		Microsoft::WRL::ComPtr<ID3D12PipelineState>& GetState() { return m_PipelineState; }
+		DirectXShader(const std::vector<RhiInputElement>& pLayout, std::filesystem::path pShaderPath,
+		              ShaderPermutations pPermutations = {});
+		virtual ~DirectXShader() = default;
+
+		DirectXShader(const DirectXShader&) = delete;
+		DirectXShader& operator=(const DirectXShader&) = delete;
+
+		/// <returns> The pipeline of a variant SelectVariant() or CreateAllVariants() created. </returns>
+		RhiPipeline& GetPipeline(ShaderVariantKey pVariant) const;
+
+		/// <summary>
+		/// Completes the material's features with the frame's ones (lights...) and creates the variant if needed.
+		/// Main thread only, the draws recorded in parallel only read the variants.
+		/// </summary>
+		/// <returns> The variant drawing pMaterial this frame. </returns>
+		ShaderVariantKey SelectVariant(const DirectXMaterial& pMaterial);
+
+		/// <returns> The vertex then pixel stage of a variant, to compile them ahead with
+		/// ShaderCompiler::CompileAll(). </returns>
+		std::vector<ShaderCompileRequest> GetCompileRequests(ShaderVariantKey pVariant) const;
+		/// <summary>
+		/// Creates every variant, compile their GetCompileRequests() together first to do it in parallel.
+		/// </summary>
+		void CreateAllVariants();
 
-        virtual void Bind(const UploadBuffer<ObjectConstants>& objectConstantBuffer) = 0;
+		const ShaderPermutations& GetPermutations() const { return m_Permutations; }
+		const std::filesystem::path& GetShaderPath() const { return m_ShaderPath; }
+		/// <returns> The variants created so far, in creation order. </returns>
+		std::vector<ShaderVariantKey> GetCreatedVariants() const;
+
+		/// <returns> Small id given at creation, used in the draw sort keys. </returns>
+		uint32_t GetSortId() const { return m_SortId; }
+
+        /// <summary>
+		/// Binds the variant's pipeline and the frame's data : pass constants, object table and instances.
+		/// </summary>
+        virtual void Bind(RhiCommandList& pCommandList, ShaderVariantKey pVariant, RhiGpuAddress pInstances,
+                          uint32_t pFirstInstance) = 0;
 
 	protected:
-		static std::array<const CD3DX12_STATIC_SAMPLER_DESC, 6> GetStaticSamplers();
+		/// <returns> pMaterialVariant with the features that depend on the frame rather than on the material. </returns>
+		virtual ShaderVariantKey ApplyFrameFeatures(ShaderVariantKey pMaterialVariant) const { return pMaterialVariant; }
+
+		// Filled by the constructor of the shader, shared by its variants.
+		std::vector<RhiRootParameter> m_RootParameters;
+		bool m_UseStaticSamplers = false;
+
+	private:
+		RhiPipeline* FindVariant(ShaderVariantKey pVariant) const;
+		RhiPipeline& CreateVariant(ShaderVariantKey pVariant);
+
+		std::vector<RhiInputElement> m_Layout;
+		std::filesystem::path m_ShaderPath;
+		ShaderPermutations m_Permutations;
+		// Few variants are used, a linear search beats hashing. The pipelines belong to the context's PipelineCache.
+		std::vector<std::pair<ShaderVariantKey, RhiPipeline*>> m_Variants;
 
-		Microsoft::WRL::ComPtr<ID3D12RootSignature> m_RootSignature = nullptr;
-		Microsoft::WRL::ComPtr<ID3D12PipelineState> m_PipelineState;
+		static uint32_t s_NextSortId;
+		uint32_t m_SortId = s_NextSortId++;
 	};
 }
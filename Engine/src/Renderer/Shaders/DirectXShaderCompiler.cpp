@@ -0,0 +1,53 @@
+#include "DirectXShaderCompiler.h"
+
+#include <d3d12.h>
+#include <D3Dcompiler.h>
+#include <wrl/client.h>
+
+namespace Engine
+{
+	namespace
+	{
+		UINT GetCompileFlags()
+		{
+#if defined(DEBUG) || defined(_DEBUG)
+			return D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
+#else
+			return 0;
+#endif
+		}
+	}
+
+	bool DirectXShaderCompiler::Compile(const ShaderCompileRequest& pRequest, ShaderBytecode& pOutBytecode,
+	                                    std::string& pErrors) const
+	{
+		std::vector<D3D_SHADER_MACRO> defines;
+		defines.reserve(pRequest.Defines.size() + 1);
+		for (const ShaderDefine& define : pRequest.Defines)
+			defines.push_back({define.Name.c_str(), define.Value.c_str()});
+		defines.push_back({nullptr, nullptr});
+
+		Microsoft::WRL::ComPtr<ID3DBlob> byteCode;
+		Microsoft::WRL::ComPtr<ID3DBlob> errors;
+		const HRESULT hr = D3DCompileFromFile(pRequest.Path.c_str(), defines.data(), D3D_COMPILE_STANDARD_FILE_INCLUDE,
+		                                      pRequest.EntryPoint.c_str(), pRequest.Target.c_str(), GetCompileFlags(),
+		                                      0, &byteCode, &errors);
+
+		if (errors != nullptr)
+		{
+			pErrors.assign(static_cast<const char*>(errors->GetBufferPointer()), errors->GetBufferSize());
+			OutputDebugStringA(pErrors.c_str());
+		}
+		if (FAILED(hr))
+			return false;
+
+		const auto* data = static_cast<const uint8_t*>(byteCode->GetBufferPointer());
+		pOutBytecode.assign(data, data + byteCode->GetBufferSize());
+		return true;
+	}
+
+	std::string DirectXShaderCompiler::GetVersionTag() const
+	{
+		return "D3DCompiler " + std::to_string(D3D_COMPILER_VERSION) + " flags " + std::to_string(GetCompileFlags());
+	}
+}
@@ -0,0 +1,16 @@
+#pragma once
+#include "ShaderCompiler.h"
+
+namespace Engine
+{
+	/// <summary>
+	/// Compiles with D3DCompiler, the debug builds keep the debug information and skip the optimizations.
+	/// </summary>
+	class DirectXShaderCompiler final : public ShaderCompilerBackend
+	{
+	public:
+		bool Compile(const ShaderCompileRequest& pRequest, ShaderBytecode& pOutBytecode,
+		             std::string& pErrors) const override;
+		std::string GetVersionTag() const override;
+	};
+}
@@ -8,13 +8,9 @@ namespace Engine
 	class DirectXSimpleShader : public DirectXShader
 	{
 	public:
-		DirectXSimpleShader(const std::vector<D3D12_INPUT_ELEMENT_DESC>& pLayout, const std::wstring& pShaderPath);
+		DirectXSimpleShader(const std::vector<RhiInputElement>& pLayout, const std::wstring& pShaderPath);
 
-        void Bind(const UploadBuffer<ObjectConstants>& objectConstantBuffer) override;
-    private:
-        void InitializeSignature();
-        void InitializePipelineState(std::vector<D3D12_INPUT_ELEMENT_DESC> pLayout,
-                                     Microsoft::WRL::ComPtr<ID3DBlob> pVsByteCode,
-                                     Microsoft::WRL::ComPtr<ID3DBlob> pPsByteCode);
-    };
+        void Bind(RhiCommandList& pCommandList, ShaderVariantKey pVariant, RhiGpuAddress pInstances,
+                  uint32_t pFirstInstance) override;
+	};
 }
@@ -1,21 +1,12 @@
 ﻿#pragma once
 
-#include "DirectXShader.h"
-#include "../DirectXContext.h"
+#include "DirectXBindlessShader.h"
 
 namespace Engine
 {
-	class DirectXTextureShader : public DirectXShader
+	class DirectXTextureShader : public DirectXBindlessShader
 	{
 	public:
-		DirectXTextureShader(const std::vector<D3D12_INPUT_ELEMENT_DESC>& pLayout, const std::wstring& pShaderPath);
-
-        void Bind(const UploadBuffer<ObjectConstants>& objectConstantBuffer) override;
-
-	private:
-		void InitializeSignature();
-		void InitializePipelineState(std::vector<D3D12_INPUT_ELEMENT_DESC> pLayout,
-		                             Microsoft::WRL::ComPtr<ID3DBlob> pVsByteCode,
-		                             Microsoft::WRL::ComPtr<ID3DBlob> pPsByteCode);
+		DirectXTextureShader(const std::vector<RhiInputElement>& pLayout, const std::wstring& pShaderPath);
 	};
 }
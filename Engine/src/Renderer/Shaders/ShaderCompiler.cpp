@@ -0,0 +1,308 @@
+#include "ShaderCompiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#include "Core/JobSystem.h"
+#include "Debug/Log.h"
+
+namespace Engine
+{
+	namespace
+	{
+		struct FileHeader
+		{
+			uint32_t Magic;
+			uint32_t Version;
+			uint64_t Key;
+			uint64_t BytecodeSize;
+		};
+
+		// FNV-1a, fed piece by piece.
+		class Hasher
+		{
+		public:
+			void Add(const void* pData, const size_t pSize)
+			{
+				const auto* bytes = static_cast<const uint8_t*>(pData);
+				for (size_t i = 0; i < pSize; ++i)
+				{
+					m_Hash ^= bytes[i];
+					m_Hash *= 0x100000001B3ull;
+				}
+			}
+
+			// Length prefixed, "ab" + "c" and "a" + "bc" do not collide.
+			void Add(const std::string& pString)
+			{
+				const uint64_t size = pString.size();
+				Add(&size, sizeof(size));
+				Add(pString.data(), pString.size());
+			}
+
+			[[nodiscard]] uint64_t Get() const { return m_Hash; }
+
+		private:
+			uint64_t m_Hash = 0xCBF29CE484222325ull;
+		};
+
+		bool TryReadFile(const std::filesystem::path& pPath, std::string& pOut)
+		{
+			std::ifstream file(pPath, std::ios::binary);
+			if (!file)
+				return false;
+			pOut.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+			return true;
+		}
+
+		// The file names of the #include directives of pSource, quoted or angled.
+		std::vector<std::string> FindIncludes(const std::string& pSource)
+		{
+			std::vector<std::string> includes;
+			size_t lineStart = 0;
+			while (lineStart < pSource.size())
+			{
+				size_t lineEnd = pSource.find('\n', lineStart);
+				if (lineEnd == std::string::npos)
+					lineEnd = pSource.size();
+
+				size_t i = pSource.find_first_not_of(" \t", lineStart);
+				if (i < lineEnd && pSource[i] == '#')
+				{
+					i = pSource.find_first_not_of(" \t", i + 1);
+					if (i < lineEnd && pSource.compare(i, 7, "include") == 0)
+					{
+						i = pSource.find_first_not_of(" \t", i + 7);
+						if (i < lineEnd && (pSource[i] == '"' || pSource[i] == '<'))
+						{
+							const char close = pSource[i] == '"' ? '"' : '>';
+							const size_t nameEnd = pSource.find(close, i + 1);
+							if (nameEnd < lineEnd)
+								includes.push_back(pSource.substr(i + 1, nameEnd - i - 1));
+						}
+					}
+				}
+				lineStart = lineEnd + 1;
+			}
+			return includes;
+		}
+	}
+
+	ShaderCompiler::ShaderCompiler(std::unique_ptr<ShaderCompilerBackend> pBackend,
+	                               std::filesystem::path pCacheDirectory)
+		: m_Backend(std::move(pBackend)), m_CacheDirectory(std::move(pCacheDirectory))
+	{
+		m_BackendVersion = m_Backend->GetVersionTag();
+	}
+
+	void ShaderCompiler::CompileAll(const std::vector<ShaderCompileRequest>& pRequests)
+	{
+		const auto start = std::chrono::steady_clock::now();
+
+		std::vector<Miss> misses;
+		for (const ShaderCompileRequest& request : pRequests)
+		{
+			++m_Stats.Requests;
+			const uint64_t key = GetKey(request);
+			if (TryLoad(key))
+				continue;
+
+			// Two requests with the same key are compiled once.
+			const bool isQueued = std::any_of(misses.begin(), misses.end(), [key](const Miss& pMiss)
+			{
+				return pMiss.Key == key;
+			});
+			if (isQueued)
+				++m_Stats.MemoryHits;
+			else
+				misses.push_back({&request, key});
+		}
+
+		// One shader per range, their compile times are too uneven to group them.
+		JobSystem::ParallelFor(static_cast<uint32_t>(misses.size()), 1, [this, &misses](
+		                       const uint32_t pFirst, const uint32_t pLast, uint32_t)
+		                       {
+			                       for (uint32_t i = pFirst; i < pLast; ++i)
+				                       CompileMiss(misses[i]);
+		                       });
+
+		for (Miss& miss : misses)
+		{
+			m_Stats.CompileMilliseconds += miss.Milliseconds;
+			if (!miss.IsCompiled)
+			{
+				++m_Stats.Failed;
+				CORE_ERROR("[ShaderCompiler] %s (%s, %s) :\n%s", miss.Request->Path.string().c_str(),
+				           miss.Request->EntryPoint.c_str(), miss.Request->Target.c_str(), miss.Errors.c_str());
+				continue;
+			}
+			++m_Stats.Compiled;
+			Store(miss.Key, std::move(miss.Bytecode));
+		}
+
+		m_Stats.WallMilliseconds += std::chrono::duration<double, std::milli>(
+			std::chrono::steady_clock::now() - start).count();
+	}
+
+	const ShaderBytecode& ShaderCompiler::Compile(const ShaderCompileRequest& pRequest)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		++m_Stats.Requests;
+		const uint64_t key = GetKey(pRequest);
+		if (!TryLoad(key))
+		{
+			Miss miss = {&pRequest, key};
+			CompileMiss(miss);
+			m_Stats.CompileMilliseconds += miss.Milliseconds;
+			if (!miss.IsCompiled)
+			{
+				++m_Stats.Failed;
+				CORE_ERROR("[ShaderCompiler] %s (%s, %s) :\n%s", pRequest.Path.string().c_str(),
+				           pRequest.EntryPoint.c_str(), pRequest.Target.c_str(), miss.Errors.c_str());
+				throw std::runtime_error("Shader compilation failed.");
+			}
+			++m_Stats.Compiled;
+			Store(key, std::move(miss.Bytecode));
+		}
+
+		m_Stats.WallMilliseconds += std::chrono::duration<double, std::milli>(
+			std::chrono::steady_clock::now() - start).count();
+		return m_Bytecode[key];
+	}
+
+	uint64_t ShaderCompiler::GetKey(const ShaderCompileRequest& pRequest) const
+	{
+		Hasher hasher;
+		hasher.Add(&k_FileVersion, sizeof(k_FileVersion));
+		hasher.Add(m_BackendVersion);
+		hasher.Add(pRequest.EntryPoint);
+		hasher.Add(pRequest.Target);
+		for (const ShaderDefine& define : pRequest.Defines)
+		{
+			hasher.Add(define.Name);
+			hasher.Add(define.Value);
+		}
+
+		// The root file's path is part of the key : debug bytecode embeds it.
+		std::string source;
+		for (const std::filesystem::path& file : GetSourceFiles(pRequest.Path))
+		{
+			hasher.Add(file.generic_string());
+			if (TryReadFile(file, source))
+				hasher.Add(source);
+		}
+		return hasher.Get();
+	}
+
+	std::vector<std::filesystem::path> ShaderCompiler::GetSourceFiles(const std::filesystem::path& pPath)
+	{
+		std::vector<std::filesystem::path> files = {pPath.lexically_normal()};
+		std::string source;
+		// files grows while it is walked, each file is scanned once.
+		for (size_t i = 0; i < files.size(); ++i)
+		{
+			if (!TryReadFile(files[i], source))
+				continue;
+
+			for (const std::string& include : FindIncludes(source))
+			{
+				std::filesystem::path path = (files[i].parent_path() / include).lexically_normal();
+				if (!std::filesystem::exists(path))
+					continue;
+				if (std::find(files.begin(), files.end(), path) == files.end())
+					files.push_back(std::move(path));
+			}
+		}
+		return files;
+	}
+
+	bool ShaderCompiler::TryLoad(const uint64_t pKey)
+	{
+		if (m_Bytecode.contains(pKey))
+		{
+			++m_Stats.MemoryHits;
+			return true;
+		}
+
+		const std::filesystem::path path = GetCachePath(pKey);
+		std::ifstream file(path, std::ios::binary);
+		if (!file)
+			return false;
+
+		FileHeader header = {};
+		ShaderBytecode bytecode;
+		file.read(reinterpret_cast<char*>(&header), sizeof(header));
+		std::error_code error;
+		const uint64_t fileSize = std::filesystem::file_size(path, error);
+		if (file && header.Magic == k_FileMagic && header.Version == k_FileVersion && header.Key == pKey &&
+			!error && header.BytecodeSize == fileSize - sizeof(header))
+		{
+			bytecode.resize(header.BytecodeSize);
+			file.read(reinterpret_cast<char*>(bytecode.data()), static_cast<std::streamsize>(bytecode.size()));
+		}
+		// Truncated or foreign files are compiled again and overwritten.
+		if (!file || bytecode.empty())
+			return false;
+
+		++m_Stats.DiskHits;
+		Store(pKey, std::move(bytecode));
+		return true;
+	}
+
+	void ShaderCompiler::Store(const uint64_t pKey, ShaderBytecode pBytecode)
+	{
+		m_Stats.BytecodeBytes += pBytecode.size();
+		m_Bytecode[pKey] = std::move(pBytecode);
+	}
+
+	void ShaderCompiler::CompileMiss(Miss& pMiss) const
+	{
+		const auto start = std::chrono::steady_clock::now();
+		pMiss.IsCompiled = m_Backend->Compile(*pMiss.Request, pMiss.Bytecode, pMiss.Errors) && !pMiss.Bytecode.empty();
+		pMiss.Milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		if (!pMiss.IsCompiled)
+			return;
+
+		// Written next to its final name then renamed, a run that stops halfway leaves no truncated entry.
+		std::error_code error;
+		std::filesystem::create_directories(m_CacheDirectory, error);
+		const std::filesystem::path path = GetCachePath(pMiss.Key);
+		std::filesystem::path temporaryPath = path;
+		temporaryPath += ".tmp";
+		{
+			std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+			const FileHeader header = {k_FileMagic, k_FileVersion, pMiss.Key, pMiss.Bytecode.size()};
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			file.write(reinterpret_cast<const char*>(pMiss.Bytecode.data()),
+			           static_cast<std::streamsize>(pMiss.Bytecode.size()));
+			if (!file)
+				return;
+		}
+		std::filesystem::rename(temporaryPath, path, error);
+	}
+
+	ShaderCompiler::DiskFootprint ShaderCompiler::GetDiskFootprint() const
+	{
+		DiskFootprint footprint;
+		std::error_code error;
+		for (const auto& entry : std::filesystem::directory_iterator(m_CacheDirectory, error))
+		{
+			if (!entry.is_regular_file() || entry.path().extension() != ".cso")
+				continue;
+			++footprint.FileCount;
+			footprint.Bytes += entry.file_size();
+		}
+		return footprint;
+	}
+
+	std::filesystem::path ShaderCompiler::GetCachePath(const uint64_t pKey) const
+	{
+		char name[32];
+		std::snprintf(name, sizeof(name), "%016llx.cso", static_cast<unsigned long long>(pKey));
+		return m_CacheDirectory / name;
+	}
+}
@@ -0,0 +1,135 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Engine
+{
+	using ShaderBytecode = std::vector<uint8_t>;
+
+	struct ShaderDefine
+	{
+		std::string Name;
+		std::string Value;
+	};
+
+	struct ShaderCompileRequest
+	{
+		std::filesystem::path Path;
+		std::string EntryPoint;
+		std::string Target;
+		std::vector<ShaderDefine> Defines;
+	};
+
+	/// <summary>
+	/// Turns a source file into bytecode, implemented for each platform's compiler.
+	/// </summary>
+	class ShaderCompilerBackend
+	{
+	public:
+		virtual ~ShaderCompilerBackend() = default;
+
+		/// <summary>
+		/// Compiles pRequest, includes are resolved relative to the including file. Called from several threads
+		/// at once.
+		/// </summary>
+		/// <returns> False on failure, pErrors holds the compiler's messages. </returns>
+		virtual bool Compile(const ShaderCompileRequest& pRequest, ShaderBytecode& pOutBytecode,
+		                     std::string& pErrors) const = 0;
+		/// <returns> Identifies the compiler and its flags, cached bytecode of another version is not used. </returns>
+		virtual std::string GetVersionTag() const = 0;
+	};
+
+	/// <summary>
+	/// Compiles shaders once. The bytecode is stored in a cache directory, under a hash of everything that
+	/// produces it : the source, the files it includes, the defines, entry point, target and compiler version.
+	/// Editing any of them changes the hash, the stale file is simply not looked up anymore.
+	/// CompileAll() compiles the requests missing from the cache in parallel on the job system, Compile() then
+	/// finds them in memory.
+	/// Not thread safe, shaders are created from the main thread.
+	/// </summary>
+	class ShaderCompiler
+	{
+	public:
+		struct Stats
+		{
+			uint32_t Requests = 0;
+			// Requests of bytecode already loaded or compiled during this run.
+			uint32_t MemoryHits = 0;
+			// Bytecode read from the cache directory.
+			uint32_t DiskHits = 0;
+			uint32_t Compiled = 0;
+			uint32_t Failed = 0;
+			// Time spent in the backend, summed over the threads.
+			double CompileMilliseconds = 0.0;
+			// Time spent in CompileAll() and Compile(), hashing and file accesses included.
+			double WallMilliseconds = 0.0;
+			// Bytecode held in memory, each distinct key once.
+			uint64_t BytecodeBytes = 0;
+		};
+
+		struct DiskFootprint
+		{
+			uint32_t FileCount = 0;
+			uint64_t Bytes = 0;
+		};
+
+		static constexpr uint32_t k_FileMagic = 0x31435353; // "SSC1"
+		// Changes whenever the key or the file layout does.
+		static constexpr uint32_t k_FileVersion = 1;
+
+		/// <param name="pBackend"></param>
+		/// <param name="pCacheDirectory"> : created on the first write</param>
+		ShaderCompiler(std::unique_ptr<ShaderCompilerBackend> pBackend, std::filesystem::path pCacheDirectory);
+
+		ShaderCompiler(const ShaderCompiler&) = delete;
+		ShaderCompiler& operator=(const ShaderCompiler&) = delete;
+
+		/// <summary>
+		/// Loads or compiles every request, the misses in parallel. Failures are logged, the matching Compile()
+		/// call throws.
+		/// </summary>
+		void CompileAll(const std::vector<ShaderCompileRequest>& pRequests);
+		/// <returns> The bytecode of pRequest, it lives as long as the compiler. Throws when it does not compile. </returns>
+		const ShaderBytecode& Compile(const ShaderCompileRequest& pRequest);
+
+		/// <returns> The cache key of pRequest, it reads the source and its includes. </returns>
+		uint64_t GetKey(const ShaderCompileRequest& pRequest) const;
+		/// <summary>
+		/// Follows the #include directives of pPath. Includes that cannot be found are skipped, the compiler
+		/// reports them.
+		/// </summary>
+		/// <returns> pPath then the files it includes, each once, in the order they are included. </returns>
+		static std::vector<std::filesystem::path> GetSourceFiles(const std::filesystem::path& pPath);
+
+		[[nodiscard]] const Stats& GetStats() const { return m_Stats; }
+		/// <returns> What the cache directory holds, the entries of edited sources included. </returns>
+		[[nodiscard]] DiskFootprint GetDiskFootprint() const;
+
+	private:
+		struct Miss
+		{
+			const ShaderCompileRequest* Request;
+			uint64_t Key;
+			ShaderBytecode Bytecode;
+			std::string Errors;
+			bool IsCompiled = false;
+			double Milliseconds = 0.0;
+		};
+
+		// Memory then disk, true when pKey is in m_Bytecode afterward.
+		bool TryLoad(uint64_t pKey);
+		void Store(uint64_t pKey, ShaderBytecode pBytecode);
+		void CompileMiss(Miss& pMiss) const;
+		std::filesystem::path GetCachePath(uint64_t pKey) const;
+
+		std::unique_ptr<ShaderCompilerBackend> m_Backend;
+		std::string m_BackendVersion;
+		std::filesystem::path m_CacheDirectory;
+		std::unordered_map<uint64_t, ShaderBytecode> m_Bytecode;
+		Stats m_Stats;
+	};
+}
@@ -0,0 +1,56 @@
+#pragma once
+// Generated by Scripts/GenerateShaderLayouts.py from Engine/Shaders, do not edit.
+#include <cstddef>
+#include <cstdint>
+
+#include <DirectXMath.h>
+
+namespace Engine
+{
+	// struct DirectionalLight of Builtin.Lit.hlsl, cbuffer packing, 28 bytes in HLSL.
+	struct DirectionalLight
+	{
+		DirectX::XMFLOAT3 Color;
+		uint32_t Padding0[1];
+		DirectX::XMFLOAT3 Direction;
+		uint32_t Padding1[1];
+	};
+
+	static_assert(offsetof(DirectionalLight, Color) == 0);
+	static_assert(offsetof(DirectionalLight, Direction) == 16);
+	static_assert(sizeof(DirectionalLight) == 32);
+
+	// cbuffer cbPass of Builtin.Lit.hlsl, cbuffer packing, 412 bytes in HLSL.
+	struct PassConstants
+	{
+		DirectX::XMFLOAT4X4 ViewProj;
+		DirectX::XMFLOAT3 EyePosW;
+		int32_t NumDirectionalLights;
+		DirectX::XMFLOAT4 AmbientLight;
+		DirectionalLight DirectionalLights[10];
+	};
+
+	static_assert(offsetof(PassConstants, ViewProj) == 0);
+	static_assert(offsetof(PassConstants, EyePosW) == 64);
+	static_assert(offsetof(PassConstants, NumDirectionalLights) == 76);
+	static_assert(offsetof(PassConstants, AmbientLight) == 80);
+	static_assert(offsetof(PassConstants, DirectionalLights) == 96);
+	static_assert(sizeof(PassConstants) == 416);
+
+	// struct LitMaterialConstants of Builtin.Lit.hlsl, structured packing, 48 bytes in HLSL.
+	struct LitMaterialConstants
+	{
+		DirectX::XMFLOAT4 Albedo;
+		DirectX::XMFLOAT4 Specular;
+		float Smoothness;
+		float Fresnel;
+		DirectX::XMFLOAT2 Tiling;
+	};
+
+	static_assert(offsetof(LitMaterialConstants, Albedo) == 0);
+	static_assert(offsetof(LitMaterialConstants, Specular) == 16);
+	static_assert(offsetof(LitMaterialConstants, Smoothness) == 32);
+	static_assert(offsetof(LitMaterialConstants, Fresnel) == 36);
+	static_assert(offsetof(LitMaterialConstants, Tiling) == 40);
+	static_assert(sizeof(LitMaterialConstants) == 48);
+}
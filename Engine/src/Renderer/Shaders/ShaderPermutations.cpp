@@ -0,0 +1,101 @@
+#include "ShaderPermutations.h"
+
+#include <bit>
+#include <stdexcept>
+
+namespace Engine
+{
+	ShaderPermutations::ShaderPermutations(std::vector<ShaderFeature> pFeatures)
+		: m_Features(std::move(pFeatures))
+	{
+		uint32_t shift = 0;
+		for (const ShaderFeature& feature : m_Features)
+		{
+			if (feature.Values.empty())
+				throw std::invalid_argument("Shader feature without value.");
+
+			const uint32_t bits = std::bit_width(static_cast<uint32_t>(feature.Values.size() - 1));
+			m_Fields.push_back({shift, (1u << bits) - 1});
+			shift += bits;
+		}
+		if (shift > k_MaxKeyBits)
+			throw std::invalid_argument("Too many shader permutations for a variant key.");
+	}
+
+	ShaderVariantKey ShaderPermutations::Select(const ShaderVariantKey pKey, const uint32_t pFeature,
+	                                            const uint32_t pMinimum) const
+	{
+		const std::vector<uint32_t>& values = m_Features[pFeature].Values;
+		uint32_t index = 0;
+		while (index + 1 < values.size() && values[index] < pMinimum)
+			++index;
+
+		const Field& field = m_Fields[pFeature];
+		return (pKey & ~(field.Mask << field.Shift)) | (index << field.Shift);
+	}
+
+	uint32_t ShaderPermutations::GetValue(const ShaderVariantKey pKey, const uint32_t pFeature) const
+	{
+		return m_Features[pFeature].Values[GetValueIndex(pKey, pFeature)];
+	}
+
+	std::vector<ShaderDefine> ShaderPermutations::GetDefines(const ShaderVariantKey pKey,
+	                                                         const RhiShaderVisibility pStage) const
+	{
+		std::vector<ShaderDefine> defines;
+		for (uint32_t i = 0; i < m_Features.size(); ++i)
+		{
+			const RhiShaderVisibility visibility = m_Features[i].Visibility;
+			if (visibility == RhiShaderVisibility::All || visibility == pStage)
+				defines.push_back({m_Features[i].Define, std::to_string(GetValue(pKey, i))});
+		}
+		return defines;
+	}
+
+	std::string ShaderPermutations::ToString(const ShaderVariantKey pKey) const
+	{
+		std::string result;
+		for (uint32_t i = 0; i < m_Features.size(); ++i)
+		{
+			if (!result.empty())
+				result += ' ';
+			result += m_Features[i].Define + '=' + std::to_string(GetValue(pKey, i));
+		}
+		return result;
+	}
+
+	std::vector<ShaderVariantKey> ShaderPermutations::GetAllKeys() const
+	{
+		// Counts in mixed radix, each digit a feature's value index.
+		std::vector<ShaderVariantKey> keys;
+		keys.reserve(GetVariantCount());
+		std::vector<uint32_t> indices(m_Features.size(), 0);
+		while (true)
+		{
+			ShaderVariantKey key = 0;
+			for (uint32_t i = 0; i < m_Features.size(); ++i)
+				key |= indices[i] << m_Fields[i].Shift;
+			keys.push_back(key);
+
+			uint32_t digit = 0;
+			while (digit < m_Features.size() && ++indices[digit] == m_Features[digit].Values.size())
+				indices[digit++] = 0;
+			if (digit == m_Features.size())
+				return keys;
+		}
+	}
+
+	uint32_t ShaderPermutations::GetVariantCount() const
+	{
+		uint32_t count = 1;
+		for (const ShaderFeature& feature : m_Features)
+			count *= static_cast<uint32_t>(feature.Values.size());
+		return count;
+	}
+
+	uint32_t ShaderPermutations::GetValueIndex(const ShaderVariantKey pKey, const uint32_t pFeature) const
+	{
+		const Field& field = m_Fields[pFeature];
+		return (pKey >> field.Shift) & field.Mask;
+	}
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ShaderCompiler.h"
+#include "Renderer/RHI/RhiTypes.h"
+
+namespace Engine
+{
+	/// <summary>
+	/// Packs the value index of every feature of a shader, see ShaderPermutations.
+	/// </summary>
+	using ShaderVariantKey = uint32_t;
+
+	/// <summary>
+	/// A switch of a shader, compiled in as "#define Define Value".
+	/// </summary>
+	struct ShaderFeature
+	{
+		std::string Define;
+		// In increasing order, the first one is the cheapest.
+		std::vector<uint32_t> Values;
+		// Stages the define is given to, the others compile the same bytecode for every value.
+		RhiShaderVisibility Visibility = RhiShaderVisibility::All;
+	};
+
+	/// <summary>
+	/// The features of a shader and the variant keys they make. A key stores the index of each feature's value
+	/// in the fewest bits that hold it, the feature declared first in the lowest bits. Key 0 is the variant
+	/// with every feature at its first value.
+	/// </summary>
+	class ShaderPermutations
+	{
+	public:
+		// A key is part of the draws' sort keys, see DrawQueue::k_VariantBits.
+		static constexpr uint32_t k_MaxKeyBits = 16;
+
+		ShaderPermutations() = default;
+		/// <summary>
+		/// Throws when a feature has no value or the keys need more than k_MaxKeyBits.
+		/// </summary>
+		explicit ShaderPermutations(std::vector<ShaderFeature> pFeatures);
+
+		/// <returns> pKey with pFeature set to its smallest value that is at least pMinimum, or to its largest one. </returns>
+		[[nodiscard]] ShaderVariantKey Select(ShaderVariantKey pKey, uint32_t pFeature, uint32_t pMinimum) const;
+		[[nodiscard]] uint32_t GetValue(ShaderVariantKey pKey, uint32_t pFeature) const;
+
+		/// <returns> The defines of the features visible to pStage, one per feature. </returns>
+		[[nodiscard]] std::vector<ShaderDefine> GetDefines(ShaderVariantKey pKey, RhiShaderVisibility pStage) const;
+		/// <returns> "DEFINE=value DEFINE=value", for logs. </returns>
+		[[nodiscard]] std::string ToString(ShaderVariantKey pKey) const;
+
+		/// <returns> Every key, each combination of values once. </returns>
+		[[nodiscard]] std::vector<ShaderVariantKey> GetAllKeys() const;
+		[[nodiscard]] uint32_t GetVariantCount() const;
+		[[nodiscard]] const std::vector<ShaderFeature>& GetFeatures() const { return m_Features; }
+
+	private:
+		struct Field
+		{
+			uint32_t Shift;
+			uint32_t Mask;
+		};
+
+		[[nodiscard]] uint32_t GetValueIndex(ShaderVariantKey pKey, uint32_t pFeature) const;
+
+		std::vector<ShaderFeature> m_Features;
+		std::vector<Field> m_Fields;
+	};
+}
@@ -0,0 +1,154 @@
+#include "StaticBatcher.h"
+
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "Vertex.h"
+#include "Core/JobSystem.h"
+
+namespace Engine
+{
+	template <typename T>
+	std::vector<Object*> StaticBatcher::Build(Object* const* pObjects, const size_t pCount)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		std::vector<Batch> batches;
+		std::vector<MergedMesh> merged;
+		std::vector<Object*> skipped = Merge(pObjects, pCount, MergeVertexFormat::Of<T>(), batches, merged);
+
+		// The meshes are created on this thread, from the merged bytes.
+		for (size_t i = 0; i < batches.size(); ++i)
+		{
+			std::vector<T> vertices;
+			vertices.reserve(merged[i].VertexCount);
+			for (uint32_t vertex = 0; vertex < merged[i].VertexCount; ++vertex)
+				vertices.push_back(reinterpret_cast<const T*>(merged[i].Vertices.data())[vertex]);
+
+			if (merged[i].Indices32.empty())
+				AddBatch(std::make_unique<DirectXMesh>(vertices, merged[i].Indices16), batches[i]);
+			else
+				AddBatch(std::make_unique<DirectXMesh>(vertices, merged[i].Indices32), batches[i]);
+		}
+
+		m_Stats.ThreadCount = JobSystem::GetThreadCount();
+		m_Stats.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		return skipped;
+	}
+
+	template std::vector<Object*> StaticBatcher::Build<VertexColor>(Object* const* pObjects, size_t pCount);
+	template std::vector<Object*> StaticBatcher::Build<VertexTex>(Object* const* pObjects, size_t pCount);
+	template std::vector<Object*> StaticBatcher::Build<VertexLit>(Object* const* pObjects, size_t pCount);
+
+	void StaticBatcher::Render() const
+	{
+		Object::CullAndSelectLods(m_ObjectPointers.data(), m_ObjectPointers.size());
+		for (Object* object : m_ObjectPointers)
+			object->Render();
+	}
+
+	std::vector<StaticBatcher::Batch> StaticBatcher::Plan(Object* const* pObjects, const size_t pCount,
+	                                                      const uint32_t pVertexStride, std::vector<Object*>& pSkipped)
+	{
+		// Materials are ordered as they are first met rather than by address, so every run gives the same batches.
+		std::unordered_map<const DirectXMaterial*, uint32_t> materialOrders;
+		std::map<std::tuple<uint32_t, int32_t, int32_t, int32_t>, std::vector<const Object*>> chunks;
+		std::unordered_map<uint32_t, DirectXMaterial*> materials;
+		std::unordered_set<const DirectXMesh*> sourceMeshes;
+		for (size_t i = 0; i < pCount; ++i)
+		{
+			Object* object = pObjects[i];
+			const DirectXMesh* mesh = object->GetMesh();
+			if (mesh->GetVertexStride() != pVertexStride)
+			{
+				pSkipped.push_back(object);
+				m_Stats.SkippedObjects++;
+				continue;
+			}
+
+			m_Stats.SourceObjects++;
+			if (sourceMeshes.insert(mesh).second)
+				m_Stats.SourceBytes += mesh->GetGpuBytes();
+
+			const uint32_t order = materialOrders.emplace(object->GetMaterial(),
+			                                              static_cast<uint32_t>(materialOrders.size())).first->second;
+			materials[order] = object->GetMaterial();
+
+			// The chunk of the bounds' center, an Object spanning several chunks goes in one of them.
+			const DirectX::XMFLOAT3 center = object->GetWorldBounds().Center;
+			chunks[{order, static_cast<int32_t>(std::floor(center.x / m_Settings.ChunkSize)),
+			        static_cast<int32_t>(std::floor(center.y / m_Settings.ChunkSize)),
+			        static_cast<int32_t>(std::floor(center.z / m_Settings.ChunkSize))}].push_back(object);
+		}
+
+		std::vector<Batch> batches;
+		for (const auto& [key, objects] : chunks)
+		{
+			const auto& [order, x, y, z] = key;
+			const DirectX::XMFLOAT3 origin((x + 0.5f) * m_Settings.ChunkSize, (y + 0.5f) * m_Settings.ChunkSize,
+			                               (z + 0.5f) * m_Settings.ChunkSize);
+			bool isFirst = true;
+			for (const Object* object : objects)
+			{
+				const DirectXMesh* mesh = object->GetMesh();
+				const auto vertexCount = static_cast<uint32_t>(mesh->GetVertexData().size() / pVertexStride);
+				const auto indexCount = static_cast<uint32_t>(mesh->GetIndices().size());
+				if (isFirst || batches.back().VertexCount + vertexCount > m_Settings.MaxVertices)
+				{
+					batches.push_back({materials[order], origin});
+					isFirst = false;
+				}
+				Batch& batch = batches.back();
+				batch.Objects.push_back(object);
+				batch.VertexCount += vertexCount;
+				batch.IndexCount += indexCount;
+			}
+		}
+		return batches;
+	}
+
+	std::vector<Object*> StaticBatcher::Merge(Object* const* pObjects, const size_t pCount,
+	                                          const MergeVertexFormat& pFormat, std::vector<Batch>& pBatches,
+	                                          std::vector<MergedMesh>& pMerged)
+	{
+		m_Objects.clear();
+		m_ObjectPointers.clear();
+		m_Meshes.clear();
+		m_Stats = {};
+
+		std::vector<Object*> skipped;
+		pBatches = Plan(pObjects, pCount, pFormat.Stride, skipped);
+
+		std::vector<std::vector<MergeSource>> sources(pBatches.size());
+		for (size_t i = 0; i < pBatches.size(); ++i)
+		{
+			const WorldPosition origin(pBatches[i].Origin);
+			for (const Object* object : pBatches[i].Objects)
+			{
+				const DirectXMesh* mesh = object->GetMesh();
+				sources[i].push_back({
+					mesh->GetVertexData().data(), static_cast<uint32_t>(mesh->GetVertexData().size() / pFormat.Stride),
+					mesh->GetIndices().data(), static_cast<uint32_t>(mesh->GetIndices().size()),
+					object->GetWorldMatrixRelativeTo(origin)
+				});
+			}
+		}
+		MeshMerger::MergeAll(sources, pFormat, pMerged);
+		return skipped;
+	}
+
+	void StaticBatcher::AddBatch(std::unique_ptr<DirectXMesh> pMesh, const Batch& pBatch)
+	{
+		m_Stats.Batches++;
+		if (pBatch.VertexCount > MeshMerger::k_Max16BitVertices)
+			m_Stats.Batches32BitIndices++;
+		m_Stats.BatchBytes += pMesh->GetGpuBytes();
+
+		m_Objects.push_back(std::make_unique<Object>(pBatch.Origin, pMesh.get(), pBatch.Material));
+		m_ObjectPointers.push_back(m_Objects.back().get());
+		m_Meshes.push_back(std::move(pMesh));
+	}
+}
@@ -0,0 +1,113 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <DirectXMath.h>
+
+#include "DirectXMesh.h"
+#include "MeshMerger.h"
+#include "Core/Object.h"
+
+namespace Engine
+{
+	/// <summary>
+	/// Merges static Objects sharing a material into combined meshes, one per chunk of a world grid so the
+	/// batches stay small enough to be culled. A batch is drawn by one Object placed at its chunk's center,
+	/// the vertices are baked relative to it, so the sources must not move afterward.
+	/// Batches are merged in parallel by MeshMerger : the result does not depend on the thread count. Batches of
+	/// more than 65536 vertices get 32 bits indices.
+	/// The source Objects are left as they are, the caller stops rendering them.
+	/// </summary>
+	class StaticBatcher
+	{
+	public:
+		struct Settings
+		{
+			// Edge length of the cubic chunks, in world units.
+			float ChunkSize = 32.f;
+			// Vertices of a batch, a chunk holding more is split.
+			uint32_t MaxVertices = 1 << 20;
+		};
+
+		struct Stats
+		{
+			uint32_t SourceObjects = 0;
+			// Objects whose vertex stride did not match, they were not batched.
+			uint32_t SkippedObjects = 0;
+			uint32_t Batches = 0;
+			uint32_t Batches32BitIndices = 0;
+			// Of the distinct meshes of the batched Objects, and of the batches.
+			uint64_t SourceBytes = 0;
+			uint64_t BatchBytes = 0;
+			uint32_t ThreadCount = 0;
+			double Seconds = 0.0;
+
+			/// <returns> The part of the sources' draws saved, 0.9 when 10 Objects became 1 batch. </returns>
+			float GetDrawCallReduction() const
+			{
+				return SourceObjects > 0 ? 1.f - static_cast<float>(Batches) / static_cast<float>(SourceObjects) : 0.f;
+			}
+			/// <returns> The batches' GPU bytes over the sources' ones. </returns>
+			float GetMemoryGrowth() const
+			{
+				return SourceBytes > 0 ? static_cast<float>(BatchBytes) / static_cast<float>(SourceBytes) : 0.f;
+			}
+		};
+
+		StaticBatcher() = default;
+		explicit StaticBatcher(const Settings& pSettings) : m_Settings(pSettings) {}
+
+		StaticBatcher(const StaticBatcher&) = delete;
+		StaticBatcher& operator=(const StaticBatcher&) = delete;
+
+		/// <summary>
+		/// Replaces the previous batches with the ones of pObjects. Only lod 0 is merged.
+		/// </summary>
+		/// <typeparam name="T"> : vertex of the meshes, one of Vertex.h. Objects whose mesh has another stride are
+		/// skipped</typeparam>
+		/// <returns> The skipped Objects, to keep rendering them. </returns>
+		template <typename T>
+		std::vector<Object*> Build(Object* const* pObjects, size_t pCount);
+
+		/// <summary>
+		/// Call this in between BeginFrame() and EndFrame(), like Object::Render(), to draw every batch. The
+		/// batches are culled first, with Object::CullAndSelectLods().
+		/// </summary>
+		void Render() const;
+
+		/// <returns> The Objects drawing the batches. </returns>
+		const std::vector<std::unique_ptr<Object>>& GetObjects() const { return m_Objects; }
+		const Stats& GetStats() const { return m_Stats; }
+
+	private:
+		struct Batch
+		{
+			DirectXMaterial* Material = nullptr;
+			DirectX::XMFLOAT3 Origin;
+			// In the order they were given.
+			std::vector<const Object*> Objects;
+			uint32_t VertexCount = 0;
+			uint32_t IndexCount = 0;
+		};
+
+		/// <summary>
+		/// Sorts pObjects by material, in the order the materials are first met, then by chunk, and splits the
+		/// chunks over Settings::MaxVertices.
+		/// </summary>
+		std::vector<Batch> Plan(Object* const* pObjects, size_t pCount, uint32_t pVertexStride,
+		                        std::vector<Object*>& pSkipped);
+		/// <summary>
+		/// Clears the previous batches, then plans and merges the new ones.
+		/// </summary>
+		std::vector<Object*> Merge(Object* const* pObjects, size_t pCount, const MergeVertexFormat& pFormat,
+		                           std::vector<Batch>& pBatches, std::vector<MergedMesh>& pMerged);
+		void AddBatch(std::unique_ptr<DirectXMesh> pMesh, const Batch& pBatch);
+
+		Settings m_Settings;
+		Stats m_Stats;
+		std::vector<std::unique_ptr<DirectXMesh>> m_Meshes;
+		std::vector<std::unique_ptr<Object>> m_Objects;
+		// m_Objects, as Object::CullAndSelectLods() takes them.
+		std::vector<Object*> m_ObjectPointers;
+	};
+}
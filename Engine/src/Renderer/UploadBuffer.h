@@ -1,6 +1,7 @@
 ﻿#pragma once
+#include <algorithm>
 
-#include "DirectXContext.h"
+#include "RHI/RhiDevice.h"
 
 namespace Engine
 {
@@ -8,63 +9,61 @@ namespace Engine
 	class UploadBuffer
 	{
 	public:
-		UploadBuffer(ID3D12Device* device, UINT elementCount, bool isConstantBuffer) :
-			mIsConstantBuffer(isConstantBuffer)
+		UploadBuffer(RhiDevice* device, uint32_t elementCount, bool isConstantBuffer) :
+			mDevice(device), mIsConstantBuffer(isConstantBuffer)
 		{
 			mElementByteSize = sizeof(T);
 
 			// Constant buffer elements need to be multiples of 256 bytes.
-			// This is because the hardware can only view constant data 
-			// at m*256 byte offsets and of n*256 byte lengths. 
+			// This is because the hardware can only view constant data
+			// at m*256 byte offsets and of n*256 byte lengths.
 			// typedef struct D3D12_CONSTANT_BUFFER_VIEW_DESC {
 			// UINT64 OffsetInBytes; // multiple of 256
 			// UINT   SizeInBytes;   // multiple of 256
 			// } D3D12_CONSTANT_BUFFER_VIEW_DESC;
 			if (isConstantBuffer)
-				mElementByteSize = DirectXContext::CalcConstantBufferByteSize(sizeof(T));
+				mElementByteSize = static_cast<uint32_t>(RhiAlign(sizeof(T), k_RhiConstantBufferAlignment));
 
-			const auto propertyUpload = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
-			const auto buffer = CD3DX12_RESOURCE_DESC::Buffer(mElementByteSize * elementCount);
-			THROW_IF_FAILED(device->CreateCommittedResource(
-				&propertyUpload,
-				D3D12_HEAP_FLAG_NONE,
-				&buffer,
-				D3D12_RESOURCE_STATE_GENERIC_READ,
-				nullptr,
-				IID_PPV_ARGS(&mUploadBuffer)));
-
-			THROW_IF_FAILED(mUploadBuffer->Map(0, nullptr, reinterpret_cast<void**>(&mMappedData)));
-
-			// We do not need to unmap until we are done with the resource.  However, we must not write to
+			// The buffer stays mapped until it is destroyed. However, we must not write to
 			// the resource while it is in use by the GPU (so we must use synchronization techniques).
+			mUploadBuffer = device->CreateBuffer({static_cast<uint64_t>(mElementByteSize) * elementCount,
+			                                      RhiHeapType::Upload});
 		}
 
 		UploadBuffer(const UploadBuffer& rhs) = delete;
 		UploadBuffer& operator=(const UploadBuffer& rhs) = delete;
 
-		~UploadBuffer()
+		RhiBuffer* Resource() const
 		{
-			if (mUploadBuffer != nullptr)
-				mUploadBuffer->Unmap(0, nullptr);
-
-			mMappedData = nullptr;
+			return mUploadBuffer.get();
 		}
 
-		ID3D12Resource* Resource() const
+		/// <returns> The GPU address of an element, to bind it as a root constant buffer. </returns>
+		RhiGpuAddress GetGpuAddress(int elementIndex = 0) const
 		{
-			return mUploadBuffer.Get();
+			return mUploadBuffer->GetGpuAddress() + static_cast<uint64_t>(elementIndex) * mElementByteSize;
 		}
 
 		void CopyData(int elementIndex, const T& data)
 		{
-			memcpy(&mMappedData[elementIndex * mElementByteSize], &data, sizeof(T));
+			mDevice->WriteBuffer(*mUploadBuffer, static_cast<uint64_t>(elementIndex) * mElementByteSize, &data,
+			                     sizeof(T));
+		}
+
+		/// <summary>
+		/// Copies the first pByteSize bytes of data, the rest of the element keeps its content.
+		/// </summary>
+		void CopyData(int elementIndex, const T& data, uint32_t pByteSize)
+		{
+			mDevice->WriteBuffer(*mUploadBuffer, static_cast<uint64_t>(elementIndex) * mElementByteSize, &data,
+			                     (std::min)(pByteSize, static_cast<uint32_t>(sizeof(T))));
 		}
 
 	private:
-		Microsoft::WRL::ComPtr<ID3D12Resource> mUploadBuffer;
-		BYTE* mMappedData = nullptr;
+		RhiDevice* mDevice = nullptr;
+		std::unique_ptr<RhiBuffer> mUploadBuffer;
 
-		UINT mElementByteSize = 0;
+		uint32_t mElementByteSize = 0;
 		bool mIsConstantBuffer = false;
 	};
 }
@@ -0,0 +1,195 @@
+#include "UploadManager.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace Engine
+{
+	UploadManager::UploadManager(RhiDevice& pDevice, const uint64_t pStagingSize)
+		: m_Device(pDevice), m_Fence(pDevice.CreateFence(0)), m_CommandList(pDevice.CreateCommandList(RhiQueueType::Copy)),
+		  m_StagingSize(RhiAlign(pStagingSize, k_RhiTexturePlacementAlignment))
+	{
+		m_Staging = m_Device.CreateBuffer({m_StagingSize, RhiHeapType::Upload});
+	}
+
+	UploadManager::~UploadManager()
+	{
+		Wait(Submit());
+		Retire();
+	}
+
+	std::unique_ptr<RhiBuffer> UploadManager::CreateBuffer(const void* pData, const uint64_t pSize)
+	{
+		std::unique_ptr<RhiBuffer> buffer = m_Device.CreateBuffer({pSize, RhiHeapType::Default});
+		UploadBuffer(*buffer, 0, pData, pSize);
+		return buffer;
+	}
+
+	void UploadManager::UploadBuffer(const RhiBuffer& pDestination, const uint64_t pOffset, const void* pData,
+	                                 const uint64_t pSize)
+	{
+		const StagingAllocation staging = Allocate(pSize, 16);
+		std::memcpy(staging.CpuAddress, pData, pSize);
+
+		BeginBatch();
+		m_CommandList->CopyBufferRegion(pDestination, pOffset, *staging.Buffer, staging.Offset, pSize);
+		++m_Stats.BufferUploads;
+		m_Stats.UploadedBytes += pSize;
+	}
+
+	void UploadManager::UploadTexture(const RhiTexture& pDestination, const RhiSubresourceData* pSubresources,
+	                                  const uint32_t pCount)
+	{
+		const uint64_t size = m_Device.GetTextureFootprints(pDestination, m_Footprints);
+		if (pCount != m_Footprints.size())
+			throw std::invalid_argument("Texture upload without every subresource.");
+
+		const StagingAllocation staging = Allocate(size, k_RhiTexturePlacementAlignment);
+		BeginBatch();
+		for (uint32_t i = 0; i < pCount; ++i)
+		{
+			// The rows are padded to the footprint's pitch, the slices follow each other.
+			const RhiTextureFootprint& footprint = m_Footprints[i];
+			const auto* source = static_cast<const uint8_t*>(pSubresources[i].Data);
+			uint8_t* destination = staging.CpuAddress + footprint.Offset;
+			for (uint32_t slice = 0; slice < footprint.Depth; ++slice)
+			{
+				for (uint32_t row = 0; row < footprint.RowCount; ++row)
+				{
+					std::memcpy(destination + (static_cast<uint64_t>(slice) * footprint.RowCount + row) * footprint.RowPitch,
+					            source + slice * pSubresources[i].SlicePitch + row * pSubresources[i].RowPitch,
+					            footprint.RowSize);
+				}
+			}
+			m_CommandList->CopyBufferToTexture(pDestination, i, *staging.Buffer, staging.Offset + footprint.Offset,
+			                                   footprint);
+			m_Stats.UploadedBytes += footprint.RowSize * footprint.RowCount * footprint.Depth;
+		}
+		++m_Stats.TextureUploads;
+	}
+
+	UploadTicket UploadManager::Submit()
+	{
+		if (!m_IsRecording)
+			return m_LastSubmittedTicket;
+
+		m_CommandList->End();
+		RhiCommandQueue& queue = m_Device.GetQueue(RhiQueueType::Copy);
+		RhiCommandList* lists[] = {m_CommandList.get()};
+		queue.Execute(lists, 1);
+		queue.Signal(*m_Fence, ++m_LastSubmittedTicket);
+
+		m_Current.Ticket = m_LastSubmittedTicket;
+		m_Current.End = m_Head;
+		m_Batches.push_back(std::move(m_Current));
+		m_Current = {};
+		m_IsRecording = false;
+		++m_Stats.Submissions;
+		return m_LastSubmittedTicket;
+	}
+
+	bool UploadManager::IsDone(const UploadTicket pTicket) const
+	{
+		// A ticket with nothing recorded under it is done.
+		if (pTicket > m_LastSubmittedTicket)
+			return !m_IsRecording;
+		return m_Fence->GetCompletedValue() >= pTicket;
+	}
+
+	void UploadManager::Wait(const UploadTicket pTicket)
+	{
+		if (pTicket > m_LastSubmittedTicket)
+			Submit();
+		m_Fence->Wait((std::min)(pTicket, m_LastSubmittedTicket));
+	}
+
+	void UploadManager::MakeVisible(RhiCommandQueue& pQueue)
+	{
+		if (m_LastVisibleTicket == m_LastSubmittedTicket)
+			return;
+
+		m_LastVisibleTicket = m_LastSubmittedTicket;
+		if (m_Fence->GetCompletedValue() >= m_LastVisibleTicket)
+			return;
+		pQueue.Wait(*m_Fence, m_LastVisibleTicket);
+		++m_Stats.QueueWaits;
+	}
+
+	void UploadManager::Retire()
+	{
+		const uint64_t completed = m_Fence->GetCompletedValue();
+		while (!m_Batches.empty() && m_Batches.front().Ticket <= completed)
+		{
+			Batch& batch = m_Batches.front();
+			m_Tail = (std::max)(m_Tail, batch.End);
+			m_FreeAllocators.push_back(std::move(batch.Allocator));
+			m_Batches.pop_front();
+		}
+		m_Stats.StagingBytes = m_Head - m_Tail;
+	}
+
+	void UploadManager::BeginBatch()
+	{
+		if (m_IsRecording)
+			return;
+
+		if (m_FreeAllocators.empty())
+		{
+			m_Current.Allocator = m_Device.CreateCommandAllocator(RhiQueueType::Copy);
+		}
+		else
+		{
+			m_Current.Allocator = std::move(m_FreeAllocators.back());
+			m_FreeAllocators.pop_back();
+		}
+		m_Current.Allocator->Reset();
+		m_CommandList->Begin(*m_Current.Allocator);
+		m_IsRecording = true;
+	}
+
+	UploadManager::StagingAllocation UploadManager::Allocate(const uint64_t pSize, const uint64_t pAlignment)
+	{
+		if (pSize > m_StagingSize)
+		{
+			// Lives as long as the batch, as the ring memory would.
+			BeginBatch();
+			m_Current.DedicatedBuffers.push_back(m_Device.CreateBuffer({pSize, RhiHeapType::Upload}));
+			++m_Stats.DedicatedUploads;
+			RhiBuffer* buffer = m_Current.DedicatedBuffers.back().get();
+			return {buffer, 0, buffer->GetMappedData()};
+		}
+
+		while (true)
+		{
+			uint64_t start = RhiAlign(m_Head, pAlignment);
+			// An allocation does not wrap around, it starts over at the beginning of the buffer.
+			if (start % m_StagingSize + pSize > m_StagingSize)
+				start = (start / m_StagingSize + 1) * m_StagingSize;
+			// Nothing in use, the skipped end of the ring is not waited for.
+			if (m_Head == m_Tail)
+				m_Tail = start;
+
+			if (start + pSize - m_Tail <= m_StagingSize)
+			{
+				m_Head = start + pSize;
+				m_Stats.StagingBytes = m_Head - m_Tail;
+				m_Stats.PeakStagingBytes = (std::max)(m_Stats.PeakStagingBytes, m_Stats.StagingBytes);
+				const uint64_t offset = start % m_StagingSize;
+				return {m_Staging.get(), offset, m_Staging->GetMappedData() + offset};
+			}
+
+			// Full : frees the batches done, or waits for the oldest one. When the batch being recorded fills
+			// the ring by itself, it is submitted first.
+			if (m_Batches.empty())
+				Submit();
+			Retire();
+			if (!m_Batches.empty() && m_Batches.front().Ticket > m_Fence->GetCompletedValue())
+			{
+				++m_Stats.StagingWaits;
+				m_Fence->Wait(m_Batches.front().Ticket);
+				Retire();
+			}
+		}
+	}
+}
@@ -0,0 +1,134 @@
+#pragma once
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "RHI/RhiDevice.h"
+
+namespace Engine
+{
+	/// <summary>
+	/// Fence value of the copy queue the uploads of a batch are done at. 0 is done from the start.
+	/// </summary>
+	using UploadTicket = uint64_t;
+
+	/// <summary>
+	/// Uploads buffers and textures on the copy queue, without waiting. The data is staged in a ring of upload
+	/// memory and the copies recorded into the current batch, Submit() executes the whole batch at once and
+	/// signals its ticket. The graphics queue waits for the submitted batches on the GPU (MakeVisible()), the
+	/// CPU only blocks when the ring is full or when asked to (Wait()).
+	/// Resources are copied in their Common state, promoted and decayed implicitly by the queues : no barrier.
+	/// Not thread safe, resources are loaded from the main thread.
+	/// </summary>
+	class UploadManager
+	{
+	public:
+		struct Stats
+		{
+			// Batches executed on the copy queue, and what they carried.
+			uint32_t Submissions = 0;
+			uint32_t BufferUploads = 0;
+			uint32_t TextureUploads = 0;
+			uint64_t UploadedBytes = 0;
+			// Staging memory used by the batches not done yet, alignment included, and the most used so far.
+			uint64_t StagingBytes = 0;
+			uint64_t PeakStagingBytes = 0;
+			// Times the ring was full and the CPU waited for the copy queue.
+			uint32_t StagingWaits = 0;
+			// Uploads larger than the ring, staged in a buffer of their own.
+			uint32_t DedicatedUploads = 0;
+			// GPU waits of the graphics queue on the copy queue.
+			uint32_t QueueWaits = 0;
+		};
+
+		UploadManager(RhiDevice& pDevice, uint64_t pStagingSize = 64 << 20);
+		/// <summary>
+		/// Submits the recorded uploads and waits for every batch.
+		/// </summary>
+		~UploadManager();
+
+		UploadManager(const UploadManager&) = delete;
+		UploadManager& operator=(const UploadManager&) = delete;
+
+		/// <returns> A default heap buffer, filled once GetPendingTicket() is done. </returns>
+		std::unique_ptr<RhiBuffer> CreateBuffer(const void* pData, uint64_t pSize);
+		/// <summary>
+		/// Copies pData to a default heap buffer. pData can be released right away.
+		/// </summary>
+		void UploadBuffer(const RhiBuffer& pDestination, uint64_t pOffset, const void* pData, uint64_t pSize);
+		/// <summary>
+		/// Copies every subresource of pDestination, in the order of RhiDevice::GetTextureFootprints. The data can
+		/// be released right away.
+		/// </summary>
+		void UploadTexture(const RhiTexture& pDestination, const RhiSubresourceData* pSubresources, uint32_t pCount);
+
+		/// <summary>
+		/// Executes the uploads recorded since the last call in one submission. Nothing happens without any.
+		/// </summary>
+		/// <returns> The ticket of the last submitted batch. </returns>
+		UploadTicket Submit();
+		/// <returns> The ticket of the uploads recorded so far, done once they are submitted and copied. </returns>
+		[[nodiscard]] UploadTicket GetPendingTicket() const { return m_LastSubmittedTicket + 1; }
+
+		[[nodiscard]] bool IsDone(UploadTicket pTicket) const;
+		/// <summary>
+		/// Blocks until pTicket is done, it is submitted first if needed.
+		/// </summary>
+		void Wait(UploadTicket pTicket);
+		/// <summary>
+		/// Makes pQueue wait on the GPU for the submitted batches, what it executes afterward can read their
+		/// resources. Nothing is waited for when they are already done.
+		/// </summary>
+		void MakeVisible(RhiCommandQueue& pQueue);
+		/// <summary>
+		/// Releases the staging memory of the batches done, also done when the ring is full.
+		/// </summary>
+		void Retire();
+
+		[[nodiscard]] const Stats& GetStats() const { return m_Stats; }
+		[[nodiscard]] uint64_t GetStagingSize() const { return m_StagingSize; }
+
+	private:
+		struct StagingAllocation
+		{
+			const RhiBuffer* Buffer;
+			uint64_t Offset;
+			uint8_t* CpuAddress;
+		};
+
+		struct Batch
+		{
+			UploadTicket Ticket;
+			// Ring position after the batch's last allocation, the ring is free up to there once it is done.
+			uint64_t End;
+			std::unique_ptr<RhiCommandAllocator> Allocator;
+			std::vector<std::unique_ptr<RhiBuffer>> DedicatedBuffers;
+		};
+
+		// Opens the current batch when it is the first upload since the last Submit().
+		void BeginBatch();
+		StagingAllocation Allocate(uint64_t pSize, uint64_t pAlignment);
+
+		RhiDevice& m_Device;
+		std::unique_ptr<RhiFence> m_Fence;
+		std::unique_ptr<RhiCommandList> m_CommandList;
+		std::vector<std::unique_ptr<RhiCommandAllocator>> m_FreeAllocators;
+
+		std::unique_ptr<RhiBuffer> m_Staging;
+		uint64_t m_StagingSize;
+		// Positions in the ring, increasing forever, modulo m_StagingSize in the buffer. The memory from m_Tail
+		// to m_Head is used by batches not done yet.
+		uint64_t m_Head = 0;
+		uint64_t m_Tail = 0;
+
+		// Submitted batches, oldest first.
+		std::deque<Batch> m_Batches;
+		Batch m_Current = {};
+		bool m_IsRecording = false;
+		UploadTicket m_LastSubmittedTicket = 0;
+		UploadTicket m_LastVisibleTicket = 0;
+
+		std::vector<RhiTextureFootprint> m_Footprints;
+		Stats m_Stats;
+	};
+}
@@ -0,0 +1,68 @@
+#include "UploadRing.h"
+
+#include <algorithm>
+
+namespace Engine
+{
+	UploadRing::UploadRing(RhiDevice& pDevice, const uint32_t pFrameCount, const uint64_t pPageSize)
+		: m_Device(pDevice), m_PageSize(RhiAlign(pPageSize, k_RhiConstantBufferAlignment)), m_Frames(pFrameCount)
+	{
+		for (FrameSlot& frame : m_Frames)
+			frame.Pages.push_back(m_Device.CreateBuffer({m_PageSize, RhiHeapType::Upload}));
+		m_Stats.CapacityBytes = m_PageSize * pFrameCount;
+		m_Stats.PageCount = pFrameCount;
+		m_CurrentFrame = &m_Frames[0];
+	}
+
+	void UploadRing::BeginFrame(const uint32_t pFrameIndex)
+	{
+		std::lock_guard lock(m_Mutex);
+
+		// Usage of the frame that was just recorded.
+		m_Stats.FrameBytes = m_CurrentFrame->FilledBytes + m_CurrentFrame->Offset;
+		m_Stats.FrameAllocations = m_CurrentFrame->AllocationCount;
+		m_Stats.PeakFrameBytes = (std::max)(m_Stats.PeakFrameBytes, m_Stats.FrameBytes);
+
+		m_CurrentFrame = &m_Frames[pFrameIndex];
+		m_CurrentFrame->CurrentPage = 0;
+		m_CurrentFrame->Offset = 0;
+		m_CurrentFrame->FilledBytes = 0;
+		m_CurrentFrame->AllocationCount = 0;
+	}
+
+	UploadAllocation UploadRing::Allocate(const uint64_t pSize, const uint64_t pAlignment)
+	{
+		std::lock_guard lock(m_Mutex);
+		FrameSlot& frame = *m_CurrentFrame;
+
+		uint64_t offset = RhiAlign(frame.Offset, pAlignment);
+		while (offset + pSize > frame.Pages[frame.CurrentPage]->GetDesc().Size)
+		{
+			// Moves to the next page, the rest of the current one is lost for this frame.
+			frame.FilledBytes += frame.Pages[frame.CurrentPage]->GetDesc().Size;
+			if (++frame.CurrentPage == frame.Pages.size())
+			{
+				const uint64_t size = (std::max)(m_PageSize, RhiAlign(pSize, k_RhiConstantBufferAlignment));
+				frame.Pages.push_back(m_Device.CreateBuffer({size, RhiHeapType::Upload}));
+				m_Stats.CapacityBytes += size;
+				++m_Stats.PageCount;
+			}
+			offset = 0;
+		}
+
+		frame.Offset = offset + pSize;
+		++frame.AllocationCount;
+
+		RhiBuffer* page = frame.Pages[frame.CurrentPage].get();
+		return {page, offset, pSize, page->GetMappedData() + offset, page->GetGpuAddress() + offset};
+	}
+
+	RhiGpuAddress UploadRing::PushConstants(const void* pData, const uint64_t pSize)
+	{
+		// Constant buffer views cover whole 256 byte blocks, the padding is part of the allocation.
+		const UploadAllocation allocation = Allocate(RhiAlign(pSize, k_RhiConstantBufferAlignment),
+		                                             k_RhiConstantBufferAlignment);
+		m_Device.WriteBuffer(*allocation.Buffer, allocation.Offset, pData, pSize);
+		return allocation.GpuAddress;
+	}
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "RHI/RhiDevice.h"
+
+namespace Engine
+{
+	/// <summary>
+	/// Block of upload memory handed out by an UploadRing, valid until the ring's frame slot is reused.
+	/// </summary>
+	struct UploadAllocation
+	{
+		RhiBuffer* Buffer = nullptr;
+		uint64_t Offset = 0;
+		uint64_t Size = 0;
+		// Persistently mapped, write only.
+		uint8_t* CpuAddress = nullptr;
+		RhiGpuAddress GpuAddress = 0;
+	};
+
+	/// <summary>
+	/// Linear allocator of per-frame upload memory (object constants, dynamic vertices / indices), with one
+	/// set of persistently mapped pages per frame in flight. Allocations are a bump of the current page's offset
+	/// and are all released at once when the frame slot comes back, so the GPU never reads memory the CPU is
+	/// writing. When a frame needs more than a page, another one is created and kept for the next frames.
+	/// </summary>
+	class UploadRing
+	{
+	public:
+		struct Stats
+		{
+			// Bytes allocated by the last completed frame, alignment padding included, and the most of any frame.
+			uint64_t FrameBytes = 0;
+			uint64_t PeakFrameBytes = 0;
+			uint32_t FrameAllocations = 0;
+			// Upload memory owned by the ring, over every frame slot.
+			uint64_t CapacityBytes = 0;
+			uint32_t PageCount = 0;
+		};
+
+		UploadRing(RhiDevice& pDevice, uint32_t pFrameCount, uint64_t pPageSize = 1 << 20);
+
+		UploadRing(const UploadRing&) = delete;
+		UploadRing& operator=(const UploadRing&) = delete;
+
+		/// <summary>
+		/// Releases the allocations of frame slot pFrameIndex. The GPU must be done with the last frame that
+		/// used it (see FramePacer::BeginFrame).
+		/// </summary>
+		void BeginFrame(uint32_t pFrameIndex);
+
+		/// <summary>
+		/// Thread safe.
+		/// </summary>
+		UploadAllocation Allocate(uint64_t pSize, uint64_t pAlignment = 16);
+
+		/// <returns> The address of a copy of pData, aligned to be bound as a root constant buffer. </returns>
+		RhiGpuAddress PushConstants(const void* pData, uint64_t pSize);
+
+		template <typename T>
+		RhiGpuAddress PushConstants(const T& pData)
+		{
+			return PushConstants(&pData, sizeof(T));
+		}
+
+		[[nodiscard]] const Stats& GetStats() const { return m_Stats; }
+		[[nodiscard]] uint64_t GetPageSize() const { return m_PageSize; }
+
+	private:
+		struct FrameSlot
+		{
+			std::vector<std::unique_ptr<RhiBuffer>> Pages;
+			size_t CurrentPage = 0;
+			uint64_t Offset = 0;
+			// Bytes of the pages already filled this frame.
+			uint64_t FilledBytes = 0;
+			uint32_t AllocationCount = 0;
+		};
+
+		RhiDevice& m_Device;
+		uint64_t m_PageSize;
+
+		std::mutex m_Mutex;
+		std::vector<FrameSlot> m_Frames;
+		FrameSlot* m_CurrentFrame = nullptr;
+		Stats m_Stats;
+	};
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <vector>
+#include <DirectXMath.h>
+
+#include "RHI/RhiTypes.h"
+
+namespace Engine
+{
+	struct Vertex
+	{
+	};
+
+	struct VertexColor : Vertex
+	{
+		DirectX::XMFLOAT3 Position;
+		DirectX::XMFLOAT4 Color{1, 1, 1, 1};
+
+		VertexColor(const DirectX::XMFLOAT3 pPosition)
+			: Vertex(), Position(pPosition)
+		{
+		}
+
+		VertexColor(const DirectX::XMFLOAT3 pPosition, const DirectX::XMFLOAT4 pColor)
+			: Vertex(), Position(pPosition), Color(pColor)
+		{
+		}
+
+		static std::vector<RhiInputElement> GetLayout()
+		{
+			return {
+				{"POSITION", 0, RhiFormat::R32G32B32Float, 0},
+				{"COLOR", 0, RhiFormat::R32G32B32A32Float, 12}
+			};
+		}
+	};
+
+	struct VertexTex : Vertex
+	{
+		DirectX::XMFLOAT3 Position;
+		DirectX::XMFLOAT2 TexCoord;
+
+		VertexTex(const DirectX::XMFLOAT3 pPosition, const DirectX::XMFLOAT2 pTexCoord)
+			: Vertex(), Position(pPosition), TexCoord(pTexCoord)
+		{
+		}
+
+		static std::vector<RhiInputElement> GetLayout()
+		{
+			return {
+				{"POSITION", 0, RhiFormat::R32G32B32Float, 0},
+				{"TEXCOORD", 0, RhiFormat::R32G32Float, 12}
+			};
+		}
+	};
+
+	struct VertexLit : Vertex
+	{
+		DirectX::XMFLOAT3 Position;
+		DirectX::XMFLOAT2 TexCoord;
+		DirectX::XMFLOAT3 Normal;
+
+		VertexLit(const DirectX::XMFLOAT3 pPosition, const DirectX::XMFLOAT2 pTexCoord, const DirectX::XMFLOAT3 pNormal)
+			: Vertex(), Position(pPosition), TexCoord(pTexCoord), Normal(pNormal)
+		{
+		}
+
+		static std::vector<RhiInputElement> GetLayout()
+		{
+			return {
+				{"POSITION", 0, RhiFormat::R32G32B32Float, 0},
+				{"TEXCOORD", 0, RhiFormat::R32G32Float, 12},
+				{"NORMAL", 0, RhiFormat::R32G32B32Float, 20}
+			};
+		}
+	};
+}
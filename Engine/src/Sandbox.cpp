@@ -1,28 +1,58 @@
 ﻿#include "Sandbox.h"
 
 #include "Core/ObjLoader.h"
+#include "Events/MouseEvent.h"
 #include "Renderer/DirectXApi.h"
 #include "Renderer/Materials/DirectXLitMaterial.h"
 #include "Renderer/Materials/DirectXSimpleMaterial.h"
 #include "Renderer/Materials/DirectXTextureMaterial.h"
+#include "Renderer/Culling/PvsBaker.h"
 #include "Renderer/Resource/DirectXResourceManager.h"
 #include "Renderer/Shaders/DirectXLitShader.h"
 #include "Renderer/Shaders/DirectXSimpleShader.h"
 #include "Renderer/Shaders/DirectXTextureShader.h"
 
-Sandbox::Sandbox(const Engine::ApplicationSpecification& pSpecification)
+Sandbox::Sandbox(const Engine::ApplicationSpecification& pSpecification, const uint32_t pStressSphereCount)
 	: Application(pSpecification)
 {
-	// Texture
-	Engine::Texture* stone = Engine::DirectXContext::Get()->GetResourceManager().LoadTexture(L"Textures\\stone.dds", "Stone");
-	Engine::Texture* bingus = Engine::DirectXContext::Get()->GetResourceManager().LoadTexture(L"Textures\\bingus.dds", "Bingus");
-	Engine::Texture* white = Engine::DirectXContext::Get()->GetResourceManager().LoadTexture(L"Textures\\white.dds", "White");
-	Engine::Texture* ground = Engine::DirectXContext::Get()->GetResourceManager().LoadTexture(L"Textures\\ground2.dds", "Ground");
+	// Texture (headless runs have no resource manager, materials are drawn untextured)
+	const auto loadTexture = [](const std::wstring& pPath, const std::string& pName) -> Engine::Texture*
+	{
+		if (Engine::DirectXContext::Get()->IsHeadless())
+			return nullptr;
+		return Engine::DirectXContext::Get()->GetResourceManager().LoadTexture(pPath, pName);
+	};
+	Engine::Texture* stone = loadTexture(L"Textures\\stone.dds", "Stone");
+	Engine::Texture* bingus = loadTexture(L"Textures\\bingus.dds", "Bingus");
+	Engine::Texture* white = loadTexture(L"Textures\\white.dds", "White");
+	Engine::Texture* ground = loadTexture(L"Textures\\ground2.dds", "Ground");
 
-	// Shaders
+	// Shaders, every variant is compiled ahead together on the job system rather than on its first draw
 	m_SimpleShader = std::make_unique<Engine::DirectXSimpleShader>(Engine::VertexColor::GetLayout(), L"Shaders\\Builtin.Color.hlsl");
 	m_TextureShader = std::make_unique<Engine::DirectXTextureShader>(Engine::VertexTex::GetLayout(), L"Shaders\\Builtin.Texture.hlsl");
 	m_LitShader = std::make_unique<Engine::DirectXLitShader>(Engine::VertexLit::GetLayout(), L"Shaders\\Builtin.Lit.hlsl");
+	const Engine::DirectXShader* shaders[] = {m_SimpleShader.get(), m_TextureShader.get(), m_LitShader.get()};
+	std::vector<Engine::ShaderCompileRequest> shaderRequests;
+	for (const Engine::DirectXShader* shader : shaders)
+	{
+		for (const Engine::ShaderVariantKey variant : shader->GetPermutations().GetAllKeys())
+		{
+			const std::vector<Engine::ShaderCompileRequest> stages = shader->GetCompileRequests(variant);
+			shaderRequests.insert(shaderRequests.end(), stages.begin(), stages.end());
+		}
+	}
+	Engine::DirectXContext::Get()->GetShaderCompiler().CompileAll(shaderRequests);
+	m_SimpleShader->CreateAllVariants();
+	m_TextureShader->CreateAllVariants();
+	m_LitShader->CreateAllVariants();
+	const auto& shaderStats = Engine::DirectXApi::GetShaderCompilerStats();
+	INFO("Shader compiler : %u requests, %u from disk, %u compiled, %u failed, %.2f ms compiling, %.2f ms total",
+	     shaderStats.Requests, shaderStats.DiskHits, shaderStats.Compiled, shaderStats.Failed,
+	     shaderStats.CompileMilliseconds, shaderStats.WallMilliseconds);
+	const auto& pipelineStats = Engine::DirectXApi::GetPipelineCacheStats();
+	INFO("Pipeline cache : %u requests, %u hits, %u from disk, %u compiled (%.0f%% hit rate), %.2f ms spent, %.2f ms saved",
+	     pipelineStats.Requests, pipelineStats.Hits, pipelineStats.DiskHits, pipelineStats.Misses,
+	     pipelineStats.GetHitRate() * 100.f, pipelineStats.CreateMilliseconds, pipelineStats.SavedMilliseconds);
 
 	// Materials
 	m_SimpleMaterial = std::make_unique<Engine::DirectXSimpleMaterial>(m_SimpleShader.get());
@@ -39,10 +69,13 @@ Sandbox::Sandbox(const Engine::ApplicationSpecification& pSpecification)
 	}
 
 	// Init mesh
+	// The OBJ meshes share one vertex and one index buffer, and draw with their base vertex and start index.
+	Engine::DirectXContext::Get()->EnableMeshPool(sizeof(Engine::VertexLit));
 	m_BingusMesh = Engine::DirectXMesh::CreateFromFile(".\\Objs\\bingus.obj");
 	m_BunnyMesh = Engine::DirectXMesh::CreateFromFile(".\\Objs\\bunnyex.obj");
 	m_FaceMesh = Engine::DirectXMesh::CreateFromFile(".\\Objs\\face.obj");
 	m_SphereMesh = Engine::DirectXMesh::CreateFromFile(".\\Objs\\sphere.obj");
+	m_CubeMesh = Engine::DirectXMesh::CreateFromFile(".\\Objs\\untitled.obj");
 
 	std::vector vertices3{
 		Engine::VertexTex{DirectX::XMFLOAT3{-.5f, .5f, 0}, DirectX::XMFLOAT2(0, 0)},
@@ -76,6 +109,32 @@ Sandbox::Sandbox(const Engine::ApplicationSpecification& pSpecification)
 		m_Spheres[i]->GetTransform()->SetScale(DirectX::XMFLOAT3(0.4f, 0.4f, 0.4f));
 	}
 
+	// Every sphere shares the mesh and the white texture, whatever its material : one instanced draw.
+	const uint32_t stressColumns = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<float>(pStressSphereCount))));
+	for (uint32_t i = 0; i < pStressSphereCount; i++)
+	{
+		const DirectX::XMFLOAT3 position(static_cast<float>(i % stressColumns) - stressColumns / 2.f, 0.5f,
+		                                 30.f + static_cast<float>(i / stressColumns));
+		m_StressSpheres.push_back(std::make_unique<Engine::Object>(position, m_SphereMesh.get(), m_LitMaterials[i % 10].get()));
+		m_StressSpheres.back()->GetTransform()->SetScale(DirectX::XMFLOAT3(0.4f, 0.4f, 0.4f));
+	}
+
+	CreateLevel();
+	BakeLevelVisibility();
+
+	m_Objects = {m_BingusObject.get(), m_BunnyObject.get(), m_BunnyObject2.get(), m_Ground.get()};
+	for (const auto& sphere : m_Spheres)
+		m_Objects.push_back(sphere.get());
+	for (const auto& object : m_LevelObjects)
+		m_Objects.push_back(object.get());
+	for (const auto& sphere : m_StressSpheres)
+		m_Objects.push_back(sphere.get());
+
+	// Big meshes hide what is behind them, the ground hides what is below.
+	Engine::DirectXApi::AddOccluder(m_Ground.get());
+	Engine::DirectXApi::AddOccluder(m_BunnyObject.get());
+	Engine::DirectXApi::AddOccluder(m_BunnyObject2.get());
+
 	m_Timer = 0;
 }
 
@@ -87,23 +146,252 @@ void Sandbox::Update(const Engine::Timestep pDeltaTime)
 	m_BingusObject->GetTransform()->SetRotation(DirectX::XMFLOAT3(std::sin(m_Timer * 5) / 2, 90, 0));
 	m_BunnyObject->GetTransform()->Rotate(pDeltaTime.GetSeconds(), 0, 0);
 	m_BunnyObject2->GetTransform()->Rotate(pDeltaTime.GetSeconds(), 0, 0);
+
+	m_StatsTimer += pDeltaTime.GetSeconds();
+	if (m_StatsTimer >= 5.f)
+	{
+		const auto stats = Engine::DirectXApi::GetOcclusionStats();
+		INFO("Occlusion culling : %u/%u draws culled (%.1f%%), %u occluder triangles", stats.Culled, stats.Tested,
+		     stats.GetCulledPercent(), stats.OccluderTriangles);
+		const auto& uploadStats = Engine::DirectXApi::GetUploadStats();
+		INFO("Upload ring : %llu bytes in %u allocations last frame, peak %llu bytes, %u pages (%llu bytes)",
+		     uploadStats.FrameBytes, uploadStats.FrameAllocations, uploadStats.PeakFrameBytes,
+		     uploadStats.PageCount, uploadStats.CapacityBytes);
+		const auto& copyStats = Engine::DirectXApi::GetUploadManagerStats();
+		INFO("Upload manager : %u buffers and %u textures (%llu bytes) in %u copy submissions, staging peak %llu bytes, "
+		     "%u staging waits, %u GPU waits", copyStats.BufferUploads, copyStats.TextureUploads,
+		     copyStats.UploadedBytes, copyStats.Submissions, copyStats.PeakStagingBytes, copyStats.StagingWaits,
+		     copyStats.QueueWaits);
+		const auto memoryStats = Engine::DirectXApi::GetMemoryStats().GetTotal();
+		INFO("GPU memory : %u heaps (%llu bytes) %.0f%% used, %.0f%% fragmented, %u dedicated allocations (%llu bytes)",
+		     memoryStats.HeapCount, memoryStats.HeapBytes, memoryStats.GetOccupancy() * 100.0f,
+		     memoryStats.GetFragmentation() * 100.0f, memoryStats.DedicatedCount, memoryStats.DedicatedBytes);
+		if (const Engine::MeshPool* meshPool = Engine::DirectXContext::Get()->GetMeshPool(sizeof(Engine::VertexLit)))
+		{
+			const auto poolStats = meshPool->GetStats();
+			INFO("Mesh pool : %u meshes, %u/%u vertices and %u/%u indices used, %u compactions, %u meshes did not fit",
+			     poolStats.MeshCount, poolStats.UsedVertices, poolStats.VertexCapacity, poolStats.UsedIndices,
+			     poolStats.IndexCapacity, poolStats.Compactions, poolStats.FailedAllocations);
+		}
+		const auto& tableStats = Engine::DirectXApi::GetObjectTableStats();
+		INFO("Object table : %u objects, %u updated in %u ranges (%llu bytes) last frame, %llu bytes on the GPU",
+		     tableStats.ObjectCount, tableStats.UpdatedObjects, tableStats.RangeCount, tableStats.UploadedBytes,
+		     tableStats.CapacityBytes);
+		const auto& materialStats = Engine::DirectXApi::GetMaterialTableStats();
+		INFO("Material table : %u materials, %u updated in %u ranges (%llu bytes) last frame",
+		     materialStats.MaterialCount, materialStats.UpdatedMaterials, materialStats.RangeCount,
+		     materialStats.UploadedBytes);
+		const auto& queueStats = Engine::DirectXApi::GetDrawQueueStats();
+		INFO("Draw queue : %u draws issued as %u draw calls in %u command lists last frame",
+		     queueStats.SubmittedDraws, queueStats.DrawCalls, queueStats.ListCount);
+		INFO("Pass constants : %u bytes uploaded last frame, %zu bytes with every light",
+		     Engine::DirectXApi::GetPassConstantsUploadBytes(), sizeof(Engine::PassConstants));
+		const auto filterStats = Engine::DirectXApi::GetStateFilteringStats();
+		INFO("State filtering : %llu state changes issued, %llu redundant ones dropped last frame",
+		     filterStats.GetIssuedCount(), filterStats.GetFilteredCount());
+		const auto& graphStats = Engine::DirectXApi::GetRenderGraphStats();
+		INFO("Render graph : %u/%u passes culled, %u barriers in %u batches, %u transients in %llu bytes "
+		     "(%llu saved by aliasing)", graphStats.CulledPasses, graphStats.PassCount, graphStats.BarrierCount,
+		     graphStats.BarrierBatchCount, graphStats.TransientCount, graphStats.HeapBytes,
+		     graphStats.GetAliasingSavings());
+		if (m_IsGpuCulled)
+		{
+			const auto& cullStats = m_GpuCuller.GetStats();
+			INFO("GPU culling : %u candidates in %u groups, %u objects drawn apart, %u uploads, %llu bytes on the GPU",
+			     cullStats.Candidates, cullStats.Groups, cullStats.Rejected, cullStats.Uploads, cullStats.GpuBytes);
+		}
+		m_StatsTimer = 0;
+	}
 }
 
 void Sandbox::Draw()
 {
 	Application::Draw();
-	
-	m_BingusObject->Render();
-	m_BunnyObject->Render();
-	m_BunnyObject2->Render();
-	m_Ground->Render();
-	for (size_t i = 0; i < 10; i++)
+
+	// The Objects drawn one by one this frame, the level's ones out of the camera cell's set are left out before
+	// they are culled, and only what survives culling gets a lod.
+	m_DrawnObjects = {m_BingusObject.get(), m_BunnyObject.get(), m_BunnyObject2.get()};
+	if (m_IsStaticBatched)
+	{
+		m_StaticBatcher.Render();
+		m_DrawnObjects.insert(m_DrawnObjects.end(), m_UnbatchedObjects.begin(), m_UnbatchedObjects.end());
+	}
+	else if (m_IsGpuCulled)
+	{
+		m_GpuCuller.Render();
+		m_DrawnObjects.insert(m_DrawnObjects.end(), m_GpuCulledRest.begin(), m_GpuCulledRest.end());
+	}
+	else
+	{
+		m_DrawnObjects.push_back(m_Ground.get());
+		for (const auto& sphere : m_Spheres)
+			m_DrawnObjects.push_back(sphere.get());
+		for (const auto& sphere : m_StressSpheres)
+			m_DrawnObjects.push_back(sphere.get());
+
+		const uint32_t cell = m_LevelPvs.GetCellIndex(Engine::DirectXApi::GetCameraPosition());
+		for (uint32_t i = 0; i < m_LevelObjects.size(); i++)
+		{
+			if (m_LevelPvs.IsVisible(cell, i))
+				m_DrawnObjects.push_back(m_LevelObjects[i].get());
+		}
+	}
+
+	Engine::Object::CullAndSelectLods(m_DrawnObjects.data(), m_DrawnObjects.size());
+	for (Engine::Object* object : m_DrawnObjects)
+		object->Render();
+}
+
+void Sandbox::CreateLevel()
+{
+	// 3x3 rooms of 6x6 behind the spheres, each wall has a door in its middle and each room holds a sphere.
+	constexpr int roomCount = 3;
+	constexpr float roomSize = 6.f;
+	constexpr float wallHeight = 1.f;
+	const DirectX::XMFLOAT3 origin(-roomCount * roomSize / 2, -0.4f, 7.f);
+
+	const auto addObject = [this](Engine::DirectXMesh* pMesh, Engine::DirectXMaterial* pMaterial,
+	                              const DirectX::XMFLOAT3& pPosition, const DirectX::XMFLOAT3& pScale)
+	{
+		m_LevelObjects.push_back(std::make_unique<Engine::Object>(pPosition, pMesh, pMaterial));
+		m_LevelObjects.back()->GetTransform()->SetScale(pScale);
+	};
+
+	// The cube mesh spans [-1, 1], a wall piece covers a third of the side on each side of the door.
+	// Walls sink under the ground so no baking ray slips below them.
+	const float piece = roomSize / 3;
+	const float wallY = origin.y + wallHeight - 0.2f;
+	for (int line = 0; line <= roomCount; line++)
 	{
-		m_Spheres[i]->Render();
+		for (int room = 0; room < roomCount; room++)
+		{
+			const float along = room * roomSize;
+			const float across = line * roomSize;
+			for (const float offset : {piece / 2, roomSize - piece / 2})
+			{
+				addObject(m_CubeMesh.get(), m_StoneMaterial.get(),
+				          DirectX::XMFLOAT3(origin.x + along + offset, wallY, origin.z + across),
+				          DirectX::XMFLOAT3(piece / 2, wallHeight, 0.1f));
+				addObject(m_CubeMesh.get(), m_StoneMaterial.get(),
+				          DirectX::XMFLOAT3(origin.x + across, wallY, origin.z + along + offset),
+				          DirectX::XMFLOAT3(0.1f, wallHeight, piece / 2));
+			}
+		}
 	}
+
+	for (int row = 0; row < roomCount; row++)
+	{
+		for (int column = 0; column < roomCount; column++)
+		{
+			addObject(m_SphereMesh.get(), m_LitMaterials[(row * roomCount + column) % 10].get(),
+			          DirectX::XMFLOAT3(origin.x + (column + 0.3f) * roomSize, origin.y + 0.4f,
+			                            origin.z + (row + 0.7f) * roomSize),
+			          DirectX::XMFLOAT3(0.4f, 0.4f, 0.4f));
+		}
+	}
+}
+
+void Sandbox::BakeLevelVisibility()
+{
+	Engine::PvsBaker baker;
+	DirectX::BoundingBox volume;
+	for (size_t i = 0; i < m_LevelObjects.size(); i++)
+	{
+		const DirectX::BoundingBox bounds = m_LevelObjects[i]->GetWorldBounds();
+		baker.AddObject(bounds, &m_LevelObjects[i]->GetMesh()->GetBvh(), *m_LevelObjects[i]->GetTransform());
+		if (i == 0)
+			volume = bounds;
+		else
+			DirectX::BoundingBox::CreateMerged(volume, volume, bounds);
+	}
+
+	// Baked again as soon as a level object moved or changed mesh.
+	const char* path = "LevelPvs.bin";
+	if (m_LevelPvs.Load(path) && m_LevelPvs.GetSceneHash() == baker.ComputeSceneHash())
+		return;
+
+	baker.Bake(volume, m_LevelPvs);
+
+	const auto& stats = baker.GetStats();
+	INFO("Baked level visibility : %u cells, %llu rays in %.2fs on %u threads (%.1f Mrays/s), %zu bytes",
+	     stats.CellCount, stats.RayCount, stats.Seconds, stats.ThreadCount, stats.GetRaysPerSecond() / 1e6,
+	     m_LevelPvs.GetCompressedSize());
+	m_LevelPvs.Save(path);
+}
+
+void Sandbox::EnableStaticBatching()
+{
+	std::vector<Engine::Object*> staticObjects = {m_Ground.get()};
+	for (const auto& sphere : m_Spheres)
+		staticObjects.push_back(sphere.get());
+	for (const auto& object : m_LevelObjects)
+		staticObjects.push_back(object.get());
+	for (const auto& sphere : m_StressSpheres)
+		staticObjects.push_back(sphere.get());
+
+	m_UnbatchedObjects = m_StaticBatcher.Build<Engine::VertexLit>(staticObjects.data(), staticObjects.size());
+	m_IsStaticBatched = true;
+
+	const auto& stats = m_StaticBatcher.GetStats();
+	INFO("Static batching : %u objects merged in %u batches (%u with 32 bits indices), %.0f%% fewer draws, "
+	     "%llu bytes of meshes became %llu (x%.1f), %.2f ms on %u threads", stats.SourceObjects, stats.Batches,
+	     stats.Batches32BitIndices, stats.GetDrawCallReduction() * 100.f, stats.SourceBytes, stats.BatchBytes,
+	     stats.GetMemoryGrowth(), stats.Seconds * 1000.0, stats.ThreadCount);
+}
+
+void Sandbox::EnableGpuCulling()
+{
+	if (m_IsStaticBatched)
+		return;
+
+	std::vector<Engine::Object*> staticObjects = {m_Ground.get()};
+	for (const auto& sphere : m_Spheres)
+		staticObjects.push_back(sphere.get());
+	for (const auto& object : m_LevelObjects)
+		staticObjects.push_back(object.get());
+	for (const auto& sphere : m_StressSpheres)
+		staticObjects.push_back(sphere.get());
+
+	m_GpuCulledRest = m_GpuCuller.SetObjects(staticObjects.data(), staticObjects.size());
+	m_IsGpuCulled = true;
+}
+
+void Sandbox::LogShaderReport() const
+{
+	const Engine::DirectXShader* shaders[] = {m_SimpleShader.get(), m_TextureShader.get(), m_LitShader.get()};
+	for (const Engine::DirectXShader* shader : shaders)
+	{
+		const Engine::ShaderPermutations& permutations = shader->GetPermutations();
+		const std::vector<Engine::ShaderVariantKey> variants = shader->GetCreatedVariants();
+		INFO("Shader '%s' : %zu features, %u permutations, %zu created", shader->GetShaderPath().string().c_str(),
+		     permutations.GetFeatures().size(), permutations.GetVariantCount(), variants.size());
+		for (const Engine::ShaderVariantKey variant : variants)
+			INFO("    variant %u : %s", variant, permutations.ToString(variant).c_str());
+	}
+
+	const Engine::ShaderCompiler& compiler = Engine::DirectXContext::Get()->GetShaderCompiler();
+	const Engine::ShaderCompiler::DiskFootprint footprint = compiler.GetDiskFootprint();
+	INFO("Shader cache : %llu bytes of bytecode in memory, %u files and %llu bytes on disk",
+	     compiler.GetStats().BytecodeBytes, footprint.FileCount, footprint.Bytes);
 }
 
 void Sandbox::OnEvent(Engine::Event& pEvent)
 {
 	Application::OnEvent(pEvent);
+
+	Engine::EventDispatcher dispatcher(pEvent);
+	dispatcher.Dispatch<Engine::MouseButtonPressedEvent>([this](const Engine::MouseButtonPressedEvent& pButtonEvent)
+	{
+		// Right click (MK_RBUTTON)
+		if (pButtonEvent.GetMouseButton() != Engine::Mouse::Button2)
+			return false;
+
+		Engine::RayHit hit;
+		const Engine::Object* picked = Engine::Object::Pick(m_Objects.data(), m_Objects.size(),
+		                                                    Engine::DirectXApi::GetCameraWorldPosition(),
+		                                                    Engine::DirectXApi::GetCameraMouseRay(), &hit);
+		if (picked)
+			INFO("Picked object %p (triangle %u at distance %.2f)", picked, hit.TriangleIndex, hit.T);
+		return true;
+	});
 }
@@ -1,10 +1,32 @@
 ﻿#pragma once
 #include "Core/Application.h"
+#include "Renderer/StaticBatcher.h"
+#include "Renderer/Culling/GpuCuller.h"
+#include "Renderer/Culling/PotentiallyVisibleSet.h"
 
 class Sandbox : public Engine::Application
 {
 public:
-	Sandbox(const Engine::ApplicationSpecification& pSpecification);
+	/// <param name="pSpecification"></param>
+	/// <param name="pStressSphereCount"> : extra spheres laid out in a grid behind the level, to stress the renderer</param>
+	Sandbox(const Engine::ApplicationSpecification& pSpecification, uint32_t pStressSphereCount = 0);
+
+	/// <summary>
+	/// Logs every shader's permutations, the variants created so far and the shader cache's size.
+	/// </summary>
+	void LogShaderReport() const;
+
+	/// <summary>
+	/// Merges the objects that never move (ground, spheres, level, stress spheres) per material and chunk,
+	/// they are drawn as the batches from now on, without the level's PVS.
+	/// </summary>
+	void EnableStaticBatching();
+
+	/// <summary>
+	/// Culls the objects that never move on the GPU and draws the visible ones with one ExecuteIndirect,
+	/// without the level's PVS. Ignored once static batching is enabled.
+	/// </summary>
+	void EnableGpuCulling();
 
 protected:
 	void Update(Engine::Timestep pDeltaTime) override;
@@ -12,6 +34,9 @@ protected:
 	void OnEvent(Engine::Event& pEvent) override;
 
 private:
+	void CreateLevel();
+	void BakeLevelVisibility();
+
     std::unique_ptr<Engine::DirectXSimpleShader> m_SimpleShader;
     std::unique_ptr<Engine::DirectXTextureShader> m_TextureShader;
     std::unique_ptr<Engine::DirectXLitShader> m_LitShader;
@@ -29,6 +54,7 @@ private:
     std::unique_ptr<Engine::DirectXMesh> m_BunnyMesh;
     std::unique_ptr<Engine::DirectXMesh> m_FaceMesh;
     std::unique_ptr<Engine::DirectXMesh> m_SphereMesh;
+    std::unique_ptr<Engine::DirectXMesh> m_CubeMesh;
     std::unique_ptr<Engine::DirectXMesh> m_Triangle1;
     std::unique_ptr<Engine::DirectXMesh> m_Triangle2;
 
@@ -37,6 +63,23 @@ private:
     std::unique_ptr<Engine::Object> m_BunnyObject2;
     std::unique_ptr<Engine::Object> m_Ground;
     std::unique_ptr<Engine::Object> m_Spheres[10];
+	std::vector<std::unique_ptr<Engine::Object>> m_StressSpheres;
+	// Static rooms behind the spheres, drawn through m_LevelPvs.
+	std::vector<std::unique_ptr<Engine::Object>> m_LevelObjects;
+	Engine::PotentiallyVisibleSet m_LevelPvs;
+	// Every object above, for picking.
+	std::vector<Engine::Object*> m_Objects;
+	// Rebuilt by Draw() every frame.
+	std::vector<Engine::Object*> m_DrawnObjects;
+	// Replaces the static objects once EnableStaticBatching() is called, with the ones it could not merge.
+	Engine::StaticBatcher m_StaticBatcher;
+	std::vector<Engine::Object*> m_UnbatchedObjects;
+	bool m_IsStaticBatched = false;
+	// Replaces the static objects once EnableGpuCulling() is called, with the ones it could not take.
+	Engine::GpuCuller m_GpuCuller;
+	std::vector<Engine::Object*> m_GpuCulledRest;
+	bool m_IsGpuCulled = false;
 
 	float m_Timer;
+	float m_StatsTimer = 0;
 };
\ No newline at end of file
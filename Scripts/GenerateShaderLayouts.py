@@ -0,0 +1,301 @@
+import os
+import re
+import sys
+
+# Generates the C++ mirrors of the shaders' constant buffers and structures in Engine/src/Renderer/Shaders/ShaderLayouts.h.
+# The offsets follow the HLSL packing rules, the header checks them with static_assert.
+#
+#   python GenerateShaderLayouts.py           Writes the header when it changed.
+#   python GenerateShaderLayouts.py --check   Fails when the header is out of date.
+
+ROOT = os.path.abspath(os.path.join(os.path.dirname(__file__), ".."))
+SHADER_DIRECTORY = os.path.join(ROOT, "Engine", "Shaders")
+OUTPUT_PATH = os.path.join(ROOT, "Engine", "src", "Renderer", "Shaders", "ShaderLayouts.h")
+
+# (shader, HLSL struct or cbuffer, C++ struct), a structure before the ones that use it.
+# The other shaders declaring the same name must declare a prefix of it.
+LAYOUTS = [
+    ("Builtin.Lit.hlsl", "DirectionalLight", "DirectionalLight"),
+    ("Builtin.Lit.hlsl", "cbPass", "PassConstants"),
+    ("Builtin.Lit.hlsl", "LitMaterialConstants", "LitMaterialConstants"),
+]
+
+REGISTER_SIZE = 16
+
+# HLSL component type -> C++ scalar and vector types.
+SCALARS = {
+    "float": "float",
+    "int": "int32_t",
+    "uint": "uint32_t",
+}
+VECTOR_TYPES = {
+    "float": "DirectX::XMFLOAT",
+    "int": "DirectX::XMINT",
+    "uint": "DirectX::XMUINT",
+}
+
+class LayoutError(Exception):
+    pass
+
+class Member:
+    def __init__(self, typeName, name, count):
+        self.Type = typeName
+        self.Name = name
+        # None when not an array.
+        self.Count = count
+        self.Offset = 0
+        self.Size = 0
+
+class Declaration:
+    def __init__(self, kind, name, members, path):
+        self.Kind = kind
+        self.Name = name
+        self.Members = members
+        self.Path = path
+
+def StripComments(source):
+    source = re.sub(r"/\*.*?\*/", "", source, flags=re.S)
+    source = re.sub(r"//[^\n]*", "", source)
+    # Preprocessor lines hold no declaration.
+    return re.sub(r"^[ \t]*#[^\n]*", "", source, flags=re.M)
+
+def ParseMembers(body, path, name):
+    members = []
+    for statement in body.split(";"):
+        statement = statement.strip()
+        if not statement:
+            continue
+        # Semantics and packoffset are dropped, interpolation modifiers skipped.
+        statement = statement.split(":")[0].strip()
+        match = re.fullmatch(r"(?:(?:nointerpolation|linear|centroid|noperspective|row_major|column_major)\s+)*"
+                             r"(\w+)\s+(\w+)\s*(?:\[\s*(\w+)\s*\])?", statement)
+        if not match:
+            raise LayoutError("%s : cannot parse '%s' in %s" % (path, statement, name))
+        count = match.group(3)
+        if count is not None:
+            if not count.isdigit():
+                raise LayoutError("%s : the size of %s.%s must be a literal" % (path, name, match.group(2)))
+            count = int(count)
+        members.append(Member(match.group(1), match.group(2), count))
+    return members
+
+def ParseShader(path):
+    fileName = os.path.basename(path)
+    with open(path, "r", encoding="utf-8-sig") as file:
+        source = StripComments(file.read())
+
+    declarations = {}
+    for match in re.finditer(r"\b(struct|cbuffer)\s+(\w+)\s*(?::\s*register\s*\([^)]*\))?\s*\{(.*?)\}", source, re.S):
+        kind, name, body = match.groups()
+        declarations[name] = Declaration(kind, name, ParseMembers(body, fileName, name), fileName)
+
+    structured = set(re.findall(r"\b(?:RW)?StructuredBuffer\s*<\s*(\w+)\s*>", source))
+    return declarations, structured
+
+def GetPackings(declarations, structured, name):
+    # A structure is packed as the buffers that reach it are : cbuffer or structured.
+    packings = set()
+    def Visit(declaration, packing, visited):
+        if declaration.Name == name:
+            packings.add(packing)
+        if declaration.Name in visited:
+            return
+        visited.add(declaration.Name)
+        for member in declaration.Members:
+            if member.Type in declarations:
+                Visit(declarations[member.Type], packing, visited)
+
+    for declaration in declarations.values():
+        if declaration.Kind == "cbuffer":
+            Visit(declaration, "cbuffer", set())
+    for root in structured:
+        if root in declarations:
+            Visit(declarations[root], "structured", set())
+    return packings
+
+def GetBasicSize(typeName, path):
+    # (size in bytes, starts a register in a cbuffer)
+    match = re.fullmatch(r"(float|int|uint)([1-4])?(?:x([1-4]))?", typeName)
+    if not match:
+        raise LayoutError("%s : type '%s' has no C++ mirror, use float, int, uint, their vectors or float4x4" % (path, typeName))
+    rows = int(match.group(2) or 1)
+    columns = match.group(3)
+    if columns is not None:
+        if typeName != "float4x4":
+            raise LayoutError("%s : only float4x4 matrices are supported, '%s' pads each column" % (path, typeName))
+        return 64, True
+    return 4 * rows, False
+
+def Round(value, alignment):
+    return (value + alignment - 1) // alignment * alignment
+
+def ComputeLayout(declaration, declarations, packing, cache):
+    # Returns the size in bytes, sets the members' offsets.
+    # cbuffer : a member does not straddle a 16 bytes register, structures, arrays and matrices start a register,
+    # the elements of an array are each padded to a register, the last one excepted.
+    # structured : members are tightly packed on 4 bytes.
+    key = (declaration.Name, packing)
+    if key in cache:
+        return cache[key]
+
+    offset = 0
+    for member in declaration.Members:
+        if member.Type in declarations:
+            elementSize = ComputeLayout(declarations[member.Type], declarations, packing, cache)
+            startsRegister = True
+        else:
+            elementSize, startsRegister = GetBasicSize(member.Type, declaration.Path)
+
+        if packing == "cbuffer":
+            stride = Round(elementSize, REGISTER_SIZE)
+            if member.Count is not None:
+                startsRegister = True
+            if startsRegister or offset % REGISTER_SIZE + elementSize > REGISTER_SIZE:
+                offset = Round(offset, REGISTER_SIZE)
+        else:
+            stride = elementSize
+
+        count = member.Count if member.Count is not None else 1
+        member.Offset = offset
+        member.Size = stride * (count - 1) + elementSize
+        offset += member.Size
+
+    cache[key] = offset
+    return offset
+
+def GetCppName(member, declaration):
+    # The cbuffer globals lose their "g" prefix.
+    if declaration.Kind == "cbuffer" and re.match(r"g[A-Z]", member.Name):
+        return member.Name[1:]
+    return member.Name
+
+def GetCppType(typeName, cppNames):
+    if typeName in cppNames:
+        return cppNames[typeName]
+    if typeName == "float4x4":
+        return "DirectX::XMFLOAT4X4"
+    match = re.fullmatch(r"(float|int|uint)([1-4])?", typeName)
+    if match.group(2) is None or match.group(2) == "1":
+        return SCALARS[match.group(1)]
+    return VECTOR_TYPES[match.group(1)] + match.group(2)
+
+def CheckPrefix(declaration, reference, path):
+    if len(declaration.Members) > len(reference.Members):
+        raise LayoutError("%s : %s has more members than in %s" % (path, declaration.Name, reference.Path))
+    for member, expected in zip(declaration.Members, reference.Members):
+        if (member.Type, member.Name, member.Count, member.Offset) != (expected.Type, expected.Name, expected.Count, expected.Offset):
+            raise LayoutError("%s : %s.%s differs from %s" % (path, declaration.Name, member.Name, reference.Path))
+
+def Generate():
+    shaders = {}
+    for fileName in sorted(os.listdir(SHADER_DIRECTORY)):
+        if fileName.endswith(".hlsl"):
+            shaders[fileName] = ParseShader(os.path.join(SHADER_DIRECTORY, fileName))
+
+    lines = []
+    cppNames = {}
+    for shader, name, cppName in LAYOUTS:
+        declarations, structured = shaders[shader]
+        if name not in declarations:
+            raise LayoutError("%s : %s is not declared" % (shader, name))
+        declaration = declarations[name]
+        packings = GetPackings(declarations, structured, name)
+        if len(packings) != 1:
+            raise LayoutError("%s : %s must be used by cbuffers or structured buffers only, not %s"
+                              % (shader, name, sorted(packings) or "none"))
+        packing = packings.pop()
+        size = ComputeLayout(declaration, declarations, packing, {})
+
+        # Every other declaration of the name, the smaller cbPass of the unlit shaders for instance.
+        for otherShader, (otherDeclarations, otherStructured) in shaders.items():
+            other = otherDeclarations.get(name)
+            if otherShader == shader or other is None:
+                continue
+            for otherPacking in GetPackings(otherDeclarations, otherStructured, name):
+                ComputeLayout(other, otherDeclarations, otherPacking, {})
+                CheckPrefix(other, declaration, otherShader)
+
+        # In a cbuffer, an array element or a structure is followed by the start of a register.
+        cppSize = Round(size, REGISTER_SIZE) if packing == "cbuffer" and declaration.Kind == "struct" else size
+        lines.append("\t// %s %s of %s, %s packing, %d bytes in HLSL." % (declaration.Kind, name, shader, packing, size))
+        lines.append("\tstruct %s" % cppName)
+        lines.append("\t{")
+        cppOffset = 0
+        paddingIndex = 0
+        checks = []
+        for member in declaration.Members:
+            if member.Offset < cppOffset:
+                raise LayoutError("%s : %s.%s is packed in the padding of the previous member, reorder the members"
+                                  % (shader, name, member.Name))
+            if member.Offset > cppOffset:
+                lines.append("\t\tuint32_t Padding%d[%d];" % (paddingIndex, (member.Offset - cppOffset) // 4))
+                paddingIndex += 1
+
+            memberName = GetCppName(member, declaration)
+            cppType = GetCppType(member.Type, cppNames)
+            if member.Type in declarations:
+                elementCppSize = Round(ComputeLayout(declarations[member.Type], declarations, packing, {}),
+                                       REGISTER_SIZE if packing == "cbuffer" else 4)
+            else:
+                elementCppSize = GetBasicSize(member.Type, shader)[0]
+            if member.Count is not None:
+                if packing == "cbuffer" and elementCppSize % REGISTER_SIZE != 0:
+                    raise LayoutError("%s : the elements of %s.%s are padded to 16 bytes, use a vector of 4 or a structure"
+                                      % (shader, name, member.Name))
+                lines.append("\t\t%s %s[%d];" % (cppType, memberName, member.Count))
+                cppOffset = member.Offset + elementCppSize * member.Count
+            else:
+                lines.append("\t\t%s %s;" % (cppType, memberName))
+                cppOffset = member.Offset + elementCppSize
+            checks.append("\tstatic_assert(offsetof(%s, %s) == %d);" % (cppName, memberName, member.Offset))
+
+        if cppSize > cppOffset:
+            lines.append("\t\tuint32_t Padding%d[%d];" % (paddingIndex, (cppSize - cppOffset) // 4))
+            cppOffset = cppSize
+        lines.append("\t};")
+        lines.append("")
+        lines.extend(checks)
+        lines.append("\tstatic_assert(sizeof(%s) == %d);" % (cppName, cppOffset))
+        lines.append("")
+        cppNames[name] = cppName
+
+    header = [
+        "#pragma once",
+        "// Generated by Scripts/GenerateShaderLayouts.py from Engine/Shaders, do not edit.",
+        "#include <cstddef>",
+        "#include <cstdint>",
+        "",
+        "#include <DirectXMath.h>",
+        "",
+        "namespace Engine",
+        "{",
+    ]
+    return "\n".join(header + lines[:-1] + ["}", ""])
+
+def Main():
+    try:
+        content = Generate()
+    except LayoutError as error:
+        print("GenerateShaderLayouts : %s" % error)
+        return 1
+
+    current = None
+    if os.path.exists(OUTPUT_PATH):
+        with open(OUTPUT_PATH, "r", encoding="utf-8") as file:
+            current = file.read()
+
+    if "--check" in sys.argv:
+        if current != content:
+            print("GenerateShaderLayouts : %s is out of date, run Scripts/GenerateShaderLayouts.py" % OUTPUT_PATH)
+            return 1
+        return 0
+
+    # Left untouched when up to date, what includes it is not rebuilt.
+    if current != content:
+        with open(OUTPUT_PATH, "w", encoding="utf-8", newline="\n") as file:
+            file.write(content)
+        print("Generated %s" % os.path.relpath(OUTPUT_PATH, ROOT))
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(Main())
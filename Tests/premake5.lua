@@ -0,0 +1,95 @@
+project "Tests"
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++20"
+	staticruntime "off"
+
+	targetdir ("%{wks.location}/bin/" .. outputdir .. "/%{prj.name}")
+	objdir ("%{wks.location}/bin-int/" .. outputdir .. "/%{prj.name}")
+
+	-- Only the engine code that runs without an OS window or D3D12 : the main loop is driven through the headless
+	-- window, the renderer through the null RHI.
+    files
+    {
+		"src/**.h",
+		"src/**.cpp",
+
+		"../Engine/src/Core/Clock.cpp",
+		"../Engine/src/Core/JobSystem.cpp",
+		"../Engine/src/Core/MeshBvh.cpp",
+		"../Engine/src/Core/ObjLoader.cpp",
+		"../Engine/src/Core/RadixSort.cpp",
+		"../Engine/src/Core/TlsfAllocator.cpp",
+		"../Engine/src/Core/Transform.cpp",
+		"../Engine/src/Debug/Log.cpp",
+		"../Engine/src/Platform/EventScript.cpp",
+		"../Engine/src/Platform/FilesSystem.cpp",
+		"../Engine/src/Platform/HeadlessWindow.cpp",
+		"../Engine/src/Platform/Input.cpp",
+		"../Engine/src/Renderer/CommandListPool.cpp",
+		"../Engine/src/Renderer/Culling/GpuCulling.cpp",
+		"../Engine/src/Renderer/Culling/LodSelector.cpp",
+		"../Engine/src/Renderer/Culling/OcclusionCuller.cpp",
+		"../Engine/src/Renderer/Culling/PotentiallyVisibleSet.cpp",
+		"../Engine/src/Renderer/Culling/PvsBaker.cpp",
+		"../Engine/src/Renderer/DrawQueue.cpp",
+		"../Engine/src/Renderer/FramePacer.cpp",
+		"../Engine/src/Renderer/GpuObjectTable.cpp",
+		"../Engine/src/Renderer/MeshMerger.cpp",
+		"../Engine/src/Renderer/MeshPool.cpp",
+		"../Engine/src/Renderer/PipelineCache.cpp",
+		"../Engine/src/Renderer/RHI/NullRhi.cpp",
+		"../Engine/src/Renderer/RHI/RhiDevice.cpp",
+		"../Engine/src/Renderer/RHI/RhiMemoryAllocator.cpp",
+		"../Engine/src/Renderer/RHI/StateFilteringCommandList.cpp",
+		"../Engine/src/Renderer/RenderGraph.cpp",
+		"../Engine/src/Renderer/Shaders/ShaderCompiler.cpp",
+		"../Engine/src/Renderer/Shaders/ShaderPermutations.cpp",
+		"../Engine/src/Renderer/UploadManager.cpp",
+		"../Engine/src/Renderer/UploadRing.cpp",
+    }
+
+    defines
+	{
+		"_CRT_SECURE_NO_WARNINGS"
+	}
+
+    includedirs
+    {
+        "src",
+        "../Engine/src",
+    }
+
+	flags { "NoPCH" }
+
+	-- Same instruction set as the engine.
+	vectorextensions "AVX2"
+
+	-- The benchmarks load the engine's meshes, Objs/... relative to the Engine folder.
+	debugdir "../Engine"
+
+    filter "system:windows"
+		systemversion "latest"
+
+	filter "system:linux"
+		-- DirectXMath is header only, DIRECTXMATH_DIR points at a checkout of github.com/microsoft/DirectXMath
+		-- with a sal.h (ex. the one of DirectX-Headers) next to it.
+		includedirs { os.getenv("DIRECTXMATH_DIR") and (os.getenv("DIRECTXMATH_DIR") .. "/Inc") or "/usr/include/directxmath" }
+		links { "pthread" }
+		-- MSVC's /arch:AVX2 includes FMA, which the occlusion rasterizer uses.
+		buildoptions { "-mfma" }
+
+    filter "configurations:Debug"
+		defines "_DEBUG"
+		runtime "Debug"
+		symbols "on"
+
+	filter "configurations:Release"
+		defines "_RELEASE"
+		runtime "Release"
+		optimize "on"
+
+	filter "configurations:Dist"
+		defines "_DIST"
+		runtime "Release"
+		optimize "on"
@@ -0,0 +1,247 @@
+#include "Test.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+#include "Core/MeshBvh.h"
+#include "Core/ObjLoader.h"
+
+namespace
+{
+	using DirectX::XMFLOAT3;
+
+	// Moller-Trumbore. pTolerance widens (or shrinks when negative) the triangle, in barycentric coordinates.
+	bool IntersectTriangle(const XMFLOAT3& pA, const XMFLOAT3& pB, const XMFLOAT3& pC, const Engine::Ray& pRay,
+	                       const float pTolerance, float& pT)
+	{
+		const XMFLOAT3& o = pRay.Origin;
+		const XMFLOAT3& d = pRay.Direction;
+		const XMFLOAT3 e1 = {pB.x - pA.x, pB.y - pA.y, pB.z - pA.z};
+		const XMFLOAT3 e2 = {pC.x - pA.x, pC.y - pA.y, pC.z - pA.z};
+
+		const float px = d.y * e2.z - d.z * e2.y;
+		const float py = d.z * e2.x - d.x * e2.z;
+		const float pz = d.x * e2.y - d.y * e2.x;
+		const float det = e1.x * px + e1.y * py + e1.z * pz;
+		const float invDet = 1.f / det;
+
+		const float tx = o.x - pA.x, ty = o.y - pA.y, tz = o.z - pA.z;
+		const float u = (tx * px + ty * py + tz * pz) * invDet;
+		const float qx = ty * e1.z - tz * e1.y;
+		const float qy = tz * e1.x - tx * e1.z;
+		const float qz = tx * e1.y - ty * e1.x;
+		const float v = (d.x * qx + d.y * qy + d.z * qz) * invDet;
+		pT = (e2.x * qx + e2.y * qy + e2.z * qz) * invDet;
+
+		return std::fabs(det) > 1e-7f && u >= -pTolerance && v >= -pTolerance && u + v <= 1.f + pTolerance &&
+			pT > 1e-7f && pT < pRay.TMax;
+	}
+
+	// The compiler may fuse the multiplies and adds of the brute force differently from the SIMD code, so the
+	// hits are compared with a tolerance : the traversal's triangle must be hit when slightly widened, and no
+	// triangle hit when slightly shrunk may be closer.
+	bool MatchesBruteForce(const std::vector<XMFLOAT3>& pPositions, const std::vector<uint32_t>& pIndices,
+	                       const Engine::Ray& pRay, const Engine::RayHit& pHit)
+	{
+		constexpr float tolerance = 1e-4f;
+		const auto getCorner = [&](const uint32_t pTriangle, const uint32_t pCorner) -> const XMFLOAT3&
+		{
+			return pPositions[pIndices[pTriangle * 3 + pCorner]];
+		};
+
+		float closest = pRay.TMax;
+		for (uint32_t triangle = 0; triangle < pIndices.size() / 3; ++triangle)
+		{
+			float t;
+			if (IntersectTriangle(getCorner(triangle, 0), getCorner(triangle, 1), getCorner(triangle, 2), pRay,
+			                      -tolerance, t))
+				closest = (std::min)(closest, t);
+		}
+
+		if (!pHit.HasHit())
+			return closest == pRay.TMax;
+
+		float t;
+		const uint32_t triangle = pHit.TriangleIndex;
+		return IntersectTriangle(getCorner(triangle, 0), getCorner(triangle, 1), getCorner(triangle, 2), pRay,
+		                         tolerance, t) && std::fabs(t - pHit.T) <= tolerance * t &&
+			pHit.T <= closest * (1.f + tolerance);
+	}
+
+	// Rays from random points around the box towards random points inside it.
+	std::vector<Engine::Ray> MakeRays(Tests::Random& pRandom, const uint32_t pCount, const float pExtent)
+	{
+		std::vector<Engine::Ray> rays(pCount);
+		for (Engine::Ray& ray : rays)
+		{
+			ray.Origin = {pRandom.Range(-2.f, 2.f) * pExtent, pRandom.Range(-2.f, 2.f) * pExtent, -2.f * pExtent};
+			const XMFLOAT3 target = {pRandom.Range(-1.f, 1.f) * pExtent, pRandom.Range(-1.f, 1.f) * pExtent, 0.f};
+			ray.Direction = {target.x - ray.Origin.x, target.y - ray.Origin.y, target.z - ray.Origin.z};
+			const float length = std::sqrt(ray.Direction.x * ray.Direction.x + ray.Direction.y * ray.Direction.y +
+				ray.Direction.z * ray.Direction.z);
+			ray.Direction = {ray.Direction.x / length, ray.Direction.y / length, ray.Direction.z / length};
+		}
+		return rays;
+	}
+
+	uint32_t CountMismatches(const Engine::MeshBvh& pBvh, const std::vector<XMFLOAT3>& pPositions,
+	                         const std::vector<uint32_t>& pIndices, const std::vector<Engine::Ray>& pRays,
+	                         uint32_t& pHitCount)
+	{
+		std::vector<Engine::RayHit> hits(pRays.size());
+		pHitCount = pBvh.Intersect(pRays.data(), hits.data(), static_cast<uint32_t>(pRays.size()));
+
+		uint32_t mismatches = 0;
+		for (size_t i = 0; i < pRays.size(); ++i)
+		{
+			if (!MatchesBruteForce(pPositions, pIndices, pRays[i], hits[i]))
+				++mismatches;
+		}
+		return mismatches;
+	}
+}
+
+TEST(MeshBvh_MatchesBruteForce)
+{
+	Tests::Random random(1);
+	std::vector<XMFLOAT3> positions;
+	std::vector<uint32_t> indices;
+	for (uint32_t triangle = 0; triangle < 3000; ++triangle)
+	{
+		const XMFLOAT3 center = {random.Range(-10.f, 10.f), random.Range(-10.f, 10.f), random.Range(-10.f, 10.f)};
+		for (int corner = 0; corner < 3; ++corner)
+		{
+			indices.push_back(static_cast<uint32_t>(positions.size()));
+			positions.push_back({
+				center.x + random.Range(-1.f, 1.f), center.y + random.Range(-1.f, 1.f), center.z + random.Range(-1.f, 1.f)
+			});
+		}
+	}
+
+	Engine::MeshBvh bvh;
+	bvh.Build(positions, indices);
+	CHECK(bvh.GetTriangleCount() == 3000);
+	CHECK(bvh.GetDepth() <= Engine::MeshBvh::k_MaxDepth);
+
+	// 4001 rays, the last packet is partial.
+	uint32_t hitCount = 0;
+	const std::vector<Engine::Ray> rays = MakeRays(random, 4001, 10.f);
+	CHECK(CountMismatches(bvh, positions, indices, rays, hitCount) == 0);
+	CHECK(hitCount > 1000);
+}
+
+TEST(MeshBvh_DepthIsCapped)
+{
+	// Three rows of triangles, along x, y and z, whose sizes and distances to the origin halve each time. A split
+	// only takes the farthest few off a row, the tree would be 79 levels deep without the cap.
+	std::vector<XMFLOAT3> positions;
+	std::vector<uint32_t> indices;
+	for (int axis = 0; axis < 3; ++axis)
+		for (int i = 0; i < 100; ++i)
+		{
+			const float distance = std::ldexp(1e17f, -i);
+			const float size = distance * 1e-3f;
+			XMFLOAT3 corner = {0.f, 0.f, 0.f};
+			(&corner.x)[axis] = distance;
+			const auto first = static_cast<uint32_t>(positions.size());
+			indices.insert(indices.end(), {first, first + 1, first + 2});
+			positions.push_back(corner);
+			positions.push_back({corner.x + size, corner.y + size, corner.z});
+			positions.push_back({corner.x, corner.y + size, corner.z + size});
+		}
+
+	Engine::MeshBvh bvh;
+	bvh.Build(positions, indices);
+	CHECK(bvh.GetDepth() == Engine::MeshBvh::k_MaxDepth);
+
+	// A ray at the middle of every triangle, along its normal, the ones in the capped leaves included.
+	std::vector<Engine::Ray> rays;
+	const float normal = 1.f / std::sqrt(3.f);
+	for (uint32_t triangle = 0; triangle < indices.size() / 3; ++triangle)
+	{
+		const XMFLOAT3& corner = positions[triangle * 3];
+		const float size = positions[triangle * 3 + 1].y - corner.y;
+		Engine::Ray ray;
+		ray.Origin = {
+			corner.x + size / 3.f + 2.f * size * normal, corner.y + size * 2.f / 3.f - 2.f * size * normal,
+			corner.z + size / 3.f + 2.f * size * normal
+		};
+		ray.Direction = {-normal, normal, -normal};
+		rays.push_back(ray);
+	}
+
+	uint32_t hitCount = 0;
+	CHECK(CountMismatches(bvh, positions, indices, rays, hitCount) == 0);
+	// The triangles smaller than about 1e-3 are under the intersection's determinant threshold.
+	CHECK(hitCount > 150);
+}
+
+BENCHMARK(MeshBvh_RaycastBunny)
+{
+	std::vector<Engine::VertexLit> vertices;
+	Engine::ObjLoader::LoadObj("Objs/bunnyex.obj", &vertices);
+	CHECK(!vertices.empty());
+	if (vertices.empty())
+		return;
+
+	std::vector<XMFLOAT3> positions;
+	std::vector<uint32_t> indices;
+	for (const Engine::VertexLit& vertex : vertices)
+	{
+		indices.push_back(static_cast<uint32_t>(positions.size()));
+		positions.push_back(vertex.Position);
+	}
+
+	Engine::MeshBvh bvh;
+	double start = Tests::GetTime();
+	bvh.Build(positions, indices);
+	const double buildTime = Tests::GetTime() - start;
+	std::printf("    %u triangles, %u nodes, depth %u, built in %.1f ms\n", bvh.GetTriangleCount(), bvh.GetNodeCount(),
+	            bvh.GetDepth(), buildTime * 1000.0);
+
+	// Primary rays of a 1024x1024 pinhole camera framing the mesh, each packet a 4x2 pixel tile.
+	constexpr uint32_t resolution = 1024;
+	const DirectX::BoundingBox& bounds = bvh.GetBounds();
+	const float extent = (std::max)({bounds.Extents.x, bounds.Extents.y, bounds.Extents.z});
+	const XMFLOAT3 eye = {bounds.Center.x, bounds.Center.y, bounds.Center.z - 3.f * extent};
+	std::vector<Engine::Ray> coherentRays;
+	coherentRays.reserve(resolution * resolution);
+	for (uint32_t y = 0; y < resolution; y += 2)
+		for (uint32_t x = 0; x < resolution; x += 4)
+			for (uint32_t pixel = 0; pixel < 8; ++pixel)
+			{
+				const float u = ((x + (pixel & 3)) + 0.5f) / resolution * 2.f - 1.f;
+				const float v = ((y + (pixel >> 2)) + 0.5f) / resolution * 2.f - 1.f;
+				Engine::Ray ray;
+				ray.Origin = eye;
+				const float length = std::sqrt(u * u * 0.16f + v * v * 0.16f + 1.f);
+				ray.Direction = {u * 0.4f / length, v * 0.4f / length, 1.f / length};
+				coherentRays.push_back(ray);
+			}
+
+	Tests::Random random(7);
+	std::vector<Engine::Ray> randomRays = MakeRays(random, resolution * resolution, extent);
+	for (Engine::Ray& ray : randomRays)
+	{
+		ray.Origin = {ray.Origin.x + bounds.Center.x, ray.Origin.y + bounds.Center.y, ray.Origin.z + bounds.Center.z};
+	}
+
+	std::vector<Engine::RayHit> hits(resolution * resolution);
+	for (const auto& [name, rays] : {std::make_pair("coherent", &coherentRays), std::make_pair("random", &randomRays)})
+	{
+		// Best of a few runs, the first one warms the caches up.
+		double best = 1e30;
+		uint32_t hitCount = 0;
+		for (int run = 0; run < 4; ++run)
+		{
+			start = Tests::GetTime();
+			hitCount = bvh.Intersect(rays->data(), hits.data(), static_cast<uint32_t>(rays->size()));
+			best = (std::min)(best, Tests::GetTime() - start);
+		}
+		std::printf("    %-8s : %zu rays, %u hits, %.1f ms, %.1f Mrays/s on one thread\n", name, rays->size(), hitCount,
+		            best * 1000.0, rays->size() / best / 1e6);
+	}
+}
@@ -0,0 +1,149 @@
+#include "Test.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <numeric>
+#include <vector>
+
+#include "Core/JobSystem.h"
+#include "Core/RadixSort.h"
+
+namespace
+{
+	// The DrawQueue key layout, DrawQueue itself needs D3D12 : shader (8) | material (16) | mesh (16) | depth (20).
+	uint64_t MakeDrawKey(const uint32_t pShader, const uint32_t pMaterial, const uint32_t pMesh, const float pDepth)
+	{
+		const uint64_t depth = std::bit_cast<uint32_t>(pDepth) >> (32 - 1 - 20);
+		return (static_cast<uint64_t>(pShader) << 52) | (static_cast<uint64_t>(pMaterial) << 36) |
+			(static_cast<uint64_t>(pMesh) << 20) | depth;
+	}
+
+	// A frame of opaque draws : 8 shaders, 500 materials, 200 meshes and random depths.
+	std::vector<uint64_t> MakeDrawKeys(Tests::Random& pRandom, const uint32_t pCount)
+	{
+		std::vector<uint64_t> keys(pCount);
+		for (uint64_t& key : keys)
+		{
+			const uint32_t material = pRandom.Next(500);
+			key = MakeDrawKey(material % 8, material, pRandom.Next(200), pRandom.Range(0.1f, 5000.f));
+		}
+		return keys;
+	}
+
+	std::vector<uint32_t> StableOrder(const std::vector<uint64_t>& pKeys)
+	{
+		std::vector<uint32_t> order(pKeys.size());
+		std::iota(order.begin(), order.end(), 0u);
+		std::stable_sort(order.begin(), order.end(), [&](const uint32_t pA, const uint32_t pB) { return pKeys[pA] < pKeys[pB]; });
+		return order;
+	}
+}
+
+// Keys of every shape : all equal, few distinct values, a single varying bit, the full 64 bits, and too many for
+// the index to be packed with them. The order is the one of std::stable_sort.
+TEST(RadixSort_MatchesStableSort)
+{
+	Engine::RadixSorter sorter;
+	Tests::Random random(9);
+
+	const auto check = [&](const std::vector<uint64_t>& pKeys)
+	{
+		std::vector<uint32_t> order(pKeys.size());
+		sorter.Sort(pKeys.data(), static_cast<uint32_t>(pKeys.size()), order.data());
+		CHECK(order == StableOrder(pKeys));
+	};
+
+	check({});
+	check({42});
+	check(std::vector<uint64_t>(1000, 0x123456789ull));
+	CHECK(sorter.GetStats().Passes == 0);
+
+	for (const uint32_t count : {100u, 5000u, 70000u})
+	{
+		std::vector<uint64_t> keys(count);
+		for (uint64_t& key : keys)
+			key = static_cast<uint64_t>(random.Next(4)) << 40;
+		check(keys);
+		CHECK(sorter.GetStats().KeyBits == 2);
+
+		for (uint64_t& key : keys)
+			key = static_cast<uint64_t>(random.Next(2)) << 63 | 0xF0;
+		check(keys);
+		CHECK(sorter.GetStats().KeyBits == 1);
+
+		for (uint64_t& key : keys)
+			key = static_cast<uint64_t>(random.Next()) << 32 | random.Next();
+		check(keys);
+		CHECK(sorter.GetStats().Passes == 8);
+
+		check(MakeDrawKeys(random, count));
+	}
+
+	// Fewer keys than the scratch buffers were sized for.
+	check(MakeDrawKeys(random, 10));
+	check(MakeDrawKeys(random, 2));
+}
+
+// Enough keys for several ranges : each pass moves keys from one range to another, the order must not depend on
+// the thread count. Draw keys have the index packed with them, full 64 bits keys do not.
+TEST(RadixSort_SortsInParallel)
+{
+	Tests::Random random(12);
+	const uint32_t count = 4 * Engine::RadixSorter::k_MinKeysPerJob + 17;
+	const std::vector<uint64_t> drawKeys = MakeDrawKeys(random, count);
+	std::vector<uint64_t> wideKeys(count);
+	for (uint64_t& key : wideKeys)
+		key = static_cast<uint64_t>(random.Next()) << 32 | random.Next();
+	const std::vector<uint32_t> drawOrder = StableOrder(drawKeys);
+	const std::vector<uint32_t> wideOrder = StableOrder(wideKeys);
+
+	for (const uint32_t threadCount : {1u, 2u, 3u, 4u})
+	{
+		Engine::JobSystem::Initialize(threadCount - 1);
+		Engine::RadixSorter sorter;
+		std::vector<uint32_t> order(count);
+		sorter.Sort(drawKeys.data(), count, order.data());
+		CHECK(order == drawOrder);
+		sorter.Sort(wideKeys.data(), count, order.data());
+		CHECK(order == wideOrder);
+		Engine::JobSystem::Shutdown();
+	}
+}
+
+// A frame of 1M draw packets, sorted as DrawQueue::Sort() does once the keys are built, on every thread.
+BENCHMARK(RadixSort_Sort1MDrawPackets)
+{
+	constexpr uint32_t count = 1000000;
+	Tests::Random random(10);
+	const std::vector<uint64_t> keys = MakeDrawKeys(random, count);
+	std::vector<uint32_t> order(count);
+
+	Engine::JobSystem::Initialize();
+	Engine::RadixSorter sorter;
+	sorter.Sort(keys.data(), count, order.data());
+	CHECK(order == StableOrder(keys));
+
+	constexpr uint32_t runs = 20;
+	double start = Tests::GetTime();
+	for (uint32_t run = 0; run < runs; ++run)
+		sorter.Sort(keys.data(), count, order.data());
+	const double radixTime = (Tests::GetTime() - start) / runs;
+
+	start = Tests::GetTime();
+	const std::vector<uint32_t> stableOrder = StableOrder(keys);
+	const double stableTime = Tests::GetTime() - start;
+
+	// The memory a pass has to move at best, for scale.
+	std::vector<uint64_t> copy(count);
+	start = Tests::GetTime();
+	for (uint32_t run = 0; run < runs; ++run)
+		std::copy(keys.begin(), keys.end(), copy.begin());
+	const double copyTime = (Tests::GetTime() - start) / runs;
+
+	const Engine::RadixSorter::Stats& stats = sorter.GetStats();
+	std::printf("    %u packets, %u key bits in %u passes on %u threads : %.2f ms, std::stable_sort %.2f ms, copying "
+	            "the keys once %.2f ms\n", count, stats.KeyBits, stats.Passes, Engine::JobSystem::GetThreadCount(),
+	            radixTime * 1000.0, stableTime * 1000.0, copyTime * 1000.0);
+	Engine::JobSystem::Shutdown();
+}
@@ -0,0 +1,219 @@
+#include "Test.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+#include "Core/TlsfAllocator.h"
+
+namespace
+{
+	/// <returns> True when pAllocation overlaps one of pLive, the allocations by offset. </returns>
+	bool Overlaps(const std::map<uint64_t, Engine::TlsfAllocation>& pLive, const Engine::TlsfAllocation& pAllocation)
+	{
+		const auto next = pLive.lower_bound(pAllocation.Offset);
+		if (next != pLive.end() && next->first < pAllocation.Offset + pAllocation.Size)
+			return true;
+		return next != pLive.begin() && std::prev(next)->second.Offset + std::prev(next)->second.Size > pAllocation.Offset;
+	}
+}
+
+// Random allocations and frees, of sizes from one granule to a few percent of the range and alignments up to
+// 4 MB, checked against a shadow of the live allocations.
+TEST(TlsfAllocator_MatchesAShadowOfTheAllocations)
+{
+	for (const uint64_t granularity : {256ull, 4096ull, 65536ull})
+	{
+		for (uint32_t seed = 0; seed < 20; ++seed)
+		{
+			Tests::Random random(seed);
+			const uint64_t capacity = granularity * (1000 + random.Next(5000));
+			Engine::TlsfAllocator allocator(capacity, granularity);
+
+			std::map<uint64_t, Engine::TlsfAllocation> live;
+			std::vector<uint64_t> liveOffsets;
+			uint64_t usedBytes = 0;
+			uint32_t failures = 0;
+			for (uint32_t i = 0; i < 20000; ++i)
+			{
+				if (liveOffsets.empty() || random.Next(100) < 55)
+				{
+					const uint64_t size = 1 + random.Next(static_cast<uint32_t>(granularity * (random.Next(4) ? 8 : 200)));
+					const uint64_t alignment = 1ull << random.Next(23);
+					Engine::TlsfAllocation allocation;
+					if (allocator.TryAllocate(size, alignment, allocation, reinterpret_cast<void*>(uintptr_t(i) + 1)))
+					{
+						CHECK(allocation.Offset % (std::max)(alignment, granularity) == 0);
+						CHECK(allocation.Size >= size && allocation.Size < size + granularity);
+						CHECK(allocation.Offset + allocation.Size <= capacity);
+						CHECK(!Overlaps(live, allocation));
+						live[allocation.Offset] = allocation;
+						liveOffsets.push_back(allocation.Offset);
+						usedBytes += allocation.Size;
+					}
+					else
+					{
+						++failures;
+						// Without an alignment to meet, a failure means that no free block is large enough.
+						if (alignment <= granularity)
+							CHECK(allocator.GetStats().LargestFreeBlock < (size + granularity - 1) / granularity * granularity);
+					}
+				}
+				else
+				{
+					const uint32_t index = random.Next(static_cast<uint32_t>(liveOffsets.size()));
+					const auto freed = live.find(liveOffsets[index]);
+					allocator.Free(freed->second);
+					usedBytes -= freed->second.Size;
+					live.erase(freed);
+					liveOffsets[index] = liveOffsets.back();
+					liveOffsets.pop_back();
+				}
+
+				if (i % 97 == 0)
+					CHECK(allocator.Validate());
+			}
+
+			const Engine::TlsfAllocator::Stats stats = allocator.GetStats();
+			CHECK(stats.UsedBytes == usedBytes);
+			CHECK(stats.AllocationCount == live.size());
+			CHECK(stats.UsedBytes + stats.FreeBytes == capacity);
+			CHECK(failures > 0);
+
+			// Listed in offset order with their user data.
+			std::vector<Engine::TlsfAllocation> allocations;
+			allocator.GetAllocations(allocations);
+			CHECK(allocations.size() == live.size());
+			auto expected = live.begin();
+			for (size_t i = 0; i < allocations.size() && expected != live.end(); ++i, ++expected)
+			{
+				CHECK(allocations[i].Offset == expected->second.Offset);
+				CHECK(allocations[i].Size == expected->second.Size);
+				CHECK(allocations[i].UserData == expected->second.UserData);
+			}
+
+			if (seed == 0)
+			{
+				std::printf("    granularity %llu : %zu live, %u failed allocations, %.1f%% used, fragmentation %.2f in %u "
+				            "free blocks\n", static_cast<unsigned long long>(granularity), live.size(), failures,
+				            100.0 * static_cast<double>(stats.UsedBytes) / static_cast<double>(capacity),
+				            stats.GetFragmentation(), stats.FreeBlockCount);
+			}
+
+			// Everything freed merges back into the whole range.
+			for (const auto& [offset, allocation] : live)
+				allocator.Free(allocation);
+			CHECK(allocator.Validate());
+			CHECK(allocator.IsEmpty());
+			CHECK(allocator.GetStats().FreeBlockCount == 1);
+			CHECK(allocator.GetStats().LargestFreeBlock == capacity);
+		}
+	}
+}
+
+// Every granule allocated, one in two freed then the rest in random order : the free blocks never merge while
+// separated and all merge at the end.
+TEST(TlsfAllocator_FillsAndMergesEveryBlock)
+{
+	constexpr uint64_t granularity = 256;
+	constexpr uint32_t blockCount = 50000;
+	Engine::TlsfAllocator allocator(granularity * blockCount, granularity);
+
+	std::vector<Engine::TlsfAllocation> allocations(blockCount);
+	for (Engine::TlsfAllocation& allocation : allocations)
+		CHECK(allocator.TryAllocate(1, 1, allocation));
+	Engine::TlsfAllocation full;
+	CHECK(!allocator.TryAllocate(1, 1, full));
+	CHECK(allocator.GetStats().FreeBlockCount == 0);
+
+	for (uint32_t i = 0; i < blockCount; i += 2)
+		allocator.Free(allocations[i]);
+	Engine::TlsfAllocator::Stats stats = allocator.GetStats();
+	CHECK(stats.FreeBlockCount == blockCount / 2);
+	CHECK(stats.LargestFreeBlock == granularity);
+	CHECK(stats.GetFragmentation() > 0.99f);
+	CHECK(allocator.Validate());
+	// Half of the range is free, not two granules in a row.
+	Engine::TlsfAllocation tooLarge;
+	CHECK(!allocator.TryAllocate(2 * granularity, 1, tooLarge));
+
+	Tests::Random random(11);
+	std::vector<uint32_t> order;
+	for (uint32_t i = 1; i < blockCount; i += 2)
+		order.push_back(i);
+	for (uint32_t i = static_cast<uint32_t>(order.size()); i > 1; --i)
+		std::swap(order[i - 1], order[random.Next(i)]);
+	for (const uint32_t index : order)
+		allocator.Free(allocations[index]);
+
+	stats = allocator.GetStats();
+	CHECK(allocator.Validate());
+	CHECK(stats.FreeBlockCount == 1);
+	CHECK(stats.GetFragmentation() == 0.0f);
+	Engine::TlsfAllocation whole;
+	CHECK(allocator.TryAllocate(granularity * blockCount, granularity, whole));
+	CHECK(whole.Offset == 0);
+
+	// Misuse is reported rather than corrupting the lists.
+	allocator.Free(whole);
+	bool threw = false;
+	try
+	{
+		allocator.Free(whole);
+	}
+	catch (const std::invalid_argument&)
+	{
+		threw = true;
+	}
+	CHECK(threw);
+	threw = false;
+	try
+	{
+		allocator.TryAllocate(granularity, 3 * granularity, whole);
+	}
+	catch (const std::invalid_argument&)
+	{
+		threw = true;
+	}
+	CHECK(threw);
+	CHECK(allocator.Validate());
+}
+
+// Steady state of a heap : about 10000 live allocations, one allocated for one freed.
+BENCHMARK(TlsfAllocator_AllocateFree)
+{
+	constexpr uint64_t granularity = 4096;
+	Engine::TlsfAllocator allocator(granularity * 1000000, granularity);
+	Tests::Random random(12);
+
+	std::vector<Engine::TlsfAllocation> live(10000);
+	for (Engine::TlsfAllocation& allocation : live)
+		CHECK(allocator.TryAllocate(granularity * (1 + random.Next(64)), granularity, allocation));
+
+	constexpr uint32_t operationCount = 1000000;
+	std::vector<uint32_t> sizes(operationCount);
+	std::vector<uint32_t> indices(operationCount);
+	for (uint32_t i = 0; i < operationCount; ++i)
+	{
+		sizes[i] = 1 + random.Next(64);
+		indices[i] = random.Next(static_cast<uint32_t>(live.size()));
+	}
+
+	uint32_t failures = 0;
+	const double start = Tests::GetTime();
+	for (uint32_t i = 0; i < operationCount; ++i)
+	{
+		allocator.Free(live[indices[i]]);
+		failures += !allocator.TryAllocate(granularity * sizes[i], granularity << (i & 3), live[indices[i]]);
+	}
+	const double time = Tests::GetTime() - start;
+	CHECK(failures == 0);
+	CHECK(allocator.Validate());
+
+	std::printf("    %u frees and allocations : %.1f ns per pair, fragmentation %.2f in %u free blocks\n", operationCount,
+	            time * 1e9 / operationCount, allocator.GetStats().GetFragmentation(), allocator.GetStats().FreeBlockCount);
+}
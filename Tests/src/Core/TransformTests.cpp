@@ -0,0 +1,124 @@
+#include "Test.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "Core/MeshBvh.h"
+#include "Core/Transform.h"
+
+namespace
+{
+	// 10 000 km, where a float keeps a 1 m precision.
+	constexpr double k_Far = 1e7;
+
+	Engine::WorldPosition RandomFarPosition(Tests::Random& pRandom, const float pRange)
+	{
+		return {
+			k_Far + pRandom.Range(-pRange, pRange), k_Far + pRandom.Range(-pRange, pRange),
+			k_Far + pRandom.Range(-pRange, pRange)
+		};
+	}
+}
+
+TEST(Transform_RelativeWorldErrorFarFromOrigin)
+{
+	Tests::Random random(1);
+	double maxRelativeError = 0.0;
+	double maxFloatError = 0.0;
+	for (uint32_t i = 0; i < 10000; ++i)
+	{
+		Engine::Transform transform;
+		transform.SetPosition(RandomFarPosition(random, 1000.f));
+		const Engine::WorldPosition origin = RandomFarPosition(random, 1000.f);
+
+		DirectX::XMFLOAT4X4 relative;
+		DirectX::XMStoreFloat4x4(&relative, transform.GetWorldRelativeTo(origin));
+		DirectX::XMFLOAT4X4 world;
+		DirectX::XMStoreFloat4x4(&world, transform.GetWorld());
+		const DirectX::XMFLOAT3 floatOrigin = origin.ToFloat3();
+
+		const Engine::WorldPosition& position = transform.GetWorldPosition();
+		const double expected[3] = {position.x - origin.x, position.y - origin.y, position.z - origin.z};
+		const float relativeTranslation[3] = {relative._41, relative._42, relative._43};
+		const float floatTranslation[3] = {world._41 - floatOrigin.x, world._42 - floatOrigin.y, world._43 - floatOrigin.z};
+		for (uint32_t axis = 0; axis < 3; ++axis)
+		{
+			// The double difference is exact, rounding it to float is at most half an ulp off.
+			const double error = std::fabs(relativeTranslation[axis] - expected[axis]);
+			CHECK(error <= std::ldexp(std::fabs(expected[axis]), -24));
+			maxRelativeError = (std::max)(maxRelativeError, error);
+			maxFloatError = (std::max)(maxFloatError, std::fabs(floatTranslation[axis] - expected[axis]));
+		}
+	}
+
+	std::printf("    Objects within 1 km of the camera, 1e7 m from the origin : %.3g m off relative to the camera, "
+	            "%.3g m off through the float world matrix\n", maxRelativeError, maxFloatError);
+	CHECK(maxRelativeError < 1e-4);
+	CHECK(maxFloatError > 0.25);
+}
+
+// The path of Object::Raycast : the ray is relative to its origin, the mesh is moved to it with
+// GetWorldRelativeTo(ray origin).
+TEST(Transform_RaycastFarFromOrigin)
+{
+	// A 1 cm square.
+	const std::vector<DirectX::XMFLOAT3> positions = {
+		{-0.005f, -0.005f, 0.f}, {0.005f, -0.005f, 0.f}, {0.005f, 0.005f, 0.f}, {-0.005f, 0.005f, 0.f}
+	};
+	const std::vector<uint32_t> indices = {0, 1, 2, 0, 2, 3};
+	Engine::MeshBvh bvh;
+	bvh.Build(positions, indices);
+
+	Tests::Random random(2);
+	constexpr uint32_t rayCount = 1000;
+	uint32_t hitCount = 0;
+	uint32_t floatHitCount = 0;
+	double maxError = 0.0;
+	for (uint32_t i = 0; i < rayCount; ++i)
+	{
+		Engine::Transform transform({0.f, 0.f, 0.f}, {random.Range(-0.5f, 0.5f), random.Range(-0.5f, 0.5f), 0.f});
+		transform.SetPosition(RandomFarPosition(random, 1.f));
+
+		// From about 2 m in front of the square to a point 4 mm around its centre, the hit is at T = 1.
+		const DirectX::XMFLOAT3 offset = {random.Range(-0.5f, 0.5f), random.Range(-0.5f, 0.5f), -2.f};
+		const Engine::WorldPosition& position = transform.GetWorldPosition();
+		const Engine::WorldPosition origin(position.x + offset.x, position.y + offset.y, position.z + offset.z);
+		const DirectX::XMVECTOR target = DirectX::XMVector3TransformNormal(
+			DirectX::XMVectorSet(random.Range(-0.004f, 0.004f), random.Range(-0.004f, 0.004f), 0.f, 0.f),
+			transform.GetWorldRelativeTo(position));
+
+		Engine::Ray ray;
+		DirectX::XMStoreFloat3(&ray.Direction, DirectX::XMVectorSubtract(target, DirectX::XMLoadFloat3(&offset)));
+		ray.TMax = 2.f;
+
+		const DirectX::XMMATRIX toLocal = DirectX::XMMatrixInverse(nullptr, transform.GetWorldRelativeTo(origin));
+		Engine::Ray localRay = ray;
+		DirectX::XMStoreFloat3(&localRay.Origin, DirectX::XMVector3TransformCoord(DirectX::XMVectorZero(), toLocal));
+		DirectX::XMStoreFloat3(&localRay.Direction,
+		                       DirectX::XMVector3TransformNormal(DirectX::XMLoadFloat3(&ray.Direction), toLocal));
+		Engine::RayHit hit;
+		if (bvh.Intersect(localRay, hit))
+		{
+			++hitCount;
+			maxError = (std::max)(maxError, std::fabs(hit.T - 1.0) * 2.0);
+		}
+
+		// The previous path, a float world space ray through the inverse of the float world matrix.
+		const DirectX::XMMATRIX floatToLocal = DirectX::XMMatrixInverse(nullptr, transform.GetWorld());
+		const DirectX::XMFLOAT3 floatOrigin = origin.ToFloat3();
+		DirectX::XMStoreFloat3(&localRay.Origin,
+		                       DirectX::XMVector3TransformCoord(DirectX::XMLoadFloat3(&floatOrigin), floatToLocal));
+		DirectX::XMStoreFloat3(&localRay.Direction,
+		                       DirectX::XMVector3TransformNormal(DirectX::XMLoadFloat3(&ray.Direction), floatToLocal));
+		if (bvh.Intersect(localRay, hit))
+			++floatHitCount;
+	}
+
+	std::printf("    1 cm square 1e7 m from the origin, 2 m away : %u of %u rays hit it (%.3g m off), "
+	            "%u through the float world matrix\n", hitCount, rayCount, maxError, floatHitCount);
+	CHECK(hitCount == rayCount);
+	CHECK(maxError < 1e-4);
+	CHECK(floatHitCount < rayCount / 10);
+}
@@ -0,0 +1,25 @@
+#include <cstring>
+
+namespace Tests
+{
+	int RunTests(bool pRunBenchmarks, const char* pFilter);
+}
+
+// Runs the engine's tests, without a window nor a GPU. Returns the number of failed tests.
+// Command line :
+//   --bench            runs the benchmarks instead, from the Engine folder since they load its meshes
+//   <filter>           only runs the tests or benchmarks whose name contains it
+int main(int pArgc, char** pArgv)
+{
+	bool runBenchmarks = false;
+	const char* filter = nullptr;
+	for (int i = 1; i < pArgc; ++i)
+	{
+		if (std::strcmp(pArgv[i], "--bench") == 0)
+			runBenchmarks = true;
+		else
+			filter = pArgv[i];
+	}
+
+	return Tests::RunTests(runBenchmarks, filter);
+}
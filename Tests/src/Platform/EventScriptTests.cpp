@@ -0,0 +1,76 @@
+#include "Test.h"
+
+#include "Platform/EventScript.h"
+
+// Every event kind with its arguments, comments and blank lines skipped, sorted by frame.
+TEST(EventScript_ParsesEveryEvent)
+{
+	Engine::EventScript script;
+	CHECK(script.Parse(
+		"# frame event arguments\n"
+		"\n"
+		"600 WindowClose\n"
+		"0   WindowResize 1920 1080\n"
+		"  10  KeyPressed 87\n"
+		"12  MouseMoved 640.5 360\n"
+		"13  MouseScrolled 0 -1\n"
+		"14  MouseButtonPressed 1\n"
+		"15  MouseButtonReleased 1\n"
+		"40  KeyReleased 87\n"));
+
+	const auto& events = script.GetEvents();
+	CHECK(events.size() == 8);
+	for (size_t i = 1; i < events.size(); ++i)
+		CHECK(events[i - 1].Frame <= events[i].Frame);
+
+	CHECK(events[0].Frame == 0 && events[0].Type == Engine::EventType::WindowResize);
+	CHECK(events[0].X == 1920.f && events[0].Y == 1080.f);
+	CHECK(events[1].Type == Engine::EventType::KeyPressed && events[1].Code == 87);
+	CHECK(events[2].Type == Engine::EventType::MouseMoved && events[2].X == 640.5f && events[2].Y == 360.f);
+	CHECK(events[3].Type == Engine::EventType::MouseScrolled && events[3].Y == -1.f);
+	CHECK(events[4].Type == Engine::EventType::MouseButtonPressed && events[4].Code == 1);
+	CHECK(events[5].Type == Engine::EventType::MouseButtonReleased && events[5].Code == 1);
+	CHECK(events[6].Frame == 40 && events[6].Type == Engine::EventType::KeyReleased);
+	CHECK(events[7].Frame == 600 && events[7].Type == Engine::EventType::WindowClose);
+}
+
+// Events of a same frame keep the order they were added in, whether parsed or added from code.
+TEST(EventScript_KeepsTheOrderWithinAFrame)
+{
+	Engine::EventScript script;
+	script.KeyPressed(5, 1);
+	script.Close(9);
+	script.KeyPressed(5, 2);
+	CHECK(script.Parse("5 KeyPressed 3\n0 KeyReleased 4"));
+	script.KeyPressed(5, 5);
+
+	const auto& events = script.GetEvents();
+	CHECK(events.size() == 6);
+	CHECK(events[0].Frame == 0 && events[0].Code == 4);
+	for (uint32_t i = 1; i <= 4; ++i)
+		CHECK(events[i].Frame == 5 && events[i].Code == (i < 4 ? i : 5));
+	CHECK(events[5].Type == Engine::EventType::WindowClose);
+}
+
+// Unknown events, missing arguments and missing frames fail the parse, the lines before the bad one are kept.
+TEST(EventScript_RejectsBadLines)
+{
+	const char* badLines[] = {
+		"10 KeyPresed 87",
+		"10 KeyPressed",
+		"10 MouseMoved 640",
+		"10 WindowResize x 1080",
+		"KeyPressed 87",
+		"-",
+	};
+	for (const char* badLine : badLines)
+	{
+		Engine::EventScript script;
+		CHECK(!script.Parse(std::string("1 KeyPressed 87\n") + badLine + "\n2 WindowClose"));
+		CHECK(script.GetEvents().size() == 1);
+	}
+
+	Engine::EventScript empty;
+	CHECK(empty.Parse("# nothing\n\n   \n"));
+	CHECK(empty.IsEmpty());
+}
@@ -0,0 +1,174 @@
+#include "Test.h"
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+#include "Core/Clock.h"
+#include "Core/KeyCodes.h"
+#include "Core/MouseCodes.h"
+#include "Events/ApplicationEvent.h"
+#include "Events/KeyEvent.h"
+#include "Events/MouseEvent.h"
+#include "Platform/HeadlessWindow.h"
+#include "Platform/Input.h"
+
+namespace
+{
+	struct ReceivedEvent
+	{
+		uint64_t Frame;
+		Engine::EventType Type;
+	};
+
+	/// <summary>
+	/// Main loop of Application::Run() without the renderer : ticks the clock, updates, then pumps the window
+	/// until a WindowClose event or the frame limit.
+	/// </summary>
+	class HeadlessLoop
+	{
+	public:
+		HeadlessLoop(Engine::EventScript pScript, uint64_t pFrameCount)
+			: m_Window(Engine::WindowProps{"Tests", 640, 480}, std::move(pScript)), m_FrameCount(pFrameCount)
+		{
+			m_Window.SetEventCallback([this](Engine::Event& pEvent) { OnEvent(pEvent); });
+		}
+
+		void Run()
+		{
+			while (m_IsRunning)
+			{
+				const Engine::Timestep deltaTime = m_Clock.Tick();
+				Update(deltaTime);
+
+				m_Window.Update();
+
+				m_FrameIndex++;
+				if (m_FrameCount != 0 && m_FrameIndex >= m_FrameCount)
+					m_IsRunning = false;
+			}
+		}
+
+		Engine::HeadlessWindow m_Window;
+		Engine::FixedStepClock m_Clock{0.25f};
+		std::vector<ReceivedEvent> m_Events;
+		// Input state polled in Update(), as gameplay code does.
+		std::vector<bool> m_WasWDown;
+		float m_TotalTime = 0.f;
+		uint64_t m_FrameIndex = 0;
+		uint64_t m_FrameCount;
+		bool m_IsRunning = true;
+
+	private:
+		void Update(Engine::Timestep pDeltaTime)
+		{
+			m_TotalTime += pDeltaTime.GetSeconds();
+			m_WasWDown.push_back(Engine::Input::IsKeyPressed(Engine::Key::W));
+		}
+
+		void OnEvent(Engine::Event& pEvent)
+		{
+			m_Events.push_back({m_Window.GetFrame(), pEvent.GetEventType()});
+
+			Engine::EventDispatcher dispatcher(pEvent);
+			dispatcher.Dispatch<Engine::WindowCloseEvent>([this](Engine::WindowCloseEvent&)
+			{
+				m_IsRunning = false;
+				return true;
+			});
+			// Pressing space clicks, as a UI reacting to input would.
+			dispatcher.Dispatch<Engine::KeyPressedEvent>([this](const Engine::KeyPressedEvent& pKeyEvent)
+			{
+				if (pKeyEvent.GetKeyCode() == Engine::Key::Space)
+					m_Window.Inject({0, Engine::EventType::MouseButtonPressed, Engine::Mouse::ButtonLeft});
+				return false;
+			});
+		}
+	};
+}
+
+// A scripted run : the events reach the loop on their frames, Input follows them, the fixed step clock makes
+// the time depend only on the frame count, and the scripted WindowClose ends the loop.
+TEST(HeadlessWindow_RunsAScriptedLoop)
+{
+	Engine::EventScript script;
+	CHECK(script.Parse(
+		"2 WindowResize 1920 1080\n"
+		"3 KeyPressed 87\n"
+		"3 MouseMoved 100 200\n"
+		"6 KeyReleased 87\n"
+		"8 KeyPressed 32\n"
+		"8 KeyReleased 32\n"
+		"10 WindowClose\n"
+		"20 KeyPressed 87\n"));
+
+	HeadlessLoop loop(script, 0);
+	CHECK(loop.m_Window.GetWidth() == 640 && loop.m_Window.GetHeight() == 480);
+	loop.Run();
+
+	// Closed after the window update of frame 10, the events of frame 20 are never sent.
+	CHECK(loop.m_FrameIndex == 11);
+	CHECK(!loop.m_Window.IsScriptDone());
+	CHECK(loop.m_TotalTime == 11 * 0.25f);
+	CHECK(loop.m_Clock.GetTime() == 11 * 0.25);
+
+	const ReceivedEvent expected[] = {
+		{2, Engine::EventType::WindowResize},
+		{3, Engine::EventType::KeyPressed},
+		{3, Engine::EventType::MouseMoved},
+		{6, Engine::EventType::KeyReleased},
+		{8, Engine::EventType::KeyPressed},
+		{8, Engine::EventType::KeyReleased},
+		// Injected by the space key press, sent by the same update after the events already queued.
+		{8, Engine::EventType::MouseButtonPressed},
+		{10, Engine::EventType::WindowClose},
+	};
+	CHECK(loop.m_Events.size() == std::size(expected));
+	for (size_t i = 0; i < (std::min)(loop.m_Events.size(), std::size(expected)); ++i)
+		CHECK(loop.m_Events[i].Frame == expected[i].Frame && loop.m_Events[i].Type == expected[i].Type);
+
+	// Update() of frame N sees the events sent by the window updates before it.
+	CHECK(loop.m_WasWDown.size() == 11);
+	for (uint64_t frame = 0; frame < loop.m_WasWDown.size(); ++frame)
+		CHECK(loop.m_WasWDown[frame] == (frame >= 4 && frame <= 6));
+
+	CHECK(loop.m_Window.GetWidth() == 1920 && loop.m_Window.GetHeight() == 1080);
+	CHECK(Engine::Input::GetMouseX() == 100.f && Engine::Input::GetMouseY() == 200.f);
+	CHECK(Engine::Input::IsMouseButtonPressed(Engine::Mouse::ButtonLeft));
+	CHECK(!Engine::Input::IsKeyPressed(Engine::Key::Space));
+
+	Engine::HeadlessWindow release(Engine::WindowProps{}, {});
+	release.Inject({0, Engine::EventType::MouseButtonReleased, Engine::Mouse::ButtonLeft});
+	release.Update();
+	CHECK(!Engine::Input::IsMouseButtonPressed(Engine::Mouse::ButtonLeft));
+}
+
+// Without a WindowClose the loop stops on the frame limit, and two runs of the same script see the same events.
+TEST(HeadlessWindow_ReplaysDeterministically)
+{
+	Tests::Random random(7);
+	Engine::EventScript script;
+	for (uint32_t i = 0; i < 200; ++i)
+	{
+		const uint64_t frame = random.Next(100);
+		if (random.Next(2) == 0)
+			script.KeyPressed(frame, static_cast<Engine::KeyCode>(Engine::Key::A + random.Next(26)));
+		else
+			script.MouseMoved(frame, static_cast<float>(random.Next(1920)), static_cast<float>(random.Next(1080)));
+	}
+
+	HeadlessLoop first(script, 120);
+	first.Run();
+	HeadlessLoop second(script, 120);
+	second.Run();
+
+	CHECK(first.m_FrameIndex == 120 && first.m_Window.IsScriptDone());
+	CHECK(first.m_Events.size() == 200 && second.m_Events.size() == 200);
+	for (size_t i = 0; i < (std::min)(first.m_Events.size(), second.m_Events.size()); ++i)
+	{
+		CHECK(first.m_Events[i].Frame == second.m_Events[i].Frame);
+		CHECK(first.m_Events[i].Type == second.m_Events[i].Type);
+		CHECK(first.m_Events[i].Frame == script.GetEvents()[i].Frame);
+	}
+	CHECK(first.m_TotalTime == second.m_TotalTime);
+}
@@ -0,0 +1,178 @@
+#include "Test.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "Core/JobSystem.h"
+#include "Renderer/CommandListPool.h"
+#include "Renderer/FramePacer.h"
+#include "Renderer/RHI/NullRhi.h"
+
+namespace
+{
+	constexpr uint32_t k_FrameCount = 3;
+
+	// Draw calls in sorted order : runs of the same pipeline, mesh and material, like the DrawQueue's.
+	struct DrawCall
+	{
+		const Engine::RhiPipeline* Pipeline;
+		Engine::RhiVertexBufferView VertexBuffer;
+		uint32_t Material;
+	};
+
+	std::vector<DrawCall> MakeDrawCalls(const std::vector<std::unique_ptr<Engine::RhiPipeline>>& pPipelines,
+	                                    const uint32_t pCount)
+	{
+		std::vector<DrawCall> drawCalls(pCount);
+		for (uint32_t i = 0; i < pCount; ++i)
+			drawCalls[i] = {pPipelines[i / 1000 % pPipelines.size()].get(), {0x10000ull * (1 + i / 300), 4096, 32}, i / 7};
+		return drawCalls;
+	}
+
+	void RecordDrawCalls(Engine::RhiCommandList& pList, const std::vector<DrawCall>& pDrawCalls, const uint32_t pFirst,
+	                     const uint32_t pLast)
+	{
+		for (uint32_t i = pFirst; i < pLast; ++i)
+		{
+			pList.SetPipeline(*pDrawCalls[i].Pipeline);
+			pList.SetVertexBuffer(pDrawCalls[i].VertexBuffer);
+			pList.SetGraphicsRoot32BitConstant(0, pDrawCalls[i].Material, 0);
+			pList.DrawIndexedInstanced(36, 1, 0, 0, i);
+		}
+	}
+
+	/// <summary>
+	/// Replays a list from an empty state, as the GPU starts every list.
+	/// </summary>
+	/// <returns> The number of draws that were not recorded with the state of their draw call, after a render target. </returns>
+	uint32_t CountWrongDraws(const Engine::NullRhiCommandList& pList, const std::vector<DrawCall>& pDrawCalls,
+	                         std::vector<uint32_t>& pDrawn)
+	{
+		const void* pipeline = nullptr;
+		uint64_t vertexBuffer = 0;
+		uint64_t material = UINT64_MAX;
+		bool hasTarget = false;
+		uint32_t wrongDraws = 0;
+		for (const Engine::NullRhiCommand& command : pList.GetCommands())
+		{
+			switch (command.Type)
+			{
+			case Engine::NullRhiCommandType::SetPipeline:
+				pipeline = command.Object;
+				material = UINT64_MAX;
+				break;
+			case Engine::NullRhiCommandType::SetPipelineState:
+				pipeline = command.Object;
+				break;
+			case Engine::NullRhiCommandType::SetVertexBuffer:
+				vertexBuffer = command.Args[0];
+				break;
+			case Engine::NullRhiCommandType::SetRootConstant:
+				material = command.Args[0];
+				break;
+			case Engine::NullRhiCommandType::SetRenderTarget:
+				hasTarget = true;
+				break;
+			case Engine::NullRhiCommandType::DrawIndexedInstanced:
+			{
+				const DrawCall& drawCall = pDrawCalls[command.Slot];
+				if (!hasTarget || pipeline != drawCall.Pipeline || vertexBuffer != drawCall.VertexBuffer.Address ||
+					material != drawCall.Material)
+					++wrongDraws;
+				pDrawn.push_back(command.Slot);
+				break;
+			}
+			default:
+				break;
+			}
+		}
+		return wrongDraws;
+	}
+}
+
+// The draw calls are split over the pool's lists the way DrawQueue::Flush() does, on 1 to 8 threads. Replayed
+// one after the other, the lists draw everything in order, each with its own state, and are submitted at once.
+TEST(CommandListPool_RecordsRangesInParallel)
+{
+	Engine::NullRhiDevice device;
+	auto& queue = static_cast<Engine::NullRhiCommandQueue&>(device.GetQueue(Engine::RhiQueueType::Graphics));
+	queue.SetLatency(k_FrameCount);
+
+	// Two pipelines of one root signature, one of another.
+	std::vector<std::unique_ptr<Engine::RhiPipeline>> pipelines;
+	Engine::RhiPipelineDesc desc;
+	desc.RootParameters = {{Engine::RhiRootParameterType::Constants}};
+	pipelines.push_back(device.CreatePipeline(desc));
+	pipelines.push_back(device.CreatePipeline(desc));
+	desc.UseStaticSamplers = true;
+	pipelines.push_back(device.CreatePipeline(desc));
+
+	constexpr uint32_t minDrawCallsPerList = 64;
+	for (const uint32_t threadCount : {1u, 2u, 4u, 8u})
+	{
+		Engine::JobSystem::Initialize(threadCount - 1);
+		Engine::FramePacer pacer(device, k_FrameCount);
+		// One more list than there are threads, for what comes after the draws.
+		Engine::CommandListPool pool(device, k_FrameCount, Engine::JobSystem::GetThreadCount() + 1);
+		Engine::RhiCommandList& frameList = device.GetCommandList();
+
+		Tests::Random random(threadCount);
+		for (uint32_t frame = 0; frame < 10; ++frame)
+		{
+			// Some frames are too small to be split.
+			const uint32_t drawCallCount = frame % 3 == 2 ? 1 + random.Next(minDrawCallsPerList) : 2000 + random.Next(4000);
+			const std::vector<DrawCall> drawCalls = MakeDrawCalls(pipelines, drawCallCount);
+
+			pacer.BeginFrame();
+			pool.BeginFrame(pacer.GetFrameIndex());
+			frameList.Begin(device.GetCommandAllocator());
+			frameList.End();
+
+			const uint32_t listCapacity = pool.GetListCount() - 1;
+			const uint32_t minRange = (std::max)(minDrawCallsPerList, (drawCallCount + listCapacity - 1) / listCapacity);
+			std::atomic<uint32_t> listCount = 0;
+			Engine::JobSystem::ParallelFor(drawCallCount, minRange,
+			                               [&](const uint32_t pFirst, const uint32_t pLast, const uint32_t pRange)
+			                               {
+				                               Engine::RhiCommandList& list = pool.Begin(pRange);
+				                               list.SetRenderTarget(nullptr, nullptr);
+				                               RecordDrawCalls(list, drawCalls, pFirst, pLast);
+				                               pool.End(pRange);
+				                               listCount.fetch_add(1, std::memory_order_relaxed);
+			                               });
+			const uint32_t lists = listCount.load();
+			CHECK(lists == (std::min)(threadCount, (drawCallCount + minRange - 1) / minRange));
+			pool.Begin(lists);
+			pool.End(lists);
+
+			std::vector<uint32_t> drawn;
+			uint32_t wrongDraws = 0;
+			for (uint32_t list = 0; list < lists; ++list)
+				wrongDraws += CountWrongDraws(static_cast<Engine::NullRhiCommandList&>(pool.GetList(list)), drawCalls, drawn);
+			CHECK(wrongDraws == 0);
+			CHECK(drawn.size() == drawCallCount);
+			CHECK(std::is_sorted(drawn.begin(), drawn.end()));
+
+			// Only the lists of this frame are summed, a larger previous frame left counters in the others. Every list
+			// binds its first vertex buffer again.
+			const Engine::StateFilteringCommandList::Stats stats = pool.GetStateFilteringStats();
+			const uint64_t vertexBufferBinds =
+				stats.Issued[static_cast<size_t>(Engine::StateFilteringCommandList::StateType::VertexBuffer)];
+			const uint32_t vertexBufferCount = (drawCallCount - 1) / 300 + 1;
+			CHECK(vertexBufferBinds >= vertexBufferCount);
+			CHECK(vertexBufferBinds < vertexBufferCount + lists);
+			// SetPipeline() counts as a root signature and a pipeline state.
+			CHECK(stats.GetIssuedCount() + stats.GetFilteredCount() == 4ull * drawCallCount);
+
+			const Engine::NullRhiStats before = device.GetStats();
+			pool.Execute(queue, &frameList, lists + 1);
+			CHECK(device.GetStats().ExecuteCount == before.ExecuteCount + 1);
+			CHECK(device.GetStats().ExecutedListCount == before.ExecutedListCount + lists + 2);
+			pacer.EndFrame(queue);
+		}
+		pacer.WaitIdle();
+		Engine::JobSystem::Shutdown();
+	}
+}
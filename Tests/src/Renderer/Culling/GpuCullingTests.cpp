@@ -0,0 +1,247 @@
+#include "Test.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <numeric>
+#include <vector>
+
+#include "Core/JobSystem.h"
+#include "Renderer/Culling/GpuCulling.h"
+
+namespace
+{
+	// Looking slightly up and to the right, 500 m deep.
+	DirectX::XMFLOAT4X4 MakeViewProj()
+	{
+		DirectX::XMFLOAT4X4 viewProj;
+		DirectX::XMStoreFloat4x4(&viewProj, DirectX::XMMatrixLookAtLH(DirectX::XMVectorSet(0.f, 0.f, 0.f, 1.f),
+		                                                              DirectX::XMVectorSet(0.3f, 0.1f, 1.f, 1.f),
+		                                                              DirectX::XMVectorSet(0.f, 1.f, 0.f, 0.f)) *
+		                         DirectX::XMMatrixPerspectiveFovLH(1.f, 16.f / 9.f, 0.1f, 500.f));
+		return viewProj;
+	}
+
+	// Boxes of 0.2 to 6 m within 400 m of the origin, most of them out of the frustum.
+	std::vector<Engine::GpuCulling::Candidate> MakeCandidates(Tests::Random& pRandom, const uint32_t pCount)
+	{
+		std::vector<Engine::GpuCulling::Candidate> candidates(pCount);
+		for (uint32_t i = 0; i < pCount; ++i)
+		{
+			candidates[i] = {
+				{pRandom.Range(-400.f, 400.f), pRandom.Range(-80.f, 80.f), pRandom.Range(-400.f, 400.f)}, 3 * (1 + i % 97),
+				{pRandom.Range(0.1f, 3.f), pRandom.Range(0.1f, 3.f), pRandom.Range(0.1f, 3.f)}, i * 3,
+				static_cast<int32_t>(i % 1000) - 500, {}
+			};
+		}
+		return candidates;
+	}
+
+	/// <summary>
+	/// The frustum test in double, on the box moved by pOffset.
+	/// </summary>
+	/// <returns> The distance of the box to the frustum, negative when outside of it. </returns>
+	double GetSignedDistance(const DirectX::XMFLOAT4X4& pViewProj, const double (&pOffset)[3],
+	                         const Engine::GpuCulling::Candidate& pCandidate)
+	{
+		const double center[3] = {pCandidate.Center.x + pOffset[0], pCandidate.Center.y + pOffset[1],
+		                          pCandidate.Center.z + pOffset[2]};
+		const double extents[3] = {pCandidate.Extents.x, pCandidate.Extents.y, pCandidate.Extents.z};
+		double distance = 1e30;
+		for (int plane = 0; plane < 6; ++plane)
+		{
+			double p[4];
+			for (int i = 0; i < 4; ++i)
+			{
+				const double x = pViewProj.m[i][0], y = pViewProj.m[i][1], z = pViewProj.m[i][2], w = pViewProj.m[i][3];
+				const double planes[6] = {w + x, w - x, w + y, w - y, z, w - z};
+				p[i] = planes[plane];
+			}
+			const double length = std::sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+			const double d = p[0] * center[0] + p[1] * center[1] + p[2] * center[2] + p[3];
+			const double r = std::fabs(p[0]) * extents[0] + std::fabs(p[1]) * extents[1] + std::fabs(p[2]) * extents[2];
+			distance = (std::min)(distance, (d + r) / length);
+		}
+		return distance;
+	}
+
+	/// <returns> The number of candidates IsVisible() gets wrong by more than a millimetre. </returns>
+	uint32_t CountWrongTests(const Engine::GpuCulling::Constants& pConstants, const DirectX::XMFLOAT4X4& pViewProj,
+	                         const double (&pOffset)[3], const std::vector<Engine::GpuCulling::Candidate>& pCandidates)
+	{
+		uint32_t wrong = 0;
+		for (const Engine::GpuCulling::Candidate& candidate : pCandidates)
+		{
+			const double distance = GetSignedDistance(pViewProj, pOffset, candidate);
+			if (std::fabs(distance) > 1e-3 && (distance >= 0.0) != Engine::GpuCulling::IsVisible(candidate, pConstants.Planes))
+				++wrong;
+		}
+		return wrong;
+	}
+
+	/// <summary>
+	/// What the three passes must write, one candidate after the other.
+	/// </summary>
+	std::vector<Engine::GpuCulling::DrawCommand> GetExpectedCommands(const Engine::GpuCulling::Constants& pConstants,
+	                                                                 const std::vector<Engine::GpuCulling::Candidate>&
+	                                                                 pCandidates)
+	{
+		std::vector<Engine::GpuCulling::DrawCommand> commands;
+		for (uint32_t i = 0; i < pCandidates.size(); ++i)
+		{
+			const Engine::GpuCulling::Candidate& candidate = pCandidates[i];
+			if (Engine::GpuCulling::IsVisible(candidate, pConstants.Planes))
+				commands.push_back({i, {candidate.IndexCount, 1, candidate.StartIndex, candidate.BaseVertex, 0}});
+		}
+		return commands;
+	}
+
+	bool HasCommands(const Engine::GpuCulling::Output& pOutput,
+	                 const std::vector<Engine::GpuCulling::DrawCommand>& pExpected)
+	{
+		return pOutput.CommandCount == pExpected.size() &&
+			std::memcmp(pOutput.Commands.data(), pExpected.data(),
+			            pExpected.size() * sizeof(Engine::GpuCulling::DrawCommand)) == 0;
+	}
+}
+
+// The buffers have the layouts of Builtin.Cull.hlsl.
+TEST(GpuCulling_MatchesTheShaderLayouts)
+{
+	CHECK(sizeof(Engine::GpuCulling::Candidate) == 48);
+	CHECK(sizeof(Engine::GpuCulling::Constants) == 112);
+	CHECK(sizeof(Engine::GpuCulling::DrawCommand) == 24);
+	CHECK(offsetof(Engine::GpuCulling::DrawCommand, Draw) == 4);
+}
+
+// The box test agrees with a test in double away from the planes, near the world origin and 10000 km from it.
+// Floats flushed to zero when denormal, as on the GPU, make a box just outside of a plane touch it.
+TEST(GpuCulling_TestsBoxesAgainstTheFrustum)
+{
+	const DirectX::XMFLOAT4X4 viewProj = MakeViewProj();
+	Tests::Random random(14);
+	const std::vector<Engine::GpuCulling::Candidate> candidates = MakeCandidates(random, 100000);
+
+	const double origin[3] = {};
+	const Engine::GpuCulling::Constants constants = Engine::GpuCulling::GetConstants(viewProj, origin, 100000);
+	CHECK(CountWrongTests(constants, viewProj, origin, candidates) == 0);
+	const uint32_t visibleCount = static_cast<uint32_t>(GetExpectedCommands(constants, candidates).size());
+	CHECK(visibleCount > 1000);
+	CHECK(visibleCount < 50000);
+
+	// The candidates are relative to an origin 10000 km from the world's, the camera 3.25 m from it.
+	const double worldOrigin[3] = {1e7, -2e3, 4e6};
+	const double camera[3] = {1e7 - 3.25, -2e3 + 2.5, 4e6 - 7.0};
+	const double offset[3] = {worldOrigin[0] - camera[0], worldOrigin[1] - camera[1], worldOrigin[2] - camera[2]};
+	const Engine::GpuCulling::Constants farConstants = Engine::GpuCulling::GetConstants(viewProj, offset, 100000);
+	CHECK(CountWrongTests(farConstants, viewProj, offset, candidates) == 0);
+
+	// The same boxes in world coordinates, as floats.
+	std::vector<Engine::GpuCulling::Candidate> worldCandidates = candidates;
+	for (Engine::GpuCulling::Candidate& candidate : worldCandidates)
+	{
+		candidate.Center = {static_cast<float>(candidate.Center.x + worldOrigin[0]),
+		                    static_cast<float>(candidate.Center.y + worldOrigin[1]),
+		                    static_cast<float>(candidate.Center.z + worldOrigin[2])};
+	}
+	const double toWorld[3] = {-camera[0], -camera[1], -camera[2]};
+	const uint32_t worldWrong = CountWrongTests(Engine::GpuCulling::GetConstants(viewProj, toWorld, 100000), viewProj,
+	                                            toWorld, worldCandidates);
+	std::printf("    %u of 100000 boxes visible, none wrong by more than 1 mm. In world coordinates 10000 km away, %u "
+	            "wrong\n", visibleCount, worldWrong);
+
+	Engine::GpuCulling::Constants flushConstants = {};
+	for (DirectX::XMFLOAT4& plane : flushConstants.Planes)
+		plane = {0.f, 0.f, 0.f, 1.f};
+	flushConstants.Planes[0] = {1.f, 0.f, 0.f, 0.f};
+	Engine::GpuCulling::Candidate denormal = {{-1e-40f, 0.f, 0.f}, 3, {0.f, 0.f, 0.f}, 0, 0, {}};
+	CHECK(Engine::GpuCulling::IsVisible(denormal, flushConstants.Planes));
+	denormal.Center.x = -1e-37f;
+	CHECK(!Engine::GpuCulling::IsVisible(denormal, flushConstants.Planes));
+}
+
+// The passes write the same bytes whatever the number of threads and the order the groups run in, as the GPU may
+// run them in any order : the draws of the visible candidates, in the candidates' order.
+TEST(GpuCulling_WritesTheSameDrawsInAnyOrder)
+{
+	const DirectX::XMFLOAT4X4 viewProj = MakeViewProj();
+	const double origin[3] = {};
+	Tests::Random random(15);
+
+	for (const uint32_t candidateCount : {0u, 1u, 63u, 64u, 65u, 20000u, 100003u})
+	{
+		const std::vector<Engine::GpuCulling::Candidate> candidates = MakeCandidates(random, candidateCount);
+		const Engine::GpuCulling::Constants constants = Engine::GpuCulling::GetConstants(viewProj, origin, candidateCount);
+		const std::vector<Engine::GpuCulling::DrawCommand> expected = GetExpectedCommands(constants, candidates);
+
+		Engine::GpuCulling::Output serial;
+		serial.Resize(candidateCount);
+		CHECK(Engine::GpuCulling::Run(constants, candidates.data(), serial) == expected.size());
+		CHECK(HasCommands(serial, expected));
+
+		for (const uint32_t threadCount : {2u, 4u, 8u})
+		{
+			Engine::JobSystem::Initialize(threadCount - 1);
+			Engine::GpuCulling::Output parallel;
+			parallel.Resize(candidateCount);
+			Engine::GpuCulling::Run(constants, candidates.data(), parallel);
+			CHECK(HasCommands(parallel, expected));
+			CHECK(parallel.Visibility == serial.Visibility);
+			CHECK(parallel.GroupCounts == serial.GroupCounts);
+			CHECK(parallel.GroupBases == serial.GroupBases);
+			Engine::JobSystem::Shutdown();
+		}
+
+		// Groups in random order, over an output holding the previous frame's draws.
+		std::vector<uint32_t> groups(constants.GroupCount);
+		std::iota(groups.begin(), groups.end(), 0u);
+		for (uint32_t i = constants.GroupCount; i > 1; --i)
+			std::swap(groups[i - 1], groups[random.Next(i)]);
+		Engine::GpuCulling::Output shuffled = serial;
+		std::fill(shuffled.Visibility.begin(), shuffled.Visibility.end(), 0xFFFFFFFFu);
+		for (const uint32_t group : groups)
+			Engine::GpuCulling::CullGroup(constants, candidates.data(), group, shuffled);
+		Engine::GpuCulling::ScanGroups(constants, shuffled);
+		for (uint32_t i = constants.GroupCount; i > 1; --i)
+			std::swap(groups[i - 1], groups[random.Next(i)]);
+		for (const uint32_t group : groups)
+			Engine::GpuCulling::CompactGroup(constants, candidates.data(), group, shuffled);
+		CHECK(HasCommands(shuffled, expected));
+		CHECK(shuffled.Visibility == serial.Visibility);
+	}
+}
+
+// 1M candidates culled and compacted on the CPU, the work of the shader's three dispatches.
+BENCHMARK(GpuCulling_Run1M)
+{
+	constexpr uint32_t candidateCount = 1000000;
+	const DirectX::XMFLOAT4X4 viewProj = MakeViewProj();
+	const double origin[3] = {};
+	Tests::Random random(16);
+	const std::vector<Engine::GpuCulling::Candidate> candidates = MakeCandidates(random, candidateCount);
+	const Engine::GpuCulling::Constants constants = Engine::GpuCulling::GetConstants(viewProj, origin, candidateCount);
+
+	for (const bool isParallel : {false, true})
+	{
+		if (isParallel)
+			Engine::JobSystem::Initialize();
+
+		Engine::GpuCulling::Output output;
+		output.Resize(candidateCount);
+		double best = 1e30;
+		for (uint32_t run = 0; run < 5; ++run)
+		{
+			const double start = Tests::GetTime();
+			Engine::GpuCulling::Run(constants, candidates.data(), output);
+			best = (std::min)(best, Tests::GetTime() - start);
+		}
+		std::printf("    %u threads : %u of %u candidates drawn in %.2f ms, %.2f ns per candidate\n",
+		            Engine::JobSystem::GetThreadCount(), output.CommandCount, candidateCount, best * 1000.0,
+		            best * 1e9 / candidateCount);
+
+		if (isParallel)
+			Engine::JobSystem::Shutdown();
+	}
+}
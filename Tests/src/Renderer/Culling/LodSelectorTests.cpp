@@ -0,0 +1,151 @@
+#include "Test.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include "Core/JobSystem.h"
+#include "Renderer/Culling/LodSelector.h"
+
+namespace
+{
+	// Three lods, the last two allowed from 5 and 50 units away : with a 90 degrees field of view on 1000 pixels,
+	// one pixel is 0.002 units one unit away. With the default 15% hysteresis, they are picked over the finer
+	// one from 5.88 and 58.8 units away.
+	Engine::LodSelector::LodGroup MakeGroup()
+	{
+		Engine::LodSelector::LodGroup group;
+		group.LodCount = 3;
+		group.GeometricErrors[1] = 0.01f;
+		group.GeometricErrors[2] = 0.1f;
+		return group;
+	}
+
+	/// <summary>
+	/// Selects the lod of a sphere of radius 1 whose surface is pDistance away from the camera.
+	/// </summary>
+	uint8_t Select(Engine::LodSelector& pSelector, const float pDistance, const uint8_t pPrevious)
+	{
+		const Engine::LodSelector::LodGroup group = MakeGroup();
+		const Engine::LodSelector::LodGroup* groupPointer = &group;
+		const DirectX::BoundingSphere sphere({0.f, 0.f, pDistance + 1.f}, 1.f);
+		uint8_t lod = pPrevious;
+		pSelector.Select(&sphere, &groupPointer, &lod, 1);
+		return lod;
+	}
+}
+
+// Between the distance a lod is allowed from and the one it is picked from, the previous lod is kept.
+TEST(LodSelector_KeepsTheLodInTheHysteresisBand)
+{
+	Engine::LodSelector selector;
+	selector.SetView({0.f, 0.f, 0.f}, 90.f, 1000.f);
+
+	CHECK(Select(selector, 4.f, 0) == 0);
+	CHECK(Select(selector, 5.5f, 0) == 0);
+	CHECK(Select(selector, 6.f, 0) == 1);
+	CHECK(Select(selector, 5.5f, 1) == 1);
+	CHECK(Select(selector, 4.9f, 1) == 0);
+
+	CHECK(Select(selector, 55.f, 1) == 1);
+	CHECK(Select(selector, 60.f, 1) == 2);
+	CHECK(Select(selector, 55.f, 2) == 2);
+	CHECK(Select(selector, 49.f, 2) == 1);
+
+	const Engine::LodSelector::Stats stats = selector.GetStats();
+	CHECK(stats.Selected[0] == 3 && stats.Selected[1] == 4 && stats.Selected[2] == 2 && stats.Culled == 0);
+}
+
+// A previous lod too coarse or too fine for the distance is brought back to the closest one allowed, lods past
+// the group's count are never picked.
+TEST(LodSelector_ClampsToTheFinestAndCoarsestLods)
+{
+	Engine::LodSelector selector;
+	selector.SetView({0.f, 0.f, 0.f}, 90.f, 1000.f);
+
+	CHECK(Select(selector, 2.f, 2) == 0);
+	CHECK(Select(selector, 10.f, 2) == 1);
+	CHECK(Select(selector, 10.f, 0) == 1);
+	CHECK(Select(selector, 100.f, 0) == 2);
+	CHECK(Select(selector, 100.f, 3) == 2);
+	// Shown again after being culled : the finest lod allowed, not the coarsest.
+	CHECK(Select(selector, 55.f, Engine::LodSelector::k_Culled) == 1);
+}
+
+// Objects under MinPixelSize are culled, and shown again only once 15% larger than it.
+TEST(LodSelector_CullsObjectsBelowMinPixelSize)
+{
+	Engine::LodSelector selector;
+	selector.SetView({0.f, 0.f, 0.f}, 90.f, 1000.f);
+	constexpr uint8_t culled = Engine::LodSelector::k_Culled;
+
+	// A diameter of 2 is 1000 / distance pixels : 2 pixels 500 units away, 2.3 pixels 435 units away.
+	CHECK(Select(selector, 520.f, 2) == culled);
+	CHECK(Select(selector, 480.f, culled) == culled);
+	CHECK(Select(selector, 480.f, 2) == 2);
+	CHECK(Select(selector, 420.f, culled) == 2);
+	CHECK(Select(selector, 5000.f, 0) == culled);
+	CHECK(selector.GetStats().Culled == 3);
+
+	Engine::LodSelector::Settings settings;
+	settings.MinPixelSize = 0.f;
+	selector.SetSettings(settings);
+	selector.SetView({0.f, 0.f, 0.f}, 90.f, 1000.f);
+	CHECK(Select(selector, 5000.f, culled) == 2);
+	CHECK(selector.GetStats().Culled == 0);
+}
+
+// Selects the lods of 100k objects spread over 2 km around a camera walking through them, like
+// Object::CullAndSelectLods() does every frame.
+BENCHMARK(LodSelector_Select100k)
+{
+	constexpr uint32_t objectCount = 100000;
+	constexpr uint32_t frameCount = 16;
+
+	Tests::Random random(3);
+	std::vector<DirectX::BoundingSphere> spheres(objectCount);
+	std::vector<Engine::LodSelector::LodGroup> groups(objectCount);
+	std::vector<const Engine::LodSelector::LodGroup*> groupPointers(objectCount);
+	for (uint32_t i = 0; i < objectCount; ++i)
+	{
+		spheres[i].Center = {random.Range(-1000.f, 1000.f), random.Range(-50.f, 50.f), random.Range(-1000.f, 1000.f)};
+		spheres[i].Radius = random.Range(0.5f, 5.f);
+		groups[i].LodCount = Engine::LodSelector::k_MaxLods;
+		groups[i].GeometricErrors[1] = spheres[i].Radius * 0.01f;
+		groups[i].GeometricErrors[2] = spheres[i].Radius * 0.04f;
+		groups[i].GeometricErrors[3] = spheres[i].Radius * 0.15f;
+		groupPointers[i] = &groups[i];
+	}
+
+	std::vector<uint8_t> singleThreadLods;
+	for (const bool isParallel : {false, true})
+	{
+		if (isParallel)
+			Engine::JobSystem::Initialize();
+
+		Engine::LodSelector selector;
+		std::vector<uint8_t> lods(objectCount, 0);
+		double best = 1e30;
+		for (uint32_t frame = 0; frame < frameCount; ++frame)
+		{
+			selector.SetView({0.f, 2.f, -500.f + 50.f * frame}, 60.f, 1080.f);
+			const double start = Tests::GetTime();
+			selector.Select(spheres.data(), groupPointers.data(), lods.data(), objectCount);
+			best = (std::min)(best, Tests::GetTime() - start);
+		}
+
+		const Engine::LodSelector::Stats stats = selector.GetStats();
+		std::printf("    %u threads : %.3f ms, %.2f ns per object. Lods %u / %u / %u / %u, %u culled\n",
+		            Engine::JobSystem::GetThreadCount(), best * 1000.0, best * 1e9 / objectCount, stats.Selected[0],
+		            stats.Selected[1], stats.Selected[2], stats.Selected[3], stats.Culled);
+
+		// The selection does not depend on how it was split.
+		if (!isParallel)
+			singleThreadLods = lods;
+		else
+			CHECK(lods == singleThreadLods);
+
+		if (isParallel)
+			Engine::JobSystem::Shutdown();
+	}
+}
@@ -0,0 +1,334 @@
+#include "Test.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "Core/JobSystem.h"
+#include "Core/MeshBvh.h"
+#include "Renderer/Culling/OcclusionCuller.h"
+
+namespace
+{
+	using DirectX::XMFLOAT3;
+
+	constexpr uint32_t k_Width = 256;
+	constexpr uint32_t k_Height = 144;
+	constexpr float k_FovY = 1.0471976f;
+
+	// Camera at the origin looking down +z, the view is the identity.
+	DirectX::XMFLOAT4X4 GetViewProj()
+	{
+		DirectX::XMFLOAT4X4 viewProj;
+		DirectX::XMStoreFloat4x4(&viewProj, DirectX::XMMatrixPerspectiveFovLH(
+			                         k_FovY, static_cast<float>(k_Width) / k_Height, 0.1f, 1000.f));
+		return viewProj;
+	}
+
+	// World x and y seen at a screen position, at a depth.
+	float ToWorldX(const float pScreenX, const float pDepth)
+	{
+		const float scale = std::tan(k_FovY * 0.5f) * static_cast<float>(k_Width) / k_Height;
+		return (pScreenX / k_Width * 2.f - 1.f) * scale * pDepth;
+	}
+
+	float ToWorldY(const float pScreenY, const float pDepth)
+	{
+		return (1.f - pScreenY / k_Height * 2.f) * std::tan(k_FovY * 0.5f) * pDepth;
+	}
+
+	float ToScreenX(const float pWorldX, const float pDepth)
+	{
+		const float scale = std::tan(k_FovY * 0.5f) * static_cast<float>(k_Width) / k_Height;
+		return (pWorldX / (scale * pDepth) * 0.5f + 0.5f) * k_Width;
+	}
+
+	float ToScreenY(const float pWorldY, const float pDepth)
+	{
+		return (0.5f - pWorldY / (std::tan(k_FovY * 0.5f) * pDepth) * 0.5f) * k_Height;
+	}
+
+	DirectX::BoundingBox MakeBox(const XMFLOAT3& pMin, const XMFLOAT3& pMax)
+	{
+		return DirectX::BoundingBox({(pMin.x + pMax.x) * 0.5f, (pMin.y + pMax.y) * 0.5f, (pMin.z + pMax.z) * 0.5f},
+		                            {(pMax.x - pMin.x) * 0.5f, (pMax.y - pMin.y) * 0.5f, (pMax.z - pMin.z) * 0.5f});
+	}
+
+	/// <summary>
+	/// Box occluders in world space, rasterized by the culler and ray traced by the reference.
+	/// </summary>
+	class OccluderScene
+	{
+	public:
+		void AddBox(const DirectX::BoundingBox& pBox)
+		{
+			const auto first = static_cast<uint32_t>(m_Positions.size());
+			for (const float z : {-1.f, 1.f})
+				for (const auto& [x, y] : {std::pair(-1.f, -1.f), std::pair(1.f, -1.f), std::pair(1.f, 1.f), std::pair(-1.f, 1.f)})
+					m_Positions.push_back({
+						pBox.Center.x + x * pBox.Extents.x, pBox.Center.y + y * pBox.Extents.y, pBox.Center.z + z * pBox.Extents.z
+					});
+
+			// The 4 near corners around the box then the 4 far ones.
+			constexpr uint32_t faces[6][4] = {
+				{0, 1, 2, 3}, {4, 5, 6, 7}, {0, 1, 5, 4}, {1, 2, 6, 5}, {2, 3, 7, 6}, {3, 0, 4, 7}
+			};
+			for (const auto& face : faces)
+			{
+				m_Indices.insert(m_Indices.end(), {first + face[0], first + face[1], first + face[2]});
+				m_Indices.insert(m_Indices.end(), {first + face[0], first + face[2], first + face[3]});
+			}
+		}
+
+		void Rasterize(Engine::OcclusionCuller& pCuller)
+		{
+			DirectX::XMFLOAT4X4 identity;
+			DirectX::XMStoreFloat4x4(&identity, DirectX::XMMatrixIdentity());
+			pCuller.BeginFrame(GetViewProj());
+			pCuller.AddOccluder(m_Positions.data(), m_Indices.data(), static_cast<uint32_t>(m_Indices.size()), identity);
+			pCuller.Rasterize();
+			m_Bvh.Build(m_Positions, m_Indices);
+		}
+
+		/// <summary>
+		/// Casts rays through pSamplesPerPixel^2 points per pixel of the box's screen rectangle.
+		/// </summary>
+		/// <returns> True if one of them reaches the box before the occluders. </returns>
+		bool IsVisibleReference(const DirectX::BoundingBox& pBox, const uint32_t pSamplesPerPixel) const
+		{
+			XMFLOAT3 corners[DirectX::BoundingBox::CORNER_COUNT];
+			pBox.GetCorners(corners);
+			float minX = FLT_MAX, maxX = -FLT_MAX, minY = FLT_MAX, maxY = -FLT_MAX;
+			for (const XMFLOAT3& corner : corners)
+			{
+				minX = (std::min)(minX, ToScreenX(corner.x, corner.z));
+				maxX = (std::max)(maxX, ToScreenX(corner.x, corner.z));
+				minY = (std::min)(minY, ToScreenY(corner.y, corner.z));
+				maxY = (std::max)(maxY, ToScreenY(corner.y, corner.z));
+			}
+			minX = (std::max)(minX, 0.f);
+			minY = (std::max)(minY, 0.f);
+			maxX = (std::min)(maxX, static_cast<float>(k_Width));
+			maxY = (std::min)(maxY, static_cast<float>(k_Height));
+
+			const float step = 1.f / static_cast<float>(pSamplesPerPixel);
+			for (float y = minY + step * 0.5f; y < maxY; y += step)
+			{
+				for (float x = minX + step * 0.5f; x < maxX; x += step)
+				{
+					Engine::Ray ray;
+					ray.Direction = {ToWorldX(x, 1.f), ToWorldY(y, 1.f), 1.f};
+					const float length = std::sqrt(ray.Direction.x * ray.Direction.x + ray.Direction.y * ray.Direction.y + 1.f);
+					ray.Direction = {ray.Direction.x / length, ray.Direction.y / length, 1.f / length};
+
+					float boxEntry;
+					if (!IntersectBox(pBox, ray, boxEntry))
+						continue;
+
+					ray.TMax = boxEntry;
+					Engine::RayHit hit;
+					if (!m_Bvh.Intersect(ray, hit))
+						return true;
+				}
+			}
+			return false;
+		}
+
+	private:
+		static bool IntersectBox(const DirectX::BoundingBox& pBox, const Engine::Ray& pRay, float& pEntry)
+		{
+			float tMin = 0.f, tMax = FLT_MAX;
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				const float origin = (&pRay.Origin.x)[axis];
+				const float direction = (&pRay.Direction.x)[axis];
+				const float min = (&pBox.Center.x)[axis] - (&pBox.Extents.x)[axis];
+				const float max = (&pBox.Center.x)[axis] + (&pBox.Extents.x)[axis];
+				if (std::fabs(direction) < 1e-12f)
+				{
+					if (origin < min || origin > max)
+						return false;
+					continue;
+				}
+				const float t0 = (min - origin) / direction, t1 = (max - origin) / direction;
+				tMin = (std::max)(tMin, (std::min)(t0, t1));
+				tMax = (std::min)(tMax, (std::max)(t0, t1));
+			}
+			pEntry = tMin;
+			return tMin <= tMax;
+		}
+
+		std::vector<XMFLOAT3> m_Positions;
+		std::vector<uint32_t> m_Indices;
+		Engine::MeshBvh m_Bvh;
+	};
+}
+
+TEST(OcclusionCuller_KeepsSubPixelSlivers)
+{
+	// A wall, and boxes behind it sticking out of one of its sides by less than a pixel. The wall is moved by
+	// fractions of a pixel so its edges land everywhere within a pixel.
+	uint32_t falseCulls = 0, hiddenCulled = 0, hiddenCount = 0;
+	for (int offset = 0; offset < 16; ++offset)
+	{
+		constexpr float wallDepth = 20.f;
+		const float shift = ToWorldX(offset / 16.f, wallDepth) - ToWorldX(0.f, wallDepth);
+		const float wallShiftY = ToWorldY(offset / 16.f, wallDepth) - ToWorldY(0.f, wallDepth);
+		OccluderScene scene;
+		scene.AddBox(MakeBox({-4.f + shift, -3.f + wallShiftY, wallDepth}, {4.f + shift, 3.f + wallShiftY, wallDepth + 0.5f}));
+
+		Engine::OcclusionCuller culler(k_Width, k_Height);
+		scene.Rasterize(culler);
+
+		// The wall's edges on screen, its near face is the silhouette.
+		const float left = ToScreenX(-4.f + shift, wallDepth), right = ToScreenX(4.f + shift, wallDepth);
+		const float top = ToScreenY(3.f + wallShiftY, wallDepth), bottom = ToScreenY(-3.f + wallShiftY, wallDepth);
+
+		constexpr float boxDepth = 25.f;
+		for (const float overhang : {-2.f, 0.15f, 0.3f, 0.5f, 0.75f, 0.95f})
+		{
+			const float inLeft = ToWorldX(left + 3.f, boxDepth), inRight = ToWorldX(right - 3.f, boxDepth);
+			const float inTop = ToWorldY(top + 3.f, boxDepth), inBottom = ToWorldY(bottom - 3.f, boxDepth);
+			const float outLeft = ToWorldX(left - overhang, boxDepth), outRight = ToWorldX(right + overhang, boxDepth);
+			const float outTop = ToWorldY(top - overhang, boxDepth), outBottom = ToWorldY(bottom + overhang, boxDepth);
+
+			const DirectX::BoundingBox boxes[] = {
+				MakeBox({outLeft, inBottom * 0.5f, boxDepth}, {inLeft, inTop * 0.5f, boxDepth + 1.f}),
+				MakeBox({inRight, inBottom * 0.5f, boxDepth}, {outRight, inTop * 0.5f, boxDepth + 1.f}),
+				MakeBox({inLeft * 0.5f, inTop, boxDepth}, {inRight * 0.5f, outTop, boxDepth + 1.f}),
+				MakeBox({inLeft * 0.5f, outBottom, boxDepth}, {inRight * 0.5f, inBottom, boxDepth + 1.f}),
+			};
+			for (const DirectX::BoundingBox& box : boxes)
+			{
+				const bool isVisible = scene.IsVisibleReference(box, 16);
+				// The reference sees every sliver, the boxes inside stay hidden.
+				CHECK(isVisible == (overhang > 0.f));
+				const bool isCulled = !culler.IsVisible(box);
+				falseCulls += isVisible && isCulled ? 1 : 0;
+				hiddenCount += isVisible ? 0 : 1;
+				hiddenCulled += !isVisible && isCulled ? 1 : 0;
+			}
+		}
+	}
+
+	CHECK(falseCulls == 0);
+	// Moving the test rectangle out by half a pixel must not stop culling the boxes well behind.
+	CHECK(hiddenCulled == hiddenCount);
+}
+
+TEST(OcclusionCuller_MatchesBruteForce)
+{
+	// Random walls in front of random boxes, compared with rays through 4x4 points per pixel. The culled
+	// percentage is compared with the boxes the rays find hidden.
+	uint32_t falseCulls = 0, culledCount = 0, hiddenCount = 0, testedCount = 0;
+	for (uint64_t seed = 0; seed < 4; ++seed)
+	{
+		Tests::Random random(seed);
+		OccluderScene scene;
+		for (int i = 0; i < 40; ++i)
+		{
+			const float depth = random.Range(8.f, 30.f);
+			const XMFLOAT3 center = {
+				ToWorldX(random.Range(0.f, k_Width), depth), ToWorldY(random.Range(0.f, k_Height), depth), depth
+			};
+			const XMFLOAT3 extents = {random.Range(0.5f, 4.f), random.Range(0.5f, 3.f), random.Range(0.1f, 0.5f)};
+			scene.AddBox(DirectX::BoundingBox(center, extents));
+		}
+
+		Engine::OcclusionCuller culler(k_Width, k_Height);
+		scene.Rasterize(culler);
+
+		for (int i = 0; i < 1500; ++i)
+		{
+			const float depth = random.Range(12.f, 60.f);
+			const XMFLOAT3 center = {
+				ToWorldX(random.Range(0.f, k_Width), depth), ToWorldY(random.Range(0.f, k_Height), depth), depth
+			};
+			const float size = random.Range(0.05f, 1.5f);
+			const DirectX::BoundingBox box(center, {size, size * random.Range(0.3f, 1.f), size});
+
+			const bool isCulled = !culler.IsVisible(box);
+			const bool isVisible = scene.IsVisibleReference(box, 4);
+			falseCulls += isCulled && isVisible ? 1 : 0;
+			culledCount += isCulled ? 1 : 0;
+			hiddenCount += isVisible ? 0 : 1;
+		}
+		testedCount += culler.GetStats().Tested;
+	}
+
+	std::printf("    %u boxes, %.1f%% culled, %.1f%% hidden from the rays, %u culled while visible\n", testedCount,
+	            100.f * culledCount / testedCount, 100.f * hiddenCount / testedCount, falseCulls);
+	// Gaps narrower than a pixel between two occluders are not covered.
+	CHECK(falseCulls == 0);
+	CHECK(culledCount > hiddenCount / 2);
+}
+
+TEST(OcclusionCuller_RejectsBoxesOutsideTheFrustum)
+{
+	Engine::OcclusionCuller culler(k_Width, k_Height);
+	OccluderScene().Rasterize(culler);
+
+	// Without occluders, only the frustum culls.
+	CHECK(culler.IsVisible(MakeBox({-1.f, -1.f, 10.f}, {1.f, 1.f, 12.f})));
+	CHECK(!culler.IsVisible(MakeBox({-1.f, -1.f, -12.f}, {1.f, 1.f, -10.f})));
+	CHECK(!culler.IsVisible(MakeBox({-1.f, -1.f, 1100.f}, {1.f, 1.f, 1200.f})));
+	const float left = ToWorldX(0.f, 20.f), right = ToWorldX(static_cast<float>(k_Width), 20.f);
+	const float top = ToWorldY(0.f, 20.f);
+	CHECK(!culler.IsVisible(MakeBox({left - 3.f, -1.f, 19.5f}, {left - 2.f, 1.f, 20.5f})));
+	CHECK(!culler.IsVisible(MakeBox({right + 2.f, -1.f, 19.5f}, {right + 3.f, 1.f, 20.5f})));
+	CHECK(!culler.IsVisible(MakeBox({-1.f, top + 1.f, 19.f}, {1.f, top + 3.f, 21.f})));
+	// Across a frustum plane, around the camera, or beside the frustum but not outside any single plane.
+	CHECK(culler.IsVisible(MakeBox({left - 3.f, -1.f, 19.f}, {left + 1.f, 1.f, 21.f})));
+	CHECK(culler.IsVisible(MakeBox({-1.f, -1.f, -1.f}, {1.f, 1.f, 1.f})));
+	CHECK(culler.IsVisible(MakeBox({-1.f, -1.f, 0.05f}, {1.f, 1.f, 5.f})));
+
+	const Engine::OcclusionCuller::Stats stats = culler.GetStats();
+	CHECK(stats.Tested == 9);
+	CHECK(stats.Culled == 5);
+}
+
+TEST(OcclusionCuller_ClampsOccludersNearTheCamera)
+{
+	// A wall over the left half of the screen, from just past the near clip of the culler : its projected
+	// vertices are far outside the int range, its far part still hides what is behind it.
+	OccluderScene scene;
+	scene.AddBox(MakeBox({-1000.f, -1000.f, 1.0001e-4f}, {0.f, 1000.f, 1.f}));
+	Engine::OcclusionCuller culler(k_Width, k_Height);
+	scene.Rasterize(culler);
+
+	CHECK(!culler.IsVisible(MakeBox({-3.f, -1.f, 10.f}, {-1.f, 1.f, 12.f})));
+	CHECK(!culler.IsVisible(MakeBox({-30.f, -20.f, 50.f}, {-5.f, 20.f, 60.f})));
+	CHECK(culler.IsVisible(MakeBox({1.f, -1.f, 10.f}, {3.f, 1.f, 12.f})));
+	CHECK(culler.IsVisible(MakeBox({-3.f, -1.f, 10.f}, {3.f, 1.f, 12.f})));
+}
+
+TEST(OcclusionCuller_StatsFromSeveralThreads)
+{
+	OccluderScene scene;
+	scene.AddBox(MakeBox({-10.f, -10.f, 10.f}, {10.f, 10.f, 11.f}));
+	Engine::OcclusionCuller culler(k_Width, k_Height);
+	scene.Rasterize(culler);
+
+	// Half of the boxes are behind the wall.
+	constexpr uint32_t count = 100000;
+	std::vector<uint8_t> results(count);
+	Engine::JobSystem::Initialize(4);
+	Engine::JobSystem::ParallelFor(count, 1000, [&](const uint32_t pFirst, const uint32_t pLast, uint32_t)
+	{
+		for (uint32_t i = pFirst; i < pLast; ++i)
+		{
+			const float x = i % 2 == 0 ? 0.f : 30.f;
+			results[i] = culler.IsVisible(DirectX::BoundingBox({x, 0.f, 20.f}, {1.f, 1.f, 1.f})) ? 1 : 0;
+		}
+	});
+	Engine::JobSystem::Shutdown();
+
+	const Engine::OcclusionCuller::Stats stats = culler.GetStats();
+	CHECK(stats.Tested == count);
+	CHECK(stats.Culled == count / 2);
+	CHECK(std::count(results.begin(), results.end(), 0) == count / 2);
+}
@@ -0,0 +1,263 @@
+#include "Test.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include "Core/MeshBvh.h"
+#include "Core/Transform.h"
+#include "Renderer/Culling/PotentiallyVisibleSet.h"
+#include "Renderer/Culling/PvsBaker.h"
+
+namespace
+{
+	using DirectX::XMFLOAT3;
+
+	constexpr uint32_t k_CellsX = 9;
+	constexpr uint32_t k_CellsY = 2;
+	constexpr uint32_t k_CellsZ = 3;
+	constexpr uint32_t k_CellCount = k_CellsX * k_CellsY * k_CellsZ;
+	// Not a multiple of 64, the last word is partly used.
+	constexpr uint32_t k_ObjectCount = 150;
+	constexpr uint32_t k_WordCount = (k_ObjectCount + 63) / 64;
+
+	/// <summary>
+	/// Visible sets of every cell. Coherent ones differ from their neighbour along x by a few objects, like a
+	/// baked scene, the others are random.
+	/// </summary>
+	std::vector<uint64_t> MakeBits(const uint64_t pSeed, const bool pIsCoherent)
+	{
+		Tests::Random random(pSeed);
+		std::vector<uint64_t> bits(static_cast<size_t>(k_CellCount) * k_WordCount, 0);
+		for (uint32_t cell = 0; cell < k_CellCount; ++cell)
+		{
+			uint64_t* cellBits = bits.data() + static_cast<size_t>(cell) * k_WordCount;
+			if (pIsCoherent && cell % k_CellsX != 0)
+			{
+				std::memcpy(cellBits, cellBits - k_WordCount, k_WordCount * sizeof(uint64_t));
+				for (uint32_t flip = random.Next(4); flip > 0; --flip)
+				{
+					const uint32_t object = random.Next(k_ObjectCount);
+					cellBits[object / 64] ^= 1ull << (object % 64);
+				}
+				continue;
+			}
+			for (uint32_t object = 0; object < k_ObjectCount; ++object)
+			{
+				if (random.Next(pIsCoherent ? 8 : 2) == 0)
+					cellBits[object / 64] |= 1ull << (object % 64);
+			}
+		}
+		return bits;
+	}
+
+	/// <returns> The number of cells whose decoded set, or any IsVisible(), differs from bits. </returns>
+	uint32_t CountMismatches(const Engine::PotentiallyVisibleSet& pPvs, const std::vector<uint64_t>& pBits)
+	{
+		uint32_t mismatches = 0;
+		std::vector<uint64_t> decoded(k_WordCount);
+		for (uint32_t cell = 0; cell < k_CellCount; ++cell)
+		{
+			const uint64_t* cellBits = pBits.data() + static_cast<size_t>(cell) * k_WordCount;
+			pPvs.GetVisibleSet(cell, decoded.data());
+			bool isSame = std::memcmp(decoded.data(), cellBits, k_WordCount * sizeof(uint64_t)) == 0;
+			for (uint32_t object = 0; object < k_ObjectCount; ++object)
+				isSame = isSame && pPvs.IsVisible(cell, object) == ((cellBits[object / 64] >> (object % 64) & 1) != 0);
+			mismatches += isSame ? 0 : 1;
+		}
+		return mismatches;
+	}
+
+	std::vector<char> ReadFile(const char* pPath)
+	{
+		std::ifstream file(pPath, std::ios::binary);
+		return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+
+	void WriteFile(const char* pPath, const std::vector<char>& pBytes)
+	{
+		std::ofstream file(pPath, std::ios::binary | std::ios::trunc);
+		file.write(pBytes.data(), static_cast<std::streamsize>(pBytes.size()));
+	}
+
+	void WriteUint32(std::vector<char>& pBytes, const size_t pOffset, const uint32_t pValue)
+	{
+		std::memcpy(pBytes.data() + pOffset, &pValue, sizeof(pValue));
+	}
+
+	// A wall of 2x2 units in the xy plane, as two triangles.
+	Engine::MeshBvh MakeWall()
+	{
+		Engine::MeshBvh bvh;
+		bvh.Build({{-1.f, -1.f, 0.f}, {1.f, -1.f, 0.f}, {1.f, 1.f, 0.f}, {-1.f, 1.f, 0.f}}, {0, 1, 2, 0, 2, 3});
+		return bvh;
+	}
+}
+
+// Coherent sets are stored as xor rows with their key cell and shared rows, random ones fall back to raw bitsets,
+// both decode to the sets they were built from.
+TEST(PotentiallyVisibleSet_EncodesAndDecodes)
+{
+	for (uint64_t seed = 0; seed < 4; ++seed)
+	{
+		Engine::PotentiallyVisibleSet pvs;
+		const std::vector<uint64_t> coherent = MakeBits(seed, true);
+		pvs.Build({0.f, 0.f, 0.f}, 1.f, k_CellsX, k_CellsY, k_CellsZ, k_ObjectCount, coherent.data());
+		CHECK(pvs.IsCompressed());
+		CHECK(pvs.GetCompressedSize() < pvs.GetUncompressedSize());
+		CHECK(CountMismatches(pvs, coherent) == 0);
+
+		const std::vector<uint64_t> random = MakeBits(seed, false);
+		pvs.Build({0.f, 0.f, 0.f}, 1.f, k_CellsX, k_CellsY, k_CellsZ, k_ObjectCount, random.data());
+		CHECK(!pvs.IsCompressed());
+		CHECK(CountMismatches(pvs, random) == 0);
+	}
+
+	// Every cell the same, or seeing nothing.
+	Engine::PotentiallyVisibleSet pvs;
+	const std::vector<uint64_t> none(static_cast<size_t>(k_CellCount) * k_WordCount, 0);
+	pvs.Build({0.f, 0.f, 0.f}, 1.f, k_CellsX, k_CellsY, k_CellsZ, k_ObjectCount, none.data());
+	CHECK(CountMismatches(pvs, none) == 0);
+	CHECK(pvs.GetCompressedSize() <= (k_CellCount + 1) * sizeof(uint32_t));
+}
+
+TEST(PotentiallyVisibleSet_FindsCells)
+{
+	Engine::PotentiallyVisibleSet pvs;
+	const std::vector<uint64_t> bits = MakeBits(7, true);
+	pvs.Build({-2.f, 0.f, 1.f}, 0.5f, k_CellsX, k_CellsY, k_CellsZ, k_ObjectCount, bits.data());
+
+	CHECK(pvs.GetCellIndex({-2.f, 0.f, 1.f}) == 0);
+	CHECK(pvs.GetCellIndex({-1.99f, 0.49f, 1.49f}) == 0);
+	CHECK(pvs.GetCellIndex({-1.4f, 0.1f, 1.1f}) == 1);
+	CHECK(pvs.GetCellIndex({-1.9f, 0.6f, 1.1f}) == k_CellsX);
+	CHECK(pvs.GetCellIndex({-1.9f, 0.1f, 1.6f}) == k_CellsX * k_CellsY);
+	CHECK(pvs.GetCellIndex({2.49f, 0.99f, 2.49f}) == k_CellCount - 1);
+
+	// Just outside of each side of the grid.
+	CHECK(pvs.GetCellIndex({-2.01f, 0.5f, 2.f}) == Engine::PotentiallyVisibleSet::k_InvalidCell);
+	CHECK(pvs.GetCellIndex({2.5f, 0.5f, 2.f}) == Engine::PotentiallyVisibleSet::k_InvalidCell);
+	CHECK(pvs.GetCellIndex({0.f, -0.01f, 2.f}) == Engine::PotentiallyVisibleSet::k_InvalidCell);
+	CHECK(pvs.GetCellIndex({0.f, 1.f, 2.f}) == Engine::PotentiallyVisibleSet::k_InvalidCell);
+	CHECK(pvs.GetCellIndex({0.f, 0.5f, 0.99f}) == Engine::PotentiallyVisibleSet::k_InvalidCell);
+	CHECK(pvs.GetCellIndex({0.f, 0.5f, 2.5f}) == Engine::PotentiallyVisibleSet::k_InvalidCell);
+
+	// Outside of the grid, or for an object it does not know, everything is visible.
+	std::vector<uint64_t> decoded(k_WordCount, 0);
+	pvs.GetVisibleSet(Engine::PotentiallyVisibleSet::k_InvalidCell, decoded.data());
+	CHECK(decoded == std::vector<uint64_t>(k_WordCount, ~0ull));
+	CHECK(pvs.IsVisible(Engine::PotentiallyVisibleSet::k_InvalidCell, 0));
+	CHECK(pvs.IsVisible(0, k_ObjectCount));
+}
+
+// A baked set written and read back decodes the same and keeps the hash of its scene, which changes when an
+// object moves.
+TEST(PotentiallyVisibleSet_SavesAndLoads)
+{
+	const char* path = "PotentiallyVisibleSetTests.bin";
+	for (const bool isCoherent : {true, false})
+	{
+		Engine::PotentiallyVisibleSet pvs;
+		const std::vector<uint64_t> bits = MakeBits(11, isCoherent);
+		pvs.Build({1.f, 2.f, 3.f}, 0.25f, k_CellsX, k_CellsY, k_CellsZ, k_ObjectCount, bits.data());
+		CHECK(pvs.Save(path));
+
+		Engine::PotentiallyVisibleSet loaded;
+		CHECK(loaded.Load(path));
+		CHECK(loaded.IsCompressed() == isCoherent);
+		CHECK(loaded.GetCellCount() == k_CellCount);
+		CHECK(loaded.GetObjectCount() == k_ObjectCount);
+		CHECK(loaded.GetCellIndex({1.3f, 2.1f, 3.1f}) == 1);
+		CHECK(CountMismatches(loaded, bits) == 0);
+	}
+
+	const Engine::MeshBvh wall = MakeWall();
+	Engine::Transform transforms[2] = {
+		Engine::Transform(XMFLOAT3(0.f, 0.f, 0.f), XMFLOAT3(0.f, 0.f, 0.f), XMFLOAT3(1.f, 1.f, 1.f)),
+		Engine::Transform(XMFLOAT3(0.f, 0.f, 4.f), XMFLOAT3(0.f, 0.f, 0.f), XMFLOAT3(1.f, 1.f, 1.f)),
+	};
+	const auto bake = [&](Engine::PotentiallyVisibleSet& pResult)
+	{
+		Engine::PvsBaker baker;
+		for (Engine::Transform& transform : transforms)
+		{
+			DirectX::BoundingBox bounds;
+			wall.GetBounds().Transform(bounds, transform.GetWorld());
+			baker.AddObject(bounds, &wall, transform);
+		}
+		baker.Bake(DirectX::BoundingBox({0.f, 0.f, 2.f}, {2.f, 2.f, 4.f}), pResult);
+		return baker.ComputeSceneHash();
+	};
+
+	Engine::PotentiallyVisibleSet pvs;
+	const uint64_t hash = bake(pvs);
+	CHECK(pvs.GetSceneHash() == hash);
+	CHECK(pvs.Save(path));
+	Engine::PotentiallyVisibleSet loaded;
+	CHECK(loaded.Load(path));
+	CHECK(loaded.GetSceneHash() == hash);
+	std::remove(path);
+
+	transforms[1].SetPosition(XMFLOAT3(0.f, 0.f, 4.5f));
+	CHECK(bake(pvs) != hash);
+}
+
+// Truncated files, or counts and offsets that do not match the data, are rejected before any read past it.
+TEST(PotentiallyVisibleSet_RejectsCorruptFiles)
+{
+	const char* path = "PotentiallyVisibleSetTests.bin";
+	Engine::PotentiallyVisibleSet pvs;
+	const std::vector<uint64_t> bits = MakeBits(5, true);
+	pvs.Build({0.f, 0.f, 0.f}, 1.f, k_CellsX, k_CellsY, k_CellsZ, k_ObjectCount, bits.data());
+	CHECK(pvs.IsCompressed());
+	CHECK(pvs.Save(path));
+	const std::vector<char> valid = ReadFile(path);
+
+	// Header : magic, origin, cell size, cells x y z, object count, cell row count, row value count, reserved,
+	// scene hash.
+	constexpr size_t headerSize = 56;
+	constexpr size_t cellsXOffset = 20;
+	constexpr size_t objectCountOffset = 32;
+	constexpr size_t rowValueCountOffset = 40;
+	CHECK(valid.size() > headerSize + k_CellCount * sizeof(uint32_t));
+	uint32_t rowValueCount = 0;
+	std::memcpy(&rowValueCount, valid.data() + rowValueCountOffset, sizeof(rowValueCount));
+	const size_t rowsOffset = headerSize + k_CellCount * sizeof(uint32_t);
+
+	std::vector<std::vector<char>> corrupts;
+	corrupts.emplace_back(valid.begin(), valid.end() - 4);
+	corrupts.emplace_back(valid.begin(), valid.begin() + headerSize - 1);
+	corrupts.push_back(valid);
+	WriteUint32(corrupts.back(), 0, 0x31535650);
+	corrupts.push_back(valid);
+	WriteUint32(corrupts.back(), cellsXOffset, k_CellsX + 1);
+	corrupts.push_back(valid);
+	WriteUint32(corrupts.back(), rowValueCountOffset, 0x40000000);
+	// A cell's row past the rows.
+	corrupts.push_back(valid);
+	WriteUint32(corrupts.back(), headerSize + 4 * sizeof(uint32_t), rowValueCount);
+	// The first row announcing more values than there are.
+	corrupts.push_back(valid);
+	WriteUint32(corrupts.back(), rowsOffset, (rowValueCount << 1) | 1);
+	// Sparse rows indexing objects past the count.
+	corrupts.push_back(valid);
+	WriteUint32(corrupts.back(), objectCountOffset, 10);
+
+	for (const std::vector<char>& corrupt : corrupts)
+	{
+		WriteFile(path, corrupt);
+		Engine::PotentiallyVisibleSet loaded;
+		CHECK(!loaded.Load(path));
+		CHECK(loaded.IsEmpty());
+		CHECK(loaded.GetCellCount() == 0);
+		CHECK(loaded.IsVisible(0, 0));
+	}
+
+	WriteFile(path, valid);
+	Engine::PotentiallyVisibleSet loaded;
+	CHECK(loaded.Load(path));
+	CHECK(CountMismatches(loaded, bits) == 0);
+	std::remove(path);
+}
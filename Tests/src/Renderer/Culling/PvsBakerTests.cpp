@@ -0,0 +1,110 @@
+#include "Test.h"
+
+#include <cstdio>
+#include <vector>
+
+#include "Core/JobSystem.h"
+#include "Core/MeshBvh.h"
+#include "Core/ObjLoader.h"
+#include "Core/Transform.h"
+#include "Renderer/Culling/PotentiallyVisibleSet.h"
+#include "Renderer/Culling/PvsBaker.h"
+
+namespace
+{
+	using DirectX::XMFLOAT3;
+
+	/// <returns> The hierarchy over one of the engine's meshes, empty if it could not be loaded. </returns>
+	Engine::MeshBvh LoadBvh(const char* pPath)
+	{
+		std::vector<Engine::VertexLit> vertices;
+		Engine::ObjLoader::LoadObj(pPath, &vertices);
+		std::vector<XMFLOAT3> positions;
+		std::vector<uint32_t> indices;
+		for (const Engine::VertexLit& vertex : vertices)
+		{
+			indices.push_back(static_cast<uint32_t>(positions.size()));
+			positions.push_back(vertex.Position);
+		}
+		Engine::MeshBvh bvh;
+		bvh.Build(positions, indices);
+		return bvh;
+	}
+}
+
+// Bakes a grid of rooms like Sandbox::CreateLevel(), 8x8 instead of 3x3, with the Sandbox's cube and sphere meshes.
+BENCHMARK(PvsBaker_BakeRooms)
+{
+	constexpr int roomCount = 8;
+	constexpr float roomSize = 6.f;
+	constexpr float wallHeight = 1.f;
+	const XMFLOAT3 origin(-roomCount * roomSize / 2, -0.4f, 7.f);
+
+	const Engine::MeshBvh cube = LoadBvh("Objs/untitled.obj");
+	const Engine::MeshBvh sphere = LoadBvh("Objs/sphere.obj");
+	CHECK(!cube.IsEmpty() && !sphere.IsEmpty());
+	if (cube.IsEmpty() || sphere.IsEmpty())
+		return;
+
+	// The baker keeps pointers to the transforms.
+	std::vector<Engine::Transform> transforms;
+	std::vector<const Engine::MeshBvh*> meshes;
+	transforms.reserve(static_cast<size_t>(roomCount + 1) * roomCount * 4 + roomCount * roomCount);
+	const auto addObject = [&](const Engine::MeshBvh& pMesh, const XMFLOAT3& pPosition, const XMFLOAT3& pScale)
+	{
+		transforms.emplace_back(pPosition, XMFLOAT3(0.f, 0.f, 0.f), pScale);
+		meshes.push_back(&pMesh);
+	};
+
+	const float piece = roomSize / 3;
+	const float wallY = origin.y + wallHeight - 0.2f;
+	for (int line = 0; line <= roomCount; line++)
+		for (int room = 0; room < roomCount; room++)
+		{
+			const float along = room * roomSize;
+			const float across = line * roomSize;
+			for (const float offset : {piece / 2, roomSize - piece / 2})
+			{
+				addObject(cube, XMFLOAT3(origin.x + along + offset, wallY, origin.z + across),
+				          XMFLOAT3(piece / 2, wallHeight, 0.1f));
+				addObject(cube, XMFLOAT3(origin.x + across, wallY, origin.z + along + offset),
+				          XMFLOAT3(0.1f, wallHeight, piece / 2));
+			}
+		}
+	for (int row = 0; row < roomCount; row++)
+		for (int column = 0; column < roomCount; column++)
+			addObject(sphere, XMFLOAT3(origin.x + (column + 0.3f) * roomSize, origin.y + 0.4f,
+			                           origin.z + (row + 0.7f) * roomSize), XMFLOAT3(0.4f, 0.4f, 0.4f));
+
+	Engine::PvsBaker baker;
+	DirectX::BoundingBox volume;
+	for (size_t i = 0; i < transforms.size(); ++i)
+	{
+		DirectX::BoundingBox bounds;
+		meshes[i]->GetBounds().Transform(bounds, transforms[i].GetWorld());
+		baker.AddObject(bounds, meshes[i], transforms[i]);
+		if (i == 0)
+			volume = bounds;
+		else
+			DirectX::BoundingBox::CreateMerged(volume, volume, bounds);
+	}
+
+	Engine::JobSystem::Initialize();
+	Engine::PotentiallyVisibleSet pvs;
+	baker.Bake(volume, pvs);
+	Engine::JobSystem::Shutdown();
+
+	uint64_t visibleCount = 0;
+	for (uint32_t cell = 0; cell < pvs.GetCellCount(); ++cell)
+		for (uint32_t object = 0; object < pvs.GetObjectCount(); ++object)
+			visibleCount += pvs.IsVisible(cell, object) ? 1 : 0;
+	const double visibleFraction = static_cast<double>(visibleCount) / pvs.GetCellCount() / pvs.GetObjectCount();
+
+	const Engine::PvsBaker::Stats& stats = baker.GetStats();
+	std::printf("    %u objects, %u cells, %llu rays in %.2f s on %u threads : %.2f Mrays/s, %.1f ms per cell\n",
+	            pvs.GetObjectCount(), stats.CellCount, static_cast<unsigned long long>(stats.RayCount), stats.Seconds,
+	            stats.ThreadCount, stats.GetRaysPerSecond() / 1e6, stats.Seconds * 1000.0 / stats.CellCount);
+	std::printf("    %.1f%% of the objects visible per cell, %zu bytes (%zu as raw bitsets)\n", visibleFraction * 100.0,
+	            pvs.GetCompressedSize(), pvs.GetUncompressedSize());
+	CHECK(visibleFraction < 0.9);
+}
@@ -0,0 +1,377 @@
+#include "Test.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <set>
+#include <tuple>
+#include <vector>
+
+#include "Core/JobSystem.h"
+#include "Renderer/CommandListPool.h"
+#include "Renderer/DrawQueue.h"
+#include "Renderer/UploadRing.h"
+#include "Renderer/RHI/NullRhi.h"
+
+namespace
+{
+	constexpr uint32_t k_FrameCount = 2;
+
+	// The draw queue writes its instances through RhiDevice::Get(). Declared first, the device outlives the
+	// buffers and pipelines of the test.
+	class ScopedDevice
+	{
+	public:
+		ScopedDevice() { Engine::RhiDevice::Initialize(std::make_unique<Engine::NullRhiDevice>()); }
+		~ScopedDevice() { Engine::RhiDevice::Shutdown(); }
+
+		Engine::NullRhiDevice& Get() const { return static_cast<Engine::NullRhiDevice&>(*Engine::RhiDevice::Get()); }
+	};
+
+	// Binds its vertex buffer and draws its indices, as DirectXMesh does outside of a pool.
+	class TestMesh : public Engine::DrawQueueMesh
+	{
+	public:
+		explicit TestMesh(const uint32_t pSortId) : m_SortId(pSortId) {}
+
+		void Draw(Engine::RhiCommandList& pCommandList, const uint32_t pInstanceCount) const override
+		{
+			pCommandList.SetVertexBuffer(GetVertexBuffer());
+			pCommandList.DrawIndexedInstanced(36, pInstanceCount, 0, 0, 0);
+		}
+
+		uint32_t GetSortId() const override { return m_SortId; }
+		Engine::RhiVertexBufferView GetVertexBuffer() const { return {0x10000ull * (m_SortId + 1), 4096, 32}; }
+
+	private:
+		uint32_t m_SortId;
+	};
+
+	// Binds the pipeline, the instances and the draw's first instance, as the DirectXShaders do.
+	class TestMaterial : public Engine::DrawQueueMaterial
+	{
+	public:
+		TestMaterial(const Engine::RhiPipeline& pPipeline, const uint32_t pShader, const Engine::ShaderVariantKey pVariant,
+		             const uint32_t pMaterialId)
+			: m_Pipeline(pPipeline), m_Shader(pShader), m_Variant(pVariant), m_MaterialId(pMaterialId)
+		{
+		}
+
+		void Bind(Engine::RhiCommandList& pCommandList, Engine::ShaderVariantKey pVariant,
+		          const Engine::RhiGpuAddress pInstances, const uint32_t pFirstInstance) const override
+		{
+			pCommandList.SetPipeline(m_Pipeline);
+			pCommandList.SetGraphicsRootShaderResourceView(1, pInstances);
+			pCommandList.SetGraphicsRoot32BitConstant(0, pFirstInstance, 0);
+		}
+
+		Engine::ShaderVariantKey SelectVariant() const override { return m_Variant; }
+		uint32_t GetShaderSortId() const override { return m_Shader; }
+		uint32_t GetMaterialId() const override { return m_MaterialId; }
+
+		const Engine::RhiPipeline& GetPipeline() const { return m_Pipeline; }
+
+	private:
+		const Engine::RhiPipeline& m_Pipeline;
+		uint32_t m_Shader;
+		Engine::ShaderVariantKey m_Variant;
+		uint32_t m_MaterialId;
+	};
+
+	/// <summary>
+	/// Meshes and materials of two shaders : the first one with two variants, one pipeline per variant.
+	/// </summary>
+	struct Scene
+	{
+		explicit Scene(Engine::RhiDevice& pDevice, const uint32_t pMeshCount = 4)
+		{
+			Engine::RhiPipelineDesc desc;
+			desc.RootParameters = {{Engine::RhiRootParameterType::Constants}, {Engine::RhiRootParameterType::ShaderResource}};
+			for (uint32_t i = 0; i < 3; ++i)
+				Pipelines.push_back(pDevice.CreatePipeline(desc));
+
+			for (uint32_t i = 0; i < pMeshCount; ++i)
+				Meshes.push_back(std::make_unique<TestMesh>(i));
+			for (uint32_t i = 0; i < 10; ++i)
+				Materials.push_back(std::make_unique<TestMaterial>(*Pipelines[0], 0, 0, i));
+			Materials.push_back(std::make_unique<TestMaterial>(*Pipelines[1], 0, 1, 10));
+			Materials.push_back(std::make_unique<TestMaterial>(*Pipelines[1], 0, 1, 11));
+			Materials.push_back(std::make_unique<TestMaterial>(*Pipelines[2], 1, 0, 12));
+		}
+
+		std::vector<std::unique_ptr<Engine::RhiPipeline>> Pipelines;
+		std::vector<std::unique_ptr<TestMesh>> Meshes;
+		std::vector<std::unique_ptr<TestMaterial>> Materials;
+	};
+
+	struct Draw
+	{
+		uint32_t Mesh;
+		uint32_t Material;
+		float Depth;
+	};
+
+	std::vector<Draw> MakeDraws(const Scene& pScene, const uint32_t pCount, const uint32_t pSeed)
+	{
+		Tests::Random random(pSeed);
+		std::vector<Draw> draws(pCount);
+		for (Draw& draw : draws)
+		{
+			draw.Mesh = random.Next(static_cast<uint32_t>(pScene.Meshes.size()));
+			draw.Material = random.Next(static_cast<uint32_t>(pScene.Materials.size()));
+			draw.Depth = random.Range(0.f, 500.f);
+		}
+		return draws;
+	}
+
+	// Object i is draw i, what the draw queue writes as the instance's object id.
+	void Submit(Engine::DrawQueue& pQueue, const Scene& pScene, const std::vector<Draw>& pDraws)
+	{
+		for (uint32_t i = 0; i < pDraws.size(); ++i)
+			pQueue.Submit(pScene.Meshes[pDraws[i].Mesh].get(), pScene.Materials[pDraws[i].Material].get(), i,
+			              pDraws[i].Depth);
+	}
+
+	uint64_t DepthKey(const float pDepth)
+	{
+		return Engine::DrawQueue::MakeKey(Engine::DrawPass::Opaque, 0, 0, 0, pDepth);
+	}
+
+	struct RecordedDraw
+	{
+		const void* Pipeline;
+		Engine::RhiGpuAddress VertexBuffer;
+		Engine::RhiGpuAddress Instances;
+		uint32_t FirstInstance;
+		uint32_t InstanceCount;
+
+		auto Tie() const { return std::tie(Pipeline, VertexBuffer, Instances, FirstInstance, InstanceCount); }
+	};
+
+	/// <summary>
+	/// Replays the lists one after the other from an empty state.
+	/// </summary>
+	std::vector<RecordedDraw> Replay(const std::vector<const Engine::NullRhiCommandList*>& pLists)
+	{
+		std::vector<RecordedDraw> draws;
+		for (const Engine::NullRhiCommandList* list : pLists)
+		{
+			RecordedDraw state = {};
+			for (const Engine::NullRhiCommand& command : list->GetCommands())
+			{
+				switch (command.Type)
+				{
+				case Engine::NullRhiCommandType::SetPipeline:
+				case Engine::NullRhiCommandType::SetPipelineState:
+					state.Pipeline = command.Object;
+					break;
+				case Engine::NullRhiCommandType::SetVertexBuffer:
+					state.VertexBuffer = command.Args[0];
+					break;
+				case Engine::NullRhiCommandType::SetRootShaderResource:
+					state.Instances = command.Args[0];
+					break;
+				case Engine::NullRhiCommandType::SetRootConstant:
+					state.FirstInstance = static_cast<uint32_t>(command.Args[0]);
+					break;
+				case Engine::NullRhiCommandType::DrawIndexedInstanced:
+					state.InstanceCount = static_cast<uint32_t>(command.Args[1]);
+					draws.push_back(state);
+					break;
+				default:
+					break;
+				}
+			}
+		}
+		return draws;
+	}
+
+	/// <returns> The instances the draw queue wrote at pAddress, read back through the upload ring's page. </returns>
+	std::vector<Engine::InstanceData> ReadInstances(Engine::UploadRing& pUploadRing, const Engine::RhiGpuAddress pAddress,
+	                                                const size_t pCount)
+	{
+		// The next allocation of the frame is in the same page, right after the instances.
+		const Engine::UploadAllocation next = pUploadRing.Allocate(16);
+		std::vector<Engine::InstanceData> instances(pCount);
+		const auto& storage = static_cast<Engine::NullRhiBuffer*>(next.Buffer)->GetStorage();
+		std::memcpy(instances.data(), storage.data() + (pAddress - next.Buffer->GetGpuAddress()),
+		            pCount * sizeof(Engine::InstanceData));
+		return instances;
+	}
+}
+
+// Draws of the same mesh, shader and variant become one instanced draw whatever their material, every object is
+// drawn once with its mesh, pipeline and material id, and the instances of a draw go front to back.
+TEST(DrawQueue_MergesDrawsOfTheSameMeshShaderAndVariant)
+{
+	const ScopedDevice scopedDevice;
+	Engine::NullRhiDevice& device = scopedDevice.Get();
+	Engine::UploadRing uploadRing(device, k_FrameCount);
+	const Scene scene(device);
+	const std::vector<Draw> draws = MakeDraws(scene, 5000, 3);
+
+	std::set<std::tuple<uint32_t, uint32_t, Engine::ShaderVariantKey>> groups;
+	for (const Draw& draw : draws)
+	{
+		const TestMaterial& material = *scene.Materials[draw.Material];
+		groups.insert({draw.Mesh, material.GetShaderSortId(), material.SelectVariant()});
+	}
+
+	for (const bool isEnabled : {true, false})
+	{
+		Engine::DrawQueue queue;
+		queue.SetEnabled(isEnabled);
+		uploadRing.BeginFrame(0);
+		auto& list = static_cast<Engine::NullRhiCommandList&>(device.GetCommandList());
+		list.Begin(device.GetCommandAllocator());
+		Submit(queue, scene, draws);
+		queue.Flush(list, uploadRing);
+		list.End();
+
+		const Engine::DrawQueue::Stats& stats = queue.GetStats();
+		CHECK(stats.SubmittedDraws == draws.size());
+		CHECK(stats.DrawCalls == (isEnabled ? groups.size() : draws.size()));
+		CHECK(stats.ListCount == 1);
+
+		const std::vector<RecordedDraw> recorded = Replay({&list});
+		CHECK(recorded.size() == stats.DrawCalls);
+		const std::vector<Engine::InstanceData> instances =
+			ReadInstances(uploadRing, recorded.empty() ? 0 : recorded[0].Instances, draws.size());
+
+		std::vector<uint32_t> drawnCount(draws.size());
+		uint32_t nextInstance = 0;
+		uint32_t wrongInstances = 0;
+		for (const RecordedDraw& drawCall : recorded)
+		{
+			// The draws cover the instances in order.
+			CHECK(drawCall.FirstInstance == nextInstance);
+			nextInstance += drawCall.InstanceCount;
+			// Depths as the sort key keeps them, the draws of a same key stay in submission order.
+			uint64_t previousDepth = 0;
+			for (uint32_t i = drawCall.FirstInstance; i < drawCall.FirstInstance + drawCall.InstanceCount; ++i)
+			{
+				const Engine::InstanceData& instance = instances[i];
+				const Draw& draw = draws[instance.ObjectId];
+				const TestMaterial& material = *scene.Materials[draw.Material];
+				if (&material.GetPipeline() != drawCall.Pipeline || instance.MaterialId != material.GetMaterialId() ||
+					scene.Meshes[draw.Mesh]->GetVertexBuffer().Address != drawCall.VertexBuffer ||
+					DepthKey(draw.Depth) < previousDepth)
+					++wrongInstances;
+				previousDepth = DepthKey(draw.Depth);
+				++drawnCount[instance.ObjectId];
+			}
+		}
+		CHECK(nextInstance == draws.size());
+		CHECK(wrongInstances == 0);
+		CHECK(std::all_of(drawnCount.begin(), drawnCount.end(), [](const uint32_t pCount) { return pCount == 1; }));
+	}
+
+	// Nothing submitted, nothing recorded.
+	Engine::DrawQueue queue;
+	auto& list = static_cast<Engine::NullRhiCommandList&>(device.GetCommandList());
+	list.Begin(device.GetCommandAllocator());
+	queue.Flush(list, uploadRing);
+	list.End();
+	CHECK(list.GetCommands().empty());
+	CHECK(queue.GetStats().DrawCalls == 0);
+}
+
+// The draw calls split over the pool's lists on 1 to 4 threads replay as the ones recorded into a single list.
+TEST(DrawQueue_RecordsTheSameDrawsInParallel)
+{
+	const ScopedDevice scopedDevice;
+	Engine::NullRhiDevice& device = scopedDevice.Get();
+	// Enough meshes for several lists of Engine::DrawQueue::k_MinDrawCallsPerList draw calls.
+	const Scene scene(device, 200);
+	const std::vector<Draw> draws = MakeDraws(scene, 20000, 11);
+
+	for (const uint32_t threadCount : {1u, 2u, 4u})
+	{
+		Engine::JobSystem::Initialize(threadCount - 1);
+		Engine::UploadRing uploadRing(device, k_FrameCount);
+		Engine::CommandListPool pool(device, k_FrameCount, Engine::JobSystem::GetThreadCount());
+		Engine::DrawQueue queue;
+
+		uploadRing.BeginFrame(0);
+		auto& list = static_cast<Engine::NullRhiCommandList&>(device.GetCommandList());
+		list.Begin(device.GetCommandAllocator());
+		Submit(queue, scene, draws);
+		queue.Flush(list, uploadRing);
+		list.End();
+		std::vector<RecordedDraw> expected = Replay({&list});
+
+		pool.BeginFrame(1);
+		uploadRing.BeginFrame(1);
+		Submit(queue, scene, draws);
+		const uint32_t listCount = queue.Flush(pool, uploadRing, [](Engine::RhiCommandList& pList)
+		{
+			pList.SetRenderTarget(nullptr, nullptr);
+		});
+		CHECK(listCount == queue.GetStats().ListCount);
+		CHECK(listCount == threadCount);
+
+		std::vector<const Engine::NullRhiCommandList*> lists;
+		for (uint32_t i = 0; i < listCount; ++i)
+			lists.push_back(&static_cast<const Engine::NullRhiCommandList&>(pool.GetList(i)));
+		const std::vector<RecordedDraw> recorded = Replay(lists);
+
+		// Each flush wrote its instances at its own address.
+		CHECK(recorded.size() == expected.size());
+		for (size_t i = 0; i < (std::min)(recorded.size(), expected.size()); ++i)
+		{
+			expected[i].Instances = recorded[i].Instances;
+			CHECK(recorded[i].Tie() == expected[i].Tie());
+		}
+		Engine::JobSystem::Shutdown();
+	}
+}
+
+// 10,000 spheres over ten materials of one shader and variant, plus two other objects, flushed through the
+// command list pool as DirectXApi::EndFrame() does, instanced then with one draw call per object.
+BENCHMARK(DrawQueue_Instancing10k)
+{
+	const ScopedDevice scopedDevice;
+	Engine::NullRhiDevice& device = scopedDevice.Get();
+	Engine::JobSystem::Initialize();
+	const Scene scene(device, 2);
+
+	std::vector<Draw> draws = MakeDraws(scene, 10002, 17);
+	for (uint32_t i = 0; i < 10000; ++i)
+		draws[i] = {0, i % 10, draws[i].Depth};
+	draws[10000] = {1, 10, 1.f};
+	draws[10001] = {1, 12, 2.f};
+
+	constexpr uint32_t warmupFrames = 10;
+	constexpr uint32_t frames = 100;
+	for (const bool isEnabled : {true, false})
+	{
+		Engine::UploadRing uploadRing(device, k_FrameCount);
+		Engine::CommandListPool pool(device, k_FrameCount, Engine::JobSystem::GetThreadCount());
+		Engine::DrawQueue queue;
+		queue.SetEnabled(isEnabled);
+
+		double seconds = 0.0;
+		uint64_t drawCalls = 0;
+		uint64_t stateChanges = 0;
+		for (uint32_t frame = 0; frame < warmupFrames + frames; ++frame)
+		{
+			const double start = Tests::GetTime();
+			uploadRing.BeginFrame(frame % k_FrameCount);
+			pool.BeginFrame(frame % k_FrameCount);
+			Submit(queue, scene, draws);
+			const uint32_t listCount = queue.Flush(pool, uploadRing, [](Engine::RhiCommandList&) {});
+			if (frame < warmupFrames)
+				continue;
+
+			seconds += Tests::GetTime() - start;
+			drawCalls += queue.GetStats().DrawCalls;
+			for (uint32_t i = 0; i < listCount; ++i)
+				stateChanges += static_cast<const Engine::NullRhiCommandList&>(pool.GetList(i)).GetStats().GetBindCount();
+		}
+		printf("    %s : %.0f draw calls, %.0f state changes, %.3f ms per frame\n",
+		       isEnabled ? "instanced" : "one draw call per object", static_cast<double>(drawCalls) / frames,
+		       static_cast<double>(stateChanges) / frames, seconds * 1000.0 / frames);
+	}
+
+	Engine::JobSystem::Shutdown();
+}
@@ -0,0 +1,79 @@
+#include "Test.h"
+
+#include <algorithm>
+
+#include "Renderer/FramePacer.h"
+#include "Renderer/RHI/NullRhi.h"
+
+// The null queue's GPU runs pLatency frames behind : the pacer waits every frame once that reaches the
+// frame count, never before.
+TEST(FramePacer_WaitsOnlyWhenTheGpuIsAFrameCountBehind)
+{
+	for (uint32_t frameCount = 1; frameCount <= 4; ++frameCount)
+	{
+		for (uint32_t latency = 0; latency <= 5; ++latency)
+		{
+			Engine::NullRhiDevice device;
+			auto& queue = static_cast<Engine::NullRhiCommandQueue&>(device.GetQueue(Engine::RhiQueueType::Graphics));
+			queue.SetLatency(latency);
+
+			Engine::FramePacer pacer(device, frameCount);
+			constexpr uint32_t frames = 50;
+			for (uint32_t frame = 0; frame < frames; ++frame)
+			{
+				CHECK(pacer.GetFrameIndex() == frame % frameCount);
+				pacer.BeginFrame();
+				pacer.EndFrame(queue);
+			}
+
+			const Engine::FramePacer::Stats& stats = pacer.GetStats();
+			CHECK(stats.FrameCount == frames);
+			CHECK(stats.WaitCount == (latency >= frameCount ? frames - frameCount : 0));
+			CHECK(stats.MaxFramesInFlight == (std::min)(latency, frameCount));
+		}
+	}
+}
+
+// The GPU speeds up and slows down at random. Tracks the frames in flight on the side : a signal completes once
+// latency newer ones are queued, and the pacer must wait exactly when the frame reusing a slot is still queued.
+TEST(FramePacer_FollowsAVaryingGpu)
+{
+	Engine::NullRhiDevice device;
+	auto& queue = static_cast<Engine::NullRhiCommandQueue&>(device.GetQueue(Engine::RhiQueueType::Graphics));
+	constexpr uint32_t frameCount = 3;
+	Engine::FramePacer pacer(device, frameCount);
+
+	Tests::Random random(4);
+	uint32_t inFlight = 0;
+	uint64_t waitCount = 0;
+	uint32_t maxInFlight = 0;
+	for (uint32_t frame = 0; frame < 10000; ++frame)
+	{
+		const uint32_t latency = random.Next(6);
+		queue.SetLatency(latency);
+		inFlight = (std::min)(inFlight, latency);
+
+		pacer.BeginFrame();
+		CHECK(pacer.GetStats().FramesInFlight == inFlight);
+		maxInFlight = (std::max)(maxInFlight, inFlight);
+		if (inFlight >= frameCount)
+		{
+			++waitCount;
+			inFlight = frameCount - 1;
+		}
+		CHECK(pacer.GetStats().WaitCount == waitCount);
+
+		pacer.EndFrame(queue);
+		inFlight = (std::min)(inFlight + 1, latency);
+	}
+
+	CHECK(pacer.GetStats().MaxFramesInFlight == maxInFlight);
+	CHECK(maxInFlight == frameCount);
+	CHECK(waitCount > 0);
+
+	// Nothing is left in flight once the pacer waited for the GPU.
+	pacer.WaitIdle();
+	queue.SetLatency(frameCount);
+	pacer.BeginFrame();
+	CHECK(pacer.GetStats().FramesInFlight == 0);
+}
@@ -0,0 +1,182 @@
+#include "Test.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+#include "Renderer/GpuObjectTable.h"
+#include "Renderer/UploadRing.h"
+#include "Renderer/RHI/NullRhi.h"
+
+namespace
+{
+	constexpr uint32_t k_FrameCount = 3;
+
+	// A table updated and executed every frame on the null RHI, whose default buffers hold what was copied to them.
+	class TableScene
+	{
+	public:
+		explicit TableScene(const uint32_t pInitialCapacity)
+			: m_Ring(m_Device, k_FrameCount), m_Table(m_Device, k_FrameCount, pInitialCapacity)
+		{
+		}
+
+		Engine::GpuObjectTable& GetTable() { return m_Table; }
+
+		void Frame(const Engine::WorldPosition& pCamera)
+		{
+			Engine::RhiCommandList& commandList = m_Device.GetCommandList();
+			commandList.Begin(m_Device.GetCommandAllocator());
+			m_Ring.BeginFrame(m_FrameNumber++ % k_FrameCount);
+			m_Table.Update(commandList, m_Ring, pCamera);
+			commandList.End();
+
+			Engine::RhiCommandList* lists[] = {&commandList};
+			m_Device.GetQueue(Engine::RhiQueueType::Graphics).Execute(lists, 1);
+		}
+
+		/// <returns> The number of registered transforms whose element differs from their matrix. </returns>
+		uint32_t CountMismatches(const std::vector<std::unique_ptr<Engine::Transform>>& pTransforms,
+		                         const std::vector<uint32_t>& pIds)
+		{
+			const auto& storage = static_cast<const Engine::NullRhiBuffer&>(m_Table.GetBuffer()).GetStorage();
+			uint32_t mismatches = 0;
+			for (size_t i = 0; i < pTransforms.size(); ++i)
+			{
+				if (pIds[i] == Engine::GpuObjectTable::k_InvalidId)
+					continue;
+
+				Engine::GpuObjectData expected;
+				DirectX::XMStoreFloat4x4(&expected.World, DirectX::XMMatrixTranspose(
+					                         pTransforms[i]->GetWorldRelativeTo(m_Table.GetOrigin())));
+				if (std::memcmp(storage.data() + static_cast<size_t>(pIds[i]) * sizeof(Engine::GpuObjectData), &expected,
+				                sizeof(expected)) != 0)
+					++mismatches;
+			}
+			return mismatches;
+		}
+
+	private:
+		Engine::NullRhiDevice m_Device;
+		Engine::UploadRing m_Ring;
+		Engine::GpuObjectTable m_Table;
+		uint32_t m_FrameNumber = 0;
+	};
+
+	Engine::WorldPosition RandomPosition(Tests::Random& pRandom)
+	{
+		return {pRandom.Range(-500.f, 500.f), pRandom.Range(-10.f, 10.f), pRandom.Range(-500.f, 500.f)};
+	}
+}
+
+// Objects move, come and go, the table grows and the camera travels far enough to rebase it : after every
+// frame the table holds every registered object's matrix.
+TEST(GpuObjectTable_MatchesTheTransforms)
+{
+	// The transforms outlive the table, which stops listening to them when it is destroyed.
+	std::vector<std::unique_ptr<Engine::Transform>> transforms;
+	std::vector<uint32_t> ids;
+	TableScene scene(64);
+	Engine::GpuObjectTable& table = scene.GetTable();
+
+	Tests::Random random(7);
+	Engine::WorldPosition camera;
+	for (uint32_t frame = 0; frame < 200; ++frame)
+	{
+		for (uint32_t i = 0; i < 20; ++i)
+		{
+			transforms.push_back(std::make_unique<Engine::Transform>());
+			transforms.back()->SetPosition(RandomPosition(random));
+			ids.push_back(table.Register(transforms.back().get()));
+		}
+		for (uint32_t i = 0; i < 30; ++i)
+		{
+			Engine::Transform& transform = *transforms[random.Next(static_cast<uint32_t>(transforms.size()))];
+			if (random.Next(2))
+				transform.Translate(random.Range(-1.f, 1.f), 0.f, random.Range(-1.f, 1.f));
+			else
+				transform.Rotate(random.Range(-0.1f, 0.1f), 0.f, 0.f);
+		}
+		for (uint32_t i = 0; i < 5; ++i)
+		{
+			const uint32_t object = random.Next(static_cast<uint32_t>(transforms.size()));
+			table.Unregister(ids[object]);
+			ids[object] = Engine::GpuObjectTable::k_InvalidId;
+		}
+
+		camera.x += 100.0;
+		scene.Frame(camera);
+		CHECK(scene.CountMismatches(transforms, ids) == 0);
+		CHECK(table.GetStats().UploadedBytes == table.GetStats().UpdatedObjects * sizeof(Engine::GpuObjectData));
+	}
+
+	// Room for 64 objects at first, 4000 registered and some of them unregistered, their ids reused.
+	std::vector<uint32_t> liveIds;
+	std::copy_if(ids.begin(), ids.end(), std::back_inserter(liveIds),
+	             [](const uint32_t pId) { return pId != Engine::GpuObjectTable::k_InvalidId; });
+	std::sort(liveIds.begin(), liveIds.end());
+	CHECK(std::adjacent_find(liveIds.begin(), liveIds.end()) == liveIds.end());
+	CHECK(table.GetStats().ObjectCount == liveIds.size());
+	CHECK(liveIds.back() < 4000 - 100);
+	CHECK(table.GetStats().CapacityBytes >= liveIds.size() * sizeof(Engine::GpuObjectData));
+	// The camera went 20 km away.
+	CHECK(table.GetOrigin().x > 10000.0);
+
+	// Nothing moved : nothing is uploaded.
+	scene.Frame(camera);
+	CHECK(table.GetStats().UploadedBytes == 0);
+	CHECK(table.GetStats().RangeCount == 0);
+}
+
+// 1% of 100k objects move every frame, the table only uploads them and the few still objects merged between
+// them.
+TEST(GpuObjectTable_UploadsTheMovedObjects)
+{
+	constexpr uint32_t objectCount = 100000;
+	constexpr uint32_t movedCount = objectCount / 100;
+
+	std::vector<std::unique_ptr<Engine::Transform>> transforms;
+	std::vector<uint32_t> ids;
+	TableScene scene(objectCount);
+	Engine::GpuObjectTable& table = scene.GetTable();
+	Tests::Random random(8);
+	for (uint32_t i = 0; i < objectCount; ++i)
+	{
+		transforms.push_back(std::make_unique<Engine::Transform>());
+		transforms.back()->SetPosition(RandomPosition(random));
+		ids.push_back(table.Register(transforms.back().get()));
+	}
+	scene.Frame({});
+	CHECK(table.GetStats().UploadedBytes == objectCount * sizeof(Engine::GpuObjectData));
+
+	// Scattered movers, then a contiguous block of them.
+	uint64_t scatteredBytes = 0;
+	uint32_t scatteredRanges = 0;
+	constexpr uint32_t frames = 16;
+	for (uint32_t frame = 0; frame < frames; ++frame)
+	{
+		for (uint32_t i = 0; i < movedCount; ++i)
+			transforms[random.Next(objectCount)]->Translate(0.f, 0.01f, 0.f);
+		scene.Frame({});
+		scatteredBytes += table.GetStats().UploadedBytes;
+		scatteredRanges += table.GetStats().RangeCount;
+		CHECK(table.GetStats().UpdatedObjects >= movedCount * 9 / 10);
+		CHECK(table.GetStats().UpdatedObjects <= movedCount * 2);
+	}
+	CHECK(scene.CountMismatches(transforms, ids) == 0);
+
+	for (uint32_t i = 0; i < movedCount; ++i)
+		transforms[5000 + i]->Translate(0.f, 0.01f, 0.f);
+	scene.Frame({});
+	CHECK(table.GetStats().UpdatedObjects == movedCount);
+	CHECK(table.GetStats().RangeCount == 1);
+
+	std::printf("    1%% of %u objects moving : %llu bytes in %u copies per frame scattered, %llu bytes in %u copy "
+	            "contiguous, instead of %llu bytes\n", objectCount,
+	            static_cast<unsigned long long>(scatteredBytes / frames), scatteredRanges / frames,
+	            static_cast<unsigned long long>(table.GetStats().UploadedBytes), table.GetStats().RangeCount,
+	            static_cast<unsigned long long>(objectCount * sizeof(Engine::GpuObjectData)));
+}
@@ -0,0 +1,299 @@
+#include "Test.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "Core/JobSystem.h"
+#include "Renderer/MeshMerger.h"
+
+namespace
+{
+	// Laid out as Engine::VertexLit : the bytes around the position and the normal are copied as they are.
+	struct LitVertex
+	{
+		DirectX::XMFLOAT3 Position;
+		float Uv[2];
+		DirectX::XMFLOAT3 Normal;
+		uint32_t Material;
+	};
+
+	struct ColorVertex
+	{
+		uint32_t Id;
+		DirectX::XMFLOAT3 Position;
+		uint32_t Color;
+	};
+
+	// The vertices and indices a MergeSource points to.
+	template <typename T>
+	struct Source
+	{
+		std::vector<T> Vertices;
+		std::vector<uint32_t> Indices;
+		DirectX::XMFLOAT3 Scale = {1.f, 1.f, 1.f};
+		DirectX::XMFLOAT4 Rotation = {0.f, 0.f, 0.f, 1.f};
+		DirectX::XMFLOAT3 Translation = {0.f, 0.f, 0.f};
+
+		Engine::MergeSource Get() const
+		{
+			using namespace DirectX;
+
+			Engine::MergeSource source = {
+				reinterpret_cast<const uint8_t*>(Vertices.data()), static_cast<uint32_t>(Vertices.size()),
+				Indices.data(), static_cast<uint32_t>(Indices.size())
+			};
+			XMStoreFloat4x4(&source.Transform, XMMatrixMultiply(
+				                XMMatrixMultiply(XMMatrixScaling(Scale.x, Scale.y, Scale.z),
+				                                 XMMatrixRotationQuaternion(XMLoadFloat4(&Rotation))),
+				                XMMatrixTranslation(Translation.x, Translation.y, Translation.z)));
+			return source;
+		}
+	};
+
+	DirectX::XMFLOAT3 RandomFloat3(Tests::Random& pRandom, const float pMin, const float pMax)
+	{
+		return {pRandom.Range(pMin, pMax), pRandom.Range(pMin, pMax), pRandom.Range(pMin, pMax)};
+	}
+
+	Source<LitVertex> MakeLitSource(Tests::Random& pRandom, const uint32_t pVertexCount, const uint32_t pTriangleCount)
+	{
+		using namespace DirectX;
+
+		Source<LitVertex> source;
+		source.Vertices.resize(pVertexCount);
+		for (LitVertex& vertex : source.Vertices)
+		{
+			vertex.Position = RandomFloat3(pRandom, -10.f, 10.f);
+			vertex.Uv[0] = pRandom.Range(0.f, 1.f);
+			vertex.Uv[1] = pRandom.Range(0.f, 1.f);
+			XMStoreFloat3(&vertex.Normal, XMVector3Normalize(XMLoadFloat3(&vertex.Position)));
+			vertex.Material = pRandom.Next();
+		}
+		source.Indices.resize(3 * pTriangleCount);
+		for (uint32_t& index : source.Indices)
+			index = pRandom.Next(pVertexCount);
+
+		source.Scale = RandomFloat3(pRandom, 0.5f, 3.f);
+		XMStoreFloat4(&source.Rotation, XMQuaternionRotationRollPitchYaw(
+			              pRandom.Range(-3.f, 3.f), pRandom.Range(-3.f, 3.f), pRandom.Range(-3.f, 3.f)));
+		source.Translation = RandomFloat3(pRandom, -100.f, 100.f);
+		return source;
+	}
+
+	template <typename T>
+	std::vector<Engine::MergeSource> GetSources(const std::vector<Source<T>>& pSources)
+	{
+		std::vector<Engine::MergeSource> sources;
+		for (const Source<T>& source : pSources)
+			sources.push_back(source.Get());
+		return sources;
+	}
+
+	bool IsNear(const DirectX::XMFLOAT3& pA, const DirectX::XMFLOAT3& pB, const float pEpsilon)
+	{
+		return std::abs(pA.x - pB.x) <= pEpsilon && std::abs(pA.y - pB.y) <= pEpsilon && std::abs(pA.z - pB.z) <= pEpsilon;
+	}
+
+	uint32_t GetIndex(const Engine::MergedMesh& pMesh, const size_t pIndex)
+	{
+		return pMesh.Indices32.empty() ? pMesh.Indices16[pIndex] : pMesh.Indices32[pIndex];
+	}
+
+	// Checks each source's slice of pMesh against it, the transform applied step by step rather than as a matrix :
+	// the vertices come at the source's base vertex, the indices at its start index, moved by the base vertex and
+	// with the winding flipped when the scale mirrors. Returns the sources whose slice does not match.
+	uint32_t CountBrokenSources(const Engine::MergedMesh& pMesh, const std::vector<Source<LitVertex>>& pSources)
+	{
+		using namespace DirectX;
+
+		uint32_t broken = 0;
+		uint32_t baseVertex = 0;
+		size_t startIndex = 0;
+		for (const Source<LitVertex>& source : pSources)
+		{
+			const XMVECTOR scale = XMLoadFloat3(&source.Scale);
+			const XMVECTOR rotation = XMLoadFloat4(&source.Rotation);
+			const bool isMirrored = source.Scale.x * source.Scale.y * source.Scale.z < 0.f;
+			bool isIntact = (baseVertex + source.Vertices.size()) * sizeof(LitVertex) <= pMesh.Vertices.size() &&
+				startIndex + source.Indices.size() <= (std::max)(pMesh.Indices16.size(), pMesh.Indices32.size());
+
+			for (size_t i = 0; isIntact && i < source.Vertices.size(); ++i)
+			{
+				const LitVertex& input = source.Vertices[i];
+				LitVertex merged;
+				std::memcpy(&merged, pMesh.Vertices.data() + (baseVertex + i) * sizeof(LitVertex), sizeof(merged));
+
+				XMFLOAT3 position;
+				XMStoreFloat3(&position, XMVectorAdd(XMVector3Rotate(XMVectorMultiply(XMLoadFloat3(&input.Position), scale),
+				                                                     rotation), XMLoadFloat3(&source.Translation)));
+				// Scaling the normal by the inverse scale keeps it perpendicular to the scaled surface.
+				XMFLOAT3 normal;
+				XMStoreFloat3(&normal, XMVector3Normalize(XMVector3Rotate(
+					              XMVectorMultiply(XMLoadFloat3(&input.Normal),
+					                               XMVectorSet(1.f / source.Scale.x, 1.f / source.Scale.y,
+					                                           1.f / source.Scale.z, 0.f)), rotation)));
+				isIntact = IsNear(merged.Position, position, 1e-3f) && IsNear(merged.Normal, normal, 1e-4f) &&
+					merged.Uv[0] == input.Uv[0] && merged.Uv[1] == input.Uv[1] && merged.Material == input.Material;
+			}
+			for (size_t i = 0; isIntact && i < source.Indices.size(); i += 3)
+			{
+				isIntact = GetIndex(pMesh, startIndex + i) == baseVertex + source.Indices[i] &&
+					GetIndex(pMesh, startIndex + i + 1) == baseVertex + source.Indices[i + (isMirrored ? 2 : 1)] &&
+					GetIndex(pMesh, startIndex + i + 2) == baseVertex + source.Indices[i + (isMirrored ? 1 : 2)];
+			}
+
+			broken += isIntact ? 0 : 1;
+			baseVertex += static_cast<uint32_t>(source.Vertices.size());
+			startIndex += source.Indices.size();
+		}
+		return broken;
+	}
+}
+
+// Sources under translations, rotations, non uniform scales and mirrors, merged one after the other : each keeps
+// its own index range moved by its base vertex, its positions and normals transformed, its other bytes untouched.
+TEST(MeshMerger_BakesTransformsIntoIndexRanges)
+{
+	Tests::Random random(21);
+	std::vector<Source<LitVertex>> sources;
+	for (uint32_t i = 0; i < 12; ++i)
+	{
+		sources.push_back(MakeLitSource(random, 1 + random.Next(200), 1 + random.Next(300)));
+		// One source in three is mirrored along one axis, one in six along all three.
+		if (i % 3 == 0)
+			sources.back().Scale.y = -sources.back().Scale.y;
+		if (i % 6 == 0)
+			sources.back().Scale = {-sources.back().Scale.x, sources.back().Scale.y, -sources.back().Scale.z};
+	}
+	const std::vector<Engine::MergeSource> mergeSources = GetSources(sources);
+
+	const Engine::MergeVertexFormat format = Engine::MergeVertexFormat::Of<LitVertex>();
+	CHECK(format.Stride == sizeof(LitVertex));
+	CHECK(format.NormalOffset == offsetof(LitVertex, Normal));
+	Engine::MergedMesh mesh;
+	Engine::MeshMerger::Merge(mergeSources.data(), mergeSources.size(), format, mesh);
+
+	uint32_t vertexCount = 0;
+	size_t indexCount = 0;
+	for (const Source<LitVertex>& source : sources)
+	{
+		vertexCount += static_cast<uint32_t>(source.Vertices.size());
+		indexCount += source.Indices.size();
+	}
+	CHECK(mesh.VertexCount == vertexCount);
+	CHECK(mesh.Vertices.size() == vertexCount * sizeof(LitVertex));
+	CHECK(mesh.Indices16.size() == indexCount);
+	CHECK(mesh.Indices32.empty());
+	CHECK(CountBrokenSources(mesh, sources) == 0);
+}
+
+// Up to Engine::MeshMerger::k_Max16BitVertices vertices the indices take 16 bits, above they take 32 and still
+// reach the vertices of the last source.
+TEST(MeshMerger_Switches32BitIndicesAboveTheLimit)
+{
+	Tests::Random random(22);
+	const Engine::MergeVertexFormat format = Engine::MergeVertexFormat::Of<LitVertex>();
+	for (const uint32_t lastVertexCount : {Engine::MeshMerger::k_Max16BitVertices - 40000,
+	                                       Engine::MeshMerger::k_Max16BitVertices - 39999})
+	{
+		std::vector<Source<LitVertex>> sources;
+		sources.push_back(MakeLitSource(random, 40000, 100));
+		sources.push_back(MakeLitSource(random, lastVertexCount, 100));
+		// Indices to the last vertex, 65535 or 65536 once merged.
+		sources.back().Indices[0] = lastVertexCount - 1;
+		const std::vector<Engine::MergeSource> mergeSources = GetSources(sources);
+
+		Engine::MergedMesh mesh;
+		Engine::MeshMerger::Merge(mergeSources.data(), mergeSources.size(), format, mesh);
+		const bool is32Bits = mesh.VertexCount > Engine::MeshMerger::k_Max16BitVertices;
+		CHECK(mesh.Indices16.empty() == is32Bits);
+		CHECK(mesh.Indices32.empty() == !is32Bits);
+		CHECK(GetIndex(mesh, sources[0].Indices.size()) == mesh.VertexCount - 1);
+		CHECK(CountBrokenSources(mesh, sources) == 0);
+	}
+}
+
+// Vertices without a normal, their position not at the start : only the position changes.
+TEST(MeshMerger_TransformsOnlyThePositionWithoutNormal)
+{
+	using namespace DirectX;
+
+	const Engine::MergeVertexFormat format = Engine::MergeVertexFormat::Of<ColorVertex>();
+	CHECK(format.PositionOffset == offsetof(ColorVertex, Position));
+	CHECK(format.NormalOffset == Engine::MergeVertexFormat::k_NoNormal);
+
+	Tests::Random random(23);
+	Source<ColorVertex> source;
+	for (uint32_t i = 0; i < 100; ++i)
+		source.Vertices.push_back({i, RandomFloat3(random, -1.f, 1.f), random.Next()});
+	source.Indices = {0, 1, 2, 97, 98, 99};
+	source.Scale = {2.f, 3.f, 4.f};
+	source.Translation = {5.f, 6.f, 7.f};
+	const Engine::MergeSource mergeSource = source.Get();
+
+	Engine::MergedMesh mesh;
+	Engine::MeshMerger::Merge(&mergeSource, 1, format, mesh);
+	CHECK(mesh.Indices16 == std::vector<uint16_t>({0, 1, 2, 97, 98, 99}));
+	for (uint32_t i = 0; i < 100; ++i)
+	{
+		const ColorVertex& input = source.Vertices[i];
+		ColorVertex merged;
+		std::memcpy(&merged, mesh.Vertices.data() + i * sizeof(ColorVertex), sizeof(merged));
+		const XMFLOAT3 position = {input.Position.x * 2.f + 5.f, input.Position.y * 3.f + 6.f, input.Position.z * 4.f + 7.f};
+		CHECK(IsNear(merged.Position, position, 1e-5f));
+		CHECK(merged.Id == input.Id);
+		CHECK(merged.Color == input.Color);
+	}
+}
+
+// The same meshes merged on 1, 2 and 4 threads : each mesh is merged by one thread, the results match byte for byte.
+TEST(MeshMerger_MergesTheSameBytesOnAnyThreadCount)
+{
+	Tests::Random random(24);
+	std::vector<std::vector<Source<LitVertex>>> meshSources(37);
+	std::vector<std::vector<Engine::MergeSource>> meshes;
+	for (std::vector<Source<LitVertex>>& sources : meshSources)
+	{
+		const uint32_t sourceCount = 1 + random.Next(8);
+		for (uint32_t i = 0; i < sourceCount; ++i)
+		{
+			sources.push_back(MakeLitSource(random, 1 + random.Next(500), 1 + random.Next(500)));
+			if (random.Next(4) == 0)
+				sources.back().Scale.x = -sources.back().Scale.x;
+		}
+		meshes.push_back(GetSources(sources));
+	}
+	const Engine::MergeVertexFormat format = Engine::MergeVertexFormat::Of<LitVertex>();
+
+	std::vector<Engine::MergedMesh> expected;
+	for (const uint32_t threadCount : {1u, 2u, 4u})
+	{
+		// JobSystem::Initialize(0) starts one worker per hardware thread : a single thread is the JobSystem stopped.
+		if (threadCount > 1)
+			Engine::JobSystem::Initialize(threadCount - 1);
+		CHECK(Engine::JobSystem::GetThreadCount() == threadCount);
+
+		std::vector<Engine::MergedMesh> merged;
+		Engine::MeshMerger::MergeAll(meshes, format, merged);
+		CHECK(merged.size() == meshes.size());
+		if (expected.empty())
+		{
+			expected = std::move(merged);
+			for (size_t i = 0; i < expected.size(); ++i)
+				CHECK(CountBrokenSources(expected[i], meshSources[i]) == 0);
+		}
+		else
+		{
+			for (size_t i = 0; i < (std::min)(merged.size(), expected.size()); ++i)
+			{
+				CHECK(merged[i].VertexCount == expected[i].VertexCount);
+				CHECK(merged[i].Vertices == expected[i].Vertices);
+				CHECK(merged[i].Indices16 == expected[i].Indices16);
+				CHECK(merged[i].Indices32 == expected[i].Indices32);
+			}
+		}
+		Engine::JobSystem::Shutdown();
+	}
+}
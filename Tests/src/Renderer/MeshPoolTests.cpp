@@ -0,0 +1,198 @@
+#include "Test.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "Renderer/MeshPool.h"
+#include "Renderer/UploadManager.h"
+#include "Renderer/RHI/NullRhi.h"
+
+namespace
+{
+	constexpr uint32_t k_FrameCount = 2;
+
+	struct Vertex
+	{
+		uint32_t Mesh;
+		uint32_t Index;
+		uint32_t Random[2];
+
+		bool operator==(const Vertex&) const = default;
+	};
+
+	struct Mesh
+	{
+		Engine::MeshPool::Handle Handle = Engine::MeshPool::k_InvalidHandle;
+		std::vector<Vertex> Vertices;
+		std::vector<uint16_t> Indices;
+	};
+
+	Mesh MakeMesh(Tests::Random& pRandom, const uint32_t pId)
+	{
+		Mesh mesh;
+		mesh.Vertices.resize(1 + pRandom.Next(100));
+		for (uint32_t i = 0; i < mesh.Vertices.size(); ++i)
+			mesh.Vertices[i] = {pId, i, {pRandom.Next(), pRandom.Next()}};
+		mesh.Indices.resize(3 * (1 + pRandom.Next(60)));
+		for (uint16_t& index : mesh.Indices)
+			index = static_cast<uint16_t>(pRandom.Next(static_cast<uint32_t>(mesh.Vertices.size())));
+		return mesh;
+	}
+
+	bool TryAllocate(Engine::MeshPool& pPool, Engine::UploadManager& pUploads, Mesh& pMesh)
+	{
+		pMesh.Handle = pPool.Allocate(pUploads, pMesh.Vertices.data(), static_cast<uint32_t>(pMesh.Vertices.size()),
+		                              pMesh.Indices.data(), static_cast<uint32_t>(pMesh.Indices.size()));
+		return pMesh.Handle != Engine::MeshPool::k_InvalidHandle;
+	}
+
+	// A frame as DirectXApi runs it : the uploads are submitted and made visible to the graphics queue, which then
+	// executes the pool's compaction copies.
+	void RunFrame(Engine::NullRhiDevice& pDevice, Engine::UploadManager& pUploads, Engine::MeshPool& pPool,
+	              const bool pCompact = false)
+	{
+		Engine::RhiCommandList& list = pDevice.GetCommandList();
+		list.Begin(pDevice.GetCommandAllocator());
+		if (pCompact)
+			pPool.Compact(list, pPool.GetStats().VertexCapacity, pPool.GetStats().IndexCapacity);
+		else
+			pPool.BeginFrame(list);
+		list.End();
+
+		pUploads.Submit();
+		Engine::RhiCommandQueue& queue = pDevice.GetQueue(Engine::RhiQueueType::Graphics);
+		pUploads.MakeVisible(queue);
+		Engine::RhiCommandList* lists[] = {&list};
+		queue.Execute(lists, 1);
+	}
+
+	// Draws every mesh as the GPU would, from the pool's current buffers : each index, relative to the base vertex,
+	// has to reach the vertex it pointed to in the source mesh. Returns the meshes that do not.
+	uint32_t CountBrokenMeshes(const Engine::MeshPool& pPool, const std::vector<Mesh>& pMeshes)
+	{
+		const auto& vertexStorage = static_cast<const Engine::NullRhiBuffer&>(pPool.GetVertexBuffer()).GetStorage();
+		const auto& indexStorage = static_cast<const Engine::NullRhiBuffer&>(pPool.GetIndexBuffer()).GetStorage();
+		uint32_t broken = 0;
+		for (const Mesh& mesh : pMeshes)
+		{
+			const Engine::MeshPool::Range& range = pPool.GetRange(mesh.Handle);
+			bool isIntact = range.VertexCount == mesh.Vertices.size() && range.IndexCount == mesh.Indices.size() &&
+				(range.BaseVertex + range.VertexCount) * sizeof(Vertex) <= vertexStorage.size() &&
+				(range.StartIndex + range.IndexCount) * sizeof(uint16_t) <= indexStorage.size();
+			for (uint32_t i = 0; isIntact && i < range.IndexCount; ++i)
+			{
+				uint16_t index;
+				std::memcpy(&index, indexStorage.data() + (range.StartIndex + i) * sizeof(uint16_t), sizeof(index));
+				Vertex vertex;
+				std::memcpy(&vertex, vertexStorage.data() + (range.BaseVertex + index) * sizeof(Vertex), sizeof(vertex));
+				isIntact = index == mesh.Indices[i] && vertex == mesh.Vertices[index];
+			}
+			broken += isIntact ? 0 : 1;
+		}
+		return broken;
+	}
+
+	// The vertex and index ranges in use when the pool is packed : back to back from 0.
+	bool IsPacked(const Engine::MeshPool& pPool, const std::vector<Mesh>& pMeshes)
+	{
+		uint64_t vertexEnd = 0;
+		uint64_t indexEnd = 0;
+		for (const Mesh& mesh : pMeshes)
+		{
+			const Engine::MeshPool::Range& range = pPool.GetRange(mesh.Handle);
+			vertexEnd = (std::max)(vertexEnd, static_cast<uint64_t>(range.BaseVertex) + range.VertexCount);
+			indexEnd = (std::max)(indexEnd, static_cast<uint64_t>(range.StartIndex) + range.IndexCount);
+		}
+		const Engine::MeshPool::Stats stats = pPool.GetStats();
+		return vertexEnd == stats.UsedVertices && indexEnd == stats.UsedIndices;
+	}
+}
+
+// Meshes are allocated, freed, allocated again in the holes and compacted, over several frames : every mesh left
+// still draws its own vertices through its base vertex and start index, and the compaction packs them.
+TEST(MeshPool_KeepsMeshesThroughCompaction)
+{
+	Engine::NullRhiDevice device;
+	Engine::UploadManager uploads(device, 1 << 20);
+	Engine::MeshPool pool(device, sizeof(Vertex), k_FrameCount, 6 * 1024, 18 * 1024);
+
+	Tests::Random random(7);
+	std::vector<Mesh> meshes;
+	uint32_t nextId = 0;
+	for (uint32_t round = 0; round < 6; ++round)
+	{
+		for (uint32_t i = 0; i < 40; ++i)
+		{
+			Mesh mesh = MakeMesh(random, nextId++);
+			CHECK(TryAllocate(pool, uploads, mesh));
+			meshes.push_back(std::move(mesh));
+		}
+		RunFrame(device, uploads, pool);
+		CHECK(CountBrokenMeshes(pool, meshes) == 0);
+
+		// About half of the meshes go, their ranges stay in use for the frames in flight.
+		const Engine::MeshPool::Stats beforeFree = pool.GetStats();
+		for (size_t i = meshes.size(); i-- > 0;)
+		{
+			if (random.Next(2) == 0)
+				continue;
+			pool.Free(meshes[i].Handle);
+			meshes.erase(meshes.begin() + static_cast<std::ptrdiff_t>(i));
+		}
+		CHECK(pool.GetStats().UsedVertices == beforeFree.UsedVertices);
+		for (uint32_t frame = 0; frame <= k_FrameCount; ++frame)
+		{
+			RunFrame(device, uploads, pool);
+			CHECK(CountBrokenMeshes(pool, meshes) == 0);
+		}
+		CHECK(pool.GetStats().MeshCount == meshes.size());
+	}
+
+	// The freed ranges left the free space split, BeginFrame() compacted the pool on its own.
+	const uint32_t compactions = pool.GetStats().Compactions;
+	CHECK(compactions > 0);
+	RunFrame(device, uploads, pool, true);
+	const Engine::MeshPool::Stats stats = pool.GetStats();
+	CHECK(stats.Compactions == compactions + 1);
+	CHECK(CountBrokenMeshes(pool, meshes) == 0);
+	CHECK(IsPacked(pool, meshes));
+	CHECK(stats.MovedBytes == stats.UsedVertices * sizeof(Vertex) + stats.UsedIndices * sizeof(uint16_t));
+	CHECK(stats.VertexFragmentation == 0.f);
+	CHECK(stats.IndexFragmentation == 0.f);
+}
+
+// A mesh that does not fit makes the next frame compact into buffers twice as large, the meshes already in move
+// with their data and the mesh fits afterward.
+TEST(MeshPool_GrowsWhenFull)
+{
+	Engine::NullRhiDevice device;
+	Engine::UploadManager uploads(device, 1 << 20);
+	Engine::MeshPool pool(device, sizeof(Vertex), k_FrameCount, 1024, 3 * 1024);
+
+	Tests::Random random(8);
+	std::vector<Mesh> meshes;
+	Mesh rejected;
+	for (uint32_t id = 0; rejected.Vertices.empty(); ++id)
+	{
+		Mesh mesh = MakeMesh(random, id);
+		if (TryAllocate(pool, uploads, mesh))
+			meshes.push_back(std::move(mesh));
+		else
+			rejected = std::move(mesh);
+	}
+	CHECK(pool.GetStats().FailedAllocations == 1);
+
+	RunFrame(device, uploads, pool);
+	const Engine::MeshPool::Stats stats = pool.GetStats();
+	CHECK(stats.Compactions == 1);
+	CHECK(stats.VertexCapacity == 2 * 1024);
+	CHECK(stats.IndexCapacity == 2 * 3 * 1024);
+	CHECK(CountBrokenMeshes(pool, meshes) == 0);
+	CHECK(IsPacked(pool, meshes));
+
+	CHECK(TryAllocate(pool, uploads, rejected));
+	meshes.push_back(std::move(rejected));
+	RunFrame(device, uploads, pool);
+	CHECK(CountBrokenMeshes(pool, meshes) == 0);
+}
@@ -0,0 +1,168 @@
+#include "Test.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "Renderer/PipelineCache.h"
+#include "Renderer/RHI/NullRhi.h"
+
+namespace
+{
+	const uint8_t k_VertexShader[] = {0x44, 0x58, 0x42, 0x43, 1, 2, 3, 4};
+	const uint8_t k_PixelShader[] = {0x44, 0x58, 0x42, 0x43, 5, 6, 7, 8, 9};
+
+	// A lit pipeline as DirectXShader::CreateVariant() describes it.
+	Engine::RhiPipelineDesc MakeDesc(const char* pPosition = "POSITION", const char* pNormal = "NORMAL")
+	{
+		Engine::RhiPipelineDesc desc;
+		desc.InputLayout = {
+			{pPosition, 0, Engine::RhiFormat::R32G32B32Float, 0},
+			{pNormal, 0, Engine::RhiFormat::R32G32B32Float, 12},
+		};
+		desc.VertexShader = {k_VertexShader, sizeof(k_VertexShader)};
+		desc.PixelShader = {k_PixelShader, sizeof(k_PixelShader)};
+		Engine::RhiRootParameter constants;
+		constants.Type = Engine::RhiRootParameterType::Constants;
+		constants.ConstantCount = 4;
+		desc.RootParameters = {constants, Engine::RhiRootParameter()};
+		return desc;
+	}
+
+	uint64_t HashDesc(const Engine::RhiPipelineDesc& pDesc)
+	{
+		std::vector<uint8_t> canonicalDesc;
+		Engine::PipelineCache::GetCanonicalDesc(pDesc, canonicalDesc);
+		return Engine::PipelineCache::Hash(canonicalDesc);
+	}
+
+	std::vector<char> ReadFile(const char* pPath)
+	{
+		std::ifstream file(pPath, std::ios::binary);
+		return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+
+	void WriteFile(const char* pPath, const std::vector<char>& pBytes)
+	{
+		std::ofstream file(pPath, std::ios::binary | std::ios::trunc);
+		file.write(pBytes.data(), static_cast<std::streamsize>(pBytes.size()));
+	}
+}
+
+// The key is what the pipeline is made of, not where its description lives : copies of the semantics and the
+// bytecode hash the same, and every field that changes the pipeline changes the hash.
+TEST(PipelineCache_HashesTheCanonicalDescription)
+{
+	const Engine::RhiPipelineDesc desc = MakeDesc();
+	const uint64_t hash = HashDesc(desc);
+
+	std::string position = "POSITION";
+	std::string normal = "NORMAL";
+	Engine::RhiPipelineDesc copy = MakeDesc(position.c_str(), normal.c_str());
+	const std::vector<uint8_t> vertexShader(std::begin(k_VertexShader), std::end(k_VertexShader));
+	copy.VertexShader = {vertexShader.data(), vertexShader.size()};
+	CHECK(HashDesc(copy) == hash);
+
+	std::vector<Engine::RhiPipelineDesc> variants(10, desc);
+	variants[0].InputLayout[1].Semantic = "TEXCOORD";
+	variants[1].InputLayout[1].Offset = 16;
+	variants[2].InputLayout.pop_back();
+	variants[3].VertexShader.Size -= 1;
+	variants[4].PixelShader = variants[4].VertexShader;
+	variants[5].RootParameters[0].ConstantCount = 5;
+	variants[6].RootParameters[1].ShaderRegister = 1;
+	variants[7].UseStaticSamplers = true;
+	variants[8].RenderTargetFormat = Engine::RhiFormat::R32G32B32A32Float;
+	variants[9].SampleCount = 4;
+
+	std::vector<uint64_t> hashes = {hash};
+	for (const Engine::RhiPipelineDesc& variant : variants)
+		hashes.push_back(HashDesc(variant));
+	std::sort(hashes.begin(), hashes.end());
+	CHECK(std::adjacent_find(hashes.begin(), hashes.end()) == hashes.end());
+
+	// The cache shares a pipeline between equivalent descriptions only.
+	Engine::NullRhiDevice device;
+	Engine::PipelineCache cache(device);
+	Engine::RhiPipeline& pipeline = cache.GetPipeline(desc);
+	CHECK(&cache.GetPipeline(copy) == &pipeline);
+	for (const Engine::RhiPipelineDesc& variant : variants)
+		CHECK(&cache.GetPipeline(variant) != &pipeline);
+
+	const Engine::PipelineCache::Stats& stats = cache.GetStats();
+	CHECK(stats.Requests == 12);
+	CHECK(stats.Hits == 1);
+	CHECK(stats.Misses == 11);
+	CHECK(cache.IsDirty());
+}
+
+// A blob the driver rejects is compiled again and replaced in the file, the other pipelines still come from it.
+// Files cut short or from another version are ignored as a whole.
+TEST(PipelineCache_RebuildsRejectedBlobs)
+{
+	const char* path = "PipelineCacheTests.bin";
+	Engine::NullRhiDevice device;
+	Engine::RhiPipelineDesc descs[2] = {MakeDesc(), MakeDesc()};
+	descs[1].SampleCount = 4;
+
+	{
+		Engine::PipelineCache cache(device);
+		for (const Engine::RhiPipelineDesc& desc : descs)
+			CHECK(!cache.GetPipeline(desc).IsFromCachedBlob());
+		CHECK(cache.Save(path));
+	}
+	{
+		Engine::PipelineCache cache(device);
+		CHECK(cache.Load(path));
+		for (const Engine::RhiPipelineDesc& desc : descs)
+			CHECK(cache.GetPipeline(desc).IsFromCachedBlob());
+		CHECK(cache.GetStats().DiskHits == 2);
+		CHECK(cache.GetStats().GetHitRate() == 1.f);
+		CHECK(!cache.IsDirty());
+	}
+
+	// The null device only takes back the blobs it wrote, as a driver update would reject them.
+	const std::vector<char> bytes = ReadFile(path);
+	const std::vector<uint8_t> blob = Engine::NullRhiPipeline(descs[0], nullptr).GetCachedBlob();
+	std::vector<char> rejected = bytes;
+	const auto found = std::search(rejected.begin(), rejected.end(), blob.begin(), blob.end());
+	CHECK(found != rejected.end());
+	*found ^= 0x20;
+	WriteFile(path, rejected);
+	{
+		Engine::PipelineCache cache(device);
+		CHECK(cache.Load(path));
+		for (const Engine::RhiPipelineDesc& desc : descs)
+			cache.GetPipeline(desc);
+		CHECK(cache.GetStats().DiskHits == 1);
+		CHECK(cache.GetStats().Misses == 1);
+		CHECK(cache.IsDirty());
+		CHECK(cache.Save(path));
+	}
+	{
+		Engine::PipelineCache cache(device);
+		CHECK(cache.Load(path));
+		for (const Engine::RhiPipelineDesc& desc : descs)
+			cache.GetPipeline(desc);
+		CHECK(cache.GetStats().DiskHits == 2);
+	}
+
+	std::vector<char> truncated = ReadFile(path);
+	truncated.resize(truncated.size() - 1);
+	WriteFile(path, truncated);
+	Engine::PipelineCache cache(device);
+	CHECK(!cache.Load(path));
+
+	std::vector<char> outdated = bytes;
+	const uint32_t version = Engine::PipelineCache::k_FileVersion + 1;
+	std::memcpy(outdated.data() + sizeof(uint32_t), &version, sizeof(version));
+	WriteFile(path, outdated);
+	CHECK(!cache.Load(path));
+	cache.GetPipeline(descs[0]);
+	CHECK(cache.GetStats().Misses == 1);
+	std::remove(path);
+}
@@ -0,0 +1,211 @@
+#include "Test.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include "Core/JobSystem.h"
+#include "Renderer/RHI/NullRhi.h"
+#include "Renderer/RHI/RhiMemoryAllocator.h"
+
+namespace
+{
+	/// <returns> The number of allocations that overlap another one of the same heap. </returns>
+	uint32_t CountOverlaps(std::vector<Engine::RhiMemoryAllocation> pAllocations)
+	{
+		std::sort(pAllocations.begin(), pAllocations.end(),
+		          [](const Engine::RhiMemoryAllocation& pA, const Engine::RhiMemoryAllocation& pB)
+		          {
+			          return std::tie(pA.Pool, pA.Heap, pA.Offset) < std::tie(pB.Pool, pB.Heap, pB.Offset);
+		          });
+		uint32_t overlaps = 0;
+		for (size_t i = 1; i < pAllocations.size(); ++i)
+		{
+			const Engine::RhiMemoryAllocation& previous = pAllocations[i - 1];
+			if (pAllocations[i].Pool == previous.Pool && pAllocations[i].Heap == previous.Heap &&
+				pAllocations[i].Offset < previous.Offset + previous.Size)
+				++overlaps;
+		}
+		return overlaps;
+	}
+
+	void PrintPool(const char* pName, const Engine::RhiMemoryAllocator::PoolStats& pPool)
+	{
+		std::printf("    %-22s : %u heaps of %llu MB, %u allocations, %.1f%% used, fragmentation %.2f\n", pName,
+		            pPool.HeapCount, static_cast<unsigned long long>(pPool.HeapBytes >> 20), pPool.AllocationCount,
+		            100.0f * pPool.GetOccupancy(), pPool.GetFragmentation());
+	}
+}
+
+// Resources of the null device placed in heaps : small buffers share them, a large one gets its own memory, each
+// pool has its heaps, and a defragmentation plan empties a heap that is then released.
+TEST(RhiMemoryAllocator_PlacesAndMovesResources)
+{
+	Engine::NullRhiDevice device;
+	Engine::RhiMemoryAllocator& memory = device.GetMemoryAllocator();
+	constexpr size_t defaultBuffers = static_cast<size_t>(Engine::RhiMemoryPool::DefaultBuffers);
+	constexpr size_t textures = static_cast<size_t>(Engine::RhiMemoryPool::Textures);
+
+	// 2000 buffers of up to 60 KB take 64 KB each, in two heaps.
+	Tests::Random random(13);
+	std::vector<std::unique_ptr<Engine::RhiBuffer>> buffers;
+	std::vector<Engine::RhiMemoryAllocation> allocations;
+	for (uint32_t i = 0; i < 2000; ++i)
+	{
+		buffers.push_back(device.CreateBuffer({256 + random.Next(60000), Engine::RhiHeapType::Default}));
+		allocations.push_back(static_cast<Engine::NullRhiBuffer&>(*buffers.back()).GetAllocation());
+	}
+	Engine::RhiMemoryAllocator::Stats stats = memory.GetStats();
+	CHECK(stats.Pools[defaultBuffers].HeapCount == 2);
+	CHECK(stats.Pools[defaultBuffers].AllocationCount == 2000);
+	CHECK(CountOverlaps(allocations) == 0);
+	PrintPool("2000 buffers", stats.Pools[defaultBuffers]);
+
+	auto large = device.CreateBuffer({40ull << 20, Engine::RhiHeapType::Default});
+	auto upload = device.CreateBuffer({1024, Engine::RhiHeapType::Upload});
+	stats = memory.GetStats();
+	CHECK(stats.Pools[defaultBuffers].DedicatedCount == 1);
+	CHECK(stats.Pools[defaultBuffers].HeapCount == 2);
+	CHECK(stats.Pools[static_cast<size_t>(Engine::RhiMemoryPool::UploadBuffers)].AllocationCount == 1);
+	large.reset();
+	upload.reset();
+	CHECK(memory.GetStats().Pools[defaultBuffers].DedicatedCount == 0);
+
+	// One buffer in two freed : the two heaps are half empty.
+	for (size_t i = 0; i < buffers.size(); i += 2)
+		buffers[i].reset();
+	PrintPool("one in two freed", memory.GetStats().Pools[defaultBuffers]);
+
+	// The least used heap moves into the other one, as the backend does it : the owner takes its new place and
+	// the old one is freed.
+	std::vector<Engine::RhiMemoryAllocator::Move> moves;
+	const uint64_t movedBytes = memory.PlanDefragmentation(Engine::RhiMemoryPool::DefaultBuffers, UINT64_MAX, moves);
+	CHECK(!moves.empty());
+	CHECK(movedBytes > 0);
+	const uint32_t source = moves.empty() ? 0 : moves.front().From.Heap;
+	for (const Engine::RhiMemoryAllocator::Move& move : moves)
+	{
+		auto& owner = *static_cast<Engine::NullRhiBuffer*>(move.Owner);
+		CHECK(move.From.Heap == source && move.To.Heap != source);
+		CHECK(owner.GetAllocation().Heap == move.From.Heap && owner.GetAllocation().Offset == move.From.Offset);
+		memory.Free(move.From);
+		owner.SetAllocation(memory, move.To, owner.GetGpuAddress());
+	}
+	stats = memory.GetStats();
+	CHECK(stats.Pools[defaultBuffers].HeapCount == 1);
+	CHECK(stats.Pools[defaultBuffers].AllocationCount == 1000);
+	CHECK(stats.HeapsReleased >= 1);
+	allocations.clear();
+	for (const auto& buffer : buffers)
+	{
+		if (buffer)
+			allocations.push_back(static_cast<Engine::NullRhiBuffer&>(*buffer).GetAllocation());
+	}
+	CHECK(CountOverlaps(allocations) == 0);
+	std::printf("    %zu moves of %llu KB\n", moves.size(), static_cast<unsigned long long>(movedBytes >> 10));
+	PrintPool("defragmented", stats.Pools[defaultBuffers]);
+
+	// Small textures take 4 KB, not 64 KB.
+	std::vector<std::unique_ptr<Engine::RhiTexture>> textureList;
+	for (uint32_t i = 0; i < 100; ++i)
+		textureList.push_back(device.CreateTexture({16, 16, 1}));
+	textureList.push_back(device.CreateTexture({2048, 2048, 12}));
+	stats = memory.GetStats();
+	CHECK(stats.Pools[textures].AllocationCount == 101);
+	CHECK(stats.Pools[textures].UsedBytes < 100 * 65536 + (32ull << 20));
+	PrintPool("textures", stats.Pools[textures]);
+
+	textureList.clear();
+	buffers.clear();
+	stats = memory.GetStats();
+	CHECK(stats.GetTotal().AllocationCount == 0);
+	CHECK(stats.GetTotal().DedicatedCount == 0);
+}
+
+// Threads allocating and freeing from every pool at once, in heaps of 1 MB so that they are created and released
+// all along : no two allocations overlap and everything freed leaves one heap per pool.
+TEST(RhiMemoryAllocator_AllocatesFromManyThreads)
+{
+	constexpr uint32_t poolCount = static_cast<uint32_t>(Engine::RhiMemoryPool::Count);
+	// Only called under the allocator's lock.
+	std::vector<bool> heaps[poolCount];
+	uint32_t heapErrors = 0;
+	Engine::RhiMemoryAllocator memory(
+		[&](const Engine::RhiMemoryPool pPool, const uint32_t pHeap, const uint64_t pSize)
+		{
+			std::vector<bool>& poolHeaps = heaps[static_cast<size_t>(pPool)];
+			poolHeaps.resize((std::max)(poolHeaps.size(), size_t(pHeap) + 1));
+			heapErrors += poolHeaps[pHeap] || pSize != 1ull << 20;
+			poolHeaps[pHeap] = true;
+		},
+		[&](const Engine::RhiMemoryPool pPool, const uint32_t pHeap)
+		{
+			std::vector<bool>& poolHeaps = heaps[static_cast<size_t>(pPool)];
+			heapErrors += pHeap >= poolHeaps.size() || !poolHeaps[pHeap];
+			if (pHeap < poolHeaps.size())
+				poolHeaps[pHeap] = false;
+		},
+		1ull << 20);
+
+	Engine::JobSystem::Initialize(7);
+	const uint32_t rangeCount = Engine::JobSystem::GetThreadCount();
+	std::vector<std::vector<Engine::RhiMemoryAllocation>> live(rangeCount);
+	Engine::JobSystem::ParallelFor(rangeCount, 1, [&](const uint32_t pFirst, uint32_t, const uint32_t pRange)
+	{
+		Tests::Random random(100 + pFirst);
+		std::vector<Engine::RhiMemoryAllocation>& allocations = live[pRange];
+		for (uint32_t i = 0; i < 20000; ++i)
+		{
+			if (allocations.empty() || random.Next(100) < 52)
+			{
+				const auto pool = static_cast<Engine::RhiMemoryPool>(random.Next(poolCount));
+				// Now and then too large for a heap.
+				const uint64_t size = random.Next(200) ? 1 + random.Next(64 << 10) : (1ull << 20) - random.Next(4096);
+				allocations.push_back(memory.Allocate(pool, size, 4096ull << random.Next(5), &allocations));
+			}
+			else
+			{
+				const uint32_t index = random.Next(static_cast<uint32_t>(allocations.size()));
+				memory.Free(allocations[index]);
+				allocations[index] = allocations.back();
+				allocations.pop_back();
+			}
+		}
+	});
+	Engine::JobSystem::Shutdown();
+
+	std::vector<Engine::RhiMemoryAllocation> placed;
+	uint32_t dedicatedCount = 0;
+	for (const auto& allocations : live)
+	{
+		for (const Engine::RhiMemoryAllocation& allocation : allocations)
+		{
+			if (allocation.IsDedicated())
+				++dedicatedCount;
+			else
+				placed.push_back(allocation);
+		}
+	}
+	CHECK(CountOverlaps(placed) == 0);
+	Engine::RhiMemoryAllocator::Stats stats = memory.GetStats();
+	CHECK(stats.GetTotal().AllocationCount == placed.size());
+	CHECK(stats.GetTotal().DedicatedCount == dedicatedCount);
+	CHECK(stats.HeapsCreated > stats.HeapsReleased + poolCount);
+	CHECK(heapErrors == 0);
+	std::printf("    %u threads : %zu live allocations, %u heaps created and %u released\n", rangeCount,
+	            placed.size() + dedicatedCount, stats.HeapsCreated, stats.HeapsReleased);
+
+	for (const auto& allocations : live)
+	{
+		for (const Engine::RhiMemoryAllocation& allocation : allocations)
+			memory.Free(allocation);
+	}
+	stats = memory.GetStats();
+	CHECK(stats.GetTotal().AllocationCount == 0);
+	CHECK(stats.GetTotal().DedicatedCount == 0);
+	CHECK(stats.GetTotal().HeapCount == poolCount);
+	CHECK(stats.HeapsCreated == stats.HeapsReleased + poolCount);
+	CHECK(heapErrors == 0);
+}
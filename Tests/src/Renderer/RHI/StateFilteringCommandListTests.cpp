@@ -0,0 +1,274 @@
+#include "Test.h"
+
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "Renderer/RHI/NullRhi.h"
+#include "Renderer/RHI/StateFilteringCommandList.h"
+
+namespace
+{
+	using CommandType = Engine::NullRhiCommandType;
+
+	// What a draw reads : the pipeline, the root arguments by slot (and constant offset), the buffers and topology.
+	struct DrawState
+	{
+		const void* Pipeline = nullptr;
+		std::map<std::pair<uint32_t, uint32_t>, std::pair<CommandType, uint64_t>> RootArguments;
+		uint64_t VertexBuffer[3] = {};
+		uint64_t IndexBuffer[3] = {};
+		uint64_t Topology = UINT64_MAX;
+		uint64_t StartInstance = 0;
+
+		bool operator==(const DrawState& pOther) const = default;
+	};
+
+	/// <summary>
+	/// Replays a recorded stream as the GPU would see it : root arguments are lost when the root signature changes
+	/// and after an ExecuteIndirect(), the rest stays bound until set again.
+	/// </summary>
+	std::vector<DrawState> GetDrawStates(const std::vector<Engine::NullRhiCommand>& pCommands)
+	{
+		std::vector<DrawState> draws;
+		DrawState state;
+		const void* rootSignature = nullptr;
+		for (const Engine::NullRhiCommand& command : pCommands)
+		{
+			switch (command.Type)
+			{
+			case CommandType::SetPipeline:
+			{
+				const void* newRootSignature = static_cast<const Engine::RhiPipeline*>(command.Object)->GetRootSignatureId();
+				if (newRootSignature != rootSignature)
+					state.RootArguments.clear();
+				rootSignature = newRootSignature;
+				state.Pipeline = command.Object;
+				break;
+			}
+			case CommandType::SetPipelineState:
+				state.Pipeline = command.Object;
+				break;
+			case CommandType::SetRootConstantBuffer:
+			case CommandType::SetRootDescriptorTable:
+			case CommandType::SetRootShaderResource:
+				state.RootArguments[{command.Slot, 0}] = {command.Type, command.Args[0]};
+				break;
+			case CommandType::SetRootConstant:
+				state.RootArguments[{command.Slot, 1 + static_cast<uint32_t>(command.Args[1])}] = {command.Type, command.Args[0]};
+				break;
+			case CommandType::ExecuteIndirect:
+				state.RootArguments.clear();
+				break;
+			case CommandType::SetVertexBuffer:
+				std::copy_n(command.Args, 3, state.VertexBuffer);
+				break;
+			case CommandType::SetIndexBuffer:
+				std::copy_n(command.Args, 3, state.IndexBuffer);
+				break;
+			case CommandType::SetPrimitiveTopology:
+				state.Topology = command.Args[0];
+				break;
+			case CommandType::DrawIndexedInstanced:
+				state.StartInstance = command.Slot;
+				draws.push_back(state);
+				break;
+			default:
+				break;
+			}
+		}
+		return draws;
+	}
+
+	// Pipelines 0 and 1 share a root signature, 2 and 3 share another one.
+	struct Pipelines
+	{
+		explicit Pipelines(Engine::RhiDevice& pDevice)
+		{
+			Engine::RhiPipelineDesc desc;
+			desc.RootParameters = {{Engine::RhiRootParameterType::ConstantBuffer}, {Engine::RhiRootParameterType::DescriptorTable},
+			                       {Engine::RhiRootParameterType::ShaderResource}, {Engine::RhiRootParameterType::Constants}};
+			for (uint32_t i = 0; i < 2; ++i)
+				List.push_back(pDevice.CreatePipeline(desc));
+			desc.UseStaticSamplers = true;
+			for (uint32_t i = 0; i < 2; ++i)
+				List.push_back(pDevice.CreatePipeline(desc));
+		}
+
+		std::vector<std::unique_ptr<Engine::RhiPipeline>> List;
+	};
+
+	/// <summary>
+	/// Records a random mix of state changes, many of them redundant, and draws. The same seed records the same calls.
+	/// </summary>
+	void RecordRandomDraws(Engine::RhiCommandList& pList, const Pipelines& pPipelines,
+	                       const Engine::RhiCommandSignature& pSignature, const Engine::RhiBuffer& pArguments,
+	                       const uint64_t pSeed)
+	{
+		Tests::Random random(pSeed);
+		uint32_t pipeline = 0;
+		pList.SetPipeline(*pPipelines.List[pipeline]);
+		for (uint32_t i = 0; i < 20000; ++i)
+		{
+			const uint32_t operation = random.Next(40);
+			if (operation < 3)
+			{
+				pipeline = random.Next(4);
+				pList.SetPipeline(*pPipelines.List[pipeline]);
+			}
+			else if (operation < 5)
+			{
+				// The other pipeline of the same root signature.
+				pipeline ^= random.Next(2);
+				pList.SetPipelineState(*pPipelines.List[pipeline]);
+			}
+			else if (operation < 15)
+			{
+				// Slot 20 is past the ones the filter tracks.
+				const uint32_t slot = random.Next(10) ? random.Next(3) : 20;
+				const uint64_t value = 0x1000 * (1 + random.Next(3));
+				switch (random.Next(3))
+				{
+				case 0: pList.SetGraphicsRootConstantBufferView(slot, value); break;
+				case 1: pList.SetGraphicsRootDescriptorTable(slot, value); break;
+				default: pList.SetGraphicsRootShaderResourceView(slot, value); break;
+				}
+			}
+			else if (operation < 20)
+			{
+				// Offset 4 is past the constants the filter tracks.
+				pList.SetGraphicsRoot32BitConstant(3, random.Next(3), random.Next(5));
+			}
+			else if (operation < 23)
+			{
+				const uint32_t buffer = random.Next(3);
+				pList.SetVertexBuffer({0x10000 * (1 + buffer), 4096, 32 + 4 * buffer});
+			}
+			else if (operation < 26)
+			{
+				const uint32_t buffer = random.Next(3);
+				pList.SetIndexBuffer({0x20000 * (1 + buffer), 1024, buffer ? Engine::RhiFormat::R16Uint : Engine::RhiFormat::R32Uint});
+			}
+			else if (operation < 28)
+			{
+				pList.SetPrimitiveTopology(random.Next(2) ? Engine::RhiPrimitiveTopology::TriangleList
+				                                          : Engine::RhiPrimitiveTopology::TriangleStrip);
+			}
+			else if (operation == 28)
+			{
+				pList.ExecuteIndirect(pSignature, 16, pArguments, 0, nullptr, 0);
+			}
+			else
+			{
+				pList.DrawIndexedInstanced(36, 1 + random.Next(3), 0, 0, i);
+			}
+		}
+	}
+}
+
+// The same random calls with and without filtering : every draw sees the same state, with far fewer commands.
+TEST(StateFilteringCommandList_KeepsTheStateOfEveryDraw)
+{
+	Engine::NullRhiDevice device;
+	auto& list = static_cast<Engine::NullRhiCommandList&>(device.GetCommandList());
+	Engine::StateFilteringCommandList filter(list);
+	const Pipelines pipelines(device);
+	const auto signature = device.CreateCommandSignature({{{Engine::RhiIndirectArgumentType::DrawIndexed}}, 20}, nullptr);
+	const auto arguments = device.CreateBuffer({320});
+
+	for (uint64_t seed = 1; seed <= 4; ++seed)
+	{
+		filter.SetEnabled(false);
+		filter.Begin(device.GetCommandAllocator());
+		RecordRandomDraws(filter, pipelines, *signature, *arguments, seed);
+		filter.End();
+		const std::vector<DrawState> expected = GetDrawStates(list.GetCommands());
+		const Engine::NullRhiStats unfiltered = list.GetStats();
+		CHECK(filter.GetStats().GetFilteredCount() == 0);
+		const uint64_t callCount = filter.GetStats().GetIssuedCount();
+
+		filter.SetEnabled(true);
+		filter.Begin(device.GetCommandAllocator());
+		RecordRandomDraws(filter, pipelines, *signature, *arguments, seed);
+		filter.End();
+		CHECK(GetDrawStates(list.GetCommands()) == expected);
+
+		const Engine::NullRhiStats& filtered = list.GetStats();
+		const Engine::StateFilteringCommandList::Stats& stats = filter.GetStats();
+		CHECK(filtered.DrawCount == unfiltered.DrawCount);
+		CHECK(filtered.ExecuteIndirectCount == unfiltered.ExecuteIndirectCount);
+		CHECK(stats.GetIssuedCount() + stats.GetFilteredCount() == callCount);
+		for (const uint64_t typeFiltered : stats.Filtered)
+			CHECK(typeFiltered > 0);
+
+		if (seed == 1)
+		{
+			std::printf("    %llu draws : %llu binds filtered down to %llu, %llu of %llu state calls dropped\n",
+			            static_cast<unsigned long long>(filtered.DrawCount),
+			            static_cast<unsigned long long>(unfiltered.GetBindCount()),
+			            static_cast<unsigned long long>(filtered.GetBindCount()),
+			            static_cast<unsigned long long>(stats.GetFilteredCount()),
+			            static_cast<unsigned long long>(callCount));
+		}
+	}
+}
+
+// Root arguments survive a pipeline of the same root signature, not one of another root signature nor an
+// ExecuteIndirect(). Begin() and Invalidate() forget everything.
+TEST(StateFilteringCommandList_ForgetsWhatTheGpuForgets)
+{
+	Engine::NullRhiDevice device;
+	auto& list = static_cast<Engine::NullRhiCommandList&>(device.GetCommandList());
+	Engine::StateFilteringCommandList filter(list);
+	const Pipelines pipelines(device);
+	const auto signature = device.CreateCommandSignature({{{Engine::RhiIndirectArgumentType::DrawIndexed}}, 20}, nullptr);
+	const auto arguments = device.CreateBuffer({320});
+	const Engine::RhiVertexBufferView vertexBuffer = {0x10000, 4096, 32};
+
+	const auto recorded = [&]
+	{
+		std::vector<CommandType> types;
+		for (const Engine::NullRhiCommand& command : list.GetCommands())
+			types.push_back(command.Type);
+		return types;
+	};
+
+	filter.Begin(device.GetCommandAllocator());
+	filter.SetPipeline(*pipelines.List[0]);
+	filter.SetGraphicsRootConstantBufferView(0, 0x1000);
+	filter.SetVertexBuffer(vertexBuffer);
+	// Same root signature : only the pipeline state changes.
+	filter.SetPipeline(*pipelines.List[1]);
+	filter.SetGraphicsRootConstantBufferView(0, 0x1000);
+	filter.SetPipeline(*pipelines.List[1]);
+	// Another root signature.
+	filter.SetPipeline(*pipelines.List[2]);
+	filter.SetGraphicsRootConstantBufferView(0, 0x1000);
+	filter.SetVertexBuffer(vertexBuffer);
+	// The arguments written by the indirect commands replace the root arguments, not the vertex buffer.
+	filter.ExecuteIndirect(*signature, 1, *arguments, 0, nullptr, 0);
+	filter.SetGraphicsRootConstantBufferView(0, 0x1000);
+	filter.SetPipeline(*pipelines.List[2]);
+	filter.SetVertexBuffer(vertexBuffer);
+	filter.End();
+	CHECK(recorded() == std::vector<CommandType>({
+		CommandType::SetPipeline, CommandType::SetRootConstantBuffer, CommandType::SetVertexBuffer,
+		CommandType::SetPipelineState,
+		CommandType::SetPipeline, CommandType::SetRootConstantBuffer,
+		CommandType::ExecuteIndirect, CommandType::SetRootConstantBuffer}));
+
+	// A new recording starts without any state.
+	filter.Begin(device.GetCommandAllocator());
+	filter.SetPipeline(*pipelines.List[2]);
+	filter.SetGraphicsRootConstantBufferView(0, 0x1000);
+	filter.SetVertexBuffer(vertexBuffer);
+	filter.Invalidate();
+	filter.SetPipeline(*pipelines.List[2]);
+	filter.SetVertexBuffer(vertexBuffer);
+	filter.End();
+	CHECK(recorded() == std::vector<CommandType>({
+		CommandType::SetPipeline, CommandType::SetRootConstantBuffer, CommandType::SetVertexBuffer,
+		CommandType::SetPipeline, CommandType::SetVertexBuffer}));
+}
@@ -0,0 +1,341 @@
+#include "Test.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "Renderer/RenderGraph.h"
+#include "Renderer/RHI/NullRhi.h"
+
+namespace
+{
+	// States a pass declared for its textures, by pass.
+	using PassStates = std::map<uint32_t, std::vector<std::pair<Engine::RenderGraph::TextureHandle, Engine::RhiResourceState>>>;
+
+	Engine::RhiTextureDesc MakeRenderTargetDesc(const uint32_t pWidth, const uint32_t pHeight,
+	                                            const Engine::RhiFormat pFormat = Engine::RhiFormat::R8G8B8A8Unorm)
+	{
+		Engine::RhiTextureDesc desc;
+		desc.Width = pWidth;
+		desc.Height = pHeight;
+		desc.Format = pFormat;
+		desc.IsRenderTarget = true;
+		return desc;
+	}
+
+	Engine::RhiTextureDesc MakeDepthStencilDesc(const uint32_t pWidth, const uint32_t pHeight)
+	{
+		Engine::RhiTextureDesc desc;
+		desc.Width = pWidth;
+		desc.Height = pHeight;
+		desc.Format = Engine::RhiFormat::D24UnormS8Uint;
+		desc.IsDepthStencil = true;
+		return desc;
+	}
+
+	// Records a Dispatch(pPass) as the pass, to find the passes in the recorded commands.
+	Engine::RenderGraph::ExecuteCallback MarkPass(const uint32_t pPass)
+	{
+		return [pPass](Engine::RhiCommandList& pCommandList) { pCommandList.Dispatch(pPass, 0, 0); };
+	}
+
+	/// <summary>
+	/// Follows the resources' states through recorded commands, across recordings, as the GPU would.
+	/// </summary>
+	class StateReplay
+	{
+	public:
+		void SetState(const void* pResource, const Engine::RhiResourceState pState) { m_States[pResource] = pState; }
+
+		Engine::RhiResourceState GetState(const void* pResource) const
+		{
+			const auto state = m_States.find(pResource);
+			return state == m_States.end() ? Engine::RhiResourceState::Common : state->second;
+		}
+
+		/// <returns> The number of transitions that do not start from the resource's state, and of textures not in
+		/// the state their pass declared when it runs. </returns>
+		uint32_t Replay(const std::vector<Engine::NullRhiCommand>& pCommands, const Engine::RenderGraph& pGraph,
+		                const PassStates& pPassStates)
+		{
+			uint32_t errors = 0;
+			for (const Engine::NullRhiCommand& command : pCommands)
+			{
+				if (command.Type == Engine::NullRhiCommandType::Barrier)
+				{
+					errors += static_cast<uint64_t>(GetState(command.Object)) != command.Args[0];
+					m_States[command.Object] = static_cast<Engine::RhiResourceState>(command.Args[1]);
+				}
+				else if (command.Type == Engine::NullRhiCommandType::Dispatch)
+				{
+					const auto pass = pPassStates.find(static_cast<uint32_t>(command.Args[0]));
+					if (pass == pPassStates.end())
+						continue;
+					for (const auto& [texture, state] : pass->second)
+						errors += GetState(&pGraph.GetTexture(texture)) != state;
+				}
+			}
+			return errors;
+		}
+
+	private:
+		std::map<const void*, Engine::RhiResourceState> m_States;
+	};
+
+	uint32_t CountCommands(const std::vector<Engine::NullRhiCommand>& pCommands, const Engine::NullRhiCommandType pType)
+	{
+		return static_cast<uint32_t>(std::count_if(pCommands.begin(), pCommands.end(),
+		                                           [pType](const Engine::NullRhiCommand& pCommand)
+		                                           {
+			                                           return pCommand.Type == pType;
+		                                           }));
+	}
+}
+
+// A deferred frame compiled and recorded on the null RHI, three frames in a row : the debug pass nobody reads is
+// culled, the depth buffer and the light buffer share memory, and every pass finds its textures in the states it
+// declared.
+TEST(RenderGraph_CompilesADeferredFrame)
+{
+	Engine::NullRhiDevice device;
+	auto& list = static_cast<Engine::NullRhiCommandList&>(device.GetCommandList());
+	const auto backBuffer = device.CreateTexture(MakeRenderTargetDesc(1920, 1080));
+
+	Engine::RenderGraph graph(device, 3);
+	StateReplay replay;
+	replay.SetState(backBuffer.get(), Engine::RhiResourceState::Present);
+	for (uint32_t frame = 0; frame < 3; ++frame)
+	{
+		graph.Reset();
+		const auto back = graph.ImportTexture("Back", *backBuffer, Engine::RhiResourceState::Present,
+		                                      Engine::RhiResourceState::Present);
+		const auto gbuffer = graph.CreateTexture("GBuffer", MakeRenderTargetDesc(1920, 1080,
+		                                                                         Engine::RhiFormat::R32G32B32A32Float));
+		const auto depth = graph.CreateTexture("Depth", MakeDepthStencilDesc(1920, 1080));
+		const auto light = graph.CreateTexture("Light", MakeRenderTargetDesc(1920, 1080));
+		const auto debug = graph.CreateTexture("Debug", MakeRenderTargetDesc(1920, 1080));
+
+		PassStates passStates;
+		const uint32_t gbufferPass = graph.AddPass("GBuffer", MarkPass(0))
+		                                  .Write(gbuffer, Engine::RhiResourceState::RenderTarget)
+		                                  .Write(depth, Engine::RhiResourceState::DepthWrite).GetPass();
+		passStates[0] = {{gbuffer, Engine::RhiResourceState::RenderTarget}, {depth, Engine::RhiResourceState::DepthWrite}};
+		const uint32_t debugPass = graph.AddPass("Debug", MarkPass(1))
+		                                .Read(depth, Engine::RhiResourceState::ShaderResource)
+		                                .Write(debug, Engine::RhiResourceState::RenderTarget).GetPass();
+		const uint32_t lightingPass = graph.AddPass("Lighting", MarkPass(2))
+		                                   .Read(gbuffer, Engine::RhiResourceState::ShaderResource)
+		                                   .Write(light, Engine::RhiResourceState::RenderTarget).GetPass();
+		passStates[2] = {{gbuffer, Engine::RhiResourceState::ShaderResource}, {light, Engine::RhiResourceState::RenderTarget}};
+		const uint32_t composePass = graph.AddPass("Compose", MarkPass(3))
+		                                  .Read(light, Engine::RhiResourceState::ShaderResource)
+		                                  .Write(back, Engine::RhiResourceState::RenderTarget).GetPass();
+		passStates[3] = {{light, Engine::RhiResourceState::ShaderResource}, {back, Engine::RhiResourceState::RenderTarget}};
+
+		graph.Compile();
+		const Engine::RenderGraph::Stats& stats = graph.GetStats();
+		CHECK(graph.IsPassKept(gbufferPass) && !graph.IsPassKept(debugPass));
+		CHECK(graph.IsPassKept(lightingPass) && graph.IsPassKept(composePass));
+		CHECK(stats.CulledPasses == 1);
+		CHECK(stats.TransientCount == 3);
+		// The depth buffer is last used by the first pass, the light buffer first by the second one.
+		CHECK(graph.GetTextureOffset(depth) == graph.GetTextureOffset(light));
+		CHECK(stats.HeapBytes < stats.TransientBytes);
+
+		// Split across two recordings, as a frame over two command lists.
+		list.Begin(device.GetCommandAllocator());
+		graph.Execute(list, gbufferPass);
+		CHECK(list.GetStats().BarrierBatchCount == 1);
+		graph.Execute(list);
+		list.End();
+
+		CHECK(replay.Replay(list.GetCommands(), graph, passStates) == 0);
+		CHECK(replay.GetState(backBuffer.get()) == Engine::RhiResourceState::Present);
+		CHECK(CountCommands(list.GetCommands(), Engine::NullRhiCommandType::Dispatch) == 3);
+		// The first use of each transient in the heap.
+		CHECK(CountCommands(list.GetCommands(), Engine::NullRhiCommandType::AliasingBarrier) == 3);
+		// One batch before each kept pass, one for the final states.
+		CHECK(list.GetStats().BarrierBatchCount == 4);
+
+		if (frame == 0)
+		{
+			std::printf("    %u passes, %u culled : %u barriers in %u batches, %u transients in %llu KB instead of "
+			            "%llu KB\n", stats.PassCount, stats.CulledPasses, stats.BarrierCount, stats.BarrierBatchCount,
+			            stats.TransientCount, static_cast<unsigned long long>(stats.HeapBytes >> 10),
+			            static_cast<unsigned long long>(stats.TransientBytes >> 10));
+		}
+	}
+}
+
+// Two passes writing a texture as an unordered access view are separated by a UAV barrier, and a pass only
+// reading a transient is culled. The plan comes from Compile() alone, nothing is recorded.
+TEST(RenderGraph_PlansUnorderedAccessBarriers)
+{
+	Engine::NullRhiDevice device;
+	const auto backBuffer = device.CreateTexture(MakeRenderTargetDesc(1920, 1080));
+
+	Engine::RenderGraph graph(device, 3);
+	graph.Reset();
+	const auto back = graph.ImportTexture("Back", *backBuffer, Engine::RhiResourceState::Present,
+	                                      Engine::RhiResourceState::Present);
+	const auto texture = graph.CreateTexture("Texture", MakeRenderTargetDesc(256, 256));
+	graph.AddPass("A", MarkPass(0)).Write(texture, Engine::RhiResourceState::UnorderedAccess);
+	graph.AddPass("B", MarkPass(1)).Write(texture, Engine::RhiResourceState::UnorderedAccess);
+	graph.AddPass("C", MarkPass(2)).Read(texture, Engine::RhiResourceState::ShaderResource);
+	graph.AddPass("D", MarkPass(3)).Read(texture, Engine::RhiResourceState::ShaderResource)
+	     .Write(back, Engine::RhiResourceState::RenderTarget);
+	graph.Compile();
+
+	const std::vector<Engine::RhiBarrier> second = graph.GetPassBarriers(1);
+	CHECK(second.size() == 1 && second[0].Type == Engine::RhiBarrierType::UnorderedAccess);
+	CHECK(!graph.IsPassKept(2));
+	CHECK(graph.GetPassBarriers(2).empty());
+	const std::vector<Engine::RhiBarrier> last = graph.GetPassBarriers(3);
+	CHECK(last.size() == 2);
+	if (last.size() == 2)
+	{
+		CHECK(last[0].Type == Engine::RhiBarrierType::Transition);
+		CHECK(last[0].Before == Engine::RhiResourceState::UnorderedAccess);
+		CHECK(last[1].Resource == backBuffer.get());
+	}
+}
+
+// Random graphs of up to 16 passes and 11 textures : the transients used at the same time never overlap in the
+// heap, which is no larger than the last of them, and the recorded barriers always lead to the declared states.
+TEST(RenderGraph_AliasesRandomGraphs)
+{
+	Engine::NullRhiDevice device;
+	auto& list = static_cast<Engine::NullRhiCommandList&>(device.GetCommandList());
+	const auto backBuffer = device.CreateTexture(MakeRenderTargetDesc(1920, 1080));
+
+	// Nothing is released, so no texture is created again at the address of another and the replay stays right
+	// across graphs.
+	Engine::RenderGraph graph(device, 100000);
+	StateReplay replay;
+	replay.SetState(backBuffer.get(), Engine::RhiResourceState::Present);
+
+	Tests::Random random(17);
+	constexpr Engine::RhiResourceState states[] = {
+		Engine::RhiResourceState::RenderTarget, Engine::RhiResourceState::ShaderResource,
+		Engine::RhiResourceState::UnorderedAccess, Engine::RhiResourceState::CopySource
+	};
+	constexpr uint32_t graphCount = 2000;
+	uint32_t passCount = 0, culledCount = 0;
+	uint64_t transientBytes = 0, heapBytes = 0;
+	double compileTime = 0.0;
+	for (uint32_t iteration = 0; iteration < graphCount; ++iteration)
+	{
+		graph.Reset();
+		const auto back = graph.ImportTexture("Back", *backBuffer, Engine::RhiResourceState::Present,
+		                                      Engine::RhiResourceState::Present);
+		std::vector<Engine::RenderGraph::TextureHandle> textures;
+		const uint32_t textureCount = 2 + random.Next(10);
+		for (uint32_t i = 0; i < textureCount; ++i)
+		{
+			const uint32_t width = 64u << random.Next(5), height = 64u << random.Next(5);
+			textures.push_back(graph.CreateTexture("Texture", random.Next(4) == 0
+				                                                  ? MakeDepthStencilDesc(width, height)
+				                                                  : MakeRenderTargetDesc(width, height)));
+		}
+
+		PassStates passStates;
+		const uint32_t graphPassCount = 2 + random.Next(14);
+		for (uint32_t pass = 0; pass < graphPassCount; ++pass)
+		{
+			Engine::RenderGraph::PassBuilder builder = graph.AddPass("Pass", MarkPass(pass));
+			std::map<Engine::RenderGraph::TextureHandle, Engine::RhiResourceState> used;
+			const uint32_t accessCount = 1 + random.Next(3);
+			for (uint32_t i = 0; i < accessCount; ++i)
+			{
+				const Engine::RenderGraph::TextureHandle texture = textures[random.Next(textureCount)];
+				if (used.contains(texture))
+					continue;
+				const Engine::RhiResourceState state = states[random.Next(4)];
+				if (random.Next(2))
+					builder.Write(texture, state);
+				else
+					builder.Read(texture, state);
+				used[texture] = state;
+			}
+			if (pass == graphPassCount - 1)
+			{
+				builder.Write(back, Engine::RhiResourceState::RenderTarget);
+				used[back] = Engine::RhiResourceState::RenderTarget;
+			}
+			if (random.Next(8) == 0)
+				builder.SetSideEffects();
+			passStates[pass].assign(used.begin(), used.end());
+		}
+
+		const double start = Tests::GetTime();
+		graph.Compile();
+		compileTime += Tests::GetTime() - start;
+		const Engine::RenderGraph::Stats& stats = graph.GetStats();
+		passCount += stats.PassCount;
+		culledCount += stats.CulledPasses;
+		transientBytes += stats.TransientBytes;
+		heapBytes += stats.HeapBytes;
+
+		list.Begin(device.GetCommandAllocator());
+		graph.Execute(list);
+		list.End();
+
+		// The kept passes using each transient, first and last, from the declarations.
+		std::map<Engine::RenderGraph::TextureHandle, std::pair<uint32_t, uint32_t>> lifetimes;
+		uint32_t order = 0;
+		for (uint32_t pass = 0; pass < graphPassCount; ++pass)
+		{
+			if (!graph.IsPassKept(pass))
+			{
+				passStates.erase(pass);
+				continue;
+			}
+			for (const auto& [texture, state] : passStates[pass])
+			{
+				if (texture == back)
+					continue;
+				const auto lifetime = lifetimes.try_emplace(texture, order, order).first;
+				lifetime->second.second = order;
+			}
+			++order;
+		}
+
+		uint64_t heapEnd = 0;
+		uint32_t overlaps = 0, misaligned = 0;
+		for (const auto& [a, lifetimeA] : lifetimes)
+		{
+			const uint64_t offsetA = graph.GetTextureOffset(a);
+			const uint64_t sizeA = device.GetTextureAllocationInfo(graph.GetTexture(a).GetDesc()).Size;
+			misaligned += offsetA % Engine::k_RhiResourcePlacementAlignment != 0;
+			heapEnd = (std::max)(heapEnd, offsetA + sizeA);
+			for (const auto& [b, lifetimeB] : lifetimes)
+			{
+				if (b <= a)
+					continue;
+				const uint64_t offsetB = graph.GetTextureOffset(b);
+				const uint64_t sizeB = device.GetTextureAllocationInfo(graph.GetTexture(b).GetDesc()).Size;
+				const bool isLiveTogether = lifetimeA.first <= lifetimeB.second && lifetimeB.first <= lifetimeA.second;
+				overlaps += isLiveTogether && offsetA < offsetB + sizeB && offsetB < offsetA + sizeA;
+			}
+		}
+		CHECK(overlaps == 0);
+		CHECK(misaligned == 0);
+		CHECK(heapEnd == stats.HeapBytes);
+		CHECK(stats.HeapBytes <= stats.TransientBytes);
+
+		CHECK(replay.Replay(list.GetCommands(), graph, passStates) == 0);
+		CHECK(replay.GetState(backBuffer.get()) == Engine::RhiResourceState::Present);
+		uint32_t batchCount = 0;
+		for (uint32_t pass = 0; pass < graphPassCount; ++pass)
+			batchCount += !graph.GetPassBarriers(pass).empty();
+		CHECK(list.GetStats().BarrierBatchCount <= batchCount + 1);
+	}
+
+	std::printf("    %u graphs : %u of %u passes culled, aliasing saves %.0f%% of %llu MB, %.1f us per Compile()\n",
+	            graphCount, culledCount, passCount,
+	            100.0 * static_cast<double>(transientBytes - heapBytes) / static_cast<double>(transientBytes),
+	            static_cast<unsigned long long>(transientBytes >> 20), compileTime * 1e6 / graphCount);
+}
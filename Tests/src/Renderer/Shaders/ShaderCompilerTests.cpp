@@ -0,0 +1,288 @@
+#include "Test.h"
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Core/JobSystem.h"
+#include "Renderer/Shaders/ShaderCompiler.h"
+
+namespace
+{
+	const std::filesystem::path k_Directory = "ShaderCompilerTests";
+
+	std::string ReadFile(const std::filesystem::path& pPath)
+	{
+		std::ifstream file(pPath, std::ios::binary);
+		return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+
+	void WriteFile(const std::filesystem::path& pPath, const std::string& pText)
+	{
+		std::filesystem::create_directories(pPath.parent_path());
+		std::ofstream file(pPath, std::ios::binary | std::ios::trunc);
+		file << pText;
+	}
+
+	// "Compiles" to the request and every source file it reads, sources containing "error" fail. Counts its calls,
+	// which come from several threads during CompileAll().
+	class StubBackend : public Engine::ShaderCompilerBackend
+	{
+	public:
+		bool Compile(const Engine::ShaderCompileRequest& pRequest, Engine::ShaderBytecode& pOutBytecode,
+		             std::string& pErrors) const override
+		{
+			m_CompileCount.fetch_add(1, std::memory_order_relaxed);
+			std::string text = pRequest.EntryPoint + ' ' + pRequest.Target;
+			for (const Engine::ShaderDefine& define : pRequest.Defines)
+				text += ' ' + define.Name + '=' + define.Value;
+			for (const std::filesystem::path& file : Engine::ShaderCompiler::GetSourceFiles(pRequest.Path))
+				text += '\n' + ReadFile(file);
+
+			if (text.find("error") != std::string::npos)
+			{
+				pErrors = "error X0000: stub";
+				return false;
+			}
+			pOutBytecode.assign(text.begin(), text.end());
+			return true;
+		}
+
+		std::string GetVersionTag() const override { return "stub 1"; }
+
+		[[nodiscard]] uint32_t GetCompileCount() const { return m_CompileCount.load(); }
+
+	private:
+		mutable std::atomic<uint32_t> m_CompileCount = 0;
+	};
+
+	// A compiler over a cache directory that outlives it, as two runs of the engine share one.
+	struct Run
+	{
+		explicit Run(std::unique_ptr<StubBackend> pBackend = std::make_unique<StubBackend>())
+			: Backend(*pBackend), Compiler(std::move(pBackend), k_Directory / "Cache")
+		{
+		}
+
+		StubBackend& Backend;
+		Engine::ShaderCompiler Compiler;
+	};
+
+	std::string ToString(const Engine::ShaderBytecode& pBytecode) { return std::string(pBytecode.begin(), pBytecode.end()); }
+
+	std::vector<std::filesystem::path> GetCacheFiles()
+	{
+		std::vector<std::filesystem::path> files;
+		for (const auto& entry : std::filesystem::directory_iterator(k_Directory / "Cache"))
+			files.push_back(entry.path());
+		return files;
+	}
+}
+
+// The key covers the source, the defines, the entry point and the target. A request that changes any of them is
+// a miss, the same request is found in memory, then on disk by the next run.
+TEST(ShaderCompiler_HashesSourceAndDefines)
+{
+	std::filesystem::remove_all(k_Directory);
+	const std::filesystem::path path = k_Directory / "Lit.hlsl";
+	WriteFile(path, "float4 PS() : SV_Target { return LIGHTS; }");
+	const Engine::ShaderCompileRequest request = {path, "PS", "ps_5_1", {{"LIGHTS", "1"}, {"TEXTURE", "0"}}};
+
+	std::vector<Engine::ShaderCompileRequest> changed(6, request);
+	changed[0].Defines[0].Value = "2";
+	changed[1].Defines[1].Name = "TEXTURES";
+	changed[2].Defines.pop_back();
+	changed[3].EntryPoint = "VS";
+	changed[4].Target = "ps_6_0";
+	// Define "A" = "BC" against "AB" = "C".
+	changed[5].Defines[0] = {"LIGHTS1", ""};
+	{
+		Run run;
+		const uint64_t key = run.Compiler.GetKey(request);
+		Engine::ShaderCompileRequest same = request;
+		same.Path = k_Directory / "Unused" / ".." / "Lit.hlsl";
+		CHECK(run.Compiler.GetKey(same) == key);
+
+		const std::string bytecode = ToString(run.Compiler.Compile(request));
+		CHECK(bytecode.find("LIGHTS=1") != std::string::npos);
+		CHECK(ToString(run.Compiler.Compile(same)) == bytecode);
+		for (const Engine::ShaderCompileRequest& other : changed)
+		{
+			CHECK(run.Compiler.GetKey(other) != key);
+			CHECK(ToString(run.Compiler.Compile(other)) != bytecode);
+		}
+		CHECK(run.Backend.GetCompileCount() == 7);
+		CHECK(run.Compiler.GetStats().MemoryHits == 1);
+		CHECK(run.Compiler.GetDiskFootprint().FileCount == 7);
+	}
+	{
+		Run run;
+		run.Compiler.CompileAll(changed);
+		CHECK(run.Backend.GetCompileCount() == 0);
+		CHECK(run.Compiler.GetStats().DiskHits == 6);
+
+		// The edited source is compiled again, next to its stale entry.
+		const uint64_t key = run.Compiler.GetKey(request);
+		WriteFile(path, "float4 PS() : SV_Target { return LIGHTS * 2; }");
+		CHECK(run.Compiler.GetKey(request) != key);
+		run.Compiler.Compile(request);
+		CHECK(run.Backend.GetCompileCount() == 1);
+		CHECK(run.Compiler.GetDiskFootprint().FileCount == 8);
+	}
+	std::filesystem::remove_all(k_Directory);
+}
+
+// Includes are followed through the files that include them, relative to each one. Editing the deepest one
+// changes the key of every shader above it and only of those.
+TEST(ShaderCompiler_InvalidatesNestedIncludes)
+{
+	std::filesystem::remove_all(k_Directory);
+	const std::filesystem::path lit = k_Directory / "Lit.hlsl";
+	const std::filesystem::path color = k_Directory / "Color.hlsl";
+	const std::filesystem::path common = k_Directory / "Include" / "Common.hlsli";
+	const std::filesystem::path light = k_Directory / "Include" / "Lighting" / "Light.hlsli";
+	WriteFile(lit, "#include \"Include/Common.hlsli\"\nfloat4 PS() : SV_Target { return Shade(); }");
+	WriteFile(color, "  #  include <Include/Common.hlsli>\nfloat4 PS() : SV_Target { return 1; }");
+	// Lighting/Light.hlsli is next to Common.hlsli, the cycle back to it is followed once.
+	WriteFile(common, "#include \"Lighting/Light.hlsli\"\n// #include \"Missing.hlsli\"\n#include \"Missing.hlsli\"");
+	WriteFile(light, "#include \"../Common.hlsli\"\nfloat4 Shade() { return 0.5; }");
+	const std::filesystem::path shader = k_Directory / "Shader.hlsl";
+	WriteFile(shader, "float4 PS() : SV_Target { return 0; }");
+
+	const std::vector<std::filesystem::path> files = Engine::ShaderCompiler::GetSourceFiles(lit);
+	CHECK(files.size() == 3);
+	CHECK(files.size() == 3 && files[1] == common.lexically_normal() && files[2] == light.lexically_normal());
+	CHECK(Engine::ShaderCompiler::GetSourceFiles(color).size() == 3);
+
+	const std::vector<Engine::ShaderCompileRequest> requests = {
+		{lit, "PS", "ps_5_1", {}},
+		{color, "PS", "ps_5_1", {}},
+		{shader, "PS", "ps_5_1", {}},
+	};
+	std::string litBytecode;
+	{
+		Run run;
+		run.Compiler.CompileAll(requests);
+		CHECK(run.Backend.GetCompileCount() == 3);
+		litBytecode = ToString(run.Compiler.Compile(requests[0]));
+	}
+
+	WriteFile(light, "#include \"../Common.hlsli\"\nfloat4 Shade() { return 0.25; }");
+	{
+		Run run;
+		run.Compiler.CompileAll(requests);
+		CHECK(run.Backend.GetCompileCount() == 2);
+		CHECK(run.Compiler.GetStats().DiskHits == 1);
+		const std::string bytecode = ToString(run.Compiler.Compile(requests[0]));
+		CHECK(bytecode != litBytecode);
+		CHECK(bytecode.find("0.25") != std::string::npos);
+	}
+	std::filesystem::remove_all(k_Directory);
+}
+
+// Cache files cut short, emptied, from another version or holding another key are compiled again and rewritten.
+TEST(ShaderCompiler_RejectsCorruptCacheFiles)
+{
+	std::filesystem::remove_all(k_Directory);
+	const std::filesystem::path path = k_Directory / "Color.hlsl";
+	WriteFile(path, "float4 PS() : SV_Target { return 1; }");
+	const Engine::ShaderCompileRequest request = {path, "PS", "ps_5_1", {}};
+	const Engine::ShaderCompileRequest other = {path, "VS", "vs_5_1", {}};
+
+	std::string expected;
+	std::string otherFile;
+	{
+		Run run;
+		run.Compiler.Compile(other);
+		otherFile = ReadFile(GetCacheFiles()[0]);
+		std::filesystem::remove(GetCacheFiles()[0]);
+		expected = ToString(run.Compiler.Compile(request));
+	}
+	const std::filesystem::path cacheFile = GetCacheFiles()[0];
+	const std::string file = ReadFile(cacheFile);
+	constexpr size_t headerSize = 2 * sizeof(uint32_t) + 2 * sizeof(uint64_t);
+	CHECK(file.size() == headerSize + expected.size());
+
+	std::vector<std::string> corruptFiles(6, file);
+	corruptFiles[0].pop_back();
+	corruptFiles[1].resize(headerSize / 2);
+	corruptFiles[2].resize(headerSize);
+	corruptFiles[3][0] ^= 1;
+	corruptFiles[4][sizeof(uint32_t)] ^= 1;
+	corruptFiles[5] = otherFile;
+	corruptFiles.push_back(file + "extra");
+	corruptFiles.push_back("");
+	for (const std::string& corruptFile : corruptFiles)
+	{
+		WriteFile(cacheFile, corruptFile);
+		{
+			Run run;
+			CHECK(ToString(run.Compiler.Compile(request)) == expected);
+			CHECK(run.Backend.GetCompileCount() == 1);
+			CHECK(run.Compiler.GetStats().DiskHits == 0);
+		}
+		CHECK(ReadFile(cacheFile) == file);
+	}
+
+	Run run;
+	CHECK(ToString(run.Compiler.Compile(request)) == expected);
+	CHECK(run.Compiler.GetStats().DiskHits == 1);
+	std::filesystem::remove_all(k_Directory);
+}
+
+// Requests sharing a key are compiled once however many threads compile the misses, failures are reported by
+// the matching Compile() call and do not stop the others.
+TEST(ShaderCompiler_CompilesConcurrentMissesOnce)
+{
+	std::filesystem::remove_all(k_Directory);
+	const std::filesystem::path path = k_Directory / "Lit.hlsl";
+	const std::filesystem::path broken = k_Directory / "Broken.hlsl";
+	WriteFile(path, "float4 PS() : SV_Target { return LIGHTS; }");
+	WriteFile(broken, "float4 PS() : SV_Target { error }");
+
+	std::vector<Engine::ShaderCompileRequest> requests;
+	for (uint32_t copy = 0; copy < 3; ++copy)
+	{
+		for (uint32_t lights = 0; lights < 8; ++lights)
+			requests.push_back({path, "PS", "ps_5_1", {{"LIGHTS", std::to_string(lights)}}});
+	}
+	requests.push_back({broken, "PS", "ps_5_1", {}});
+
+	for (const uint32_t threadCount : {1u, 4u})
+	{
+		std::filesystem::remove_all(k_Directory / "Cache");
+		Engine::JobSystem::Initialize(threadCount - 1);
+		Run run;
+		run.Compiler.CompileAll(requests);
+		const Engine::ShaderCompiler::Stats& stats = run.Compiler.GetStats();
+		CHECK(run.Backend.GetCompileCount() == 9);
+		CHECK(stats.Requests == 25);
+		CHECK(stats.Compiled == 8);
+		CHECK(stats.Failed == 1);
+		CHECK(stats.MemoryHits == 16);
+		CHECK(run.Compiler.GetDiskFootprint().FileCount == 8);
+
+		for (uint32_t lights = 0; lights < 8; ++lights)
+		{
+			const std::string bytecode = ToString(run.Compiler.Compile(requests[lights]));
+			CHECK(bytecode.find("LIGHTS=" + std::to_string(lights)) != std::string::npos);
+		}
+		bool threw = false;
+		try
+		{
+			run.Compiler.Compile(requests.back());
+		}
+		catch (const std::runtime_error&)
+		{
+			threw = true;
+		}
+		CHECK(threw);
+		CHECK(run.Backend.GetCompileCount() == 10);
+		Engine::JobSystem::Shutdown();
+	}
+	std::filesystem::remove_all(k_Directory);
+}
@@ -0,0 +1,110 @@
+#include "Test.h"
+
+#include <set>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+#include "Renderer/Shaders/ShaderPermutations.h"
+
+namespace
+{
+	// The lit shader's features, with an instancing switch both stages see and a value that never changes.
+	Engine::ShaderPermutations MakeLitPermutations()
+	{
+		return Engine::ShaderPermutations({
+			{"TEXTURE", {0, 1}, Engine::RhiShaderVisibility::Pixel},
+			{"MAX_DIRECTIONAL_LIGHTS", {0, 1, 2, 4, 10}, Engine::RhiShaderVisibility::Pixel},
+			{"QUANTIZED", {1}, Engine::RhiShaderVisibility::Vertex},
+			{"INSTANCED", {0, 1}},
+		});
+	}
+
+	bool Throws(std::vector<Engine::ShaderFeature> pFeatures)
+	{
+		try
+		{
+			Engine::ShaderPermutations permutations(std::move(pFeatures));
+		}
+		catch (const std::invalid_argument&)
+		{
+			return true;
+		}
+		return false;
+	}
+}
+
+// Every combination of values has one key, packed in the fewest bits, and key 0 is every feature's first value.
+TEST(ShaderPermutations_EnumeratesEveryVariant)
+{
+	const Engine::ShaderPermutations permutations = MakeLitPermutations();
+	CHECK(permutations.GetVariantCount() == 2 * 5 * 1 * 2);
+
+	const std::vector<Engine::ShaderVariantKey> keys = permutations.GetAllKeys();
+	CHECK(keys.size() == permutations.GetVariantCount());
+	CHECK(keys[0] == 0);
+	std::set<Engine::ShaderVariantKey> uniqueKeys;
+	std::set<std::tuple<uint32_t, uint32_t, uint32_t, uint32_t>> combinations;
+	for (const Engine::ShaderVariantKey key : keys)
+	{
+		// 1 + 3 + 0 + 1 bits.
+		CHECK(key < (1u << 5));
+		uniqueKeys.insert(key);
+		combinations.insert({permutations.GetValue(key, 0), permutations.GetValue(key, 1), permutations.GetValue(key, 2),
+		                     permutations.GetValue(key, 3)});
+	}
+	CHECK(uniqueKeys.size() == keys.size());
+	CHECK(combinations.size() == keys.size());
+	CHECK(permutations.ToString(0) == "TEXTURE=0 MAX_DIRECTIONAL_LIGHTS=0 QUANTIZED=1 INSTANCED=0");
+
+	// A shader without features has a single variant.
+	const Engine::ShaderPermutations none;
+	CHECK(none.GetVariantCount() == 1);
+	CHECK(none.GetAllKeys() == std::vector<Engine::ShaderVariantKey>{0});
+	CHECK(none.GetDefines(0, Engine::RhiShaderVisibility::Vertex).empty());
+
+	CHECK(Throws({{"EMPTY", {}}}));
+	CHECK(Throws({{"A", std::vector<uint32_t>(256)}, {"B", std::vector<uint32_t>(512)}}));
+	CHECK(!Throws({{"A", std::vector<uint32_t>(256)}, {"B", std::vector<uint32_t>(256)}}));
+}
+
+// A stage only gets the defines it sees, so variants that differ in pixel features share their vertex bytecode,
+// and a material gets the cheapest variant that covers what it needs.
+TEST(ShaderPermutations_PrunesVariants)
+{
+	const Engine::ShaderPermutations permutations = MakeLitPermutations();
+
+	std::set<std::vector<std::pair<std::string, std::string>>> vertexDefines;
+	std::set<std::vector<std::pair<std::string, std::string>>> pixelDefines;
+	for (const Engine::ShaderVariantKey key : permutations.GetAllKeys())
+	{
+		std::vector<std::pair<std::string, std::string>> defines;
+		for (const Engine::ShaderDefine& define : permutations.GetDefines(key, Engine::RhiShaderVisibility::Vertex))
+			defines.emplace_back(define.Name, define.Value);
+		vertexDefines.insert(defines);
+
+		defines.clear();
+		for (const Engine::ShaderDefine& define : permutations.GetDefines(key, Engine::RhiShaderVisibility::Pixel))
+			defines.emplace_back(define.Name, define.Value);
+		pixelDefines.insert(defines);
+	}
+	// QUANTIZED and INSTANCED for the vertex stage, everything but QUANTIZED for the pixel one.
+	CHECK(vertexDefines.size() == 2);
+	CHECK(vertexDefines.begin()->size() == 2);
+	CHECK(pixelDefines.size() == 2 * 5 * 2);
+	CHECK(pixelDefines.begin()->size() == 3);
+
+	constexpr uint32_t lights = 1;
+	const Engine::ShaderVariantKey textured = permutations.Select(0, 0, 1);
+	CHECK(permutations.GetValue(textured, 0) == 1);
+	const uint32_t expected[][2] = {{0, 0}, {1, 1}, {2, 2}, {3, 4}, {4, 4}, {5, 10}, {10, 10}, {11, 10}};
+	for (const auto& [lightCount, value] : expected)
+	{
+		const Engine::ShaderVariantKey key = permutations.Select(textured, lights, lightCount);
+		CHECK(permutations.GetValue(key, lights) == value);
+		CHECK(permutations.GetValue(key, 0) == 1);
+	}
+	// Selecting again replaces the value rather than adding to it.
+	const Engine::ShaderVariantKey fourLights = permutations.Select(textured, lights, 3);
+	CHECK(permutations.Select(fourLights, lights, 1) == permutations.Select(textured, lights, 1));
+}
@@ -0,0 +1,267 @@
+#include "Test.h"
+
+#include <memory>
+#include <vector>
+
+#include "Renderer/UploadManager.h"
+#include "Renderer/RHI/NullRhi.h"
+
+namespace
+{
+	constexpr uint64_t k_StagingSize = 64 * 1024;
+
+	// The staging memory every copy reads, with the ticket of its batch. A copy reading memory that a batch not
+	// done yet reads too means the ring handed it out again too early.
+	class StagingTracker
+	{
+	public:
+		void Use(const Engine::RhiBuffer& pSource, const uint64_t pOffset, const uint64_t pSize)
+		{
+			const uint64_t completed = m_Fence->GetCompletedValue();
+			for (const Range& range : m_Ranges)
+			{
+				if (range.Ticket > completed && range.Source == &pSource && pOffset < range.End && range.Begin < pOffset + pSize)
+					++m_Overlaps;
+			}
+			if (&pSource == m_LastSource && pOffset < m_LastOffset)
+				++m_Wraps;
+			m_LastSource = &pSource;
+			m_LastOffset = pOffset;
+			m_Ranges.push_back({&pSource, pOffset, pOffset + pSize, m_EndedBatches + 1});
+		}
+
+		void EndBatch() { ++m_EndedBatches; }
+		void SetFence(const Engine::RhiFence& pFence) { m_Fence = &pFence; }
+
+		[[nodiscard]] uint32_t GetOverlaps() const { return m_Overlaps; }
+		[[nodiscard]] uint32_t GetWraps() const { return m_Wraps; }
+
+	private:
+		struct Range
+		{
+			const Engine::RhiBuffer* Source;
+			uint64_t Begin;
+			uint64_t End;
+			Engine::UploadTicket Ticket;
+		};
+
+		const Engine::RhiFence* m_Fence = nullptr;
+		std::vector<Range> m_Ranges;
+		uint32_t m_EndedBatches = 0;
+		const Engine::RhiBuffer* m_LastSource = nullptr;
+		uint64_t m_LastOffset = 0;
+		uint32_t m_Overlaps = 0;
+		uint32_t m_Wraps = 0;
+	};
+
+	class TrackingCommandList : public Engine::NullRhiCommandList
+	{
+	public:
+		explicit TrackingCommandList(StagingTracker& pTracker) : m_Tracker(pTracker) {}
+
+		void End() override
+		{
+			NullRhiCommandList::End();
+			m_Tracker.EndBatch();
+		}
+
+		void CopyBufferRegion(const Engine::RhiBuffer& pDestination, const uint64_t pDestinationOffset,
+		                      const Engine::RhiBuffer& pSource, const uint64_t pSourceOffset, const uint64_t pSize) override
+		{
+			NullRhiCommandList::CopyBufferRegion(pDestination, pDestinationOffset, pSource, pSourceOffset, pSize);
+			m_Tracker.Use(pSource, pSourceOffset, pSize);
+		}
+
+	private:
+		StagingTracker& m_Tracker;
+	};
+
+	// Hands the UploadManager its tracked copy list and fence. The copy queue completes a signal once pLatency
+	// more were queued, batches stay in flight as they would on a busy GPU.
+	class TrackingDevice : public Engine::NullRhiDevice
+	{
+	public:
+		explicit TrackingDevice(const uint32_t pLatency)
+		{
+			static_cast<Engine::NullRhiCommandQueue&>(GetQueue(Engine::RhiQueueType::Copy)).SetLatency(pLatency);
+		}
+
+		std::unique_ptr<Engine::RhiFence> CreateFence(const uint64_t pInitialValue) override
+		{
+			std::unique_ptr<Engine::RhiFence> fence = NullRhiDevice::CreateFence(pInitialValue);
+			Tracker.SetFence(*fence);
+			return fence;
+		}
+
+		std::unique_ptr<Engine::RhiCommandList> CreateCommandList(Engine::RhiQueueType) override
+		{
+			return std::make_unique<TrackingCommandList>(Tracker);
+		}
+
+		StagingTracker Tracker;
+	};
+
+	struct Upload
+	{
+		std::unique_ptr<Engine::RhiBuffer> Buffer;
+		std::vector<uint8_t> Data;
+	};
+
+	Upload CreateBuffer(Engine::UploadManager& pUploads, Tests::Random& pRandom, const uint64_t pSize)
+	{
+		Upload upload;
+		upload.Data.resize(pSize);
+		for (uint8_t& byte : upload.Data)
+			byte = static_cast<uint8_t>(pRandom.Next());
+		upload.Buffer = pUploads.CreateBuffer(upload.Data.data(), pSize);
+		return upload;
+	}
+
+	bool HoldsData(const Upload& pUpload)
+	{
+		return static_cast<const Engine::NullRhiBuffer&>(*pUpload.Buffer).GetStorage() == pUpload.Data;
+	}
+}
+
+// Batches of uploads larger than the ring in total, while the copy queue runs two batches behind : the ring wraps
+// around many times, waits for the oldest batch when it is full, and never hands out memory a batch in flight
+// still reads.
+TEST(UploadManager_WrapsTheRingAroundCopiesInFlight)
+{
+	TrackingDevice device(2);
+	Engine::UploadManager uploads(device, k_StagingSize);
+	CHECK(uploads.GetStagingSize() == k_StagingSize);
+
+	Tests::Random random(3);
+	std::vector<Upload> buffers;
+	uint64_t uploadedBytes = 0;
+	for (uint32_t batch = 0; batch < 40; ++batch)
+	{
+		const uint32_t count = 1 + random.Next(4);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			buffers.push_back(CreateBuffer(uploads, random, 1 + random.Next(k_StagingSize / 4)));
+			uploadedBytes += buffers.back().Data.size();
+		}
+		CHECK(uploads.Submit() == batch + 1);
+	}
+	uploads.Wait(uploads.Submit());
+	for (const Upload& buffer : buffers)
+		CHECK(HoldsData(buffer));
+
+	const Engine::UploadManager::Stats& stats = uploads.GetStats();
+	CHECK(device.Tracker.GetOverlaps() == 0);
+	CHECK(device.Tracker.GetWraps() > 5);
+	CHECK(stats.StagingWaits > 0);
+	CHECK(stats.PeakStagingBytes <= k_StagingSize);
+	CHECK(stats.Submissions == 40);
+	CHECK(stats.BufferUploads == buffers.size());
+	CHECK(stats.UploadedBytes == uploadedBytes);
+	CHECK(stats.DedicatedUploads == 0);
+
+	uploads.Retire();
+	CHECK(uploads.GetStats().StagingBytes == 0);
+}
+
+// An upload larger than the whole ring is staged in a buffer of its own, kept until its batch is done. The ring
+// uploads around it are unaffected.
+TEST(UploadManager_StagesOversizedUploadsInTheirOwnBuffer)
+{
+	TrackingDevice device(1);
+	Engine::UploadManager uploads(device, k_StagingSize);
+	Tests::Random random(4);
+
+	const Upload before = CreateBuffer(uploads, random, 1000);
+	const Upload large = CreateBuffer(uploads, random, 3 * k_StagingSize + 7);
+	const Upload after = CreateBuffer(uploads, random, k_StagingSize - 2000);
+	const Engine::UploadManager::Stats& stats = uploads.GetStats();
+	CHECK(stats.DedicatedUploads == 1);
+	CHECK(stats.StagingWaits == 0);
+	CHECK(stats.PeakStagingBytes < k_StagingSize);
+
+	const Engine::UploadTicket ticket = uploads.Submit();
+	CHECK(!uploads.IsDone(ticket));
+	uploads.Wait(ticket);
+	CHECK(HoldsData(before));
+	CHECK(HoldsData(large));
+	CHECK(HoldsData(after));
+	CHECK(device.Tracker.GetOverlaps() == 0);
+}
+
+// Tickets are polled without blocking : nothing recorded is done, a submitted batch is done once the copy queue
+// reached it, and Wait() submits the batch being recorded.
+TEST(UploadManager_PollsTickets)
+{
+	TrackingDevice device(2);
+	Engine::UploadManager uploads(device, k_StagingSize);
+	Tests::Random random(5);
+
+	CHECK(uploads.IsDone(0));
+	CHECK(uploads.GetPendingTicket() == 1);
+	CHECK(uploads.IsDone(uploads.GetPendingTicket()));
+	CHECK(uploads.Submit() == 0);
+
+	std::vector<Upload> buffers;
+	std::vector<Engine::UploadTicket> tickets;
+	for (uint32_t batch = 0; batch < 3; ++batch)
+	{
+		buffers.push_back(CreateBuffer(uploads, random, 256));
+		const Engine::UploadTicket ticket = uploads.GetPendingTicket();
+		CHECK(!uploads.IsDone(ticket));
+		CHECK(uploads.Submit() == ticket);
+		tickets.push_back(ticket);
+	}
+	// Two signals behind : only the first batch is done.
+	CHECK(uploads.IsDone(tickets[0]));
+	CHECK(!uploads.IsDone(tickets[1]));
+	CHECK(!uploads.IsDone(tickets[2]));
+	CHECK(uploads.GetStats().StagingBytes > 0);
+
+	buffers.push_back(CreateBuffer(uploads, random, 256));
+	const Engine::UploadTicket pending = uploads.GetPendingTicket();
+	uploads.Wait(pending);
+	CHECK(uploads.GetStats().Submissions == 4);
+	for (const Engine::UploadTicket ticket : tickets)
+		CHECK(uploads.IsDone(ticket));
+	CHECK(uploads.IsDone(pending));
+	for (const Upload& buffer : buffers)
+		CHECK(HoldsData(buffer));
+
+	uploads.Retire();
+	CHECK(uploads.GetStats().StagingBytes == 0);
+}
+
+// The graphics queue waits on the GPU for the copies it reads, once per submission and only for batches the copy
+// queue has not finished.
+TEST(UploadManager_MakesTheGraphicsQueueWaitOnTheCopyFence)
+{
+	TrackingDevice device(1);
+	Engine::UploadManager uploads(device, k_StagingSize);
+	Engine::RhiCommandQueue& graphicsQueue = device.GetQueue(Engine::RhiQueueType::Graphics);
+	Tests::Random random(6);
+
+	// Nothing submitted, nothing to wait for.
+	uploads.MakeVisible(graphicsQueue);
+	CHECK(uploads.GetStats().QueueWaits == 0);
+
+	const Upload first = CreateBuffer(uploads, random, 512);
+	const Engine::UploadTicket ticket = uploads.Submit();
+	CHECK(!uploads.IsDone(ticket));
+	uploads.MakeVisible(graphicsQueue);
+	CHECK(uploads.GetStats().QueueWaits == 1);
+	CHECK(device.GetStats().QueueWaitCount == 1);
+	// The null queue catches up to the fence value it waited for.
+	CHECK(uploads.IsDone(ticket));
+	CHECK(HoldsData(first));
+
+	uploads.MakeVisible(graphicsQueue);
+	CHECK(uploads.GetStats().QueueWaits == 1);
+
+	// A batch already copied is visible without a wait.
+	const Upload second = CreateBuffer(uploads, random, 512);
+	uploads.Wait(uploads.Submit());
+	uploads.MakeVisible(graphicsQueue);
+	CHECK(uploads.GetStats().QueueWaits == 1);
+	CHECK(device.GetStats().QueueWaitCount == 1);
+	CHECK(HoldsData(second));
+}
@@ -0,0 +1,188 @@
+#include "Test.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "Core/JobSystem.h"
+#include "Renderer/FramePacer.h"
+#include "Renderer/UploadRing.h"
+#include "Renderer/RHI/NullRhi.h"
+
+namespace
+{
+	struct Block
+	{
+		Engine::RhiGpuAddress Address;
+		uint64_t Size;
+		uint8_t* CpuAddress;
+		uint8_t Tag;
+	};
+
+	bool Overlap(const Block& pA, const Block& pB)
+	{
+		return pA.Address < pB.Address + pB.Size && pB.Address < pA.Address + pA.Size;
+	}
+
+	bool HoldsTag(const Block& pBlock)
+	{
+		return std::all_of(pBlock.CpuAddress, pBlock.CpuAddress + pBlock.Size,
+		                   [&](const uint8_t pByte) { return pByte == pBlock.Tag; });
+	}
+}
+
+// The null buffers live in CPU memory at distinct fake GPU addresses : the blocks are checked through both.
+TEST(UploadRing_AllocatesAlignedBlocksInThePage)
+{
+	Engine::NullRhiDevice device;
+	Engine::UploadRing ring(device, 2, 4096);
+
+	Tests::Random random(5);
+	std::vector<Block> blocks;
+	uint64_t end = 0;
+	for (uint32_t i = 0; i < 40; ++i)
+	{
+		const uint64_t size = 1 + random.Next(60);
+		const uint64_t alignment = 1ull << random.Next(7);
+		const Engine::UploadAllocation allocation = ring.Allocate(size, alignment);
+		CHECK(allocation.Offset % alignment == 0);
+		CHECK(allocation.Offset >= end);
+		CHECK(allocation.Size == size);
+		CHECK(allocation.GpuAddress == allocation.Buffer->GetGpuAddress() + allocation.Offset);
+		CHECK(allocation.CpuAddress == allocation.Buffer->GetMappedData() + allocation.Offset);
+		end = allocation.Offset + size;
+		blocks.push_back({allocation.GpuAddress, size, allocation.CpuAddress, 0});
+	}
+	// A bump allocator : the padding is the only gap between the blocks.
+	CHECK(end < 40 * (60 + 64));
+	CHECK(ring.GetStats().PageCount == 2);
+
+	const Engine::RhiGpuAddress constants = ring.PushConstants(blocks.data(), 80);
+	CHECK(constants % Engine::k_RhiConstantBufferAlignment == 0);
+
+	ring.BeginFrame(1);
+	CHECK(ring.GetStats().FrameAllocations == 41);
+	// The constants take a whole 256 byte block.
+	CHECK(ring.GetStats().FrameBytes == Engine::RhiAlign(end, 256) + 256);
+	CHECK(ring.GetStats().PeakFrameBytes == ring.GetStats().FrameBytes);
+
+	// A frame slot starts over from the beginning of its pages once it comes back.
+	ring.BeginFrame(0);
+	CHECK(ring.Allocate(16, 16).GpuAddress == blocks[0].Address);
+}
+
+TEST(UploadRing_GrowsWhenAFrameNeedsMoreThanAPage)
+{
+	Engine::NullRhiDevice device;
+	Engine::UploadRing ring(device, 3, 1024);
+	CHECK(ring.GetStats().CapacityBytes == 3 * 1024);
+
+	// 10 blocks of 300 bytes, 3 per page : 4 pages.
+	for (uint32_t i = 0; i < 10; ++i)
+		CHECK(ring.Allocate(300, 4).Offset + 300 <= 1024);
+	CHECK(ring.GetStats().PageCount == 3 + 3);
+
+	// Larger than a page : a page of its own, sized for it.
+	const Engine::UploadAllocation large = ring.Allocate(5000, 256);
+	CHECK(large.Offset == 0);
+	CHECK(large.Buffer->GetDesc().Size >= 5000);
+	CHECK(ring.GetStats().PageCount == 3 + 4);
+
+	ring.BeginFrame(1);
+	const Engine::UploadRing::Stats stats = ring.GetStats();
+	// 4 full pages, then the large one.
+	CHECK(stats.FrameBytes == 4 * 1024 + 5000);
+	CHECK(stats.PeakFrameBytes == stats.FrameBytes);
+
+	// The pages are kept, the same frame slot does not create them again.
+	ring.BeginFrame(2);
+	ring.BeginFrame(0);
+	for (uint32_t i = 0; i < 10; ++i)
+		ring.Allocate(300, 4);
+	ring.Allocate(5000, 256);
+	CHECK(ring.GetStats().PageCount == stats.PageCount);
+	CHECK(ring.GetStats().CapacityBytes == stats.CapacityBytes);
+
+	// A smaller frame does not lower the peak.
+	ring.BeginFrame(1);
+	ring.Allocate(64, 16);
+	ring.BeginFrame(2);
+	CHECK(ring.GetStats().FrameBytes == 64);
+	CHECK(ring.GetStats().PeakFrameBytes == stats.PeakFrameBytes);
+}
+
+// Frames paced on a GPU running behind the CPU : the memory of a frame the GPU may still read is never
+// handed out again, whatever the sizes the frames after it ask for.
+TEST(UploadRing_KeepsTheFramesInFlight)
+{
+	Engine::NullRhiDevice device;
+	auto& queue = static_cast<Engine::NullRhiCommandQueue&>(device.GetQueue(Engine::RhiQueueType::Graphics));
+	constexpr uint32_t frameCount = 3;
+	queue.SetLatency(frameCount);
+	Engine::FramePacer pacer(device, frameCount);
+	Engine::UploadRing ring(device, frameCount, 2048);
+
+	Tests::Random random(6);
+	std::vector<std::vector<Block>> frames;
+	for (uint32_t frame = 0; frame < 300; ++frame)
+	{
+		pacer.BeginFrame();
+		ring.BeginFrame(pacer.GetFrameIndex());
+
+		std::vector<Block> blocks;
+		const uint32_t blockCount = random.Next(40);
+		const uint8_t tag = static_cast<uint8_t>(frame + 1);
+		for (uint32_t i = 0; i < blockCount; ++i)
+		{
+			const Engine::UploadAllocation allocation = ring.Allocate(1 + random.Next(400), 16);
+			std::memset(allocation.CpuAddress, tag, allocation.Size);
+			blocks.push_back({allocation.GpuAddress, allocation.Size, allocation.CpuAddress, tag});
+		}
+
+		// The frames before it still in flight kept their blocks and their content.
+		const size_t firstInFlight = frames.size() - (std::min)(frames.size(), static_cast<size_t>(frameCount - 1));
+		for (size_t previous = firstInFlight; previous < frames.size(); ++previous)
+		{
+			for (const Block& block : frames[previous])
+			{
+				CHECK(HoldsTag(block));
+				for (const Block& newBlock : blocks)
+					CHECK(!Overlap(block, newBlock));
+			}
+		}
+
+		frames.push_back(std::move(blocks));
+		pacer.EndFrame(queue);
+	}
+	CHECK(pacer.GetStats().WaitCount > 0);
+}
+
+TEST(UploadRing_AllocatesFromSeveralThreads)
+{
+	Engine::JobSystem::Initialize(4);
+	Engine::NullRhiDevice device;
+	Engine::UploadRing ring(device, 2, 4096);
+
+	constexpr uint32_t blockCount = 20000;
+	std::vector<Block> blocks(blockCount);
+	Engine::JobSystem::ParallelFor(blockCount, 64, [&](const uint32_t pFirst, const uint32_t pLast, uint32_t)
+	{
+		for (uint32_t i = pFirst; i < pLast; ++i)
+		{
+			const Engine::UploadAllocation allocation = ring.Allocate(8 + i % 57, 8);
+			std::memset(allocation.CpuAddress, static_cast<uint8_t>(i), allocation.Size);
+			blocks[i] = {allocation.GpuAddress, allocation.Size, allocation.CpuAddress, static_cast<uint8_t>(i)};
+		}
+	});
+	Engine::JobSystem::Shutdown();
+
+	std::sort(blocks.begin(), blocks.end(), [](const Block& pA, const Block& pB) { return pA.Address < pB.Address; });
+	for (uint32_t i = 0; i < blockCount; ++i)
+	{
+		CHECK(HoldsTag(blocks[i]));
+		if (i > 0)
+			CHECK(!Overlap(blocks[i - 1], blocks[i]));
+	}
+	ring.BeginFrame(1);
+	CHECK(ring.GetStats().FrameAllocations == blockCount);
+}
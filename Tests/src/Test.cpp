@@ -0,0 +1,75 @@
+#include "Test.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace Tests
+{
+	namespace
+	{
+		struct TestCase
+		{
+			const char* Name;
+			TestFunction Function;
+			bool IsBenchmark;
+		};
+
+		// Filled by the static registrations, before main().
+		std::vector<TestCase>& GetTestCases()
+		{
+			static std::vector<TestCase> s_TestCases;
+			return s_TestCases;
+		}
+
+		// Only the first failures of a test are printed, a check failing in a loop would flood the output.
+		constexpr uint32_t k_MaxPrintedFailures = 10;
+		uint32_t s_FailureCount = 0;
+	}
+
+	TestRegistration::TestRegistration(const char* pName, const TestFunction pFunction, const bool pIsBenchmark)
+	{
+		GetTestCases().push_back({pName, pFunction, pIsBenchmark});
+	}
+
+	void Fail(const char* pFile, const int pLine, const char* pExpression)
+	{
+		if (s_FailureCount++ < k_MaxPrintedFailures)
+			std::printf("  %s(%d): CHECK(%s) failed\n", pFile, pLine, pExpression);
+	}
+
+	double GetTime()
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	/// <returns> The number of failed tests. </returns>
+	int RunTests(const bool pRunBenchmarks, const char* pFilter)
+	{
+		int failedCount = 0;
+		int runCount = 0;
+		for (const TestCase& testCase : GetTestCases())
+		{
+			if (testCase.IsBenchmark != pRunBenchmarks || (pFilter && !std::strstr(testCase.Name, pFilter)))
+				continue;
+
+			std::printf("[ RUN  ] %s\n", testCase.Name);
+			std::fflush(stdout);
+			s_FailureCount = 0;
+			const double start = GetTime();
+			testCase.Function();
+			const double milliseconds = (GetTime() - start) * 1000.0;
+
+			if (s_FailureCount > 0)
+				std::printf("[ FAIL ] %s, %u failed checks\n", testCase.Name, s_FailureCount);
+			else
+				std::printf("[  OK  ] %s (%.1f ms)\n", testCase.Name, milliseconds);
+			failedCount += s_FailureCount > 0 ? 1 : 0;
+			++runCount;
+		}
+
+		std::printf("%d run, %d failed\n", runCount, failedCount);
+		return failedCount;
+	}
+}
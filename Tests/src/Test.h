@@ -0,0 +1,64 @@
+#pragma once
+#include <cstdint>
+
+namespace Tests
+{
+	using TestFunction = void (*)();
+
+	/// <summary>
+	/// Adds a test, or a benchmark only run with --bench, to the ones EntryPoint runs. Declared by TEST() and
+	/// BENCHMARK().
+	/// </summary>
+	struct TestRegistration
+	{
+		TestRegistration(const char* pName, TestFunction pFunction, bool pIsBenchmark);
+	};
+
+	/// <summary>
+	/// Fails the running test. The test goes on, so every failed check is reported.
+	/// </summary>
+	void Fail(const char* pFile, int pLine, const char* pExpression);
+
+	/// <returns> Seconds from an arbitrary point, for timing. </returns>
+	double GetTime();
+
+	/// <summary>
+	/// Small deterministic generator, so a failing test fails again the same way.
+	/// </summary>
+	class Random
+	{
+	public:
+		explicit Random(const uint64_t pSeed) : m_State(pSeed * 0x9E3779B97F4A7C15ull + 1) {}
+
+		uint32_t Next()
+		{
+			m_State = m_State * 6364136223846793005ull + 1442695040888963407ull;
+			return static_cast<uint32_t>(m_State >> 32);
+		}
+
+		/// <returns> A value in [0, pCount). </returns>
+		uint32_t Next(const uint32_t pCount) { return static_cast<uint32_t>(static_cast<uint64_t>(Next()) * pCount >> 32); }
+		/// <returns> A value in [pMin, pMax). </returns>
+		float Range(const float pMin, const float pMax) { return pMin + (pMax - pMin) * (Next() >> 8) * (1.f / 16777216.f); }
+
+	private:
+		uint64_t m_State;
+	};
+}
+
+#define TEST(pName) \
+	static void pName(); \
+	static const ::Tests::TestRegistration s_##pName##Registration(#pName, &pName, false); \
+	static void pName()
+
+#define BENCHMARK(pName) \
+	static void pName(); \
+	static const ::Tests::TestRegistration s_##pName##Registration(#pName, &pName, true); \
+	static void pName()
+
+#define CHECK(pCondition) \
+	do \
+	{ \
+		if (!(pCondition)) \
+			::Tests::Fail(__FILE__, __LINE__, #pCondition); \
+	} while (false)
@@ -16,4 +16,5 @@ workspace "GT_ProjectDirectX"
     
 outputdir = "%{cfg.buildcfg}-%{cfg.system}-%{cfg.architecture}"
 
-include "Engine"
\ No newline at end of file
+include "Engine"
+include "Tests"
\ No newline at end of file